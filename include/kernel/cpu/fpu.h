@@ -0,0 +1,60 @@
+/**
+ * @file fpu.h
+ * @brief Lazy FPU and SSE context switching.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstdint.h"
+
+namespace tsk {
+class Thread;
+}
+
+namespace cpu {
+
+//! The FPU, MMX and SSE state saved by @p fxsave.
+struct alignas(16) FpuState {
+    stl::array<stl::byte, 512> data;
+};
+
+static_assert(sizeof(FpuState) == 512);
+
+/**
+ * @brief Enable the FPU and SSE instructions and lazy context switching.
+ *
+ * @details
+ * A thread does not save its FPU state when it is switched out.
+ * Instead, the task-switched flag in @p CR0 is set,
+ * and the first FPU or SSE instruction of the next thread raises a device-not-available exception.
+ * The exception handler saves the state of the previous owner and restores the state of the current thread.
+ * So threads that never use the FPU pay nothing.
+ *
+ * @warning
+ * Interrupt handlers must not use the FPU or SSE instructions, since they would change the state of the interrupted thread.
+ */
+void InitFpu() noexcept;
+
+//! Whether lazy FPU context switching has been enabled.
+bool IsFpuInited() noexcept;
+
+/**
+ * @brief Prepare the FPU for a thread about to run.
+ *
+ * @details
+ * If the thread does not own the FPU registers, the task-switched flag is set.
+ * It is called by the scheduler with interrupts disabled.
+ */
+void SwitchFpu(const tsk::Thread& next) noexcept;
+
+//! Copy the FPU state of a thread to another thread, which is used by forking.
+void CopyFpu(const tsk::Thread& from, tsk::Thread& to) noexcept;
+
+//! Free the FPU state of an exiting thread.
+void ReleaseFpu(tsk::Thread&) noexcept;
+
+}  // namespace cpu
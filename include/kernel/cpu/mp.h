@@ -0,0 +1,87 @@
+/**
+ * @file mp.h
+ * @brief Processor detection based on the *MultiProcessor Specification*.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstdint.h"
+
+namespace cpu {
+
+//! The maximum number of processors that can be recorded.
+inline constexpr stl::size_t max_cpu_count {16};
+
+//! The number of ISA interrupt requests.
+inline constexpr stl::size_t isa_irq_count {16};
+
+//! Processors detected from the multiprocessor configuration table.
+struct MpInfo {
+    //! The number of enabled processors.
+    stl::size_t cpu_count;
+
+    //! The index of the bootstrap processor in @p apic_ids.
+    stl::size_t bsp_idx;
+
+    //! The physical address of local APICs.
+    stl::uintptr_t local_apic_addr;
+
+    //! The local APIC ID of each enabled processor.
+    stl::array<stl::uint8_t, max_cpu_count> apic_ids;
+
+    //! The physical address of the first I/O APIC, or @p 0 if there is none.
+    stl::uintptr_t io_apic_addr;
+
+    //! The ID of the first I/O APIC.
+    stl::uint8_t io_apic_id;
+
+    /**
+     * @brief The input pin of the first I/O APIC connected to each ISA interrupt request.
+     *
+     * @details
+     * Most pins are identical to interrupt requests, but the timer is often connected to the pin @p 2.
+     */
+    stl::array<stl::uint8_t, isa_irq_count> isa_irq_pins;
+
+    /**
+     * @brief Whether the interrupt mode configuration register is present.
+     *
+     * @details
+     * If it is present, the system starts in the PIC mode,
+     * where *Intel 8259A* is connected to processors directly instead of through APICs.
+     */
+    bool imcr_present;
+};
+
+/**
+ * @brief Detect processors.
+ *
+ * @details
+ * It searches the MP floating pointer structure in the extended BIOS data area, the last kilobyte of base memory and the BIOS ROM,
+ * then reads processor entries from the configuration table.
+ * If no valid table is found, the system is regarded as uniprocessor.
+ *
+ * @warning
+ * Application processors are only detected, but not started.
+ * Kernel locks are implemented by disabling interrupts, which does not protect data shared between processors.
+ */
+void InitMultiProcessor() noexcept;
+
+const MpInfo& GetMpInfo() noexcept;
+
+/**
+ * @brief Get the index of the current processor in @p MpInfo::apic_ids.
+ *
+ * @details
+ * Only the bootstrap processor runs the kernel.
+ */
+stl::size_t GetCurrCpuIdx() noexcept;
+
+//! Get the mask of processors running the kernel. The bit @p i is the index @p i in @p MpInfo::apic_ids.
+stl::uint32_t GetOnlineCpuMask() noexcept;
+
+}  // namespace cpu
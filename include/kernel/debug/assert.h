@@ -13,12 +13,31 @@
 
 namespace dbg {
 
-#ifdef NDEBUG
-inline constexpr bool enabled {false};
+/**
+ * @brief The assertion level.
+ *
+ * @details
+ * - @p 0: All assertions are disabled.
+ * - @p 1: Only constant-time assertions are enabled.
+ * - @p 2: Slow assertions, such as searching a list, are also enabled.
+ *
+ * It can be set by the @p DBG_ASSERT_LEVEL macro. @p NDEBUG disables all assertions.
+ */
+#if defined(NDEBUG)
+inline constexpr unsigned int level {0};
+#elif defined(DBG_ASSERT_LEVEL)
+inline constexpr unsigned int level {DBG_ASSERT_LEVEL};
 #else
-inline constexpr bool enabled {true};
+inline constexpr unsigned int level {2};
 #endif
 
+static_assert(level <= 2);
+
+inline constexpr bool enabled {level > 0};
+
+//! Whether slow assertions are enabled.
+inline constexpr bool slow_enabled {level > 1};
+
 /**
  * @brief
  * Check for a condition.
@@ -31,4 +50,23 @@ inline constexpr bool enabled {true};
 void Assert(bool cond, stl::string_view msg = nullptr,
             const stl::source_location& src = stl::source_location::current()) noexcept;
 
+/**
+ * @brief Check for a condition that is slow to evaluate.
+ *
+ * @details
+ * The condition is a callable object. It is only evaluated when slow assertions are enabled,
+ * so checks like searching a list are removed from hot paths in release builds.
+ *
+ * @param cond A callable object returning the condition.
+ * @param msg An optional message to display.
+ * @param src The source code information. The developer should not change this parameter.
+ */
+template <typename Cond>
+void AssertSlow(Cond&& cond, const stl::string_view msg = nullptr,
+                const stl::source_location& src = stl::source_location::current()) noexcept {
+    if constexpr (slow_enabled) {
+        Assert(cond(), msg, src);
+    }
+}
+
 }  // namespace dbg
\ No newline at end of file
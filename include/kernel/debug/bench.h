@@ -0,0 +1,87 @@
+/**
+ * @file bench.h
+ * @brief Microbenchmarks of kernel primitives.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/util/metric.h"
+
+namespace dbg {
+
+/**
+ * @brief Whether to run microbenchmarks after the kernel is initialized.
+ *
+ * @details
+ * It can be set by the @p KRNL_BENCH macro.
+ */
+#ifdef KRNL_BENCH
+inline constexpr bool krnl_bench_enabled {KRNL_BENCH != 0};
+#else
+inline constexpr bool krnl_bench_enabled {false};
+#endif
+
+//! A microbenchmark measuring an operation by the time-stamp counter.
+struct Benchmark {
+    //! An operation, a setup or a cleanup callback.
+    using Callback = void (*)(void* arg) noexcept;
+
+    //! The name of the benchmark.
+    const char* name;
+    //! The operation measured in each run.
+    Callback op;
+    //! An argument passed to callbacks.
+    void* arg {nullptr};
+    //! A parameter printed after the name, such as a size, or @p npos if there is none.
+    stl::size_t param {npos};
+    //! A callback called before runs, such as creating threads or buffers.
+    Callback setup {nullptr};
+    //! A callback called after runs.
+    Callback cleanup {nullptr};
+    /**
+     * @brief Whether the operation runs in a user process, such as a system call.
+     *
+     * @details
+     * The operation is called in user mode. It must not use privileged instructions.
+     */
+    bool usr_mode {false};
+};
+
+//! The maximum number of registered benchmarks.
+inline constexpr stl::size_t max_bench_count {48};
+
+//! The number of runs before measuring, which warm up caches and the TLB.
+inline constexpr stl::size_t bench_warm_up_count {16};
+
+//! The number of measured runs.
+inline constexpr stl::size_t bench_run_count {256};
+
+/**
+ * @brief Register a benchmark before @p RunBenchmarks is called.
+ *
+ * @return Whether the benchmark is registered. It fails if @p max_bench_count benchmarks have been registered.
+ */
+bool RegisterBenchmark(const Benchmark&) noexcept;
+
+/**
+ * @brief Run built-in and registered benchmarks and print the results.
+ *
+ * @details
+ * Built-in benchmarks are registered first:
+ * - A context switch round trip by @p tsk::Thread::Yield between two threads.
+ * - A system call round trip from user mode.
+ * - @p mem::Allocate and @p mem::Free for each block size.
+ * - @p Bitmap::Alloc in a half-allocated bitmap.
+ * - @p io::Disk::ReadSectors of one and eight sectors on the boot disk.
+ * - @p stl::memcpy of 64 bytes and 4 KB.
+ *
+ * Each benchmark runs its operation @p bench_warm_up_count times, then measures @p bench_run_count runs.
+ * The cost of reading the time-stamp counter is measured first and removed from each run.
+ * The minimum, median and 99th percentile are printed in cycles.
+ */
+void RunBenchmarks() noexcept;
+
+}  // namespace dbg
@@ -0,0 +1,94 @@
+/**
+ * @file log.h
+ * @brief The kernel log.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/stl/string_view.h"
+#include "kernel/util/format.h"
+
+namespace dbg {
+
+enum class LogLevel { Debug, Info, Warning, Error };
+
+//! Records below this level are discarded when they are created.
+inline constexpr LogLevel min_log_level {LogLevel::Info};
+
+//! The maximum number of records waiting to be printed.
+inline constexpr stl::size_t max_log_record_count {64};
+
+//! The priority of the logger thread, which is only higher than the idle thread.
+inline constexpr stl::size_t log_thd_priority {16};
+
+//! A log record.
+struct LogRecord {
+    //! The maximum length of a message. Longer messages are truncated.
+    static constexpr stl::size_t max_msg_len {100};
+
+    //! The number of nanoseconds after the timer initialization, or zero before it.
+    stl::uint64_t time;
+    LogLevel level;
+    stl::size_t msg_len;
+    stl::array<char, max_msg_len> msg;
+};
+
+namespace _log_impl {
+
+void Format(LogRecord&, stl::uint32_t) noexcept;
+
+void Format(LogRecord&, stl::int32_t) noexcept;
+
+void Format(LogRecord&, stl::uint64_t) noexcept;
+
+void Format(LogRecord&, char) noexcept;
+
+void Format(LogRecord&, stl::string_view) noexcept;
+
+void Format(LogRecord&, const char*) noexcept;
+
+//! Stamp a record with the current time and level.
+void BeginRecord(LogRecord&, LogLevel) noexcept;
+
+//! Push a record into the log ring, or print it at once if the logger thread has not started.
+void SubmitRecord(const LogRecord&) noexcept;
+
+}  // namespace _log_impl
+
+/**
+ * @brief Log a message with variadic values.
+ *
+ * @details
+ * The message is formatted into a record and pushed into a lock-free ring without blocking,
+ * so it can be called in hot paths and interrupt handlers.
+ * A low-priority logger thread prints records to the console.
+ * If the ring is full, the record is dropped and counted.
+ *
+ * The format is the same as @p io::Printf, and it is parsed at compile time.
+ */
+template <typename... Args>
+void Log(const LogLevel level, const FormatString<stl::type_identity_t<Args>...> format,
+         const Args... args) noexcept {
+    if (level < min_log_level) {
+        return;
+    }
+
+    LogRecord record;
+    _log_impl::BeginRecord(record, level);
+    stl::size_t i {0};
+    ((_log_impl::Format(record, format.GetPiece(i++)), _log_impl::Format(record, args)), ...);
+    _log_impl::Format(record, format.GetPiece(i));
+    _log_impl::SubmitRecord(record);
+}
+
+//! Get the number of records dropped because the ring was full.
+stl::size_t GetDroppedLogCount() noexcept;
+
+//! Initialize the log ring and start the logger thread.
+void InitLog() noexcept;
+
+}  // namespace dbg
@@ -0,0 +1,69 @@
+/**
+ * @file prof.h
+ * @brief The sampling profiler driven by clock interrupts.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/interrupt/intr.h"
+
+namespace dbg {
+
+//! The maximum number of saved samples. Later samples overwrite the oldest ones.
+inline constexpr stl::size_t max_prof_sample_count {4096};
+
+//! The maximum number of code addresses printed by @p DumpProfile.
+inline constexpr stl::size_t max_prof_dump_addr_count {64};
+
+//! A sample of the code interrupted by a clock interrupt.
+struct ProfSample {
+    //! The interrupted instruction address.
+    stl::uintptr_t eip;
+    //! The interrupted thread, only used to tell threads apart.
+    stl::uintptr_t thd;
+    //! The process ID of the thread, or @p 0 for kernel threads.
+    stl::size_t pid;
+    //! Whether the thread was running in user mode.
+    bool usr_mode;
+};
+
+/**
+ * @brief Clear samples, then enable or disable the profiler.
+ *
+ * @details
+ * When it is enabled, each clock interrupt records the interrupted instruction and thread.
+ * The system has one processor running the kernel, so there is only one sample buffer.
+ */
+void ResetProfiler(bool enabled) noexcept;
+
+//! Whether the profiler is recording samples.
+bool IsProfilerEnabled() noexcept;
+
+/**
+ * @brief Print the profile.
+ *
+ * @details
+ * Code addresses are printed with their sample counts in descending order,
+ * followed by the number of samples of each thread.
+ * Kernel addresses can be symbolized against @p build/kernel.bin on the host,
+ * for example with @p addr2line -f -C -e build/kernel.bin.
+ */
+void DumpProfile() noexcept;
+
+extern "C" {
+/**
+ * @brief Record a sample.
+ *
+ * @details
+ * It is called by @p Intr0x20HandlerEntry in @p src/kernel/interrupt/intr.asm when the profiler is enabled,
+ * with interrupts disabled.
+ *
+ * @param stack Registers saved by the clock interrupt.
+ */
+void RecordProfSample(const intr::IntrStack& stack) noexcept;
+}
+
+}  // namespace dbg
@@ -0,0 +1,67 @@
+/**
+ * @file timeline.h
+ * @brief The boot timeline.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+#include "kernel/stl/span.h"
+
+namespace dbg {
+
+//! The maximum number of boot stages in the timeline. Later stages are discarded.
+inline constexpr stl::size_t max_boot_stage_count {32};
+
+//! A boot stage recorded in the timeline. It starts when the previous stage finishes.
+struct BootStage {
+    //! The name of the stage.
+    const char* name;
+    //! The time-stamp counter when the stage finishes.
+    stl::uint64_t tsc;
+};
+
+/**
+ * @brief Initialize the boot timeline when the kernel starts.
+ *
+ * @details
+ * The master boot record and the loader save time-stamp counters when they start to run,
+ * and the loader saves another one before jumping to the kernel.
+ * They are copied to the timeline as the end of the BIOS, the master boot record and the loader.
+ * It must be called before the low physical memory is unmapped.
+ */
+void InitBootTimeline() noexcept;
+
+/**
+ * @brief Record the end of a boot stage with the current time-stamp counter.
+ *
+ * @details
+ * If the timeline has been logged, the stage is logged at once.
+ *
+ * @param name The name of the stage. It must be a string literal.
+ */
+void MarkBootStage(const char* name) noexcept;
+
+/**
+ * @brief Record the boot stage finishing when the first user process enters user mode.
+ *
+ * @details
+ * Only the first call is recorded.
+ */
+void MarkFirstUsrProc() noexcept;
+
+/**
+ * @brief Log the recorded boot stages.
+ *
+ * @details
+ * Each stage is logged with its end time after the processor reset and its duration in microseconds. The timer must be initialized to convert time-stamp counters.
+ */
+void LogBootTimeline() noexcept;
+
+//! Get the recorded boot stages.
+stl::span<BootStage> GetBootStages() noexcept;
+
+}  // namespace dbg
@@ -0,0 +1,157 @@
+/**
+ * @file trace.h
+ * @brief Static tracepoints recording binary events in a ring buffer.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+
+namespace dbg {
+
+/**
+ * @brief Whether tracepoints are compiled into the kernel.
+ *
+ * @details
+ * It can be set by the @p KRNL_TRACE macro.
+ * If it is disabled, tracepoints are removed at compile time and the trace cannot be enabled.
+ */
+#ifdef KRNL_TRACE
+inline constexpr bool krnl_trace_enabled {KRNL_TRACE != 0};
+#else
+inline constexpr bool krnl_trace_enabled {false};
+#endif
+
+/**
+ * @brief Whether kernel functions record their entries and exits as trace events.
+ *
+ * @details
+ * It can be set by the @p KRNL_INSTRUMENT macro, which also compiles kernel code with @p -finstrument-functions.
+ * The compiler inserts calls to @p __cyg_profile_func_enter and @p __cyg_profile_func_exit into each function.
+ */
+#ifdef KRNL_INSTRUMENT
+inline constexpr bool krnl_instrument_enabled {KRNL_INSTRUMENT != 0};
+#else
+inline constexpr bool krnl_instrument_enabled {false};
+#endif
+
+static_assert(!krnl_instrument_enabled || krnl_trace_enabled,
+              "Function instrumentation needs tracepoints.");
+
+//! Event types of tracepoints.
+enum class TraceEvent : stl::uint16_t {
+    //! A thread switch. The arguments are the previous and the next thread.
+    ThreadSwitch,
+    //! An interrupt handler starts. The first argument is the interrupt number.
+    IntrEnter,
+    //! An interrupt handler returns. The first argument is the interrupt number.
+    IntrExit,
+    //! A system call handler starts. The arguments are the index and the first argument of the call.
+    SysCallEnter,
+    //! A system call handler returns. The arguments are the index and the return value.
+    SysCallExit,
+    //! A disk read starts. The arguments are the LBA and the number of sectors.
+    DiskReadEnter,
+    //! A disk read completes. The arguments are the LBA and the number of sectors.
+    DiskReadExit,
+    //! A disk write starts. The arguments are the LBA and the number of sectors.
+    DiskWriteEnter,
+    //! A disk write completes. The arguments are the LBA and the number of sectors.
+    DiskWriteExit,
+    //! A memory allocation. The arguments are the size and the address.
+    MemAlloc,
+    //! An instrumented function starts. The arguments are the function and the call site.
+    FuncEnter,
+    //! An instrumented function returns. The arguments are the function and the call site.
+    FuncExit,
+    Count
+};
+
+//! A fixed-size binary trace record.
+struct TraceRecord {
+    //! The time-stamp counter when the event occurred.
+    stl::uint64_t tsc;
+    //! The current thread, only used to tell threads apart.
+    stl::uint32_t thd;
+    TraceEvent event;
+    stl::uint16_t reserved;
+    stl::uint32_t arg1;
+    stl::uint32_t arg2;
+};
+
+static_assert(sizeof(TraceRecord) == 24);
+
+/**
+ * @brief The number of records in the ring buffer. Later records overwrite the oldest ones.
+ *
+ * @details
+ * Instrumented functions record two events for each call, so the buffer is larger.
+ */
+inline constexpr stl::size_t trace_record_count {krnl_instrument_enabled ? 0x8000 : 0x1000};
+
+static_assert((trace_record_count & (trace_record_count - 1)) == 0);
+
+extern "C" {
+/**
+ * @brief Whether tracepoints record events.
+ *
+ * @details
+ * It is also checked by interrupt and system call entries in assembly.
+ */
+extern stl::uint32_t trace_enabled;
+}
+
+namespace _trace_impl {
+
+void Record(TraceEvent, stl::uint32_t arg1, stl::uint32_t arg2) noexcept;
+
+}  // namespace _trace_impl
+
+//! Whether tracepoints are recording events.
+inline bool IsTraceEnabled() noexcept {
+    return krnl_trace_enabled && __atomic_load_n(&trace_enabled, __ATOMIC_RELAXED) != 0;
+}
+
+/**
+ * @brief A tracepoint.
+ *
+ * @details
+ * If tracepoints are not compiled into the kernel, it is empty.
+ * Otherwise, when the trace is disabled, it only checks a flag.
+ * When it is enabled, a record is reserved in the ring buffer by an atomic operation,
+ * so tracepoints can be used in interrupt handlers without disabling interrupts.
+ */
+template <TraceEvent event>
+void Trace(const stl::uint32_t arg1 = 0, const stl::uint32_t arg2 = 0) noexcept {
+    if constexpr (krnl_trace_enabled) {
+        if (IsTraceEnabled()) {
+            _trace_impl::Record(event, arg1, arg2);
+        }
+    }
+}
+
+/**
+ * @brief Clear the ring buffer, then enable or disable tracepoints.
+ *
+ * @details
+ * The ring buffer is allocated when the trace is enabled for the first time.
+ * If tracepoints are not compiled into the kernel, the trace stays disabled.
+ *
+ * @return Whether the trace is enabled.
+ */
+bool ResetTrace(bool enabled) noexcept;
+
+/**
+ * @brief Disable tracepoints and write records in the ring buffer to the serial port.
+ *
+ * @details
+ * The first line is @p trace followed by the time-stamp counter frequency, the number of written records and the number of overwritten records.
+ * Each following line is a record from the oldest one, with its time-stamp counter, event name, thread and two arguments in hexadecimal.
+ * The dump waits for the transmit queue of the serial port, so records are not dropped.
+ */
+void DumpTrace() noexcept;
+
+}  // namespace dbg
@@ -31,6 +31,18 @@ inline constexpr stl::size_t usr_code {5};
 //! The user descriptor for data.
 inline constexpr stl::size_t usr_data {6};
 
+/**
+ * @brief Descriptors used by @p sysenter and @p sysexit.
+ *
+ * @details
+ * @p sysenter and @p sysexit require kernel code, kernel stack, user code and user stack descriptors to be adjacent.
+ * They are copies of the above descriptors.
+ */
+inline constexpr stl::size_t sysenter_krnl_code {7};
+inline constexpr stl::size_t sysenter_krnl_stack {8};
+inline constexpr stl::size_t sysenter_usr_code {9};
+inline constexpr stl::size_t sysenter_usr_stack {10};
+
 }  // namespace idx
 
 }  // namespace gdt
\ No newline at end of file
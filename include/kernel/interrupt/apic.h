@@ -0,0 +1,69 @@
+/**
+ * @file apic.h
+ * @brief The local APIC and I/O APIC.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/interrupt/pic.h"
+#include "kernel/stl/cstdint.h"
+
+namespace intr::apic {
+
+/**
+ * @brief Whether to use APICs instead of *Intel 8259A* when they are available.
+ *
+ * @details
+ * *Intel 8259A* remains the interrupt controller if the processor has no local APIC,
+ * or the MP configuration table does not describe an I/O APIC.
+ */
+inline constexpr bool apic_preferred {true};
+
+/**
+ * @brief Initialize the local APIC of the bootstrap processor and the I/O APIC.
+ *
+ * @details
+ * - Interrupt requests keep the interrupt numbers assigned by *Intel 8259A*,
+ *   so their handlers do not change. They are routed to the bootstrap processor.
+ * - *Intel 8259A* is masked, and end-of-interrupt signals are written to the local APIC instead.
+ * - The clock interrupt is generated by the local APIC timer instead of the I/O APIC.
+ *
+ * It must be called after memory and processors are initialized, with interrupts disabled.
+ *
+ * @param intrs Interrupts to be enabled.
+ * @return Whether APICs are used.
+ */
+bool InitApic(stl::span<pic::Intr> intrs) noexcept;
+
+//! Whether APICs are used instead of *Intel 8259A*.
+bool IsApicEnabled() noexcept;
+
+//! Get the local APIC ID of the current processor.
+stl::uint8_t GetLocalApicId() noexcept;
+
+//! Modes of the local APIC timer.
+enum class TimerMode {
+    //! Generate an interrupt once when the count reaches zero.
+    OneShot,
+    //! Reload the initial count and generate interrupts periodically.
+    Periodic
+};
+
+/**
+ * @brief Start the local APIC timer.
+ *
+ * @details
+ * The timer counts down at the bus frequency divided by @p 16 and generates clock interrupts.
+ *
+ * @param mode The timer mode.
+ * @param count The initial count.
+ */
+void StartTimer(TimerMode mode, stl::uint32_t count) noexcept;
+
+//! Read the current count of the local APIC timer. A one-shot timer stays at zero after it has fired.
+stl::uint32_t ReadTimer() noexcept;
+
+}  // namespace intr::apic
@@ -24,6 +24,8 @@ inline constexpr stl::size_t max_intr_handler_name_len {32};
 
 //! Interrupt numbers.
 enum class Intr {
+    //! The FPU is used when the task-switched flag is set.
+    DeviceNotAvailable = 0x07,
     //! The memory page fault.
     PageFault = 0x0E,
 
@@ -32,6 +34,8 @@ enum class Intr {
     Clock = start_usr_intr_num,
     //! The keyboard.
     Keyboard,
+    //! The serial port @p COM1.
+    Com1 = start_usr_intr_num + 4,
     //! The primary IDE channel.
     PrimaryIdeChnl = start_usr_intr_num + 14,
     //! The secondary IDE channel.
@@ -194,6 +198,15 @@ bool IsIntrEnabled() noexcept;
 //! Initialize interrupts.
 void InitIntr() noexcept;
 
+/**
+ * @brief Deliver interrupt requests through APICs if they are available.
+ *
+ * @details
+ * It must be called after memory and processors are initialized.
+ * Otherwise, *Intel 8259A* initialized by @p InitIntr remains the interrupt controller.
+ */
+void SwitchToApic() noexcept;
+
 /**
  * @brief The interrupt guard.
  *
@@ -220,6 +233,48 @@ private:
  */
 void DefaultIntrHandler(stl::size_t intr_num) noexcept;
 
+/**
+ * @brief Statistics of an interrupt.
+ *
+ * @details
+ * It has the same layout as @p usr::intr::IntrStats.
+ * Handler cycles are measured by the time-stamp counter around the handler.
+ * If a handler switches threads, its cycles include the time until the thread runs again.
+ */
+struct IntrStats {
+    stl::size_t count;
+    //! The number of times the interrupt occurred while the thread was running another interrupt handler.
+    stl::size_t nested_count;
+    //! The number of spurious interrupts, which are ignored.
+    stl::size_t spurious_count;
+    stl::uint64_t total_cycles;
+    stl::uint64_t max_cycles;
+};
+
+/**
+ * @brief Reset statistics of all interrupts, then enable or disable recording them.
+ *
+ * @details
+ * Recording is disabled by default.
+ * When it is enabled, interrupt entries dispatch interrupts through a wrapper,
+ * which reads the time-stamp counter before and after calling the handler.
+ * Spurious interrupts are always counted.
+ */
+void ResetIntrStats(bool enabled) noexcept;
+
+//! Whether statistics of interrupts are being recorded.
+bool IsIntrStatsEnabled() noexcept;
+
+/**
+ * @brief Get statistics of an interrupt.
+ *
+ * @return Whether the interrupt number is valid.
+ */
+bool GetIntrStats(stl::size_t intr_num, IntrStats*) noexcept;
+
+//! Print statistics of interrupts that have occurred.
+void DumpIntrStats() noexcept;
+
 //! Get the interrupt descriptor table register.
 desc::DescTabReg GetIntrDescTabReg() noexcept;
 
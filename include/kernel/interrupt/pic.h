@@ -29,6 +29,9 @@ enum class Intr {
      */
     SlavePic = 2,
 
+    //! The serial port @p COM1.
+    Com1 = 4,
+
     //! The primary IDE channel.
     PrimaryIdeChnl = 14,
     //! The secondary IDE channel.
@@ -42,4 +45,13 @@ enum class Intr {
  */
 void InitPgmIntrCtrl(stl::span<Intr> intrs) noexcept;
 
+/**
+ * @brief Mask all interrupt requests of the interrupt controller.
+ *
+ * @details
+ * It is called when APICs take over interrupt requests.
+ * The interrupt numbers remain remapped, so a spurious interrupt from *Intel 8259A* does not look like an exception.
+ */
+void DisablePgmIntrCtrl() noexcept;
+
 }  // namespace intr::pic
\ No newline at end of file
@@ -0,0 +1,50 @@
+/**
+ * @file work.h
+ * @brief The kernel work queue for deferred interrupt processing.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+
+namespace intr {
+
+/**
+ * @brief A work item deferred from an interrupt handler to thread context.
+ *
+ * @details
+ * An interrupt handler only does urgent work, such as reading a device register,
+ * and enqueues the rest as a work item.
+ * A high-priority kernel worker thread runs work items with interrupts enabled,
+ * which shortens the time with interrupts disabled.
+ */
+struct Work {
+    using Callback = void (*)(void*) noexcept;
+
+    Callback callback;
+    void* arg;
+};
+
+//! The maximum number of pending work items.
+inline constexpr stl::size_t max_work_count {64};
+
+//! The priority of the worker thread.
+inline constexpr stl::size_t work_thd_priority {31};
+
+/**
+ * @brief Enqueue a work item to be run by the worker thread.
+ *
+ * @details
+ * It never blocks and can be called by interrupt handlers.
+ *
+ * @return Whether the work item is enqueued. It returns @p false if the work queue is full.
+ */
+bool ScheduleWork(Work::Callback callback, void* arg = nullptr) noexcept;
+
+//! Initialize the work queue and start the worker thread.
+void InitWorkQueue() noexcept;
+
+}  // namespace intr
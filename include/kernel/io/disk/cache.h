@@ -0,0 +1,243 @@
+/**
+ * @file cache.h
+ * @brief The block buffer cache.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/io/disk/disk.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/mutex.h"
+#include "kernel/util/block_queue.h"
+#include "kernel/util/metric.h"
+#include "kernel/util/tag_list.h"
+
+namespace io {
+
+/**
+ * @brief The block buffer cache between file systems and disks.
+ *
+ * @details
+ * It caches sectors keyed by disks and LBAs, so hot metadata such as index nodes and directory entries is served from memory.
+ * - Buffers are indexed by a hash table.
+ * - Unused buffers are evicted in the least recently used order.
+ * - A buffer is reference-counted while it is being used, and cannot be evicted.
+ * - Writes only mark buffers as dirty. A flusher thread writes dirty buffers back to disks periodically.
+ *   A dirty buffer is also written back before it is evicted.
+ * - Sectors can be prefetched asynchronously by a readahead thread.
+ *
+ * @warning
+ * Sectors accessed by the cache should not be accessed by @p Disk::ReadSectors or @p Disk::WriteSectors directly,
+ * otherwise the cache becomes incoherent.
+ */
+class BlockCache {
+public:
+    //! The number of buffers.
+    static constexpr stl::size_t buf_count {256};
+
+    //! The number of hash buckets.
+    static constexpr stl::size_t bucket_count {32};
+
+    //! The interval between two write-backs of the flusher thread.
+    static constexpr stl::size_t flush_interval {SecondsToMilliseconds(1)};
+
+    //! The maximum number of contiguous sectors transferred by a single command of the cache.
+    static constexpr stl::size_t max_run_count {32};
+
+    //! The maximum number of pending prefetch requests.
+    static constexpr stl::size_t max_prefetch_req_count {16};
+
+    BlockCache() noexcept = default;
+
+    BlockCache(const BlockCache&) = delete;
+
+    /**
+     * @brief Read sectors through the cache.
+     *
+     * @details
+     * Each run of contiguous sectors that are not cached is read with a single disk command.
+     *
+     * @warning
+     * The buffer must be in kernel memory, since another thread may transfer the data.
+     */
+    BlockCache& Read(const Disk&, stl::size_t lba, void* buf, stl::size_t count = 1) noexcept;
+
+    //! Write sectors to the cache. They are written to the disk later.
+    BlockCache& Write(Disk&, stl::size_t lba, const void* data, stl::size_t count = 1) noexcept;
+
+    /**
+     * @brief Read bytes from sectors through the cache.
+     *
+     * @details
+     * It is used for records smaller than a sector, such as index nodes.
+     * Only the requested bytes are copied, so the caller does not need a buffer of whole sectors.
+     *
+     * @param offset The offset of the first byte in the sector.
+     * @param size The number of bytes.
+     */
+    BlockCache& ReadBytes(const Disk&, stl::size_t lba, stl::size_t offset, void* buf,
+                          stl::size_t size) noexcept;
+
+    /**
+     * @brief Overwrite bytes in sectors in the cache. They are written to the disk later.
+     *
+     * @details
+     * The rest of a sector that is not cached is loaded first.
+     * Each sector is modified under its buffer lock, so concurrent writes of different records in the same sector are not lost.
+     */
+    BlockCache& WriteBytes(Disk&, stl::size_t lba, stl::size_t offset, const void* data,
+                           stl::size_t size) noexcept;
+
+    /**
+     * @brief Drop cached sectors without writing them back.
+     *
+     * @details
+     * It is used for freed blocks, whose data is no longer needed.
+     * The sectors are loaded from the disk again when they are accessed next time.
+     */
+    BlockCache& Discard(const Disk&, stl::size_t lba, stl::size_t count = 1) noexcept;
+
+    //! Write all dirty buffers back to disks.
+    BlockCache& Flush() noexcept;
+
+    /**
+     * @brief Prefetch contiguous sectors into the cache asynchronously.
+     *
+     * @details
+     * The request is dropped if there are too many pending requests.
+     */
+    BlockCache& Prefetch(const Disk&, stl::size_t lba, stl::size_t count) noexcept;
+
+    /**
+     * @brief Load contiguous sectors into the cache and copy them to a buffer.
+     *
+     * @details
+     * Sectors already in the cache are not reloaded.
+     * Each run of the others is read straight into the buffer with a single disk command.
+     * If buffers run short, the sectors are loaded in smaller chunks,
+     * and no buffer is held while waiting for a free one.
+     *
+     * @param buf A buffer of @p count sectors.
+     * @param prefetch
+     * Whether the load is a prefetch request.
+     * Prefetched sectors are not counted as cache hits or misses, since no one has accessed them yet.
+     */
+    BlockCache& Load(const Disk&, stl::size_t lba, stl::size_t count, void* buf,
+                     bool prefetch = false) noexcept;
+
+    //! Wait for a prefetch request and run it. It is called by the readahead thread.
+    BlockCache& RunPrefetch(void* staging) noexcept;
+
+    //! Allocate the memory of buffers.
+    BlockCache& Init() noexcept;
+
+private:
+    //! A cached sector.
+    struct Buffer {
+        static Buffer& GetByHashTag(const TagList::Tag&) noexcept;
+
+        static Buffer& GetByLruTag(const TagList::Tag&) noexcept;
+
+        //! The tag for a hash bucket.
+        TagList::Tag hash_tag;
+
+        //! The tag for the least recently used list.
+        TagList::Tag lru_tag;
+
+        //! The disk of the sector, or @p nullptr if the buffer has not been used.
+        const Disk* disk {nullptr};
+
+        stl::size_t lba {0};
+
+        //! The number of users. It is protected by the cache lock.
+        stl::size_t ref_count {0};
+
+        //! Whether the data has been loaded from the disk. It is protected by the buffer lock.
+        bool valid {false};
+
+        //! Whether the data has not been written back. It is protected by the buffer lock.
+        bool dirty {false};
+
+        //! The lock for the data.
+        stl::mutex lock;
+
+        stl::byte* data {nullptr};
+    };
+
+    //! A request to prefetch contiguous sectors.
+    struct PrefetchReq {
+        const Disk* disk;
+        stl::size_t lba;
+        stl::size_t count;
+    };
+
+    static stl::size_t GetBucketIdx(const Disk*, stl::size_t lba) noexcept;
+
+    /**
+     * @brief Get the buffer of a sector and add a reference to it.
+     *
+     * @details
+     * If the sector is not cached, the least recently used unused buffer is reused.
+     * Its data is invalid until it is loaded.
+     * If all buffers are being used, it waits until one is released.
+     * The caller must not hold references to other buffers, or it may wait forever.
+     */
+    Buffer& Get(const Disk&, stl::size_t lba) noexcept;
+
+    /**
+     * @brief Get the buffer of a sector and add a reference to it without waiting.
+     *
+     * @return The buffer, or @p nullptr if the sector is not cached and all buffers are being used.
+     */
+    Buffer* TryGet(const Disk&, stl::size_t lba) noexcept;
+
+    //! Remove a reference from a buffer.
+    BlockCache& Release(Buffer&) noexcept;
+
+    //! Write a buffer back to the disk if it is dirty.
+    BlockCache& WriteBack(Buffer&) noexcept;
+
+    /**
+     * @brief Write a buffer back to the disk if it is dirty,
+     * together with the following dirty sectors with a single disk command.
+     *
+     * @param staging A buffer of @p max_run_count sectors.
+     */
+    BlockCache& WriteBack(Buffer&, void* staging) noexcept;
+
+    //! Find the buffer of a sector. The cache lock must be held.
+    Buffer* Find(const Disk*, stl::size_t lba) const noexcept;
+
+    //! Move a buffer to the end of the least recently used list. The cache lock must be held.
+    BlockCache& Touch(Buffer&) noexcept;
+
+    //! The lock for the hash table, the least recently used list and reference counts.
+    stl::mutex lock_;
+
+    stl::array<Buffer, buf_count> bufs_;
+
+    mutable stl::array<TagList, bucket_count> buckets_;
+
+    //! Buffers from the least recently used one to the most recently used one.
+    mutable TagList lru_;
+
+    //! The lock for flushing, since its staging buffer is shared.
+    stl::mutex flush_lock_;
+
+    //! The staging buffer for writing runs of dirty sectors back.
+    stl::byte* flush_staging_ {nullptr};
+
+    //! Pending prefetch requests. It is protected by disabling interrupts.
+    BlockQueue<PrefetchReq, max_prefetch_req_count> prefetch_reqs_;
+};
+
+//! Get the block buffer cache.
+BlockCache& GetBlockCache() noexcept;
+
+//! Initialize the block buffer cache and start its flusher and readahead threads.
+void InitBlockCache() noexcept;
+
+}  // namespace io
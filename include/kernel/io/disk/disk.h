@@ -11,10 +11,14 @@
 #include "kernel/io/disk/file/dir.h"
 #include "kernel/io/disk/file/file.h"
 #include "kernel/stl/array.h"
+#include "kernel/stl/mutex.h"
+#include "kernel/stl/shared_mutex.h"
 #include "kernel/stl/string_view.h"
 #include "kernel/util/bit.h"
 #include "kernel/util/bitmap.h"
+#include "kernel/util/block_queue.h"
 #include "kernel/util/metric.h"
+#include "kernel/util/tag_hash_table.h"
 #include "kernel/util/tag_list.h"
 
 namespace io {
@@ -28,7 +32,50 @@ class Directory;
 class DirEntry;
 }  // namespace fs
 
+/**
+ * @brief I/O statistics of a disk or a partition.
+ *
+ * @details
+ * It has the same layout as @p usr::io::DiskStats.
+ * Latencies are measured in cycles by the time-stamp counter from submitting a request to its completion,
+ * so they include the time waiting in the queue.
+ * Commands, busy-wait timeouts and queue depths are only counted for disks.
+ */
+struct DiskStats {
+    //! The number of buckets in the latency histogram.
+    static constexpr stl::size_t latency_bucket_count {32};
+
+    //! The number of read requests.
+    stl::size_t read_count;
+    //! The number of write requests.
+    stl::size_t write_count;
+    //! The number of read sectors.
+    stl::size_t read_sector_count;
+    //! The number of written sectors.
+    stl::size_t write_sector_count;
+    //! The number of requests merged into the commands of other requests.
+    stl::size_t merged_count;
+    //! The number of disk commands.
+    stl::size_t cmd_count;
+    //! The number of interrupts that did not arrive in time, or busy waits after which the disk was still busy.
+    stl::size_t timeout_count;
+    //! The number of requests in the queue.
+    stl::size_t queue_depth;
+    //! The maximum number of requests in the queue.
+    stl::size_t max_queue_depth;
+    //! The number of sectors found in the block cache.
+    stl::size_t cache_hit_count;
+    //! The number of sectors loaded into the block cache from the disk.
+    stl::size_t cache_miss_count;
+    //! The total latency of all requests.
+    stl::uint64_t total_cycles;
+    //! The bucket @p i counts requests taking @p [2^i, 2^(i+1)) cycles.
+    stl::size_t latencies[latency_bucket_count];
+};
+
 class Disk {
+    friend class IdeChnl;
+
 public:
     //! The sector size.
     static constexpr stl::size_t sector_size {512};
@@ -36,10 +83,14 @@ public:
     static constexpr stl::size_t prim_part_count {4};
     //! The maximum supported number of logical partitions.
     static constexpr stl::size_t max_logic_part_count {8};
-    //! The maximum supported disk size.
-    static constexpr stl::size_t max_size {MB(80)};
-    //! The maximum LBA.
-    static constexpr stl::size_t max_lba {max_size / sector_size - 1};
+    //! The maximum number of sectors that can be addressed by 28-bit LBAs.
+    static constexpr stl::size_t max_lba28_sector_count {1 << 28};
+    //! The maximum number of sectors that can be manipulated per disk access with 28-bit LBAs.
+    static constexpr stl::size_t max_sector_count_per_access {256};
+    //! The maximum number of sectors that can be manipulated per disk access with 48-bit LBAs.
+    static constexpr stl::size_t max_ext_sector_count_per_access {65536};
+    //! The time to wait for the interrupt of a command before polling the disk.
+    static constexpr stl::size_t intr_timeout {SecondsToMilliseconds(5)};
 
     //! The partition.
     class Part {
@@ -70,6 +121,9 @@ public:
 
         bool IsValid() const noexcept;
 
+        //! Get I/O statistics of the partition.
+        DiskStats GetStats() const noexcept;
+
     protected:
         static constexpr stl::size_t name_len {8};
 
@@ -78,9 +132,19 @@ public:
         stl::size_t sector_count_ {0};
         stl::array<char, name_len + 1> name_;
         Disk* disk_ {nullptr};
+
+        //! I/O statistics. They are protected by disabling interrupts.
+        mutable DiskStats stats_ {};
     };
 
-    //! The file partition.
+    /**
+     * @brief The file partition.
+     *
+     * @details
+     * Each partition has a reader-writer lock.
+     * Reading files and directories and looking up paths hold it shared,
+     * while operations changing metadata, such as creating, writing and deleting, hold it exclusively.
+     */
     class FilePart : public Part {
     public:
         static FilePart& GetByTag(const TagList::Tag&) noexcept;
@@ -90,6 +154,15 @@ public:
 
         const fs::SuperBlock& GetSuperBlock() const noexcept;
 
+        /**
+         * @brief Get the usage of the file system.
+         *
+         * @details
+         * Free counts are kept in the super block when blocks and index nodes are allocated or freed,
+         * so it does not scan bitmaps.
+         */
+        FileSysStats GetStats() const noexcept;
+
         /**
          * @brief Open the root directory.
          *
@@ -104,8 +177,46 @@ public:
 
         stl::size_t ReadFile(FileDesc, void* buf, stl::size_t size) const noexcept;
 
+        //! Write data from multiple buffers in one file operation.
+        stl::size_t WriteFile(FileDesc, const IoVec* vecs, stl::size_t count) noexcept;
+
+        //! Read data into multiple buffers in one file operation.
+        stl::size_t ReadFile(FileDesc, const IoVec* vecs, stl::size_t count) const noexcept;
+
         stl::size_t SeekFile(FileDesc, stl::int32_t offset, File::SeekOrigin) const noexcept;
 
+        /**
+         * @brief Reserve blocks for a file.
+         *
+         * @details
+         * Blocks are allocated for the file to grow to the specified size, but its size is not changed.
+         * They are contiguous on the disk whenever possible, so later writes and reads can be coalesced.
+         *
+         * @return Whether the blocks are reserved.
+         */
+        bool ReserveFile(FileDesc, stl::size_t size) noexcept;
+
+        /**
+         * @brief Read data at an offset of a file in the global file table.
+         *
+         * @details
+         * It is used by memory-mapped files. The access offset of the file is moved after the read data.
+         */
+        stl::size_t ReadFileAt(const fs::File&, stl::size_t offset, void* buf,
+                               stl::size_t size) const noexcept;
+
+        /**
+         * @brief Overwrite data at an offset of a file in the global file table.
+         *
+         * @details
+         * It is used by memory-mapped files. Data beyond the end of the file is not written,
+         * so the file never grows. Blocks are updated in place through the block cache.
+         *
+         * @return The number of written bytes.
+         */
+        stl::size_t WriteFileAt(const fs::File&, stl::size_t offset, const void* data,
+                                stl::size_t size) noexcept;
+
         /**
          * @brief Delete a file.
          *
@@ -134,15 +245,52 @@ public:
         fs::Directory* OpenDir(const Path&) const noexcept;
 
         /**
-         * @brief Read the next entry in a directory.
+         * @brief Read the next entry in a directory and move its cursor.
          *
-         * @return A directory entry or @p nullptr if there are no more entries.
+         * @param[out] entry The read entry.
+         * @return Whether an entry is read. It is @p false if there are no more entries.
          */
-        fs::DirEntry* ReadDir(const fs::Directory&) const noexcept;
+        bool ReadDir(const fs::Directory&, fs::DirEntry& entry) const noexcept;
+
+        /**
+         * @brief Read multiple entries in a directory from a cursor.
+         *
+         * @details
+         * Reading resumes from the cursor's block and slot, and only reads the sectors after it.
+         *
+         * @param[in, out] cursor The position to read from. It is moved after the read entries.
+         * @param[out] entries A buffer for entries.
+         * @param count The maximum number of entries to read.
+         * @return The number of read entries. It is less than @p count if there are no more entries.
+         */
+        stl::size_t ReadDir(const fs::Directory&, fs::Directory::Cursor& cursor,
+                            fs::DirEntry* entries, stl::size_t count) const noexcept;
+
+        //! Open a directory by its path and read multiple entries from a cursor.
+        stl::size_t ReadDir(const Path&, fs::Directory::Cursor& cursor, fs::DirEntry* entries,
+                            stl::size_t count) const noexcept;
 
         //! Delete a subdirectory from a directory.
         bool DeleteDir(fs::Directory& parent, const fs::Directory& child) noexcept;
 
+        /**
+         * @brief Write modified metadata and all dirty cached sectors to the disk.
+         *
+         * @details
+         * Bitmap sectors and index nodes are only marked as dirty when they are modified.
+         * They are written to the block cache periodically or by this method,
+         * so multiple updates of the same sector are merged.
+         */
+        FilePart& Sync() noexcept;
+
+        /**
+         * @brief Write modified bitmap sectors and index nodes to the block cache.
+         *
+         * @details
+         * It is called periodically by the metadata flusher thread.
+         */
+        FilePart& FlushMeta() noexcept;
+
     private:
         enum class BitmapType {
             Node,
@@ -176,6 +324,10 @@ public:
         /**
          * @brief Search an entry in a directory.
          *
+         * @details
+         * The result is looked up in and saved to the directory entry cache,
+         * including the absence of the entry.
+         *
          * @param name An entry name.
          * @param[out] found_entry The found entry.
          * @return Whether the entry is found.
@@ -183,6 +335,10 @@ public:
         bool SearchDirEntry(const fs::Directory&, stl::string_view name,
                             fs::DirEntry& found_entry) const noexcept;
 
+        //! Search an entry in a directory by its hashed index or by scanning its blocks.
+        bool SearchDirEntryOnDisk(const fs::Directory&, stl::string_view name,
+                                  fs::DirEntry& found_entry) const noexcept;
+
         //! Synchronize an entry in a directory to the partition.
         bool SyncDirEntry(fs::Directory&, const fs::DirEntry&, void* io_buf,
                           stl::size_t io_buf_size) noexcept;
@@ -221,11 +377,11 @@ public:
         FileDesc CreateFile(fs::Directory&, stl::string_view name,
                             bit::Flags<File::OpenMode> flags) noexcept;
 
-        stl::size_t ReadFile(const fs::File&, void* buf, stl::size_t size) const noexcept;
+        stl::size_t ReadFile(const fs::File&, const IoVec* vecs, stl::size_t count) const noexcept;
 
         stl::size_t SeekFile(fs::File&, stl::int32_t offset, File::SeekOrigin) const noexcept;
 
-        stl::size_t WriteFile(fs::File&, const void* data, stl::size_t size) noexcept;
+        stl::size_t WriteFile(fs::File&, const IoVec* vecs, stl::size_t count) noexcept;
 
         //! Open a file by its index node ID.
         FileDesc OpenFile(stl::size_t inode_idx, bit::Flags<File::OpenMode> flags) const noexcept;
@@ -240,9 +396,56 @@ public:
         /**
          * @brief Allocate a block from the bitmap.
          *
+         * @param hint The preferred block LBA.
          * @return The block LBA or @p npos if there is no free block.
          */
-        stl::size_t AllocBlock() const noexcept;
+        stl::size_t AllocBlock(stl::size_t hint = npos) const noexcept;
+
+        /**
+         * @brief Allocate contiguous blocks from the bitmap.
+         *
+         * @param count The number of blocks.
+         * @param hint The preferred LBA of the first block.
+         * @return The LBA of the first block or @p npos if there are no enough contiguous free blocks.
+         */
+        stl::size_t AllocBlocks(stl::size_t count, stl::size_t hint = npos) const noexcept;
+
+        /**
+         * @brief Allocate an index node's blocks in the range <tt>[begin, end)</tt>.
+         *
+         * @details
+         * Reserved blocks are kept.
+         * New blocks are allocated as a contiguous run after the previous block whenever possible.
+         * If the allocation fails, blocks allocated before the failure are kept as reserved blocks.
+         *
+         * @return Whether the blocks are allocated.
+         */
+        bool AllocNodeBlocks(fs::IdxNode&, stl::size_t begin, stl::size_t end) noexcept;
+
+        /**
+         * @brief Create the indirect block tables required by an index node's block.
+         *
+         * @details
+         * New tables are empty. A block in double indirect blocks requires both
+         * the double indirect block table and the second-level table containing it.
+         *
+         * @param idx The index of a block in the index node.
+         * @return Whether the tables exist.
+         */
+        bool PrepareNodeTab(fs::IdxNode&, stl::size_t idx) noexcept;
+
+        /**
+         * @brief Save LBAs of new blocks to an index node.
+         *
+         * @details
+         * The blocks must share a block table, which has been created by @p PrepareNodeTab.
+         *
+         * @param begin The index of the first block in the index node.
+         * @param lbas The LBAs of allocated blocks.
+         * @param count The number of blocks.
+         */
+        FilePart& SetNodeLbas(fs::IdxNode&, stl::size_t begin, const stl::size_t* lbas,
+                              stl::size_t count) noexcept;
 
         //! Free an index node to the bitmap.
         const FilePart& FreeNode(stl::size_t idx) const noexcept;
@@ -253,6 +456,9 @@ public:
         /**
          * @brief Synchronize an index node's bit from the in-memory bitmap to the partition.
          *
+         * @details
+         * The bitmap sector is only marked as dirty. It is written back by @p FlushMeta.
+         *
          * @param idx An index node ID.
          */
         FilePart& SyncNodeBitmap(stl::size_t idx) noexcept;
@@ -260,6 +466,9 @@ public:
         /**
          * @brief Synchronize a block's bit from the in-memory bitmap to the partition.
          *
+         * @details
+         * The bitmap sector is only marked as dirty. It is written back by @p FlushMeta.
+         *
          * @param idx A block LBA.
          */
         FilePart& SyncBlockBitmap(stl::size_t lba) noexcept;
@@ -275,14 +484,40 @@ public:
          * - The blocks.
          * - The single indirect block table.
          * - The index node.
+         *
+         * Only bitmaps are changed. Neither the index node nor its blocks are zero-filled.
+         * Double indirect blocks are freed later by @p ReclaimBlocks, so deleting a large file does not read all its block tables.
          */
         FilePart& DeleteNode(stl::size_t idx) noexcept;
 
-        //! Zero-fill an index node in the partition.
-        FilePart& ZeroFillNode(stl::size_t idx, void* io_buf, stl::size_t io_buf_size) noexcept;
+        /**
+         * @brief Free the double indirect blocks, their second-level tables and the double indirect block table of a deleted index node.
+         *
+         * @param outer_tab_lba The LBA of the double indirect block table.
+         */
+        FilePart& FreeDoubleIndirectBlocks(stl::size_t outer_tab_lba) noexcept;
 
-        //! Synchronize an index node to the partition.
-        FilePart& SyncNode(const fs::IdxNode&, void* io_buf, stl::size_t io_buf_size) noexcept;
+        //! Free the double indirect blocks of deleted index nodes whose freeing has been deferred.
+        FilePart& ReclaimBlocks() noexcept;
+
+        /**
+         * @brief Synchronize an index node to the partition.
+         *
+         * @details
+         * Only the bytes of the index node are written to the cached sectors, without a read-modify-write of whole sectors.
+         */
+        FilePart& SyncNode(const fs::IdxNode&) noexcept;
+
+        /**
+         * @brief Mark an open index node as modified.
+         *
+         * @details
+         * A dirty index node holds an extra reference so it stays open until @p FlushMeta writes it back.
+         */
+        FilePart& MarkNodeDirty(fs::IdxNode&) noexcept;
+
+        //! Discard the modification of an open index node, which is being deleted.
+        FilePart& DropNodeDirty(fs::IdxNode&) noexcept;
 
         //! Load the block bitmap from the partition.
         const FilePart& LoadBlockBitmap() const noexcept;
@@ -290,11 +525,29 @@ public:
         //! Load the index node bitmap from the partition.
         const FilePart& LoadNodeBitmap() const noexcept;
 
-        //! Synchronize a bit in an in-memory bitmap to the partition.
+        //! Mark the sector of a bit in an in-memory bitmap as dirty.
         FilePart& SyncBitmap(BitmapType, stl::size_t bit_idx) noexcept;
 
+        //! Write a sector of an in-memory bitmap to the block cache.
+        FilePart& WriteBitmapSector(BitmapType, stl::size_t sector_idx) noexcept;
+
+        /**
+         * @brief Count free blocks and index nodes in bitmaps and update the free-space summary.
+         *
+         * @details
+         * It is called at mount and whenever a count would underflow or overflow.
+         * The super block is marked as dirty only if the summary changes.
+         */
+        const FilePart& RebuildSummary() const noexcept;
+
+        //! Write the super block to the block cache.
+        FilePart& WriteSuperBlock() noexcept;
+
         fs::SuperBlock* super_block_ {nullptr};
 
+        //! Whether the free-space summary in the super block has not been written to the block cache.
+        mutable bool super_block_dirty_ {false};
+
         /**
          * @brief The block bitmap.
          *
@@ -313,8 +566,40 @@ public:
          */
         mutable Bitmap inode_bitmap_;
 
-        //! The list of open index nodes.
-        mutable TagList open_inodes_;
+        /**
+         * @brief Bitmap sectors that have not been written to the block cache.
+         *
+         * @details
+         * Its bits start with block bitmap sectors, followed by index node bitmap sectors.
+         */
+        Bitmap dirty_bitmap_sectors_;
+
+        //! The maximum number of deleted index nodes whose double indirect blocks are waiting to be freed.
+        static constexpr stl::size_t max_pending_double_indirect_tab_count {16};
+
+        /**
+         * @brief The double indirect block tables of deleted index nodes.
+         *
+         * @details
+         * Their blocks stay allocated until @p ReclaimBlocks frees them. It is protected by disabling interrupts.
+         */
+        BlockQueue<stl::size_t, max_pending_double_indirect_tab_count>
+            pending_double_indirect_tabs_;
+
+        //! The number of hash buckets of open index nodes.
+        static constexpr stl::size_t open_inode_bucket_count {64};
+
+        //! The table of open index nodes, hashed by their IDs.
+        mutable TagHashTable<open_inode_bucket_count> open_inodes_;
+
+        //! The lock for opening index nodes, since path lookups can run at the same time.
+        mutable stl::mutex inode_lock_;
+
+        //! The lock for building directory indexes, since path lookups can run at the same time.
+        mutable stl::mutex dir_index_lock_;
+
+        //! The lock for file system metadata.
+        mutable stl::shared_mutex meta_lock_;
     };
 
     //! Disk information.
@@ -329,6 +614,12 @@ public:
 
         stl::size_t GetSectorCount() const noexcept;
 
+        //! Whether the disk supports DMA transfers.
+        bool IsDmaSupported() const noexcept;
+
+        //! Whether the disk supports the 48-bit address feature set.
+        bool IsLba48Supported() const noexcept;
+
     private:
         static constexpr stl::size_t serial_len {20};
         static constexpr stl::size_t model_len {40};
@@ -336,6 +627,8 @@ public:
         stl::array<char, serial_len + 1> serial_;
         stl::array<char, model_len + 1> model_;
         stl::size_t sector_count_ {0};
+        bool dma_ {false};
+        bool lba48_ {false};
     };
 
     using PrimaryParts = stl::array<FilePart, prim_part_count>;
@@ -347,6 +640,18 @@ public:
         Read = 0x20,
         //! Write data.
         Write = 0x30,
+        //! Read data by DMA.
+        ReadDma = 0xC8,
+        //! Write data by DMA.
+        WriteDma = 0xCA,
+        //! Read data with 48-bit LBAs.
+        ReadExt = 0x24,
+        //! Write data with 48-bit LBAs.
+        WriteExt = 0x34,
+        //! Read data by DMA with 48-bit LBAs.
+        ReadDmaExt = 0x25,
+        //! Write data by DMA with 48-bit LBAs.
+        WriteDmaExt = 0x35,
         //! Identify device data.
         Identify = 0xEC
     };
@@ -358,6 +663,9 @@ public:
     /**
      * @brief Read words from the disk.
      *
+     * @details
+     * The request is queued to the IDE channel and the current thread sleeps until it is completed.
+     *
      * @note
      * The disk can only read or write a word once, cannot operate bytes.
      */
@@ -366,6 +674,9 @@ public:
     /**
      * @brief Write words to the disk.
      *
+     * @details
+     * The request is queued to the IDE channel and the current thread sleeps until it is completed.
+     *
      * @note
      * The disk can only read or write a word once, cannot operate bytes.
      */
@@ -374,12 +685,45 @@ public:
     //! Attach the disk to an IDE channel.
     Disk& Attach(IdeChnl* ide_chnl, stl::size_t idx) noexcept;
 
-    //! Scan and initialize partitions.
+    /**
+     * @brief Scan and initialize partitions if they have not been scanned.
+     *
+     * @details
+     * Partitions are scanned on demand instead of at boot. The boot disk has no partitions to scan.
+     */
     Disk& ScanParts() noexcept;
 
     //! Get disk information.
     Info GetInfo() const noexcept;
 
+    /**
+     * @brief Enable bus-master DMA transfers.
+     *
+     * @details
+     * The IDE channel must support bus-master DMA. Otherwise, the disk uses PIO transfers.
+     */
+    Disk& EnableDma(bool enable = true) noexcept;
+
+    bool IsDmaEnabled() const noexcept;
+
+    /**
+     * @brief Enable 48-bit LBAs, which use the extended commands of up to 65536 sectors.
+     *
+     * @details
+     * The disk must support the 48-bit address feature set. Otherwise, it uses 28-bit LBAs.
+     */
+    Disk& EnableLba48(bool enable = true) noexcept;
+
+    bool IsLba48Enabled() const noexcept;
+
+    //! Get the maximum number of sectors that can be manipulated per disk access.
+    stl::size_t GetMaxSectorCountPerAccess() const noexcept;
+
+    //! Set the number of sectors reported by the identify data, which bounds all accesses.
+    Disk& SetSectorCount(stl::size_t) noexcept;
+
+    stl::size_t GetSectorCount() const noexcept;
+
     const PrimaryParts& GetPrimaryParts() const noexcept;
 
     const LogicParts& GetLogicParts() const noexcept;
@@ -400,6 +744,16 @@ public:
 
     Disk& SetName(stl::string_view) noexcept;
 
+    //! Get I/O statistics of the disk.
+    DiskStats GetStats() const noexcept;
+
+    /**
+     * @brief Record an access to a sector through the block cache.
+     *
+     * @param hit Whether the sector is cached.
+     */
+    const Disk& RecordCacheAccess(stl::size_t lba, bool hit) const noexcept;
+
 private:
     static constexpr stl::size_t name_len {8};
 
@@ -419,12 +773,38 @@ private:
     /**
      * @brief Wait for a while when the disk is busy.
      *
+     * @details
+     * It polls the status register. Commands are completed by interrupts,
+     * so it is only used before writing the first sector by PIO, or as a recovery when an interrupt is lost.
+     *
      * @return Whether the data is prepared.
      */
     bool BusyWait() const noexcept;
 
+    /**
+     * @brief Sleep until the disk raises an interrupt for the last command.
+     *
+     * @details
+     * If the interrupt does not arrive within @p intr_timeout, the status register is polled by @p BusyWait.
+     *
+     * @param data Whether the disk should have data prepared for transfers.
+     * @return Whether the command succeeded.
+     */
+    bool WaitForIntr(bool data) const noexcept;
+
     const Disk& ReadWords(void* buf, stl::size_t count = 1) const noexcept;
 
+    //! Find the partition containing a sector.
+    Part* FindPart(stl::size_t lba) const noexcept;
+
+    /**
+     * @brief Record a completed request.
+     *
+     * @param cycles The number of cycles from submitting the request to its completion.
+     */
+    const Disk& RecordRequest(stl::size_t lba, stl::size_t count, bool write,
+                              stl::uint64_t cycles) const noexcept;
+
     Disk& WriteWords(const void* data, stl::size_t count = 1) noexcept;
 
     /**
@@ -497,6 +877,21 @@ private:
 
     //! The index of the disk under the IDE channel.
     stl::size_t idx_ {0};
+
+    //! Whether the disk uses bus-master DMA transfers.
+    bool dma_ {false};
+
+    //! Whether the disk uses 48-bit LBAs.
+    bool lba48_ {false};
+
+    //! Whether partitions have been scanned.
+    bool parts_scanned_ {false};
+
+    //! The number of sectors.
+    stl::size_t sector_count_ {0};
+
+    //! I/O statistics. They are protected by disabling interrupts.
+    mutable DiskStats stats_ {};
 };
 
 //! The index of the boot disk.
@@ -516,12 +911,40 @@ void InitDisk() noexcept;
 //! Whether disks have been initialized.
 bool IsDiskInited() noexcept;
 
+/**
+ * @brief Find a partition by its name, such as @p sdb1.
+ *
+ * @details
+ * Partitions of its disk are scanned if they have not been scanned.
+ *
+ * @return The partition, or @p nullptr if it is not found.
+ */
+Disk::FilePart* FindDiskPart(stl::string_view name) noexcept;
+
 //! Initialize the file system.
 void InitFileSys() noexcept;
 
 //! Get the default partition.
 Disk::FilePart& GetDefaultPart() noexcept;
 
+//! System calls.
+namespace sc {
+
+class Disk {
+public:
+    Disk() = delete;
+
+    /**
+     * @brief Get I/O statistics of a disk or a partition.
+     *
+     * @param name The name of a disk, such as @p sda, or a partition, such as @p sdb1.
+     * @return Whether the disk or partition is found.
+     */
+    static bool GetStats(const char* name, DiskStats* stats) noexcept;
+};
+
+}  // namespace sc
+
 namespace fs {
 
 //! Get the root directory.
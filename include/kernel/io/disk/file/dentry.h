@@ -0,0 +1,89 @@
+/**
+ * @file dentry.h
+ * @brief The directory entry cache.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/io/disk/file/dir.h"
+#include "kernel/stl/mutex.h"
+
+namespace io::fs {
+
+/**
+ * @brief The directory entry cache for path lookups.
+ *
+ * @details
+ * It maps a partition, a parent directory's index node ID and a name to a directory entry,
+ * so repeated lookups of the same path do not search directories.
+ * - A positive entry saves the found directory entry.
+ * - A negative entry records that the name does not exist in the directory.
+ *
+ * The cache is direct-mapped. A new entry replaces the old one in the same slot.
+ * Names longer than @p Path::max_name_len are not cached.
+ */
+class DentryCache {
+public:
+    //! The number of cached entries.
+    static constexpr stl::size_t slot_count {128};
+
+    /**
+     * @brief Look up a name in a directory.
+     *
+     * @param part A partition.
+     * @param parent_idx The index node ID of the parent directory.
+     * @param name A name.
+     * @param[out] entry The found entry. Its type is @p FileType::Unknown for a negative entry.
+     * @return Whether the name is cached.
+     */
+    bool Find(const void* part, stl::size_t parent_idx, stl::string_view name,
+              DirEntry& entry) const noexcept;
+
+    /**
+     * @brief Cache the result of a lookup.
+     *
+     * @param entry The found entry, or @p nullptr if the name does not exist.
+     */
+    DentryCache& Insert(const void* part, stl::size_t parent_idx, stl::string_view name,
+                        const DirEntry* entry) noexcept;
+
+    //! Remove the entry of a name in a directory.
+    DentryCache& Erase(const void* part, stl::size_t parent_idx, stl::string_view name) noexcept;
+
+    /**
+     * @brief Remove all entries referring to an index node or in a directory.
+     *
+     * @details
+     * It is used when an index node is deleted, since its ID can be reused by a new file or directory.
+     */
+    DentryCache& Erase(const void* part, stl::size_t inode_idx) noexcept;
+
+private:
+    struct Slot {
+        bool IsUsed() const noexcept;
+
+        bool Match(const void* part, stl::size_t parent_idx,
+                   stl::string_view name) const noexcept;
+
+        //! The partition, or @p nullptr if the slot is free.
+        const void* part;
+        stl::size_t parent_idx;
+        //! The cached entry, whose type is @p FileType::Unknown for a negative entry.
+        DirEntry entry;
+    };
+
+    static stl::size_t GetSlotIdx(const void* part, stl::size_t parent_idx,
+                                  stl::string_view name) noexcept;
+
+    stl::array<Slot, slot_count> slots_ {};
+
+    mutable stl::mutex lock_;
+};
+
+//! Get the directory entry cache.
+DentryCache& GetDentryCache() noexcept;
+
+}  // namespace io::fs
@@ -26,6 +26,21 @@ struct Directory {
      */
     static constexpr stl::size_t min_entry_count {2};
 
+    /**
+     * @brief The position of the next directory entry to read.
+     *
+     * @details
+     * It refers to an entry slot instead of counting entries,
+     * so reading can resume without scanning from the beginning,
+     * and deleting entries that have been read does not skip the remaining ones.
+     */
+    struct Cursor {
+        //! The index of the block in the index node.
+        stl::size_t block_idx {0};
+        //! The index of the entry slot in the block.
+        stl::size_t slot_idx {0};
+    };
+
     Directory() noexcept = default;
 
     Directory(const Directory&) = delete;
@@ -40,7 +55,7 @@ struct Directory {
 
     stl::size_t GetNodeIdx() const noexcept;
 
-    //! Reset the access offset to the begging of the directory.
+    //! Reset the cursor to the beginning of the directory.
     void Rewind() noexcept;
 
     /**
@@ -51,8 +66,8 @@ struct Directory {
      */
     IdxNode* inode {nullptr};
 
-    //! The access offset.
-    mutable stl::size_t pos {0};
+    //! The read cursor.
+    mutable Cursor cursor;
 };
 
 enum class FileType { Unknown, Regular, Directory };
@@ -112,6 +127,16 @@ struct DirEntry {
 
     DirEntry& SetName(stl::string_view) noexcept;
 
+    /**
+     * @brief Whether the entry has a name.
+     *
+     * @details
+     * It is called for every entry scanned in a directory, so most entries are rejected in constant time:
+     * the stored name must end at the length of the name, and their first characters must be equal.
+     * The name does not need to end with a null character.
+     */
+    bool HasName(stl::string_view) const noexcept;
+
     //! The entry type.
     FileType type {FileType::Unknown};
 
@@ -0,0 +1,97 @@
+/**
+ * @file dir_index.h
+ * @brief The in-memory hashed directory index.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/stl/string_view.h"
+#include "kernel/util/tag_list.h"
+
+namespace io::fs {
+
+/**
+ * @brief A hash table mapping the names of a directory's entries to their positions on the disk.
+ *
+ * @details
+ * It is built when a directory is searched for the first time after it is opened,
+ * and lives until the directory's index node is closed for the last time.
+ * A lookup only reads the sectors containing entries whose name hashes match,
+ * instead of scanning all blocks of the directory.
+ *
+ * Only hashes and positions are saved, so entries are still read from the disk to compare names.
+ */
+class DirIndex {
+public:
+    //! The number of hash buckets.
+    static constexpr stl::size_t bucket_count {64};
+
+    //! The position of a directory entry on the disk.
+    struct Pos {
+        //! The LBA of the sector containing the entry.
+        stl::size_t lba;
+        //! The index of the entry in the sector.
+        stl::size_t idx;
+    };
+
+    using Visitor = bool (*)(const Pos&, void*) noexcept;
+
+    //! Allocate an empty index.
+    static DirIndex* Create() noexcept;
+
+    //! Free an index and all its entries.
+    static void Destroy(DirIndex*) noexcept;
+
+    DirIndex() noexcept = default;
+
+    DirIndex(const DirIndex&) = delete;
+
+    /**
+     * @brief Add a directory entry.
+     *
+     * @return Whether the entry is added. It fails if there is no free memory.
+     */
+    bool Insert(stl::string_view name, const Pos&) noexcept;
+
+    //! Remove a directory entry.
+    DirIndex& Erase(stl::string_view name, const Pos&) noexcept;
+
+    //! Remove all directory entries in the sectors <tt>[begin_lba, end_lba)</tt>.
+    DirIndex& Erase(stl::size_t begin_lba, stl::size_t end_lba) noexcept;
+
+    /**
+     * @brief Visit the positions of entries that may have a name.
+     *
+     * @param name A name.
+     * @param visitor A visitor. It returns @p true to stop visiting.
+     * @param arg An argument passed to the visitor.
+     * @return Whether the visitor has stopped.
+     */
+    bool Find(stl::string_view name, Visitor visitor, void* arg = nullptr) const noexcept;
+
+private:
+    struct Entry {
+        static Entry& GetByTag(const TagList::Tag&) noexcept;
+
+        //! The tag for a hash bucket.
+        TagList::Tag tag;
+
+        stl::size_t hash;
+
+        Pos pos;
+    };
+
+    //! Calculate the hash of a name.
+    static stl::size_t Hash(stl::string_view) noexcept;
+
+    //! Remove and free all entries.
+    DirIndex& Clear() noexcept;
+
+    stl::array<TagList, bucket_count> buckets_;
+};
+
+}  // namespace io::fs
@@ -10,14 +10,19 @@
 
 #include "kernel/debug/assert.h"
 #include "kernel/io/file/file.h"
-#include "kernel/io/video/print.h"
 #include "kernel/stl/array.h"
 #include "kernel/util/bit.h"
 
+namespace io {
+
+class Pipe;
+
+}  // namespace io
+
 namespace io::fs {
 
 //! The maximum number of files that can be open simultaneously in the system.
-inline constexpr stl::size_t max_open_file_times {32};
+inline constexpr stl::size_t max_open_file_times {1024};
 
 class IdxNode;
 
@@ -28,8 +33,13 @@ struct File {
 
     bool IsOpen() const noexcept;
 
+    //! Whether the file is an end of a pipe instead of a file on the disk.
+    bool IsPipe() const noexcept;
+
     IdxNode& GetNode() const noexcept;
 
+    Pipe& GetPipe() const noexcept;
+
     stl::size_t GetNodeIdx() const noexcept;
 
     File& Clear() noexcept;
@@ -45,8 +55,28 @@ struct File {
      */
     IdxNode* inode {nullptr};
 
+    /**
+     * The pipe if the file is an end of a pipe, otherwise @p nullptr.
+     * The read end is open in @p io::File::OpenMode::ReadOnly and the write end in @p io::File::OpenMode::WriteOnly.
+     */
+    Pipe* pipe {nullptr};
+
     //! The access offset.
     mutable stl::size_t pos {0};
+
+    //! The sequential readahead state.
+    struct Readahead {
+        //! The access offset after the last read, where a sequential read starts.
+        stl::size_t pos {0};
+
+        //! The number of blocks to prefetch after the last read.
+        stl::size_t window {0};
+
+        //! The index of the first block in the file that has not been prefetched.
+        stl::size_t end_block {0};
+    };
+
+    mutable Readahead readahead;
 };
 
 /**
@@ -55,59 +85,104 @@ struct File {
  * @details
  * The open file table saves all open files in the system.
  * A global file descriptor is an index to this table.
+ *
+ * Files are saved in chunks, which are allocated when the table is full, so files never move.
+ * Free descriptors are linked into a stack, so allocating and releasing a descriptor takes constant time.
  */
-template <stl::size_t size>
 class FileTab {
-    static_assert(size > std_stream_count);
-
 public:
+    //! The number of files in a chunk.
+    static constexpr stl::size_t chunk_size {32};
+
+    //! The maximum number of chunks.
+    static constexpr stl::size_t max_chunk_count {max_open_file_times / chunk_size};
+
+    static_assert(max_open_file_times % chunk_size == 0 && chunk_size > std_stream_count);
+
+    FileTab() noexcept = default;
+
+    FileTab(const FileTab&) = delete;
+
     /**
-     * @brief Get a free descriptor.
+     * @brief Allocate a free descriptor.
      *
      * @return A free descriptor or @p npos if there is no free descriptor.
      */
-    FileDesc GetFreeDesc() const noexcept {
-        for (stl::size_t i {std_stream_count}; i != files_.size(); ++i) {
-            if (!files_[i].IsOpen()) {
-                return i;
-            }
-        }
+    FileDesc AllocDesc() noexcept;
+
+    /**
+     * @brief Release a descriptor and close its file if it is open.
+     *
+     * @details
+     * Releasing a free descriptor does nothing.
+     */
+    FileTab& FreeDesc(FileDesc) noexcept;
 
-        io::PrintlnStr("The system file table is full.");
-        return npos;
-    }
+    /**
+     * @brief Get the descriptor of an open file for a forked process.
+     *
+     * @details
+     * - A file on the disk shares the descriptor, and the reference count of its index node is increased by one.
+     * - An end of a pipe gets a new descriptor, so the end can count how many processes have opened it.
+     *
+     * @return A descriptor or @p npos if there is no free descriptor.
+     */
+    FileDesc ForkDesc(FileDesc) noexcept;
 
-    //! Whether an index node is open.
-    bool Contain(const stl::size_t inode_idx) const noexcept {
-        for (stl::size_t i {std_stream_count}; i != files_.size(); ++i) {
-            if (files_[i].IsOpen() && files_[i].GetNodeIdx() == inode_idx) {
-                return true;
-            }
-        }
+    /**
+     * @brief Open the file of a descriptor on the disk again with a new read-only descriptor.
+     *
+     * @details
+     * The new descriptor does not deny other writers.
+     * It is used by the kernel to keep a file open regardless of the descriptor it was opened with.
+     *
+     * @return A descriptor or @p npos if there is no free descriptor.
+     */
+    FileDesc DupDesc(FileDesc) noexcept;
 
-        return false;
-    }
+    //! Whether an index node is open.
+    bool Contain(stl::size_t inode_idx) const noexcept;
 
     //! Get the file by a descriptor.
-    const File& operator[](const FileDesc desc) const noexcept {
-        dbg::Assert(desc < files_.size());
-        return files_[desc];
-    }
+    const File& operator[](FileDesc) const noexcept;
 
-    File& operator[](const FileDesc desc) noexcept {
-        return const_cast<File&>(const_cast<const FileTab&>(*this)[desc]);
-    }
+    File& operator[](FileDesc) noexcept;
 
-    constexpr stl::size_t GetSize() const noexcept {
-        return files_.size();
-    }
+    //! Get the number of descriptors in allocated chunks.
+    stl::size_t GetSize() const noexcept;
 
 private:
-    //! Open files.
-    stl::array<File, size> files_;
+    //! The value of @p Slot::next_free for allocated descriptors.
+    static constexpr stl::size_t used {npos - 1};
+
+    struct Slot {
+        File file;
+
+        /**
+         * The next free descriptor in the stack, @p npos if it is the last one,
+         * or @p used if the descriptor is allocated.
+         */
+        stl::size_t next_free;
+    };
+
+    using Chunk = stl::array<Slot, chunk_size>;
+
+    const Slot& GetSlot(FileDesc) const noexcept;
+
+    Slot& GetSlot(FileDesc) noexcept;
+
+    //! Allocate a new chunk and push its descriptors to the free stack.
+    bool Grow() noexcept;
+
+    stl::array<Chunk*, max_chunk_count> chunks_ {};
+
+    stl::size_t chunk_count_ {0};
+
+    //! The top of the free descriptor stack.
+    stl::size_t free_top_ {npos};
 };
 
 //! Get the open file table.
-FileTab<max_open_file_times>& GetFileTab() noexcept;
+FileTab& GetFileTab() noexcept;
 
 }  // namespace io::fs
\ No newline at end of file
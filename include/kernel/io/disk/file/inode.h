@@ -12,8 +12,14 @@
 #include "kernel/util/metric.h"
 #include "kernel/util/tag_list.h"
 
+namespace mem {
+class SlabCacheBase;
+}
+
 namespace io::fs {
 
+class DirIndex;
+
 /**
  * @brief The index node.
  *
@@ -21,36 +27,72 @@ namespace io::fs {
  * In @em Linux, the index node describes a file system object such as a file or a directory.
  * Each index node stores the attributes and disk block locations of the object's data.
  *
- * In our system, an index node has 12 direct blocks and a single indirect block table.
- * The size of a single indirect block table is one sector, so it can save 128 block addresses.
- * Totally, an index node has up to 140 blocks for data storage.
+ * In our system, an index node has 12 direct blocks, a single indirect block table and a double indirect block table.
+ * The size of an indirect block table is one sector, so it can save 128 block addresses.
+ * Each entry in the double indirect block table is the address of another single indirect block table.
+ * Totally, an index node has up to 12 + 128 + 128 × 128 = 16524 blocks for data storage.
+ *
+ * The double indirect block table is the last member, so the other members keep their layout on legacy file systems.
+ * Legacy index nodes do not have it, and only have up to 140 blocks.
  *
  * @code
- *                      Index Node
- * ┌────────────┬───────────────┬───────────────────────┐
- * │ Attributes │ Direct Blocks │ Single Indirect Block │
- * └────────────┴───────────────┴───────────────────────┘
- *                │          │              │
- *                ▼          ▼              │
- *            ┌───────┐  ┌───────┐          ▼
- *            │ Block │  │ Block │  ┌───────────────┐
- *            └───────┘  └───────┘  │ Direct Blocks │
- *                                  └───────────────┘
- *                                      │        │
- *                                      ▼        ▼
- *                                  ┌───────┐ ┌───────┐
- *                                  │ Block │ │ Block │
- *                                  └───────┘ └───────┘
+ *                                 Index Node
+ * ┌────────────┬───────────────┬───────────────────────┬───────────────────────┐
+ * │ Attributes │ Direct Blocks │ Single Indirect Block │ Double Indirect Block │
+ * └────────────┴───────────────┴───────────────────────┴───────────────────────┘
+ *                │          │              │                       │
+ *                ▼          ▼              ▼                       ▼
+ *            ┌───────┐  ┌───────┐  ┌───────────────┐  ┌────────────────────────┐
+ *            │ Block │  │ Block │  │ Direct Blocks │  │ Single Indirect Blocks │
+ *            └───────┘  └───────┘  └───────────────┘  └────────────────────────┘
+ *                                      │        │            │            │
+ *                                      ▼        ▼            ▼            ▼
+ *                                  ┌───────┐ ┌───────┐ ┌───────────┐ ┌───────────┐
+ *                                  │ Block │ │ Block │ │ Direct    │ │ Direct    │
+ *                                  └───────┘ └───────┘ │ Blocks    │ │ Blocks    │
+ *                                                      └───────────┘ └───────────┘
  * @endcode
  *
+ * An open index node caches its single indirect block table after the table is first loaded.
+ * The cache is kept in the slab object beside the index node, so the layout on the disk is unchanged.
+ *
  * Index nodes do not indicate their data type.
  * Instead, we use directory entries @p DirEntry to determine whether an item is a file or a directory.
  */
 struct IdxNode {
     static constexpr stl::size_t direct_block_count {12};
 
+    //! The number of block LBAs in an indirect block table.
+    static constexpr stl::size_t indirect_block_count {128};
+
+    //! The size of an index node on legacy file systems, which do not have double indirect block tables.
+    static constexpr stl::size_t legacy_size {76};
+
+    /**
+     * @brief The size of an index node slot on sector-aligned file systems.
+     *
+     * @details
+     * It evenly divides the sector size, so no index node is across two sectors.
+     * The padding behind an index node is zero.
+     */
+    static constexpr stl::size_t aligned_size {128};
+
     static IdxNode& GetByTag(const TagList::Tag&) noexcept;
 
+    /**
+     * @brief Allocate an index node from the slab cache of open index nodes.
+     *
+     * @details
+     * It is freed when it is closed for the last time.
+     */
+    static IdxNode* Create() noexcept;
+
+    //! Free an index node allocated by @p Create that has never been opened.
+    static void Destroy(IdxNode*) noexcept;
+
+    //! Get the slab cache of open index nodes.
+    static const mem::SlabCacheBase& GetCache() noexcept;
+
     IdxNode() noexcept;
 
     IdxNode(const IdxNode&) = delete;
@@ -61,25 +103,95 @@ struct IdxNode {
      * @brief Close the index node.
      *
      * @details
-     * If it is not used by any task, it will be removed from the list of open index nodes,
+     * If it is not used by any task, it will be removed from the table of open index nodes,
      * and its memory will be rreed.
      */
     void Close() noexcept;
 
+    /**
+     * @brief Get the cached LBAs in the single indirect block table.
+     *
+     * @details
+     * It can only be used for index nodes allocated by @p Create.
+     *
+     * @return The cached LBAs, or @p nullptr if the table has not been cached.
+     */
+    const stl::size_t* GetCachedIndirectLbas() const noexcept;
+
+    /**
+     * @brief Cache the LBAs in the single indirect block table.
+     *
+     * @details
+     * The table must be cached again whenever it is changed on the disk.
+     * The cache is not a part of the index node's data, so it can be updated on a constant index node.
+     */
+    void CacheIndirectLbas(const stl::size_t* lbas) const noexcept;
+
+    //! Drop the cached single indirect block table.
+    void DropIndirectLbas() const noexcept;
+
+    /**
+     * @brief Get the hashed index of a directory's entries.
+     *
+     * @details
+     * It can only be used for index nodes allocated by @p Create.
+     *
+     * @return The index, or @p nullptr if the index has not been built.
+     */
+    DirIndex* GetDirIndex() const noexcept;
+
+    /**
+     * @brief Set the hashed index of a directory's entries.
+     *
+     * @details
+     * The previous index is freed. The index is freed when the index node is closed for the last time.
+     */
+    void SetDirIndex(DirIndex*) const noexcept;
+
+    //! Free the hashed index of a directory's entries.
+    void DropDirIndex() const noexcept;
+
+    /**
+     * @brief Deny writes to the file while a program image runs it.
+     *
+     * @details
+     * Interrupts must be disabled.
+     *
+     * @return Whether the file is not being written.
+     */
+    bool DenyWriteForExec() const noexcept;
+
+    /**
+     * @brief Allow writes to the file again when a program image closes it.
+     *
+     * @details
+     * Interrupts must be disabled.
+     *
+     * @return Whether no program image runs the file anymore.
+     */
+    bool AllowWriteForExec() const noexcept;
+
+    //! Whether a program image runs the file. Interrupts must be disabled.
+    bool IsExecuting() const noexcept;
+
     bool IsOpen() const noexcept;
 
     stl::size_t GetIndirectTabLba() const noexcept;
 
+    stl::size_t GetDoubleIndirectTabLba() const noexcept;
+
     stl::size_t GetDirectLba(stl::size_t idx) const noexcept;
 
     IdxNode& SetIndirectTabLba(stl::size_t) noexcept;
 
+    IdxNode& SetDoubleIndirectTabLba(stl::size_t) noexcept;
+
     IdxNode& SetDirectLba(stl::size_t idx, stl::size_t lba) noexcept;
 
-    //! Clone a new index node but reset its open times, writing status and tag.
+    //! Clone a new index node but reset its open times, writing and dirty status and tag.
     void CloneToPure(IdxNode&) const noexcept;
 
-    //! The tag for the list of open index nodes.
+    //! The tag for the table of open index nodes.
     TagList::Tag tag;
 
     //! The ID or index.
@@ -100,6 +212,14 @@ struct IdxNode {
     //! Whether the file is being written.
     bool write_deny {false};
 
+    /**
+     * @brief Whether the index node has been modified but not written back.
+     *
+     * @details
+     * It occupies the padding after @p write_deny, so the layout on the disk is unchanged.
+     */
+    bool dirty {false};
+
 private:
     //! The LBAs of direct blocks.
     stl::array<stl::size_t, direct_block_count> direct_lbas_;
@@ -111,6 +231,14 @@ private:
      * Each entry in the single indirect block table is a block's LBA.
      */
     stl::size_t indirect_tab_lba_;
+
+    /**
+     * @brief The LBA of the double indirect block table.
+     *
+     * @details
+     * Each entry in the double indirect block table is a single indirect block table's LBA.
+     */
+    stl::size_t double_indirect_tab_lba_;
 };
 
 //! The index of the root directory's index node.
@@ -46,6 +46,32 @@ public:
     //! The start LBA.
     static constexpr stl::uint32_t start_lba {boot_sector_count};
 
+    //! The format version of file systems whose index nodes do not have double indirect block tables.
+    static constexpr stl::uint32_t legacy_version {0};
+
+    //! The format version of file systems whose index nodes have double indirect block tables.
+    static constexpr stl::uint32_t double_indirect_version {1};
+
+    /**
+     * @brief The format version of file systems whose index nodes are padded to @p IdxNode::aligned_size.
+     *
+     * @details
+     * In older versions, index nodes are packed, and some of them are across two sectors.
+     */
+    static constexpr stl::uint32_t aligned_inode_version {2};
+
+    //! The format version of new file systems.
+    static constexpr stl::uint32_t curr_version {aligned_inode_version};
+
+    //! The signature of a valid free-space summary.
+    static constexpr stl::uint32_t valid_summary_sign {0x55667788};
+
+    //! The maximum number of sectors in a block.
+    static constexpr stl::size_t max_block_sector_count {8};
+
+    //! Whether a block size can be used to format a partition, which can be 512 bytes, 1, 2 or 4 KiB.
+    static bool IsBlockSizeValid(stl::size_t size) noexcept;
+
     /**
      * @brief Whether the super block has a valid signature.
      *
@@ -54,6 +80,29 @@ public:
      */
     bool IsSignValid() const noexcept;
 
+    //! Whether index nodes have double indirect block tables.
+    bool HasDoubleIndirect() const noexcept;
+
+    //! Whether index nodes are padded so that none of them is across two sectors.
+    bool AreNodesAligned() const noexcept;
+
+    //! Get the size of an index node slot on the disk, including its padding.
+    stl::size_t GetNodeSize() const noexcept;
+
+    /**
+     * @brief Whether the free-space summary is valid.
+     *
+     * @details
+     * Legacy super blocks do not have the summary. It should be rebuilt from bitmaps when they are mounted.
+     */
+    bool IsSummaryValid() const noexcept;
+
+    //! Get the number of sectors in a block.
+    stl::size_t GetBlockSectorCount() const noexcept;
+
+    //! Get the size of a block in bytes.
+    stl::size_t GetBlockSize() const noexcept;
+
     //! The start LBA of the partition.
     stl::size_t part_start_lba;
     //! The number of sectors in the partition.
@@ -80,6 +129,41 @@ public:
     stl::size_t data_start_lba;
     //! The index of the root directory's index node.
     stl::size_t root_inode_idx;
+
+    /**
+     * @brief The format version.
+     *
+     * @details
+     * Legacy super blocks do not have this field, but their padding is zero, which is @p legacy_version.
+     */
+    stl::uint32_t version;
+
+    /**
+     * @brief The number of sectors in a block.
+     *
+     * @details
+     * Bits in the block bitmap, block LBAs in index nodes and file data transfers all use blocks.
+     * Legacy super blocks do not have this field. Their padding is zero, meaning a block is one sector large.
+     */
+    stl::uint32_t block_sector_count;
+
+    /**
+     * @brief The signature of the free-space summary below.
+     *
+     * @details
+     * Legacy super blocks do not have the summary. Their padding is zero, so it is not @p valid_summary_sign.
+     */
+    stl::uint32_t summary_sign;
+    //! The number of data blocks, which is the number of bits in the block bitmap.
+    stl::size_t block_count;
+    //! The number of free data blocks.
+    stl::size_t free_block_count;
+    //! The number of free index nodes.
+    stl::size_t free_inode_count;
+    //! The index of the first possibly free data block. All blocks before it are allocated.
+    stl::size_t free_block_hint;
+    //! The index of the first possibly free index node. All index nodes before it are allocated.
+    stl::size_t free_inode_hint;
 };
 
 //! The 4096-byte padded super block.
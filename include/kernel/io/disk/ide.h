@@ -9,17 +9,64 @@
 #pragma once
 
 #include "kernel/io/disk/disk.h"
-#include "kernel/stl/mutex.h"
 #include "kernel/stl/semaphore.h"
+#include "kernel/thread/sync.h"
+#include "kernel/util/tag_list.h"
 
 namespace io {
 
-//! The IDE channel.
+/**
+ * @brief The IDE channel.
+ *
+ * @details
+ * Each channel has a request queue shared by its disks, and a worker thread dispatching the queue.
+ * Threads submit block requests and can sleep until they are completed, or keep running and wait later.
+ * Channels never wait for each other, so requests to disks on different channels are transferred in parallel.
+ *
+ * The dispatcher uses the C-LOOK elevator algorithm.
+ * It serves requests in ascending order of positions from the last served position,
+ * and jumps back to the lowest position when there are no requests ahead.
+ * Requests adjacent to each other in the same direction are merged into a single multi-sector command.
+ */
 class IdeChnl {
 public:
     //! A machine usually has two channels: primary and secondary channels.
     enum class Type { Invalid, Primary, Secondary };
 
+    //! A block request to a disk under the channel.
+    struct Request {
+        static Request& GetByTag(const TagList::Tag&) noexcept;
+
+        //! Get the LBA after the last sector.
+        stl::size_t GetEndLba() const noexcept;
+
+        //! The tag for the request queue.
+        TagList::Tag tag;
+
+        Disk* disk {nullptr};
+        stl::size_t lba {0};
+        stl::size_t count {0};
+
+        /**
+         * @brief The buffer of sectors.
+         *
+         * @warning
+         * It must be in kernel memory, since the worker thread of the channel transfers the data.
+         */
+        stl::byte* buf {nullptr};
+
+        bool write {false};
+
+        //! The next request merged into the same command.
+        Request* merged {nullptr};
+
+        //! Whether the request has been completed.
+        stl::binary_semaphore done {0};
+
+        //! The time-stamp counter when the request was submitted.
+        stl::uint64_t submit_tsc {0};
+    };
+
     //! Each channel has up to two disks.
     static constexpr stl::size_t max_disk_count {2};
 
@@ -83,32 +130,133 @@ public:
 
     const Disks& GetDisks() const noexcept;
 
-    stl::mutex& GetLock() const noexcept;
+    //! Submit a request and sleep until it is completed.
+    void Submit(Request&) const noexcept;
+
+    /**
+     * @brief Submit a request without waiting for it.
+     *
+     * @details
+     * The request is transferred by the worker thread of the channel.
+     * It must stay valid until @p Wait returns.
+     */
+    void SubmitAsync(Request&) const noexcept;
+
+    //! Sleep until a request submitted by @p SubmitAsync is completed.
+    void Wait(Request&) const noexcept;
+
+    //! Create the worker thread dispatching the request queue.
+    IdeChnl& StartWorker() noexcept;
 
     /**
-     * @brief Block the thread.
+     * @brief Sleep until the disk raises an interrupt or a timeout expires.
      *
      * @details
      * Call this method when we need to wait for the disk to finish an operation.
+     * The waiting must be started by @p NeedToWaitForIntr before the command is sent,
+     * which @p Disk::SendCmd does with interrupts disabled.
+     * Then an interrupt arriving before this method is called is not lost.
+     *
+     * @param[out] status The status register read by the interrupt handler.
+     * @param milliseconds The timeout.
+     * @return Whether the interrupt arrived before the timeout.
      */
-    void Block() const noexcept;
+    bool WaitForIntr(stl::uint8_t& status, stl::size_t milliseconds) const noexcept;
 
     /**
-     * @brief Unblock the thread.
+     * @brief Wake up the thread waiting for an interrupt.
      *
      * @details
-     * Call this method when the disk has finished its operation.
+     * Call this method in the interrupt handler when the disk has finished its operation.
+     *
+     * @param status The status register, whose reading has acknowledged the interrupt.
      */
-    void Unblock() const noexcept;
+    void CompleteIntr(stl::uint8_t status) const noexcept;
 
     stl::string_view GetName() const noexcept;
 
+    /**
+     * @brief Enable bus-master DMA transfers.
+     *
+     * @param port The bus-master base port of the channel.
+     */
+    IdeChnl& EnableBusMaster(stl::uint16_t port) noexcept;
+
+    bool IsBusMasterEnabled() const noexcept;
+
 private:
+    class BatchCursor;
+
+    struct PrdEntry;
+
     static constexpr stl::size_t name_len {8};
 
     stl::uint16_t GetBasePort() const noexcept;
 
-    mutable stl::mutex mtx_;
+    stl::uint16_t GetBusMasterCmdPort() const noexcept;
+
+    stl::uint16_t GetBusMasterStatusPort() const noexcept;
+
+    stl::uint16_t GetBusMasterPrdTabPort() const noexcept;
+
+    //! Insert a request into the queue in the elevator order.
+    void Enqueue(Request&) const noexcept;
+
+    /**
+     * @brief Remove the next batch of requests from the queue.
+     *
+     * @return
+     * The first request of the batch, whose @p merged links adjacent requests.
+     * If the queue is empty, it returns @p nullptr.
+     */
+    Request* PopBatch() const noexcept;
+
+    //! The worker thread transferring requests of a channel.
+    static void Serve(void* chnl) noexcept;
+
+    /**
+     * @brief Transfer the sectors of a batch of adjacent requests.
+     *
+     * @details
+     * The batch is split into commands of up to @p Disk::GetMaxSectorCountPerAccess sectors.
+     * The data of a command is scattered to or gathered from the buffers of requests in order.
+     */
+    void Transfer(Request& batch) const noexcept;
+
+    /**
+     * @brief Transfer sectors by PIO, where the CPU moves every word through the data port.
+     *
+     * @return Whether the transfer succeeded.
+     */
+    bool TransferPio(Disk&, bool write, stl::size_t lba, stl::size_t count,
+                     BatchCursor&) const noexcept;
+
+    /**
+     * @brief Transfer sectors by bus-master DMA.
+     *
+     * @details
+     * The buffers are described by a physical region descriptor table,
+     * and the controller moves the data while the current thread sleeps.
+     *
+     * @param[in,out] count
+     * The maximum number of sectors.
+     * It returns the number of transferred sectors, which is limited by the size of the table.
+     * @return Whether the transfer succeeded.
+     */
+    bool TransferDma(Disk&, bool write, stl::size_t lba, stl::size_t& count,
+                     BatchCursor&) const noexcept;
+
+    //! Pending requests sorted by positions.
+    mutable TagList reqs_;
+
+    //! The worker thread waiting for requests.
+    mutable sync::WaitQueue worker_;
+
+    //! The disk of the last served request.
+    mutable const Disk* head_disk_ {nullptr};
+
+    //! The LBA after the last served request, where the elevator continues.
+    mutable stl::size_t head_lba_ {0};
 
     stl::array<char, name_len + 1> name_;
 
@@ -121,6 +269,12 @@ private:
     //! The interrupt number.
     stl::size_t intr_num_ {0};
 
+    //! The bus-master base I/O port, or @p 0 if bus-master DMA is not supported.
+    stl::uint16_t bm_port_ {0};
+
+    //! The physical region descriptor table for bus-master transfers.
+    PrdEntry* prd_tab_ {nullptr};
+
     //! The disks under the channel.
     Disks disks_;
 
@@ -133,8 +287,11 @@ private:
      */
     mutable bool waiting_intr_ {false};
 
-    //! Whether the disk has finished its operation.
-    mutable stl::binary_semaphore disk_done_ {0};
+    //! The status register read by the interrupt handler.
+    mutable stl::uint8_t intr_status_ {0};
+
+    //! The worker thread waiting for an interrupt.
+    mutable sync::WaitQueue intr_waiter_;
 };
 
 //! A machine usually has two IDE channels.
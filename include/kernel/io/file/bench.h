@@ -0,0 +1,42 @@
+/**
+ * @file bench.h
+ * @brief The file system benchmark.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+namespace io {
+
+/**
+ * @brief Whether to run the file system benchmark after the kernel is initialized.
+ *
+ * @details
+ * It can be set by the @p FS_BENCH macro.
+ */
+#ifdef FS_BENCH
+inline constexpr bool fs_bench_enabled {FS_BENCH != 0};
+#else
+inline constexpr bool fs_bench_enabled {false};
+#endif
+
+/**
+ * @brief Run the file system benchmark on the default partition and print the results.
+ *
+ * @details
+ * It runs the following workloads in the directory @p /bench:
+ * - Sequential writes and reads of a file in 4 KiB chunks.
+ * - Random writes and reads of single sectors in the file.
+ * - Creating and deleting small files.
+ * - Opening a file in a deep directory.
+ * - Listing a directory.
+ *
+ * The latency of each operation is measured by the time-stamp counter.
+ * Each workload reports the throughput and latency percentiles.
+ * All created files are deleted at the end, but directories are kept and reused by later runs.
+ */
+void RunFileSysBench() noexcept;
+
+}  // namespace io
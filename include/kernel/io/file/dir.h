@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "kernel/io/disk/file/dir.h"
 #include "kernel/io/file/path.h"
 
 namespace io {
@@ -17,6 +18,17 @@ class Directory {
 public:
     //! Create a directory.
     static bool Create(const Path&) noexcept;
+
+    /**
+     * @brief Read multiple entries in a directory from a cursor.
+     *
+     * @param[in, out] cursor The position to read from. It is moved after the read entries.
+     * @param[out] entries A buffer for entries.
+     * @param count The maximum number of entries to read.
+     * @return The number of read entries.
+     */
+    static stl::size_t ReadEntries(const Path&, fs::Directory::Cursor& cursor,
+                                   fs::DirEntry* entries, stl::size_t count) noexcept;
 };
 
 //! System calls.
@@ -27,6 +39,9 @@ public:
     Directory() = delete;
 
     static bool Create(const char*) noexcept;
+
+    static stl::size_t ReadEntries(const char* path, fs::Directory::Cursor* cursor,
+                                   fs::DirEntry* entries, stl::size_t count) noexcept;
 };
 
 }  // namespace sc
@@ -38,6 +38,76 @@ private:
     stl::size_t desc_;
 };
 
+/**
+ * @brief A buffer in vectored file operations.
+ *
+ * @details
+ * It has the same layout as @p usr::io::IoVec.
+ */
+struct IoVec {
+    void* base;
+    stl::size_t size;
+};
+
+//! The maximum number of buffers in a vectored file operation.
+inline constexpr stl::size_t max_io_vec_count {16};
+
+//! Get the total size of buffers.
+stl::size_t GetIoVecSize(const IoVec* vecs, stl::size_t count) noexcept;
+
+//! The size of a kernel buffer which user memory is copied through in file operations.
+inline constexpr stl::size_t usr_io_buf_size {0x4000};
+
+/**
+ * @brief Read a file on the disk into a buffer, which can be in user memory.
+ *
+ * @details
+ * A user buffer is filled through a kernel buffer, chunk by chunk.
+ * A page fault on user memory may load a page from the file system,
+ * so it must not happen while the file system is locked.
+ */
+stl::size_t ReadDiskFile(FileDesc, void* buf, stl::size_t size) noexcept;
+
+//! Write a buffer, which can be in user memory, to a file on the disk.
+stl::size_t WriteDiskFile(FileDesc, const void* data, stl::size_t size) noexcept;
+
+/**
+ * @brief Read a file on the disk into buffers, which can be in user memory.
+ *
+ * @details
+ * If any buffer is in user memory, consecutive buffers are filled through one kernel buffer.
+ * Each filled kernel buffer takes a single vectored read and is copied out after the file system is unlocked.
+ * Buffers after a user buffer extending into kernel memory are ignored.
+ */
+stl::size_t ReadDiskFile(FileDesc, const IoVec* vecs, stl::size_t count) noexcept;
+
+/**
+ * @brief Write buffers, which can be in user memory, to a file on the disk.
+ *
+ * @details
+ * If any buffer is in user memory, consecutive buffers are packed into one kernel buffer,
+ * and each filled kernel buffer takes a single vectored write.
+ * Buffers after a user buffer extending into kernel memory are ignored.
+ */
+stl::size_t WriteDiskFile(FileDesc, const IoVec* vecs, stl::size_t count) noexcept;
+
+/**
+ * @brief The usage of a file system.
+ *
+ * @details
+ * It has the same layout as @p usr::io::FileSysStats.
+ */
+struct FileSysStats {
+    //! The size of a block in bytes.
+    stl::size_t block_size;
+    //! The number of data blocks.
+    stl::size_t block_count;
+    stl::size_t free_block_count;
+    //! The number of index nodes, which is the maximum number of files and directories.
+    stl::size_t inode_count;
+    stl::size_t free_inode_count;
+};
+
 //! The wrapper for file functions of @p Disk::FilePart.
 class File {
 public:
@@ -49,6 +119,17 @@ public:
 
     static bool Delete(const Path&) noexcept;
 
+    /**
+     * @brief Write all modified file data and metadata to the disk.
+     *
+     * @details
+     * Otherwise, they are written back periodically.
+     */
+    static void Sync() noexcept;
+
+    //! Get the usage of the default file system.
+    static FileSysStats GetSysStats() noexcept;
+
     explicit File(FileDesc) noexcept;
 
     explicit File(const Path&, bit::Flags<OpenMode>) noexcept;
@@ -61,8 +142,30 @@ public:
 
     stl::size_t Read(void* buf, stl::size_t size) noexcept;
 
+    /**
+     * @brief Write data from multiple buffers in one file operation.
+     *
+     * @details
+     * Buffers are written in order as if they were one buffer.
+     * It is more efficient than writing them one by one,
+     * since a partial sector is only read and written once, and the index node is only synchronized once.
+     */
+    stl::size_t WriteV(const IoVec* vecs, stl::size_t count) noexcept;
+
+    //! Read data into multiple buffers in one file operation.
+    stl::size_t ReadV(const IoVec* vecs, stl::size_t count) noexcept;
+
     stl::size_t Seek(stl::int32_t offset, SeekOrigin) noexcept;
 
+    /**
+     * @brief Reserve blocks for the file to grow to a size without changing its size.
+     *
+     * @details
+     * It is similar to @p fallocate in @em Linux.
+     * Writing a file of a known size after reserving its blocks keeps the file contiguous on the disk.
+     */
+    bool Reserve(stl::size_t size) noexcept;
+
     void Close() noexcept;
 
     bool IsOpen() const noexcept;
@@ -88,40 +191,28 @@ class File {
 public:
     File() = delete;
 
-    struct OpenArgs {
-        const char* path;
-        stl::uint32_t flags;
-    };
+    static stl::size_t Open(const char* path, stl::uint32_t flags) noexcept;
 
-    struct WriteArgs {
-        stl::size_t desc;
-        const void* data;
-        stl::size_t size;
-    };
+    static void Close(stl::size_t) noexcept;
 
-    struct ReadArgs {
-        stl::size_t desc;
-        void* buf;
-        stl::size_t size;
-    };
+    static bool Delete(const char*) noexcept;
 
-    struct SeekArgs {
-        stl::size_t desc;
-        stl::int32_t offset;
-        io::File::SeekOrigin origin;
-    };
+    static void Sync() noexcept;
 
-    static stl::size_t Open(const OpenArgs&) noexcept;
+    static void GetSysStats(FileSysStats*) noexcept;
 
-    static void Close(stl::size_t) noexcept;
+    static stl::size_t Write(stl::size_t desc, const void* data, stl::size_t size) noexcept;
 
-    static bool Delete(const char*) noexcept;
+    static stl::size_t Read(stl::size_t desc, void* buf, stl::size_t size) noexcept;
+
+    static stl::size_t WriteV(stl::size_t desc, const IoVec* vecs, stl::size_t count) noexcept;
 
-    static stl::size_t Write(const WriteArgs&) noexcept;
+    static stl::size_t ReadV(stl::size_t desc, const IoVec* vecs, stl::size_t count) noexcept;
 
-    static stl::size_t Read(const ReadArgs&) noexcept;
+    static stl::size_t Seek(stl::size_t desc, stl::int32_t offset,
+                            io::File::SeekOrigin origin) noexcept;
 
-    static stl::size_t Seek(const SeekArgs&) noexcept;
+    static bool Reserve(stl::size_t desc, stl::size_t size) noexcept;
 };
 
 }  // namespace sc
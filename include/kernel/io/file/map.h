@@ -0,0 +1,86 @@
+/**
+ * @file map.h
+ * @brief Memory-mapped files.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/io/file/file.h"
+
+namespace io {
+
+/**
+ * @brief Memory-mapped files.
+ *
+ * @details
+ * A mapping reserves virtual pages in the current process for a range of a file.
+ * - When a page is accessed for the first time, the page fault handler maps a zeroed physical page
+ *   and reads the file data into it through the block cache.
+ * - The processor marks written pages as dirty. Dirty pages are written back by @p Sync and @p Unmap.
+ * - Bytes beyond the end of the file are read as zeros and never written back, so the file does not grow.
+ * - The mapping holds its own descriptor in the global file table,
+ *   so the file can be closed after mapping, and it cannot be deleted until it is unmapped.
+ *
+ * Mappings are not inherited by forked processes. Pages that have been loaded are copied as private memory.
+ * A page that has not been loaded cannot be used as a buffer of another file operation,
+ * since loading it requires the partition lock held by the operation.
+ */
+class FileMap {
+public:
+    //! The maximum number of mappings in the system.
+    static constexpr stl::size_t max_count {16};
+
+    FileMap() = delete;
+
+    /**
+     * @brief Map a range of a file into the current process.
+     *
+     * @param desc A local descriptor of a file on the disk.
+     * @param offset The offset in the file. It must be aligned to a page.
+     * @param size The size in bytes. It is rounded up to pages.
+     * @param writable Whether the pages are writable. The file must be open for writing.
+     * @return The virtual base address, or @p nullptr if the file cannot be mapped.
+     */
+    static void* Map(FileDesc desc, stl::size_t offset, stl::size_t size, bool writable) noexcept;
+
+    //! Write dirty pages back and unmap a mapping of the current process.
+    static bool Unmap(void* vr_base) noexcept;
+
+    //! Write dirty pages back and unmap all mappings of the current process when it exits.
+    static void UnmapAll() noexcept;
+
+    //! Write dirty pages of a mapping of the current process back to the file.
+    static bool Sync(void* vr_base) noexcept;
+
+    /**
+     * @brief Load a page of a mapping of the current process on its first access.
+     *
+     * @details
+     * It is called by the page fault handler.
+     *
+     * @param vr_addr A virtual address in the page.
+     * @return Whether the page belongs to a mapping and has been loaded.
+     */
+    static bool LoadPage(stl::uintptr_t vr_addr) noexcept;
+};
+
+namespace sc {
+
+class FileMap {
+public:
+    FileMap() = delete;
+
+    static void* Map(stl::size_t desc, stl::size_t offset, stl::size_t size,
+                     bool writable) noexcept;
+
+    static bool Unmap(void* vr_base) noexcept;
+
+    static bool Sync(void* vr_base) noexcept;
+};
+
+}  // namespace sc
+
+}  // namespace io
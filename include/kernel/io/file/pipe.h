@@ -0,0 +1,102 @@
+/**
+ * @file pipe.h
+ * @brief Kernel pipes.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/io/file/file.h"
+#include "kernel/util/block_queue.h"
+
+namespace io {
+
+/**
+ * @brief A one-way byte stream between processes in kernel memory.
+ *
+ * @details
+ * A pipe has a read end and a write end, which are open files in the global file table.
+ * Data is copied from the writer's buffer into a ring buffer and then into the reader's buffer,
+ * without accessing the disk.
+ * - A write blocks until all data is written, or all read ends are closed.
+ * - A read blocks until some data is available, then returns as much as possible.
+ *   It returns zero after all write ends are closed and the buffer is empty.
+ *
+ * Each end counts the files referring to it, which are increased by forking.
+ * The pipe is freed after both ends are closed and no thread is reading or writing it.
+ */
+class Pipe {
+public:
+    //! The size of the ring buffer.
+    static constexpr stl::size_t buf_size {KB(4) - 1};
+
+    /**
+     * @brief Create a pipe and open its ends in the current process or kernel thread.
+     *
+     * @param[out] read_end The local descriptor of the read end.
+     * @param[out] write_end The local descriptor of the write end.
+     * @return Whether the pipe is created.
+     */
+    static bool Create(FileDesc& read_end, FileDesc& write_end) noexcept;
+
+    Pipe(const Pipe&) = delete;
+
+    //! Write data, blocking while the buffer is full.
+    stl::size_t Write(const void* data, stl::size_t size) noexcept;
+
+    /**
+     * @brief Read available data.
+     *
+     * @param wait Whether to block while the buffer is empty.
+     */
+    stl::size_t Read(void* buf, stl::size_t size, bool wait = true) noexcept;
+
+    //! Add a file referring to an end.
+    Pipe& Open(bool write_end) noexcept;
+
+    /**
+     * @brief Remove a file referring to an end.
+     *
+     * @details
+     * After all files of an end are closed, threads waiting at the other end are woken up.
+     * After both ends are closed, the pipe is freed by the last thread leaving it.
+     */
+    void Close(bool write_end) noexcept;
+
+private:
+    Pipe() noexcept = default;
+
+    Pipe& Init() noexcept;
+
+    //! Whether both ends are closed and no thread is reading or writing. Interrupts must be disabled.
+    bool IsUnused() const noexcept;
+
+    BlockQueue<stl::byte, buf_size> buf_;
+
+    stl::size_t reader_count_;
+
+    stl::size_t writer_count_;
+
+    //! The number of threads reading or writing the pipe.
+    stl::size_t active_count_;
+};
+
+namespace sc {
+
+class Pipe {
+public:
+    Pipe() = delete;
+
+    /**
+     * @brief Create a pipe.
+     *
+     * @param[out] descs The local descriptors of the read end and the write end.
+     */
+    static bool Create(stl::size_t* descs) noexcept;
+};
+
+}  // namespace sc
+
+}  // namespace io
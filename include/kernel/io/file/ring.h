@@ -0,0 +1,114 @@
+/**
+ * @file ring.h
+ * @brief Submission and completion rings for batched file operations.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+
+namespace io {
+
+/**
+ * @brief Submission and completion rings shared by a process and the kernel.
+ *
+ * @details
+ * The rings are in user memory and have the same layout as @p usr::io::IoRing::Shared.
+ * - A process queues file operations into the submission ring, and enters the kernel once to submit them.
+ * - A worker thread of the process runs them in kernel mode and posts results to the completion ring.
+ *
+ * Each ring is a single-producer single-consumer ring.
+ * Its head is only written by the producer and its tail is only written by the consumer.
+ * Both are free-running counters, so the number of entries is @p head - @p tail.
+ *
+ * The worker thread belongs to the process, so it uses the process's address space and file descriptors.
+ * While it is blocked on disk transfers, other threads of the process can keep running.
+ *
+ * @warning
+ * A forked child does not inherit the worker thread. It has to set up its own rings.
+ */
+class IoRing {
+public:
+    //! The maximum number of processes with rings.
+    static constexpr stl::size_t max_count {8};
+
+    //! The number of entries in each ring. It must be a power of two.
+    static constexpr stl::size_t entry_count {32};
+
+    static_assert((entry_count & (entry_count - 1)) == 0);
+
+    enum class Op { Read, Write };
+
+    //! A file operation queued by a process.
+    struct Submission {
+        stl::size_t op;
+        stl::size_t desc;
+        void* buf;
+        stl::size_t size;
+        //! A value copied to the completion to identify the operation.
+        stl::size_t user_data;
+    };
+
+    //! The result of a file operation.
+    struct Completion {
+        stl::size_t user_data;
+        //! The number of bytes read or written, or @p npos if the operation is invalid.
+        stl::size_t result;
+    };
+
+    struct Shared {
+        stl::size_t submit_head;
+        stl::size_t submit_tail;
+        Submission submits[entry_count];
+        stl::size_t complete_head;
+        stl::size_t complete_tail;
+        Completion completes[entry_count];
+    };
+
+    /**
+     * @brief Set up rings for the current process and start its worker thread.
+     *
+     * @return Whether the rings are set up. A process can only set up rings once.
+     */
+    static bool Setup(Shared&) noexcept;
+
+    /**
+     * @brief Submit queued operations of the current process.
+     *
+     * @param min_complete
+     * The minimum number of completions to wait for.
+     * If it is @p 0, submitted operations run while the process keeps running.
+     *
+     * @return
+     * The number of completions in the completion ring,
+     * or @p npos if the process has no rings or has corrupted their counters.
+     */
+    static stl::size_t Enter(stl::size_t min_complete) noexcept;
+
+    /**
+     * @brief Stop the worker thread of the current process's rings when the process exits.
+     *
+     * @details
+     * Submissions that have not been run are discarded.
+     */
+    static void Release() noexcept;
+};
+
+//! System calls.
+namespace sc {
+
+class IoRing {
+public:
+    IoRing() = delete;
+
+    static bool Setup(void* shared) noexcept;
+
+    static stl::size_t Enter(stl::size_t min_complete) noexcept;
+};
+
+}  // namespace sc
+
+}  // namespace io
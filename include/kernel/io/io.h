@@ -68,15 +68,27 @@ stl::uint32_t GetCr2() noexcept;
 //! Set the value of @p CR3.
 void SetCr3(stl::uint32_t) noexcept;
 
+//! Read the time-stamp counter.
+stl::uint64_t ReadTsc() noexcept;
+
+//! Write a value to a model-specific register.
+void WriteMsr(stl::uint32_t msr, stl::uint64_t val) noexcept;
+
 //! Write a byte to a port.
 void WriteByteToPort(stl::uint16_t port, stl::byte data) noexcept;
 
 //! Write a number of words to a port.
 void WriteWordsToPort(stl::uint16_t port, const void* data, stl::size_t count = 1) noexcept;
 
+//! Write a double word to a port.
+void WriteDoubleWordToPort(stl::uint16_t port, stl::uint32_t data) noexcept;
+
 //! Read a byte from a port.
 stl::byte ReadByteFromPort(stl::uint16_t port) noexcept;
 
+//! Read a double word from a port.
+stl::uint32_t ReadDoubleWordFromPort(stl::uint16_t port) noexcept;
+
 //! Read a number of words from a port.
 void ReadWordsFromPort(stl::uint16_t port, void* buf, stl::size_t count = 1) noexcept;
 }
@@ -8,16 +8,14 @@
 
 #pragma once
 
-#include "kernel/util/block_queue.h"
-
 namespace io {
 
-//! Initialize the keyboard.
+/**
+ * @brief Initialize the keyboard.
+ *
+ * @details
+ * Characters are passed to the line discipline of console input by the keyboard work in the worker thread.
+ */
 void InitKeyboard() noexcept;
 
-using KeyboardBuffer = BlockQueue<char, 64>;
-
-//! Get the keyboard buffer.
-KeyboardBuffer& GetKeyboardBuffer() noexcept;
-
 }  // namespace io
\ No newline at end of file
@@ -0,0 +1,99 @@
+/**
+ * @file line_disc.h
+ * @brief The line discipline of console input.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/stl/mutex.h"
+#include "kernel/util/spsc_queue.h"
+
+namespace io {
+
+/**
+ * @brief The line discipline between the keyboard and readers of the console.
+ *
+ * @details
+ * Characters from the keyboard work in the worker thread are processed in one of two modes:
+ * - In the canonical mode, characters are edited in a line buffer and echoed to the screen.
+ *   Backspaces delete the last character, and carriage returns are translated into line feeds.
+ *   A line is moved into the input ring only when it ends, so a reader receives a whole line at once.
+ * - In the raw mode, characters are moved into the input ring immediately without echoing.
+ *
+ * @code
+ *   Keyboard Work ──► Line Buffer ──(Line Feed)──► Input Ring ──► Read
+ *         │                                         ▲
+ *         └─────────────────(Raw Mode)──────────────┘
+ * @endcode
+ */
+class LineDiscipline {
+public:
+    //! The size of the input ring.
+    static constexpr stl::size_t input_size {1024};
+
+    //! The maximum length of an edited line, including the line feed.
+    static constexpr stl::size_t max_line_len {256};
+
+    LineDiscipline() noexcept = default;
+
+    LineDiscipline(const LineDiscipline&) = delete;
+
+    /**
+     * @brief Process a character from the keyboard.
+     *
+     * @details
+     * It is only called by the keyboard work in the worker thread, which is the only producer.
+     * If the line buffer or the input ring is full, the character is dropped.
+     */
+    void Receive(char) noexcept;
+
+    /**
+     * @brief Read characters by one call.
+     *
+     * @details
+     * It blocks until characters are available.
+     * - In the canonical mode, it reads a line, including the line feed.
+     *   If the line is longer than the buffer, the rest is returned by the next call.
+     * - In the raw mode, it reads all available characters.
+     *
+     * @return The number of characters read, which is at most @p size.
+     */
+    stl::size_t Read(char* buf, stl::size_t size) noexcept;
+
+    /**
+     * @brief Switch between the canonical and raw modes.
+     *
+     * @details
+     * A partially edited line is moved into the input ring when the next character arrives in the raw mode.
+     */
+    LineDiscipline& SetCanonical(bool canonical = true) noexcept;
+
+    bool IsCanonical() const noexcept;
+
+private:
+    //! Move the edited line into the input ring.
+    void CommitLine() noexcept;
+
+    //! Edit the line buffer in the canonical mode.
+    void Edit(char) noexcept;
+
+    SpscQueue<char, input_size> input_;
+
+    //! The line being edited. It is only accessed by the producer.
+    stl::array<char, max_line_len> line_;
+    stl::size_t line_len_ {0};
+
+    bool canonical_ {true};
+
+    //! The input ring only has one consumer, so readers are serialized.
+    stl::mutex read_mtx_;
+};
+
+//! Get the line discipline of console input.
+LineDiscipline& GetConsoleInput() noexcept;
+
+}  // namespace io
@@ -0,0 +1,82 @@
+/**
+ * @file pci.h
+ * @brief The PCI configuration space.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+
+namespace io {
+
+/**
+ * @brief A PCI device function.
+ *
+ * @details
+ * Its configuration space is accessed by the configuration mechanism #1,
+ * which writes an address to port @p 0xCF8 and transfers data through port @p 0xCFC.
+ */
+class PciDevice {
+public:
+    //! The maximum number of buses.
+    static constexpr stl::size_t max_bus_count {256};
+
+    //! The maximum number of devices per bus.
+    static constexpr stl::size_t max_device_count {32};
+
+    //! The maximum number of functions per device.
+    static constexpr stl::size_t max_func_count {8};
+
+    //! The number of base address registers.
+    static constexpr stl::size_t bar_count {6};
+
+    /**
+     * @brief Find the first device function of a class.
+     *
+     * @return The device function, or an invalid one if it does not exist.
+     */
+    static PciDevice Find(stl::uint8_t class_code, stl::uint8_t subclass) noexcept;
+
+    constexpr PciDevice() noexcept = default;
+
+    PciDevice(stl::size_t bus, stl::size_t device, stl::size_t func) noexcept;
+
+    bool IsValid() const noexcept;
+
+    stl::uint16_t GetVendorId() const noexcept;
+
+    stl::uint8_t GetClassCode() const noexcept;
+
+    stl::uint8_t GetSubclass() const noexcept;
+
+    //! Get the programming interface, which describes register-level features of the class.
+    stl::uint8_t GetProgIntf() const noexcept;
+
+    //! Whether the device has multiple functions.
+    bool IsMultiFunc() const noexcept;
+
+    //! Get a base address register.
+    stl::uint32_t GetBar(stl::size_t idx) const noexcept;
+
+    //! Allow the device to respond to I/O space accesses and to act as a bus master.
+    const PciDevice& EnableBusMaster() const noexcept;
+
+    //! Read a double word from the configuration space.
+    stl::uint32_t Read(stl::size_t offset) const noexcept;
+
+    //! Write a double word to the configuration space.
+    const PciDevice& Write(stl::size_t offset, stl::uint32_t val) const noexcept;
+
+private:
+    stl::uint32_t GetAddr(stl::size_t offset) const noexcept;
+
+    bool valid_ {false};
+    stl::uint8_t bus_ {0};
+    stl::uint8_t device_ {0};
+    stl::uint8_t func_ {0};
+};
+
+}  // namespace io
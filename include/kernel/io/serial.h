@@ -0,0 +1,124 @@
+/**
+ * @file serial.h
+ * @brief The *NS16550A* serial port.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/stl/string_view.h"
+
+namespace io {
+
+/**
+ * @brief The *NS16550A* serial port with an interrupt-driven transmit queue.
+ *
+ * @details
+ * Printed text is mirrored to the serial port, so it can be captured by the host of a virtual machine.
+ * - Characters are pushed into a transmit queue in memory, so printing never waits for the port.
+ *   If the queue is full, characters are dropped and counted.
+ * - @p Flush starts a transmission by filling the transmit FIFO of the port if it is idle.
+ * - When the FIFO becomes empty, the port raises an interrupt and its handler refills the FIFO from the queue.
+ * - @p Drain sends the whole queue by polling, for the panic path where interrupts stay disabled.
+ *
+ * Methods are not thread-safe. Interrupts should be disabled when calling them.
+ */
+class SerialPort {
+public:
+    //! The base port of @p COM1.
+    static constexpr stl::uint16_t com1_base {0x3F8};
+
+    //! The baud rate.
+    static constexpr stl::size_t baud_rate {115200};
+
+    //! The size of the transmit queue. It must be a power of two.
+    static constexpr stl::size_t tx_queue_size {0x1000};
+
+    static_assert((tx_queue_size & (tx_queue_size - 1)) == 0);
+
+    constexpr SerialPort(const stl::uint16_t base) noexcept : base_ {base} {}
+
+    SerialPort(const SerialPort&) = delete;
+
+    /**
+     * @brief Detect and initialize the port.
+     *
+     * @details
+     * The port is tested in the loopback mode.
+     * If it is not present, characters put into it are discarded.
+     *
+     * @return Whether the port is present.
+     */
+    bool Init() noexcept;
+
+    bool IsPresent() const noexcept;
+
+    /**
+     * @brief Push a character into the transmit queue.
+     *
+     * @details
+     * Line feeds are sent with carriage returns, as terminals expect.
+     * The port is not accessed until @p Flush is called.
+     */
+    SerialPort& PutChar(char) noexcept;
+
+    SerialPort& PutStr(stl::string_view) noexcept;
+
+    //! Push an unsigned hexadecimal integer without the prefix @p 0x.
+    SerialPort& PutHex(stl::uint32_t) noexcept;
+
+    //! Start transmitting queued characters if the port is idle.
+    SerialPort& Flush() noexcept;
+
+    /**
+     * @brief Send all queued characters by polling the line status.
+     *
+     * @details
+     * It does not rely on interrupts, so it can be used when interrupts will not be enabled again,
+     * such as before the system panics.
+     */
+    SerialPort& Drain() noexcept;
+
+    //! Refill the transmit FIFO when it becomes empty. It is called by the interrupt handler.
+    SerialPort& OnTxEmpty() noexcept;
+
+    //! Get the number of characters that can be pushed into the transmit queue without dropping.
+    stl::size_t GetFreeCount() const noexcept;
+
+    //! Get the number of characters dropped because the transmit queue was full.
+    stl::size_t GetDroppedCount() const noexcept;
+
+private:
+    //! Push a character without translating it.
+    void Push(char) noexcept;
+
+    //! Move characters from the transmit queue to the transmit FIFO.
+    void FillFifo() noexcept;
+
+    stl::uint16_t base_;
+
+    //! The number of characters the transmit FIFO can hold. It is zero if the port is not present.
+    stl::size_t fifo_size_ {0};
+
+    //! Whether the port is sending characters and will raise an interrupt when its FIFO is empty.
+    bool tx_busy_ {false};
+
+    stl::array<char, tx_queue_size> tx_queue_;
+
+    //! Free-running positions in the transmit queue.
+    stl::size_t head_ {0};
+    stl::size_t tail_ {0};
+
+    stl::size_t dropped_count_ {0};
+};
+
+//! Get the serial port @p COM1.
+SerialPort& GetSerialPort() noexcept;
+
+//! Initialize the serial port @p COM1 and register its interrupt handler.
+void InitSerialPort() noexcept;
+
+}  // namespace io
@@ -15,6 +15,14 @@ namespace io {
 //! The number of interrupts generated by the timer per second.
 inline constexpr stl::size_t timer_freq_per_second {100};
 
+/**
+ * @brief Whether to stop periodic clock interrupts when only the idle thread can run.
+ *
+ * @details
+ * The CPU does not need to wake up on every tick when all threads are blocked or sleeping.
+ */
+inline constexpr bool timer_tickless_idle {true};
+
 /**
  * @brief Initialize the timer.
  *
@@ -25,7 +33,54 @@ void InitTimer(stl::size_t freq_per_second) noexcept;
 //! Get the number of ticks after system startup.
 stl::size_t GetTicks() noexcept;
 
+/**
+ * @brief Stop periodic clock interrupts and enter the tickless mode.
+ *
+ * @details
+ * The counter is reprogrammed to fire a one-shot clock interrupt after a number of ticks,
+ * which is limited by the counter width.
+ * Skipped ticks are counted in @p GetTicks after periodic clock interrupts restart.
+ * Interrupts must be disabled.
+ *
+ * @param idle_ticks The number of ticks until the next timed event, or @p npos if there is none.
+ */
+void StopTimerTick(stl::size_t idle_ticks) noexcept;
+
+/**
+ * @brief Restart periodic clock interrupts if the timer is in the tickless mode.
+ *
+ * @details
+ * It should be called when the CPU is woken up by an interrupt other than the one-shot clock interrupt.
+ */
+void ResumeTimerTick() noexcept;
+
+/**
+ * @brief Get the number of nanoseconds after the timer initialization.
+ *
+ * @details
+ * The monotonic clock is based on the time-stamp counter, which is calibrated against the timer at boot.
+ * It assumes the time-stamp counter has a constant rate.
+ */
+stl::uint64_t GetNanoseconds() noexcept;
+
+//! Get the calibrated frequency of the time-stamp counter.
+stl::uint64_t GetTscFreq() noexcept;
+
+//! Convert a number of time-stamp counter cycles to microseconds.
+stl::uint64_t ConvertTscToMicroseconds(stl::uint64_t cycles) noexcept;
+
 //! Whether the timer has been initialized.
 bool IsTimerInited() noexcept;
 
+namespace sc {
+
+class Timer {
+public:
+    Timer() = delete;
+
+    static void GetNanoseconds(stl::uint64_t* ns) noexcept;
+};
+
+}  // namespace sc
+
 }  // namespace io
\ No newline at end of file
@@ -0,0 +1,129 @@
+/**
+ * @file timer_wheel.h
+ * @brief One-shot and periodic kernel timers in a hierarchical timer wheel.
+ *
+ * @details
+ * A timer wheel has several levels of slots. A slot of level @p i covers @p 64^i ticks.
+ * A timer is put into the slot of the lowest level that can hold its expiration,
+ * so arming and cancelling a timer only link or unlink a list node.
+ * When the lowest level wraps around, timers in the next slot of the higher level
+ * are moved down to lower levels.
+ *
+ * @code
+ *  Level   Ticks per Slot   Slots
+ *    0            1           64   ─── Expire
+ *    1           64           64   ─── Cascade to the level 0
+ *    2         4096           64   ─── Cascade to the level 1
+ *    3       262144           64   ─── Cascade to the level 2
+ * @endcode
+ *
+ * The wheel is advanced by the clock interrupt.
+ * Callbacks of expired timers are run by the worker thread of the work queue.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/interrupt/work.h"
+#include "kernel/util/tag_list.h"
+
+namespace io {
+
+//! The number of bits of a slot index in a level of the timer wheel.
+inline constexpr stl::size_t timer_wheel_slot_bit_count {6};
+
+//! The number of slots in a level of the timer wheel.
+inline constexpr stl::size_t timer_wheel_slot_count {1 << timer_wheel_slot_bit_count};
+
+//! The number of levels of the timer wheel.
+inline constexpr stl::size_t timer_wheel_level_count {4};
+
+/**
+ * @brief The maximum number of ticks the timer wheel can hold.
+ *
+ * @details
+ * A timer expiring later is put into the last level and moved again when it is cascaded.
+ */
+inline constexpr stl::size_t max_timer_wheel_ticks {
+    1 << (timer_wheel_slot_bit_count * timer_wheel_level_count)};
+
+/**
+ * @brief A kernel timer.
+ *
+ * @details
+ * A timer is owned by its user and must not be destroyed while it is pending.
+ * Its methods can be called by threads and interrupt handlers.
+ */
+class KrnlTimer {
+    friend class TimerWheel;
+
+public:
+    using Callback = intr::Work::Callback;
+
+    KrnlTimer() noexcept = default;
+
+    KrnlTimer(const KrnlTimer&) = delete;
+
+    //! Set the callback and its argument. The timer must not be pending.
+    KrnlTimer& Init(Callback, void* arg = nullptr) noexcept;
+
+    /**
+     * @brief Arm or re-arm the timer.
+     *
+     * @param ticks The number of ticks until the first expiration. Zero means the next tick.
+     * @param period The number of ticks between later expirations, or zero for a one-shot timer.
+     */
+    KrnlTimer& Start(stl::size_t ticks, stl::size_t period = 0) noexcept;
+
+    /**
+     * @brief Cancel the timer.
+     *
+     * @details
+     * A callback that has been passed to the work queue is not cancelled.
+     *
+     * @return Whether the timer was pending.
+     */
+    bool Stop() noexcept;
+
+    //! Whether the timer is waiting for its next expiration.
+    bool IsPending() const noexcept;
+
+private:
+    //! The tag in a slot of the timer wheel.
+    TagList::Tag tag_;
+
+    //! The tick when the timer expires.
+    stl::size_t expire_tick_ {0};
+
+    //! The number of ticks between expirations of a periodic timer.
+    stl::size_t period_ {0};
+
+    Callback callback_ {nullptr};
+
+    void* arg_ {nullptr};
+
+    bool pending_ {false};
+};
+
+/**
+ * @brief Expire timers until a tick.
+ *
+ * @details
+ * It is called by the clock interrupt handler.
+ * Ticks skipped in the tickless mode are processed one by one.
+ * If the work queue is full, an expired timer is retried at the next tick.
+ */
+void RunKrnlTimers(stl::size_t ticks) noexcept;
+
+/**
+ * @brief Get the earliest tick when the timer wheel needs to be advanced, or @p npos if no timer is pending.
+ *
+ * @details
+ * A timer in higher levels is only reported at the next cascade,
+ * so the tick may be earlier than the real expiration.
+ */
+stl::size_t GetNextKrnlTimerTick() noexcept;
+
+}  // namespace io
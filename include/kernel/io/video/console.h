@@ -35,13 +35,33 @@ public:
 
     static void PrintHex(stl::int32_t) noexcept;
 
-    //! Read characters from the keyboard buffer.
-    static void Read(char* buf, stl::size_t count) noexcept;
+    /**
+     * @brief Print a number of characters, which do not need to end with a null character.
+     *
+     * @details
+     * The console is only locked once, so a user buffer can be printed by one system call.
+     */
+    static void Write(const char* buf, stl::size_t size) noexcept;
+
+    /**
+     * @brief Read a line or available characters from the keyboard by one call.
+     *
+     * @details
+     * It blocks until characters are available.
+     * In the canonical mode, it returns a whole line. In the raw mode, it returns all available characters.
+     *
+     * @return The number of characters read.
+     */
+    static stl::size_t Read(char* buf, stl::size_t size) noexcept;
+
+    //! Switch keyboard input between the canonical mode with line editing and the raw mode.
+    static void SetCanonical(bool canonical) noexcept;
 
     template <typename... Args>
-    static void Printf(const stl::string_view format, const Args... args) noexcept {
+    static void Printf(const FormatString<stl::type_identity_t<Args>...> format,
+                       const Args... args) noexcept {
         const stl::lock_guard guard {GetMutex()};
-        io::Printf(format, args...);
+        io::Printf<Args...>(format, args...);
     }
 
 private:
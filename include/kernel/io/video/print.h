@@ -2,6 +2,11 @@
  * @file print.h
  * @brief Text printing.
  *
+ * @details
+ * Printing functions write characters into the shadow buffer of the text screen,
+ * then copy changed lines to VGA memory and update the hardware cursor once.
+ * Characters are also mirrored to the serial port if it is present.
+ *
  * @par GitHub
  * https://github.com/Zhuagenborn
  */
@@ -11,6 +16,7 @@
 #include "kernel/debug/assert.h"
 #include "kernel/stl/cstdint.h"
 #include "kernel/stl/string_view.h"
+#include "kernel/util/format.h"
 
 namespace io {
 
@@ -31,10 +37,10 @@ void PrintlnChar(char) noexcept;
 //! Print an unsigned hexadecimal integer with a new line.
 void PrintlnHex(stl::uint32_t) noexcept;
 
-//! Print a hexadecimal integer with a new line.
+//! Print a signed hexadecimal integer with a new line.
 void PrintlnHex(stl::int32_t) noexcept;
 
-//! Print a hexadecimal integer.
+//! Print a signed hexadecimal integer. A negative integer is printed as @p - and its magnitude.
 void PrintHex(stl::int32_t) noexcept;
 
 extern "C" {
@@ -53,39 +59,62 @@ void SetCursorPos(stl::uint16_t) noexcept;
 
 //! Get the cursor position.
 stl::uint16_t GetCursorPos() noexcept;
+
+//! Set the start address of the display window in VGA text memory, in characters.
+void SetDisplayStart(stl::uint16_t) noexcept;
 }
 
 namespace _printf_impl {
 
-void Print(stl::uint32_t) noexcept;
+/**
+ * @brief A stack buffer collecting formatted text.
+ *
+ * @details
+ * Its content is printed by one call when the buffer is full or formatting finishes.
+ */
+class Buffer {
+public:
+    static constexpr stl::size_t size {128};
 
-void Print(stl::int32_t) noexcept;
+    Buffer() noexcept = default;
 
-void Print(char) noexcept;
+    Buffer(const Buffer&) = delete;
 
-void Print(stl::string_view) noexcept;
+    //! Print the remaining content.
+    ~Buffer() noexcept;
 
-void Print(const char*) noexcept;
+    Buffer& Append(stl::uint32_t) noexcept;
 
-void Printf(stl::string_view) noexcept;
+    Buffer& Append(stl::int32_t) noexcept;
 
-template <typename Arg, typename... Args>
-void Printf(const stl::string_view format, const Arg arg, const Args... args) noexcept {
-    for (stl::size_t i {0}; i != format.size(); ++i) {
-        if (format[i] == '{' && i + 1 != format.size() && format[i + 1] == '}') {
-            Print(arg);
-            return Printf(format.substr(i + 2), args...);
-        } else {
-            Print(format[i]);
-        }
-    }
-}
+    Buffer& Append(stl::uint64_t) noexcept;
+
+    Buffer& Append(char) noexcept;
+
+    Buffer& Append(stl::string_view) noexcept;
+
+    Buffer& Append(const char*) noexcept;
+
+private:
+    //! The space for a 32-bit integer in hexadecimal with a sign and a null character.
+    static constexpr stl::size_t max_num_len {10};
+
+    //! Print the content and clear the buffer.
+    void Print() noexcept;
+
+    char buf_[size];
+    stl::size_t len_ {0};
+};
 
 }  // namespace _printf_impl
 
 /**
  * @brief Print variadic values.
  *
+ * @details
+ * The format string is parsed at compile time.
+ * Values are formatted into a stack buffer and printed by one call.
+ *
  * @param format
  * A format string with a number of @p {}.
  * They will be replaced by the string representations of the arguments.
@@ -95,12 +124,19 @@ void Printf(const stl::string_view format, const Arg arg, const Args... args) no
  * - `stl::string_view`
  * - `stl::uint32_t`
  * - `stl::int32_t`
+ * - `stl::uint64_t`
+ *
+ * Integers are printed in hexadecimal without the prefix @p 0x.
+ * A negative @p stl::int32_t is printed as @p - and its magnitude, such as @p -1A, not as its two's complement.
  * @param args Variadic arguments to be printed.
  */
 template <typename... Args>
-void Printf(const stl::string_view format, const Args... args) noexcept {
-    dbg::Assert(!format.empty());
-    _printf_impl::Printf(format, args...);
+void Printf(const FormatString<stl::type_identity_t<Args>...> format,
+            const Args... args) noexcept {
+    _printf_impl::Buffer buf;
+    stl::size_t i {0};
+    (buf.Append(format.GetPiece(i++)).Append(args), ...);
+    buf.Append(format.GetPiece(i));
 }
 
 }  // namespace io
\ No newline at end of file
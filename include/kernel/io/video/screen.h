@@ -0,0 +1,110 @@
+/**
+ * @file screen.h
+ * @brief The VGA text screen with a shadow buffer.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/io/video/print.h"
+#include "kernel/stl/array.h"
+#include "kernel/util/bit.h"
+
+namespace io {
+
+/**
+ * @brief The VGA text screen with a shadow buffer.
+ *
+ * @details
+ * Characters are written into a shadow buffer in memory instead of VGA memory.
+ * - The cursor position is tracked in memory, so printing a character does not access CRT controller ports.
+ * - Lines in the buffer form a ring. Scrolling only moves the top line and clears the new bottom line.
+ * - Lines changed since the last flush are marked as dirty.
+ *   @p Flush copies only dirty lines to VGA memory and sets the hardware cursor once.
+ * - VGA text memory holds many more rows than the screen.
+ *   Scrolling moves the display window down by the start address register of the CRT controller,
+ *   so rows already in VGA memory are not copied again.
+ *   When the window reaches the end of VGA text memory, it wraps to the beginning and the whole screen is copied.
+ *
+ * Methods are not thread-safe. Interrupts should be disabled when calling them.
+ */
+class TextScreen {
+public:
+    static constexpr stl::size_t width {text_screen_width};
+
+    static constexpr stl::size_t height {text_screen_height};
+
+    //! The width of a horizontal tab.
+    static constexpr stl::size_t tab_width {2};
+
+    //! Load the current content and the cursor position from VGA memory.
+    TextScreen() noexcept;
+
+    TextScreen(const TextScreen&) = delete;
+
+    /**
+     * @brief Put a character at the cursor position and move the cursor.
+     *
+     * @details
+     * Carriage returns and line feeds both move the cursor to the beginning of the next line.
+     * VGA memory is not updated until @p Flush is called.
+     */
+    TextScreen& PutChar(char) noexcept;
+
+    TextScreen& PutStr(stl::string_view) noexcept;
+
+    //! Put an unsigned hexadecimal integer without the prefix @p 0x.
+    TextScreen& PutHex(stl::uint32_t) noexcept;
+
+    //! Copy dirty lines to VGA memory and update the hardware cursor.
+    TextScreen& Flush() noexcept;
+
+    //! Whether there are changes that have not been flushed.
+    bool IsDirty() const noexcept;
+
+private:
+    //! A character with its attribute in the low and high bytes.
+    using Cell = stl::uint16_t;
+
+    //! The attribute of blanks, which are light gray on black.
+    static constexpr Cell blank_attr {0x07};
+
+    using Line = stl::array<Cell, width>;
+
+    static_assert(height <= sizeof(stl::uint32_t) * bit::byte_len);
+
+    //! Get a line by its row on the screen.
+    Line& GetLine(stl::size_t row) noexcept;
+
+    //! Scroll the screen up by one line.
+    void ScrollUp() noexcept;
+
+    void MarkDirty(stl::size_t row) noexcept;
+
+    stl::array<Line, height> lines_;
+
+    //! The index of the line at the top of the screen in @p lines_.
+    stl::size_t top_ {0};
+
+    //! The cursor position as an offset from the top-left of the screen.
+    stl::size_t cursor_ {0};
+
+    //! The bit @p i is set if the row @p i has been changed since the last flush.
+    stl::uint32_t dirty_rows_ {0};
+
+    //! Whether the cursor has been moved since the last flush.
+    bool cursor_moved_ {false};
+
+    //! The row in VGA text memory at the top of the display window.
+    stl::size_t vga_top_ {0};
+
+    //! Whether the display window has been moved since the last flush.
+    bool window_moved_ {false};
+};
+
+//! Get the VGA text screen.
+TextScreen& GetTextScreen() noexcept;
+
+}  // namespace io
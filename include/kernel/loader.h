@@ -0,0 +1,103 @@
+/**
+ * @file loader.h
+ * @brief Data saved by the kernel loader.
+ *
+ * @details
+ * The loader saves data for the kernel in its data area, after global descriptors.
+ * The layout must be the same as in @p src/boot/loader.asm,
+ * which is checked against @p loader_krnl_data_base and @p loader_krnl_data_size in @p kernel/krnl.inc.
+ *
+ * @code
+ *   Loader data area (0x900)
+ *  ┌───────────────────────────┐
+ *  │ Global descriptors        │
+ *  ├───────────────────────────┤ ◄── loader_krnl_data_base
+ *  │ Total memory size         │
+ *  │ Time-stamp counters       │
+ *  │ Memory map (E820)         │
+ *  └───────────────────────────┘
+ * @endcode
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/descriptor/desc.h"
+#include "kernel/descriptor/gdt/idx.h"
+#include "kernel/stl/array.h"
+
+//! The base address of the loader data area.
+inline constexpr stl::uintptr_t loader_base {0x900};
+
+//! The address of data saved by the loader for the kernel, after global descriptors.
+inline constexpr stl::uintptr_t loader_krnl_data_base {loader_base
+                                                       + gdt::count * sizeof(desc::SegDesc)};
+
+//! The maximum number of address range descriptors saved by the loader.
+inline constexpr stl::size_t max_mem_map_count {20};
+
+/**
+ * @brief The address range descriptor reported by @p INT 0x15, @p AX 0xE820.
+ *
+ * @details
+ * It has the same layout as @p AddrRangeDesc in @p src/boot/loader.asm.
+ */
+struct AddrRangeDesc {
+    //! Whether the range can be used by the operating system.
+    bool IsUsable() const noexcept {
+        return type == 1;
+    }
+
+    stl::uint64_t GetBase() const noexcept {
+        return (static_cast<stl::uint64_t>(base_addr_high) << 32) | base_addr_low;
+    }
+
+    stl::uint64_t GetLen() const noexcept {
+        return (static_cast<stl::uint64_t>(len_high) << 32) | len_low;
+    }
+
+    stl::uint32_t base_addr_low;
+    stl::uint32_t base_addr_high;
+    stl::uint32_t len_low;
+    stl::uint32_t len_high;
+    stl::uint32_t type;
+};
+
+static_assert(sizeof(AddrRangeDesc) == 20);
+
+//! Data saved by the loader for the kernel.
+struct LoaderData {
+    //! The total memory size in bytes.
+    stl::uint32_t total_mem_size;
+
+    //! The time-stamp counter when the master boot record starts to run.
+    stl::uint64_t mbr_tsc;
+
+    //! The time-stamp counter when the loader starts to run.
+    stl::uint64_t loader_tsc;
+
+    //! The time-stamp counter when the loader jumps to the kernel.
+    stl::uint64_t krnl_tsc;
+
+    //! The number of address range descriptors, or @p 0 if BIOS does not support @p INT 0x15, @p AX 0xE820.
+    stl::uint32_t mem_map_count;
+
+    stl::array<AddrRangeDesc, max_mem_map_count> mem_map;
+};
+
+static_assert(__builtin_offsetof(LoaderData, mbr_tsc) == 4);
+static_assert(__builtin_offsetof(LoaderData, mem_map_count) == 28);
+static_assert(__builtin_offsetof(LoaderData, mem_map) == 32);
+//! It must be the same as @p loader_krnl_data_size in @p kernel/krnl.inc.
+static_assert(sizeof(LoaderData) == 432);
+
+/**
+ * @brief Get data saved by the loader.
+ *
+ * @details
+ * The address is read through a volatile variable,
+ * so the compiler does not treat the fixed low address as an out-of-bounds access to a null pointer.
+ */
+const LoaderData& GetLoaderData() noexcept;
@@ -0,0 +1,111 @@
+/**
+ * @file buddy.h
+ * @brief The binary buddy page allocator.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/util/bitmap.h"
+
+namespace mem {
+
+/**
+ * @brief The binary buddy allocator that allocates page indices.
+ *
+ * @details
+ * Pages are grouped into blocks of @p 2^order pages.
+ * Each order has a bitmap, in which a clear bit means a free block that is not part of a larger free block.
+ * - When allocating, the smallest order with a free block is found by free counts.
+ *   If the block is larger than required, it is split and the unused buddies are freed to lower orders.
+ * - When freeing, a block is merged with its buddy repeatedly as long as the buddy is free.
+ *
+ * @code
+ * Order 2 │               0               │
+ * Order 1 │       0       │       1       │
+ * Order 0 │   0   │   1   │   2   │   3   │
+ * @endcode
+ *
+ * Requests whose sizes are not powers of two are rounded up, and the excess pages are freed immediately,
+ * so pages can be freed in any grouping, such as one by one.
+ */
+class BuddyAllocator {
+public:
+    //! The maximum order. The largest block has @p 2^max_order pages.
+    static constexpr stl::size_t max_order {10};
+
+    //! Get the length of the bitmap buffer in bytes required by a number of pages.
+    static stl::size_t CalcBitmapByteLen(stl::size_t page_count) noexcept;
+
+    BuddyAllocator() noexcept = default;
+
+    BuddyAllocator(const BuddyAllocator&) = delete;
+
+    /**
+     * @brief Initialize the allocator. All pages are free.
+     *
+     * @param bits A bitmap buffer, whose length is calculated by @p CalcBitmapByteLen.
+     * @param page_count The number of pages.
+     */
+    BuddyAllocator& Init(void* bits, stl::size_t page_count) noexcept;
+
+    /**
+     * @brief Try to allocate the specified number of continuous pages.
+     *
+     * @return
+     * The beginning index of the allocated pages if it succeeds.
+     * Otherwise, @p npos.
+     */
+    stl::size_t Alloc(stl::size_t count = 1) noexcept;
+
+    BuddyAllocator& Free(stl::size_t begin, stl::size_t count = 1) noexcept;
+
+    /**
+     * @brief Mark free pages as allocated, such as holes in physical memory.
+     *
+     * @details
+     * The free block containing each page is split, and the halves not containing the page are freed to lower orders.
+     */
+    BuddyAllocator& Reserve(stl::size_t begin, stl::size_t count = 1) noexcept;
+
+    stl::size_t GetPageCount() const noexcept;
+
+    //! Whether a page is in a free block.
+    bool IsFree(stl::size_t idx) const noexcept;
+
+    //! The number of block splits.
+    stl::size_t GetSplitCount() const noexcept;
+
+    //! The number of buddy merges.
+    stl::size_t GetMergeCount() const noexcept;
+
+private:
+    static constexpr stl::size_t order_count {max_order + 1};
+
+    //! Get the number of complete blocks of an order.
+    static stl::size_t CalcBlockCount(stl::size_t page_count, stl::size_t order) noexcept;
+
+    //! Get the smallest order whose blocks can hold a number of pages.
+    static stl::size_t CalcOrder(stl::size_t count) noexcept;
+
+    //! Free a block and merge it with its free buddies.
+    BuddyAllocator& FreeBlock(stl::size_t idx, stl::size_t order) noexcept;
+
+    stl::size_t page_count_ {0};
+
+    //! The number of orders that have at least one complete block.
+    stl::size_t used_order_count_ {0};
+
+    stl::array<Bitmap, order_count> free_blocks_;
+
+    stl::array<stl::size_t, order_count> free_counts_;
+
+    stl::size_t split_count_ {0};
+
+    stl::size_t merge_count_ {0};
+};
+
+}  // namespace mem
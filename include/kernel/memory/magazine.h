@@ -0,0 +1,87 @@
+/**
+ * @file magazine.h
+ * @brief Per-thread memory block caches.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+
+namespace mem {
+
+/**
+ * @brief The memory block magazine.
+ *
+ * @details
+ * A magazine is a small stack of free blocks of the same size, owned by a thread.
+ * Allocation and release first try the magazine of the current thread,
+ * which does not need to lock the memory pool.
+ * - When a magazine is empty, it is refilled from the free block list of @p MemBlockDesc in a batch.
+ * - When a magazine is full, a batch of blocks is drained back to the free block list.
+ *
+ * Blocks in a magazine are still counted as allocated by their arenas.
+ */
+class MemBlockMagazine {
+public:
+    //! The maximum number of blocks in a magazine.
+    static constexpr stl::size_t capacity {8};
+
+    //! The number of blocks moved between a magazine and a block descriptor at a time.
+    static constexpr stl::size_t batch_size {capacity / 2};
+
+    MemBlockMagazine() noexcept = default;
+
+    MemBlockMagazine(const MemBlockMagazine&) = delete;
+
+    constexpr bool IsEmpty() const noexcept {
+        return count_ == 0;
+    }
+
+    constexpr bool IsFull() const noexcept {
+        return count_ == capacity;
+    }
+
+    constexpr stl::size_t GetCount() const noexcept {
+        return count_;
+    }
+
+    MemBlockMagazine& Push(void* block) noexcept;
+
+    void* Pop() noexcept;
+
+    MemBlockMagazine& Clear() noexcept;
+
+private:
+    stl::size_t count_ {0};
+    stl::array<void*, capacity> blocks_;
+};
+
+/**
+ * @brief Memory block magazines for all block sizes of @p MemBlockDescTab.
+ *
+ * @details
+ * Each magazine caches blocks for the descriptor with the same index.
+ */
+class MemBlockMagazines {
+public:
+    //! The number of magazines. It must be the same as the number of block descriptors.
+    static constexpr stl::size_t count {23};
+
+    MemBlockMagazines() noexcept = default;
+
+    MemBlockMagazines(const MemBlockMagazines&) = delete;
+
+    const MemBlockMagazine& operator[](stl::size_t) const noexcept;
+
+    MemBlockMagazine& operator[](stl::size_t) noexcept;
+
+    MemBlockMagazines& Clear() noexcept;
+
+private:
+    stl::array<MemBlockMagazine, count> mags_;
+};
+
+}  // namespace mem
@@ -20,6 +20,8 @@ inline constexpr stl::size_t page_dir_count {1024};
 inline constexpr stl::size_t page_dir_self_ref {page_dir_count - 1};
 //! The size of a page in bytes.
 inline constexpr stl::size_t page_size {KB(4)};
+//! The size of a large page mapped directly by a page directory entry in bytes.
+inline constexpr stl::size_t large_page_size {MB(4)};
 
 //! Align an address to its page base.
 constexpr stl::uintptr_t AlignToPageBase(const stl::uintptr_t addr) noexcept {
@@ -57,6 +59,8 @@ constexpr stl::size_t CalcPageCount(const stl::size_t size) noexcept {
  *                      └─ 1: The page is global.
  * @endcode
  *
+ * The kernel uses the lowest available bit @p AVL to mark copy-on-write pages.
+ *
  * In @p src/boot/loader.asm, the page directory table is initialized as follows:
  *
  * @code
@@ -141,6 +145,139 @@ public:
         return *this;
     }
 
+    //! Whether writes to the page go to memory without being held in caches.
+    constexpr bool IsWriteThrough() const noexcept {
+        return bit::IsBitSet(entry_, pwt_pos);
+    }
+
+    constexpr PageEntry& SetWriteThrough(const bool write_through = true) noexcept {
+        if (write_through) {
+            bit::SetBit(entry_, pwt_pos);
+        } else {
+            bit::ResetBit(entry_, pwt_pos);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Whether the page is not cached.
+     *
+     * @details
+     * Memory-mapped device registers must not be cached,
+     * since reading or writing them has side effects.
+     */
+    constexpr bool IsCacheDisabled() const noexcept {
+        return bit::IsBitSet(entry_, pcd_pos);
+    }
+
+    constexpr PageEntry& SetCacheDisabled(const bool disabled = true) noexcept {
+        if (disabled) {
+            bit::SetBit(entry_, pcd_pos);
+        } else {
+            bit::ResetBit(entry_, pcd_pos);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Whether the page is global.
+     *
+     * @details
+     * The TLB entry of a global page is not flushed when @p CR3 is reloaded.
+     * Kernel pages are global since all processes share them.
+     */
+    constexpr bool IsGlobal() const noexcept {
+        return bit::IsBitSet(entry_, g_pos);
+    }
+
+    constexpr PageEntry& SetGlobal(const bool global = true) noexcept {
+        if (global) {
+            bit::SetBit(entry_, g_pos);
+        } else {
+            bit::ResetBit(entry_, g_pos);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Whether the page has been written.
+     *
+     * @details
+     * The processor sets the bit when the page is written. It is never cleared by the processor.
+     */
+    constexpr bool IsDirty() const noexcept {
+        return bit::IsBitSet(entry_, d_pos);
+    }
+
+    constexpr PageEntry& SetDirty(const bool dirty = true) noexcept {
+        if (dirty) {
+            bit::SetBit(entry_, d_pos);
+        } else {
+            bit::ResetBit(entry_, d_pos);
+        }
+
+        return *this;
+    }
+
+    //! Whether a page directory entry maps a 4 MB page directly without a page table.
+    constexpr bool IsLarge() const noexcept {
+        return bit::IsBitSet(entry_, ps_pos);
+    }
+
+    constexpr PageEntry& SetLarge(const bool large = true) noexcept {
+        if (large) {
+            bit::SetBit(entry_, ps_pos);
+        } else {
+            bit::ResetBit(entry_, ps_pos);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Whether the page is copy-on-write.
+     *
+     * @details
+     * A copy-on-write page is read-only and shared by multiple processes.
+     * When a process writes to it, the page fault handler gives the process its own copy.
+     */
+    constexpr bool IsCopyOnWrite() const noexcept {
+        return bit::IsBitSet(entry_, cow_pos);
+    }
+
+    constexpr PageEntry& SetCopyOnWrite(const bool cow = true) noexcept {
+        if (cow) {
+            bit::SetBit(entry_, cow_pos);
+        } else {
+            bit::ResetBit(entry_, cow_pos);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Whether the page belongs to a shared memory region.
+     *
+     * @details
+     * A shared page stays writable and is not copied on write after forking.
+     */
+    constexpr bool IsShared() const noexcept {
+        return bit::IsBitSet(entry_, shared_pos);
+    }
+
+    constexpr PageEntry& SetShared(const bool shared = true) noexcept {
+        if (shared) {
+            bit::SetBit(entry_, shared_pos);
+        } else {
+            bit::ResetBit(entry_, shared_pos);
+        }
+
+        return *this;
+    }
+
     constexpr stl::uintptr_t GetAddress() const noexcept {
         return bit::GetBits(entry_, addr_pos, addr_len) << addr_pos;
     }
@@ -158,6 +295,13 @@ private:
     static constexpr stl::size_t p_pos {0};
     static constexpr stl::size_t rw_pos {p_pos + 1};
     static constexpr stl::size_t us_pos {rw_pos + 1};
+    static constexpr stl::size_t pwt_pos {us_pos + 1};
+    static constexpr stl::size_t pcd_pos {pwt_pos + 1};
+    static constexpr stl::size_t d_pos {6};
+    static constexpr stl::size_t ps_pos {7};
+    static constexpr stl::size_t g_pos {8};
+    static constexpr stl::size_t cow_pos {9};
+    static constexpr stl::size_t shared_pos {10};
     static constexpr stl::size_t addr_pos {12};
     static constexpr stl::size_t addr_len {20};
 
@@ -249,7 +393,15 @@ public:
 
     //! Whether the virtual address is mapped to a physical address.
     constexpr bool IsMapped() const noexcept {
-        return GetPageDirEntry().IsPresent() && GetPageTabEntry().IsPresent();
+        const auto& page_dir_entry {GetPageDirEntry()};
+        return page_dir_entry.IsPresent()
+               && (page_dir_entry.IsLarge() || GetPageTabEntry().IsPresent());
+    }
+
+    //! Whether the virtual address is in a 4 MB page mapped directly by its page directory entry.
+    constexpr bool IsInLargePage() const noexcept {
+        const auto& page_dir_entry {GetPageDirEntry()};
+        return page_dir_entry.IsPresent() && page_dir_entry.IsLarge();
     }
 
     /**
@@ -283,6 +435,9 @@ public:
      * 2. The middle 10 bits of @p 0xFFC00000 are @p 0.
      *    The first directory entry indexed @p 0, which points to the first page table, is treated as a page entry.
      * 3. By setting the value of the first 10 bits, we can access different page tables.
+     *
+     * @warning
+     * A virtual address in a 4 MB page does not have a page table entry.
      */
     constexpr PageEntry& GetPageTabEntry() const noexcept {
         const stl::uintptr_t addr {VrAddr {}
@@ -300,11 +455,21 @@ public:
     //! Get the mapped physical address.
     stl::uintptr_t GetPhyAddr() const noexcept;
 
-    //! Map the virtual address to a physical address.
+    /**
+     * @brief Map the virtual address to a physical address.
+     *
+     * @details
+     * Kernel pages are mapped as global pages.
+     */
     const VrAddr& MapToPhyAddr(stl::uintptr_t phy_addr) const noexcept;
 
     VrAddr& MapToPhyAddr(stl::uintptr_t phy_addr) noexcept;
 
+    //! Invalidate the Translation Lookaside Buffer (TLB) entry after the page table entry is modified.
+    const VrAddr& FlushTlb() const noexcept;
+
+    VrAddr& FlushTlb() noexcept;
+
 private:
     static constexpr stl::size_t offset_pos {0};
     static constexpr stl::size_t offset_len {12};
@@ -347,4 +512,44 @@ inline constexpr stl::uintptr_t krnl_page_dir_phy_base {MB(1)};
  */
 inline constexpr stl::uintptr_t page_dir_base {0xFFFFF000};
 
+/**
+ * @brief A source of physical pages for @p MapRange.
+ *
+ * @return A physical page address, or @p 0 if no page is available.
+ */
+using PhyPageSource = stl::uintptr_t (*)(void* arg) noexcept;
+
+//! A callback receiving the physical address of each page unmapped by @p UnmapRange.
+using PhyPageSink = void (*)(stl::uintptr_t phy_addr, void* arg) noexcept;
+
+/**
+ * @brief Map continuous virtual pages to physical pages in one pass.
+ *
+ * @details
+ * Missing page tables are created once for each 4 MB span. Kernel pages are mapped as global pages.
+ *
+ * @param vr_base The virtual base address.
+ * @param count The number of pages.
+ * @param src A source providing a physical page for each virtual page.
+ * @param arg An argument passed to the source.
+ * @return The number of mapped pages. It is less than @p count if the source runs out of pages.
+ */
+stl::size_t MapRange(stl::uintptr_t vr_base, stl::size_t count, PhyPageSource src,
+                     void* arg = nullptr) noexcept;
+
+/**
+ * @brief Unmap continuous virtual pages in one pass.
+ *
+ * @details
+ * Pages that have not been mapped are skipped.
+ * TLB entries of a small range are invalidated one by one. For a large range, the whole TLB is flushed once.
+ *
+ * @param vr_base The virtual base address.
+ * @param count The number of pages.
+ * @param sink An optional callback receiving the physical address of each unmapped page.
+ * @param arg An argument passed to the callback.
+ */
+void UnmapRange(stl::uintptr_t vr_base, stl::size_t count, PhyPageSink sink = nullptr,
+                void* arg = nullptr) noexcept;
+
 }  // namespace mem
\ No newline at end of file
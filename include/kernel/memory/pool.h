@@ -8,8 +8,11 @@
 
 #pragma once
 
+#include "kernel/memory/buddy.h"
+#include "kernel/memory/magazine.h"
 #include "kernel/stl/array.h"
 #include "kernel/stl/mutex.h"
+#include "kernel/util/bit.h"
 #include "kernel/util/bitmap.h"
 #include "kernel/util/metric.h"
 #include "kernel/util/tag_list.h"
@@ -18,15 +21,25 @@ namespace mem {
 
 enum class PoolType { Kernel, User };
 
+class SlabCacheBase;
+
 /**
  * @brief The virtual address pool that allocates virtual addresses in pages.
  *
+ * @details
+ * Addresses can be managed by one of two backends:
+ * - A bitmap, which needs one bit for each page in the whole range.
+ * - A sorted list of allocated ranges, where adjacent ranges are merged.
+ *   Its memory overhead scales with the number of ranges rather than the size of the address space.
+ *
  * @warning
  * This class only manages virtual addresses. They cannot be accessed directly after allocation.
  * Each address should be mapped to a physical page allocated by @p PhyMemPagePool using @p VrAddr::MapToPhyAddr.
  */
 class VrAddrPool {
 public:
+    enum class Backend { Bitmap, Range };
+
     VrAddrPool() noexcept = default;
 
     /**
@@ -39,8 +52,24 @@ public:
 
     VrAddrPool(const VrAddrPool&) = delete;
 
+    //! Initialize the pool with the bitmap backend.
     VrAddrPool& Init(stl::uintptr_t start_vr_addr, Bitmap bitmap) noexcept;
 
+    /**
+     * @brief Initialize the pool with the range backend.
+     *
+     * @warning
+     * Range nodes are allocated from the kernel memory pool,
+     * so this backend cannot be used by the kernel virtual address pool.
+     *
+     * @param start_vr_addr The virtual start address.
+     * @param page_count The number of pages.
+     */
+    VrAddrPool& Init(stl::uintptr_t start_vr_addr, stl::size_t page_count) noexcept;
+
+    //! Copy allocated addresses from another virtual address pool with the same range and backend.
+    VrAddrPool& CopyFrom(const VrAddrPool&) noexcept;
+
     /**
      * @brief Allocate a number of continuous virtual page addresses.
      *
@@ -57,29 +86,124 @@ public:
      */
     stl::uintptr_t AllocPageAtAddr(stl::uintptr_t vr_addr) noexcept;
 
+    /**
+     * @brief Allocate a number of continuous virtual page addresses at a specific virtual address.
+     *
+     * @param vr_base A virtual base address aligned to a page.
+     * @param count The number of pages.
+     * @return The virtual base address, or @p 0 if any of the pages is out of the pool or has been allocated.
+     */
+    stl::uintptr_t AllocPagesAtAddr(stl::uintptr_t vr_base, stl::size_t count) noexcept;
+
     VrAddrPool& FreePages(stl::uintptr_t vr_base, stl::size_t count = 1) noexcept;
 
+    //! Free all addresses. Range nodes are returned to their slab cache.
+    VrAddrPool& Clear() noexcept;
+
+    //! Whether a virtual address belongs to the pool and has been allocated.
+    bool IsAlloc(stl::uintptr_t vr_addr) const noexcept;
+
     stl::size_t GetFreeCount() const noexcept;
 
     stl::uintptr_t GetStartAddr() const noexcept;
 
+    Backend GetBackend() const noexcept;
+
+    //! Get the bitmap. The backend must be @p Backend::Bitmap.
     const Bitmap& GetBitmap() const noexcept;
 
+    //! Get the number of allocated ranges. The backend must be @p Backend::Range.
+    stl::size_t GetRangeCount() const noexcept;
+
 private:
+    //! A range of allocated pages.
+    struct Range;
+
+    //! Get the slab cache of range nodes.
+    static SlabCacheBase& GetRangeCache() noexcept;
+
+    //! Mark pages as allocated in the range list.
+    VrAddrPool& AllocRange(stl::size_t page_begin, stl::size_t count) noexcept;
+
+    //! Mark pages as free in the range list.
+    VrAddrPool& FreeRange(stl::size_t page_begin, stl::size_t count) noexcept;
+
+    //! Free all range nodes.
+    VrAddrPool& ClearRanges() noexcept;
+
+    //! Whether all pages are in the pool and free.
+    bool IsFree(stl::size_t page_begin, stl::size_t count) const noexcept;
+
     stl::uintptr_t start_vr_addr_ {0};
     stl::size_t free_count_ {0};
+    Backend backend_ {Backend::Bitmap};
     Bitmap bitmap_;
+
+    //! The total number of pages for the range backend.
+    stl::size_t page_count_ {0};
+    Range* ranges_ {nullptr};
+    stl::size_t range_count_ {0};
+};
+
+/**
+ * @brief A cache of zeroed physical pages.
+ *
+ * @details
+ * The idle thread zeroes free pages ahead of time and saves them in the cache,
+ * so allocations requiring zeroed memory do not need to zero pages by themselves.
+ * Pages in the cache have been allocated from their physical memory pool.
+ */
+class ZeroedPageCache {
+public:
+    static constexpr stl::size_t capacity {16};
+
+    ZeroedPageCache() noexcept = default;
+
+    ZeroedPageCache(const ZeroedPageCache&) = delete;
+
+    bool IsEmpty() const noexcept;
+
+    bool IsFull() const noexcept;
+
+    stl::size_t GetCount() const noexcept;
+
+    ZeroedPageCache& Push(stl::uintptr_t phy_addr) noexcept;
+
+    stl::uintptr_t Pop() noexcept;
+
+    ZeroedPageCache& Clear() noexcept;
+
+private:
+    stl::array<stl::uintptr_t, capacity> pages_;
+    stl::size_t count_ {0};
 };
 
 /**
  * @brief The physical memory pool that allocates physical memory in pages.
  *
+ * @details
+ * Pages can be managed by one of two backends:
+ * - A bitmap, which scans for continuous free bits.
+ * - A binary buddy allocator @p BuddyAllocator, which allocates and frees pages in logarithmic time and coalesces freed pages.
+ *
  * @warning
  * This class only manages physical pages. They cannot be accessed directly after allocation.
  * Each page should be associated with a virtual address allocated by @p VrAddrPool using @p VrAddr::MapToPhyAddr.
  */
 class PhyMemPagePool {
 public:
+    enum class Backend { Bitmap, Buddy };
+
+    //! Allocation counters.
+    struct Stats {
+        //! The number of successful allocations.
+        stl::size_t alloc_count;
+        //! The number of failed allocations.
+        stl::size_t fail_count;
+        //! The number of releases.
+        stl::size_t free_count;
+    };
+
     PhyMemPagePool() noexcept = default;
 
     /**
@@ -92,8 +216,25 @@ public:
 
     PhyMemPagePool(const PhyMemPagePool&) = delete;
 
+    //! Initialize the pool with the bitmap backend.
     PhyMemPagePool& Init(stl::uintptr_t start_phy_addr, Bitmap bitmap) noexcept;
 
+    /**
+     * @brief Initialize the pool with the buddy backend.
+     *
+     * @param start_phy_addr The physical start address.
+     * @param bits A bitmap buffer, whose length is calculated by @p BuddyAllocator::CalcBitmapByteLen.
+     * @param page_count The number of pages.
+     */
+    PhyMemPagePool& Init(stl::uintptr_t start_phy_addr, void* bits, stl::size_t page_count) noexcept;
+
+    /**
+     * @brief Enable reference counts for pages shared by multiple processes.
+     *
+     * @param counts A buffer containing one byte for each page.
+     */
+    PhyMemPagePool& InitRefCounts(void* counts) noexcept;
+
     /**
      * @brief Allocate a number of continuous physical pages.
      *
@@ -104,8 +245,35 @@ public:
 
     stl::size_t GetFreeCount() const noexcept;
 
+    //! Get the total number of pages, including reserved pages.
+    stl::size_t GetPageCount() const noexcept;
+
+    //! Whether a page is free in the backend.
+    bool IsFree(stl::size_t page_idx) const noexcept;
+
+    /**
+     * @brief Free a number of continuous physical pages.
+     *
+     * @details
+     * If reference counts are enabled, a shared page is only freed when its last reference is dropped.
+     */
     PhyMemPagePool& FreePages(stl::uintptr_t phy_base, stl::size_t count = 1) noexcept;
 
+    /**
+     * @brief Mark a number of continuous free pages as allocated forever.
+     *
+     * @details
+     * It is used for pages that cannot be allocated, such as holes in physical memory and pool metadata.
+     * Reserved pages are not counted as free pages.
+     */
+    PhyMemPagePool& ReservePages(stl::uintptr_t phy_base, stl::size_t count = 1) noexcept;
+
+    //! Add a reference to an allocated page. Reference counts must be enabled.
+    PhyMemPagePool& SharePage(stl::uintptr_t phy_addr) noexcept;
+
+    //! Get the reference count of an allocated page. Reference counts must be enabled.
+    stl::size_t GetRefCount(stl::uintptr_t phy_addr) const noexcept;
+
     /**
      * Get a lock.
      * Before allocation or release, it must be locked.
@@ -114,11 +282,33 @@ public:
 
     stl::uintptr_t GetStartAddr() const noexcept;
 
+    Backend GetBackend() const noexcept;
+
+    const Stats& GetStats() const noexcept;
+
+    //! Get the buddy allocator. The backend must be @p Backend::Buddy.
+    const BuddyAllocator& GetBuddy() const noexcept;
+
+    //! Get zeroed pages allocated from the pool.
+    const ZeroedPageCache& GetZeroedPages() const noexcept;
+
+    ZeroedPageCache& GetZeroedPages() noexcept;
+
 private:
+    //! Free pages in the backend without checking reference counts.
+    PhyMemPagePool& FreePagesImpl(stl::size_t page_idx, stl::size_t count) noexcept;
+
     mutable stl::mutex mtx_;
     stl::uintptr_t start_phy_addr_ {0};
     stl::size_t free_count_ {0};
+    Backend backend_ {Backend::Bitmap};
+    Stats stats_ {};
     Bitmap bitmap_;
+    BuddyAllocator buddy_;
+    ZeroedPageCache zeroed_pages_;
+
+    //! Reference counts of pages, or @p nullptr if pages cannot be shared.
+    stl::uint8_t* ref_counts_ {nullptr};
 };
 
 /**
@@ -152,6 +342,25 @@ private:
  */
 class MemBlockDesc {
 public:
+    //! The default maximum number of empty arenas retained before their pages are freed.
+    static constexpr stl::size_t default_max_empty_arena_count {1};
+
+    //! Arena counters.
+    struct Stats {
+        //! The number of arenas allocated from pages.
+        stl::size_t arena_alloc_count;
+        //! The number of arenas whose pages have been freed.
+        stl::size_t arena_free_count;
+        //! The number of times an empty arena was retained instead of being freed.
+        stl::size_t arena_retain_count;
+        //! The number of times a retained empty arena was reused.
+        stl::size_t arena_reuse_count;
+        //! The number of block allocations.
+        stl::size_t block_alloc_count;
+        //! The number of block releases.
+        stl::size_t block_free_count;
+    };
+
     MemBlockDesc() noexcept = default;
 
     explicit MemBlockDesc(stl::size_t block_size) noexcept;
@@ -168,6 +377,42 @@ public:
 
     TagList& GetFreeBlockList() noexcept;
 
+    //! Get the number of empty arenas whose blocks are all in the free block list.
+    stl::size_t GetEmptyArenaCount() const noexcept;
+
+    stl::size_t GetMaxEmptyArenaCount() const noexcept;
+
+    /**
+     * @brief Set the maximum number of empty arenas retained before their pages are freed.
+     *
+     * @details
+     * Retained arenas avoid allocating and mapping a new page when blocks are allocated and freed repeatedly at an arena boundary.
+     */
+    MemBlockDesc& SetMaxEmptyArenaCount(stl::size_t count) noexcept;
+
+    /**
+     * @brief Update the counters when an arena is allocated, freed or retained.
+     *
+     * @details
+     * It is called by memory allocation methods. The memory pool must be locked.
+     */
+    MemBlockDesc& OnArenaAlloc() noexcept;
+
+    MemBlockDesc& OnArenaFree() noexcept;
+
+    MemBlockDesc& OnArenaRetain() noexcept;
+
+    //! Update the counters when a retained empty arena is freed by memory reclaim.
+    MemBlockDesc& OnArenaRelease() noexcept;
+
+    MemBlockDesc& OnArenaReuse() noexcept;
+
+    MemBlockDesc& OnBlockAlloc() noexcept;
+
+    MemBlockDesc& OnBlockFree() noexcept;
+
+    const Stats& GetStats() const noexcept;
+
 private:
     //! The block size managed by the memory block descriptor.
     stl::size_t block_size_ {0};
@@ -177,26 +422,34 @@ private:
 
     //! The free blocks in the current arena.
     TagList free_blocks_;
+
+    stl::size_t empty_arena_count_ {0};
+    stl::size_t max_empty_arena_count_ {default_max_empty_arena_count};
+    Stats stats_ {};
 };
 
 /**
  * @brief The memory block descriptor table.
  *
  * @details
- * The memory block descriptor table contains memory block descriptors for different block sizes:
- * - 16 bytes.
- * - 32 bytes.
- * - 64 bytes.
- * - 128 bytes.
- * - 256 bytes.
- * - 512 bytes.
+ * The memory block descriptor table contains memory block descriptors for different block sizes from 16 to 1024 bytes:
+ * - 16 and 24 bytes.
+ * - From 32 bytes, four sizes between two powers of two, such as 32, 40, 48 and 56 bytes.
  * - 1024 bytes.
+ * All block sizes are multiples of @p block_size_step, so a suitable descriptor is found by a lookup table.
  * A user process has a memory block descriptor table for heap memory management.
  */
 class MemBlockDescTab {
 public:
     static constexpr stl::size_t min_block_size {16};
     static constexpr stl::size_t max_block_size {1024};
+    //! The granularity and alignment of block sizes.
+    static constexpr stl::size_t block_size_step {8};
+    //! The number of block descriptors.
+    static constexpr stl::size_t count {23};
+
+    //! Get the block size of a descriptor.
+    static stl::size_t GetBlockSize(stl::size_t idx) noexcept;
 
     MemBlockDescTab() noexcept;
 
@@ -208,7 +461,11 @@ public:
 
     MemBlockDesc* GetMinDesc(stl::size_t) noexcept;
 
-    //! Get the smallest descriptor that satisfies the required size.
+    /**
+     * @brief Get the smallest descriptor that satisfies the required size.
+     *
+     * @return The descriptor, or @p nullptr if the size is larger than @p max_block_size.
+     */
     const MemBlockDesc* GetMinDesc(stl::size_t) const noexcept;
 
     constexpr stl::size_t size() const noexcept {
@@ -240,11 +497,60 @@ public:
     }
 
 private:
-    static constexpr stl::size_t count {7};
+    static_assert(count == MemBlockMagazines::count);
 
     stl::array<MemBlockDesc, count> descs_;
 };
 
+/**
+ * @brief Memory statistics of a memory pool.
+ *
+ * @warning
+ * Its layout must be the same as @p usr::mem::MemStats.
+ */
+struct MemStats {
+    /**
+     * @brief The number of buckets in the free-run histogram.
+     *
+     * @details
+     * The bucket @p i counts runs of continuous free pages whose lengths are in @p [2^i, 2^(i+1)).
+     * The last bucket also counts longer runs.
+     */
+    static constexpr stl::size_t free_run_bucket_count {11};
+
+    //! Statistics of a memory block descriptor.
+    struct BlockStats {
+        stl::size_t block_size;
+        //! The number of block allocations.
+        stl::size_t alloc_count;
+        //! The number of block releases.
+        stl::size_t free_count;
+        //! The number of arenas that have not been freed.
+        stl::size_t live_arena_count;
+        //! The number of blocks in the free block list.
+        stl::size_t free_block_count;
+    };
+
+    //! The total number of physical pages.
+    stl::size_t page_count;
+    //! The number of free physical pages.
+    stl::size_t free_page_count;
+    //! The number of zeroed pages in @p ZeroedPageCache.
+    stl::size_t zeroed_page_count;
+    //! The number of successful page allocations.
+    stl::size_t alloc_count;
+    //! The number of failed page allocations.
+    stl::size_t fail_count;
+    //! The number of page releases.
+    stl::size_t free_count;
+    //! The length of the largest run of continuous free pages.
+    stl::size_t largest_free_run;
+    //! The free-run histogram.
+    stl::array<stl::size_t, free_run_bucket_count> free_runs;
+    //! Block descriptors. For the user pool, they belong to the current process.
+    stl::array<BlockStats, MemBlockDescTab::count> blocks;
+};
+
 //! Initialize memory management.
 void InitMem() noexcept;
 
@@ -275,6 +581,16 @@ PoolType GetSrcMemPool(const void* vr_addr) noexcept;
  */
 void* AllocPages(PoolType, stl::size_t count = 1) noexcept;
 
+/**
+ * @brief Allocate a number of virtual pages from a memory pool, aligned to their total size.
+ *
+ * @details
+ * For example, eight pages are aligned to 32 KB.
+ *
+ * @param count The number of pages. It must be a power of two.
+ */
+void* AllocAlignedPages(PoolType, stl::size_t count) noexcept;
+
 /**
  * @brief Allocate a virtual page from a memory pool at a specific virtual address.
  *
@@ -286,31 +602,115 @@ void* AllocPageAtAddr(PoolType, stl::uintptr_t vr_addr) noexcept;
 
 void* AllocPageAtAddr(PoolType, VrAddrPool& addr_pool, stl::uintptr_t vr_addr) noexcept;
 
+/**
+ * @brief Reserve a number of virtual pages from a memory pool without physical pages.
+ *
+ * @details
+ * Physical pages are allocated, zeroed and mapped by the page fault handler on first access.
+ * Only the user memory pool supports reservation.
+ */
+void* ReservePages(PoolType, stl::size_t count = 1) noexcept;
+
+//! Reserve a virtual page from a memory pool at a specific virtual address without a physical page.
+void* ReservePageAtAddr(PoolType, stl::uintptr_t vr_addr) noexcept;
+
+//! Flags for mapping anonymous memory.
+enum class MapFlag {
+    //! Map memory at exactly the required address.
+    Fixed = 1,
+    //! Map physical pages at once instead of on first access.
+    Populate = 2
+};
+
+/**
+ * @brief Map anonymous memory into the current process.
+ *
+ * @details
+ * Pages are reserved in the process's virtual address pool and mapped to zeroed physical pages on first access,
+ * unless @p MapFlag::Populate is set.
+ *
+ * @param vr_addr A preferred virtual base address aligned to a page, or @p 0 to use any address.
+ * Without @p MapFlag::Fixed, another address is used if the preferred one is unavailable.
+ * @param size The size in bytes. It is rounded up to pages.
+ * @param flags Flags of @p MapFlag.
+ * @return The virtual base address, or @p nullptr if the memory cannot be mapped.
+ */
+void* MapMem(stl::uintptr_t vr_addr, stl::size_t size, bit::Flags<MapFlag> flags = 0) noexcept;
+
+/**
+ * @brief Unmap anonymous memory from the current process.
+ *
+ * @details
+ * Physical pages that have been accessed are freed.
+ *
+ * @param vr_base A virtual base address aligned to a page.
+ * @param size The size in bytes. It is rounded up to pages.
+ * @return Whether the memory has been unmapped. All pages must have been mapped.
+ */
+bool UnmapMem(void* vr_base, stl::size_t size) noexcept;
+
+/**
+ * @brief Free all user memory of the current process when it exits.
+ *
+ * @details
+ * All user page tables are walked once. Mapped physical pages lose a reference from the process,
+ * so pages shared with other processes are kept. Page tables are freed, and the virtual address pool is cleared.
+ * Only the page directory table is left, which is still loaded.
+ *
+ * @warning
+ * TLB entries of freed pages are not flushed. The caller should reload the page directory table.
+ */
+void FreeUsrMem() noexcept;
+
 /**
  * @brief Allocate virtual memory in bytes.
  *
  * @details
  * - If the required size is larger than the maximum block size:
- *     1. Allocate memory pages.
+ *     1. Allocate memory pages. User pages are reserved and mapped on first access.
  *     2. Initialize the arena @p MemArena at the begging of the first page.
  *     3. Return the address of the available memory behind the arena.
  * - Otherwise:
  *     1. Find the suitable block descriptor @p MemBlockDesc.
- *     2. If the free block list of the descriptor is empty:
+ *     2. If the magazine @p MemBlockMagazine of the current thread is not empty, pop a block without locking.
+ *     3. If the free block list of the descriptor is empty:
  *         1. Allocate and initialize an arena @p MemArena.
  *         2. Add all blocks in the arena to the free block list.
- *     3. Remove a block @p MemBlock from the free block list and return its address.
+ *     4. Remove a block @p MemBlock from the free block list and return its address.
+ *     5. Refill the magazine with a batch of blocks from the free block list.
  */
 void* Allocate(stl::size_t size) noexcept;
 
 //! Allocate virtual memory from a memory pool in bytes.
 void* Allocate(PoolType, stl::size_t size) noexcept;
 
+/**
+ * @brief Allocate virtual memory in bytes without zeroing it.
+ *
+ * @details
+ * It can be used when the caller overwrites the memory at once.
+ */
+void* AllocateUninit(stl::size_t size) noexcept;
+
+//! Allocate virtual memory from a memory pool in bytes without zeroing it.
+void* AllocateUninit(PoolType, stl::size_t size) noexcept;
+
+//! Allocate zeroed virtual memory in bytes. It is the same as @p Allocate.
+void* AllocateZeroed(stl::size_t size) noexcept;
+
+//! Allocate zeroed virtual memory from a memory pool in bytes. It is the same as @p Allocate.
+void* AllocateZeroed(PoolType, stl::size_t size) noexcept;
+
 template <typename T>
 T* AllocPages(const PoolType type, const stl::size_t count = 1) noexcept {
     return static_cast<T*>(AllocPages(type, count));
 }
 
+template <typename T>
+T* AllocAlignedPages(const PoolType type, const stl::size_t count) noexcept {
+    return static_cast<T*>(AllocAlignedPages(type, count));
+}
+
 template <typename T>
 T* AllocPageAtAddr(const PoolType type, const stl::uintptr_t vr_addr) noexcept {
     return static_cast<T*>(AllocPageAtAddr(type, vr_addr));
@@ -326,11 +726,32 @@ T* Allocate(const PoolType type, const stl::size_t size) noexcept {
     return static_cast<T*>(Allocate(type, size));
 }
 
+template <typename T>
+T* AllocateUninit(const stl::size_t size) noexcept {
+    return static_cast<T*>(AllocateUninit(size));
+}
+
+template <typename T>
+T* AllocateUninit(const PoolType type, const stl::size_t size) noexcept {
+    return static_cast<T*>(AllocateUninit(type, size));
+}
+
+template <typename T>
+T* AllocateZeroed(const stl::size_t size) noexcept {
+    return static_cast<T*>(AllocateZeroed(size));
+}
+
+template <typename T>
+T* AllocateZeroed(const PoolType type, const stl::size_t size) noexcept {
+    return static_cast<T*>(AllocateZeroed(type, size));
+}
+
 /**
  * @brief Free virtual pages.
  *
  * @details
  * This method combines @p PhyMemPagePool::FreePages and @p VrAddr::Unmap.
+ * Reserved pages that have never been accessed do not have physical pages to free.
  */
 void FreePages(void* vr_base, stl::size_t count = 1) noexcept;
 
@@ -342,18 +763,122 @@ void FreePages(void* vr_base, stl::size_t count = 1) noexcept;
  * - If the arena is a large arena:
  *     2. Directly free pages.
  * - Otherwise:
- *     2. Get the block descriptor @p MemBlockDesc from the arena.
- *     3. Add the block @p MemBlock to the free block list of the descriptor.
- *     4. If all blocks in the arena are free, remove them from the free block list and free the arena.
+ *     2. If the magazine @p MemBlockMagazine of the current thread is not full, push the block without locking.
+ *     3. Otherwise, drain a batch of blocks from the magazine.
+ *     4. Get the block descriptor @p MemBlockDesc from the arena.
+ *     5. Add the block @p MemBlock to the free block list of the descriptor.
+ *     6. If all blocks in the arena are free, remove them from the free block list and free the arena.
  */
 void Free(void* vr_base) noexcept;
 
 //! Free virtual memory from a memory pool.
 void Free(PoolType, void* vr_base) noexcept;
 
+/**
+ * @brief Return all blocks cached in the magazines of the current thread to their block descriptors.
+ *
+ * @details
+ * It is called before a thread exits, otherwise its cached blocks are leaked.
+ */
+void DrainMemBlockMagazines() noexcept;
+
+/**
+ * @brief Drain and free the magazines of the current thread when it exits.
+ *
+ * @details
+ * The thread must not allocate or free memory afterwards, otherwise new magazines are leaked.
+ */
+void ReleaseMemBlockMagazines() noexcept;
+
+/**
+ * @brief Change the size of allocated memory.
+ *
+ * @details
+ * - If the memory is a block and the new size fits the block, it is returned directly.
+ * - If the memory is a large arena, it grows in place when the following virtual pages are free.
+ * - Otherwise, new memory is allocated, the contents are copied and the old memory is freed.
+ *
+ * Memory beyond the old allocation is zeroed.
+ *
+ * @param vr_base Allocated memory, or @p nullptr to allocate new memory.
+ * @param size The new size in bytes.
+ * @return The new address, or @p nullptr if memory is insufficient. The old memory is kept in that case.
+ */
+void* Reallocate(void* vr_base, stl::size_t size) noexcept;
+
+//! Change the size of allocated memory from a memory pool.
+void* Reallocate(PoolType, void* vr_base, stl::size_t size) noexcept;
+
+/**
+ * @brief Zero free physical pages and save them in the zeroed page caches @p ZeroedPageCache.
+ *
+ * @details
+ * It is called by the idle thread. A memory pool is skipped if it is locked by another thread.
+ */
+void FillZeroedPages() noexcept;
+
+/**
+ * @brief Map a reserved page of the current process on its first access.
+ *
+ * @param vr_addr A virtual address in the page.
+ * @return Whether the page has been reserved and is now mapped to a zeroed physical page.
+ */
+bool MapPageOnDemand(stl::uintptr_t vr_addr) noexcept;
+
+/**
+ * @brief Make a copy-on-write page writable.
+ *
+ * @details
+ * If the physical page is still shared by other processes, it is copied to a new page.
+ * Otherwise, the page is directly marked as writable.
+ *
+ * @param vr_addr A virtual address in the page.
+ * @return Whether the page is copy-on-write and has become writable.
+ */
+bool CopyPageOnWrite(stl::uintptr_t vr_addr) noexcept;
+
+/**
+ * @brief Make a user page of the current process present and writable before the kernel writes to it.
+ *
+ * @details
+ * The page is loaded, mapped on demand or copied on write as the page fault handler does,
+ * so the kernel does not have to rely on a page fault that may be fatal.
+ *
+ * @param vr_addr A virtual address in the page.
+ * @return Whether the page is mapped and writable.
+ */
+bool PrepareUsrPageForWrite(stl::uintptr_t vr_addr) noexcept;
+
 //! Assert that an allocated address is not @p nullptr.
 void AssertAlloc(const void*) noexcept;
 
 void AssertAlloc(stl::uintptr_t) noexcept;
 
+/**
+ * @brief Collect statistics of a memory pool.
+ *
+ * @details
+ * It scans all physical pages to build the free-run histogram.
+ */
+MemStats GetMemStats(PoolType) noexcept;
+
+//! Print statistics of all memory pools.
+void DumpMemStats() noexcept;
+
+//! System calls.
+namespace sc {
+
+class Memory {
+public:
+    Memory() = delete;
+
+    static void GetStats(PoolType type, MemStats* stats) noexcept;
+
+    static void* Map(stl::uintptr_t addr, stl::size_t size, stl::uint32_t flags) noexcept;
+
+    static bool Unmap(void* addr, stl::size_t size) noexcept;
+};
+
+}  // namespace sc
+
 }  // namespace mem
\ No newline at end of file
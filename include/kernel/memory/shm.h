@@ -0,0 +1,68 @@
+/**
+ * @file shm.h
+ * @brief Shared memory regions between processes.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/string_view.h"
+
+namespace mem {
+
+/**
+ * @brief Named shared memory regions.
+ *
+ * @details
+ * A region is a number of user physical pages that several processes can map into their virtual address pools.
+ * - The region holds a reference to each page. Each mapping holds another one.
+ * - Pages are mapped as shared pages, so they are not copied on write after forking.
+ * - A mapping is unmapped by @p UnmapMem. Pages are freed after the region is deleted and all mappings are unmapped.
+ */
+class SharedMem {
+public:
+    //! The maximum length of a region name.
+    static constexpr stl::size_t max_name_len {15};
+
+    //! The maximum number of regions.
+    static constexpr stl::size_t max_count {16};
+
+    SharedMem() = delete;
+
+    /**
+     * @brief Map a named shared memory region into the current process.
+     *
+     * @details
+     * If no region has the name, a region of zeroed pages is created.
+     *
+     * @param name The region name.
+     * @param size The size in bytes. It cannot be larger than the size of an existing region.
+     * @return The virtual base address, or @p nullptr if the region cannot be mapped.
+     */
+    static void* Map(stl::string_view name, stl::size_t size) noexcept;
+
+    /**
+     * @brief Delete a named shared memory region.
+     *
+     * @details
+     * Existing mappings stay valid. The name can be used by a new region at once.
+     */
+    static bool Delete(stl::string_view name) noexcept;
+};
+
+namespace sc {
+
+class SharedMem {
+public:
+    SharedMem() = delete;
+
+    static void* Map(const char* name, stl::size_t size) noexcept;
+
+    static bool Delete(const char*) noexcept;
+};
+
+}  // namespace sc
+
+}  // namespace mem
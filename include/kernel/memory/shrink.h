@@ -0,0 +1,75 @@
+/**
+ * @file shrink.h
+ * @brief Memory reclaim from kernel caches.
+ *
+ * @details
+ * Caches register shrinkers, which release their spare memory when a memory pool is low on free pages.
+ * Allocation methods reclaim memory before they fail, so caches can keep all spare memory.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/memory/pool.h"
+
+namespace mem {
+
+//! The number of free pages, including zeroed pages, below which allocations reclaim memory.
+inline constexpr stl::size_t reclaim_watermark_page_count {16};
+
+//! The maximum number of registered shrinkers.
+inline constexpr stl::size_t max_shrinker_count {16};
+
+/**
+ * @brief A callback releasing spare memory of a cache.
+ *
+ * @details
+ * It is called when the current thread holds no mutex, so it can lock its cache without deadlocks.
+ * It should not allocate memory.
+ *
+ * @param type The memory pool with low free pages.
+ * @param page_count The number of pages to release.
+ * @param arg The argument passed when the shrinker was registered.
+ * @return The number of released pages.
+ */
+using Shrinker = stl::size_t (*)(PoolType type, stl::size_t page_count, void* arg) noexcept;
+
+/**
+ * @brief Register a shrinker.
+ *
+ * @details
+ * Shrinkers are called in registration order and cannot be removed,
+ * so the argument must not be destroyed.
+ *
+ * @return Whether the shrinker is registered.
+ * It returns @p false if there are already @p max_shrinker_count shrinkers.
+ */
+bool RegisterShrinker(Shrinker, void* arg = nullptr) noexcept;
+
+/**
+ * @brief Reclaim memory from caches if a memory pool will be low on free pages after an allocation.
+ *
+ * @details
+ * Shrinkers are called until the pool has @p page_count free pages above the watermark.
+ * Nothing is reclaimed when the current thread holds a mutex,
+ * which includes allocations made by caches and memory pools themselves.
+ * It is called by allocation methods before locking the memory pool.
+ *
+ * @param page_count The number of pages to allocate.
+ * @return The number of released pages.
+ */
+stl::size_t ReclaimMem(PoolType, stl::size_t page_count) noexcept;
+
+//! Reclaim statistics of a memory pool.
+struct ReclaimStats {
+    //! The number of times shrinkers were called.
+    stl::size_t reclaim_count;
+    //! The number of pages released by shrinkers.
+    stl::size_t released_page_count;
+};
+
+ReclaimStats GetReclaimStats(PoolType) noexcept;
+
+}  // namespace mem
@@ -0,0 +1,173 @@
+/**
+ * @file slab.h
+ * @brief Typed object caches.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/memory/pool.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/mutex.h"
+#include "kernel/stl/string_view.h"
+#include "kernel/util/tag_list.h"
+
+namespace mem {
+
+/**
+ * @brief The slab cache that allocates objects of the same size.
+ *
+ * @details
+ * A slab is a page containing a header, a free-object index list and packed objects.
+ * Unlike @p MemBlockDesc, an object size is not rounded up to a power of two.
+ *
+ * @code
+ *   Slab Page
+ * ┌────────────┐
+ * │   Header   │ ─── The number of free objects and the first free object
+ * ├────────────┤
+ * │ Free Index │ ─── The index of the next free object for each object
+ * ├────────────┤
+ * │   Object   │
+ * ├────────────┤
+ * │    ....    │
+ * ├────────────┤
+ * │   Object   │
+ * └────────────┘
+ * @endcode
+ *
+ * - An optional constructor is called once for each object when its slab is created.
+ *   A freed object keeps its state, so it can be reused without being constructed again.
+ * - Objects as large as a page do not have slab headers. Each of them is a whole page and freed pages are kept for reuse.
+ * - Each cache registers a shrinker, which frees retained empty slabs and kept pages when memory is low.
+ *   So a cache must not be destroyed.
+ */
+class SlabCacheBase {
+public:
+    using Ctor = void (*)(void*) noexcept;
+
+    //! The maximum number of empty slabs retained before their pages are freed.
+    static constexpr stl::size_t max_empty_slab_count {1};
+
+    //! The maximum number of freed page-sized objects kept for reuse.
+    static constexpr stl::size_t max_free_page_count {8};
+
+    //! Usage counters.
+    struct Stats {
+        //! The number of slabs, or pages for page-sized objects.
+        stl::size_t slab_count;
+        //! The number of objects in use.
+        stl::size_t used_count;
+        //! The number of free objects in slabs.
+        stl::size_t free_count;
+        //! The number of allocations.
+        stl::size_t alloc_count;
+        //! The number of releases.
+        stl::size_t release_count;
+    };
+
+    /**
+     * @brief Create a slab cache.
+     *
+     * @param name The cache name.
+     * @param obj_size The object size in bytes.
+     * @param obj_align The object alignment in bytes.
+     * @param type The memory pool where slabs are allocated from.
+     * @param ctor An optional constructor called once for each object.
+     */
+    SlabCacheBase(stl::string_view name, stl::size_t obj_size, stl::size_t obj_align,
+                  PoolType type = PoolType::Kernel, Ctor ctor = nullptr) noexcept;
+
+    SlabCacheBase(const SlabCacheBase&) = delete;
+
+    //! Allocate an object, or return @p nullptr if memory is insufficient.
+    void* Allocate() noexcept;
+
+    //! Free an object allocated from the cache.
+    SlabCacheBase& Free(void* obj) noexcept;
+
+    /**
+     * @brief Allocate memory in advance until the cache has at least @p count free objects.
+     *
+     * @details
+     * Page-sized objects are kept up to @p max_free_page_count.
+     * Reserved memory can still be released by the shrinker under memory pressure.
+     *
+     * @return The number of free objects.
+     */
+    stl::size_t Reserve(stl::size_t count) noexcept;
+
+    stl::string_view GetName() const noexcept;
+
+    stl::size_t GetObjSize() const noexcept;
+
+    //! Get the number of objects in a slab.
+    stl::size_t GetObjCountPerSlab() const noexcept;
+
+    const Stats& GetStats() const noexcept;
+
+private:
+    struct Slab;
+
+    //! Whether each object is a whole page.
+    bool IsPageObj() const noexcept;
+
+    //! Create a slab and construct its objects.
+    Slab* CreateSlab() noexcept;
+
+    //! Free retained empty slabs and kept pages until enough pages are released.
+    stl::size_t Shrink(stl::size_t page_count) noexcept;
+
+    void* AllocatePage() noexcept;
+
+    SlabCacheBase& FreePage(void* page) noexcept;
+
+    mutable stl::mutex mtx_;
+    stl::string_view name_;
+    stl::size_t obj_size_ {0};
+    stl::size_t obj_count_per_slab_ {0};
+    //! The offset of the first object from the beginning of a slab.
+    stl::size_t obj_offset_ {0};
+    PoolType type_ {PoolType::Kernel};
+    Ctor ctor_ {nullptr};
+
+    //! Slabs containing free objects.
+    TagList partial_slabs_;
+    stl::size_t empty_slab_count_ {0};
+
+    //! Freed page-sized objects.
+    stl::array<void*, max_free_page_count> free_pages_;
+    stl::size_t free_page_count_ {0};
+
+    Stats stats_ {};
+};
+
+/**
+ * @brief The slab cache for a type.
+ *
+ * @tparam T The object type.
+ * @tparam obj_size The object size in bytes.
+ * It can be larger than the type size, for example, a thread block occupies a whole page.
+ */
+template <typename T, stl::size_t obj_size = sizeof(T)>
+class SlabCache : public SlabCacheBase {
+    static_assert(obj_size >= sizeof(T));
+
+public:
+    explicit SlabCache(const stl::string_view name, const PoolType type = PoolType::Kernel,
+                       const Ctor ctor = nullptr) noexcept :
+        SlabCacheBase {name, obj_size, alignof(T), type, ctor} {}
+
+    T* Allocate() noexcept {
+        return static_cast<T*>(SlabCacheBase::Allocate());
+    }
+
+    SlabCache& Free(T* const obj) noexcept {
+        SlabCacheBase::Free(obj);
+        return *this;
+    }
+};
+
+}  // namespace mem
@@ -0,0 +1,88 @@
+/**
+ * @file elf.h
+ * @brief The Executable and Linkable Format (ELF).
+ *
+ * @details
+ * Structures have the same layout as those in @p include/kernel/process/elf.inc.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstdint.h"
+
+namespace tsk::elf {
+
+//! The file header.
+struct FileHeader {
+    //! The magic number and other information.
+    stl::array<stl::uint8_t, 16> e_ident;
+    stl::uint16_t e_type;
+    stl::uint16_t e_machine;
+    stl::uint32_t e_version;
+    //! The virtual address of the code entry.
+    stl::uint32_t e_entry;
+    //! The file offset of the program header table.
+    stl::uint32_t e_phoff;
+    stl::uint32_t e_shoff;
+    stl::uint32_t e_flags;
+    stl::uint16_t e_ehsize;
+    stl::uint16_t e_phentsize;
+    //! The number of program headers.
+    stl::uint16_t e_phnum;
+    stl::uint16_t e_shentsize;
+    stl::uint16_t e_shnum;
+    stl::uint16_t e_shstrndx;
+};
+
+static_assert(sizeof(FileHeader) == 52);
+
+//! The program header, describing a segment.
+struct ProgHeader {
+    stl::uint32_t p_type;
+    //! The file offset of the segment.
+    stl::uint32_t p_offset;
+    //! The virtual address of the segment.
+    stl::uint32_t p_vaddr;
+    stl::uint32_t p_paddr;
+    //! The size of the segment in the file.
+    stl::uint32_t p_filesz;
+    //! The size of the segment in memory. Bytes beyond the file size are zeros.
+    stl::uint32_t p_memsz;
+    stl::uint32_t p_flags;
+    stl::uint32_t p_align;
+};
+
+static_assert(sizeof(ProgHeader) == 32);
+
+//! The magic number @p "\x7FELF" in the first four bytes of @p FileHeader::e_ident, in little-endian.
+inline constexpr stl::uint32_t magic {0x464C457F};
+
+//! The index of the file class in @p FileHeader::e_ident.
+inline constexpr stl::size_t ei_class {4};
+
+//! The index of the data encoding in @p FileHeader::e_ident.
+inline constexpr stl::size_t ei_data {5};
+
+//! 32-bit objects.
+inline constexpr stl::uint8_t elf_class_32 {1};
+
+//! Little-endian data encoding.
+inline constexpr stl::uint8_t elf_data_2lsb {1};
+
+//! Executable files.
+inline constexpr stl::uint16_t et_exec {2};
+
+//! The @em Intel x86 architecture.
+inline constexpr stl::uint16_t em_386 {3};
+
+//! Loadable segments.
+inline constexpr stl::uint32_t pt_load {1};
+
+//! The writable segment flag.
+inline constexpr stl::uint32_t pf_w {2};
+
+}  // namespace tsk::elf
@@ -0,0 +1,127 @@
+/**
+ * @file image.h
+ * @brief Program images loaded from executable files.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/io/file/file.h"
+#include "kernel/io/file/path.h"
+#include "kernel/stl/array.h"
+
+namespace tsk {
+
+/**
+ * @brief The program image of a process loaded from an ELF executable file.
+ *
+ * @details
+ * Loadable segments are reserved in the virtual address space of the process,
+ * and their pages are loaded by the page fault handler on first access.
+ * - A page of a writable segment is private. Its file data is read into a zeroed physical page.
+ *   Pages only containing zero-initialized data are mapped by @p mem::MapPageOnDemand without reading the file.
+ * - A page of a read-only segment is cached by the index node and the file offset,
+ *   so processes running the same executable share its physical page.
+ *   Cached pages are freed when no process maps them and the last image of the file is closed.
+ *
+ * The image holds its own descriptor in the global file table,
+ * so the executable file cannot be deleted while a process is running it.
+ * It also denies writes to the file, so cached pages and pages loaded later never come from a rewritten file.
+ * After the last image of the file is closed, all its cached pages are dropped.
+ *
+ * @warning
+ * Like memory-mapped files, a page that has not been loaded cannot be used as a buffer of another file operation.
+ */
+class Image {
+public:
+    //! The maximum number of loadable segments.
+    static constexpr stl::size_t max_seg_count {8};
+
+    //! The maximum number of cached read-only pages in the system.
+    static constexpr stl::size_t max_cached_page_count {128};
+
+    /**
+     * @brief Load a page of the current process's image on its first access.
+     *
+     * @details
+     * It is called by the page fault handler and reads the file system,
+     * so user memory must not be accessed while the file system is locked.
+     * System calls copy user buffers through kernel memory instead.
+     *
+     * @param vr_addr A virtual address in the page.
+     * @return Whether the page belongs to a segment and has been loaded.
+     */
+    static bool LoadPage(stl::uintptr_t vr_addr) noexcept;
+
+    /**
+     * @brief Open an executable file and parse its headers.
+     *
+     * @details
+     * Nothing is mapped until @p Map is called.
+     *
+     * @param path The path of an executable file.
+     * @param vr_begin The lowest virtual address that segments can use.
+     * @param vr_end The virtual address after the highest one that segments can use.
+     * @return Whether the file is a valid 32-bit @em x86 executable and its segments are in range.
+     */
+    bool Open(const io::Path& path, stl::uintptr_t vr_begin, stl::uintptr_t vr_end) noexcept;
+
+    /**
+     * @brief Close the executable file when the process exits or runs another image.
+     *
+     * @details
+     * It should be called after user memory has been freed,
+     * so cached pages no longer mapped by any process can be freed.
+     */
+    Image& Close() noexcept;
+
+    //! Reserve virtual pages of segments in the current process.
+    bool Map() const noexcept;
+
+    /**
+     * @brief Fork the image.
+     *
+     * @details
+     * It should be called on the copied image of a child process, which gets a new descriptor.
+     */
+    Image& Fork() noexcept;
+
+    bool IsOpen() const noexcept;
+
+    //! Get the virtual address of the code entry.
+    stl::uintptr_t GetEntry() const noexcept;
+
+private:
+    //! A loadable segment, extended to page boundaries.
+    struct Segment {
+        bool Contain(stl::uintptr_t vr_addr) const noexcept;
+
+        //! The virtual base address aligned to a page.
+        stl::uintptr_t vr_base;
+        stl::size_t page_count;
+        //! The file offset of the first page.
+        stl::size_t offset;
+        //! The number of bytes from the base address that are read from the file.
+        stl::size_t file_size;
+        bool writable;
+    };
+
+    //! Find the segment containing a virtual address.
+    const Segment* FindSeg(stl::uintptr_t vr_addr) const noexcept;
+
+    //! Load a page of a segment into the current address space.
+    bool LoadPage(const Segment&, stl::uintptr_t page_base) const noexcept;
+
+    //! The descriptor of the executable file in the global file table.
+    io::FileDesc global_;
+
+    stl::uintptr_t entry_ {0};
+
+    stl::size_t seg_count_ {0};
+
+    stl::array<Segment, max_seg_count> segs_ {};
+};
+
+}  // namespace tsk
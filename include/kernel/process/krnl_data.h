@@ -0,0 +1,60 @@
+/**
+ * @file krnl_data.h
+ * @brief The kernel data page shared with user processes.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+
+namespace tsk {
+
+/**
+ * @brief The user-space address of the kernel data page.
+ *
+ * @details
+ * It must be the same as @p krnl_data_base in @p include/user/process/krnl_data.h.
+ */
+inline constexpr stl::uintptr_t usr_krnl_data_base {0x40001000};
+
+/**
+ * @brief Kernel data shared with user processes.
+ *
+ * @details
+ * The kernel writes it through a kernel-space alias,
+ * and the same physical page is mapped read-only into every process at @p usr_krnl_data_base.
+ * User programs can read these values without system calls.
+ *
+ * It has the same layout as @p usr::tsk::KrnlData.
+ */
+struct KrnlData {
+    //! The ID of the running process, or @p 0 for kernel threads.
+    stl::size_t pid;
+    //! The number of ticks after system startup.
+    stl::size_t ticks;
+    //! The time-stamp counter value when the timer was initialized.
+    stl::uint64_t tsc_base;
+    //! The number of nanoseconds per cycle in a fixed-point number.
+    stl::uint32_t tsc_ns_mult;
+    //! The number of fraction bits in @p tsc_ns_mult.
+    stl::uint32_t tsc_ns_shift;
+};
+
+//! Get the kernel-space alias of the kernel data page.
+KrnlData& GetKrnlData() noexcept;
+
+/**
+ * @brief Map the kernel data page into the current process.
+ *
+ * @details
+ * The page is read-only in user mode and stays shared after forking.
+ */
+void MapKrnlData() noexcept;
+
+//! Allocate the kernel data page.
+void InitKrnlData() noexcept;
+
+}  // namespace tsk
@@ -9,9 +9,12 @@
 #pragma once
 
 #include "kernel/memory/pool.h"
+#include "kernel/process/image.h"
 #include "kernel/stl/array.h"
 #include "kernel/stl/string_view.h"
+#include "kernel/thread/sync.h"
 #include "kernel/thread/thd.h"
+#include "kernel/util/tag_list.h"
 
 namespace tsk {
 
@@ -21,6 +24,9 @@ public:
     //! The priority of the main thread.
     static constexpr stl::size_t default_priority {31};
 
+    //! The maximum number of threads running in a process, each of which has its own user stack.
+    static constexpr stl::size_t max_thd_count {16};
+
     //! Get the current thread's process, or @p nullptr for kernel threads.
     static Process* GetCurrent() noexcept;
 
@@ -38,8 +44,91 @@ public:
      */
     static Process& Create(stl::string_view name, void* code) noexcept;
 
+    /**
+     * @brief Exit the current user thread.
+     *
+     * @details
+     * When the last user thread of a process exits, the process exits and releases its resources:
+     * - The worker thread of I/O rings is stopped.
+     * - File mappings are written back and unmapped.
+     * - Open files are closed.
+     * - User memory, including page tables, is freed.
+     * - Child processes become orphans.
+     *
+     * The page directory table and the process itself are freed when the parent process waits for it,
+     * or immediately after its last thread is switched out if it has no parent.
+     */
+    [[noreturn]] static void ExitCurrThread() noexcept;
+
+    /**
+     * @brief Set the exit status of the current process and exit the current user thread.
+     *
+     * @details
+     * Other threads of the process keep running. The process exits after all of them exit.
+     */
+    [[noreturn]] static void ExitCurrent(stl::int32_t status) noexcept;
+
+    /**
+     * @brief Wait for a child process of the current process to exit and free it.
+     *
+     * @param pid The ID of a child process.
+     * @param[out] status The exit status of the child process. It can be @p nullptr.
+     * @return
+     * Whether the child process has exited.
+     * It fails if the process is not a child or is being waited for by another thread.
+     */
+    static bool Wait(stl::size_t pid, stl::int32_t* status) noexcept;
+
+    /**
+     * @brief Replace the image of the current process with an ELF executable file.
+     *
+     * @details
+     * User memory, file mappings and I/O rings are released, and a new user stack is allocated.
+     * Open files and the process ID are kept.
+     * Segments are not read until their pages are accessed.
+     *
+     * @param path The absolute path of an executable file.
+     * @return
+     * It does not return if the image is replaced.
+     * It returns @p false if the file is not a valid executable or the process has other user threads.
+     */
+    static bool ExecCurrent(const char* path) noexcept;
+
+    /**
+     * @brief Create a child process of the current process running an ELF executable file.
+     *
+     * @details
+     * Unlike forking and then running another image, no memory of the current process is copied,
+     * so the cost does not depend on the size of the current process.
+     *
+     * @param path The absolute path of an executable file.
+     * @param descs
+     * Local descriptors of the current process inherited by the child process.
+     * They are numbered in order after standard streams in the child process.
+     * @param desc_count The number of inherited descriptors.
+     * @return The child process's ID, or @p npos if the process cannot be created.
+     */
+    static stl::size_t Spawn(const char* path, const stl::size_t* descs,
+                             stl::size_t desc_count) noexcept;
+
     Process(const Process&) = delete;
 
+    /**
+     * @brief Start a user thread in the process, which must be the current process.
+     *
+     * @details
+     * The thread shares the address space and file descriptors with other threads in the process,
+     * and has its own user stack.
+     * It is detached, so it is freed when it exits.
+     *
+     * @param code The code entry. It is called with the argument and must not return.
+     * @param arg An argument to the code entry.
+     * @return
+     * Whether the thread is started.
+     * It fails if the code entry is null or @p max_thd_count threads are running.
+     */
+    bool StartThread(void* code, void* arg) noexcept;
+
     //! Get the virtual address pool of the process.
     const mem::VrAddrPool& GetVrAddrPool() const noexcept;
 
@@ -50,11 +139,19 @@ public:
 
     mem::MemBlockDescTab& GetMemBlockDescTab() noexcept;
 
+    //! Get the image loaded from an executable file. It is not open if the process runs kernel-image code.
+    const Image& GetImage() const noexcept;
+
     //! Get the file descriptor file.
-    const FileDescTab<max_open_file_count>& GetFileDescTab() const noexcept;
+    const FileDescTab& GetFileDescTab() const noexcept;
 
-    FileDescTab<max_open_file_count>& GetFileDescTab() noexcept;
+    FileDescTab& GetFileDescTab() noexcept;
 
+    /**
+     * @warning
+     * The main thread is detached.
+     * It might have exited and been freed if the process still has other threads.
+     */
     const Thread& GetMainThread() const noexcept;
 
     Thread& GetMainThread() noexcept;
@@ -78,6 +175,18 @@ public:
      */
     stl::size_t Fork() const noexcept;
 
+    //! Count a new thread of the process. It is called by @p Thread::Create.
+    Process& OnThreadCreated() noexcept;
+
+    /**
+     * @brief Count an exited thread of the process.
+     *
+     * @details
+     * It is called by @p Thread::Exit with interrupts disabled.
+     * When the last thread exits, the process is marked as exited.
+     */
+    Process& OnThreadExited() noexcept;
+
 private:
     //! The virtual base address, same as @em Linux.
     static constexpr stl::uintptr_t image_base {0x8048000};
@@ -85,8 +194,19 @@ private:
     //! Allocate a new process ID.
     static stl::size_t CreateNewPid() noexcept;
 
+    /**
+     * @brief Find a child process. Interrupts must be disabled.
+     *
+     * @param parent_pid The ID of the parent process.
+     * @param pid The ID of the child process, or @p npos for any child.
+     */
+    static Process* FindChild(stl::size_t parent_pid, stl::size_t pid = npos) noexcept;
+
     Process& Init(stl::string_view name, void* code) noexcept;
 
+    //! Initialize a new process without threads.
+    Process& Init(stl::size_t parent_pid) noexcept;
+
     //! Initialize the virtual address pool of the process.
     Process& InitVrAddrPool() noexcept;
 
@@ -99,16 +219,72 @@ private:
     Thread& CreateThread(stl::string_view name, stl::size_t priority, Thread::Callback callback,
                          void* arg = nullptr) noexcept;
 
+    /**
+     * @brief Create a child process running an opened image for @p Process::Spawn.
+     *
+     * @param globals The forked global descriptors inherited by the child process.
+     * @return
+     * The child process's ID, or @p npos if its file table cannot hold the descriptors.
+     * If the child process is created, the image and the descriptors are owned by it.
+     * Otherwise they are still owned by the caller.
+     */
+    static stl::size_t SpawnChild(stl::size_t parent_pid, const io::Path& path, const Image& image,
+                                  const io::FileDesc* globals, stl::size_t desc_count) noexcept;
+
+    /**
+     * @brief Start a user thread in the current process.
+     *
+     * @param stack
+     * The user stack prepared by @p Process::StartThread.
+     * It contains a null return address, the argument and the code entry from low to high addresses.
+     */
+    [[noreturn]] static void StartUsrThread(void* stack) noexcept;
+
+    //! Free the user stack of the current thread, which is exiting but not the last user thread.
+    Process& FreeUsrStack(stl::size_t idx) noexcept;
+
     //! Copy the file descriptor file to another process.
     const Process& CopyFileDescTabTo(Process&) const noexcept;
 
     Process& CopyFileDescTabTo(Process&) noexcept;
 
-    //! Copy memory to another process.
+    /**
+     * @brief Share memory with another process.
+     *
+     * @details
+     * Instead of copying pages, page tables are copied and all writable pages become copy-on-write pages.
+     * Both processes share physical pages until one of them writes to a page.
+     *
+     * @param buf A kernel buffer for copying page tables.
+     * @param buf_size The size of the buffer, at least one page.
+     */
     const Process& CopyMemTo(Process&, void* buf, stl::size_t buf_size) const noexcept;
 
     Process& CopyMemTo(Process&, void* buf, stl::size_t buf_size) noexcept;
 
+    /**
+     * @brief Release user memory of the process in its only running user thread.
+     *
+     * @details
+     * I/O rings and file mappings are released since they use user memory.
+     */
+    Process& ReleaseMem() noexcept;
+
+    //! Release resources of the exiting process in its last user thread.
+    Process& Release() noexcept;
+
+    //! Make child processes orphans and free those that have exited.
+    Process& ReleaseChildren() noexcept;
+
+    //! Free the page directory table and the process after it has exited.
+    void Free() noexcept;
+
+    //! Free exited orphan processes in the worker thread.
+    static void FreeOrphans(void*) noexcept;
+
+    //! The tag for the list of all processes.
+    TagList::Tag tag_;
+
     /**
      * @details
      * Each process has its own virtual address space.
@@ -130,9 +306,37 @@ private:
 
     stl::size_t parent_pid_ {npos};
 
-    FileDescTab<max_open_file_count> file_descs_;
+    FileDescTab file_descs_;
+
+    Image image_;
 
     Thread* main_thd_ {nullptr};
+
+    /**
+     * @brief Bits of user stacks in use.
+     *
+     * @details
+     * The bit @p i is set if the @p i-th user stack below the top of user space is used by a thread.
+     * A stack is freed when its thread exits, so its slot can be reused.
+     */
+    stl::uint32_t usr_stacks_ {0};
+
+    //! The number of user threads that have not started exiting.
+    stl::size_t usr_thd_count_ {0};
+
+    //! The number of threads, including kernel threads of the process, that have not exited.
+    stl::size_t live_thd_count_ {0};
+
+    //! Threads waiting for other threads of the process to exit.
+    sync::WaitQueue exit_waiters_;
+
+    stl::int32_t exit_status_ {0};
+
+    //! Whether all threads have exited.
+    bool exited_ {false};
+
+    //! Whether a thread of the parent process is waiting for the process.
+    bool waited_ {false};
 };
 
 }  // namespace tsk
\ No newline at end of file
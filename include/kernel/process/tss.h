@@ -57,7 +57,7 @@ struct TaskStateSeg {
     stl::uint32_t trace;
     stl::uint32_t io_base;
 
-    //! Update @p esp0 to a thread's kernel stack.
+    //! Update @p esp0 to a thread's kernel stack if it is different.
     TaskStateSeg& Update(const Thread&) noexcept;
 };
 
@@ -114,4 +114,14 @@ inline constexpr Selector usr_data {DescTabType::Gdt, Privilege::Three, gdt::idx
 //! The user selector for the stack.
 inline constexpr Selector usr_stack {usr_data};
 
+//! The kernel selector for code after @p sysenter.
+inline constexpr Selector sysenter_krnl_code {DescTabType::Gdt, Privilege::Zero,
+                                              gdt::idx::sysenter_krnl_code};
+//! The user selector for code after @p sysexit.
+inline constexpr Selector sysenter_usr_code {DescTabType::Gdt, Privilege::Three,
+                                             gdt::idx::sysenter_usr_code};
+//! The user selector for the stack after @p sysexit.
+inline constexpr Selector sysenter_usr_stack {DescTabType::Gdt, Privilege::Three,
+                                              gdt::idx::sysenter_usr_stack};
+
 }  // namespace sel
\ No newline at end of file
@@ -8,16 +8,41 @@ class mutex {
 public:
     mutex() noexcept = default;
 
+    //! Create a named mutex with statistics. It is an extension of the standard library.
+    explicit mutex(const char* name) noexcept;
+
     mutex(const mutex&) = delete;
 
+    //! Name the mutex and give it statistics. It is an extension of the standard library.
+    void set_name(const char* name) noexcept;
+
     void lock() noexcept;
 
+    bool try_lock() noexcept;
+
     void unlock() noexcept;
 
 private:
     sync::Mutex mtx_;
 };
 
+//! The spinlock, which can be used with @p lock_guard.
+class spin_lock {
+public:
+    spin_lock() noexcept = default;
+
+    spin_lock(const spin_lock&) = delete;
+
+    void lock() noexcept;
+
+    bool try_lock() noexcept;
+
+    void unlock() noexcept;
+
+private:
+    sync::SpinLock lck_;
+};
+
 template <typename Mutex>
 class lock_guard {
 public:
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "kernel/thread/sync.h"
+
+namespace stl {
+
+class shared_mutex {
+public:
+    shared_mutex() noexcept = default;
+
+    shared_mutex(const shared_mutex&) = delete;
+
+    void lock() noexcept;
+
+    bool try_lock() noexcept;
+
+    void unlock() noexcept;
+
+    void lock_shared() noexcept;
+
+    bool try_lock_shared() noexcept;
+
+    void unlock_shared() noexcept;
+
+private:
+    sync::RwLock lck_;
+};
+
+template <typename Mutex>
+class shared_lock {
+public:
+    explicit shared_lock(Mutex& mtx) noexcept : mtx_ {mtx} {
+        mtx.lock_shared();
+    }
+
+    shared_lock(const shared_lock&) = delete;
+
+    ~shared_lock() noexcept {
+        mtx_.unlock_shared();
+    }
+
+private:
+    Mutex& mtx_;
+};
+
+}  // namespace stl
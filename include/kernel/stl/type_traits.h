@@ -33,4 +33,12 @@ struct remove_const<const T> {
     using type = T;
 };
 
+template <typename T>
+struct type_identity {
+    using type = T;
+};
+
+template <typename T>
+using type_identity_t = typename type_identity<T>::type;
+
 }  // namespace stl
\ No newline at end of file
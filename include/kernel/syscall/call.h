@@ -15,8 +15,18 @@ namespace sc {
 //! The maximum number of supported system calls.
 inline constexpr stl::size_t count {0x60};
 
-//! The system call handler.
-using Handler = stl::int32_t (*)(void*) noexcept;
+//! The maximum number of system call arguments, which are passed in registers.
+inline constexpr stl::size_t max_arg_count {5};
+
+/**
+ * @brief The system call handler.
+ *
+ * @details
+ * A handler can have up to @p max_arg_count parameters of pointers, integers, Boolean values or enumerations.
+ * Each parameter is passed in a register.
+ */
+using Handler = stl::int32_t (*)(stl::uintptr_t, stl::uintptr_t, stl::uintptr_t, stl::uintptr_t,
+                                 stl::uintptr_t) noexcept;
 
 /**
  * @brief Types of system calls.
@@ -38,7 +48,51 @@ enum class SysCallType {
     SeekFile,
     DeleteFile,
     CreateDir,
-    Fork
+    Fork,
+    MemStats,
+    MapMem,
+    UnmapMem,
+    MapSharedMem,
+    DeleteSharedMem,
+    GetTime,
+    ThreadStats,
+    SetupIoRing,
+    EnterIoRing,
+    WriteFileV,
+    ReadFileV,
+    SysCallStats,
+    ResetSysCallStats,
+    WriteConsole,
+    SyncFiles,
+    ReserveFile,
+    ReadDirEntries,
+    FileSysStats,
+    DiskStats,
+    CreatePipe,
+    MapFile,
+    UnmapFile,
+    SyncFileMap,
+    IntrStats,
+    ResetIntrStats,
+    ReadConsole,
+    SetConsoleMode,
+    CreateThread,
+    ExitThread,
+    ExitProcess,
+    WaitProcess,
+    Exec,
+    Spawn,
+    ResetProfiler,
+    DumpProfile,
+    ResetLockStats,
+    DumpLockStats,
+    ResetTrace,
+    DumpTrace,
+    FutexWait,
+    FutexWake,
+    SetThreadPriority,
+    SetThreadTimeSlice,
+    SetThreadAffinity
 };
 
 /**
@@ -84,4 +138,53 @@ SysCallHandlerTab<count>& GetSysCallHandlerTab() noexcept;
 //! Initialize system calls.
 void InitSysCall() noexcept;
 
+/**
+ * @brief Initialize fast system calls by @p sysenter and @p sysexit if the CPU supports them.
+ *
+ * @details
+ * User descriptors must have been created by @p tsk::InitTaskStateSeg.
+ * Otherwise, or if the CPU does not support @p sysenter, system calls use the interrupt.
+ */
+void InitFastSysCall() noexcept;
+
+//! Whether system calls use @p sysenter and @p sysexit.
+bool IsFastSysCallEnabled() noexcept;
+
+/**
+ * @brief Statistics of a system call type.
+ *
+ * @details
+ * It has the same layout as @p usr::sc::SysCallStats.
+ * Latencies are measured in cycles by the time-stamp counter around the handler.
+ */
+struct SysCallStats {
+    //! The number of buckets in the latency histogram.
+    static constexpr stl::size_t latency_bucket_count {32};
+
+    stl::size_t call_count;
+    stl::uint64_t total_cycles;
+    //! The bucket @p i counts calls taking @p [2^i, 2^(i+1)) cycles.
+    stl::size_t latencies[latency_bucket_count];
+};
+
+/**
+ * @brief Reset statistics of all system calls, then enable or disable recording them.
+ *
+ * @details
+ * Recording is disabled by default.
+ * When it is enabled, @p SysCallEntry and @p SysEnterEntry dispatch system calls through a wrapper,
+ * which reads the time-stamp counter before and after calling the handler.
+ */
+void ResetSysCallStats(bool enabled) noexcept;
+
+//! Whether statistics of system calls are being recorded.
+bool IsSysCallStatsEnabled() noexcept;
+
+/**
+ * @brief Get statistics of a system call type.
+ *
+ * @return Whether the type is valid.
+ */
+bool GetSysCallStats(SysCallType, SysCallStats*) noexcept;
+
 }  // namespace sc
\ No newline at end of file
@@ -0,0 +1,67 @@
+/**
+ * @file futex.h
+ * @brief Fast user-space synchronization.
+ *
+ * @details
+ * A futex is a 32-bit word in user memory.
+ * User-mode locks change the word by atomic operations and only trap into the kernel when they are contended:
+ * a thread waits if the word still has an expected value, and another thread wakes it up after changing the word.
+ *
+ * Waiting threads are saved in a hash table keyed by the physical address of the word,
+ * so threads using the same word in shared memory can wake each other up, even if it is mapped to different virtual addresses in their processes.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+#include "kernel/util/metric.h"
+
+namespace sync {
+
+//! The number of buckets in the hash table of waiting threads.
+inline constexpr stl::size_t futex_bucket_count {64};
+
+static_assert((futex_bucket_count & (futex_bucket_count - 1)) == 0);
+
+//! The timeout to wait for a futex without expiration.
+inline constexpr stl::size_t futex_wait_forever {npos};
+
+namespace sc {
+
+//! System calls of futexes.
+class Futex {
+public:
+    Futex() = delete;
+
+    /**
+     * @brief Block the current thread if a futex word has an expected value.
+     *
+     * @details
+     * Checking the word and waiting are atomic with respect to @p Wake,
+     * so a wake-up after the word is changed will not be missed.
+     *
+     * @param addr The user address of a 32-bit aligned word.
+     * @param expected The expected value.
+     * @param milliseconds The timeout, or @p futex_wait_forever.
+     * @return Whether the thread is woken up by @p Wake.
+     * It returns @p false if the address is invalid, the word does not have the expected value or the timeout expires.
+     */
+    static bool Wait(stl::uint32_t* addr, stl::uint32_t expected,
+                     stl::size_t milliseconds) noexcept;
+
+    /**
+     * @brief Wake up threads waiting for a futex word.
+     *
+     * @param addr The user address of a 32-bit aligned word.
+     * @param count The maximum number of threads to wake up.
+     * @return The number of woken threads.
+     */
+    static stl::size_t Wake(stl::uint32_t* addr, stl::size_t count) noexcept;
+};
+
+}  // namespace sc
+
+}  // namespace sync
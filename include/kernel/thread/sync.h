@@ -15,6 +15,51 @@
 
 namespace sync {
 
+/**
+ * @brief The queue of threads waiting for an event.
+ *
+ * @details
+ * A thread is blocked in the queue by its general tag until another thread wakes it up.
+ * Checking a condition and waiting should be done with interrupts disabled, otherwise a wake-up may be missed.
+ *
+ * @code {.cpp}
+ * const intr::IntrGuard guard;
+ * while (!cond) {
+ *     waiters.Wait();
+ * }
+ * @endcode
+ */
+class WaitQueue {
+public:
+    WaitQueue() noexcept = default;
+
+    WaitQueue(const WaitQueue&) = delete;
+
+    //! Initialize an empty queue. It is used when the queue is in allocated memory.
+    WaitQueue& Init() noexcept;
+
+    //! Block the current thread until it is woken up.
+    void Wait() noexcept;
+
+    /**
+     * @brief Block the current thread until it is woken up or a timeout expires.
+     *
+     * @return Whether the thread is woken up before the timeout.
+     */
+    bool Wait(stl::size_t milliseconds) noexcept;
+
+    //! Wake up the first waiting thread. It returns @p false if there is no waiting thread.
+    bool WakeOne() noexcept;
+
+    //! Wake up all waiting threads and return the number of them.
+    stl::size_t WakeAll() noexcept;
+
+    bool IsEmpty() const noexcept;
+
+private:
+    TagList waiters_;
+};
+
 template <stl::size_t max>
 class Semaphore {
 public:
@@ -36,11 +81,8 @@ public:
         const intr::IntrGuard guard;
         dbg::Assert(val_ <= max);
         if (val_ != max) {
-            if (!waiters_.IsEmpty()) {
-                // Wakes up a waiting thread.
-                auto& next_thd {tsk::Thread::GetByTag(waiters_.Pop())};
-                tsk::Thread::Unblock(next_thd);
-            }
+            // Wakes up a waiting thread.
+            waiters_.WakeOne();
 
             ++val_;
         }
@@ -48,13 +90,9 @@ public:
 
     void Decrease() noexcept {
         const intr::IntrGuard guard;
-        auto& curr_thd {tsk::Thread::GetCurrent()};
         // Keep waiting until the semaphore is not zero.
         while (val_ == 0) {
-            // Push the current thread into the wait queue and then block it.
-            dbg::Assert(!waiters_.Find(curr_thd.GetTag()));
-            waiters_.PushBack(curr_thd.GetTag());
-            curr_thd.Block(tsk::Thread::Status::Blocked);
+            waiters_.Wait();
             // When the thread is woken up by the method `Increase`,
             // it is possible that another thread may have grabbed the semaphore faster than it.
             // So we use a loop to check the semaphore again.
@@ -63,32 +101,269 @@ public:
         --val_;
     }
 
+    //! Decrease the semaphore without blocking. It returns @p false if the semaphore is zero.
+    bool TryDecrease() noexcept {
+        const intr::IntrGuard guard;
+        if (val_ == 0) {
+            return false;
+        }
+
+        --val_;
+        return true;
+    }
+
 private:
     stl::size_t val_ {max};
 
     //! The threads waiting for a semaphore.
-    TagList waiters_;
+    WaitQueue waiters_;
+};
+
+/**
+ * @brief The spinlock.
+ *
+ * @details
+ * It uses the test-and-test-and-set algorithm.
+ * A waiting thread spins on reading the lock, which does not lock the memory bus, and only tries to set it when it is free.
+ *
+ * A spinlock does not block threads or disable interrupts.
+ * It should only protect short critical sections.
+ */
+class SpinLock {
+public:
+    SpinLock() noexcept = default;
+
+    SpinLock(const SpinLock&) = delete;
+
+    void Lock() noexcept;
+
+    //! Lock the spinlock without spinning. It returns @p false if the spinlock is held.
+    bool TryLock() noexcept;
+
+    void Unlock() noexcept;
+
+    bool IsLocked() const noexcept;
+
+private:
+    bool locked_ {false};
+};
+
+/**
+ * @brief Statistics of a named mutex.
+ *
+ * @details
+ * Wait cycles are measured by the time-stamp counter from the first failed acquisition to the successful one.
+ * Hold cycles are measured from the acquisition to the release, including the time the holder is switched out.
+ */
+struct LockStats {
+    const char* name;
+    stl::size_t acquire_count;
+    //! The number of acquisitions finding the mutex held by another thread.
+    stl::size_t contended_count;
+    stl::uint64_t total_wait_cycles;
+    stl::uint64_t max_wait_cycles;
+    stl::uint64_t max_hold_cycles;
 };
 
+//! The maximum number of named mutexes with statistics.
+inline constexpr stl::size_t max_lock_stats_count {64};
+
+//! The maximum number of mutexes printed by @p DumpLockStats.
+inline constexpr stl::size_t max_lock_stats_dump_count {16};
+
+/**
+ * @brief Reset statistics of all named mutexes, then enable or disable recording them.
+ *
+ * @details
+ * Recording is disabled by default.
+ * When it is disabled, locking a named mutex only checks a flag.
+ */
+void ResetLockStats(bool enabled) noexcept;
+
+//! Whether statistics of named mutexes are being recorded.
+bool IsLockStatsEnabled() noexcept;
+
+//! Print statistics of the most contended named mutexes.
+void DumpLockStats() noexcept;
+
+/**
+ * @brief The adaptive recursive mutex with priority inheritance.
+ *
+ * @details
+ * - Locking an unheld mutex only needs an atomic operation, without disabling interrupts.
+ * - If the holder is running on another processor, a thread spins for a while, since the mutex may be released soon.
+ * - Otherwise, the thread is blocked in a wait queue.
+ *   If the holder has a lower priority, it inherits the waiter's priority,
+ *   so medium-priority threads cannot delay it while a high-priority thread is waiting.
+ *   The inheritance follows the chain of holders blocked on other mutexes.
+ *   A holder keeps the inherited priority until it releases all its mutexes.
+ *
+ * A named mutex has statistics in a global table, which are recorded when @p ResetLockStats enables them.
+ */
 class Mutex {
 public:
+    //! The maximum number of spins before a thread is blocked.
+    static constexpr stl::size_t max_spin_count {100};
+
+    //! The maximum length of a holder chain to pass an inherited priority along.
+    static constexpr stl::size_t max_inherit_depth {8};
+
     Mutex() noexcept = default;
 
+    //! Create a named mutex with statistics.
+    explicit Mutex(const char* name) noexcept;
+
     Mutex(const Mutex&) = delete;
 
+    /**
+     * @brief Name the mutex and give it statistics.
+     *
+     * @details
+     * If there are already @p max_lock_stats_count named mutexes, it has no statistics.
+     * The name must not be destroyed before the mutex.
+     */
+    Mutex& SetName(const char* name) noexcept;
+
     void Lock() noexcept;
 
+    //! Lock the mutex without blocking. It returns @p false if the mutex is held by another thread.
+    bool TryLock() noexcept;
+
     void Unlock() noexcept;
 
 private:
-    //! A mutex is a semaphore with a maximum value of 1.
-    Semaphore<1> sema_;
+    //! Try to set the current thread as the holder.
+    bool TryAcquire(tsk::Thread&) noexcept;
+
+    //! Block the current thread in the wait queue until the mutex is released.
+    void Wait(tsk::Thread&) noexcept;
+
+    //! Wake up a waiting thread.
+    void Wake() noexcept;
+
+    //! Raise the priority of the holder and the holders it is blocked on to the priority of a waiter.
+    void InheritPriority(const tsk::Thread& waiter) const noexcept;
+
+    //! Get the statistics to record, or @p nullptr if the mutex is unnamed or recording is disabled.
+    LockStats* GetStats() const noexcept;
+
+    //! Record an acquisition and start measuring the hold time.
+    void RecordLock(LockStats&, bool contended, stl::uint64_t wait_cycles) noexcept;
 
     //! The thread currently holding the mutex.
     tsk::Thread* holder_ {nullptr};
 
     //! The number of times it is locked.
     stl::size_t repeat_times_ {0};
+
+    //! The number of threads waiting or about to wait for the mutex.
+    stl::size_t waiter_count_ {0};
+
+    //! The lock protecting the wait queue.
+    SpinLock wait_lock_;
+
+    //! The threads waiting for the mutex.
+    TagList waiters_;
+
+    //! The statistics of a named mutex.
+    LockStats* stats_ {nullptr};
+
+    //! The time-stamp counter when the mutex was acquired, or @p 0 if the hold time is not measured.
+    stl::uint64_t locked_tsc_ {0};
+};
+
+/**
+ * @brief The reader-writer lock.
+ *
+ * @details
+ * Multiple readers can hold the lock at the same time, but a writer holds it exclusively.
+ * Writers have priority. When a writer is waiting, new readers are blocked, so writers do not starve.
+ */
+class RwLock {
+public:
+    RwLock() noexcept = default;
+
+    RwLock(const RwLock&) = delete;
+
+    //! Lock the lock exclusively for writing.
+    void Lock() noexcept;
+
+    bool TryLock() noexcept;
+
+    void Unlock() noexcept;
+
+    //! Lock the lock shared for reading.
+    void LockShared() noexcept;
+
+    bool TryLockShared() noexcept;
+
+    void UnlockShared() noexcept;
+
+private:
+    //! Whether a reader can hold the lock now.
+    bool CanRead() const noexcept;
+
+    //! Whether a writer can hold the lock now.
+    bool CanWrite() const noexcept;
+
+    //! The thread currently holding the lock for writing.
+    tsk::Thread* writer_ {nullptr};
+
+    //! The number of readers currently holding the lock.
+    stl::size_t reader_count_ {0};
+
+    //! The number of writers waiting for the lock.
+    stl::size_t waiting_writer_count_ {0};
+
+    //! The readers waiting for the lock.
+    WaitQueue readers_;
+
+    //! The writers waiting for the lock.
+    WaitQueue writers_;
+};
+
+/**
+ * @brief The condition variable.
+ *
+ * @details
+ * A thread waits for a condition with a locked mutex.
+ * The mutex is released while the thread is blocked and locked again before waiting returns.
+ * A woken thread should check its condition again, since another thread may have changed it first.
+ *
+ * @code {.cpp}
+ * mtx.Lock();
+ * while (!cond) {
+ *     cv.Wait(mtx);
+ * }
+ * mtx.Unlock();
+ * @endcode
+ *
+ * @warning
+ * The mutex must be locked exactly once by the current thread.
+ */
+class CondVar {
+public:
+    CondVar() noexcept = default;
+
+    CondVar(const CondVar&) = delete;
+
+    void Wait(Mutex&) noexcept;
+
+    /**
+     * @brief Wait until the condition variable is notified or a timeout expires.
+     *
+     * @return Whether the condition variable is notified before the timeout.
+     */
+    bool Wait(Mutex&, stl::size_t milliseconds) noexcept;
+
+    //! Wake up a waiting thread.
+    void NotifyOne() noexcept;
+
+    //! Wake up all waiting threads.
+    void NotifyAll() noexcept;
+
+private:
+    WaitQueue waiters_;
 };
 
 }  // namespace sync
\ No newline at end of file
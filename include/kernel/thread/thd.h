@@ -8,22 +8,73 @@
 
 #pragma once
 
+#include "kernel/cpu/fpu.h"
+#include "kernel/cpu/mp.h"
 #include "kernel/debug/assert.h"
 #include "kernel/interrupt/intr.h"
 #include "kernel/io/disk/file/file.h"
 #include "kernel/io/disk/file/inode.h"
 #include "kernel/io/file/file.h"
 #include "kernel/io/video/print.h"
+#include "kernel/memory/magazine.h"
+#include "kernel/memory/page.h"
 #include "kernel/stl/array.h"
 #include "kernel/stl/string_view.h"
+#include "kernel/util/bit.h"
 #include "kernel/util/tag_list.h"
 
 namespace tsk {
 
 class Process;
 
+}  // namespace tsk
+
+namespace sync {
+class Mutex;
+}
+
+namespace tsk {
+
+namespace sc {
+class Thread;
+}
+
+/**
+ * @brief The number of pages in a thread block, which contains the kernel thread stack.
+ *
+ * @details
+ * It can be set by the @p KRNL_STACK_PAGE_COUNT macro, which must also be passed to the assembler.
+ * Optimization levels higher than @p -O1 use more stack memory for local variables and need more pages.
+ *
+ * The block of the main kernel thread is located below the stack top set by the loader.
+ * More than four pages would overlap the memory where the loader reads the raw kernel.
+ */
+#ifdef KRNL_STACK_PAGE_COUNT
+inline constexpr stl::size_t thd_block_page_count {KRNL_STACK_PAGE_COUNT};
+#else
+inline constexpr stl::size_t thd_block_page_count {1};
+#endif
+
+static_assert(thd_block_page_count == 1 || thd_block_page_count == 2
+              || thd_block_page_count == 4);
+
+//! The size of a thread block. A thread block is aligned to its size.
+inline constexpr stl::size_t thd_block_size {thd_block_page_count * mem::page_size};
+
+/**
+ * @brief The offset of the kernel stack address in a thread block.
+ *
+ * @details
+ * The context switch in assembly saves the stack address at this offset.
+ * It must be the same as @p thd_krnl_stack_offset in @p thd.inc.
+ */
+inline constexpr stl::size_t thd_krnl_stack_offset {24};
+
+//! The number of file descriptors a file descriptor table saves without allocating memory.
+inline constexpr stl::size_t init_open_file_count {8};
+
 //! The maximum number of files a process can open.
-inline constexpr stl::size_t max_open_file_count {8};
+inline constexpr stl::size_t max_open_file_count {256};
 
 /**
  * @brief Utilities for manipulating the file descriptor table of the current process.
@@ -54,49 +105,39 @@ public:
  * 1. Use a local descriptor @p io::FileDesc to get the global descriptor @p io::FileDesc from @p FileDescTab.
  * 2. Use the global descriptor to get the file @p io::fs::File from @p io::fs::FileTab.
  */
-template <stl::size_t size>
 class FileDescTab {
-    static_assert(size > io::std_stream_count);
+    static_assert(init_open_file_count > io::std_stream_count
+                  && init_open_file_count <= max_open_file_count);
 
 public:
     FileDescTab() noexcept {
         Init();
     }
 
-    FileDescTab& Init() noexcept {
-        dbg::Assert(descs_.size() > io::std_stream_count);
-        // The first three descriptors are standard I/O streams.
-        descs_[io::std_in] = io::std_in;
-        descs_[io::std_out] = io::std_out;
-        descs_[io::std_err] = io::std_err;
-        for (stl::size_t i {io::std_stream_count}; i != descs_.size(); ++i) {
-            descs_[i].Reset();
-        }
-
-        return *this;
-    }
+    FileDescTab(const FileDescTab&) = delete;
 
-    constexpr stl::size_t GetSize() const noexcept {
-        return descs_.size();
-    }
+    /**
+     * @brief Initialize an empty table with standard streams.
+     *
+     * @details
+     * Memory allocated by the table before is not freed.
+     */
+    FileDescTab& Init() noexcept;
+
+    //! Get the number of usable descriptors, which grows until @p max_open_file_count.
+    stl::size_t GetSize() const noexcept;
 
     /**
      * @brief Save a global file descriptor to the process or kernel thread.
      *
+     * @details
+     * Free descriptors are linked into a stack, so it takes constant time unless the table grows.
+     * The table doubles its size when it is full.
+     *
      * @param global A global file descriptor.
      * @return A local descriptor for internal file access. It might be invalid if the table is full.
      */
-    io::FileDesc SyncGlobal(const io::FileDesc global) noexcept {
-        for (stl::size_t i {io::std_stream_count}; i != descs_.size(); ++i) {
-            if (!descs_[i].IsValid()) {
-                descs_[i] = global;
-                return i;
-            }
-        }
-
-        io::PrintlnStr("The process file table is full.");
-        return {};
-    }
+    io::FileDesc SyncGlobal(io::FileDesc global) noexcept;
 
     /**
      * @brief Get the global file descriptor from the process or kernel thread.
@@ -104,44 +145,100 @@ public:
      * @param local A local descriptor.
      * @return The global file descriptor.
      */
-    io::FileDesc GetGlobal(const io::FileDesc local) const noexcept {
-        dbg::Assert(io::std_stream_count <= local && local < descs_.size());
-        const auto global {descs_[local]};
-        dbg::Assert(global.IsValid());
-        return global;
-    }
+    io::FileDesc GetGlobal(io::FileDesc local) const noexcept;
 
-    FileDescTab& Reset(const io::FileDesc local) noexcept {
-        dbg::Assert(io::std_stream_count <= local && local < descs_.size());
-        descs_[local].Reset();
-        return *this;
-    }
+    //! Whether a local descriptor other than standard streams refers to an open file.
+    bool IsOpen(io::FileDesc local) const noexcept;
+
+    FileDescTab& Reset(io::FileDesc local) noexcept;
+
+    /**
+     * @brief Copy descriptors from another table.
+     *
+     * @details
+     * The table must be new or have not allocated memory.
+     */
+    FileDescTab& CopyFrom(const FileDescTab&) noexcept;
 
     /**
      * @brief Fork the file descriptor table.
      *
      * @details
+     * It should be called on the copied table of a child process.
      * For each open file, forking increases their reference count by one.
+     * Ends of pipes get new global descriptors, which are closed in the child if the global table is full.
      */
-    const FileDescTab& Fork() const noexcept {
-        auto& file_tab {io::fs::GetFileTab()};
-        for (stl::size_t i {io::std_stream_count}; i != descs_.size(); ++i) {
-            // If a descriptor refers to an open file, increase its reference count.
-            if (const auto desc {descs_[i]}; desc.IsValid()) {
-                dbg::Assert(file_tab[desc].IsOpen() && file_tab[desc].GetNode().open_times > 0);
-                ++file_tab[desc].GetNode().open_times;
-            }
-        }
-
-        return *this;
-    }
+    FileDescTab& Fork() noexcept;
 
-    FileDescTab& Fork() noexcept {
-        return const_cast<FileDescTab&>(const_cast<const FileDescTab&>(*this).Fork());
-    }
+    /**
+     * @brief Close all open files and free allocated memory when the process exits.
+     *
+     * @details
+     * The table becomes an empty table with standard streams.
+     */
+    FileDescTab& CloseAll() noexcept;
 
 private:
-    stl::array<io::FileDesc, size> descs_;
+    struct Entry {
+        //! The global file descriptor, which is invalid if the entry is free.
+        io::FileDesc global;
+
+        //! The next free entry in the stack, or @p npos if it is the last one.
+        stl::size_t next_free;
+    };
+
+    //! Allocate a table twice larger and push new entries to the free stack.
+    bool Grow() noexcept;
+
+    const Entry* GetEntries() const noexcept;
+
+    Entry* GetEntries() noexcept;
+
+    stl::array<Entry, init_open_file_count> init_entries_;
+
+    //! Allocated entries after the table grows, or @p nullptr if initial entries are used.
+    Entry* entries_;
+
+    stl::size_t size_;
+
+    //! The top of the free entry stack.
+    stl::size_t free_top_;
+};
+
+/**
+ * @brief Scheduler statistics of a thread.
+ *
+ * @details
+ * Times are in nanoseconds. They are only measured after the timer has been initialized.
+ *
+ * @warning
+ * Its layout must be the same as @p usr::tsk::ThreadStats.
+ */
+struct ThreadStats {
+    static constexpr stl::size_t name_len {16};
+
+    stl::array<char, name_len + 1> name;
+    //! The value of @p Thread::Status.
+    stl::size_t status;
+    stl::size_t priority;
+    //! The number of clock interrupts while the thread is running.
+    stl::size_t elapsed_ticks;
+    //! The total time running on the CPU.
+    stl::uint64_t run_time;
+    //! The total time waiting in the run queue.
+    stl::uint64_t ready_time;
+    //! The total time being blocked.
+    stl::uint64_t blocked_time;
+    //! The maximum time from being unblocked to running.
+    stl::uint64_t max_wake_latency;
+    //! The number of times the thread gives up the CPU by blocking or yielding.
+    stl::size_t voluntary_switch_count;
+    //! The number of times the thread is removed from the CPU when its time slices run out.
+    stl::size_t involuntary_switch_count;
+    //! The number of ticks the thread can run in the CPU at a time.
+    stl::size_t time_slice;
+    //! The mask of processors the thread can run on.
+    stl::uint32_t affinity;
 };
 
 #pragma pack(push, 1)
@@ -151,10 +248,10 @@ private:
  *
  * @details
  * Here is the memory layout of a thread block and its stack.
- * The total size is one memory page.
+ * The total size is @p thd_block_size, one memory page by default.
  *
  * @code
- * 0xFFF ┌─────────────────┐ `GetKrnlStackBottom`
+ *  size ┌─────────────────┐ `GetKrnlStackBottom`
  *       │ Interrupt Stack │
  *       ├─────────────────┤ `GetIntrStack`
  *       │┌───────────────┐│
@@ -172,17 +269,30 @@ private:
  *
  * @warning
  * The compiler might allocate more memory for the control block in a thread, especially with debug options.
- * In that case, the size of a thread block is larger than one memory page, and some methods no longer work.
+ * In that case, the control block is larger than the thread block, and some methods no longer work.
  */
 class Thread {
     friend class Process;
+    friend class sc::Thread;
+    friend void DumpThreadStats() noexcept;
 
 public:
     enum class Status { Died, Ready, Running, Blocked, Waiting, Hanging };
 
     using Callback = void (*)(void*) noexcept;
 
-    static FileDescTab<max_open_file_count>& GetFileDescTab() noexcept;
+    //! The maximum priority. Higher priorities only give longer default time slices.
+    static constexpr stl::size_t max_priority {31};
+
+    //! The maximum number of ticks in a time slice set by @p SetTimeSlice.
+    static constexpr stl::size_t max_time_slice {256};
+
+    //! The affinity mask allowing a thread to run on any processor.
+    static constexpr stl::uint32_t any_cpu {0xFFFFFFFF};
+
+    static_assert(cpu::max_cpu_count <= sizeof(any_cpu) * bit::byte_len);
+
+    static FileDescTab& GetFileDescTab() noexcept;
 
     static void Unblock(Thread&) noexcept;
 
@@ -190,6 +300,19 @@ public:
 
     static Thread& GetByTag(const TagList::Tag&) noexcept;
 
+    /**
+     * @brief Wake up sleeping threads whose wake-up ticks have been reached.
+     *
+     * @details
+     * It is called by the clock interrupt handler on each tick.
+     *
+     * @param ticks The number of ticks after system startup.
+     */
+    static void WakeSleepers(stl::size_t ticks) noexcept;
+
+    //! Get the earliest wake-up tick of sleeping threads, or @p npos if no thread is sleeping.
+    static stl::size_t GetNextWakeTick() noexcept;
+
     /**
      * @brief Create and start a thread.
      *
@@ -204,12 +327,101 @@ public:
 
     Thread(const Thread&) = delete;
 
+    stl::string_view GetName() const noexcept;
+
     Status GetStatus() const noexcept;
 
     Thread& SetStatus(Status) noexcept;
 
+    /**
+     * @brief Get the effective priority.
+     *
+     * @details
+     * It is the higher one of the thread's own priority and the priority inherited from threads waiting for its mutexes.
+     */
     stl::size_t GetPriority() const noexcept;
 
+    /**
+     * @brief Raise the effective priority to the priority of a thread waiting for a mutex held by the thread.
+     *
+     * @details
+     * If the thread is ready, it is moved to the new level in the run queue at once.
+     */
+    Thread& InheritPriority(stl::size_t priority) noexcept;
+
+    /**
+     * @brief Set the thread's own priority.
+     *
+     * @details
+     * The thread returns to the base level of the new priority.
+     * If it is ready, it is moved to the level in the run queue at once.
+     * It does not drop an inherited priority.
+     */
+    Thread& SetPriority(stl::size_t priority) noexcept;
+
+    /**
+     * @brief Get the number of ticks the thread can run in the CPU at a time.
+     *
+     * @details
+     * By default, it is the thread's own priority.
+     */
+    stl::size_t GetTimeSlice() const noexcept;
+
+    /**
+     * @brief Set the number of ticks the thread can run in the CPU at a time.
+     *
+     * @details
+     * It takes effect when the current time slice runs out.
+     *
+     * @param ticks The number of ticks, or @p 0 to use the priority.
+     */
+    Thread& SetTimeSlice(stl::size_t ticks) noexcept;
+
+    //! Get the mask of processors the thread can run on.
+    stl::uint32_t GetAffinity() const noexcept;
+
+    /**
+     * @brief Set the mask of processors the thread can run on.
+     *
+     * @details
+     * The scheduler skips ready threads that cannot run on the current processor.
+     *
+     * @return Whether the mask contains a processor running the kernel. Otherwise the affinity is not changed.
+     */
+    bool SetAffinity(stl::uint32_t mask) noexcept;
+
+    //! Whether the thread can run on a processor.
+    bool CanRunOn(stl::size_t cpu_idx) const noexcept;
+
+    //! Record that the thread has locked a mutex.
+    Thread& OnMutexLocked() noexcept;
+
+    /**
+     * @brief Record that the thread has unlocked a mutex.
+     *
+     * @details
+     * When the thread holds no mutex, its inherited priority is dropped.
+     */
+    Thread& OnMutexUnlocked() noexcept;
+
+    //! Get the number of mutexes the thread holds.
+    stl::size_t GetHeldMutexCount() const noexcept;
+
+    /**
+     * @brief Record that the thread has entered an interrupt handler.
+     *
+     * @return The number of interrupt handlers the thread was already running.
+     */
+    stl::size_t OnIntrEntered() noexcept;
+
+    //! Record that the thread has left an interrupt handler.
+    Thread& OnIntrExited() noexcept;
+
+    //! Get the mutex the thread is blocked on, or @p nullptr.
+    const sync::Mutex* GetWaitingMutex() const noexcept;
+
+    Thread& SetWaitingMutex(const sync::Mutex*) noexcept;
+
     Process* GetProcess() const noexcept;
 
     /**
@@ -239,13 +451,59 @@ public:
      */
     void Block(Status status) noexcept;
 
+    /**
+     * @brief Block the thread for a period of time.
+     *
+     * @details
+     * The thread is added to the sleeping-thread list and unblocked by the clock interrupt handler after its wake-up tick.
+     */
     void Sleep(stl::size_t milliseconds) noexcept;
 
+    /**
+     * @brief Block the thread until it is unblocked or a timeout expires.
+     *
+     * @param milliseconds The timeout.
+     * @param queued
+     * Whether the thread has been added to a wait queue by its general tag.
+     * If so, it will be removed from the queue when the timeout expires.
+     * Interrupts must be disabled between adding the thread to the queue and calling this method.
+     * @return Whether the thread is unblocked before the timeout.
+     */
+    bool BlockFor(stl::size_t milliseconds, bool queued) noexcept;
+
+    /**
+     * @brief Terminate the current thread.
+     *
+     * @details
+     * The thread wakes up its joining thread and never runs again.
+     * A detached thread is freed by the reaper thread.
+     * Otherwise its thread block is kept until another thread joins it.
+     */
+    [[noreturn]] void Exit() noexcept;
+
+    /**
+     * @brief Wait until the thread exits and free it.
+     *
+     * @warning
+     * A thread can only be joined once, and cannot be joined after being detached.
+     * It becomes invalid after joining.
+     */
+    void Join() noexcept;
+
+    /**
+     * @brief Free the thread automatically when it exits.
+     *
+     * @warning
+     * A detached thread cannot be joined and may become invalid at any time.
+     */
+    Thread& Detach() noexcept;
+
     /**
      * @brief Temporarily remove the thread from the CPU and schedule another thread to run.
      *
      * @details
      * The removed thread is marked as ready to run and its remaining tick will not be reset.
+     * It stays at its current level in the run queue.
      */
     void Yield() noexcept;
 
@@ -255,8 +513,14 @@ public:
      * @details
      * If the removed thread is running, its remaining tick will be reset and it is marked as ready to run.
      *
-     * The scheduler uses the basic First-In-First-Out algorithm.
-     * The thread priority only represents the maximum number of time slices a thread can run in the CPU at a time.
+     * The scheduler uses a multi-level run queue. Each level is first-in-first-out.
+     * - The thread priority determines its base level,
+     *   and the default maximum number of time slices a thread can run in the CPU at a time.
+     * - Ready threads that cannot run on the current processor are skipped.
+     * - A thread whose time slices run out is moved to a lower level.
+     * - An unblocked thread returns to its base level.
+     * - A thread waiting too long in the run queue is moved to the highest level.
+     *
      * High-priority threads cannot directly preempt running low-priority threads.
      */
     void Schedule() noexcept;
@@ -278,11 +542,42 @@ public:
     //! Fork a new thread.
     Thread& Fork() const noexcept;
 
+    /**
+     * @brief Get the memory block magazines, or @p nullptr if the thread has not cached blocks.
+     *
+     * @details
+     * They only cache blocks from the default memory pool of the thread.
+     * - A kernel thread caches kernel blocks.
+     * - A user thread caches user blocks of its process.
+     *
+     * They are allocated on first use outside the thread block, which leaves more space for the kernel stack.
+     */
+    const mem::MemBlockMagazines* GetMemBlockMagazines() const noexcept;
+
+    mem::MemBlockMagazines* GetMemBlockMagazines() noexcept;
+
+    Thread& SetMemBlockMagazines(mem::MemBlockMagazines*) noexcept;
+
+    ThreadStats GetStats() const noexcept;
+
+    //! Get the saved FPU state, or @p nullptr if the thread has never used the FPU.
+    const cpu::FpuState* GetFpuState() const noexcept;
+
+    cpu::FpuState* GetFpuState() noexcept;
+
+    Thread& SetFpuState(cpu::FpuState*) noexcept;
+
 protected:
     //! @see @p Tags.
-    enum class TagType { General, AllThreads };
+    enum class TagType { General, AllThreads, Sleeping };
 
-    static constexpr stl::size_t name_len {16};
+    static constexpr stl::size_t name_len {ThreadStats::name_len};
+
+    //! The maximum number of levels a thread can be moved below its base level.
+    static constexpr stl::size_t max_demotion_count {3};
+
+    //! The number of ticks a ready thread can wait before it is moved to the highest level.
+    static constexpr stl::size_t starvation_ticks {100};
     static constexpr stl::uint32_t stack_guard {0x12345678};
 
     /**
@@ -349,6 +644,13 @@ protected:
 
         //! The tag for the list of all threads.
         TagList::Tag all_thds;
+
+        /**
+         * @details
+         * The tag for the list of sleeping threads.
+         * A thread waiting in a list with a timeout also uses its general tag.
+         */
+        TagList::Tag sleep;
     };
 
     static Thread& GetByTag(const TagList::Tag&, TagType) noexcept;
@@ -385,7 +687,7 @@ protected:
     /**
      * @details
      * Load the thread environment, including:
-     * - The page directory table.
+     * - The page directory table, if it is not the loaded one.
      * - The task state segment.
      */
     Thread& LoadKrnlEnv() noexcept;
@@ -401,12 +703,30 @@ protected:
      * - If the thread is a kernel thread, it uses the kernel page directory table.
      * - If the thread belongs to a user process, it uses the process's page directory table.
      *   Each user process has its own page directory table.
+     *
+     * It always writes @p CR3, so TLB entries of changed pages are flushed.
      */
     const Thread& LoadPageDir() const noexcept;
 
+    //! Get the physical address of the page directory table used by the thread.
+    stl::uintptr_t GetPageDirPhyAddr() const noexcept;
+
     //! Copy the thread data to another thread.
     void CopyTo(Thread&) const noexcept;
 
+    //! Get the run queue level determined by the priority.
+    stl::size_t GetBaseLevel() const noexcept;
+
+    /**
+     * @brief Add the ready thread to its current level in the run queue.
+     *
+     * @param front Whether to put the thread at the beginning of the level.
+     */
+    Thread& Enqueue(bool front = false) noexcept;
+
+    //! Move threads waiting too long in the run queue to the highest level.
+    static void AgeReadyThreads() noexcept;
+
     Tags tags_;
 
     //! The address of the free thread stack.
@@ -416,9 +736,15 @@ protected:
 
     Status status_ {Status::Died};
 
-    //! The maximum number of time slices the thread can run in the CPU at a time.
+    //! The thread's own priority, which determines its base level.
     stl::size_t priority_ {0};
 
+    //! The number of ticks the thread can run in the CPU at a time, or @p 0 to use the priority.
+    stl::size_t time_slice_ {0};
+
+    //! The mask of processors the thread can run on.
+    stl::uint32_t affinity_ {any_cpu};
+
     /**
      * @details
      * The number of remaining ticks the thread can run in the CPU at this time.
@@ -429,9 +755,72 @@ protected:
     //! The total number of ticks after thread startup.
     stl::size_t elapsed_ticks_ {0};
 
+    //! The tick when a sleeping thread should be woken up.
+    stl::size_t wake_tick_ {0};
+
+    //! Whether the thread is in the sleeping-thread list.
+    bool sleeping_ {false};
+
+    //! Whether the thread is blocked with a timeout in a wait queue.
+    bool queued_ {false};
+
+    //! Whether the last timeout expired before the thread was unblocked.
+    bool timed_out_ {false};
+
+    //! Whether the thread is freed by the reaper thread when it exits.
+    bool detached_ {false};
+
+    //! The thread waiting for the thread to exit.
+    Thread* joiner_ {nullptr};
+
+    //! Scheduler accounting.
+    struct Accounting {
+        stl::uint64_t run_time;
+        stl::uint64_t ready_time;
+        stl::uint64_t blocked_time;
+        stl::uint64_t max_wake_latency;
+        stl::size_t voluntary_switch_count;
+        stl::size_t involuntary_switch_count;
+    };
+
+    Accounting acct_ {};
+
+    //! The time in nanoseconds when the thread entered its current status.
+    stl::uint64_t status_time_ {0};
+
+    //! Whether the thread has been unblocked but not run since then.
+    bool woken_ {false};
+
+    //! The FPU state saved when another thread uses the FPU.
+    cpu::FpuState* fpu_state_ {nullptr};
+
+    //! The priority inherited from threads waiting for mutexes held by the thread, or zero.
+    stl::size_t inherited_priority_ {0};
+
+    //! The number of mutexes held by the thread.
+    stl::size_t held_mutex_count_ {0};
+
+    //! The mutex the thread is blocked on.
+    const sync::Mutex* waiting_mtx_ {nullptr};
+
+    //! The number of interrupt handlers the thread is running. It is only counted with interrupt statistics.
+    stl::size_t intr_depth_ {0};
+
+    //! The current level in the run queue.
+    stl::size_t level_ {0};
+
+    //! The tick when the thread was added to the run queue.
+    stl::size_t ready_tick_ {0};
+
     //! The parent process, or @p nullptr for kernel threads.
     Process* proc_ {nullptr};
 
+    //! The index of the user stack in the parent process, which is freed when the thread exits.
+    stl::size_t usr_stack_idx_ {0};
+
+    //! Free memory blocks cached by the thread.
+    mem::MemBlockMagazines* mem_blocks_ {nullptr};
+
     //! A guard for stack overflow checking.
     stl::uint32_t stack_guard_ {stack_guard};
 };
@@ -460,14 +849,14 @@ public:
                               void* arg = nullptr) noexcept;
 
     //! Get the file descriptor file.
-    const FileDescTab<max_open_file_count>& GetFileDescTab() const noexcept;
+    const FileDescTab& GetFileDescTab() const noexcept;
 
-    FileDescTab<max_open_file_count>& GetFileDescTab() noexcept;
+    FileDescTab& GetFileDescTab() noexcept;
 
 private:
     KrnlThread& Init(stl::string_view name, stl::size_t priority) noexcept;
 
-    FileDescTab<max_open_file_count> file_descs_;
+    FileDescTab file_descs_;
 };
 
 #pragma pack(pop)
@@ -478,4 +867,68 @@ void InitThread() noexcept;
 //! Whether threads have been initialized.
 bool IsThreadInited() noexcept;
 
+//! Print scheduler statistics of all threads.
+void DumpThreadStats() noexcept;
+
+/**
+ * @brief Allocate thread blocks in advance, so creating threads does not allocate pages.
+ *
+ * @details
+ * It may block and must be called in a thread.
+ */
+void ReserveThreadBlocks(stl::size_t count) noexcept;
+
+//! System calls.
+namespace sc {
+
+class Thread {
+public:
+    Thread() = delete;
+
+    /**
+     * @brief Get scheduler statistics of a thread.
+     *
+     * @param idx The index of a thread in the list of all threads.
+     * @param stats The returned statistics.
+     * @return Whether the index is in range.
+     */
+    static bool GetStats(stl::size_t idx, ThreadStats* stats) noexcept;
+
+    /**
+     * @brief Start a thread in the current process.
+     *
+     * @param code The code entry. It is called with the argument and must not return.
+     * @param arg An argument to the code entry.
+     * @return Whether the thread is started. It fails if the process has too many threads.
+     */
+    static bool Create(void* code, void* arg) noexcept;
+
+    //! Exit the current thread. A user thread must call it instead of returning from its code entry.
+    static void Exit() noexcept;
+
+    /**
+     * @brief Set the priority of the current thread.
+     *
+     * @return Whether the priority is between @p 1 and @p Thread::max_priority.
+     */
+    static bool SetPriority(stl::size_t priority) noexcept;
+
+    /**
+     * @brief Set the number of ticks the current thread can run in the CPU at a time.
+     *
+     * @param ticks The number of ticks, or @p 0 to use the priority.
+     * @return Whether the number is not larger than @p Thread::max_time_slice.
+     */
+    static bool SetTimeSlice(stl::size_t ticks) noexcept;
+
+    /**
+     * @brief Set the mask of processors the current thread can run on.
+     *
+     * @return Whether the mask contains a processor running the kernel.
+     */
+    static bool SetAffinity(stl::uint32_t mask) noexcept;
+};
+
+}  // namespace sc
+
 }  // namespace tsk
\ No newline at end of file
@@ -68,6 +68,26 @@ constexpr void ResetBit(T& val, const stl::size_t idx) noexcept {
     val &= ~(static_cast<T>(1) << idx);
 }
 
+/**
+ * @brief Get the index of the lowest set bit in a double word.
+ *
+ * @details
+ * It is compiled to a @p bsf instruction. The value must not be zero.
+ */
+constexpr stl::size_t GetLowestSetBit(const stl::uint32_t val) noexcept {
+    return static_cast<stl::size_t>(__builtin_ctz(val));
+}
+
+/**
+ * @brief Get the index of the highest set bit in a double word.
+ *
+ * @details
+ * It is compiled to a @p bsr instruction. The value must not be zero.
+ */
+constexpr stl::size_t GetHighestSetBit(const stl::uint32_t val) noexcept {
+    return static_cast<stl::size_t>(31 - __builtin_clz(val));
+}
+
 //! Get a byte from a value.
 template <typename T>
 constexpr stl::uint8_t GetByte(const T val, const stl::size_t begin) noexcept {
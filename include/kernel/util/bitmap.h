@@ -9,6 +9,7 @@
 #pragma once
 
 #include "kernel/stl/cstdint.h"
+#include "kernel/util/bit.h"
 
 class Bitmap {
 public:
@@ -31,9 +32,16 @@ public:
 
     Bitmap& Init(void* bits, stl::size_t byte_len, bool clear = true) noexcept;
 
+    //! Copy bits from another bitmap with the same length.
+    Bitmap& CopyFrom(const Bitmap&) noexcept;
+
     /**
      * @brief Try to allocate the specified number of bits.
      *
+     * @details
+     * The bitmap is scanned 32 bits at a time, starting from the first possibly free bit.
+     * Bits before that position are always allocated, so a nearly full bitmap does not need to be scanned from the beginning.
+     *
      * @param count The number of bits to be allocated.
      * @return
      * The beginning index of the allocated bits if it succeeds.
@@ -41,6 +49,17 @@ public:
      */
     stl::size_t Alloc(stl::size_t count = 1) noexcept;
 
+    /**
+     * @brief Try to allocate the specified number of bits at or after a hint.
+     *
+     * @details
+     * If there are no enough free bits after the hint, it is the same as @p Alloc.
+     *
+     * @param hint The preferred beginning index.
+     * @param count The number of bits to be allocated.
+     */
+    stl::size_t AllocNear(stl::size_t hint, stl::size_t count = 1) noexcept;
+
     //! Forcefully mark the specified bits as allocated.
     Bitmap& ForceAlloc(stl::size_t begin, stl::size_t count = 1) noexcept;
 
@@ -54,17 +73,66 @@ public:
 
     const void* GetBits() const noexcept;
 
+    //! Get the number of free bits. It scans the whole bitmap.
+    stl::size_t GetFreeCount() const noexcept;
+
+    //! Get the index of the first possibly free bit. All bits before it are allocated.
+    stl::size_t GetFreeHint() const noexcept;
+
+    /**
+     * @brief Set the index of the first possibly free bit, which is saved elsewhere.
+     *
+     * @details
+     * All bits before the hint must be allocated. Otherwise, they will not be allocated until some bits before them are freed.
+     */
+    Bitmap& SetFreeHint(stl::size_t) noexcept;
+
     bool IsAlloc(stl::size_t idx) const noexcept;
 
 private:
+    //! The number of bits scanned at a time.
+    static constexpr stl::size_t dword_bit_len {sizeof(stl::uint32_t) * bit::byte_len};
+
     Bitmap& SetBit(stl::size_t idx, bool val) noexcept;
 
+    /**
+     * @brief Try to allocate the specified number of bits in the range <tt>[begin, end)</tt>.
+     *
+     * @return The beginning index of the allocated bits, or @p npos if there are no enough free bits.
+     */
+    stl::size_t AllocInRange(stl::size_t begin, stl::size_t end, stl::size_t count) noexcept;
+
+    /**
+     * @brief Load a double word of bits.
+     *
+     * @details
+     * Bytes beyond the end of the bitmap are regarded as allocated.
+     */
+    stl::uint32_t LoadDword(stl::size_t dword_idx) const noexcept;
+
+    /**
+     * @brief Find the first free bit in the range <tt>[begin, end)</tt>.
+     *
+     * @return The index of the free bit, or @p npos if all bits are allocated.
+     */
+    stl::size_t FindFree(stl::size_t begin, stl::size_t end) const noexcept;
+
+    /**
+     * @brief Find the first allocated bit in the range <tt>[begin, end)</tt>.
+     *
+     * @return The index of the allocated bit, or @p npos if all bits are free.
+     */
+    stl::size_t FindAlloc(stl::size_t begin, stl::size_t end) const noexcept;
+
     Bitmap& Set(stl::size_t begin, stl::size_t count) noexcept;
 
     Bitmap& Reset(stl::size_t begin, stl::size_t count) noexcept;
 
     stl::size_t byte_len_ {0};
     stl::uint8_t* bits_ {nullptr};
+
+    //! The index of the first possibly free bit. All bits before it are allocated.
+    stl::size_t free_hint_ {0};
 };
 
 void swap(Bitmap&, Bitmap&) noexcept;
\ No newline at end of file
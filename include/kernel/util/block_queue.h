@@ -10,9 +10,9 @@
 
 #include "kernel/debug/assert.h"
 #include "kernel/interrupt/intr.h"
+#include "kernel/stl/algorithm.h"
 #include "kernel/stl/array.h"
-#include "kernel/stl/mutex.h"
-#include "kernel/thread/thd.h"
+#include "kernel/thread/sync.h"
 
 /**
  * @brief The block queue based on a circular buffer.
@@ -22,6 +22,9 @@
  * When the queue is empty, `head == tail`.
  * When the queue is full, `head + 1 == tail`.
  *
+ * Multiple producers and consumers can wait in the queue at the same time.
+ * After the queue is closed, no thread waits in it any more.
+ *
  * @warning
  * This queue only works on a single-core processor.
  */
@@ -38,6 +41,41 @@ public:
 
     BlockQueue(const BlockQueue&) = delete;
 
+    //! Initialize an empty queue. It is used when the queue is in allocated memory.
+    BlockQueue& Init() noexcept {
+        not_full_.Init();
+        not_empty_.Init();
+        head_ = 0;
+        tail_ = 0;
+        closed_ = false;
+        return *this;
+    }
+
+    /**
+     * @brief Close the queue and wake up all waiting threads.
+     *
+     * @details
+     * Producers stop pushing objects, and consumers pop remaining objects without waiting.
+     * Only batched operations check whether the queue is closed.
+     */
+    BlockQueue& Close() noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        closed_ = true;
+        not_full_.WakeAll();
+        not_empty_.WakeAll();
+        return *this;
+    }
+
+    bool IsClosed() const noexcept {
+        return closed_;
+    }
+
+    //! Get the number of objects in the queue.
+    stl::size_t GetSize() const noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        return head_ >= tail_ ? head_ - tail_ : n + 1 - tail_ + head_;
+    }
+
     bool IsFull() const noexcept {
         dbg::Assert(!intr::IsIntrEnabled());
         return GetNextPos(head_) == tail_;
@@ -53,86 +91,193 @@ public:
      *
      * @details
      * If the queue is full, the current thread will be blocked.
-     * When another consumer thread pops elements, the blocked thread will be resumed.
+     * When another consumer thread pops elements, a blocked producer will be resumed.
      */
     BlockQueue& Push(T val) noexcept {
         dbg::Assert(!intr::IsIntrEnabled());
         while (IsFull()) {
-            // Only one thread can change the waiting producer at a time.
-            const stl::lock_guard guard {mtx_};
             // The queue is full. The current thread is waiting as a producer.
-            Wait(prod_);
+            // When it is woken up, another producer may have filled the queue again, so we check it again.
+            not_full_.Wait();
         }
 
         buf_[head_] = stl::move(val);
         head_ = GetNextPos(head_);
-        if (consr_) {
-            // Wake up a consumer if it is waiting.
-            WakeUp(consr_);
-        }
-
+        // Wake up a consumer if it is waiting.
+        not_empty_.WakeOne();
         return *this;
     }
 
     /**
-     * @brief Push an object into the queue.
+     * @brief Pop an object from the queue.
      *
      * @details
      * If the queue is empty, the current thread will be blocked.
-     * When another producer thread pushes elements, the blocked thread will be resumed.
+     * When another producer thread pushes elements, a blocked consumer will be resumed.
      */
     T Pop() noexcept {
         dbg::Assert(!intr::IsIntrEnabled());
         while (IsEmpty()) {
-            // Only one thread can change the waiting consumer at a time.
-            const stl::lock_guard guard {mtx_};
             // The queue is empty. The current thread is waiting as a consumer.
-            Wait(consr_);
+            not_empty_.Wait();
         }
 
-        const auto val {stl::move(buf_[tail_])};
+        auto val {stl::move(buf_[tail_])};
         tail_ = GetNextPos(tail_);
-        if (prod_) {
-            // Wake up a producer if it is waiting.
-            WakeUp(prod_);
+        // Wake up a producer if it is waiting.
+        not_full_.WakeOne();
+        return val;
+    }
+
+    /**
+     * @brief Push multiple objects into the queue.
+     *
+     * @details
+     * Objects are copied in contiguous runs of the circular buffer.
+     * Waiting consumers are woken up once when the batch is finished or the queue becomes full,
+     * instead of once for each object.
+     *
+     * @return The number of pushed objects, which is less than @p count if the queue is closed.
+     */
+    stl::size_t PushN(const T* const vals, const stl::size_t count) noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        dbg::Assert(vals || count == 0);
+        stl::size_t pushed {0};
+        bool pending {false};
+        while (pushed != count && !closed_) {
+            if (IsFull()) {
+                if (pending) {
+                    // Consumers must be woken up before waiting, otherwise they may never free any slot.
+                    not_empty_.WakeAll();
+                    pending = false;
+                }
+
+                not_full_.Wait();
+                continue;
+            }
+
+            const auto run {stl::min(GetFreeRunLen(), count - pushed)};
+            for (stl::size_t i {0}; i != run; ++i) {
+                buf_[head_ + i] = vals[pushed + i];
+            }
+
+            head_ = (head_ + run) % (n + 1);
+            pushed += run;
+            pending = true;
         }
 
-        return val;
+        if (pending) {
+            not_empty_.WakeAll();
+        }
+
+        return pushed;
     }
 
-private:
     /**
-     * @brief Block the current thread.
+     * @brief Pop multiple objects from the queue.
      *
-     * @param[out] waiter
-     * The input parameter should be @p nullptr.
-     * The output is a pointer to the current thread.
+     * @details
+     * Objects are copied in contiguous runs of the circular buffer.
+     * Waiting producers are woken up once when the batch is finished or the queue becomes empty,
+     * instead of once for each object.
+     *
+     * @return The number of popped objects, which is less than @p count if the queue is closed.
      */
-    static void Wait(tsk::Thread*& waiter) noexcept {
-        dbg::Assert(!waiter);
-        waiter = &tsk::Thread::GetCurrent();
-        waiter->Block(tsk::Thread::Status::Blocked);
+    stl::size_t PopN(T* const vals, const stl::size_t count) noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        dbg::Assert(vals || count == 0);
+        stl::size_t popped {0};
+        bool pending {false};
+        while (popped != count) {
+            if (IsEmpty()) {
+                if (closed_) {
+                    break;
+                }
+
+                if (pending) {
+                    // Producers must be woken up before waiting, otherwise they may never push any object.
+                    not_full_.WakeAll();
+                    pending = false;
+                }
+
+                not_empty_.Wait();
+                continue;
+            }
+
+            const auto run {stl::min(GetUsedRunLen(), count - popped)};
+            for (stl::size_t i {0}; i != run; ++i) {
+                vals[popped + i] = stl::move(buf_[tail_ + i]);
+            }
+
+            tail_ = (tail_ + run) % (n + 1);
+            popped += run;
+            pending = true;
+        }
+
+        if (pending) {
+            not_full_.WakeAll();
+        }
+
+        return popped;
     }
 
     /**
-     * @brief Wake up a thread.
+     * @brief Pop at most a number of objects.
      *
-     * @param waiter
-     * A blocked thread.
-     * The parameter will be set to @p nullptr after waking it up.
+     * @details
+     * It only waits when the queue is empty, and then pops all available objects up to @p count,
+     * so consumers do not wait for a full batch.
+     *
+     * @param wait Whether to wait when the queue is empty.
+     * @return The number of popped objects, which is zero if the queue is empty and closed.
      */
-    static void WakeUp(tsk::Thread*& waiter) noexcept {
-        dbg::Assert(waiter);
-        tsk::Thread::Unblock(*waiter);
-        waiter = nullptr;
+    stl::size_t PopSome(T* const vals, const stl::size_t count, const bool wait = true) noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        dbg::Assert(vals || count == 0);
+        while (wait && IsEmpty() && !closed_ && count != 0) {
+            not_empty_.Wait();
+        }
+
+        stl::size_t popped {0};
+        while (popped != count && !IsEmpty()) {
+            const auto run {stl::min(GetUsedRunLen(), count - popped)};
+            for (stl::size_t i {0}; i != run; ++i) {
+                vals[popped + i] = stl::move(buf_[tail_ + i]);
+            }
+
+            tail_ = (tail_ + run) % (n + 1);
+            popped += run;
+        }
+
+        if (popped != 0) {
+            not_full_.WakeAll();
+        }
+
+        return popped;
+    }
+
+private:
+    //! Get the number of free slots from the head to the end of the buffer or the slot before the tail.
+    stl::size_t GetFreeRunLen() const noexcept {
+        if (head_ < tail_) {
+            return tail_ - head_ - 1;
+        } else {
+            // The last slot cannot be used if the tail is at the beginning.
+            return n + 1 - head_ - (tail_ == 0 ? 1 : 0);
+        }
+    }
+
+    //! Get the number of objects from the tail to the end of the buffer or the head.
+    stl::size_t GetUsedRunLen() const noexcept {
+        return head_ >= tail_ ? head_ - tail_ : n + 1 - tail_;
     }
 
-    mutable stl::mutex mtx_;
-    //! A waiting producer thread.
-    tsk::Thread* prod_ {nullptr};
-    //! A waiting consumer thread.
-    tsk::Thread* consr_ {nullptr};
-    stl::array<stl::byte, n + 1> buf_;
+    //! The producers waiting for free slots.
+    sync::WaitQueue not_full_;
+    //! The consumers waiting for elements.
+    sync::WaitQueue not_empty_;
+    stl::array<T, n + 1> buf_;
     stl::size_t head_ {0};
     stl::size_t tail_ {0};
+    bool closed_ {false};
 };
\ No newline at end of file
@@ -9,14 +9,103 @@
 #pragma once
 
 #include "kernel/debug/assert.h"
+#include "kernel/stl/array.h"
 #include "kernel/stl/string_view.h"
+#include "kernel/stl/type_traits.h"
 
-//! Convert an unsigned integer to a string and write it to a buffer.
+/**
+ * @brief Convert an unsigned integer to a string and write it to a buffer.
+ *
+ * @details
+ * Decimal and hexadecimal strings have faster paths.
+ * A null character is written after digits.
+ *
+ * @return The number of digits.
+ */
 stl::size_t ConvertUIntToString(char* buf, stl::uint32_t num, stl::size_t base = 10) noexcept;
 
+/**
+ * @brief Convert an unsigned integer to a hexadecimal string by shifts and masks.
+ *
+ * @details
+ * A null character is written after digits.
+ *
+ * @param min_len The minimum number of digits. Leading zeros are added if needed.
+ * @return The number of digits.
+ */
+stl::size_t ConvertUIntToHexString(char* buf, stl::uint32_t num, stl::size_t min_len = 1) noexcept;
+
 //! Convert an integer to a string and write it to a buffer.
 stl::size_t ConvertIntToString(char* buf, stl::int32_t num, stl::size_t base = 10) noexcept;
 
+namespace _format_string_impl {
+
+/**
+ * @brief Report an invalid format string.
+ *
+ * @details
+ * It is not a constant expression, so calling it while constructing a @p FormatString fails the compilation.
+ */
+void ReportInvalidFormat() noexcept;
+
+}  // namespace _format_string_impl
+
+/**
+ * @brief A format string parsed at compile time.
+ *
+ * @details
+ * Placeholders @p {} are located when the string is constructed from a literal,
+ * so formatting copies literal pieces between them without scanning the string again.
+ * The number of placeholders must be equal to the number of arguments, or the compilation fails.
+ *
+ * @code {.cpp}
+ * template <typename... Args>
+ * void Format(FormatString<stl::type_identity_t<Args>...> format, Args... args) noexcept;
+ * @endcode
+ *
+ * @tparam Args The types of arguments.
+ */
+template <typename... Args>
+class FormatString {
+public:
+    static constexpr stl::size_t arg_count {sizeof...(Args)};
+
+    consteval FormatString(const char* const str) noexcept : str_ {str} {
+        stl::size_t count {0};
+        for (stl::size_t i {0}; i < str_.size(); ++i) {
+            if (str_[i] == '{' && i + 1 != str_.size() && str_[i + 1] == '}') {
+                if (count == arg_count) {
+                    _format_string_impl::ReportInvalidFormat();
+                }
+
+                ends_[count++] = i++;
+            }
+        }
+
+        if (count != arg_count) {
+            _format_string_impl::ReportInvalidFormat();
+        }
+
+        ends_[arg_count] = str_.size();
+    }
+
+    //! Get the literal piece before the placeholder @p i, or after the last placeholder if @p i is @p arg_count.
+    constexpr stl::string_view GetPiece(const stl::size_t i) const noexcept {
+        const auto begin {i == 0 ? 0 : ends_[i - 1] + 2};
+        return {str_.data() + begin, ends_[i] - begin};
+    }
+
+    constexpr stl::string_view GetStr() const noexcept {
+        return str_;
+    }
+
+private:
+    stl::string_view str_;
+
+    //! The end of each literal piece, which is the position of a placeholder or the end of the string.
+    stl::array<stl::size_t, arg_count + 1> ends_ {};
+};
+
 namespace _format_string_buffer_impl {
 
 stl::size_t Format(char* buf, stl::uint32_t) noexcept;
@@ -0,0 +1,153 @@
+/**
+ * @file mpsc_queue.h
+ * @brief The lock-free multi-producer single-consumer queue.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstddef.h"
+#include "kernel/thread/sync.h"
+
+/**
+ * @brief The lock-free multi-producer single-consumer queue based on a circular buffer.
+ *
+ * @details
+ * Each slot has a sequence number telling whether it is free for the producer of a position,
+ * or holds an object for the consumer of a position.
+ * - A producer claims a position by a compare-and-swap on the head, then writes its object and publishes the slot.
+ *   An interrupt handler can push while a thread it has interrupted is pushing,
+ *   since they claim different positions.
+ * - The producer never blocks. Pushing into a full queue fails.
+ * - The consumer can block until objects are pushed.
+ *   If a producer has claimed a slot but not published it yet, the consumer waits for it.
+ *
+ * @code
+ *                   tail                          head
+ *                    ▼                             ▼
+ *  ┌──────┬──────┬───────┬───────┬─────────┬──────┬──────┐
+ *  │ Free │ Free │ Ready │ Ready │ Claimed │ Free │ Free │
+ *  └──────┴──────┴───────┴───────┴─────────┴──────┴──────┘
+ * @endcode
+ *
+ * @warning
+ * Only one consumer can use the queue at the same time.
+ *
+ * @tparam n The capacity. It must be a power of two, so positions can wrap around.
+ */
+template <typename T, stl::size_t n>
+class MpscQueue {
+    static_assert(n > 0 && (n & (n - 1)) == 0);
+
+public:
+    MpscQueue() noexcept {
+        for (stl::size_t i {0}; i != n; ++i) {
+            slots_[i].seq = i;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+
+    bool IsEmpty() const noexcept {
+        const auto tail {__atomic_load_n(&tail_, __ATOMIC_RELAXED)};
+        return __atomic_load_n(&slots_[tail % n].seq, __ATOMIC_ACQUIRE) != tail + 1;
+    }
+
+    /**
+     * @brief Push an object into the queue without blocking.
+     *
+     * @details
+     * It can be called by multiple threads and interrupt handlers.
+     *
+     * @return Whether the object is pushed. It returns @p false if the queue is full.
+     */
+    bool TryPush(const T& val) noexcept {
+        auto pos {__atomic_load_n(&head_, __ATOMIC_RELAXED)};
+        while (true) {
+            const auto seq {__atomic_load_n(&slots_[pos % n].seq, __ATOMIC_ACQUIRE)};
+            if (const auto diff {static_cast<stl::ptrdiff_t>(seq - pos)}; diff == 0) {
+                // The slot is free. Claim it, or retry with the new head if another producer has.
+                if (__atomic_compare_exchange_n(&head_, &pos, pos + 1, false, __ATOMIC_RELAXED,
+                                                __ATOMIC_RELAXED)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The slot still holds an object from the previous round.
+                return false;
+            } else {
+                pos = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+            }
+        }
+
+        auto& slot {slots_[pos % n]};
+        slot.val = val;
+        // Publish the object after writing it.
+        __atomic_store_n(&slot.seq, pos + 1, __ATOMIC_RELEASE);
+        consr_.WakeOne();
+        return true;
+    }
+
+    /**
+     * @brief Pop an object from the queue without blocking.
+     *
+     * @details
+     * It is only called by the consumer.
+     *
+     * @return Whether an object is popped. It returns @p false if the queue is empty.
+     */
+    bool TryPop(T& val) noexcept {
+        const auto tail {__atomic_load_n(&tail_, __ATOMIC_RELAXED)};
+        auto& slot {slots_[tail % n]};
+        if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) != tail + 1) {
+            return false;
+        }
+
+        val = slot.val;
+        // Free the slot for the producer of the next round.
+        __atomic_store_n(&slot.seq, tail + n, __ATOMIC_RELEASE);
+        __atomic_store_n(&tail_, tail + 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    /**
+     * @brief Pop an object from the queue.
+     *
+     * @details
+     * If the queue is empty, the consumer will be blocked until a producer pushes an object.
+     */
+    T Pop() noexcept {
+        T val;
+        while (!TryPop(val)) {
+            WaitForObjs();
+        }
+
+        return val;
+    }
+
+private:
+    struct Slot {
+        stl::size_t seq;
+        T val;
+    };
+
+    //! Block the consumer until the queue is not empty.
+    void WaitForObjs() noexcept {
+        // Disabling interrupts ensures that a producer cannot publish an object
+        // between checking the queue and blocking the consumer.
+        const intr::IntrGuard guard;
+        if (IsEmpty()) {
+            consr_.Wait();
+        }
+    }
+
+    //! The waiting consumer.
+    sync::WaitQueue consr_;
+    stl::array<Slot, n> slots_;
+    stl::size_t head_ {0};
+    stl::size_t tail_ {0};
+};
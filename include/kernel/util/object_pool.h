@@ -0,0 +1,125 @@
+/**
+ * @file object_pool.h
+ * @brief The lock-free fixed-capacity object pool.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/debug/assert.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstddef.h"
+#include "kernel/stl/cstdint.h"
+
+/**
+ * @brief The lock-free object pool with a fixed capacity.
+ *
+ * @details
+ * Objects are stored in the pool itself, so a pool in a static variable or a page can be used before the heap is initialized.
+ * Free objects are linked by indices in a stack.
+ * The top index is paired with a version in one double word, which is increased by each change,
+ * so a compare-and-swap fails if other threads or interrupt handlers have popped and pushed the same top in the meantime.
+ * Allocation and release take constant time and never block, so they can be called by interrupt handlers.
+ *
+ * @code
+ *     Head
+ *  ┌─────────┐
+ *  │ Version │
+ *  ├─────────┤     ┌───────┐     ┌───────┐
+ *  │  Index  │ ──► │ Index │ ──► │ Index │ ──► None
+ *  └─────────┘     └───────┘     └───────┘
+ * @endcode
+ *
+ * @warning
+ * Like @p mem::SlabCache, the pool returns memory for objects without constructing them.
+ *
+ * @tparam n The capacity. It must be less than @p 0xFFFF, so an index fits in a word.
+ */
+template <typename T, stl::size_t n>
+class ObjectPool {
+    static_assert(n > 0 && n < 0xFFFF);
+
+public:
+    static constexpr stl::size_t capacity {n};
+
+    ObjectPool() noexcept {
+        for (stl::size_t i {0}; i != n - 1; ++i) {
+            next_[i] = static_cast<stl::uint16_t>(i + 1);
+        }
+
+        next_[n - 1] = none;
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+
+    //! Allocate an object, or return @p nullptr if the pool is exhausted.
+    T* Allocate() noexcept {
+        auto head {__atomic_load_n(&head_, __ATOMIC_ACQUIRE)};
+        stl::uint16_t idx {none};
+        do {
+            idx = GetIdx(head);
+            if (idx == none) {
+                return nullptr;
+            }
+
+            // If the object has been allocated by others, the index read here is stale but the version has changed.
+        } while (!__atomic_compare_exchange_n(
+            &head_, &head, MakeHead(__atomic_load_n(&next_[idx], __ATOMIC_RELAXED), head), false,
+            __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+        __atomic_sub_fetch(&free_count_, 1, __ATOMIC_RELAXED);
+        return reinterpret_cast<T*>(storage_ + idx * sizeof(T));
+    }
+
+    //! Free an object allocated from the pool.
+    ObjectPool& Free(T* const obj) noexcept {
+        dbg::Assert(Contains(obj));
+        const auto idx {static_cast<stl::uint16_t>(
+            (reinterpret_cast<const stl::byte*>(obj) - storage_) / sizeof(T))};
+        auto head {__atomic_load_n(&head_, __ATOMIC_RELAXED)};
+        do {
+            __atomic_store_n(&next_[idx], GetIdx(head), __ATOMIC_RELAXED);
+        } while (!__atomic_compare_exchange_n(&head_, &head, MakeHead(idx, head), false,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+        __atomic_add_fetch(&free_count_, 1, __ATOMIC_RELAXED);
+        return *this;
+    }
+
+    //! Whether an object belongs to the pool.
+    bool Contains(const T* const obj) const noexcept {
+        const auto addr {reinterpret_cast<const stl::byte*>(obj)};
+        return addr >= storage_ && addr < storage_ + sizeof(storage_)
+               && (addr - storage_) % sizeof(T) == 0;
+    }
+
+    stl::size_t GetFreeCount() const noexcept {
+        return __atomic_load_n(&free_count_, __ATOMIC_RELAXED);
+    }
+
+private:
+    //! The index representing the end of the stack.
+    static constexpr stl::uint16_t none {0xFFFF};
+
+    static constexpr stl::uint16_t GetIdx(const stl::uint32_t head) noexcept {
+        return static_cast<stl::uint16_t>(head);
+    }
+
+    //! Make a new head with an index and the increased version of an old head.
+    static constexpr stl::uint32_t MakeHead(const stl::uint16_t idx,
+                                            const stl::uint32_t old_head) noexcept {
+        return ((old_head >> 16) + 1) << 16 | idx;
+    }
+
+    alignas(T) stl::byte storage_[n * sizeof(T)];
+
+    //! The index of the next free object for each object.
+    stl::array<stl::uint16_t, n> next_;
+
+    //! The version in the high word and the index of the first free object in the low word.
+    stl::uint32_t head_ {0};
+
+    stl::size_t free_count_ {n};
+};
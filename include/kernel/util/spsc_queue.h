@@ -0,0 +1,210 @@
+/**
+ * @file spsc_queue.h
+ * @brief The lock-free single-producer single-consumer queue.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/array.h"
+#include "kernel/thread/sync.h"
+
+/**
+ * @brief The lock-free single-producer single-consumer queue based on a circular buffer.
+ *
+ * @details
+ * It is designed for handing data from an interrupt handler to a thread.
+ * The head is only written by the producer and the tail is only written by the consumer,
+ * so neither side needs a lock or disables interrupts to access the buffer.
+ *
+ * - The producer never blocks. Pushing into a full queue fails.
+ * - The consumer can block until objects are pushed.
+ *   Only waiting and waking up the consumer disable interrupts.
+ *
+ * @warning
+ * Only one producer and one consumer can use the queue at the same time.
+ */
+template <typename T, stl::size_t n>
+class SpscQueue {
+    static_assert(n > 0);
+
+public:
+    static constexpr stl::size_t GetNextPos(const stl::size_t pos) noexcept {
+        return (pos + 1) % (n + 1);
+    }
+
+    SpscQueue() noexcept = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+
+    bool IsFull() const noexcept {
+        return GetNextPos(__atomic_load_n(&head_, __ATOMIC_ACQUIRE))
+               == __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+    }
+
+    bool IsEmpty() const noexcept {
+        return __atomic_load_n(&head_, __ATOMIC_ACQUIRE)
+               == __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+    }
+
+    /**
+     * @brief Push an object into the queue without blocking.
+     *
+     * @details
+     * It is only called by the producer, for example, an interrupt handler.
+     *
+     * @return Whether the object is pushed. It returns @p false if the queue is full.
+     */
+    bool TryPush(T val) noexcept {
+        const auto head {__atomic_load_n(&head_, __ATOMIC_RELAXED)};
+        const auto next {GetNextPos(head)};
+        if (next == __atomic_load_n(&tail_, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+
+        buf_[head] = stl::move(val);
+        // Publish the object after writing it.
+        __atomic_store_n(&head_, next, __ATOMIC_RELEASE);
+        consr_.WakeOne();
+        return true;
+    }
+
+    /**
+     * @brief Push multiple objects into the queue without blocking.
+     *
+     * @details
+     * The head is moved once, so the consumer sees all the objects or none of them.
+     * It is only called by the producer.
+     *
+     * @return Whether the objects are pushed. It returns @p false and pushes nothing if there is not enough space.
+     */
+    bool TryPushN(const T* const vals, const stl::size_t count) noexcept {
+        dbg::Assert(vals || count == 0);
+        const auto head {__atomic_load_n(&head_, __ATOMIC_RELAXED)};
+        const auto tail {__atomic_load_n(&tail_, __ATOMIC_ACQUIRE)};
+        const auto used {(head + n + 1 - tail) % (n + 1)};
+        if (n - used < count) {
+            return false;
+        } else if (count == 0) {
+            return true;
+        }
+
+        for (stl::size_t i {0}; i != count; ++i) {
+            buf_[(head + i) % (n + 1)] = vals[i];
+        }
+
+        // Publish the objects after writing them.
+        __atomic_store_n(&head_, (head + count) % (n + 1), __ATOMIC_RELEASE);
+        consr_.WakeOne();
+        return true;
+    }
+
+    /**
+     * @brief Pop an object from the queue without blocking.
+     *
+     * @details
+     * It is only called by the consumer.
+     *
+     * @return Whether an object is popped. It returns @p false if the queue is empty.
+     */
+    bool TryPop(T& val) noexcept {
+        const auto tail {__atomic_load_n(&tail_, __ATOMIC_RELAXED)};
+        if (tail == __atomic_load_n(&head_, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+
+        val = stl::move(buf_[tail]);
+        // Release the slot after reading it.
+        __atomic_store_n(&tail_, GetNextPos(tail), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * @brief Pop an object from the queue.
+     *
+     * @details
+     * If the queue is empty, the consumer will be blocked until the producer pushes an object.
+     */
+    T Pop() noexcept {
+        T val;
+        while (!TryPop(val)) {
+            WaitForObjs();
+        }
+
+        return val;
+    }
+
+    /**
+     * @brief Pop multiple objects from the queue without blocking.
+     *
+     * @details
+     * Objects are copied in contiguous runs of the circular buffer.
+     * It is only called by the consumer.
+     *
+     * @return The number of popped objects, which is less than @p count if the queue becomes empty.
+     */
+    stl::size_t TryPopN(T* const vals, const stl::size_t count) noexcept {
+        dbg::Assert(vals || count == 0);
+        stl::size_t popped {0};
+        while (popped != count) {
+            const auto tail {__atomic_load_n(&tail_, __ATOMIC_RELAXED)};
+            const auto head {__atomic_load_n(&head_, __ATOMIC_ACQUIRE)};
+            if (tail == head) {
+                break;
+            }
+
+            // Copy objects from the tail to the end of the buffer or the head.
+            const auto run {stl::min(head > tail ? head - tail : n + 1 - tail, count - popped)};
+            for (stl::size_t i {0}; i != run; ++i) {
+                vals[popped + i] = stl::move(buf_[tail + i]);
+            }
+
+            __atomic_store_n(&tail_, (tail + run) % (n + 1), __ATOMIC_RELEASE);
+            popped += run;
+        }
+
+        return popped;
+    }
+
+    /**
+     * @brief Pop multiple objects from the queue.
+     *
+     * @details
+     * If the queue is empty, the consumer will be blocked until the producer pushes more objects.
+     */
+    SpscQueue& PopN(T* const vals, const stl::size_t count) noexcept {
+        dbg::Assert(vals || count == 0);
+        stl::size_t popped {0};
+        while (popped != count) {
+            if (const auto size {TryPopN(vals + popped, count - popped)}; size != 0) {
+                popped += size;
+            } else {
+                WaitForObjs();
+            }
+        }
+
+        return *this;
+    }
+
+private:
+    //! Block the consumer until the queue is not empty.
+    void WaitForObjs() noexcept {
+        // Disabling interrupts ensures that the producer cannot push an object
+        // between checking the queue and blocking the consumer.
+        const intr::IntrGuard guard;
+        if (IsEmpty()) {
+            consr_.Wait();
+        }
+    }
+
+    //! The waiting consumer.
+    sync::WaitQueue consr_;
+    stl::array<T, n + 1> buf_;
+    stl::size_t head_ {0};
+    stl::size_t tail_ {0};
+};
@@ -0,0 +1,98 @@
+/**
+ * @file tag_hash_table.h
+ * @brief The tag hash table.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/array.h"
+#include "kernel/util/tag_list.h"
+
+/**
+ * @brief
+ * The intrusive hash table of tags.
+ *
+ * @details
+ * Each bucket is a tag list. Objects are distributed to buckets by the hashes of their keys,
+ * so finding an object only visits the objects with the same bucket instead of all objects.
+ * Users compute hashes themselves and compare keys in visitors.
+ * A tag can be removed from the table by @p TagList::Tag::Detach.
+ *
+ * @code
+ *  Buckets
+ *  ┌─────┐      ┌────────┐      ┌────────┐
+ *  │  0  │ ───► │ Object │ ───► │ Object │
+ *  ├─────┤      └────────┘      └────────┘
+ *  │  1  │
+ *  ├─────┤      ┌────────┐
+ *  │  2  │ ───► │ Object │
+ *  ├─────┤      └────────┘
+ *  │ ... │
+ *  └─────┘
+ * @endcode
+ *
+ * @tparam bucket_count The number of buckets.
+ */
+template <stl::size_t bucket_count>
+class TagHashTable {
+    static_assert(bucket_count > 0);
+
+public:
+    TagHashTable() noexcept = default;
+
+    TagHashTable(const TagHashTable&) = delete;
+
+    //! Add a tag with a hash.
+    TagHashTable& Insert(const stl::size_t hash, TagList::Tag& tag) noexcept {
+        GetBucket(hash).PushBack(tag);
+        return *this;
+    }
+
+    /**
+     * @brief Find a tag with a hash.
+     *
+     * @param hash The hash of a key.
+     * @param visitor A visitor comparing keys. It returns @p true when the tag is found.
+     * @param arg An argument passed to the visitor.
+     * @return The found tag, or @p nullptr if it is not found.
+     */
+    TagList::Tag* Find(const stl::size_t hash, const TagList::Visitor visitor,
+                       void* const arg = nullptr) const noexcept {
+        return GetBucket(hash).Find(visitor, arg);
+    }
+
+    //! Find a tag by visiting all buckets.
+    TagList::Tag* Find(const TagList::Visitor visitor, void* const arg = nullptr) const noexcept {
+        for (const auto& bucket : buckets_) {
+            if (const auto found {bucket.Find(visitor, arg)}; found) {
+                return found;
+            }
+        }
+
+        return nullptr;
+    }
+
+    //! Get the number of tags.
+    stl::size_t GetSize() const noexcept {
+        stl::size_t size {0};
+        for (const auto& bucket : buckets_) {
+            size += bucket.GetSize();
+        }
+
+        return size;
+    }
+
+private:
+    TagList& GetBucket(const stl::size_t hash) noexcept {
+        return buckets_[hash % bucket_count];
+    }
+
+    const TagList& GetBucket(const stl::size_t hash) const noexcept {
+        return buckets_[hash % bucket_count];
+    }
+
+    stl::array<TagList, bucket_count> buckets_;
+};
@@ -0,0 +1,120 @@
+/**
+ * @file tag_tree.h
+ * @brief The tag tree.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "kernel/stl/cstdint.h"
+
+/**
+ * @brief
+ * The intrusive red-black tree of tags.
+ *
+ * @details
+ * It orders a number of tags. Each tag is a member of an object, so inserting and erasing never allocate memory.
+ * Finding, inserting and erasing an object take logarithmic time instead of visiting all objects.
+ * Users compare objects and keys themselves in callbacks.
+ *
+ * @code
+ *                  Object
+ *                 ┌───────┐
+ *                 │ ┌───┐ │
+ *                 │ │Tag│ │
+ *                 │ └───┘ │
+ *                 └───────┘
+ *                 ▲       ▲
+ *          Object │       │ Object
+ *         ┌───────┐       ┌───────┐
+ *         │ ┌───┐ │       │ ┌───┐ │
+ *         │ │Tag│ │       │ │Tag│ │
+ *         │ └───┘ │       │ └───┘ │
+ *         └───────┘       └───────┘
+ * @endcode
+ *
+ * @warning
+ * It is not thread-safe. Users should protect the tree with a lock or by disabling interrupts.
+ */
+class TagTree {
+public:
+    struct Tag {
+        Tag() noexcept = default;
+
+        Tag(const Tag&) = delete;
+
+        /**
+         * @brief Get the object containing the tag.
+         *
+         * @tparam T The object type.
+         * @tparam offset The tag offset from the beginning of the object.
+         */
+        template <typename T, stl::size_t offset = 0>
+        T& GetElem() const noexcept {
+            return const_cast<T&>(
+                *reinterpret_cast<const T*>(reinterpret_cast<const stl::byte*>(this) - offset));
+        }
+
+        Tag* parent {nullptr};
+        Tag* left {nullptr};
+        Tag* right {nullptr};
+        bool red {false};
+    };
+
+    //! Whether the object of the first tag is ordered before the object of the second tag.
+    using Less = bool (*)(const Tag&, const Tag&) noexcept;
+
+    /**
+     * @brief Compare the object of a tag with a key.
+     *
+     * @return
+     * A negative value if the object is ordered before the key,
+     * zero if they are equal, or a positive value otherwise.
+     */
+    using KeyCompare = stl::int32_t (*)(const Tag&, const void* key) noexcept;
+
+    TagTree() noexcept = default;
+
+    TagTree(const TagTree&) = delete;
+
+    //! Insert a tag. A tag equal to existing tags is ordered after them.
+    TagTree& Insert(Tag&, Less) noexcept;
+
+    //! Erase a tag in the tree.
+    TagTree& Erase(Tag&) noexcept;
+
+    //! Find a tag equal to a key, or return @p nullptr if it is not found.
+    Tag* Find(const void* key, KeyCompare) const noexcept;
+
+    //! Find the first tag not ordered before a key, or return @p nullptr if there is no such tag.
+    Tag* LowerBound(const void* key, KeyCompare) const noexcept;
+
+    //! Get the first tag in order, or @p nullptr if the tree is empty.
+    Tag* GetFirst() const noexcept;
+
+    //! Get the next tag in order, or @p nullptr if the tag is the last one.
+    static Tag* GetNext(const Tag&) noexcept;
+
+    stl::size_t GetSize() const noexcept;
+
+    bool IsEmpty() const noexcept;
+
+private:
+    //! Replace a tag by another tag or @p nullptr in the link from its parent.
+    void Replace(const Tag& old_tag, Tag* new_tag) noexcept;
+
+    void RotateLeft(Tag&) noexcept;
+
+    void RotateRight(Tag&) noexcept;
+
+    //! Restore the properties of red-black trees after a red tag is inserted.
+    void FixInsert(Tag*) noexcept;
+
+    //! Restore the properties of red-black trees after a black tag is erased.
+    void FixErase(Tag* tag, Tag* parent) noexcept;
+
+    Tag* root_ {nullptr};
+    stl::size_t size_ {0};
+};
@@ -0,0 +1,29 @@
+/**
+ * @file prof.h
+ * @brief The user-mode interface of the sampling profiler.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+namespace usr::dbg {
+
+/**
+ * @brief Clear samples, then enable or disable the kernel sampling profiler.
+ *
+ * @details
+ * When it is enabled, each clock interrupt records the interrupted instruction and thread.
+ */
+void ResetProfiler(bool enabled) noexcept;
+
+/**
+ * @brief Print code addresses with the most samples and the number of samples of each thread.
+ *
+ * @details
+ * Addresses can be symbolized against @p build/kernel.bin on the host.
+ */
+void DumpProfile() noexcept;
+
+}  // namespace usr::dbg
@@ -0,0 +1,23 @@
+/**
+ * @file trace.h
+ * @brief The user-mode interface of kernel tracepoints.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+namespace usr::dbg {
+
+/**
+ * @brief Clear the trace ring buffer, then enable or disable kernel tracepoints.
+ *
+ * @return Whether the trace is enabled. It fails if tracepoints are not compiled into the kernel.
+ */
+bool ResetTrace(bool enabled) noexcept;
+
+//! Disable kernel tracepoints and write trace records to the serial port.
+void DumpTrace() noexcept;
+
+}  // namespace usr::dbg
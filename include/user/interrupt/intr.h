@@ -0,0 +1,42 @@
+/**
+ * @file intr.h
+ * @brief User-mode interrupt statistics.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::intr {
+
+/**
+ * @brief Statistics of an interrupt.
+ *
+ * @details
+ * It has the same layout as the kernel's @p intr::IntrStats.
+ * Handler cycles are measured by the time-stamp counter.
+ */
+struct IntrStats {
+    stl::size_t count;
+    //! The number of times the interrupt occurred while another interrupt handler was running.
+    stl::size_t nested_count;
+    //! The number of spurious interrupts.
+    stl::size_t spurious_count;
+    stl::uint64_t total_cycles;
+    stl::uint64_t max_cycles;
+};
+
+/**
+ * @brief Get statistics of an interrupt.
+ *
+ * @return Whether the interrupt number is valid.
+ */
+bool GetIntrStats(stl::size_t intr_num, IntrStats& stats) noexcept;
+
+//! Reset statistics of all interrupts, then enable or disable recording them.
+void ResetIntrStats(bool enabled) noexcept;
+
+}  // namespace usr::intr
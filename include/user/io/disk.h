@@ -0,0 +1,50 @@
+/**
+ * @file disk.h
+ * @brief User-mode disk statistics.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::io {
+
+/**
+ * @brief I/O statistics of a disk or a partition.
+ *
+ * @details
+ * It has the same layout as the kernel's @p io::DiskStats.
+ */
+struct DiskStats {
+    //! The number of buckets in the latency histogram.
+    static constexpr stl::size_t latency_bucket_count {32};
+
+    stl::size_t read_count;
+    stl::size_t write_count;
+    stl::size_t read_sector_count;
+    stl::size_t write_sector_count;
+    stl::size_t merged_count;
+    stl::size_t cmd_count;
+    stl::size_t timeout_count;
+    stl::size_t queue_depth;
+    stl::size_t max_queue_depth;
+    stl::size_t cache_hit_count;
+    stl::size_t cache_miss_count;
+    stl::uint64_t total_cycles;
+    //! The bucket @p i counts requests taking @p [2^i, 2^(i+1)) cycles.
+    stl::size_t latencies[latency_bucket_count];
+};
+
+/**
+ * @brief Get the I/O statistics of a disk or a partition.
+ *
+ * @param name The name of a disk or a partition.
+ * @param[out] stats The statistics.
+ * @return Whether the disk or partition exists.
+ */
+bool GetDiskStats(const char* name, DiskStats& stats) noexcept;
+
+}  // namespace usr::io
@@ -8,14 +8,57 @@
 
 #pragma once
 
+#include "user/stl/cstdint.h"
+
 namespace usr::io {
 
+enum class FileType { Unknown, Regular, Directory };
+
+/**
+ * @brief A directory entry.
+ *
+ * @details
+ * It has the same layout as the kernel's @p io::fs::DirEntry.
+ */
+struct DirEntry {
+    //! The maximum length of a name.
+    static constexpr stl::size_t max_name_len {16};
+
+    FileType type;
+    char name[max_name_len + 1];
+    stl::size_t inode_idx;
+};
+
+/**
+ * @brief The position of the next directory entry to read.
+ *
+ * @details
+ * It has the same layout as the kernel's @p io::fs::Directory::Cursor.
+ * A zero-initialized cursor starts from the beginning of a directory.
+ */
+struct DirCursor {
+    stl::size_t block_idx;
+    stl::size_t slot_idx;
+};
+
 //! User-mode directory management.
 class Directory {
 public:
     Directory() = delete;
 
     static bool Create(const char*) noexcept;
+
+    /**
+     * @brief Read multiple entries in a directory in one system call.
+     *
+     * @param path The path of a directory.
+     * @param[in, out] cursor The position to read from. It is moved after the read entries.
+     * @param[out] entries A buffer for entries.
+     * @param count The maximum number of entries to read.
+     * @return The number of read entries. It is less than @p count if there are no more entries.
+     */
+    static stl::size_t ReadEntries(const char* path, DirCursor& cursor, DirEntry* entries,
+                                   stl::size_t count) noexcept;
 };
 
 }
\ No newline at end of file
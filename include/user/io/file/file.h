@@ -12,6 +12,31 @@
 
 namespace usr::io {
 
+/**
+ * @brief A buffer in vectored file operations.
+ *
+ * @details
+ * It has the same layout as the kernel's @p io::IoVec.
+ */
+struct IoVec {
+    void* base;
+    stl::size_t size;
+};
+
+/**
+ * @brief The usage of a file system.
+ *
+ * @details
+ * It has the same layout as the kernel's @p io::FileSysStats.
+ */
+struct FileSysStats {
+    stl::size_t block_size;
+    stl::size_t block_count;
+    stl::size_t free_block_count;
+    stl::size_t inode_count;
+    stl::size_t free_inode_count;
+};
+
 //! User-mode file management.
 class File {
 public:
@@ -27,11 +52,35 @@ public:
 
     static bool Delete(const char* path) noexcept;
 
+    //! Write all modified file data and metadata to the disk.
+    static void Sync() noexcept;
+
+    //! Get the usage of the file system without scanning it.
+    static void GetSysStats(FileSysStats&) noexcept;
+
     static stl::size_t Write(stl::size_t desc, const void* data, stl::size_t size) noexcept;
 
     static stl::size_t Read(stl::size_t desc, void* buf, stl::size_t size) noexcept;
 
+    /**
+     * @brief Write data from multiple buffers in one system call and one file operation.
+     *
+     * @param count The number of buffers, at most 16.
+     */
+    static stl::size_t WriteV(stl::size_t desc, const IoVec* vecs, stl::size_t count) noexcept;
+
+    //! Read data into multiple buffers in one system call and one file operation.
+    static stl::size_t ReadV(stl::size_t desc, const IoVec* vecs, stl::size_t count) noexcept;
+
     static stl::size_t Seek(stl::size_t desc, stl::int32_t offset, SeekOrigin) noexcept;
+
+    /**
+     * @brief Reserve blocks for a file to grow to a size without changing its size.
+     *
+     * @details
+     * Writing a file of a known size after reserving its blocks keeps the file contiguous on the disk.
+     */
+    static bool Reserve(stl::size_t desc, stl::size_t size) noexcept;
 };
 
 }  // namespace usr::io
\ No newline at end of file
@@ -0,0 +1,47 @@
+/**
+ * @file map.h
+ * @brief User-mode memory-mapped files.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::io {
+
+/**
+ * @brief Memory-mapped files.
+ *
+ * @details
+ * Pages of a mapping are loaded from the file on first access,
+ * so random access to a large file does not need a system call for each access.
+ * Written pages are written back by @p Sync and @p Unmap. Bytes beyond the end of the file are zeros,
+ * and writing them does not grow the file.
+ */
+class FileMap {
+public:
+    FileMap() = delete;
+
+    /**
+     * @brief Map a range of a file.
+     *
+     * @param desc A file descriptor.
+     * @param offset The offset in the file. It must be aligned to a page.
+     * @param size The size in bytes. It is rounded up to pages.
+     * @param writable Whether the pages are writable. The file must be open for writing.
+     * @return The base address, or @p nullptr if the file cannot be mapped.
+     */
+    static void* Map(stl::size_t desc, stl::size_t offset, stl::size_t size,
+                     bool writable = false) noexcept;
+
+    //! Write written pages back and unmap a mapping.
+    static bool Unmap(void* addr) noexcept;
+
+    //! Write written pages of a mapping back to the file.
+    static bool Sync(void* addr) noexcept;
+};
+
+}  // namespace usr::io
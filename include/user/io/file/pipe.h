@@ -0,0 +1,36 @@
+/**
+ * @file pipe.h
+ * @brief User-mode pipes.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::io {
+
+/**
+ * @brief A one-way byte stream between processes in kernel memory.
+ *
+ * @details
+ * Its ends are file descriptors, which are read and written by @p File::Read and @p File::Write,
+ * and closed by @p File::Close. Forked processes inherit both ends.
+ * A read returns zero after all write ends are closed and no data is left.
+ */
+class Pipe {
+public:
+    Pipe() = delete;
+
+    /**
+     * @brief Create a pipe.
+     *
+     * @param[out] read_end The descriptor of the read end.
+     * @param[out] write_end The descriptor of the write end.
+     */
+    static bool Create(stl::size_t& read_end, stl::size_t& write_end) noexcept;
+};
+
+}  // namespace usr::io
@@ -0,0 +1,110 @@
+/**
+ * @file ring.h
+ * @brief User-mode submission and completion rings for batched file operations.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::io {
+
+/**
+ * @brief Submission and completion rings shared with the kernel.
+ *
+ * @details
+ * Operations are queued in user space without system calls,
+ * and submitted together by one system call.
+ * A kernel worker thread of the process runs them while the process keeps running.
+ *
+ * @code {.cpp}
+ * IoRing::Shared shared;
+ * IoRing ring {shared};
+ * ring.Setup();
+ * ring.QueueWrite(desc, data, size, 0);
+ * ring.Submit(1);
+ * IoRing::Completion completion;
+ * ring.Pop(completion);
+ * @endcode
+ */
+class IoRing {
+public:
+    static constexpr stl::size_t entry_count {32};
+
+    enum class Op { Read, Write };
+
+    /**
+     * @brief A file operation.
+     *
+     * @details
+     * It has the same layout as the kernel's @p io::IoRing::Submission.
+     */
+    struct Submission {
+        stl::size_t op;
+        stl::size_t desc;
+        void* buf;
+        stl::size_t size;
+        stl::size_t user_data;
+    };
+
+    /**
+     * @brief The result of a file operation.
+     *
+     * @details
+     * It has the same layout as the kernel's @p io::IoRing::Completion.
+     */
+    struct Completion {
+        stl::size_t user_data;
+        stl::size_t result;
+    };
+
+    /**
+     * @brief Rings shared with the kernel.
+     *
+     * @details
+     * It has the same layout as the kernel's @p io::IoRing::Shared.
+     * It must stay valid after the rings are set up.
+     */
+    struct Shared {
+        stl::size_t submit_head;
+        stl::size_t submit_tail;
+        Submission submits[entry_count];
+        stl::size_t complete_head;
+        stl::size_t complete_tail;
+        Completion completes[entry_count];
+    };
+
+    explicit IoRing(Shared&) noexcept;
+
+    IoRing(const IoRing&) = delete;
+
+    //! Set up rings for the current process. A process can only set up rings once.
+    bool Setup() noexcept;
+
+    //! Queue an operation without a system call. It returns @p false if the submission ring is full.
+    bool Queue(Op, stl::size_t desc, void* buf, stl::size_t size, stl::size_t user_data) noexcept;
+
+    bool QueueRead(stl::size_t desc, void* buf, stl::size_t size, stl::size_t user_data) noexcept;
+
+    bool QueueWrite(stl::size_t desc, const void* data, stl::size_t size,
+                    stl::size_t user_data) noexcept;
+
+    /**
+     * @brief Submit queued operations.
+     *
+     * @param min_complete The minimum number of completions to wait for.
+     * @return The number of completions that can be popped.
+     */
+    stl::size_t Submit(stl::size_t min_complete = 0) noexcept;
+
+    //! Pop a completion without a system call. It returns @p false if there is no completion.
+    bool Pop(Completion&) noexcept;
+
+private:
+    Shared& shared_;
+};
+
+}  // namespace usr::io
@@ -0,0 +1,21 @@
+/**
+ * @file timer.h
+ * @brief The user-mode monotonic clock.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::io {
+
+//! Get the number of nanoseconds after the timer initialization.
+stl::uint64_t GetNanoseconds() noexcept;
+
+//! Get the number of ticks after system startup.
+stl::size_t GetTicks() noexcept;
+
+}  // namespace usr::io
@@ -32,6 +32,103 @@ public:
     static void PrintlnHex(stl::int32_t) noexcept;
 
     static void PrintHex(stl::int32_t) noexcept;
+
+    //! Print a number of characters by one system call.
+    static void Write(const char* buf, stl::size_t size) noexcept;
+
+    /**
+     * @brief Read keyboard input by one system call.
+     *
+     * @details
+     * It blocks until characters are available.
+     * In the canonical mode, it returns a whole line, including the line feed.
+     * In the raw mode, it returns all available characters.
+     *
+     * @return The number of characters read, which is at most @p size.
+     */
+    static stl::size_t Read(char* buf, stl::size_t size) noexcept;
+
+    /**
+     * @brief Switch keyboard input between two modes.
+     *
+     * @param canonical
+     * In the canonical mode, characters are echoed and edited in a line,
+     * and backspaces delete the last character.
+     * In the raw mode, characters are not echoed and can be read as soon as they are typed.
+     */
+    static void SetCanonical(bool canonical) noexcept;
+};
+
+/**
+ * @brief A buffered console output stream.
+ *
+ * @details
+ * Characters are formatted and saved in user space,
+ * and a whole line or a full buffer is printed by one system call @p Console::Write.
+ * The remaining characters are printed when the stream is destroyed.
+ *
+ * User library data are in the kernel image, which is shared by all processes,
+ * so a stream should be created on the stack or the heap of a process.
+ *
+ * @code {.cpp}
+ * ConsoleStream out;
+ * out.Printf("The process {} has {} pages.\n", pid, count);
+ * @endcode
+ */
+class ConsoleStream {
+public:
+    static constexpr stl::size_t buf_size {128};
+
+    ConsoleStream() noexcept = default;
+
+    ConsoleStream(const ConsoleStream&) = delete;
+
+    ConsoleStream& operator=(const ConsoleStream&) = delete;
+
+    ~ConsoleStream() noexcept;
+
+    ConsoleStream& Print(char) noexcept;
+
+    ConsoleStream& Print(const char*) noexcept;
+
+    ConsoleStream& Print(stl::uint32_t) noexcept;
+
+    ConsoleStream& Print(stl::int32_t) noexcept;
+
+    /**
+     * @brief Format variadic values and print them.
+     *
+     * @param format
+     * A format string with a number of @p {}.
+     * They will be replaced by the string representations of the arguments.
+     * The following types are supported:
+     * - `const char*`
+     * - `char`
+     * - `stl::uint32_t`
+     * - `stl::int32_t`
+     */
+    template <typename Arg, typename... Args>
+    ConsoleStream& Printf(const char* const format, const Arg arg, const Args... args) noexcept {
+        for (auto curr {format}; *curr != '\0'; ++curr) {
+            if (curr[0] == '{' && curr[1] == '}') {
+                Print(arg);
+                return Printf(curr + 2, args...);
+            } else {
+                Print(*curr);
+            }
+        }
+
+        return *this;
+    }
+
+    ConsoleStream& Printf(const char* format) noexcept;
+
+    //! Print buffered characters by one system call.
+    ConsoleStream& Flush() noexcept;
+
+private:
+    char buf_[buf_size];
+    stl::size_t size_ {0};
 };
 
 }  // namespace usr::io
\ No newline at end of file
@@ -12,10 +12,94 @@
 
 namespace usr::mem {
 
-//! Allocate virtual memory in bytes in user mode.
+//! Types of memory pools.
+enum class PoolType { Kernel, User };
+
+/**
+ * @brief Memory statistics.
+ *
+ * @details
+ * It has the same layout as the kernel's @p mem::MemStats.
+ */
+struct MemStats {
+    //! The number of buckets in the free-run histogram.
+    static constexpr stl::size_t free_run_bucket_count {11};
+
+    //! The number of memory block descriptors.
+    static constexpr stl::size_t block_desc_count {23};
+
+    //! Statistics of a memory block descriptor.
+    struct BlockStats {
+        stl::size_t block_size;
+        stl::size_t alloc_count;
+        stl::size_t free_count;
+        stl::size_t live_arena_count;
+        stl::size_t free_block_count;
+    };
+
+    stl::size_t page_count;
+    stl::size_t free_page_count;
+    stl::size_t zeroed_page_count;
+    stl::size_t alloc_count;
+    stl::size_t fail_count;
+    stl::size_t free_count;
+    stl::size_t largest_free_run;
+    //! The bucket @p i counts runs of continuous free pages whose lengths are in @p [2^i, 2^(i+1)).
+    stl::size_t free_runs[free_run_bucket_count];
+    //! For the user pool, block descriptors belong to the current process.
+    BlockStats blocks[block_desc_count];
+};
+
+/**
+ * @brief Allocate zeroed virtual memory in bytes in user mode.
+ *
+ * @details
+ * Small blocks are taken from size-class free lists in user space without system calls.
+ * Pages are requested from the kernel in chunks by @p MapMem only when free blocks run out.
+ * Sizes larger than the maximum block size are directly mapped.
+ */
 void* Allocate(stl::size_t size) noexcept;
 
-//! Free virtual memory in user mode.
+//! Free virtual memory allocated by @p Allocate in user mode.
 void Free(void* base) noexcept;
 
+//! Get memory statistics of a pool.
+void GetStats(PoolType type, MemStats& stats) noexcept;
+
+//! Flags for mapping anonymous memory.
+enum class MapFlag {
+    //! Map memory at exactly the required address.
+    Fixed = 1,
+    //! Map physical pages at once instead of on first access.
+    Populate = 2
+};
+
+/**
+ * @brief Map anonymous memory in pages.
+ *
+ * @param addr A preferred base address aligned to a page, or @p nullptr to use any address.
+ * @param size The size in bytes. It is rounded up to pages.
+ * @param flags Flags of @p MapFlag.
+ * @return The base address, or @p nullptr if the memory cannot be mapped.
+ */
+void* MapMem(void* addr, stl::size_t size, stl::uint32_t flags = 0) noexcept;
+
+//! Unmap anonymous memory mapped by @p MapMem, or a shared memory region mapped by @p MapSharedMem.
+bool UnmapMem(void* addr, stl::size_t size) noexcept;
+
+/**
+ * @brief Map a named shared memory region.
+ *
+ * @details
+ * If no region has the name, a region of zeroed pages is created.
+ *
+ * @param name The region name, up to 15 characters.
+ * @param size The size in bytes. It cannot be larger than the size of an existing region.
+ * @return The base address, or @p nullptr if the region cannot be mapped.
+ */
+void* MapSharedMem(const char* name, stl::size_t size) noexcept;
+
+//! Delete a named shared memory region. Existing mappings stay valid.
+bool DeleteSharedMem(const char* name) noexcept;
+
 }
\ No newline at end of file
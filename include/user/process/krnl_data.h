@@ -0,0 +1,57 @@
+/**
+ * @file krnl_data.h
+ * @brief The read-only kernel data page.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::tsk {
+
+/**
+ * @brief The base address of the kernel data page.
+ *
+ * @details
+ * The kernel maps the page read-only into every process.
+ * It must be the same as @p tsk::usr_krnl_data_base in @p include/kernel/process/krnl_data.h.
+ */
+inline constexpr stl::uintptr_t krnl_data_base {0x40001000};
+
+/**
+ * @brief Kernel data shared with user processes.
+ *
+ * @details
+ * It has the same layout as the kernel's @p tsk::KrnlData.
+ * The process ID and ticks change at any time, so they should be read by @p ReadKrnlData.
+ * Clock parameters are fixed after the timer initialization.
+ */
+struct KrnlData {
+    //! The ID of the running process.
+    stl::size_t pid;
+    //! The number of ticks after system startup.
+    stl::size_t ticks;
+    //! The time-stamp counter value when the timer was initialized.
+    stl::uint64_t tsc_base;
+    //! The number of nanoseconds per cycle in a fixed-point number.
+    stl::uint32_t tsc_ns_mult;
+    //! The number of fraction bits in @p tsc_ns_mult.
+    stl::uint32_t tsc_ns_shift;
+};
+
+//! Get the kernel data page.
+inline const KrnlData& GetKrnlData() noexcept {
+    return *reinterpret_cast<const KrnlData*>(krnl_data_base);
+}
+
+//! Read a field of the kernel data page, which may be changed by the kernel at any time.
+template <typename T>
+T ReadKrnlData(const T KrnlData::*const field) noexcept {
+    static_assert(sizeof(T) <= sizeof(stl::uint32_t), "Only 32-bit fields can be read atomically.");
+    return __atomic_load_n(&(GetKrnlData().*field), __ATOMIC_RELAXED);
+}
+
+}  // namespace usr::tsk
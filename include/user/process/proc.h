@@ -12,6 +12,96 @@
 
 namespace usr::tsk {
 
+/**
+ * @brief Scheduler statistics of a thread.
+ *
+ * @details
+ * It has the same layout as the kernel's @p tsk::ThreadStats.
+ * Times are in nanoseconds.
+ */
+struct ThreadStats {
+    static constexpr stl::size_t name_len {16};
+
+    char name[name_len + 1];
+    stl::size_t status;
+    stl::size_t priority;
+    stl::size_t elapsed_ticks;
+    stl::uint64_t run_time;
+    stl::uint64_t ready_time;
+    stl::uint64_t blocked_time;
+    //! The maximum time from being unblocked to running.
+    stl::uint64_t max_wake_latency;
+    //! The number of times the thread gives up the CPU by blocking or yielding.
+    stl::size_t voluntary_switch_count;
+    //! The number of times the thread is removed from the CPU when its time slices run out.
+    stl::size_t involuntary_switch_count;
+    //! The number of ticks the thread can run in the CPU at a time.
+    stl::size_t time_slice;
+    //! The mask of processors the thread can run on.
+    stl::uint32_t affinity;
+};
+
+/**
+ * @brief Get scheduler statistics of a thread.
+ *
+ * @param idx The index of a thread in the list of all threads.
+ * @return Whether the index is in range.
+ */
+bool GetThreadStats(stl::size_t idx, ThreadStats& stats) noexcept;
+
+//! User-mode thread management.
+class Thread {
+public:
+    using Callback = void (*)(void*) noexcept;
+
+    Thread() = delete;
+
+    /**
+     * @brief Create and start a thread in the current process.
+     *
+     * @details
+     * The thread shares memory and files with other threads in the process, and has its own stack.
+     * It exits when the callback returns.
+     *
+     * @param callback A callback to be executed by the thread.
+     * @param arg An argument to the callback.
+     * @return Whether the thread is started.
+     */
+    static bool Create(Callback callback, void* arg = nullptr) noexcept;
+
+    //! Exit the current thread.
+    [[noreturn]] static void Exit() noexcept;
+
+    /**
+     * @brief Set the priority of the current thread.
+     *
+     * @details
+     * A higher priority has a higher scheduling precedence and a longer default time slice.
+     *
+     * @param priority A priority between @p 1 and @p 31.
+     * @return Whether the priority is valid.
+     */
+    static bool SetPriority(stl::size_t priority) noexcept;
+
+    /**
+     * @brief Set the number of ticks the current thread can run in the CPU at a time.
+     *
+     * @param ticks The number of ticks up to @p 256, or @p 0 to use the priority.
+     * @return Whether the number is valid.
+     */
+    static bool SetTimeSlice(stl::size_t ticks) noexcept;
+
+    /**
+     * @brief Set the mask of processors the current thread can run on.
+     *
+     * @details
+     * The bit @p i refers to the processor @p i. Only the bootstrap processor currently runs threads.
+     *
+     * @return Whether the mask contains a processor running threads.
+     */
+    static bool SetAffinity(stl::uint32_t mask) noexcept;
+};
+
 //! User-mode process management.
 class Process {
 public:
@@ -20,6 +110,50 @@ public:
     static stl::size_t GetCurrPid() noexcept;
 
     static stl::size_t Fork() noexcept;
+
+    /**
+     * @brief Exit the current thread and set the exit status of the current process.
+     *
+     * @details
+     * The process exits and its resources are released after all of its threads exit.
+     */
+    [[noreturn]] static void Exit(stl::int32_t status) noexcept;
+
+    /**
+     * @brief Wait for a child process to exit.
+     *
+     * @param pid The ID of a child process.
+     * @param[out] status The exit status of the child process.
+     * @return Whether the child process has exited. It fails if the process is not a child.
+     */
+    static bool Wait(stl::size_t pid, stl::int32_t& status) noexcept;
+
+    /**
+     * @brief Replace the current process with an ELF executable file.
+     *
+     * @details
+     * Open files are kept. The process must have only one thread.
+     *
+     * @param path The absolute path of an executable file.
+     * @return It does not return on success. It returns @p false if the file cannot be run.
+     */
+    static bool Exec(const char* path) noexcept;
+
+    /**
+     * @brief Create a child process running an ELF executable file.
+     *
+     * @details
+     * It is cheaper than forking and then running another image, since no memory is copied.
+     *
+     * @param path The absolute path of an executable file.
+     * @param descs
+     * Descriptors inherited by the child process.
+     * They are numbered in order after standard streams in the child process.
+     * @param desc_count The number of inherited descriptors.
+     * @return The child process's ID, or @p -1 as an unsigned value if the process cannot be created.
+     */
+    static stl::size_t Spawn(const char* path, const stl::size_t* descs = nullptr,
+                             stl::size_t desc_count = 0) noexcept;
 };
 
 }  // namespace usr::tsk
\ No newline at end of file
@@ -32,19 +32,127 @@ enum class SysCallType {
     SeekFile,
     DeleteFile,
     CreateDir,
-    Fork
+    Fork,
+    MemStats,
+    MapMem,
+    UnmapMem,
+    MapSharedMem,
+    DeleteSharedMem,
+    GetTime,
+    ThreadStats,
+    SetupIoRing,
+    EnterIoRing,
+    WriteFileV,
+    ReadFileV,
+    SysCallStats,
+    ResetSysCallStats,
+    WriteConsole,
+    SyncFiles,
+    ReserveFile,
+    ReadDirEntries,
+    FileSysStats,
+    DiskStats,
+    CreatePipe,
+    MapFile,
+    UnmapFile,
+    SyncFileMap,
+    IntrStats,
+    ResetIntrStats,
+    ReadConsole,
+    SetConsoleMode,
+    CreateThread,
+    ExitThread,
+    ExitProcess,
+    WaitProcess,
+    Exec,
+    Spawn,
+    ResetProfiler,
+    DumpProfile,
+    ResetLockStats,
+    DumpLockStats,
+    ResetTrace,
+    DumpTrace,
+    FutexWait,
+    FutexWake,
+    SetThreadPriority,
+    SetThreadTimeSlice,
+    SetThreadAffinity
 };
 
+//! The maximum number of system call arguments, which are passed in registers.
+inline constexpr stl::size_t max_arg_count {5};
+
 extern "C" {
 
 /**
  * @brief Call a kernel method by a system call in user mode.
  *
+ * @details
+ * It uses @p sysenter if the kernel has enabled it, otherwise it uses an interrupt.
+ * Arguments are passed in registers. Unused arguments should be zero.
+ *
+ * @param func The type of a system call.
+ * @return The returned value of the kernel method.
+ */
+stl::int32_t RawSysCall(SysCallType func, stl::uintptr_t arg1, stl::uintptr_t arg2,
+                        stl::uintptr_t arg3, stl::uintptr_t arg4, stl::uintptr_t arg5) noexcept;
+}
+
+//! Convert a pointer to a system call argument.
+template <typename T>
+stl::uintptr_t ToSysCallArg(T* const arg) noexcept {
+    return reinterpret_cast<stl::uintptr_t>(arg);
+}
+
+//! Convert an integer, a Boolean or an enumeration to a system call argument.
+template <typename T>
+stl::uintptr_t ToSysCallArg(const T arg) noexcept {
+    static_assert(sizeof(T) <= sizeof(stl::uintptr_t));
+    return static_cast<stl::uintptr_t>(arg);
+}
+
+/**
+ * @brief Call a kernel method by a system call in user mode.
+ *
+ * @details
+ * Each argument is passed in a register, so the kernel method has the same parameters.
+ *
  * @param func The type of a system call.
- * @param arg A user-defined argument.
+ * @param args Up to five pointers, integers, Boolean values or enumerations.
  * @return The returned value of the kernel method.
  */
-stl::int32_t SysCall(SysCallType func, void* arg = nullptr) noexcept;
+template <typename... Args>
+stl::int32_t SysCall(const SysCallType func, const Args... args) noexcept {
+    static_assert(sizeof...(Args) <= max_arg_count);
+    const stl::uintptr_t regs[max_arg_count] {ToSysCallArg(args)...};
+    return RawSysCall(func, regs[0], regs[1], regs[2], regs[3], regs[4]);
 }
 
-}  // namespace usr::sc
\ No newline at end of file
+/**
+ * @brief Statistics of a system call type.
+ *
+ * @details
+ * It has the same layout as the kernel's @p sc::SysCallStats.
+ * Latencies are measured in cycles.
+ */
+struct SysCallStats {
+    //! The number of buckets in the latency histogram.
+    static constexpr stl::size_t latency_bucket_count {32};
+
+    stl::size_t call_count;
+    stl::uint64_t total_cycles;
+    //! The bucket @p i counts calls taking @p [2^i, 2^(i+1)) cycles.
+    stl::size_t latencies[latency_bucket_count];
+};
+
+/**
+ * @brief Get statistics of a system call type.
+ *
+ * @return Whether the type is valid.
+ */
+bool GetSysCallStats(SysCallType, SysCallStats&) noexcept;
+
+//! Reset statistics of all system calls, then enable or disable recording them.
+void ResetSysCallStats(bool enabled) noexcept;
+
+}  // namespace usr::sc
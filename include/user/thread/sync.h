@@ -0,0 +1,139 @@
+/**
+ * @file sync.h
+ * @brief User-mode synchronization and the interface of mutex statistics.
+ *
+ * @par GitHub
+ * https://github.com/Zhuagenborn
+ */
+
+#pragma once
+
+#include "user/stl/cstdint.h"
+
+namespace usr::sync {
+
+//! The timeout to wait for a futex without expiration.
+inline constexpr stl::size_t futex_wait_forever {static_cast<stl::size_t>(-1)};
+
+/**
+ * @brief Block the current thread if a futex word has an expected value.
+ *
+ * @details
+ * Checking the word and waiting are atomic with respect to @p FutexWake.
+ * Threads using the same word in shared memory can also wake each other up.
+ *
+ * @param addr A 32-bit aligned word.
+ * @param expected The expected value.
+ * @param milliseconds The timeout, or @p futex_wait_forever.
+ * @return Whether the thread is woken up by @p FutexWake.
+ * It returns @p false if the word does not have the expected value or the timeout expires.
+ */
+bool FutexWait(stl::uint32_t& addr, stl::uint32_t expected,
+               stl::size_t milliseconds = futex_wait_forever) noexcept;
+
+/**
+ * @brief Wake up threads waiting for a futex word.
+ *
+ * @param addr A 32-bit aligned word.
+ * @param count The maximum number of threads to wake up.
+ * @return The number of woken threads.
+ */
+stl::size_t FutexWake(stl::uint32_t& addr, stl::size_t count) noexcept;
+
+/**
+ * @brief The user-mode mutex based on a futex.
+ *
+ * @details
+ * Locking and unlocking are atomic operations in user mode.
+ * A system call is only made when the mutex is contended.
+ * The mutex is not recursive.
+ */
+class Mutex {
+public:
+    Mutex() noexcept = default;
+
+    Mutex(const Mutex&) = delete;
+
+    void Lock() noexcept;
+
+    //! Try to lock the mutex without blocking. It returns @p false if the mutex is locked.
+    bool TryLock() noexcept;
+
+    void Unlock() noexcept;
+
+private:
+    //! States of the futex word.
+    enum State : stl::uint32_t {
+        Unlocked,
+        //! The mutex is locked and no thread is waiting.
+        Locked,
+        //! The mutex is locked and threads may be waiting.
+        Contended
+    };
+
+    /**
+     * @brief Lock the mutex and mark it as contended.
+     *
+     * @details
+     * It is used by threads that have waited, since other threads may still be waiting.
+     */
+    void LockContended() noexcept;
+
+    friend class CondVar;
+
+    stl::uint32_t state_ {Unlocked};
+};
+
+/**
+ * @brief The user-mode condition variable based on a futex.
+ *
+ * @details
+ * The futex word is a sequence number increased by notifications.
+ * Notifying only makes a system call when threads are waiting.
+ *
+ * @code {.cpp}
+ * mtx.Lock();
+ * while (!cond) {
+ *     cv.Wait(mtx);
+ * }
+ * mtx.Unlock();
+ * @endcode
+ */
+class CondVar {
+public:
+    CondVar() noexcept = default;
+
+    CondVar(const CondVar&) = delete;
+
+    void Wait(Mutex&) noexcept;
+
+    /**
+     * @brief Wait until the condition variable is notified or a timeout expires.
+     *
+     * @return Whether the condition variable is notified before the timeout.
+     */
+    bool Wait(Mutex&, stl::size_t milliseconds) noexcept;
+
+    //! Wake up a waiting thread.
+    void NotifyOne() noexcept;
+
+    //! Wake up all waiting threads.
+    void NotifyAll() noexcept;
+
+private:
+    stl::uint32_t seq_ {0};
+    stl::uint32_t waiter_count_ {0};
+};
+
+/**
+ * @brief Reset statistics of all named kernel mutexes, then enable or disable recording them.
+ *
+ * @details
+ * Statistics include acquisitions, contended acquisitions, wait cycles and hold cycles.
+ */
+void ResetLockStats(bool enabled) noexcept;
+
+//! Print statistics of the most contended named kernel mutexes.
+void DumpLockStats() noexcept;
+
+}  // namespace usr::sync
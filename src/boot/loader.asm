@@ -10,8 +10,27 @@
 %include "kernel/memory/page.inc"
 %include "kernel/io/disk/disk.inc"
 
-; The maximum number of global descriptors.
-gdt_count       equ     60
+; The base-2 logarithm of the disk sector size.
+disk_sector_shift   equ     9
+
+%if 1 << disk_sector_shift != disk_sector_size
+    %error "The disk sector shift does not match the sector size"
+%endif
+
+; The minimum length of an LZ4 match.
+lz4_min_match_len   equ     4
+
+; Whether the kernel is compressed, which is set by the `KRNL_COMPRESS` macro.
+%ifndef KRNL_COMPRESS
+    %define KRNL_COMPRESS   0
+%endif
+
+; The buffer containing ELF headers of the kernel file.
+%if KRNL_COMPRESS
+    krnl_file_base  equ     unpacked_krnl_base
+%else
+    krnl_file_base  equ     raw_krnl_base
+%endif
 
 ; The control register of the A20 address line.
 a20_ctrl_port   equ     0x92
@@ -20,6 +39,12 @@ a20_ctrl_port   equ     0x92
 cr0_pe          equ     1
 ; Memory paging is enable.
 cr0_pg          equ     0x80000000
+; Read-only pages cannot be written in supervisor mode, which is required by copy-on-write pages.
+cr0_wp          equ     0x10000
+; 4 MB pages are enabled.
+cr4_pse         equ     0x10
+; Global pages are enabled.
+cr4_pge         equ     0x80
 
 ; The address range descriptor.
 struc       AddrRangeDesc
@@ -30,6 +55,9 @@ struc       AddrRangeDesc
     .type:              resd    1
 endstruc
 
+; The type of address ranges that can be used by the operating system.
+addr_range_usable   equ     1
+
 section     loader  vstart=loader_base
 ; The Global Descriptor Table (GDT)
 ; -------------------------------------------------------------------
@@ -60,9 +88,31 @@ video_desc:
 %endif
     ; -------------------------------------------------------------------
 
+    ; Data for the kernel, whose layout is the same as `LoaderData` in `include/kernel/loader.h`.
+%if $ - gdt_base != loader_krnl_data_base - loader_base
+    %error "The kernel data does not follow the global descriptor table"
+%endif
     ; The total memory size in bytes.
     total_mem_size    dd      0
 
+    ; Time-stamp counters for the boot timeline, which are read by the kernel after the total memory size.
+    ; The time-stamp counter when the master boot record starts to run.
+    mbr_tsc         dq      0
+    ; The time-stamp counter when the loader starts to run.
+    loader_tsc      dq      0
+    ; The time-stamp counter when the loader jumps to the kernel.
+    krnl_tsc        dq      0
+
+    ; The memory map reported by `INT 0x15`, `AX 0xE820`, which is read by the kernel after time-stamp counters.
+    ; The number of saved address range descriptors. It is `0` if the function is not supported.
+    mem_map_count   dd      0
+    mem_map:
+        times   max_mem_map_count * AddrRangeDesc_size      db      0
+
+%if $ - total_mem_size != loader_krnl_data_size
+    %error "The size of the kernel data does not meet the predefinition"
+%endif
+
     gdt_reg:
         istruc  DescTabReg
             at DescTabReg.limit,     dw      gdt_limit
@@ -89,6 +139,13 @@ start:
     %error "The code address does not meet the predefinition"
 %endif
 
+    ; The master boot record passes its time-stamp counter in `EDX:EAX`.
+    mov     [mbr_tsc], eax
+    mov     [mbr_tsc + B(4)], edx
+    rdtsc
+    mov     [loader_tsc], eax
+    mov     [loader_tsc + B(4)], edx
+
     call    InitTotalMemSize
 
     ; Enable memory segmentation and protected mode.
@@ -169,6 +226,7 @@ GetTotalMemSizeByInt15Ah88:
     ret
 
 ; Get the total memory size in bytes by `INT 0x15`, `AX 0xE820`.
+; Address range descriptors are saved in the memory map.
 ; Output:
 ; `EAX` = Successful or not.
 ; `ECX` = The memory size.
@@ -177,7 +235,7 @@ GetTotalMemSizeByInt15AxE820:
     xor     ebx, ebx
     mov     di, ard
 
-    ; Check each memory segment and find the maximum of `(AddrRangeDesc.base_addr_low + AddrRangeDesc.len_low)` of segments.
+    ; Check each memory segment and find the maximum of `(AddrRangeDesc.base_addr_low + AddrRangeDesc.len_low)` of usable segments below 4 GB.
 .read_seg:
     push    ecx
     mov     edx, 0x534D4150 ; "SMAP"
@@ -185,12 +243,29 @@ GetTotalMemSizeByInt15AxE820:
     mov     ecx, AddrRangeDesc_size
     int     0x15
     jc      .error
+    ; Save the descriptor in the memory map if it is not full.
+    mov     eax, [mem_map_count]
+    cmp     eax, max_mem_map_count
+    jae     .map_full
+    imul    di, ax, AddrRangeDesc_size
+    add     di, mem_map
+    mov     si, ard
+    mov     cx, AddrRangeDesc_size
+    cld
+    rep     movsb
+    inc     dword [mem_map_count]
+    mov     di, ard
+.map_full:
     pop     ecx
+    cmp     dword [ard + AddrRangeDesc.type], addr_range_usable
+    jne     .not_change_max
+    cmp     dword [ard + AddrRangeDesc.base_addr_high], 0
+    jne     .not_change_max
     ; `ECX` is the maximum of `(AddrRangeDesc.base_addr_low + AddrRangeDesc.len_low)` of segments.
     mov     eax, [ard + AddrRangeDesc.base_addr_low]
     add     eax, [ard + AddrRangeDesc.len_low]
     cmp     eax, ecx
-    jle     .not_change_max
+    jbe     .not_change_max
     mov     ecx, eax
 .not_change_max:
     test    ebx, ebx
@@ -199,6 +274,8 @@ GetTotalMemSizeByInt15AxE820:
     ret
 .error:
     pop     ecx
+    ; The memory map is incomplete and cannot be used.
+    mov     dword [mem_map_count], 0
     xor     eax, eax
     ret
 
@@ -252,9 +329,16 @@ protected_mode:
 
     call    EnableMemPaging
     call    LoadKernel
+    ; The kernel cannot be loaded.
+    test    eax, eax
+    jz      .end
+    mov     ebx, eax
+    rdtsc
+    mov     [krnl_tsc], eax
+    mov     [krnl_tsc + B(4)], edx
     mov     esp, krnl_stack_top
     ; Jump to the kernel.
-    call    eax
+    call    ebx
 .end:
     jmp     .end
 
@@ -271,13 +355,19 @@ EnableMemPaging:
     ; Add `0xC0000000` to the stack address.
     add     esp, krnl_base
 
+    ; Set the `PSE` and `PGE` bits of `CR4`.
+    ; Global kernel pages are not flushed from the TLB when `CR3` is reloaded on process switches.
+    mov     eax, cr4
+    or      eax, cr4_pse | cr4_pge
+    mov     cr4, eax
+
     ; Set `CR3` to the address of the page directory table.
     mov     eax, page_dir_base
     mov     cr3, eax
 
-    ; Set the `PG` bit of `CR0`.
+    ; Set the `PG` and `WP` bits of `CR0`.
     mov     eax, cr0
-    or      eax, cr0_pg
+    or      eax, cr0_pg | cr0_wp
     mov     cr0, eax
 
     ; Reload the global descriptor table.
@@ -303,13 +393,13 @@ paging_enabled:
 ; │   ├─────────────────────────┤    │   │  │
 ; │   │ (0x301) Directory Entry │ ───│───│──┘
 ; │   ├─────────────────────────┤    │   │
-; │   │ (0x300) Directory Entry │ ───┤   │
-; │   ├─────────────────────────┤    │   │
-; │   │           ...           │    │   │
-; │   ├─────────────────────────┤    │   │
-; │   │   (0) Directory Entry   │ ───┘ ◄─┘
-; │   ├─────────────────────────┤
-; └─► │         Kernel          │
+; │   │ (0x300) Directory Entry │ ───┘   │
+; │   ├─────────────────────────┤        │
+; │   │           ...           │        │
+; │   ├─────────────────────────┤        │
+; │   │   (0) Directory Entry   │ ───┐ ◄─┘
+; │   ├─────────────────────────┤    │ A 4 MB page
+; └─► │         Kernel          │ ◄──┘
 ;     └─────────────────────────┘
 ; ```
 SetupPageDir:
@@ -320,16 +410,17 @@ SetupPageDir:
     mov     eax, page_dir_base
     add     eax, mem_page_size
     ; `EBX` is the physical address of the first page table.
-    ; It will map the first 4 MB physical memory from `0x00000000` to `0x003FFFFF`.
+    ; It will map the kernel space from `0xC0000000` to `0xC03FFFFF`.
     mov     ebx, eax
     or      eax, mem_page_us_u | mem_page_rw_w | mem_page_p
 
-    ; The first page directory entry indexed `0` points to the first page table.
-    ; Because currently the loader is loaded to the first 1 MB physical memory within `0x00000000`-`0x003FFFFF`.
+    ; The first page directory entry indexed `0` maps the first 4 MB physical memory within `0x00000000`-`0x003FFFFF` as a large page.
+    ; Because currently the loader is loaded to the first 1 MB physical memory.
     ; To make sure it works properly, the linear address under memory segmentation and the virtual address under memory paging must be mapped to the same physical address.
-    mov     [page_dir_base + mem_page_entry_size * 0], eax
+    ; It does not share the first page table with the kernel, so global kernel pages are not visible at low addresses.
+    mov     dword [page_dir_base + mem_page_entry_size * 0], mem_page_ps | mem_page_us_u | mem_page_rw_w | mem_page_p
 
-    ; The page directory entry indexed `0x300` also points to the first page table.
+    ; The page directory entry indexed `0x300` points to the first page table.
     ; It is prepared for the kernel, which will be loaded to the first 1 MB physical memory.
     ; Because in virtual memory, the user space ranges from `0x00000000` to `0xBFFFFFFF`, 3 GB totally.
     ; Kernel space ranges from `0xC0000000` to `0xFFFFFFFF`, 1 GB totally.
@@ -341,11 +432,12 @@ SetupPageDir:
     mov     [page_dir_base + mem_page_entry_size * page_dir_self_ref], eax
 
     ; Initialize the first page table.
-    ; It maps virtual memory `0x00000000`-`0x003FFFFF` and `0xC0000000`-`0xC03FFFFF` to physical memory `0x00000000`-`0x003FFFFF`.
+    ; It maps virtual memory `0xC0000000`-`0xC00FFFFF` to physical memory `0x00000000`-`0x000FFFFF`.
+    ; Kernel pages are global since all processes share them.
     mov     ecx, krnl_size / mem_page_size
     xor     esi, esi
     xor     edx, edx
-    or      edx, mem_page_us_u | mem_page_rw_w | mem_page_p
+    or      edx, mem_page_g | mem_page_us_u | mem_page_rw_w | mem_page_p
 .init_page_tab:
     mov     [ebx + mem_page_entry_size * esi], edx
     add     edx, mem_page_size
@@ -375,28 +467,29 @@ SetupPageDir:
     ; ------------------------------------------------------------------------------------------------------------------------------
     ; <bochs:> info tab
     ; CR3: 0x000000100000
-    ; 0x00000000-0x000FFFFF -> 0x000000000000-0x0000000FFFFF
+    ; 0x00000000-0x003FFFFF -> 0x000000000000-0x0000003FFFFF
     ; 0xC0000000-0xC00FFFFF -> 0x000000000000-0x0000000FFFFF
-    ; 0xFFC00000-0xFFC00FFF -> 0x000000101000-0x000000101FFF
+    ; 0xFFF00000-0xFFF00FFF -> 0x000000101000-0x000000101FFF
     ; 0xFFFFF000-0xFFFFFFFF -> 0x000000100000-0x000000100FFF
     ; ------------------------------------------------------------------------------------------------------------------------------
     ; ```
     ;
-    ; `0x00000000-0x000FFFFF -> 0x000000000000-0x0000000FFFFF`:
-    ; The first page directory entry indexed `0` is pointing to the first page table.
+    ; `0x00000000-0x003FFFFF -> 0x000000000000-0x0000003FFFFF`:
+    ; The first page directory entry indexed `0` is mapping a 4 MB page.
     ;
     ; `0xC0000000-0xC00FFFFF -> 0x000000000000-0x0000000FFFFF`:
-    ; The page directory entry indexed `0x300` is also pointing to the first page table.
+    ; The page directory entry indexed `0x300` is pointing to the first page table.
     ;
-    ; `0xFFC00000-0xFFC00FFF -> 0x000000101000-0x000000101FFF`:
-    ; 1. The high 10 bits of `0xFFC00000` are `1023`.
+    ; `0xFFF00000-0xFFF00FFF -> 0x000000101000-0x000000101FFF`:
+    ; 1. The high 10 bits of `0xFFF00000` are `1023`.
     ;    The last page directory entry indexed `1023` is pointing to the page directory table itself at `0x00100000`.
     ;    The page directory table is treated as a page table because it is accessed from a page directory entry.
-    ; 2. The middle 10 bits of `0xFFC00000` are `0`.
-    ;    The first page directory entry indexed `0`, which is pointing to the first page table at `0x00101000`, is treated as a page entry.
-    ;    So the virtual address `0xFFC00000` is mapped to the physical address `0x000000101000`.
-    ;    `0xFFC00000` can be used to access page tables.
-    ; 3. By setting the value of the first 10 bits, we can access different page tables.
+    ; 2. The middle 10 bits of `0xFFF00000` are `0x300`.
+    ;    The page directory entry indexed `0x300`, which is pointing to the first page table at `0x00101000`, is treated as a page entry.
+    ;    So the virtual address `0xFFF00000` is mapped to the physical address `0x000000101000`.
+    ;    `0xFFC00000 + (index << 12)` can be used to access the page table of the page directory entry indexed `index`.
+    ;    `0xFFC00000` itself does not reach a page table, since the page directory entry indexed `0` maps a 4 MB page rather than pointing to a page table.
+    ; 3. By setting the value of the middle 10 bits, we can access different page tables.
     ;
     ; `0xFFFFF000-0xFFFFFFFF -> 0x000000100000-0x000000100FFF`:
     ; 1. The high 10 bits of `0xFFFFF000` are `1023`.
@@ -436,50 +529,231 @@ MemCopy:
     %pop
 
 ; Load the kernel image to memory.
+; Only loadable segments are read from the disk, and their zero-initialized parts are cleared.
 ; Output:
-; `EAX` = The entry point.
+; `EAX` = The entry point, or `0` if the kernel cannot be loaded.
 LoadKernel:
-    call    ReadKernel
-
-    xor     eax, eax
-    xor     ebx, ebx
-    xor     ecx, ecx
-    xor     edx, edx
-
-    ; The kernel is built as an ELF file.
-    mov     eax, [raw_krnl_base + ElfFileHeader.e_entry]
+%if KRNL_COMPRESS
+    call    UnpackKernel
+    test    eax, eax
+    jz      .error
+    ; Save the end of the unpacked file, which is cleared after segments are copied.
     push    eax
-    mov     dx, [raw_krnl_base + ElfFileHeader.e_phentsize]
-    mov     ebx, [raw_krnl_base + ElfFileHeader.e_phoff]
-    add     ebx, raw_krnl_base
+%else
+    ; Read the sector containing the ELF header and the program headers.
+    ; The linker places program headers right after the ELF header.
+    mov     eax, krnl_start_sector
+    mov     ebx, raw_krnl_base
+    mov     ecx, 1
+    call    ReadDisk
+%endif
 
-    ; Copy each segment to its virtual address.
-    mov     cx, [raw_krnl_base + ElfFileHeader.e_phnum]
+    ; The kernel is built as an ELF file.
+    mov     ebx, [krnl_file_base + ElfFileHeader.e_phoff]
+    add     ebx, krnl_file_base
+    movzx   ecx, word [krnl_file_base + ElfFileHeader.e_phnum]
 .load_seg:
-    cmp     byte [ebx + ElfSectHeader.p_type], PT_NULL
-    je      .next_seg
+    cmp     dword [ebx + ElfSectHeader.p_type], PT_LOAD
+    jne     .next_seg
+    push    ebx
+    push    ecx
     push    dword [ebx + ElfSectHeader.p_filesz]
+%if KRNL_COMPRESS
+    ; The whole file has been unpacked, so the segment is copied to its virtual address.
     mov     eax, [ebx + ElfSectHeader.p_offset]
-    add     eax, raw_krnl_base
+    add     eax, krnl_file_base
     push    eax
     push    dword [ebx + ElfSectHeader.p_vaddr]
     call    MemCopy
+%else
+    push    dword [ebx + ElfSectHeader.p_offset]
+    push    dword [ebx + ElfSectHeader.p_vaddr]
+    call    ReadSeg
+%endif
     add     esp, B(12)
+    pop     ecx
+    pop     ebx
+
+    ; Clear the memory beyond the file data, such as `.bss`.
+    push    ecx
+    mov     edi, [ebx + ElfSectHeader.p_vaddr]
+    add     edi, [ebx + ElfSectHeader.p_filesz]
+    mov     ecx, [ebx + ElfSectHeader.p_memsz]
+    sub     ecx, [ebx + ElfSectHeader.p_filesz]
+    xor     eax, eax
+    cld
+    rep     stosb
+    pop     ecx
 .next_seg:
-    add     ebx, edx
+    movzx   eax, word [krnl_file_base + ElfFileHeader.e_phentsize]
+    add     ebx, eax
     loop    .load_seg
+    mov     eax, [krnl_file_base + ElfFileHeader.e_entry]
+%if KRNL_COMPRESS
+    ; Clear the unpacked file, so the free memory above page tables is still zeroed.
+    pop     ecx
+    sub     ecx, unpacked_krnl_base
+    mov     edi, unpacked_krnl_base
+    push    eax
+    xor     eax, eax
+    cld
+    rep     stosb
     pop     eax
+%endif
+    ret
+%if KRNL_COMPRESS
+.error:
+    xor     eax, eax
     ret
-
-; Read the kernel from the disk.
-ReadKernel:
-%if krnl_sector_count > 1500
-    %error "The kernel is too large"
 %endif
+
+%if KRNL_COMPRESS
+; Read the compressed kernel from the disk and unpack it to `unpacked_krnl_base`.
+; The kernel is compressed in the LZ4 legacy frame format.
+; It has only one block since a legacy block can be up to 8 MB.
+; ```
+; ┌────────────────┬──────────────────────┬──────────────────┐
+; │ Magic (32-bit) │ Block Size (32-bit)  │ Compressed Block │
+; └────────────────┴──────────────────────┴──────────────────┘
+; ```
+; Output:
+; `EAX` = The end of the unpacked file, or `0` if the compressed or unpacked file is too large.
+UnpackKernel:
+    ; Read the first sector to get the size of the compressed block.
     mov     eax, krnl_start_sector
-    mov     ebx, raw_krnl_base
-    mov     ecx, krnl_sector_count
+    mov     ebx, packed_krnl_base
+    mov     ecx, 1
+    call    ReadDisk
+
+    ; The compressed kernel must not overlap the unpacked one.
+    mov     edx, [packed_krnl_base + B(4)]
+    cmp     edx, max_packed_krnl_size - B(8)
+    ja      .error
+
+    ; Read the other sectors of the compressed kernel.
+    push    edx
+    lea     ecx, [edx + B(8) + disk_sector_size - 1]
+    shr     ecx, disk_sector_shift
+    dec     ecx
+    mov     eax, krnl_start_sector + 1
+    mov     ebx, packed_krnl_base + disk_sector_size
+    call    ReadSectors
+
+    pop     ecx
+    mov     esi, packed_krnl_base + B(8)
+    lea     edx, [esi + ecx]
+    mov     edi, unpacked_krnl_base
+    push    ebp
+    mov     ebp, unpacked_krnl_base + max_unpacked_krnl_size
+    call    Lz4Decompress
+    pop     ebp
+    push    eax
+    push    edi
+
+    ; Clear the sectors of the compressed kernel, so the free memory above page tables is still zeroed.
+    mov     ecx, edx
+    sub     ecx, packed_krnl_base
+    add     ecx, disk_sector_size - 1
+    and     ecx, ~(disk_sector_size - 1)
+    mov     edi, packed_krnl_base
+    xor     eax, eax
+    cld
+    rep     stosb
+
+    pop     edi
+    pop     eax
+    test    eax, eax
+    jz      .error
+    mov     eax, edi
+    ret
+.error:
+    xor     eax, eax
+    ret
+
+; Decompress an LZ4 block.
+; A block consists of sequences, each of which has literals and a match copied from the previous output.
+; ```
+; ┌───────┬────────────────┬──────────┬──────────────────┬──────────────┐
+; │ Token │ Literal Length │ Literals │ Offset (16-bit)  │ Match Length │
+; └───────┴────────────────┴──────────┴──────────────────┴──────────────┘
+; ```
+; The high 4 bits of the token are the literal length and the low 4 bits are the match length minus 4.
+; A 4-bit length of `15` is followed by bytes added to it until a byte is not `255`.
+; The offset is the distance from the match back to the current output.
+; The last sequence only has literals.
+; Input:
+; `ESI` = The compressed block.
+; `EDX` = The end of the compressed block.
+; `EDI` = A buffer where data will be decompressed to.
+; `EBP` = The end of the buffer.
+; Output:
+; `EAX` = Successful or not. It fails if the data is larger than the buffer.
+; `EDI` = The end of the decompressed data.
+Lz4Decompress:
+    cld
+.read_seq:
+    movzx   ebx, byte [esi]
+    inc     esi
+    ; Copy literals.
+    mov     ecx, ebx
+    shr     ecx, 4
+    call    .read_len
+    lea     eax, [edi + ecx]
+    cmp     eax, ebp
+    ja      .error
+    rep     movsb
+    cmp     esi, edx
+    jae     .end
+
+    ; `EAX` is the distance from the match to the current output.
+    movzx   eax, word [esi]
+    add     esi, B(2)
+    push    eax
+    mov     ecx, ebx
+    and     ecx, 0xF
+    call    .read_len
+    add     ecx, lz4_min_match_len
+    lea     eax, [edi + ecx]
+    cmp     eax, ebp
+    pop     eax
+    ja      .error
+    ; A match can overlap the output, so it is copied byte by byte.
+    push    esi
+    mov     esi, edi
+    sub     esi, eax
+    rep     movsb
+    pop     esi
+    jmp     .read_seq
+.end:
+    mov     eax, True
+    ret
+.error:
+    xor     eax, eax
+    ret
 
+; Read extra length bytes.
+; Input:
+; `ECX` = A 4-bit length.
+; Output:
+; `ECX` = The full length.
+.read_len:
+    cmp     ecx, 0xF
+    jne     .read_len_end
+.read_len_byte:
+    movzx   eax, byte [esi]
+    inc     esi
+    add     ecx, eax
+    cmp     eax, 0xFF
+    je      .read_len_byte
+.read_len_end:
+    ret
+
+; Read sectors from the disk to memory.
+; Input:
+; `EAX` = A start sector.
+; `EBX` = A physical address where data will be written to.
+; `ECX` = The number of sectors to be read.
+ReadSectors:
 .read:
     ; Read up to 255 sectors at a time.
     push    ecx
@@ -501,6 +775,69 @@ ReadKernel:
     jmp     .read
 .end:
     ret
+%else
+; Read a segment from the disk to its virtual address.
+; A segment does not start or end at a sector boundary,
+; so sectors are read into a buffer and only the segment bytes are copied.
+ReadSeg:
+    %push   read_seg
+    %stacksize  flat
+    %arg    dest:dword, file_offset:dword, size:dword
+        enter   B(0), 0
+        ; `EAX` is the sector containing the beginning of the segment.
+        ; `EDX` is the offset of the segment in the sector.
+        mov     eax, [file_offset]
+        mov     edx, eax
+        and     edx, disk_sector_size - 1
+        shr     eax, disk_sector_shift
+        add     eax, krnl_start_sector
+.read:
+        mov     ecx, [size]
+        test    ecx, ecx
+        jz      .end
+        ; `ECX` is the number of sectors covering the rest of the segment, up to the buffer size.
+        add     ecx, edx
+        add     ecx, disk_sector_size - 1
+        shr     ecx, disk_sector_shift
+        cmp     ecx, krnl_seg_buf_sector_count
+        jbe     .not_change_sector
+        mov     ecx, krnl_seg_buf_sector_count
+.not_change_sector:
+        push    eax
+        push    ecx
+        push    edx
+        mov     ebx, krnl_seg_buf
+        call    ReadDisk
+        pop     edx
+
+        ; `ECX` is the number of segment bytes in the buffer.
+        mov     ecx, [esp]
+        shl     ecx, disk_sector_shift
+        sub     ecx, edx
+        cmp     ecx, [size]
+        jbe     .copy
+        mov     ecx, [size]
+.copy:
+        add     edx, krnl_seg_buf
+        push    ecx
+        push    edx
+        push    dword [dest]
+        call    MemCopy
+        add     esp, B(12)
+        add     [dest], ecx
+        sub     [size], ecx
+
+        pop     ecx
+        pop     eax
+        add     eax, ecx
+        ; Subsequent reads start at sector boundaries.
+        xor     edx, edx
+        jmp     .read
+.end:
+        leave
+        ret
+    %pop
+%endif
 
 ; Read data from the disk to memory in 32-bit mode.
 ; Input:
@@ -570,4 +907,8 @@ ReadDisk:
     cld
     rep     insw
 .end:
-    ret
\ No newline at end of file
+    ret
+
+%if $ - $$ > loader_sector_count * disk_sector_size
+    %error "The loader is too large"
+%endif
@@ -16,9 +16,17 @@ section     mbr     vstart=mbr_base
     mov     gs, ax
     mov     sp, mbr_stack_top
 
+    ; Save the time-stamp counter when the master boot record starts to run.
+    rdtsc
+    push    edx
+    push    eax
+
     call    ClearScreen
 
     call    ReadLoader
+    ; Pass the time-stamp counter to the loader in `EDX:EAX`.
+    pop     eax
+    pop     edx
     jmp     loader_code_entry
 
 ; Read the loader from the disk.
@@ -0,0 +1,82 @@
+%include "kernel/util/metric.inc"
+
+[bits 32]
+section     .text
+global      GetCpuFeatures
+; Get the feature flags in `EDX` returned by `cpuid` with `EAX = 1`.
+GetCpuFeatures:
+    ; `EBX` is a callee-saved register, but `cpuid` changes it.
+    push    ebx
+    mov     eax, 1
+    cpuid
+    mov     eax, edx
+    pop     ebx
+    ret
+
+global      EnableFpu
+; Enable the FPU and SSE instructions.
+EnableFpu:
+    ; Clear `CR0.EM` to use the FPU instead of emulating it.
+    ; Set `CR0.MP` so `wait` also checks the task-switched flag, and `CR0.NE` to report FPU errors natively.
+    mov     eax, cr0
+    and     eax, ~(1 << 2)
+    or      eax, (1 << 1) | (1 << 5)
+    mov     cr0, eax
+    ; Set `CR4.OSFXSR` to enable `fxsave`, `fxrstor` and SSE instructions,
+    ; and `CR4.OSXMMEXCPT` to report SSE floating-point exceptions.
+    mov     eax, cr4
+    or      eax, (1 << 9) | (1 << 10)
+    mov     cr4, eax
+    ret
+
+global      ClearTaskSwitched
+; Clear the task-switched flag in `CR0`, so the FPU can be used without a device-not-available exception.
+ClearTaskSwitched:
+    clts
+    ret
+
+global      SetTaskSwitched
+; Set the task-switched flag in `CR0`, so the next FPU instruction raises a device-not-available exception.
+SetTaskSwitched:
+    mov     eax, cr0
+    or      eax, 1 << 3
+    mov     cr0, eax
+    ret
+
+global      ResetFpu
+; Reset the FPU to its default state.
+ResetFpu:
+    fninit
+    ret
+
+global      SaveFpuState
+; Save the FPU, MMX and SSE state to a 16-byte aligned buffer.
+; ```c++
+; void SaveFpuState(FpuState* state) noexcept;
+; ```
+SaveFpuState:
+    %push   save_fpu_state
+    %stacksize  flat
+    %arg    state:dword
+        enter   B(0), 0
+        mov     eax, [state]
+        fxsave  [eax]
+        leave
+        ret
+    %pop
+
+global      RestoreFpuState
+; Restore the FPU, MMX and SSE state from a 16-byte aligned buffer.
+; ```c++
+; void RestoreFpuState(const FpuState* state) noexcept;
+; ```
+RestoreFpuState:
+    %push   restore_fpu_state
+    %stacksize  flat
+    %arg    state:dword
+        enter   B(0), 0
+        mov     eax, [state]
+        fxrstor [eax]
+        leave
+        ret
+    %pop
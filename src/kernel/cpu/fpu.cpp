@@ -0,0 +1,198 @@
+#include "kernel/cpu/fpu.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/slab.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/thread/thd.h"
+#include "kernel/util/bit.h"
+
+namespace cpu {
+
+namespace {
+
+//! Bits of the feature flags in @p EDX returned by @p cpuid.
+enum class CpuFeature {
+    //! The FPU on chip.
+    Fpu = 1 << 0,
+    //! @p fxsave and @p fxrstor.
+    Fxsr = 1 << 24,
+    //! SSE instructions.
+    Sse = 1 << 25
+};
+
+extern "C" {
+//! Get the feature flags in @p EDX returned by @p cpuid with `EAX = 1`.
+stl::uint32_t GetCpuFeatures() noexcept;
+
+//! Enable the FPU and SSE instructions.
+void EnableFpu() noexcept;
+
+//! Clear the task-switched flag in @p CR0.
+void ClearTaskSwitched() noexcept;
+
+//! Set the task-switched flag in @p CR0.
+void SetTaskSwitched() noexcept;
+
+//! Reset the FPU to its default state.
+void ResetFpu() noexcept;
+
+//! Save the FPU, MMX and SSE state.
+void SaveFpuState(FpuState*) noexcept;
+
+//! Restore the FPU, MMX and SSE state.
+void RestoreFpuState(const FpuState*) noexcept;
+}
+
+/**
+ * @brief A wrapper of a global variable representing the slab cache of FPU states.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+mem::SlabCache<FpuState>& GetFpuStateCache() noexcept {
+    static mem::SlabCache<FpuState> cache {"fpu"};
+    return cache;
+}
+
+/**
+ * @brief A wrapper of a global variable representing the thread whose state is in the FPU registers.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+const tsk::Thread*& GetFpuOwner() noexcept {
+    static const tsk::Thread* owner {nullptr};
+    return owner;
+}
+
+/**
+ * @brief A wrapper of a global @p bool variable representing whether lazy FPU context switching has been enabled.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+bool& IsFpuInitedImpl() noexcept {
+    static bool inited {false};
+    return inited;
+}
+
+/**
+ * @brief The device-not-available exception handler.
+ *
+ * @details
+ * It is raised by the first FPU or SSE instruction after a thread switch.
+ * It gives the FPU registers to the current thread.
+ */
+void DeviceNotAvailableHandler(stl::size_t) noexcept {
+    auto& curr_thd {tsk::Thread::GetCurrent()};
+    if (!curr_thd.GetFpuState()) {
+        // The thread uses the FPU for the first time.
+        // Allocating memory may block, so it is done before the registers are handed over.
+        const auto state {GetFpuStateCache().Allocate()};
+        mem::AssertAlloc(state);
+        curr_thd.SetFpuState(state);
+        const intr::IntrGuard guard;
+        ClearTaskSwitched();
+        if (auto& owner {GetFpuOwner()}; owner) {
+            SaveFpuState(const_cast<tsk::Thread*>(owner)->GetFpuState());
+        }
+
+        ResetFpu();
+        GetFpuOwner() = &curr_thd;
+        return;
+    }
+
+    const intr::IntrGuard guard;
+    ClearTaskSwitched();
+    auto& owner {GetFpuOwner()};
+    if (owner == &curr_thd) {
+        return;
+    }
+
+    if (owner) {
+        SaveFpuState(const_cast<tsk::Thread*>(owner)->GetFpuState());
+    }
+
+    RestoreFpuState(curr_thd.GetFpuState());
+    owner = &curr_thd;
+}
+
+}  // namespace
+
+void InitFpu() noexcept {
+    dbg::Assert(!IsFpuInited());
+    const bit::Flags<CpuFeature> features {GetCpuFeatures()};
+    if (!features.IsSet(CpuFeature::Fpu) || !features.IsSet(CpuFeature::Fxsr)
+        || !features.IsSet(CpuFeature::Sse)) {
+        io::PrintlnStr("The CPU does not support FPU and SSE context switching.");
+        return;
+    }
+
+    EnableFpu();
+    intr::GetIntrHandlerTab().Register(intr::Intr::DeviceNotAvailable, &DeviceNotAvailableHandler);
+    // No thread owns the FPU registers yet.
+    SetTaskSwitched();
+    IsFpuInitedImpl() = true;
+    io::PrintlnStr("The FPU and SSE have been initialized.");
+}
+
+bool IsFpuInited() noexcept {
+    return IsFpuInitedImpl();
+}
+
+void SwitchFpu(const tsk::Thread& next) noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    if (!IsFpuInited()) {
+        return;
+    }
+
+    if (GetFpuOwner() == &next) {
+        // The registers still hold the state of the thread.
+        ClearTaskSwitched();
+    } else {
+        SetTaskSwitched();
+    }
+}
+
+void CopyFpu(const tsk::Thread& from, tsk::Thread& to) noexcept {
+    to.SetFpuState(nullptr);
+    if (!from.GetFpuState()) {
+        return;
+    }
+
+    const auto state {GetFpuStateCache().Allocate()};
+    mem::AssertAlloc(state);
+    const intr::IntrGuard guard;
+    if (GetFpuOwner() == &from) {
+        // The latest state is still in the registers.
+        ClearTaskSwitched();
+        SaveFpuState(const_cast<FpuState*>(from.GetFpuState()));
+    }
+
+    stl::memcpy(state, from.GetFpuState(), sizeof(FpuState));
+    to.SetFpuState(state);
+}
+
+void ReleaseFpu(tsk::Thread& thd) noexcept {
+    const auto state {thd.GetFpuState()};
+    if (!state) {
+        return;
+    }
+
+    {
+        const intr::IntrGuard guard;
+        if (GetFpuOwner() == &thd) {
+            GetFpuOwner() = nullptr;
+        }
+
+        thd.SetFpuState(nullptr);
+    }
+
+    GetFpuStateCache().Free(state);
+}
+
+}  // namespace cpu
@@ -0,0 +1,336 @@
+#include "kernel/cpu/mp.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/video/print.h"
+#include "kernel/krnl.h"
+#include "kernel/stl/cstring.h"
+
+namespace cpu {
+
+namespace {
+
+#pragma pack(push, 1)
+
+//! The MP floating pointer structure.
+struct MpFloatPtr {
+    static constexpr char signature[] {"_MP_"};
+
+    char sign[sizeof(signature) - 1];
+    //! The physical address of the configuration table.
+    stl::uint32_t config_addr;
+    //! The structure length in 16-byte units.
+    stl::uint8_t len;
+    stl::uint8_t spec_rev;
+    stl::uint8_t checksum;
+    /**
+     * @details
+     * If it is not zero, there is no configuration table,
+     * and the system uses one of the default configurations with two processors.
+     */
+    stl::uint8_t default_config;
+    stl::uint8_t features[4];
+};
+
+static_assert(sizeof(MpFloatPtr) == 16);
+
+//! The header of the MP configuration table.
+struct MpConfigHeader {
+    static constexpr char signature[] {"PCMP"};
+
+    char sign[sizeof(signature) - 1];
+    stl::uint16_t base_len;
+    stl::uint8_t spec_rev;
+    stl::uint8_t checksum;
+    char oem_id[8];
+    char product_id[12];
+    stl::uint32_t oem_tab_addr;
+    stl::uint16_t oem_tab_size;
+    stl::uint16_t entry_count;
+    stl::uint32_t local_apic_addr;
+    stl::uint16_t ext_tab_len;
+    stl::uint8_t ext_tab_checksum;
+    stl::uint8_t reserved;
+};
+
+static_assert(sizeof(MpConfigHeader) == 44);
+
+enum class MpEntryType : stl::uint8_t { Processor, Bus, IoApic, IoIntr, LocalIntr };
+
+//! The processor entry of the MP configuration table.
+struct MpProcEntry {
+    static constexpr stl::uint8_t enabled {1 << 0};
+    static constexpr stl::uint8_t bsp {1 << 1};
+
+    MpEntryType type;
+    stl::uint8_t local_apic_id;
+    stl::uint8_t local_apic_ver;
+    stl::uint8_t flags;
+    stl::uint32_t signature;
+    stl::uint32_t features;
+    stl::uint32_t reserved[2];
+};
+
+static_assert(sizeof(MpProcEntry) == 20);
+
+//! The bus entry of the MP configuration table.
+struct MpBusEntry {
+    static constexpr char isa[] {"ISA   "};
+
+    MpEntryType type;
+    stl::uint8_t bus_id;
+    //! The bus type, padded with spaces.
+    char bus_type[sizeof(isa) - 1];
+};
+
+static_assert(sizeof(MpBusEntry) == 8);
+
+//! The I/O APIC entry of the MP configuration table.
+struct MpIoApicEntry {
+    static constexpr stl::uint8_t enabled {1 << 0};
+
+    MpEntryType type;
+    stl::uint8_t io_apic_id;
+    stl::uint8_t io_apic_ver;
+    stl::uint8_t flags;
+    stl::uint32_t io_apic_addr;
+};
+
+static_assert(sizeof(MpIoApicEntry) == 8);
+
+//! The I/O interrupt assignment entry of the MP configuration table.
+struct MpIoIntrEntry {
+    //! A vectored interrupt, whose vector is supplied by the I/O APIC.
+    static constexpr stl::uint8_t intr_type_int {0};
+
+    //! The destination ID meaning the interrupt is connected to the same pin of all I/O APICs.
+    static constexpr stl::uint8_t all_io_apics {0xFF};
+
+    MpEntryType type;
+    stl::uint8_t intr_type;
+    stl::uint16_t flags;
+    stl::uint8_t src_bus_id;
+    stl::uint8_t src_bus_irq;
+    stl::uint8_t dst_io_apic_id;
+    stl::uint8_t dst_io_apic_pin;
+};
+
+static_assert(sizeof(MpIoIntrEntry) == 8);
+
+#pragma pack(pop)
+
+//! Other entries have the same size.
+inline constexpr stl::size_t mp_entry_size {8};
+
+//! The default physical address of local APICs.
+inline constexpr stl::uintptr_t default_local_apic_addr {0xFEE00000};
+
+//! The default physical address of the I/O APIC.
+inline constexpr stl::uintptr_t default_io_apic_addr {0xFEC00000};
+
+//! The @p IMCRP bit in the second feature byte of the MP floating pointer structure.
+inline constexpr stl::uint8_t mp_feature_imcrp {1 << 7};
+
+//! The first megabyte of physical memory is mapped to the beginning of kernel space.
+inline constexpr stl::uintptr_t low_mem_size {0x100000};
+
+/**
+ * @brief A wrapper of a global variable representing detected processors.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+MpInfo& GetMpInfoImpl() noexcept {
+    static MpInfo info {};
+    return info;
+}
+
+//! Convert a physical address in the first megabyte to a virtual address.
+const void* GetLowMem(const stl::uintptr_t phy_addr) noexcept {
+    dbg::Assert(phy_addr < low_mem_size);
+    return reinterpret_cast<const void*>(krnl_base + phy_addr);
+}
+
+//! Whether the sum of all bytes is zero.
+bool IsChecksumValid(const void* const data, const stl::size_t size) noexcept {
+    stl::uint8_t sum {0};
+    for (stl::size_t i {0}; i != size; ++i) {
+        sum += static_cast<const stl::uint8_t*>(data)[i];
+    }
+
+    return sum == 0;
+}
+
+//! Search the MP floating pointer structure in a physical memory range.
+const MpFloatPtr* FindMpFloatPtr(const stl::uintptr_t phy_base, const stl::size_t size) noexcept {
+    // The structure is aligned to 16 bytes.
+    for (stl::size_t offset {0}; offset + sizeof(MpFloatPtr) <= size; offset += 16) {
+        const auto ptr {static_cast<const MpFloatPtr*>(GetLowMem(phy_base + offset))};
+        if (stl::memcmp(ptr->sign, MpFloatPtr::signature, sizeof(ptr->sign)) == 0
+            && IsChecksumValid(ptr, ptr->len * 16)) {
+            return ptr;
+        }
+    }
+
+    return nullptr;
+}
+
+const MpFloatPtr* FindMpFloatPtr() noexcept {
+    // The segment of the extended BIOS data area is saved at `0x40E`.
+    constexpr stl::uintptr_t ebda_seg_addr {0x40E};
+    constexpr stl::size_t kb {1024};
+    const auto ebda_base {static_cast<stl::uintptr_t>(
+                              *static_cast<const stl::uint16_t*>(GetLowMem(ebda_seg_addr)))
+                          << 4};
+    if (ebda_base != 0 && ebda_base + kb <= low_mem_size) {
+        if (const auto ptr {FindMpFloatPtr(ebda_base, kb)}; ptr) {
+            return ptr;
+        }
+    }
+
+    // The last kilobyte of base memory.
+    constexpr stl::uintptr_t base_mem_end {0xA0000};
+    if (const auto ptr {FindMpFloatPtr(base_mem_end - kb, kb)}; ptr) {
+        return ptr;
+    }
+
+    // The BIOS ROM.
+    constexpr stl::uintptr_t bios_rom_base {0xF0000};
+    return FindMpFloatPtr(bios_rom_base, low_mem_size - bios_rom_base);
+}
+
+void InitUniProcessor(MpInfo& info) noexcept {
+    info.cpu_count = 1;
+    info.bsp_idx = 0;
+    info.local_apic_addr = default_local_apic_addr;
+    info.apic_ids[0] = 0;
+    info.io_apic_addr = 0;
+    info.io_apic_id = 0;
+    info.imcr_present = false;
+    for (stl::size_t i {0}; i != info.isa_irq_pins.size(); ++i) {
+        info.isa_irq_pins[i] = static_cast<stl::uint8_t>(i);
+    }
+}
+
+//! Read an I/O interrupt assignment entry of an ISA interrupt request.
+void ReadIsaIntr(const MpIoIntrEntry& entry, const stl::size_t isa_bus_id, MpInfo& info) noexcept {
+    if (entry.src_bus_id != isa_bus_id || entry.intr_type != MpIoIntrEntry::intr_type_int
+        || entry.src_bus_irq >= isa_irq_count
+        || (entry.dst_io_apic_id != info.io_apic_id
+            && entry.dst_io_apic_id != MpIoIntrEntry::all_io_apics)) {
+        return;
+    }
+
+    info.isa_irq_pins[entry.src_bus_irq] = entry.dst_io_apic_pin;
+}
+
+/**
+ * @brief Read processor entries from the MP configuration table.
+ *
+ * @return Whether the table is valid.
+ */
+bool ReadMpConfig(const stl::uintptr_t phy_addr, MpInfo& info) noexcept {
+    // Only tables in the first megabyte can be accessed before they are mapped.
+    if (phy_addr == 0 || phy_addr + sizeof(MpConfigHeader) > low_mem_size) {
+        return false;
+    }
+
+    const auto header {static_cast<const MpConfigHeader*>(GetLowMem(phy_addr))};
+    if (stl::memcmp(header->sign, MpConfigHeader::signature, sizeof(header->sign)) != 0
+        || phy_addr + header->base_len > low_mem_size
+        || !IsChecksumValid(header, header->base_len)) {
+        return false;
+    }
+
+    info.cpu_count = 0;
+    info.bsp_idx = 0;
+    info.local_apic_addr = header->local_apic_addr;
+    const auto entries {reinterpret_cast<const stl::uint8_t*>(header + 1)};
+    auto entry {entries};
+    auto isa_bus_id {npos};
+    for (stl::size_t i {0}; i != header->entry_count; ++i) {
+        const auto type {static_cast<MpEntryType>(*entry)};
+        if (type == MpEntryType::Bus) {
+            const auto bus {reinterpret_cast<const MpBusEntry*>(entry)};
+            if (stl::memcmp(bus->bus_type, MpBusEntry::isa, sizeof(bus->bus_type)) == 0) {
+                isa_bus_id = bus->bus_id;
+            }
+        } else if (type == MpEntryType::IoApic) {
+            // Only the first I/O APIC is used.
+            const auto io_apic {reinterpret_cast<const MpIoApicEntry*>(entry)};
+            if ((io_apic->flags & MpIoApicEntry::enabled) != 0 && info.io_apic_addr == 0) {
+                info.io_apic_addr = io_apic->io_apic_addr;
+                info.io_apic_id = io_apic->io_apic_id;
+            }
+        }
+
+        if (type != MpEntryType::Processor) {
+            entry += mp_entry_size;
+            continue;
+        }
+
+        const auto proc {reinterpret_cast<const MpProcEntry*>(entry)};
+        entry += sizeof(MpProcEntry);
+        if ((proc->flags & MpProcEntry::enabled) == 0 || info.cpu_count == max_cpu_count) {
+            continue;
+        }
+
+        if ((proc->flags & MpProcEntry::bsp) != 0) {
+            info.bsp_idx = info.cpu_count;
+        }
+
+        info.apic_ids[info.cpu_count++] = proc->local_apic_id;
+    }
+
+    // Interrupt assignments refer to buses and I/O APICs, which may be listed after them.
+    entry = entries;
+    for (stl::size_t i {0}; i != header->entry_count; ++i) {
+        if (const auto type {static_cast<MpEntryType>(*entry)}; type == MpEntryType::Processor) {
+            entry += sizeof(MpProcEntry);
+            continue;
+        } else if (type == MpEntryType::IoIntr && isa_bus_id != npos) {
+            ReadIsaIntr(*reinterpret_cast<const MpIoIntrEntry*>(entry), isa_bus_id, info);
+        }
+
+        entry += mp_entry_size;
+    }
+
+    return info.cpu_count > 0;
+}
+
+}  // namespace
+
+void InitMultiProcessor() noexcept {
+    auto& info {GetMpInfoImpl()};
+    InitUniProcessor(info);
+    if (const auto ptr {FindMpFloatPtr()}; ptr) {
+        if (ptr->default_config != 0) {
+            // Default configurations have two processors with local APIC IDs `0` and `1`,
+            // and an I/O APIC with the ID `2` at the default address.
+            info.cpu_count = 2;
+            info.apic_ids[1] = 1;
+            info.io_apic_addr = default_io_apic_addr;
+            info.io_apic_id = 2;
+        } else if (!ReadMpConfig(ptr->config_addr, info)) {
+            InitUniProcessor(info);
+        }
+
+        info.imcr_present = (ptr->features[1] & mp_feature_imcrp) != 0;
+    }
+
+    io::Printf("0x{} processors have been detected. Only the bootstrap processor is running.\n",
+               info.cpu_count);
+}
+
+const MpInfo& GetMpInfo() noexcept {
+    return GetMpInfoImpl();
+}
+
+stl::size_t GetCurrCpuIdx() noexcept {
+    return GetMpInfo().bsp_idx;
+}
+
+stl::uint32_t GetOnlineCpuMask() noexcept {
+    return static_cast<stl::uint32_t>(1) << GetCurrCpuIdx();
+}
+
+}  // namespace cpu
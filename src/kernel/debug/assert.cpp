@@ -1,5 +1,6 @@
 #include "kernel/debug/assert.h"
 #include "kernel/interrupt/intr.h"
+#include "kernel/io/serial.h"
 #include "kernel/io/video/print.h"
 
 namespace dbg {
@@ -23,6 +24,8 @@ namespace {
         io::Printf("\tMessage: {}.\n", msg.data());
     }
 
+    // The interrupt handler of the serial port cannot refill its FIFO any more.
+    io::GetSerialPort().Drain();
     while (true) {
     }
 }
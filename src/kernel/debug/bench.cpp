@@ -0,0 +1,331 @@
+#include "kernel/debug/bench.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/disk/disk.h"
+#include "kernel/io/io.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/pool.h"
+#include "kernel/process/proc.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/syscall/call.h"
+#include "kernel/thread/thd.h"
+#include "kernel/util/bit.h"
+#include "kernel/util/bitmap.h"
+
+namespace dbg {
+
+extern "C" {
+
+//! The system call used by user code, defined in @p src/kernel/syscall/call.asm.
+stl::int32_t RawSysCall(sc::SysCallType func, stl::uintptr_t arg1, stl::uintptr_t arg2,
+                        stl::uintptr_t arg3, stl::uintptr_t arg4, stl::uintptr_t arg5) noexcept;
+}
+
+namespace {
+
+//! The number of bits in the bitmap of the bitmap benchmark.
+constexpr stl::size_t bench_bitmap_bit_count {4096};
+//! The largest size of buffers used by disk and memory benchmarks.
+constexpr stl::size_t bench_buf_size {KB(4)};
+//! The interval to check whether a user benchmark has finished.
+constexpr stl::size_t usr_bench_poll_interval {10};
+
+//! Registered benchmarks.
+struct BenchTab {
+    stl::array<Benchmark, max_bench_count> benches;
+    stl::size_t count;
+};
+
+/**
+ * @brief A wrapper of a global variable saving registered benchmarks.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+BenchTab& GetBenchTab() noexcept {
+    static BenchTab tab {};
+    return tab;
+}
+
+//! A benchmark running in a user process.
+struct UsrBench {
+    const Benchmark* bench;
+    stl::uint32_t* cycles;
+    //! Whether the user process has finished measuring.
+    bool done;
+};
+
+/**
+ * @brief A wrapper of a global variable saving the benchmark running in a user process.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ *
+ * User processes share kernel memory, so the user process reads it and writes results to it.
+ */
+UsrBench& GetUsrBench() noexcept {
+    static UsrBench bench {};
+    return bench;
+}
+
+//! Convert a cycle count to 32 bits, saturating at the maximum value.
+stl::uint32_t Saturate(const stl::uint64_t cycles) noexcept {
+    return bit::GetHighDword(cycles) == 0 ? bit::GetLowDword(cycles) : 0xFFFFFFFF;
+}
+
+/**
+ * @brief Warm up and measure an operation in cycles.
+ *
+ * @details
+ * It is also called in user mode, so it only reads the time-stamp counter and writes results.
+ *
+ * @param[out] cycles The cycles of @p bench_run_count runs.
+ */
+void Measure(const Benchmark::Callback op, void* const arg, stl::uint32_t* const cycles) noexcept {
+    for (stl::size_t i {0}; i != bench_warm_up_count; ++i) {
+        op(arg);
+    }
+
+    for (stl::size_t i {0}; i != bench_run_count; ++i) {
+        const auto begin {io::ReadTsc()};
+        op(arg);
+        cycles[i] = Saturate(io::ReadTsc() - begin);
+    }
+}
+
+//! Measure the current user benchmark in a user process and exit the process.
+[[noreturn]] void RunUsrBench() noexcept {
+    auto& usr_bench {GetUsrBench()};
+    Measure(usr_bench.bench->op, usr_bench.bench->arg, usr_bench.cycles);
+    __atomic_store_n(&usr_bench.done, true, __ATOMIC_RELEASE);
+    RawSysCall(sc::SysCallType::ExitProcess, 0, 0, 0, 0, 0);
+    while (true) {
+    }
+}
+
+//! Sort cycles in ascending order. The number of runs is small, so insertion sort is enough.
+void Sort(stl::uint32_t* const cycles, const stl::size_t count) noexcept {
+    for (stl::size_t i {1}; i < count; ++i) {
+        const auto val {cycles[i]};
+        auto j {i};
+        for (; j != 0 && cycles[j - 1] > val; --j) {
+            cycles[j] = cycles[j - 1];
+        }
+
+        cycles[j] = val;
+    }
+}
+
+//! Measure the cost of reading the time-stamp counter around an empty operation.
+stl::uint32_t MeasureOverhead(stl::uint32_t* const cycles) noexcept {
+    Measure([](void*) noexcept {}, nullptr, cycles);
+    Sort(cycles, bench_run_count);
+    return cycles[0];
+}
+
+//! Run a benchmark and print the minimum, median and 99th percentile of cycles.
+void Run(const Benchmark& bench, const stl::uint32_t overhead,
+         stl::uint32_t* const cycles) noexcept {
+    if (bench.setup) {
+        bench.setup(bench.arg);
+    }
+
+    if (bench.usr_mode) {
+        auto& usr_bench {GetUsrBench()};
+        usr_bench = {&bench, cycles, false};
+        tsk::Process::Create(bench.name, reinterpret_cast<void*>(&RunUsrBench));
+        while (!__atomic_load_n(&usr_bench.done, __ATOMIC_ACQUIRE)) {
+            tsk::Thread::GetCurrent().Sleep(usr_bench_poll_interval);
+        }
+    } else {
+        Measure(bench.op, bench.arg, cycles);
+    }
+
+    if (bench.cleanup) {
+        bench.cleanup(bench.arg);
+    }
+
+    for (stl::size_t i {0}; i != bench_run_count; ++i) {
+        cycles[i] = cycles[i] > overhead ? cycles[i] - overhead : 0;
+    }
+
+    Sort(cycles, bench_run_count);
+    io::Printf("{}", bench.name);
+    if (bench.param != npos) {
+        io::Printf(" ({})", bench.param);
+    }
+
+    io::Printf(": min {}, median {}, p99 {} cycles.\n", cycles[0], cycles[bench_run_count / 2],
+               cycles[bench_run_count * 99 / 100]);
+}
+
+//! The state of the context switch benchmark.
+struct YieldBench {
+    tsk::Thread* partner;
+    //! Whether the partner thread should exit.
+    bool stopped;
+};
+
+YieldBench& GetYieldBench() noexcept {
+    static YieldBench bench {};
+    return bench;
+}
+
+//! Buffers used by disk and memory benchmarks.
+struct BufBench {
+    void* src;
+    void* dest;
+};
+
+BufBench& GetBufBench() noexcept {
+    static BufBench bench {};
+    return bench;
+}
+
+Bitmap& GetBenchBitmap() noexcept {
+    static Bitmap bitmap;
+    return bitmap;
+}
+
+/**
+ * @brief Register built-in benchmarks.
+ *
+ * @details
+ * Sizes are passed as arguments, so callbacks do not need their own state.
+ */
+void RegisterBuiltinBenchmarks() noexcept {
+    // A round trip of two context switches with a thread that keeps yielding.
+    Benchmark yield {"tsk::Thread::Yield",
+                     [](void*) noexcept { tsk::Thread::GetCurrent().Yield(); }};
+    yield.setup = [](void*) noexcept {
+        auto& bench {GetYieldBench()};
+        bench.stopped = false;
+        bench.partner = &tsk::Thread::Create(
+            "bench_yield", tsk::Thread::GetCurrent().GetPriority(), [](void*) noexcept {
+                while (!__atomic_load_n(&GetYieldBench().stopped, __ATOMIC_ACQUIRE)) {
+                    tsk::Thread::GetCurrent().Yield();
+                }
+            });
+    };
+
+    yield.cleanup = [](void*) noexcept {
+        auto& bench {GetYieldBench()};
+        __atomic_store_n(&bench.stopped, true, __ATOMIC_RELEASE);
+        bench.partner->Join();
+        bench.partner = nullptr;
+    };
+
+    RegisterBenchmark(yield);
+
+    // The cheapest system call, so the cost is mostly entering and leaving the kernel.
+    Benchmark sys_call {"sc::SysCall", [](void*) noexcept {
+                            RawSysCall(sc::SysCallType::GetCurrPid, 0, 0, 0, 0, 0);
+                        }};
+    sys_call.usr_mode = true;
+    RegisterBenchmark(sys_call);
+
+    for (stl::size_t i {0}; i != mem::MemBlockDescTab::count; ++i) {
+        const auto size {mem::MemBlockDescTab::GetBlockSize(i)};
+        Benchmark alloc {"mem::Allocate/Free", [](void* const arg) noexcept {
+                             const auto addr {mem::Allocate(reinterpret_cast<stl::size_t>(arg))};
+                             mem::AssertAlloc(addr);
+                             mem::Free(addr);
+                         }};
+        alloc.arg = reinterpret_cast<void*>(size);
+        alloc.param = size;
+        RegisterBenchmark(alloc);
+    }
+
+    // The first half of bits is allocated, and each allocation scans it from the beginning.
+    Benchmark bitmap {"Bitmap::Alloc", [](void*) noexcept {
+                          auto& bitmap {GetBenchBitmap()};
+                          bitmap.SetFreeHint(0);
+                          bitmap.Free(bitmap.Alloc());
+                      }};
+    bitmap.setup = [](void*) noexcept {
+        const auto bits {mem::Allocate(bench_bitmap_bit_count / bit::byte_len)};
+        mem::AssertAlloc(bits);
+        GetBenchBitmap()
+            .Init(bits, bench_bitmap_bit_count / bit::byte_len)
+            .ForceAlloc(0, bench_bitmap_bit_count / 2);
+    };
+
+    bitmap.cleanup = [](void*) noexcept { mem::Free(const_cast<void*>(GetBenchBitmap().GetBits()));
+    };
+    RegisterBenchmark(bitmap);
+
+    const auto alloc_bufs {[](void*) noexcept {
+        auto& bench {GetBufBench()};
+        bench.src = mem::Allocate(bench_buf_size);
+        bench.dest = mem::Allocate(bench_buf_size);
+        mem::AssertAlloc(bench.src);
+        mem::AssertAlloc(bench.dest);
+        stl::memset(bench.src, 0xFF, bench_buf_size);
+    }};
+
+    const auto free_bufs {[](void*) noexcept {
+        auto& bench {GetBufBench()};
+        mem::Free(bench.src);
+        mem::Free(bench.dest);
+        bench = {};
+    }};
+
+    constexpr stl::size_t sector_counts[] {1, 8};
+    for (const auto count : sector_counts) {
+        Benchmark read {"io::Disk::ReadSectors", [](void* const arg) noexcept {
+                            const auto& part {io::GetDefaultPart()};
+                            part.GetDisk().ReadSectors(part.GetStartLba(), GetBufBench().dest,
+                                                       reinterpret_cast<stl::size_t>(arg));
+                        }};
+        read.arg = reinterpret_cast<void*>(count);
+        read.param = count;
+        read.setup = alloc_bufs;
+        read.cleanup = free_bufs;
+        RegisterBenchmark(read);
+    }
+
+    constexpr stl::size_t copy_sizes[] {64, bench_buf_size};
+    for (const auto size : copy_sizes) {
+        Benchmark copy {"stl::memcpy", [](void* const arg) noexcept {
+                            const auto& bench {GetBufBench()};
+                            stl::memcpy(bench.dest, bench.src, reinterpret_cast<stl::size_t>(arg));
+                        }};
+        copy.arg = reinterpret_cast<void*>(size);
+        copy.param = size;
+        copy.setup = alloc_bufs;
+        copy.cleanup = free_bufs;
+        RegisterBenchmark(copy);
+    }
+}
+
+}  // namespace
+
+bool RegisterBenchmark(const Benchmark& bench) noexcept {
+    dbg::Assert(bench.name && bench.op);
+    auto& tab {GetBenchTab()};
+    if (tab.count == tab.benches.size()) {
+        return false;
+    }
+
+    tab.benches[tab.count++] = bench;
+    return true;
+}
+
+void RunBenchmarks() noexcept {
+    RegisterBuiltinBenchmarks();
+    const auto cycles {mem::Allocate<stl::uint32_t>(bench_run_count * sizeof(stl::uint32_t))};
+    mem::AssertAlloc(cycles);
+    const auto overhead {MeasureOverhead(cycles)};
+    io::Printf("Running benchmarks. Reading the time-stamp counter takes {} cycles.\n", overhead);
+    const auto& tab {GetBenchTab()};
+    for (stl::size_t i {0}; i != tab.count; ++i) {
+        Run(tab.benches[i], overhead, cycles);
+    }
+
+    mem::Free(cycles);
+}
+
+}  // namespace dbg
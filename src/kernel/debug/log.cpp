@@ -0,0 +1,164 @@
+#include "kernel/debug/log.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/timer.h"
+#include "kernel/io/video/console.h"
+#include "kernel/io/video/print.h"
+#include "kernel/thread/thd.h"
+#include "kernel/util/bit.h"
+#include "kernel/util/format.h"
+#include "kernel/util/mpsc_queue.h"
+
+namespace dbg {
+
+namespace {
+
+using LogRing = MpscQueue<LogRecord, max_log_record_count>;
+
+/**
+ * @brief A wrapper of a global variable representing the log ring.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+LogRing& GetLogRing() noexcept {
+    static LogRing ring;
+    return ring;
+}
+
+/**
+ * @brief A wrapper of a global @p bool variable representing whether the logger thread has started.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+bool& IsLogInited() noexcept {
+    static bool inited {false};
+    return inited;
+}
+
+//! The number of records dropped because the ring was full.
+stl::size_t dropped_count {0};
+
+stl::string_view GetLevelName(const LogLevel level) noexcept {
+    switch (level) {
+        case LogLevel::Debug:
+            return "DEBUG";
+        case LogLevel::Info:
+            return "INFO";
+        case LogLevel::Warning:
+            return "WARN";
+        case LogLevel::Error:
+            return "ERROR";
+        default:
+            dbg::Assert(false, "Unknown log level.");
+            return nullptr;
+    }
+}
+
+stl::string_view GetMsg(const LogRecord& record) noexcept {
+    return {record.msg.data(), record.msg_len};
+}
+
+void PrintRecord(const LogRecord& record) noexcept {
+    io::Console::Printf("[0x{}] {}: {}\n", record.time, GetLevelName(record.level),
+                        GetMsg(record));
+}
+
+//! The logger thread that prints records to the console.
+void PrintRecords(void*) noexcept {
+    auto& ring {GetLogRing()};
+    stl::size_t reported_dropped_count {0};
+    while (true) {
+        PrintRecord(ring.Pop());
+        if (const auto dropped {GetDroppedLogCount()};
+            dropped != reported_dropped_count && ring.IsEmpty()) {
+            io::Console::Printf("0x{} log records have been dropped.\n",
+                                dropped - reported_dropped_count);
+            reported_dropped_count = dropped;
+        }
+    }
+}
+
+}  // namespace
+
+namespace _log_impl {
+
+void Format(LogRecord& record, const char ch) noexcept {
+    if (record.msg_len != record.msg.size()) {
+        record.msg[record.msg_len++] = ch;
+    }
+}
+
+void Format(LogRecord& record, const stl::string_view str) noexcept {
+    for (const auto ch : str) {
+        Format(record, ch);
+    }
+}
+
+void Format(LogRecord& record, const char* const str) noexcept {
+    dbg::Assert(str);
+    Format(record, stl::string_view {str});
+}
+
+void Format(LogRecord& record, const stl::uint32_t num) noexcept {
+    // Integers are printed in hexadecimal as `io::Printf` does.
+    char digits[sizeof(num) * 2 + 1];
+    Format(record, stl::string_view {digits, ConvertUIntToHexString(digits, num)});
+}
+
+void Format(LogRecord& record, const stl::int32_t num) noexcept {
+    if (num >= 0) {
+        Format(record, static_cast<stl::uint32_t>(num));
+    } else {
+        Format(record, '-');
+        Format(record, static_cast<stl::uint32_t>(-num));
+    }
+}
+
+void Format(LogRecord& record, const stl::uint64_t num) noexcept {
+    const auto high {bit::GetHighDword(num)};
+    const auto low {bit::GetLowDword(num)};
+    if (high == 0) {
+        Format(record, low);
+        return;
+    }
+
+    Format(record, high);
+    // The low double word must keep its leading zeros.
+    char digits[sizeof(low) * 2 + 1];
+    Format(record, stl::string_view {digits, ConvertUIntToHexString(digits, low, sizeof(low) * 2)});
+}
+
+void BeginRecord(LogRecord& record, const LogLevel level) noexcept {
+    record.time = io::IsTimerInited() ? io::GetNanoseconds() : 0;
+    record.level = level;
+    record.msg_len = 0;
+}
+
+void SubmitRecord(const LogRecord& record) noexcept {
+    if (!IsLogInited()) {
+        // Records are printed synchronously during early initialization.
+        // The console is not locked, since it may be called by an interrupt handler.
+        io::Printf("[0x{}] {}: {}\n", record.time, GetLevelName(record.level), GetMsg(record));
+    } else if (!GetLogRing().TryPush(record)) {
+        __atomic_add_fetch(&dropped_count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+}  // namespace _log_impl
+
+stl::size_t GetDroppedLogCount() noexcept {
+    return __atomic_load_n(&dropped_count, __ATOMIC_RELAXED);
+}
+
+void InitLog() noexcept {
+    dbg::Assert(!IsLogInited());
+    dbg::Assert(tsk::IsThreadInited());
+    tsk::KrnlThread::Create("logger", log_thd_priority, &PrintRecords);
+    IsLogInited() = true;
+    io::PrintlnStr("The kernel log has been initialized.");
+}
+
+}  // namespace dbg
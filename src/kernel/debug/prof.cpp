@@ -0,0 +1,202 @@
+#include "kernel/debug/prof.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/pool.h"
+#include "kernel/process/proc.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/thread/thd.h"
+
+namespace dbg {
+
+extern "C" {
+//! Whether the clock interrupt entry in @p src/kernel/interrupt/intr.asm records samples.
+extern stl::uint32_t prof_enabled;
+}
+
+stl::uint32_t prof_enabled {0};
+
+namespace {
+
+//! The maximum number of threads counted by @p DumpProfile.
+constexpr stl::size_t max_prof_thd_count {64};
+
+//! Samples in a ring buffer.
+struct ProfSamples {
+    //! The buffer, allocated when the profiler is enabled for the first time.
+    ProfSample* samples;
+    //! The number of recorded samples, including those that have been overwritten.
+    stl::size_t count;
+};
+
+/**
+ * @brief A wrapper of a global variable saving profiler samples.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+ProfSamples& GetProfSamples() noexcept {
+    static ProfSamples samples {};
+    return samples;
+}
+
+//! The number of samples of a code address.
+struct AddrCount {
+    stl::uintptr_t eip;
+    stl::size_t count;
+    bool usr_mode;
+};
+
+//! The number of samples of a thread.
+struct ThdCount {
+    stl::uintptr_t thd;
+    stl::size_t pid;
+    stl::size_t count;
+};
+
+//! Sort samples by code addresses. The buffer is small, so insertion sort is enough.
+void SortByAddr(ProfSample* const samples, const stl::size_t count) noexcept {
+    for (stl::size_t i {1}; i < count; ++i) {
+        const auto sample {samples[i]};
+        auto j {i};
+        for (; j != 0 && samples[j - 1].eip > sample.eip; --j) {
+            samples[j] = samples[j - 1];
+        }
+
+        samples[j] = sample;
+    }
+}
+
+//! Print code addresses with the most samples in descending order.
+void DumpAddrs(ProfSample* const samples, const stl::size_t count) noexcept {
+    // Merge samples of the same address.
+    SortByAddr(samples, count);
+    const auto addrs {mem::Allocate<AddrCount>(count * sizeof(AddrCount))};
+    mem::AssertAlloc(addrs);
+    stl::size_t addr_count {0};
+    for (stl::size_t i {0}; i != count; ++i) {
+        if (addr_count != 0 && addrs[addr_count - 1].eip == samples[i].eip) {
+            ++addrs[addr_count - 1].count;
+        } else {
+            addrs[addr_count++] = {samples[i].eip, 1, samples[i].usr_mode};
+        }
+    }
+
+    io::Printf("Code addresses: 0x{} in total.\n", addr_count);
+    for (stl::size_t i {0}; i != stl::min(addr_count, max_prof_dump_addr_count); ++i) {
+        // Select the address with the most samples among the rest.
+        auto max {i};
+        for (auto j {i + 1}; j < addr_count; ++j) {
+            if (addrs[j].count > addrs[max].count) {
+                max = j;
+            }
+        }
+
+        stl::swap(addrs[i], addrs[max]);
+        io::Printf("\t0x{} {}: 0x{} samples.\n", addrs[i].eip,
+                   addrs[i].usr_mode ? "user" : "kernel", addrs[i].count);
+    }
+
+    mem::Free(addrs);
+}
+
+//! Print the number of samples of each thread.
+void DumpThds(const ProfSample* const samples, const stl::size_t count) noexcept {
+    stl::array<ThdCount, max_prof_thd_count> thds {};
+    stl::size_t thd_count {0};
+    stl::size_t other_count {0};
+    for (stl::size_t i {0}; i != count; ++i) {
+        auto found {false};
+        for (stl::size_t j {0}; j != thd_count && !found; ++j) {
+            if (thds[j].thd == samples[i].thd) {
+                ++thds[j].count;
+                found = true;
+            }
+        }
+
+        if (found) {
+            continue;
+        } else if (thd_count != thds.size()) {
+            thds[thd_count++] = {samples[i].thd, samples[i].pid, 1};
+        } else {
+            ++other_count;
+        }
+    }
+
+    io::PrintlnStr("Threads:");
+    for (stl::size_t i {0}; i != thd_count; ++i) {
+        io::Printf("\tThread 0x{} of process 0x{}: 0x{} samples.\n", thds[i].thd, thds[i].pid,
+                   thds[i].count);
+    }
+
+    if (other_count != 0) {
+        io::Printf("\tOther threads: 0x{} samples.\n", other_count);
+    }
+}
+
+}  // namespace
+
+void ResetProfiler(const bool enabled) noexcept {
+    auto& samples {GetProfSamples()};
+    if (enabled && !samples.samples) {
+        const auto buf {mem::Allocate<ProfSample>(max_prof_sample_count * sizeof(ProfSample))};
+        mem::AssertAlloc(buf);
+        const intr::IntrGuard guard;
+        if (!samples.samples) {
+            samples.samples = buf;
+        } else {
+            mem::Free(buf);
+        }
+    }
+
+    const intr::IntrGuard guard;
+    samples.count = 0;
+    __atomic_store_n(&prof_enabled, enabled, __ATOMIC_RELEASE);
+}
+
+bool IsProfilerEnabled() noexcept {
+    return __atomic_load_n(&prof_enabled, __ATOMIC_ACQUIRE);
+}
+
+void RecordProfSample(const intr::IntrStack& stack) noexcept {
+    auto& samples {GetProfSamples()};
+    if (!samples.samples) {
+        return;
+    }
+
+    const auto& thd {tsk::Thread::GetCurrent()};
+    const auto proc {thd.GetProcess()};
+    samples.samples[samples.count % max_prof_sample_count] = {
+        stack.old_eip, reinterpret_cast<stl::uintptr_t>(&thd), proc ? proc->GetPid() : 0,
+        (stack.old_cs & 0b11) != 0};
+    ++samples.count;
+}
+
+void DumpProfile() noexcept {
+    const auto copy {mem::Allocate<ProfSample>(max_prof_sample_count * sizeof(ProfSample))};
+    mem::AssertAlloc(copy);
+    stl::size_t count {0};
+    stl::size_t total {0};
+    {
+        // Samples are copied with interrupts disabled, and sorted after interrupts are restored.
+        const intr::IntrGuard guard;
+        const auto& samples {GetProfSamples()};
+        total = samples.count;
+        count = stl::min(total, max_prof_sample_count);
+        if (count != 0) {
+            stl::memcpy(copy, samples.samples, count * sizeof(ProfSample));
+        }
+    }
+
+    io::Printf("Profile: 0x{} samples, 0x{} kept.\n", total, count);
+    if (count != 0) {
+        DumpAddrs(copy, count);
+        DumpThds(copy, count);
+    }
+
+    mem::Free(copy);
+}
+
+}  // namespace dbg
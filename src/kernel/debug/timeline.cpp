@@ -0,0 +1,106 @@
+#include "kernel/debug/timeline.h"
+#include "kernel/debug/assert.h"
+#include "kernel/debug/log.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/io.h"
+#include "kernel/io/timer.h"
+#include "kernel/loader.h"
+#include "kernel/stl/array.h"
+
+namespace dbg {
+
+namespace {
+
+//! The boot timeline.
+struct Timeline {
+    stl::array<BootStage, max_boot_stage_count> stages;
+    stl::size_t count;
+    //! Whether the timeline has been logged.
+    bool logged;
+    //! Whether the first user process has entered user mode.
+    bool usr_proc_started;
+};
+
+/**
+ * @brief A wrapper of a global variable representing the boot timeline.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+Timeline& GetTimeline() noexcept {
+    static Timeline timeline {};
+    return timeline;
+}
+
+void AddStage(const char* const name, const stl::uint64_t tsc) noexcept {
+    auto& timeline {GetTimeline()};
+    if (timeline.count != timeline.stages.size()) {
+        timeline.stages[timeline.count++] = {name, tsc};
+    }
+}
+
+//! Log a stage with the duration from the previous stage.
+void LogStage(const stl::size_t idx) noexcept {
+    const auto& stages {GetTimeline().stages};
+    const auto& stage {stages[idx]};
+    const auto prev_tsc {idx != 0 ? stages[idx - 1].tsc : 0};
+    const auto end {io::ConvertTscToMicroseconds(stage.tsc)};
+    const auto duration {io::ConvertTscToMicroseconds(stage.tsc - prev_tsc)};
+    Log(LogLevel::Info, "Boot stage '{}' finished at {} us, taking {} us.", stage.name, end,
+        duration);
+}
+
+}  // namespace
+
+void InitBootTimeline() noexcept {
+    // The BIOS runs from the processor reset, when the time-stamp counter is zero.
+    const auto& loader_data {GetLoaderData()};
+    AddStage("BIOS", loader_data.mbr_tsc);
+    AddStage("Master boot record", loader_data.loader_tsc);
+    AddStage("Loader", loader_data.krnl_tsc);
+}
+
+void MarkBootStage(const char* const name) noexcept {
+    dbg::Assert(name);
+    const auto tsc {io::ReadTsc()};
+    const intr::IntrGuard guard;
+    auto& timeline {GetTimeline()};
+    const auto idx {timeline.count};
+    AddStage(name, tsc);
+    if (timeline.logged && idx != timeline.count) {
+        LogStage(idx);
+    }
+}
+
+void MarkFirstUsrProc() noexcept {
+    {
+        const intr::IntrGuard guard;
+        auto& timeline {GetTimeline()};
+        if (timeline.usr_proc_started) {
+            return;
+        }
+
+        timeline.usr_proc_started = true;
+    }
+
+    MarkBootStage("First user process");
+}
+
+void LogBootTimeline() noexcept {
+    const intr::IntrGuard guard;
+    auto& timeline {GetTimeline()};
+    dbg::Assert(!timeline.logged);
+    for (stl::size_t i {0}; i != timeline.count; ++i) {
+        LogStage(i);
+    }
+
+    timeline.logged = true;
+}
+
+stl::span<BootStage> GetBootStages() noexcept {
+    auto& timeline {GetTimeline()};
+    return {timeline.stages.data(), timeline.count};
+}
+
+}  // namespace dbg
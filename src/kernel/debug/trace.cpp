@@ -0,0 +1,218 @@
+#include "kernel/debug/trace.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/io.h"
+#include "kernel/io/serial.h"
+#include "kernel/io/timer.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/thread/thd.h"
+#include "kernel/util/bit.h"
+#include "kernel/util/format.h"
+
+namespace dbg {
+
+stl::uint32_t trace_enabled {0};
+
+namespace {
+
+extern "C" {
+/**
+ * @brief Get the current running thread, defined in @p src/kernel/thread/thd.asm.
+ *
+ * @details
+ * It is used instead of @p tsk::Thread::GetCurrent, which may be instrumented and call the trace again.
+ */
+tsk::Thread& GetCurrThread() noexcept;
+}
+
+//! The maximum length of a line of a dumped record.
+constexpr stl::size_t max_trace_line_len {64};
+
+//! The interval to wait for the transmit queue of the serial port.
+constexpr stl::size_t trace_dump_poll_interval {1};
+
+//! Event names printed by @p DumpTrace, indexed by @p TraceEvent.
+constexpr const char* trace_event_names[] {
+    "switch",     "intr_enter", "intr_exit",  "sys_enter",  "sys_exit",
+    "read_enter", "read_exit",  "write_enter", "write_exit", "alloc",
+    "func_enter", "func_exit"};
+
+static_assert(sizeof(trace_event_names) / sizeof(trace_event_names[0])
+              == static_cast<stl::size_t>(TraceEvent::Count));
+
+//! Records in a ring buffer.
+struct TraceRing {
+    //! The buffer, allocated when the trace is enabled for the first time.
+    TraceRecord* records;
+    //! The number of reserved records, including those that have been overwritten.
+    stl::size_t count;
+};
+
+/**
+ * @brief A wrapper of a global variable saving trace records.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ *
+ * Only one processor runs the kernel, so there is only one ring buffer.
+ */
+TraceRing& GetTraceRing() noexcept {
+    static TraceRing ring {};
+    return ring;
+}
+
+//! Append a string to a line and return its length.
+stl::size_t AppendStr(char* const line, const char* const str) noexcept {
+    stl::size_t len {0};
+    for (; str[len] != '\0'; ++len) {
+        line[len] = str[len];
+    }
+
+    return len;
+}
+
+//! Append a hexadecimal integer of 16 digits to a line and return its length.
+stl::size_t AppendHex64(char* const line, const stl::uint64_t num) noexcept {
+    const auto len {ConvertUIntToHexString(line, bit::GetHighDword(num), 8)};
+    return len + ConvertUIntToHexString(line + len, bit::GetLowDword(num), 8);
+}
+
+//! Format a record as a line and return its length.
+stl::size_t FormatRecord(char* const line, const TraceRecord& record) noexcept {
+    const auto event {static_cast<stl::size_t>(record.event)};
+    auto len {AppendHex64(line, record.tsc)};
+    line[len++] = ' ';
+    len += AppendStr(line + len, event < static_cast<stl::size_t>(TraceEvent::Count)
+                                     ? trace_event_names[event]
+                                     : "unknown");
+    const stl::uint32_t nums[] {record.thd, record.arg1, record.arg2};
+    for (const auto num : nums) {
+        line[len++] = ' ';
+        len += ConvertUIntToHexString(line + len, num, 8);
+    }
+
+    line[len++] = '\n';
+    dbg::Assert(len < max_trace_line_len);
+    return len;
+}
+
+//! Write a line to the serial port, waiting until its transmit queue has enough space.
+void WriteLine(const char* const line, const stl::size_t len) noexcept {
+    auto& port {io::GetSerialPort()};
+    while (true) {
+        {
+            const intr::IntrGuard guard;
+            // A line feed is sent with a carriage return.
+            if (port.GetFreeCount() > len) {
+                port.PutStr({line, len}).Flush();
+                return;
+            }
+
+            port.Flush();
+        }
+
+        tsk::Thread::GetCurrent().Sleep(trace_dump_poll_interval);
+    }
+}
+
+}  // namespace
+
+namespace _trace_impl {
+
+void Record(const TraceEvent event, const stl::uint32_t arg1, const stl::uint32_t arg2) noexcept {
+    auto& ring {GetTraceRing()};
+    if (!ring.records) {
+        return;
+    }
+
+    // Reserving a record by an atomic operation allows interrupt handlers to record events at any time.
+    const auto idx {__atomic_fetch_add(&ring.count, 1, __ATOMIC_RELAXED)};
+    ring.records[idx % trace_record_count] = {
+        io::ReadTsc(), reinterpret_cast<stl::uint32_t>(&GetCurrThread()), event, 0, arg1, arg2};
+}
+
+}  // namespace _trace_impl
+
+extern "C" {
+/**
+ * @brief Record the entry of an instrumented function.
+ *
+ * @details
+ * It is called by code compiled with @p -finstrument-functions.
+ * This file is not instrumented, and the flag is checked directly instead of by inline functions,
+ * whose shared copies may be instrumented and call the hook recursively.
+ */
+[[gnu::no_instrument_function]] void __cyg_profile_func_enter(void* const func,
+                                                               void* const call_site) noexcept {
+    if (__atomic_load_n(&trace_enabled, __ATOMIC_RELAXED) != 0) {
+        _trace_impl::Record(TraceEvent::FuncEnter, reinterpret_cast<stl::uint32_t>(func),
+                            reinterpret_cast<stl::uint32_t>(call_site));
+    }
+}
+
+//! Record the exit of an instrumented function.
+[[gnu::no_instrument_function]] void __cyg_profile_func_exit(void* const func,
+                                                              void* const call_site) noexcept {
+    if (__atomic_load_n(&trace_enabled, __ATOMIC_RELAXED) != 0) {
+        _trace_impl::Record(TraceEvent::FuncExit, reinterpret_cast<stl::uint32_t>(func),
+                            reinterpret_cast<stl::uint32_t>(call_site));
+    }
+}
+}
+
+bool ResetTrace(const bool enabled) noexcept {
+    if constexpr (!krnl_trace_enabled) {
+        return false;
+    }
+
+    auto& ring {GetTraceRing()};
+    if (enabled && !ring.records) {
+        const auto buf {mem::Allocate<TraceRecord>(trace_record_count * sizeof(TraceRecord))};
+        mem::AssertAlloc(buf);
+        const intr::IntrGuard guard;
+        if (!ring.records) {
+            ring.records = buf;
+        } else {
+            mem::Free(buf);
+        }
+    }
+
+    const intr::IntrGuard guard;
+    ring.count = 0;
+    __atomic_store_n(&trace_enabled, enabled, __ATOMIC_RELEASE);
+    return enabled;
+}
+
+void DumpTrace() noexcept {
+    stl::size_t total {0};
+    {
+        const intr::IntrGuard guard;
+        __atomic_store_n(&trace_enabled, false, __ATOMIC_RELEASE);
+        total = GetTraceRing().count;
+    }
+
+    const auto& ring {GetTraceRing()};
+    if (!io::GetSerialPort().IsPresent() || !ring.records) {
+        return;
+    }
+
+    const auto count {stl::min(total, trace_record_count)};
+    char line[max_trace_line_len];
+    auto len {AppendStr(line, "trace ")};
+    len += AppendHex64(line + len, io::GetTscFreq());
+    line[len++] = ' ';
+    len += ConvertUIntToHexString(line + len, count);
+    line[len++] = ' ';
+    len += ConvertUIntToHexString(line + len, total - count);
+    line[len++] = '\n';
+    WriteLine(line, len);
+
+    // Records are written from the oldest one.
+    for (auto i {total - count}; i != total; ++i) {
+        WriteLine(line, FormatRecord(line, ring.records[i % trace_record_count]));
+    }
+}
+
+}  // namespace dbg
@@ -0,0 +1,277 @@
+#include "kernel/interrupt/apic.h"
+#include "kernel/cpu/mp.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/io.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/mutex.h"
+#include "kernel/util/bit.h"
+
+namespace intr::apic {
+
+namespace {
+
+//! The @p APIC bit of the feature flags in @p EDX returned by @p cpuid, indicating an on-chip local APIC.
+inline constexpr stl::uint32_t cpu_feature_apic {1 << 9};
+
+extern "C" {
+//! Get the feature flags in @p EDX returned by @p cpuid with `EAX = 1`.
+stl::uint32_t GetCpuFeatures() noexcept;
+
+/**
+ * @brief The virtual address of the end-of-interrupt register of the local APIC.
+ *
+ * @details
+ * If it is zero, interrupt entries in @p src/kernel/interrupt/intr.asm send end-of-interrupt signals to *Intel 8259A*.
+ */
+extern stl::uintptr_t local_apic_eoi_reg;
+}
+
+stl::uintptr_t local_apic_eoi_reg {0};
+
+//! Local APIC registers, as offsets from its base address.
+namespace local_reg {
+inline constexpr stl::size_t id {0x20};
+//! The task priority register.
+inline constexpr stl::size_t tpr {0x80};
+//! The end-of-interrupt register.
+inline constexpr stl::size_t eoi {0xB0};
+//! The spurious interrupt vector register.
+inline constexpr stl::size_t svr {0xF0};
+//! The local vector table entry of the timer.
+inline constexpr stl::size_t lvt_timer {0x320};
+//! The local vector table entry of the pin @p LINT0.
+inline constexpr stl::size_t lvt_lint0 {0x350};
+//! The local vector table entry of errors.
+inline constexpr stl::size_t lvt_error {0x370};
+//! The initial count register of the timer.
+inline constexpr stl::size_t timer_init_count {0x380};
+//! The current count register of the timer.
+inline constexpr stl::size_t timer_curr_count {0x390};
+//! The divide configuration register of the timer.
+inline constexpr stl::size_t timer_divide {0x3E0};
+}  // namespace local_reg
+
+//! I/O APIC registers, which are accessed indirectly through the select and window registers.
+namespace io_reg {
+//! The register selecting an indirect register.
+inline constexpr stl::size_t select {0x00};
+//! The register reading or writing the selected register.
+inline constexpr stl::size_t window {0x10};
+//! The version register, containing the maximum index of redirection entries.
+inline constexpr stl::uint32_t ver {0x01};
+//! The first redirection entry. Each entry has a low and a high double word.
+inline constexpr stl::uint32_t redir_tab {0x10};
+}  // namespace io_reg
+
+//! The bit enabling the local APIC in the spurious interrupt vector register.
+inline constexpr stl::uint32_t svr_enabled {1 << 8};
+//! The bit masking a local vector table entry or a redirection entry.
+inline constexpr stl::uint32_t intr_masked {1 << 16};
+//! The bit selecting the periodic mode in the local vector table entry of the timer.
+inline constexpr stl::uint32_t timer_periodic {1 << 17};
+//! The value of the divide configuration register dividing the bus frequency by @p 16.
+inline constexpr stl::uint32_t timer_divide_by_16 {0b0011};
+//! The position of the destination field in the high double word of a redirection entry.
+inline constexpr stl::size_t redir_dest_pos {24};
+//! The position of the local APIC ID in the ID register.
+inline constexpr stl::size_t local_apic_id_pos {24};
+
+/**
+ * @brief The interrupt number of spurious interrupts from the local APIC.
+ *
+ * @details
+ * It is the same as the spurious interrupt of the master *Intel 8259A* chip,
+ * which is not used by any device and already ignored by the default interrupt handler.
+ * Processors before *Pentium 4* force the lowest four bits of the vector to ones.
+ */
+inline constexpr stl::size_t spurious_intr_num {0x27};
+
+//! The interrupt mode configuration register.
+namespace imcr {
+//! The register selecting the interrupt mode configuration register.
+inline constexpr stl::uint16_t select_port {0x22};
+//! The data register of the interrupt mode configuration register.
+inline constexpr stl::uint16_t data_port {0x23};
+//! The index of the interrupt mode configuration register.
+inline constexpr stl::uint8_t idx {0x70};
+//! Connect interrupts from *Intel 8259A* to APICs instead of processors.
+inline constexpr stl::uint8_t apic_mode {0x01};
+}  // namespace imcr
+
+//! Virtual base addresses of mapped APIC registers.
+struct ApicRegs {
+    stl::uintptr_t local_apic;
+    stl::uintptr_t io_apic;
+};
+
+/**
+ * @brief A wrapper of a global variable representing mapped APIC registers.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+ApicRegs& GetApicRegs() noexcept {
+    static ApicRegs regs {};
+    return regs;
+}
+
+stl::uint32_t ReadLocalReg(const stl::size_t reg) noexcept {
+    return *reinterpret_cast<const volatile stl::uint32_t*>(GetApicRegs().local_apic + reg);
+}
+
+void WriteLocalReg(const stl::size_t reg, const stl::uint32_t val) noexcept {
+    *reinterpret_cast<volatile stl::uint32_t*>(GetApicRegs().local_apic + reg) = val;
+}
+
+stl::uint32_t ReadIoReg(const stl::uint32_t reg) noexcept {
+    // The select and window registers must be accessed together.
+    const IntrGuard guard;
+    const auto base {GetApicRegs().io_apic};
+    *reinterpret_cast<volatile stl::uint32_t*>(base + io_reg::select) = reg;
+    return *reinterpret_cast<const volatile stl::uint32_t*>(base + io_reg::window);
+}
+
+void WriteIoReg(const stl::uint32_t reg, const stl::uint32_t val) noexcept {
+    const IntrGuard guard;
+    const auto base {GetApicRegs().io_apic};
+    *reinterpret_cast<volatile stl::uint32_t*>(base + io_reg::select) = reg;
+    *reinterpret_cast<volatile stl::uint32_t*>(base + io_reg::window) = val;
+}
+
+//! Get the register index of the low double word of a redirection entry.
+constexpr stl::uint32_t GetRedirReg(const stl::size_t pin) noexcept {
+    return io_reg::redir_tab + pin * 2;
+}
+
+/**
+ * @brief Map a page of memory-mapped registers into kernel space.
+ *
+ * @return The virtual address of the physical address.
+ */
+stl::uintptr_t MapRegs(const stl::uintptr_t phy_addr) noexcept {
+    stl::uintptr_t vr_addr {0};
+    {
+        auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::Kernel)};
+        const stl::lock_guard guard {mem_pool.GetLock()};
+        vr_addr = mem::GetVrAddrPool(mem::PoolType::Kernel).AllocPages();
+    }
+
+    mem::AssertAlloc(vr_addr);
+    // Registers have side effects, so they must not be cached.
+    mem::VrAddr {vr_addr}
+        .MapToPhyAddr(mem::AlignToPageBase(phy_addr))
+        .GetPageTabEntry()
+        .SetCacheDisabled()
+        .SetWriteThrough();
+    mem::VrAddr {vr_addr}.FlushTlb();
+    return vr_addr + phy_addr % mem::page_size;
+}
+
+//! Get the interrupt number of an interrupt request.
+constexpr stl::size_t GetIntrNum(const pic::Intr intr) noexcept {
+    return static_cast<stl::size_t>(Intr::Clock) + static_cast<stl::size_t>(intr);
+}
+
+//! Get the input pin of the I/O APIC connected to an interrupt request.
+stl::size_t GetIoApicPin(const pic::Intr intr) noexcept {
+    const auto irq {static_cast<stl::size_t>(intr)};
+    dbg::Assert(irq < cpu::isa_irq_count);
+    return cpu::GetMpInfo().isa_irq_pins[irq];
+}
+
+void InitLocalApic() noexcept {
+    // Deliver all interrupts.
+    WriteLocalReg(local_reg::tpr, 0);
+    // Interrupts from Intel 8259A are no longer needed, since it is masked.
+    WriteLocalReg(local_reg::lvt_lint0, intr_masked);
+    WriteLocalReg(local_reg::lvt_error, intr_masked);
+    WriteLocalReg(local_reg::timer_divide, timer_divide_by_16);
+    WriteLocalReg(local_reg::lvt_timer, intr_masked | GetIntrNum(pic::Intr::Clock));
+    WriteLocalReg(local_reg::svr, svr_enabled | spurious_intr_num);
+    // Clear any interrupt accepted before.
+    WriteLocalReg(local_reg::eoi, 0);
+}
+
+void InitIoApic(const stl::span<pic::Intr> intrs) noexcept {
+    // Mask all pins first and enable only the ones we want.
+    const auto max_pin {bit::GetBits(ReadIoReg(io_reg::ver), 16, 8)};
+    for (stl::size_t pin {0}; pin <= max_pin; ++pin) {
+        WriteIoReg(GetRedirReg(pin), intr_masked);
+    }
+
+    const auto apic_id {GetLocalApicId()};
+    for (const auto intr : intrs) {
+        // The clock interrupt comes from the local APIC timer, and the I/O APIC does not cascade.
+        if (intr == pic::Intr::Clock || intr == pic::Intr::SlavePic) {
+            continue;
+        }
+
+        const auto pin {GetIoApicPin(intr)};
+        dbg::Assert(pin <= max_pin);
+        // ISA interrupts are edge-triggered and active-high, and delivered to a fixed processor.
+        WriteIoReg(GetRedirReg(pin) + 1, static_cast<stl::uint32_t>(apic_id) << redir_dest_pos);
+        WriteIoReg(GetRedirReg(pin), GetIntrNum(intr));
+    }
+}
+
+}  // namespace
+
+bool InitApic(const stl::span<pic::Intr> intrs) noexcept {
+    dbg::Assert(!IsIntrEnabled());
+    dbg::Assert(!IsApicEnabled());
+    const auto& info {cpu::GetMpInfo()};
+    if (!apic_preferred || (GetCpuFeatures() & cpu_feature_apic) == 0 || info.io_apic_addr == 0) {
+        return false;
+    }
+
+    auto& regs {GetApicRegs()};
+    regs.local_apic = MapRegs(info.local_apic_addr);
+    regs.io_apic = MapRegs(info.io_apic_addr);
+
+    pic::DisablePgmIntrCtrl();
+    if (info.imcr_present) {
+        // Disconnect Intel 8259A from the processor.
+        io::WriteByteToPort(imcr::select_port, imcr::idx);
+        io::WriteByteToPort(imcr::data_port, imcr::apic_mode);
+    }
+
+    InitLocalApic();
+    InitIoApic(intrs);
+    local_apic_eoi_reg = regs.local_apic + local_reg::eoi;
+    io::Printf("Local APIC 0x{} and I/O APIC 0x{} have been initialized.\n", GetLocalApicId(),
+               info.io_apic_id);
+    return true;
+}
+
+bool IsApicEnabled() noexcept {
+    return local_apic_eoi_reg != 0;
+}
+
+stl::uint8_t GetLocalApicId() noexcept {
+    dbg::Assert(GetApicRegs().local_apic != 0);
+    return static_cast<stl::uint8_t>(ReadLocalReg(local_reg::id) >> local_apic_id_pos);
+}
+
+void StartTimer(const TimerMode mode, const stl::uint32_t count) noexcept {
+    dbg::Assert(IsApicEnabled());
+    dbg::Assert(count > 0);
+    auto lvt {static_cast<stl::uint32_t>(GetIntrNum(pic::Intr::Clock))};
+    if (mode == TimerMode::Periodic) {
+        lvt |= timer_periodic;
+    }
+
+    // Writing the initial count starts the timer.
+    WriteLocalReg(local_reg::lvt_timer, lvt);
+    WriteLocalReg(local_reg::timer_init_count, count);
+}
+
+stl::uint32_t ReadTimer() noexcept {
+    dbg::Assert(IsApicEnabled());
+    return ReadLocalReg(local_reg::timer_curr_count);
+}
+
+}  // namespace intr::apic
@@ -1,4 +1,5 @@
 %include "kernel/util/metric.inc"
+%include "kernel/selector/sel.inc"
 
 ; Interrupt handlers, defined in `src/interrupt/intr.cpp`.
 ; ```c++
@@ -9,10 +10,47 @@ extern      intr_handlers
 ; System call handlers, defined in `src/syscall/call.cpp`.
 ; Developers should register kernel APIs here so they can be called in user mode.
 ; ```c++
-; std::int32_t Handler(void* arg) noexcept;
+; std::int32_t Handler(std::uintptr_t arg1, ..., std::uintptr_t arg5) noexcept;
 ; ```
 extern      sys_call_handlers
 
+; Whether statistics of interrupts are recorded, defined in `src/kernel/interrupt/intr.cpp`.
+extern      intr_stats_enabled
+
+; Call an interrupt handler, record its statistics and trace events, defined in `src/kernel/interrupt/intr.cpp`.
+; ```c++
+; void DispatchIntrWithStats(std::size_t intr_num) noexcept;
+; ```
+extern      DispatchIntrWithStats
+
+; Whether tracepoints record events, defined in `src/kernel/debug/trace.cpp`.
+extern      trace_enabled
+
+; Whether the clock interrupt records samples for the sampling profiler, defined in `src/kernel/debug/prof.cpp`.
+extern      prof_enabled
+
+; Record a sample of the interrupted code, defined in `src/kernel/debug/prof.cpp`.
+; ```c++
+; void RecordProfSample(const IntrStack& stack) noexcept;
+; ```
+extern      RecordProfSample
+
+; The virtual address of the end-of-interrupt register of the local APIC, defined in `src/kernel/interrupt/apic.cpp`.
+; It is zero if Intel 8259A is the interrupt controller.
+extern      local_apic_eoi_reg
+
+; The return address of fast system calls, defined in `src/kernel/syscall/call.asm`.
+extern      sys_enter_return
+
+; Whether statistics of system calls are recorded, defined in `src/kernel/syscall/call.cpp`.
+extern      sys_call_stats_enabled
+
+; Call a system call handler, record its statistics and trace events, defined in `src/kernel/syscall/call.cpp`.
+; ```c++
+; std::int32_t DispatchSysCallWithStats(std::uintptr_t arg1, ..., std::uintptr_t arg5, std::size_t func) noexcept;
+; ```
+extern      DispatchSysCallWithStats
+
 ; The command register for the master Intel 8259A chip.
 pic_master_cmd_port     equ     0x20
 ; The data register for the master Intel 8259A chip.
@@ -25,12 +63,43 @@ pic_slave_data_port     equ     0xA1
 ; The end-of-interrupt signal.
 pic_op_cmd_word2_eoi    equ     0b0010_0000
 
+; The interrupt number of clock interrupts.
+clock_intr_num          equ     0x20
+
 ; Some interrupts have an error code.
 ; It is pushed onto the stack by the CPU when the interrupt occurs.
 ; To simplify the code, we push a zero if the CPU does not push an error code.
 %define     error_code      nop
 %define     zero            push    0
 
+; Call the system call handler indexed by `EAX` with arguments in `EBX`, `ECX`, `EDX`, `ESI` and `EDI`.
+; A handler with fewer parameters ignores the remaining ones.
+; If statistics or tracepoints are enabled, the handler is called by `DispatchSysCallWithStats` with the index as the last argument.
+%macro      call_sys_call_handler 0
+    cmp     dword [sys_call_stats_enabled], 0
+    jne     %%stats
+    cmp     dword [trace_enabled], 0
+    jne     %%stats
+    push    edi
+    push    esi
+    push    edx
+    push    ecx
+    push    ebx
+    call    [sys_call_handlers + eax * B(4)]
+    add     esp, B(4) * 5
+    jmp     %%end
+%%stats:
+    push    eax
+    push    edi
+    push    esi
+    push    edx
+    push    ecx
+    push    ebx
+    call    DispatchSysCallWithStats
+    add     esp, B(4) * 6
+%%end:
+%endmacro
+
 ; Create an entry point of an interrupt handler.
 ; `%1`: An interrupt number.
 ; `%2`: `error_code` if the interrupt has an error code. Otherwise `zero`.
@@ -50,14 +119,42 @@ Intr%1HandlerEntry:
     pushad
 
     ; Send end-of-interrupt signals.
+    ; If APICs are used, writing to the memory-mapped register is cheaper than two port writes.
+    mov     eax, [local_apic_eoi_reg]
+    test    eax, eax
+    jz      %%pic_eoi
+    mov     dword [eax], 0
+    jmp     %%eoi_end
+%%pic_eoi:
     mov     al, pic_op_cmd_word2_eoi
     out     pic_slave_cmd_port, al
     out     pic_master_cmd_port, al
+%%eoi_end:
 
     ; Push the interrupt number.
+    ; If statistics or tracepoints are enabled, the handler is called by `DispatchIntrWithStats`.
     push    %1
+
+%if %1 == clock_intr_num
+    ; Record the interrupted code if the profiler is enabled.
+    ; `ESP` points to the saved registers, which have the layout of `IntrStack`.
+    cmp     dword [prof_enabled], 0
+    je      %%prof_end
+    push    esp
+    call    RecordProfSample
+    add     esp, B(4)
+%%prof_end:
+%endif
+
+    cmp     dword [intr_stats_enabled], 0
+    jne     %%stats
+    cmp     dword [trace_enabled], 0
+    jne     %%stats
     call    [intr_handlers + %1 * B(4)]
     jmp     intr_exit
+%%stats:
+    call    DispatchIntrWithStats
+    jmp     intr_exit
 
 section     .data
     ; The address of the entry point.
@@ -127,8 +224,8 @@ sys_call_intr_num       equ     0x30
 
 section     .text
 ; The entry point of system calls (The method `SysCall` in `src/kernel/syscall/call.asm`).
-; `ECX` = The index of an system call.
-; `EAX` = A user-defined argument.
+; `EAX` = The index of an system call.
+; `EBX`, `ECX`, `EDX`, `ESI`, `EDI` = Up to five user-defined arguments.
 SysCallEntry:
     ; Some segment and flag registers are already pushed onto the stack by the CPU.
     push    0
@@ -140,10 +237,8 @@ SysCallEntry:
     pushad
     push    sys_call_intr_num
 
-    ; Call a handler.
-    push    eax
-    call    [sys_call_handlers + ecx * B(4)]
-    add     esp, B(4)
+    ; Call a handler with arguments in registers.
+    call_sys_call_handler
     ; Copy the `EAX` value to the position of `EAX` in the saved register context,
     ; so users can get the return value after registers are restored.
     mov     [esp + B(4) * 8], eax
@@ -152,6 +247,59 @@ SysCallEntry:
 section     .data
     dd      SysCallEntry
 
+section     .text
+global      SysEnterEntry
+; The entry point of fast system calls by `sysenter` (The method `SysCall` in `src/kernel/syscall/call.asm`).
+; `EAX` = The index of an system call.
+; `EBX`, `ECX`, `EDX`, `ESI`, `EDI` = Up to five user-defined arguments.
+; `EBP` = The user stack pointer.
+; The user return address is always `sys_enter_return`.
+;
+; `sysenter` does not save anything, so we push the same registers as an interrupt from user mode.
+; Then methods using the interrupt stack, such as `Fork`, also work for fast system calls.
+; But the return path skips the interrupt exit and `iret`.
+SysEnterEntry:
+    ; `SYSENTER_ESP` points to `esp0` in the task state segment,
+    ; which is the kernel stack of the current thread.
+    mov     esp, [esp]
+    ; Push the user stack, flags and return address as the CPU does for an interrupt.
+    push    sel_sysenter_usr_stack
+    push    ebp
+    pushfd
+    ; `sysenter` has disabled interrupts, but they were enabled in user mode.
+    or      dword [esp], 1 << 9
+    push    sel_sysenter_usr_code
+    push    sys_enter_return
+    push    0
+    ; Save registers.
+    push    ds
+    push    es
+    push    fs
+    push    gs
+    pushad
+    push    sys_call_intr_num
+
+    ; Call a handler with arguments in registers.
+    call_sys_call_handler
+
+    ; Ignore the interrupt number.
+    add     esp, B(4)
+    ; Restore registers except `EAX`, which is the returned value.
+    mov     [esp + B(4) * 7], eax
+    popad
+    pop     gs
+    pop     fs
+    pop     es
+    pop     ds
+    ; Ignore the error code.
+    add     esp, B(4)
+    ; `sysexit` jumps to `EDX` with the user stack `ECX`.
+    mov     edx, [esp]
+    mov     ecx, [esp + B(4) * 3]
+    ; `sti` enables interrupts after the next instruction, so no interrupt occurs before returning to user mode.
+    sti
+    sysexit
+
 section     .text
 global      intr_exit
 intr_exit:
@@ -1,8 +1,12 @@
 #include "kernel/interrupt/intr.h"
+#include "kernel/debug/trace.h"
+#include "kernel/interrupt/apic.h"
 #include "kernel/interrupt/pic.h"
 #include "kernel/io/io.h"
 #include "kernel/io/video/print.h"
 #include "kernel/selector/sel.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/thread/thd.h"
 
 namespace intr {
 
@@ -34,10 +38,27 @@ extern stl::uintptr_t intr_entries[count];
 //! Set the interrupt descriptor table register.
 void SetIntrDescTabReg(stl::uint16_t limit, stl::uintptr_t base) noexcept;
 
+//! Whether interrupt entries in @p src/interrupt/intr.asm record statistics.
+extern stl::uint32_t intr_stats_enabled;
+
 //! Get the interrupt descriptor table register.
 void GetIntrDescTabReg(desc::DescTabReg&) noexcept;
 }
 
+stl::uint32_t intr_stats_enabled {0};
+
+/**
+ * @brief A wrapper of a global variable representing statistics of interrupts.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+stl::array<IntrStats, count>& GetStatsTab() noexcept {
+    static stl::array<IntrStats, count> stats {};
+    return stats;
+}
+
 void SetIntrDescTabReg(const desc::DescTabReg& reg) noexcept {
     SetIntrDescTabReg(reg.GetLimit(), reg.GetBase());
 }
@@ -60,6 +81,14 @@ void InitIntrDescTab() noexcept {
         sel::krnl_code, intr_entries[sys_call], {desc::SysType::Intr32, Privilege::Three}};
 }
 
+//! Get the interrupt requests of devices to be enabled.
+stl::span<pic::Intr> GetHardwareIntrs() noexcept {
+    static const pic::Intr intrs[] {pic::Intr::Keyboard,       pic::Intr::Clock,
+                                    pic::Intr::SlavePic,       pic::Intr::Com1,
+                                    pic::Intr::PrimaryIdeChnl, pic::Intr::SecondaryIdeChnl};
+    return {intrs, sizeof(intrs) / sizeof(pic::Intr)};
+}
+
 void RegisterIntrHandlers() noexcept {
     GetIntrHandlerTab()
         .Register(0x00, "#DE Divide Error")
@@ -69,7 +98,7 @@ void RegisterIntrHandlers() noexcept {
         .Register(0x04, "#OF Overflow Exception")
         .Register(0x05, "#BR Bound Range Exceeded Exception")
         .Register(0x06, "#UD Invalid Opcode Exception")
-        .Register(0x07, "#NM Device Not Available Exception")
+        .Register(Intr::DeviceNotAvailable, "#NM Device Not Available Exception")
         .Register(0x08, "#DF Double Fault Exception")
         .Register(0x09, "Coprocessor Segment Overrun")
         .Register(0x0A, "#TS Invalid TSS Exception")
@@ -87,6 +116,38 @@ void RegisterIntrHandlers() noexcept {
 
 Handler intr_handlers[count] {};
 
+/**
+ * @brief Call an interrupt handler, record its statistics and trace events.
+ *
+ * @details
+ * It is called by interrupt entries instead of the handler when statistics or tracepoints are enabled.
+ */
+extern "C" void DispatchIntrWithStats(const stl::size_t intr_num) noexcept {
+    dbg::Assert(intr_num < count);
+    auto& thd {tsk::Thread::GetCurrent()};
+    const auto nested {thd.OnIntrEntered() != 0};
+    dbg::Trace<dbg::TraceEvent::IntrEnter>(intr_num);
+    const auto begin {io::ReadTsc()};
+    intr_handlers[intr_num](intr_num);
+    const auto cycles {io::ReadTsc() - begin};
+    dbg::Trace<dbg::TraceEvent::IntrExit>(intr_num);
+    thd.OnIntrExited();
+    if (!IsIntrStatsEnabled()) {
+        return;
+    }
+
+    // The handler may have enabled interrupts or switched threads.
+    const IntrGuard guard;
+    auto& stats {GetStatsTab()[intr_num]};
+    ++stats.count;
+    if (nested) {
+        ++stats.nested_count;
+    }
+
+    stats.total_cycles += cycles;
+    stats.max_cycles = stl::max(stats.max_cycles, cycles);
+}
+
 desc::DescTabReg GetIntrDescTabReg() noexcept {
     desc::DescTabReg reg;
     GetIntrDescTabReg(reg);
@@ -102,13 +163,15 @@ void InitIntr() noexcept {
     InitIntrDescTab();
     RegisterIntrHandlers();
 
-    const pic::Intr intrs[] {pic::Intr::Keyboard, pic::Intr::Clock, pic::Intr::SlavePic,
-                             pic::Intr::PrimaryIdeChnl, pic::Intr::SecondaryIdeChnl};
-    pic::InitPgmIntrCtrl({intrs, sizeof(intrs) / sizeof(pic::Intr)});
+    pic::InitPgmIntrCtrl(GetHardwareIntrs());
     SetIntrDescTabReg(GetIntrDescTab().BuildReg());
     io::PrintlnStr("The interrupt descriptor table has been initialized.");
 }
 
+void SwitchToApic() noexcept {
+    apic::InitApic(GetHardwareIntrs());
+}
+
 extern "C" {
 
 bool IsIntrEnabled() noexcept {
@@ -131,6 +194,7 @@ IntrGuard::~IntrGuard() noexcept {
 void DefaultIntrHandler(const stl::size_t intr_num) noexcept {
     if (intr_num == 0x27 || intr_num == 0x2F) {
         // Ignore spurious interrupts.
+        ++GetStatsTab()[intr_num].spurious_count;
         return;
     }
 
@@ -144,4 +208,44 @@ void DefaultIntrHandler(const stl::size_t intr_num) noexcept {
     }
 }
 
-}  // namespace intr
\ No newline at end of file
+void ResetIntrStats(const bool enabled) noexcept {
+    const IntrGuard guard;
+    for (auto& stats : GetStatsTab()) {
+        stats = {};
+    }
+
+    __atomic_store_n(&intr_stats_enabled, enabled, __ATOMIC_RELEASE);
+}
+
+bool IsIntrStatsEnabled() noexcept {
+    return __atomic_load_n(&intr_stats_enabled, __ATOMIC_ACQUIRE);
+}
+
+bool GetIntrStats(const stl::size_t intr_num, IntrStats* const stats) noexcept {
+    dbg::Assert(stats);
+    if (intr_num >= count) {
+        return false;
+    }
+
+    const IntrGuard guard;
+    *stats = GetStatsTab()[intr_num];
+    return true;
+}
+
+void DumpIntrStats() noexcept {
+    for (stl::size_t i {0}; i != count; ++i) {
+        IntrStats stats;
+        GetIntrStats(i, &stats);
+        if (stats.count == 0 && stats.spurious_count == 0) {
+            continue;
+        }
+
+        io::Printf("Interrupt 0x{} {}:\n", i, GetIntrHandlerTab().GetName(i));
+        io::Printf("\tCount: 0x{}, nested: 0x{}, spurious: 0x{}.\n", stats.count,
+                   stats.nested_count, stats.spurious_count);
+        io::Printf("\tHandler cycles: 0x{} in total, 0x{} at most.\n", stats.total_cycles,
+                   stats.max_cycles);
+    }
+}
+
+}  // namespace intr
@@ -280,4 +280,9 @@ void InitPgmIntrCtrl(const stl::span<Intr> intrs) noexcept {
     io::PrintlnStr("Intel 8259A Programmable Interrupt Controller has been initialized.");
 }
 
+void DisablePgmIntrCtrl() noexcept {
+    OpCmdWord1 {}.DisableAllIntrs().WriteToPort(port::master_data);
+    OpCmdWord1 {}.DisableAllIntrs().WriteToPort(port::slave_data);
+}
+
 }  // namespace intr::pic
\ No newline at end of file
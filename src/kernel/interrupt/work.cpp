@@ -0,0 +1,66 @@
+#include "kernel/interrupt/work.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/video/print.h"
+#include "kernel/thread/thd.h"
+#include "kernel/util/spsc_queue.h"
+
+namespace intr {
+
+namespace {
+
+using WorkQueue = SpscQueue<Work, max_work_count>;
+
+/**
+ * @brief A wrapper of a global variable representing the work queue.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+WorkQueue& GetWorkQueue() noexcept {
+    static WorkQueue works;
+    return works;
+}
+
+/**
+ * @brief A wrapper of a global @p bool variable representing whether the work queue has been initialized.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+bool& IsWorkQueueInited() noexcept {
+    static bool inited {false};
+    return inited;
+}
+
+//! The worker thread that runs work items with interrupts enabled.
+void RunWorks(void*) noexcept {
+    auto& works {GetWorkQueue()};
+    while (true) {
+        const auto work {works.Pop()};
+        dbg::Assert(work.callback);
+        work.callback(work.arg);
+    }
+}
+
+}  // namespace
+
+bool ScheduleWork(const Work::Callback callback, void* const arg) noexcept {
+    dbg::Assert(callback);
+    dbg::Assert(IsWorkQueueInited());
+    // Interrupt handlers and threads are serialized by disabling interrupts,
+    // so there is only one producer at a time.
+    const IntrGuard guard;
+    return GetWorkQueue().TryPush({callback, arg});
+}
+
+void InitWorkQueue() noexcept {
+    dbg::Assert(!IsWorkQueueInited());
+    tsk::KrnlThread::Create("worker", work_thd_priority, &RunWorks);
+    IsWorkQueueInited() = true;
+    io::PrintlnStr("The work queue has been initialized.");
+}
+
+}  // namespace intr
@@ -0,0 +1,459 @@
+#include "kernel/io/disk/cache.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/thread/thd.h"
+
+namespace io {
+
+namespace {
+
+//! The priority of the flusher thread.
+inline constexpr stl::size_t flusher_priority {31};
+
+//! The priority of the readahead thread.
+inline constexpr stl::size_t readahead_priority {31};
+
+//! The flusher thread that writes dirty buffers back periodically.
+void FlushBuffers(void*) noexcept {
+    while (true) {
+        tsk::Thread::GetCurrent().Sleep(BlockCache::flush_interval);
+        GetBlockCache().Flush();
+    }
+}
+
+//! The interval between two attempts to find a free buffer when all buffers are being used.
+inline constexpr stl::size_t busy_wait_interval {10};
+
+//! The readahead thread that runs prefetch requests.
+void PrefetchBuffers(void*) noexcept {
+    const auto staging {mem::Allocate(BlockCache::max_run_count * Disk::sector_size)};
+    mem::AssertAlloc(staging);
+    while (true) {
+        GetBlockCache().RunPrefetch(staging);
+    }
+}
+
+}  // namespace
+
+BlockCache& GetBlockCache() noexcept {
+    static BlockCache cache;
+    return cache;
+}
+
+void InitBlockCache() noexcept {
+    GetBlockCache().Init();
+    tsk::KrnlThread::Create("flusher", flusher_priority, &FlushBuffers);
+    tsk::KrnlThread::Create("readahead", readahead_priority, &PrefetchBuffers);
+    io::PrintlnStr("The block buffer cache has been initialized.");
+}
+
+BlockCache::Buffer& BlockCache::Buffer::GetByHashTag(const TagList::Tag& tag) noexcept {
+    return tag.GetElem<Buffer>();
+}
+
+BlockCache::Buffer& BlockCache::Buffer::GetByLruTag(const TagList::Tag& tag) noexcept {
+    return tag.GetElem<Buffer, sizeof(TagList::Tag)>();
+}
+
+BlockCache& BlockCache::Init() noexcept {
+    constexpr auto page_count {
+        RoundUpDivide<stl::size_t>(buf_count * Disk::sector_size, mem::page_size)};
+    // Buffers are in kernel memory, so disks can transfer them in any thread.
+    const auto data {mem::AllocPages<stl::byte>(mem::PoolType::Kernel, page_count)};
+    mem::AssertAlloc(data);
+    for (stl::size_t i {0}; i != bufs_.size(); ++i) {
+        bufs_[i].data = data + i * Disk::sector_size;
+        lru_.PushBack(bufs_[i].lru_tag);
+    }
+
+    flush_staging_ = mem::Allocate<stl::byte>(max_run_count * Disk::sector_size);
+    mem::AssertAlloc(flush_staging_);
+
+    lock_.set_name("io::BlockCache");
+    flush_lock_.set_name("io::BlockCache (flush)");
+    return *this;
+}
+
+stl::size_t BlockCache::GetBucketIdx(const Disk* const disk, const stl::size_t lba) noexcept {
+    return (reinterpret_cast<stl::uintptr_t>(disk) / sizeof(Disk) + lba) % bucket_count;
+}
+
+BlockCache::Buffer* BlockCache::Find(const Disk* const disk, const stl::size_t lba) const noexcept {
+    struct Key {
+        const Disk* disk;
+        stl::size_t lba;
+    } key {disk, lba};
+
+    const auto found {buckets_[GetBucketIdx(disk, lba)].Find(
+        [](const TagList::Tag& tag, void* const arg) noexcept {
+            const auto& key {*static_cast<const Key*>(arg)};
+            const auto& buf {Buffer::GetByHashTag(tag)};
+            return buf.disk == key.disk && buf.lba == key.lba;
+        },
+        &key)};
+
+    return found ? &Buffer::GetByHashTag(*found) : nullptr;
+}
+
+BlockCache& BlockCache::Touch(Buffer& buf) noexcept {
+    buf.lru_tag.Detach();
+    lru_.PushBack(buf.lru_tag);
+    return *this;
+}
+
+BlockCache::Buffer& BlockCache::Get(const Disk& disk, const stl::size_t lba) noexcept {
+    while (true) {
+        if (const auto buf {TryGet(disk, lba)}; buf) {
+            return *buf;
+        }
+
+        // All buffers are being used. Wait for other threads to release some of them.
+        // Threads never wait here while holding references, so the buffers will be released.
+        tsk::Thread::GetCurrent().Sleep(busy_wait_interval);
+    }
+}
+
+BlockCache::Buffer* BlockCache::TryGet(const Disk& disk, const stl::size_t lba) noexcept {
+    while (true) {
+        lock_.lock();
+        if (const auto buf {Find(&disk, lba)}; buf) {
+            ++buf->ref_count;
+            Touch(*buf);
+            lock_.unlock();
+            return buf;
+        }
+
+        // Find the least recently used buffer that is not being used.
+        const auto victim_tag {lru_.Find([](const TagList::Tag& tag, void*) noexcept {
+            return Buffer::GetByLruTag(tag).ref_count == 0;
+        })};
+
+        if (!victim_tag) {
+            lock_.unlock();
+            return nullptr;
+        }
+
+        auto& victim {Buffer::GetByLruTag(*victim_tag)};
+        // An unused buffer cannot be modified by others, so its dirty flag can be read without the buffer lock.
+        if (victim.dirty) {
+            // Write the old sector back before reusing the buffer, then search again,
+            // since other threads may cache the sector meanwhile.
+            ++victim.ref_count;
+            lock_.unlock();
+            WriteBack(victim);
+            Release(victim);
+            continue;
+        }
+
+        if (victim.disk) {
+            victim.hash_tag.Detach();
+        }
+
+        victim.disk = &disk;
+        victim.lba = lba;
+        victim.valid = false;
+        victim.ref_count = 1;
+        buckets_[GetBucketIdx(&disk, lba)].PushBack(victim.hash_tag);
+        Touch(victim);
+        lock_.unlock();
+        return &victim;
+    }
+}
+
+BlockCache& BlockCache::Release(Buffer& buf) noexcept {
+    const stl::lock_guard guard {lock_};
+    dbg::Assert(buf.ref_count > 0);
+    --buf.ref_count;
+    return *this;
+}
+
+BlockCache& BlockCache::WriteBack(Buffer& buf) noexcept {
+    const stl::lock_guard guard {buf.lock};
+    if (buf.valid && buf.dirty) {
+        const_cast<Disk*>(buf.disk)->WriteSectors(buf.lba, buf.data);
+        buf.dirty = false;
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::WriteBack(Buffer& buf, void* const staging) noexcept {
+    dbg::Assert(staging);
+    buf.lock.lock();
+    if (!buf.valid || !buf.dirty) {
+        buf.lock.unlock();
+        return *this;
+    }
+
+    // Collect dirty buffers following the buffer on the disk.
+    stl::array<Buffer*, max_run_count> run;
+    run[0] = &buf;
+    stl::size_t run_len {1};
+    while (run_len != max_run_count) {
+        Buffer* next {nullptr};
+        {
+            const stl::lock_guard guard {lock_};
+            next = Find(buf.disk, buf.lba + run_len);
+            if (!next) {
+                break;
+            }
+
+            ++next->ref_count;
+        }
+
+        // Buffers are always locked in ascending order of LBAs.
+        next->lock.lock();
+        if (!next->valid || !next->dirty) {
+            next->lock.unlock();
+            Release(*next);
+            break;
+        }
+
+        run[run_len++] = next;
+    }
+
+    // Write the run back with a single command.
+    for (stl::size_t i {0}; i != run_len; ++i) {
+        stl::memcpy(static_cast<stl::byte*>(staging) + i * Disk::sector_size, run[i]->data,
+                    Disk::sector_size);
+    }
+
+    const_cast<Disk*>(buf.disk)->WriteSectors(buf.lba, staging, run_len);
+    for (stl::size_t i {0}; i != run_len; ++i) {
+        run[i]->dirty = false;
+        run[i]->lock.unlock();
+        if (i != 0) {
+            Release(*run[i]);
+        }
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::Read(const Disk& disk, const stl::size_t lba, void* const buf,
+                             const stl::size_t count) noexcept {
+    dbg::Assert(buf && count > 0);
+    for (stl::size_t i {0}; i < count; i += max_run_count) {
+        Load(disk, lba + i, stl::min(count - i, max_run_count),
+             static_cast<stl::byte*>(buf) + i * Disk::sector_size);
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::Write(Disk& disk, const stl::size_t lba, const void* const data,
+                              const stl::size_t count) noexcept {
+    dbg::Assert(data && count > 0);
+    for (stl::size_t i {0}; i != count; ++i) {
+        auto& cached {Get(disk, lba + i)};
+        {
+            // The whole sector is overwritten, so it does not need to be loaded.
+            const stl::lock_guard guard {cached.lock};
+            stl::memcpy(cached.data, static_cast<const stl::byte*>(data) + i * Disk::sector_size,
+                        Disk::sector_size);
+            cached.valid = true;
+            cached.dirty = true;
+        }
+
+        Release(cached);
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::ReadBytes(const Disk& disk, stl::size_t lba, stl::size_t offset,
+                                  void* const buf, stl::size_t size) noexcept {
+    dbg::Assert(buf && offset < Disk::sector_size);
+    auto data {static_cast<stl::byte*>(buf)};
+    while (size != 0) {
+        const auto len {stl::min(size, Disk::sector_size - offset)};
+        auto& cached {Get(disk, lba)};
+        {
+            const stl::lock_guard guard {cached.lock};
+            disk.RecordCacheAccess(lba, cached.valid);
+            if (!cached.valid) {
+                disk.ReadSectors(lba, cached.data);
+                cached.valid = true;
+            }
+
+            stl::memcpy(data, cached.data + offset, len);
+        }
+
+        Release(cached);
+        data += len;
+        size -= len;
+        offset = 0;
+        ++lba;
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::WriteBytes(Disk& disk, stl::size_t lba, stl::size_t offset,
+                                   const void* const data, stl::size_t size) noexcept {
+    dbg::Assert(data && offset < Disk::sector_size);
+    auto src {static_cast<const stl::byte*>(data)};
+    while (size != 0) {
+        const auto len {stl::min(size, Disk::sector_size - offset)};
+        auto& cached {Get(disk, lba)};
+        {
+            const stl::lock_guard guard {cached.lock};
+            disk.RecordCacheAccess(lba, cached.valid || len == Disk::sector_size);
+            if (!cached.valid && len != Disk::sector_size) {
+                // Only part of the sector is overwritten, so the rest must be loaded.
+                disk.ReadSectors(lba, cached.data);
+            }
+
+            stl::memcpy(cached.data + offset, src, len);
+            cached.valid = true;
+            cached.dirty = true;
+        }
+
+        Release(cached);
+        src += len;
+        size -= len;
+        offset = 0;
+        ++lba;
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::Discard(const Disk& disk, const stl::size_t lba,
+                                const stl::size_t count) noexcept {
+    for (stl::size_t i {0}; i != count; ++i) {
+        Buffer* cached {nullptr};
+        {
+            const stl::lock_guard guard {lock_};
+            cached = Find(&disk, lba + i);
+            if (!cached) {
+                continue;
+            }
+
+            ++cached->ref_count;
+        }
+
+        {
+            const stl::lock_guard guard {cached->lock};
+            cached->valid = false;
+            cached->dirty = false;
+        }
+
+        Release(*cached);
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::Flush() noexcept {
+    const stl::lock_guard flush_guard {flush_lock_};
+    for (auto& buf : bufs_) {
+        {
+            const stl::lock_guard guard {lock_};
+            if (!buf.disk) {
+                continue;
+            }
+
+            ++buf.ref_count;
+        }
+
+        WriteBack(buf, flush_staging_);
+        Release(buf);
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::Prefetch(const Disk& disk, const stl::size_t lba,
+                                 const stl::size_t count) noexcept {
+    dbg::Assert(0 < count && count <= max_run_count);
+    const intr::IntrGuard guard;
+    // Readahead is only a hint, so the caller should not wait for a free slot.
+    if (!prefetch_reqs_.IsFull()) {
+        prefetch_reqs_.Push({&disk, lba, count});
+    }
+
+    return *this;
+}
+
+BlockCache& BlockCache::RunPrefetch(void* const staging) noexcept {
+    PrefetchReq req;
+    {
+        const intr::IntrGuard guard;
+        req = prefetch_reqs_.Pop();
+    }
+
+    return Load(*req.disk, req.lba, req.count, staging, true);
+}
+
+BlockCache& BlockCache::Load(const Disk& disk, const stl::size_t lba, const stl::size_t count,
+                             void* const buf, const bool prefetch) noexcept {
+    dbg::Assert(buf && 0 < count && count <= max_run_count);
+    const auto data {static_cast<stl::byte*>(buf)};
+    stl::array<Buffer*, max_run_count> bufs;
+    for (stl::size_t begin {0}; begin != count;) {
+        // Only the first buffer of a chunk can wait for a free buffer, since no other one is held.
+        // If all buffers are being used, the chunk ends early and is released after loading,
+        // so concurrent loads cannot hold every buffer and wait for each other.
+        bufs[begin] = &Get(disk, lba + begin);
+        auto end {begin + 1};
+        while (end != count) {
+            bufs[end] = TryGet(disk, lba + end);
+            if (!bufs[end]) {
+                break;
+            }
+
+            ++end;
+        }
+
+        // Buffers are always locked in ascending order of LBAs, so threads holding multiple locks cannot deadlock.
+        for (auto i {begin}; i != end; ++i) {
+            bufs[i]->lock.lock();
+        }
+
+        for (auto i {begin}; i != end;) {
+            if (bufs[i]->valid) {
+                if (!prefetch) {
+                    disk.RecordCacheAccess(lba + i, true);
+                }
+
+                stl::memcpy(data + i * Disk::sector_size, bufs[i]->data, Disk::sector_size);
+                ++i;
+                continue;
+            }
+
+            // Read each run of sectors that are not cached straight into the buffer with a single command.
+            stl::size_t run_len {1};
+            while (i + run_len != end && !bufs[i + run_len]->valid) {
+                ++run_len;
+            }
+
+            disk.ReadSectors(lba + i, data + i * Disk::sector_size, run_len);
+            for (auto j {i}; j != i + run_len; ++j) {
+                // Each sector of the run is a miss.
+                if (!prefetch) {
+                    disk.RecordCacheAccess(lba + j, false);
+                }
+
+                stl::memcpy(bufs[j]->data, data + j * Disk::sector_size, Disk::sector_size);
+                bufs[j]->valid = true;
+            }
+
+            i += run_len;
+        }
+
+        for (auto i {begin}; i != end; ++i) {
+            bufs[i]->lock.unlock();
+            Release(*bufs[i]);
+        }
+
+        begin = end;
+    }
+
+    return *this;
+}
+
+}  // namespace io
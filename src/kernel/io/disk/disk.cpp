@@ -1,7 +1,10 @@
 #include "kernel/io/disk/disk.h"
+#include "kernel/debug/log.h"
+#include "kernel/debug/trace.h"
+#include "kernel/interrupt/intr.h"
 #include "kernel/io/disk/ide.h"
 #include "kernel/io/io.h"
-#include "kernel/io/video/console.h"
+#include "kernel/io/pci.h"
 #include "kernel/io/video/print.h"
 #include "kernel/memory/pool.h"
 #include "kernel/util/format.h"
@@ -18,8 +21,31 @@ enum class PartType : stl::uint8_t {
     ExtPart = 5
 };
 
-//! The maximum number of sectors that can be manipulated per disk access.
-inline constexpr stl::size_t max_sector_count_per_access {256};
+//! Get the bucket of a latency in log2 histograms.
+stl::size_t GetLatencyBucket(const stl::uint64_t cycles) noexcept {
+    if (bit::GetHighDword(cycles) != 0) {
+        return DiskStats::latency_bucket_count - 1;
+    } else if (const auto low {bit::GetLowDword(cycles)}; low != 0) {
+        return stl::min(bit::GetHighestSetBit(low), DiskStats::latency_bucket_count - 1);
+    } else {
+        return 0;
+    }
+}
+
+//! Record a completed request in statistics.
+void RecordRequest(DiskStats& stats, const stl::size_t count, const bool write,
+                   const stl::uint64_t cycles) noexcept {
+    if (write) {
+        ++stats.write_count;
+        stats.write_sector_count += count;
+    } else {
+        ++stats.read_count;
+        stats.read_sector_count += count;
+    }
+
+    stats.total_cycles += cycles;
+    ++stats.latencies[GetLatencyBucket(cycles)];
+}
 
 /**
  * @brief Clear the current disk interrupt.
@@ -27,22 +53,28 @@ inline constexpr stl::size_t max_sector_count_per_access {256};
  * @details
  * After an interrupt is processed, we need to notify the disk,
  * otherwise it will not generate a new interrupt.
+ *
+ * @return The status register.
  */
-void ClearCurrIntr(const IdeChnl& chnl) noexcept {
-    ReadByteFromPort(chnl.GetStatusPort());
+stl::uint8_t ClearCurrIntr(const IdeChnl& chnl) noexcept {
+    return ReadByteFromPort(chnl.GetStatusPort());
 }
 
 /**
  * @brief Adjusts the value of the number of sectors according to register restrictions.
  *
  * @details
- * The maximum number of sectors that can be manipulated per disk access is 256.
- * The I/O register is 2 bytes long, having values from 0 to 255.
+ * The maximum number of sectors that can be manipulated per disk access is 256 with 28-bit LBAs.
+ * The I/O register is 1 byte long, having values from 0 to 255.
  * So if we want to read or write 256 sectors once, we should set the register to 0.
+ * With 48-bit LBAs, the register is written twice, holding 2 bytes, and 0 means 65536 sectors.
+ *
+ * @param count The number of sectors.
+ * @param max_count The maximum number of sectors per disk access.
  */
-stl::uint8_t AdjustSectorCount(const stl::size_t count) noexcept {
-    dbg::Assert(0 < count && count <= max_sector_count_per_access);
-    return count >= max_sector_count_per_access ? 0 : count;
+stl::uint16_t AdjustSectorCount(const stl::size_t count, const stl::size_t max_count) noexcept {
+    dbg::Assert(0 < count && count <= max_count);
+    return count >= max_count ? 0 : count;
 }
 
 //! The disk interrupt handler.
@@ -52,12 +84,12 @@ void DiskIntrHandler(const stl::size_t intr_num) noexcept {
     const auto chnl_idx {intr == intr::Intr::PrimaryIdeChnl ? 0 : 1};
     auto& chnl {GetIdeChnls()[chnl_idx]};
     dbg::Assert(chnl.GetIntrNum() == intr_num);
+    // Reading the status register acknowledges the interrupt.
+    const auto status {ClearCurrIntr(chnl)};
     if (chnl.IsWaitingForIntr()) {
-        chnl.NeedToWaitForIntr(false);
-        // When manipulating a disk, we locked it.
+        // Only the worker thread of the channel sends commands.
         // So when an interrupt is triggered, it can only be caused by the last operation.
-        chnl.Unblock();
-        ClearCurrIntr(chnl);
+        chnl.CompleteIntr(status);
     }
 }
 
@@ -273,20 +305,24 @@ void SwapBytePairs(const void* const src, void* const dest, const stl::size_t co
     }
 }
 
-void PrintDiskInfo(Disk& disk) noexcept {
-    const auto info {disk.GetInfo()};
+void PrintDiskInfo(const Disk& disk, const Disk::Info& info) noexcept {
     io::Printf("\t\t\tSerial Number: {}\n", info.GetSerial());
     io::Printf("\t\t\tModel: {}\n", info.GetModel());
     io::Printf("\t\t\tSectors: {}\n", info.GetSectorCount());
-    io::Printf("\t\t\tCapacity: {} MB\n", info.GetSectorCount() * Disk::sector_size / MB(1));
+    io::Printf("\t\t\tCapacity: {} MB\n", info.GetSectorCount() / (MB(1) / Disk::sector_size));
+    io::Printf("\t\t\tTransfer: {}\n", disk.IsDmaEnabled() ? "DMA" : "PIO");
+    io::Printf("\t\t\tAddressing: {}\n", disk.IsLba48Enabled() ? "LBA48" : "LBA28");
+}
 
+void PrintPartInfo(const Disk& disk) noexcept {
+    io::Printf("Partitions of the disk '{}' have been scanned.\n", disk.GetName());
     const auto& prim_parts {disk.GetPrimaryParts()};
     for (stl::size_t i {0}; i != prim_parts.size(); ++i) {
         const auto& part {prim_parts[i]};
         if (part.IsValid()) {
-            io::Printf("\t\t\tPrimary Part {}\n", part.GetName());
-            io::Printf("\t\t\t\tStart Sector: {}\n", part.GetStartLba());
-            io::Printf("\t\t\t\tSectors: {}\n", part.GetSectorCount());
+            io::Printf("\tPrimary Part {}\n", part.GetName());
+            io::Printf("\t\tStart Sector: {}\n", part.GetStartLba());
+            io::Printf("\t\tSectors: {}\n", part.GetSectorCount());
         }
     }
 
@@ -294,13 +330,39 @@ void PrintDiskInfo(Disk& disk) noexcept {
     for (stl::size_t i {0}; i != logic_parts.size(); ++i) {
         const auto& part {logic_parts[i]};
         if (part.IsValid()) {
-            io::Printf("\t\t\tLogic Part {}\n", part.GetName());
-            io::Printf("\t\t\t\tStart Sector: {}\n", part.GetStartLba());
-            io::Printf("\t\t\t\tSectors: {}\n", part.GetSectorCount());
+            io::Printf("\tLogic Part {}\n", part.GetName());
+            io::Printf("\t\tStart Sector: {}\n", part.GetStartLba());
+            io::Printf("\t\tSectors: {}\n", part.GetSectorCount());
         }
     }
 }
 
+/**
+ * @brief Find the bus-master base I/O port of the IDE controller.
+ *
+ * @return The port, or @p 0 if the controller does not support bus-master DMA.
+ */
+stl::uint16_t FindBusMasterPort() noexcept {
+    constexpr stl::uint8_t storage_class {0x01};
+    constexpr stl::uint8_t ide_subclass {0x01};
+    constexpr stl::size_t bus_master_pos {7};
+    constexpr stl::size_t bus_master_bar_idx {4};
+    const auto pci {PciDevice::Find(storage_class, ide_subclass)};
+    if (!pci.IsValid() || !bit::IsBitSet(pci.GetProgIntf(), bus_master_pos)) {
+        return 0;
+    }
+
+    // The base address register of I/O space has the lowest bit set.
+    const auto bar {pci.GetBar(bus_master_bar_idx)};
+    if (!bit::IsBitSet(bar, 0)) {
+        return 0;
+    }
+
+    pci.EnableBusMaster();
+    // The lowest two bits are flags.
+    return static_cast<stl::uint16_t>(bar & ~0b11);
+}
+
 /**
  * @brief A wrapper of a global @p bool variable representing whether disks have been initialized.
  *
@@ -313,6 +375,25 @@ bool& IsDiskInitedImpl() noexcept {
     return inited;
 }
 
+//! The lock for scanning partitions, since scanning uses static states and partitions are scanned on demand.
+stl::mutex& GetPartScanLock() noexcept {
+    static stl::mutex lock;
+    return lock;
+}
+
+//! Find a disk by its name.
+Disk* FindDisk(const stl::string_view name) noexcept {
+    for (stl::size_t i {0}; i != GetDiskCount(); ++i) {
+        auto& disk {
+            GetIdeChnls()[i / IdeChnl::max_disk_count].GetDisk(i % IdeChnl::max_disk_count)};
+        if (disk.GetName() == name) {
+            return &disk;
+        }
+    }
+
+    return nullptr;
+}
+
 }  // namespace
 
 TagList& GetDiskParts() noexcept {
@@ -374,32 +455,16 @@ const Disk::FilePart& Disk::GetLogicPart(const stl::size_t idx) const noexcept {
 const Disk& Disk::ReadSectors(const stl::size_t start_lba, void* const buf,
                               const stl::size_t count) const noexcept {
     dbg::Assert(buf && count > 0);
-    dbg::Assert(start_lba + count <= max_lba);
-    auto& chnl {GetIdeChnl()};
-    const stl::lock_guard guard {chnl.GetLock()};
-
-    Select();
-    stl::size_t read_count {0};
-    while (read_count < count) {
-        const auto curr_count {stl::min(count - read_count, max_sector_count_per_access)};
-        SetSectors(start_lba + read_count, curr_count);
-        SendCmd(Cmd::Read);
-        // Block the IDE channel when the disk is reading.
-        // A disk can be blocked only after it receives a command and starts working.
-        // When it has finished processing the command, it will wake itself up in the interrupt handler `DiskIntrHandler`.
-        chnl.Block();
-        // Check whether the disk is readable.
-        if (!BusyWait()) {
-            io::Console::Printf("Failed to read the disk '{}', LBA {}.\n", name_.data(),
-                                start_lba + read_count);
-            dbg::Assert(false);
-        }
-
-        ReadWords(reinterpret_cast<stl::byte*>(buf) + read_count * sector_size,
-                  curr_count * sector_size / sizeof(stl::uint16_t));
-        read_count += curr_count;
-    }
-
+    dbg::Assert(start_lba + count <= sector_count_);
+    IdeChnl::Request req;
+    req.disk = const_cast<Disk*>(this);
+    req.lba = start_lba;
+    req.count = count;
+    req.buf = static_cast<stl::byte*>(buf);
+    req.write = false;
+    dbg::Trace<dbg::TraceEvent::DiskReadEnter>(start_lba, count);
+    GetIdeChnl().Submit(req);
+    dbg::Trace<dbg::TraceEvent::DiskReadExit>(start_lba, count);
     return *this;
 }
 
@@ -431,35 +496,98 @@ bool Disk::BusyWait() const noexcept {
         }
     }
 
+    const intr::IntrGuard guard;
+    ++stats_.timeout_count;
     return false;
 }
 
+bool Disk::WaitForIntr(const bool data) const noexcept {
+    const auto& chnl {GetIdeChnl()};
+    stl::uint8_t status {0};
+    if (!chnl.WaitForIntr(status, intr_timeout)) {
+        {
+            const intr::IntrGuard guard;
+            ++stats_.timeout_count;
+        }
+
+        // The interrupt may have been lost. Poll the status register as a recovery.
+        dbg::Log(dbg::LogLevel::Warning, "The interrupt of the disk '{}' has timed out.",
+                 GetName());
+        BusyWait();
+        status = ReadByteFromPort(chnl.GetStatusPort());
+    }
+
+    const StatusReg reg {status};
+    return !reg.IsDeviceBusy() && !reg.HasError() && (!data || reg.IsDataPrepared());
+}
+
 Disk& Disk::WriteSectors(const stl::size_t start_lba, const void* const data,
                          const stl::size_t count) noexcept {
     dbg::Assert(data && count > 0);
-    dbg::Assert(start_lba + count <= max_lba);
+    dbg::Assert(start_lba + count <= sector_count_);
+    IdeChnl::Request req;
+    req.disk = this;
+    req.lba = start_lba;
+    req.count = count;
+    // The data is only read when writing.
+    req.buf = const_cast<stl::byte*>(static_cast<const stl::byte*>(data));
+    req.write = true;
+    dbg::Trace<dbg::TraceEvent::DiskWriteEnter>(start_lba, count);
+    GetIdeChnl().Submit(req);
+    dbg::Trace<dbg::TraceEvent::DiskWriteExit>(start_lba, count);
+    return *this;
+}
 
-    auto& chnl {GetIdeChnl()};
-    const stl::lock_guard guard {chnl.GetLock()};
+DiskStats Disk::GetStats() const noexcept {
+    const intr::IntrGuard guard;
+    return stats_;
+}
 
-    Select();
-    stl::size_t written_count {0};
-    while (written_count < count) {
-        const auto curr_count {stl::min(count - written_count, max_sector_count_per_access)};
-        SetSectors(start_lba + written_count, curr_count);
-        SendCmd(Cmd::Write);
-        // Check whether the disk is writable.
-        if (!BusyWait()) {
-            io::Console::Printf("Failed to write data to the disk '{}', LBA {}.\n", name_.data(),
-                                start_lba + written_count);
-            dbg::Assert(false);
+Disk::Part* Disk::FindPart(const stl::size_t lba) const noexcept {
+    const auto contains {[lba](const Part& part) noexcept {
+        return part.IsValid() && part.GetStartLba() <= lba
+               && lba < part.GetStartLba() + part.GetSectorCount();
+    }};
+
+    for (const auto& part : prim_parts_) {
+        if (contains(part)) {
+            return const_cast<Part*>(static_cast<const Part*>(&part));
+        }
+    }
+
+    for (const auto& part : logic_parts_) {
+        if (contains(part)) {
+            return const_cast<Part*>(static_cast<const Part*>(&part));
         }
+    }
+
+    return nullptr;
+}
 
-        WriteWords(reinterpret_cast<const stl::byte*>(data) + written_count * sector_size,
-                   curr_count * sector_size / sizeof(stl::uint16_t));
-        // Block the IDE channel when the disk is writing.
-        chnl.Block();
-        written_count += curr_count;
+const Disk& Disk::RecordRequest(const stl::size_t lba, const stl::size_t count, const bool write,
+                                const stl::uint64_t cycles) const noexcept {
+    const intr::IntrGuard guard;
+    io::RecordRequest(stats_, count, write, cycles);
+    if (const auto part {FindPart(lba)}; part) {
+        io::RecordRequest(part->stats_, count, write, cycles);
+    }
+
+    return *this;
+}
+
+const Disk& Disk::RecordCacheAccess(const stl::size_t lba, const bool hit) const noexcept {
+    const intr::IntrGuard guard;
+    const auto part {FindPart(lba)};
+    if (hit) {
+        ++stats_.cache_hit_count;
+        if (part) {
+            ++part->stats_.cache_hit_count;
+        }
+    } else {
+        ++stats_.cache_miss_count;
+        if (part) {
+            ++part->stats_.cache_miss_count;
+        }
     }
 
     return *this;
@@ -478,15 +606,33 @@ const Disk& Disk::Select() const noexcept {
 }
 
 const Disk& Disk::SetSectors(const stl::size_t start_lba, const stl::size_t count) const noexcept {
-    dbg::Assert(0 < count && count <= max_sector_count_per_access);
-    dbg::Assert(start_lba + count <= max_lba);
+    dbg::Assert(start_lba + count <= sector_count_);
     auto& chnl {GetIdeChnl()};
-    WriteByteToPort(chnl.GetSectorCountPort(), AdjustSectorCount(count));
-    WriteByteToPort(chnl.GetLbaLowPort(), LbaLowReg {}.SetLba(start_lba));
-    WriteByteToPort(chnl.GetLbaMidPort(), LbaMidReg {}.SetLba(start_lba));
-    WriteByteToPort(chnl.GetLbaHighPort(), LbaHighReg {}.SetLba(start_lba));
     const bool is_master {idx_ == 0};
-    WriteByteToPort(chnl.GetDevicePort(), DeviceReg {is_master, start_lba});
+    if (lba48_) {
+        const auto sector_count {AdjustSectorCount(count, max_ext_sector_count_per_access)};
+        // Registers are FIFOs of two bytes. The high-order bytes are written first.
+        // The LBA is 32 bits long, so bits `32`-`47` are zeros.
+        WriteByteToPort(chnl.GetSectorCountPort(), bit::GetHighByte(sector_count));
+        WriteByteToPort(chnl.GetLbaLowPort(), bit::GetByte(start_lba, 24));
+        WriteByteToPort(chnl.GetLbaMidPort(), 0);
+        WriteByteToPort(chnl.GetLbaHighPort(), 0);
+        WriteByteToPort(chnl.GetSectorCountPort(), bit::GetLowByte(sector_count));
+        WriteByteToPort(chnl.GetLbaLowPort(), LbaLowReg {}.SetLba(start_lba));
+        WriteByteToPort(chnl.GetLbaMidPort(), LbaMidReg {}.SetLba(start_lba));
+        WriteByteToPort(chnl.GetLbaHighPort(), LbaHighReg {}.SetLba(start_lba));
+        // The device register holds no LBA bits.
+        WriteByteToPort(chnl.GetDevicePort(), DeviceReg {is_master, 0});
+    } else {
+        dbg::Assert(start_lba + count <= max_lba28_sector_count);
+        const auto sector_count {AdjustSectorCount(count, max_sector_count_per_access)};
+        WriteByteToPort(chnl.GetSectorCountPort(), bit::GetLowByte(sector_count));
+        WriteByteToPort(chnl.GetLbaLowPort(), LbaLowReg {}.SetLba(start_lba));
+        WriteByteToPort(chnl.GetLbaMidPort(), LbaMidReg {}.SetLba(start_lba));
+        WriteByteToPort(chnl.GetLbaHighPort(), LbaHighReg {}.SetLba(start_lba));
+        WriteByteToPort(chnl.GetDevicePort(), DeviceReg {is_master, start_lba});
+    }
+
     return *this;
 }
 
@@ -494,12 +640,25 @@ Disk::Info::Info(const stl::byte* const buf) noexcept {
     dbg::Assert(buf);
     constexpr stl::size_t serial_pos {10 * sizeof(stl::uint16_t)};
     constexpr stl::size_t model_pos {27 * sizeof(stl::uint16_t)};
+    constexpr stl::size_t capability_pos {49 * sizeof(stl::uint16_t)};
     constexpr stl::size_t sector_count_pos {60 * sizeof(stl::uint16_t)};
+    constexpr stl::size_t cmd_set_pos {83 * sizeof(stl::uint16_t)};
+    constexpr stl::size_t lba48_sector_count_pos {100 * sizeof(stl::uint16_t)};
     // The information data is in words, where the position of every two neighboring characters is reversed.
     // So we need to swap every two of them.
     SwapBytePairs(buf + serial_pos, serial_.data(), serial_len / 2);
     SwapBytePairs(buf + model_pos, model_.data(), model_len / 2);
-    sector_count_ = *reinterpret_cast<const stl::size_t*>(buf + sector_count_pos);
+    constexpr stl::size_t dma_pos {8};
+    dma_ = bit::IsBitSet(*reinterpret_cast<const stl::uint16_t*>(buf + capability_pos), dma_pos);
+    constexpr stl::size_t lba48_pos {10};
+    lba48_ = bit::IsBitSet(*reinterpret_cast<const stl::uint16_t*>(buf + cmd_set_pos), lba48_pos);
+    if (lba48_) {
+        // The 48-bit sector count is saved in four words. Only 32-bit LBAs can be used.
+        const auto count {*reinterpret_cast<const stl::uint64_t*>(buf + lba48_sector_count_pos)};
+        sector_count_ = bit::GetHighDword(count) == 0 ? bit::GetLowDword(count) : 0xFFFFFFFF;
+    } else {
+        sector_count_ = *reinterpret_cast<const stl::size_t*>(buf + sector_count_pos);
+    }
 }
 
 stl::string_view Disk::Info::GetSerial() const noexcept {
@@ -514,11 +673,50 @@ stl::size_t Disk::Info::GetSectorCount() const noexcept {
     return sector_count_;
 }
 
+bool Disk::Info::IsDmaSupported() const noexcept {
+    return dma_;
+}
+
+bool Disk::Info::IsLba48Supported() const noexcept {
+    return lba48_;
+}
+
+Disk& Disk::EnableDma(const bool enable) noexcept {
+    dbg::Assert(!enable || GetIdeChnl().IsBusMasterEnabled());
+    dma_ = enable;
+    return *this;
+}
+
+bool Disk::IsDmaEnabled() const noexcept {
+    return dma_;
+}
+
+Disk& Disk::EnableLba48(const bool enable) noexcept {
+    lba48_ = enable;
+    return *this;
+}
+
+bool Disk::IsLba48Enabled() const noexcept {
+    return lba48_;
+}
+
+stl::size_t Disk::GetMaxSectorCountPerAccess() const noexcept {
+    return lba48_ ? max_ext_sector_count_per_access : max_sector_count_per_access;
+}
+
+Disk& Disk::SetSectorCount(const stl::size_t count) noexcept {
+    sector_count_ = count;
+    return *this;
+}
+
+stl::size_t Disk::GetSectorCount() const noexcept {
+    return sector_count_;
+}
+
 Disk::Info Disk::GetInfo() const noexcept {
     Select();
     SendCmd(Cmd::Identify);
-    GetIdeChnl().Block();
-    if (!BusyWait()) {
+    if (!WaitForIntr(true)) {
         io::Printf("Failed to identify the disk '{}'.\n", name_.data());
         dbg::Assert(false);
     }
@@ -530,6 +728,9 @@ Disk::Info Disk::GetInfo() const noexcept {
 
 const Disk& Disk::SendCmd(const Cmd cmd) const noexcept {
     auto& chnl {GetIdeChnl()};
+    // The wait is armed before the command register is written, so an interrupt raised at once,
+    // even before the caller starts waiting, is saved by the handler instead of being ignored.
+    const intr::IntrGuard guard;
     chnl.NeedToWaitForIntr();
     WriteByteToPort(chnl.GetCmdPort(), static_cast<stl::byte>(cmd));
     return *this;
@@ -549,7 +750,17 @@ stl::string_view Disk::GetName() const noexcept {
 }
 
 Disk& Disk::ScanParts() noexcept {
-    return ScanParts(0, true);
+    const stl::lock_guard guard {GetPartScanLock()};
+    if (!parts_scanned_) {
+        parts_scanned_ = true;
+        // Skip the boot disk.
+        if (idx_ != boot_disk_idx) {
+            ScanParts(0, true);
+            PrintPartInfo(*this);
+        }
+    }
+
+    return *this;
 }
 
 Disk& Disk::ScanParts(const stl::size_t lba, const bool new_disk) noexcept {
@@ -632,6 +843,7 @@ void InitDisk() noexcept {
     dbg::Assert(intr::IsIntrEnabled());
 
     io::PrintlnStr("Initializing disks.");
+    const auto bm_base {FindBusMasterPort()};
     stl::size_t inited_disk_count {0};
     // Initialize each disk on all IDE channels.
     for (stl::size_t chnl_idx {0}; chnl_idx != GetIdeChnlCount(); ++chnl_idx) {
@@ -659,7 +871,15 @@ void InitDisk() noexcept {
             }
         }
 
+        if (bm_base != 0) {
+            // The secondary channel's registers follow the primary channel's.
+            constexpr stl::uint16_t bm_chnl_size {8};
+            chnl.EnableBusMaster(bm_base + chnl_idx * bm_chnl_size);
+        }
+
         intr::GetIntrHandlerTab().Register(chnl.GetIntrNum(), &DiskIntrHandler);
+        // Requests of each channel are transferred by its own worker thread.
+        chnl.StartWorker();
         for (stl::size_t disk_idx {0};
              disk_idx != IdeChnl::max_disk_count && inited_disk_count != GetDiskCount();
              ++disk_idx, ++inited_disk_count) {
@@ -671,11 +891,13 @@ void InitDisk() noexcept {
             disk.SetName(disk_name.data());
             io::Printf("\t\tInitializing the disk '{}'.\n", disk.GetName());
             disk.Attach(&chnl, disk_idx);
-            if (disk_idx != boot_disk_idx) {
-                disk.ScanParts();
-            }
-
-            PrintDiskInfo(disk);
+            const auto info {disk.GetInfo()};
+            // Use PIO transfers if the channel or the disk does not support DMA.
+            disk.EnableDma(chnl.IsBusMasterEnabled() && info.IsDmaSupported())
+                .EnableLba48(info.IsLba48Supported())
+                .SetSectorCount(info.GetSectorCount());
+            // Partitions are scanned when they are accessed for the first time.
+            PrintDiskInfo(disk, info);
         }
     }
 
@@ -687,4 +909,54 @@ bool IsDiskInited() noexcept {
     return IsDiskInitedImpl();
 }
 
+Disk::FilePart* FindDiskPart(const stl::string_view name) noexcept {
+    // The name of a partition starts with the name of its disk, such as "sdb1".
+    constexpr stl::size_t disk_name_len {3};
+    if (!IsDiskInited() || name.size() <= disk_name_len) {
+        return nullptr;
+    }
+
+    const auto disk {FindDisk(name.substr(0, disk_name_len))};
+    if (!disk) {
+        return nullptr;
+    }
+
+    disk->ScanParts();
+    const stl::lock_guard guard {GetPartScanLock()};
+    const auto found {GetDiskParts().Find(
+        [](const TagList::Tag& tag, void* const name) noexcept {
+            return Disk::FilePart::GetByTag(tag).GetName()
+                   == *static_cast<const stl::string_view*>(name);
+        },
+        const_cast<stl::string_view*>(&name))};
+
+    return found ? &Disk::FilePart::GetByTag(*found) : nullptr;
+}
+
+namespace sc {
+
+bool Disk::GetStats(const char* const name, DiskStats* const stats) noexcept {
+    if (!name || !stats || !IsDiskInited()) {
+        return false;
+    }
+
+    const stl::string_view target {name};
+    // Search disks first.
+    if (const auto disk {FindDisk(target)}; disk) {
+        *stats = disk->GetStats();
+        return true;
+    }
+
+    // Then search partitions.
+    if (const auto part {FindDiskPart(target)}; part) {
+        // The file system statistics of a file partition hide its I/O statistics.
+        *stats = part->Part::GetStats();
+        return true;
+    } else {
+        return false;
+    }
+}
+
+}  // namespace sc
+
 }  // namespace io
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "kernel/io/disk/file/dentry.h"
+#include "kernel/debug/assert.h"
+#include "kernel/stl/cstring.h"
+
+namespace io::fs {
+
+DentryCache& GetDentryCache() noexcept {
+    static DentryCache cache;
+    return cache;
+}
+
+bool DentryCache::Slot::IsUsed() const noexcept {
+    return part != nullptr;
+}
+
+bool DentryCache::Slot::Match(const void* const part, const stl::size_t parent_idx,
+                              const stl::string_view name) const noexcept {
+    return this->part == part && this->parent_idx == parent_idx && entry.HasName(name);
+}
+
+stl::size_t DentryCache::GetSlotIdx(const void* const part, const stl::size_t parent_idx,
+                                    const stl::string_view name) noexcept {
+    // The FNV-1a hash.
+    stl::uint32_t hash {0x811C9DC5};
+    for (const auto c : name) {
+        hash = (hash ^ static_cast<stl::uint8_t>(c)) * 0x01000193;
+    }
+
+    hash = (hash ^ parent_idx) * 0x01000193;
+    hash = (hash ^ reinterpret_cast<stl::uintptr_t>(part)) * 0x01000193;
+    return hash % slot_count;
+}
+
+bool DentryCache::Find(const void* const part, const stl::size_t parent_idx,
+                       const stl::string_view name, DirEntry& entry) const noexcept {
+    if (name.size() > Path::max_name_len) {
+        return false;
+    }
+
+    const stl::lock_guard guard {lock_};
+    if (const auto& slot {slots_[GetSlotIdx(part, parent_idx, name)]};
+        slot.IsUsed() && slot.Match(part, parent_idx, name)) {
+        entry = slot.entry;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+DentryCache& DentryCache::Insert(const void* const part, const stl::size_t parent_idx,
+                                 const stl::string_view name, const DirEntry* const entry) noexcept {
+    dbg::Assert(part && !name.empty());
+    if (name.size() > Path::max_name_len) {
+        return *this;
+    }
+
+    const stl::lock_guard guard {lock_};
+    auto& slot {slots_[GetSlotIdx(part, parent_idx, name)]};
+    slot.part = part;
+    slot.parent_idx = parent_idx;
+    if (entry) {
+        slot.entry = *entry;
+    } else {
+        slot.entry.type = FileType::Unknown;
+        slot.entry.inode_idx = npos;
+        stl::memset(slot.entry.name.data(), 0, slot.entry.name.size());
+        stl::memcpy(slot.entry.name.data(), name.data(), name.size());
+    }
+
+    return *this;
+}
+
+DentryCache& DentryCache::Erase(const void* const part, const stl::size_t parent_idx,
+                                const stl::string_view name) noexcept {
+    if (name.size() > Path::max_name_len) {
+        return *this;
+    }
+
+    const stl::lock_guard guard {lock_};
+    if (auto& slot {slots_[GetSlotIdx(part, parent_idx, name)]};
+        slot.Match(part, parent_idx, name)) {
+        slot.part = nullptr;
+    }
+
+    return *this;
+}
+
+DentryCache& DentryCache::Erase(const void* const part, const stl::size_t inode_idx) noexcept {
+    const stl::lock_guard guard {lock_};
+    for (auto& slot : slots_) {
+        if (slot.part == part
+            && (slot.parent_idx == inode_idx || slot.entry.inode_idx == inode_idx)) {
+            slot.part = nullptr;
+        }
+    }
+
+    return *this;
+}
+
+}  // namespace io::fs
@@ -2,6 +2,7 @@
 #include "kernel/io/disk/disk.h"
 #include "kernel/io/disk/file/inode.h"
 #include "kernel/memory/pool.h"
+#include "kernel/stl/cstring.h"
 
 namespace io::fs {
 
@@ -14,7 +15,7 @@ void Directory::Close() noexcept {
 }
 
 void Directory::Rewind() noexcept {
-    pos = 0;
+    cursor = {};
 }
 
 bool Directory::IsEmpty() const noexcept {
@@ -41,6 +42,18 @@ DirEntry& DirEntry::SetName(const stl::string_view name) noexcept {
     return *this;
 }
 
+bool DirEntry::HasName(const stl::string_view name) const noexcept {
+    const auto len {name.size()};
+    // The stored name is a null-terminated string,
+    // so its length is equal if the null character is at the same position.
+    if (len == 0 || len > Path::max_name_len || this->name[len] != '\0'
+        || this->name[0] != name[0]) {
+        return false;
+    }
+
+    return stl::memcmp(this->name.data(), name.data(), len) == 0;
+}
+
 DirEntry::DirEntry(const FileType type, const stl::string_view name,
                    const stl::size_t inode_idx) noexcept :
     type {type}, inode_idx {inode_idx} {
@@ -0,0 +1,127 @@
+#include "kernel/io/disk/file/dir_index.h"
+#include "kernel/debug/assert.h"
+#include "kernel/memory/pool.h"
+
+namespace io::fs {
+
+DirIndex::Entry& DirIndex::Entry::GetByTag(const TagList::Tag& tag) noexcept {
+    return tag.GetElem<Entry>();
+}
+
+DirIndex* DirIndex::Create() noexcept {
+    const auto index {mem::Allocate<DirIndex>(sizeof(DirIndex))};
+    if (!index) {
+        return nullptr;
+    }
+
+    for (auto& bucket : index->buckets_) {
+        bucket.Init();
+    }
+
+    return index;
+}
+
+void DirIndex::Destroy(DirIndex* const index) noexcept {
+    dbg::Assert(index);
+    index->Clear();
+    mem::Free(index);
+}
+
+stl::size_t DirIndex::Hash(const stl::string_view name) noexcept {
+    // The FNV-1a hash.
+    stl::uint32_t hash {0x811C9DC5};
+    for (const auto c : name) {
+        hash = (hash ^ static_cast<stl::uint8_t>(c)) * 0x01000193;
+    }
+
+    return hash;
+}
+
+bool DirIndex::Insert(const stl::string_view name, const Pos& pos) noexcept {
+    const auto entry {mem::Allocate<Entry>(sizeof(Entry))};
+    if (!entry) {
+        return false;
+    }
+
+    entry->hash = Hash(name);
+    entry->pos = pos;
+    buckets_[entry->hash % bucket_count].PushBack(entry->tag);
+    return true;
+}
+
+DirIndex& DirIndex::Erase(const stl::string_view name, const Pos& pos) noexcept {
+    struct Key {
+        stl::size_t hash;
+        Pos pos;
+    } key {Hash(name), pos};
+
+    const auto found {buckets_[key.hash % bucket_count].Find(
+        [](const TagList::Tag& tag, void* const arg) noexcept {
+            const auto& key {*static_cast<const Key*>(arg)};
+            const auto& entry {Entry::GetByTag(tag)};
+            return entry.hash == key.hash && entry.pos.lba == key.pos.lba
+                   && entry.pos.idx == key.pos.idx;
+        },
+        &key)};
+
+    if (found) {
+        found->Detach();
+        mem::Free(&Entry::GetByTag(*found));
+    }
+
+    return *this;
+}
+
+DirIndex& DirIndex::Erase(const stl::size_t begin_lba, const stl::size_t end_lba) noexcept {
+    struct Range {
+        stl::size_t begin;
+        stl::size_t end;
+    } range {begin_lba, end_lba};
+
+    for (auto& bucket : buckets_) {
+        // Tags cannot be detached while the list is being visited, so search again after each removal.
+        while (const auto found {bucket.Find(
+                   [](const TagList::Tag& tag, void* const arg) noexcept {
+                       const auto& range {*static_cast<const Range*>(arg)};
+                       const auto lba {Entry::GetByTag(tag).pos.lba};
+                       return range.begin <= lba && lba < range.end;
+                   },
+                   &range)}) {
+            found->Detach();
+            mem::Free(&Entry::GetByTag(*found));
+        }
+    }
+
+    return *this;
+}
+
+bool DirIndex::Find(const stl::string_view name, const Visitor visitor,
+                    void* const arg) const noexcept {
+    dbg::Assert(visitor);
+    struct Query {
+        stl::size_t hash;
+        Visitor visitor;
+        void* arg;
+    } query {Hash(name), visitor, arg};
+
+    return buckets_[query.hash % bucket_count].Find(
+               [](const TagList::Tag& tag, void* const arg) noexcept {
+                   const auto& query {*static_cast<const Query*>(arg)};
+                   const auto& entry {Entry::GetByTag(tag)};
+                   return entry.hash == query.hash && query.visitor(entry.pos, query.arg);
+               },
+               &query)
+           != nullptr;
+}
+
+DirIndex& DirIndex::Clear() noexcept {
+    for (auto& bucket : buckets_) {
+        while (!bucket.IsEmpty()) {
+            mem::Free(&Entry::GetByTag(bucket.Pop()));
+        }
+    }
+
+    return *this;
+}
+
+}  // namespace io::fs
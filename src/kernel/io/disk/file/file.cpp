@@ -1,22 +1,32 @@
 #include "kernel/io/disk/file/file.h"
 #include "kernel/interrupt/intr.h"
 #include "kernel/io/disk/file/inode.h"
+#include "kernel/io/file/pipe.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/pool.h"
 
 namespace io::fs {
 
-File::File(File&& o) noexcept : flags {o.flags}, inode {o.inode}, pos {o.pos} {
+File::File(File&& o) noexcept :
+    flags {o.flags}, inode {o.inode}, pipe {o.pipe}, pos {o.pos}, readahead {o.readahead} {
     o.Clear();
 }
 
 File& File::Clear() noexcept {
     pos = 0;
+    readahead = {};
     flags = 0;
     inode = nullptr;
+    pipe = nullptr;
     return *this;
 }
 
 bool File::IsOpen() const noexcept {
-    return inode != nullptr;
+    return inode != nullptr || pipe != nullptr;
+}
+
+bool File::IsPipe() const noexcept {
+    return pipe != nullptr;
 }
 
 stl::size_t File::GetNodeIdx() const noexcept {
@@ -24,7 +34,9 @@ stl::size_t File::GetNodeIdx() const noexcept {
 }
 
 void File::Close() noexcept {
-    if (IsOpen()) {
+    if (IsPipe()) {
+        pipe->Close(flags.IsSet(io::File::OpenMode::WriteOnly));
+    } else if (IsOpen()) {
         if (flags.IsSet(io::File::OpenMode::WriteOnly)
             || flags.IsSet(io::File::OpenMode::ReadWrite)) {
             dbg::Assert(inode->write_deny);
@@ -38,12 +50,157 @@ void File::Close() noexcept {
 }
 
 IdxNode& File::GetNode() const noexcept {
-    dbg::Assert(IsOpen());
+    dbg::Assert(inode);
     return *inode;
 }
 
-FileTab<max_open_file_times>& GetFileTab() noexcept {
-    static FileTab<max_open_file_times> files;
+Pipe& File::GetPipe() const noexcept {
+    dbg::Assert(IsPipe());
+    return *pipe;
+}
+
+FileDesc FileTab::AllocDesc() noexcept {
+    while (true) {
+        {
+            const intr::IntrGuard guard;
+            if (free_top_ != npos) {
+                const auto desc {free_top_};
+                auto& slot {GetSlot(desc)};
+                free_top_ = slot.next_free;
+                slot.next_free = used;
+                return desc;
+            }
+        }
+
+        if (!Grow()) {
+            io::PrintlnStr("The system file table is full.");
+            return npos;
+        }
+    }
+}
+
+FileTab& FileTab::FreeDesc(const FileDesc desc) noexcept {
+    dbg::Assert(std_stream_count <= desc && desc < GetSize());
+    auto& slot {GetSlot(desc)};
+    if (slot.next_free != used) {
+        // The descriptor has been released, for example by a forked process sharing it.
+        return *this;
+    }
+
+    slot.file.Close();
+    const intr::IntrGuard guard;
+    slot.next_free = free_top_;
+    free_top_ = desc;
+    return *this;
+}
+
+FileDesc FileTab::ForkDesc(const FileDesc desc) noexcept {
+    auto& file {(*this)[desc]};
+    dbg::Assert(file.IsOpen());
+    if (!file.IsPipe()) {
+        dbg::Assert(file.GetNode().open_times > 0);
+        ++file.GetNode().open_times;
+        return desc;
+    }
+
+    // Each end of a pipe counts its descriptors, so it needs a new descriptor.
+    const auto dup {AllocDesc()};
+    if (!dup.IsValid()) {
+        return npos;
+    }
+
+    auto& dup_file {(*this)[dup]};
+    dup_file.Clear();
+    dup_file.flags = file.flags;
+    dup_file.pipe = &file.GetPipe().Open(file.flags.IsSet(io::File::OpenMode::WriteOnly));
+    return dup;
+}
+
+FileDesc FileTab::DupDesc(const FileDesc desc) noexcept {
+    const auto dup {AllocDesc()};
+    if (!dup.IsValid()) {
+        return npos;
+    }
+
+    auto& inode {(*this)[desc].GetNode()};
+    {
+        const intr::IntrGuard guard;
+        dbg::Assert(inode.open_times > 0);
+        ++inode.open_times;
+    }
+
+    auto& file {(*this)[dup]};
+    file.Clear();
+    file.inode = &inode;
+    file.flags = io::File::OpenMode::ReadOnly;
+    return dup;
+}
+
+bool FileTab::Grow() noexcept {
+    // Memory allocation may sleep, so the chunk is allocated with interrupts enabled.
+    // The table is shared by all processes, so it must be in kernel memory.
+    const auto chunk {mem::Allocate<Chunk>(mem::PoolType::Kernel, sizeof(Chunk))};
+    if (!chunk) {
+        return false;
+    }
+
+    const intr::IntrGuard guard;
+    if (free_top_ != npos) {
+        // Another thread has released or grown descriptors.
+        mem::Free(mem::PoolType::Kernel, chunk);
+        return true;
+    } else if (chunk_count_ == max_chunk_count) {
+        mem::Free(mem::PoolType::Kernel, chunk);
+        return false;
+    }
+
+    // The first descriptors are standard streams and are never allocated.
+    const auto first {chunk_count_ == 0 ? std_stream_count : 0};
+    const auto base {chunk_count_ * chunk_size};
+    chunks_[chunk_count_++] = chunk;
+    // Push descriptors in descending order, so lower ones are allocated first.
+    for (auto i {chunk_size}; i != first; --i) {
+        (*chunk)[i - 1].next_free = free_top_;
+        free_top_ = base + i - 1;
+    }
+
+    return true;
+}
+
+bool FileTab::Contain(const stl::size_t inode_idx) const noexcept {
+    for (stl::size_t i {std_stream_count}; i != GetSize(); ++i) {
+        if (const auto& file {GetSlot(i).file};
+            file.IsOpen() && !file.IsPipe() && file.GetNodeIdx() == inode_idx) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const File& FileTab::operator[](const FileDesc desc) const noexcept {
+    return GetSlot(desc).file;
+}
+
+File& FileTab::operator[](const FileDesc desc) noexcept {
+    return GetSlot(desc).file;
+}
+
+stl::size_t FileTab::GetSize() const noexcept {
+    return chunk_count_ * chunk_size;
+}
+
+const FileTab::Slot& FileTab::GetSlot(const FileDesc desc) const noexcept {
+    dbg::Assert(desc < GetSize());
+    return (*chunks_[desc / chunk_size])[desc % chunk_size];
+}
+
+FileTab::Slot& FileTab::GetSlot(const FileDesc desc) noexcept {
+    return const_cast<Slot&>(const_cast<const FileTab&>(*this).GetSlot(desc));
+}
+
+FileTab& GetFileTab() noexcept {
+    static FileTab files;
     return files;
 }
 
@@ -1,8 +1,75 @@
 #include "kernel/io/disk/file/inode.h"
-#include "kernel/memory/pool.h"
+#include "kernel/io/disk/file/dir_index.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/memory/slab.h"
+#include "kernel/stl/cstring.h"
 
 namespace io::fs {
 
+static_assert(sizeof(IdxNode) == IdxNode::legacy_size + sizeof(stl::size_t));
+static_assert(sizeof(IdxNode) <= IdxNode::aligned_size);
+
+namespace {
+
+//! An open index node, its cached single indirect block table and its directory index.
+struct OpenIdxNode {
+    IdxNode inode;
+
+    //! Whether @p indirect_lbas is loaded.
+    bool indirect_cached;
+
+    stl::array<stl::size_t, IdxNode::indirect_block_count> indirect_lbas;
+
+    //! The hashed index of entries if the index node refers to a directory and has been searched.
+    DirIndex* dir_index;
+
+    //! The number of program images running the file.
+    stl::size_t exec_count;
+};
+
+/**
+ * @brief A wrapper of a global variable representing the slab cache of open index nodes.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+mem::SlabCache<OpenIdxNode>& GetIdxNodeCache() noexcept {
+    static mem::SlabCache<OpenIdxNode> cache {"inode"};
+    return cache;
+}
+
+//! Get the slab object containing an index node allocated by @p IdxNode::Create.
+OpenIdxNode& GetOpenNode(const IdxNode& inode) noexcept {
+    // The index node is the first member of the slab object.
+    return *reinterpret_cast<OpenIdxNode*>(const_cast<IdxNode*>(&inode));
+}
+
+}  // namespace
+
+IdxNode* IdxNode::Create() noexcept {
+    const auto node {GetIdxNodeCache().Allocate()};
+    if (!node) {
+        return nullptr;
+    }
+
+    node->indirect_cached = false;
+    node->dir_index = nullptr;
+    node->exec_count = 0;
+    return &node->inode.Init();
+}
+
+void IdxNode::Destroy(IdxNode* const inode) noexcept {
+    dbg::Assert(inode && !inode->IsOpen());
+    inode->DropDirIndex();
+    GetIdxNodeCache().Free(&GetOpenNode(*inode));
+}
+
+const mem::SlabCacheBase& IdxNode::GetCache() noexcept {
+    return GetIdxNodeCache();
+}
+
 IdxNode::IdxNode() noexcept {
     Init();
 }
@@ -13,6 +80,10 @@ IdxNode& IdxNode::Init() noexcept {
     size = 0;
     open_times = 0;
     write_deny = false;
+    dirty = false;
+    stl::memset(direct_lbas_.data(), 0, sizeof(direct_lbas_));
+    indirect_tab_lba_ = 0;
+    double_indirect_tab_lba_ = 0;
     return *this;
 }
 
@@ -20,10 +91,66 @@ void IdxNode::Close() noexcept {
     const intr::IntrGuard guard;
     if (--open_times == 0) {
         tag.Detach();
-        mem::Free(mem::PoolType::Kernel, this);
+        DropDirIndex();
+        GetIdxNodeCache().Free(&GetOpenNode(*this));
+    }
+}
+
+const stl::size_t* IdxNode::GetCachedIndirectLbas() const noexcept {
+    const auto& node {GetOpenNode(*this)};
+    return node.indirect_cached ? node.indirect_lbas.data() : nullptr;
+}
+
+void IdxNode::CacheIndirectLbas(const stl::size_t* const lbas) const noexcept {
+    dbg::Assert(lbas);
+    auto& node {GetOpenNode(*this)};
+    stl::memcpy(node.indirect_lbas.data(), lbas, sizeof(node.indirect_lbas));
+    node.indirect_cached = true;
+}
+
+void IdxNode::DropIndirectLbas() const noexcept {
+    GetOpenNode(*this).indirect_cached = false;
+}
+
+DirIndex* IdxNode::GetDirIndex() const noexcept {
+    return GetOpenNode(*this).dir_index;
+}
+
+void IdxNode::SetDirIndex(DirIndex* const index) const noexcept {
+    DropDirIndex();
+    GetOpenNode(*this).dir_index = index;
+}
+
+void IdxNode::DropDirIndex() const noexcept {
+    auto& node {GetOpenNode(*this)};
+    if (node.dir_index) {
+        DirIndex::Destroy(node.dir_index);
+        node.dir_index = nullptr;
     }
 }
 
+bool IdxNode::DenyWriteForExec() const noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    if (write_deny) {
+        return false;
+    }
+
+    ++GetOpenNode(*this).exec_count;
+    return true;
+}
+
+bool IdxNode::AllowWriteForExec() const noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    auto& node {GetOpenNode(*this)};
+    dbg::Assert(node.exec_count > 0);
+    return --node.exec_count == 0;
+}
+
+bool IdxNode::IsExecuting() const noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    return GetOpenNode(*this).exec_count != 0;
+}
+
 IdxNode& IdxNode::GetByTag(const TagList::Tag& tag) noexcept {
     return tag.GetElem<IdxNode>();
 }
@@ -32,6 +159,7 @@ void IdxNode::CloneToPure(IdxNode& inode) const noexcept {
     stl::memcpy(&inode, this, sizeof(IdxNode));
     inode.open_times = 0;
     inode.write_deny = false;
+    inode.dirty = false;
     inode.tag = {};
 }
 
@@ -48,6 +176,15 @@ IdxNode& IdxNode::SetIndirectTabLba(const stl::size_t lba) noexcept {
     return *this;
 }
 
+stl::size_t IdxNode::GetDoubleIndirectTabLba() const noexcept {
+    return double_indirect_tab_lba_;
+}
+
+IdxNode& IdxNode::SetDoubleIndirectTabLba(const stl::size_t lba) noexcept {
+    double_indirect_tab_lba_ = lba;
+    return *this;
+}
+
 IdxNode& IdxNode::SetDirectLba(const stl::size_t idx, const stl::size_t lba) noexcept {
     dbg::Assert(idx < direct_block_count);
     direct_lbas_[idx] = lba;
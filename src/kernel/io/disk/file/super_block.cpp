@@ -15,6 +15,40 @@ bool SuperBlock::IsSignValid() const noexcept {
     return sign_ == sign;
 }
 
+bool SuperBlock::HasDoubleIndirect() const noexcept {
+    return version >= double_indirect_version;
+}
+
+bool SuperBlock::AreNodesAligned() const noexcept {
+    return version >= aligned_inode_version;
+}
+
+stl::size_t SuperBlock::GetNodeSize() const noexcept {
+    if (AreNodesAligned()) {
+        return IdxNode::aligned_size;
+    } else {
+        return HasDoubleIndirect() ? sizeof(IdxNode) : IdxNode::legacy_size;
+    }
+}
+
+bool SuperBlock::IsBlockSizeValid(const stl::size_t size) noexcept {
+    const auto sector_count {size / Disk::sector_size};
+    return size % Disk::sector_size == 0 && sector_count != 0
+           && sector_count <= max_block_sector_count && (sector_count & (sector_count - 1)) == 0;
+}
+
+bool SuperBlock::IsSummaryValid() const noexcept {
+    return summary_sign == valid_summary_sign;
+}
+
+stl::size_t SuperBlock::GetBlockSectorCount() const noexcept {
+    return block_sector_count != 0 ? block_sector_count : 1;
+}
+
+stl::size_t SuperBlock::GetBlockSize() const noexcept {
+    return GetBlockSectorCount() * Disk::sector_size;
+}
+
 PaddedSuperBlock& PaddedSuperBlock::WriteTo(Disk::Part& part,
                                             const stl::size_t block_bitmap_bit_len) noexcept {
     // Write the super block to the disk.
@@ -24,7 +58,7 @@ PaddedSuperBlock& PaddedSuperBlock::WriteTo(Disk::Part& part,
 
     // Write initialization data to the disk.
     const auto io_buf_size {stl::max(stl::max(inode_bitmap_sector_count, inodes_sector_count),
-                                     block_bitmap_sector_count)
+                                     stl::max(block_bitmap_sector_count, GetBlockSectorCount()))
                             * Disk::sector_size};
     const auto io_buf {mem::Allocate(io_buf_size)};
     mem::AssertAlloc(io_buf);
@@ -69,7 +103,8 @@ PaddedSuperBlock& PaddedSuperBlock::WriteRootDirNode(Disk& disk, void* const io_
                                                      const stl::size_t io_buf_size) noexcept {
     dbg::Assert(io_buf && io_buf_size >= inodes_sector_count * Disk::sector_size);
     stl::memset(io_buf, 0, io_buf_size);
-    const auto root {static_cast<IdxNode*>(io_buf) + root_inode_idx};
+    const auto root {reinterpret_cast<IdxNode*>(static_cast<stl::byte*>(io_buf)
+                                                + root_inode_idx * GetNodeSize())};
     root->idx = root_inode_idx;
     root->size = Directory::min_entry_count * sizeof(DirEntry);
     // The entries in the root directory are saved at the begging of the data area.
@@ -80,8 +115,9 @@ PaddedSuperBlock& PaddedSuperBlock::WriteRootDirNode(Disk& disk, void* const io_
 
 PaddedSuperBlock& PaddedSuperBlock::WriteRootDirEntries(Disk& disk, void* const io_buf,
                                                         const stl::size_t io_buf_size) noexcept {
-    const auto sector_count {RoundUpDivide<stl::size_t>(
-        Directory::min_entry_count * sizeof(DirEntry), Disk::sector_size)};
+    // The other sectors of the block are zero-filled.
+    const auto sector_count {GetBlockSectorCount()};
+    dbg::Assert(Directory::min_entry_count * sizeof(DirEntry) <= GetBlockSize());
     dbg::Assert(io_buf && io_buf_size >= sector_count * Disk::sector_size);
     stl::memset(io_buf, 0, io_buf_size);
 
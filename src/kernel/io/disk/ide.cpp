@@ -1,5 +1,11 @@
 #include "kernel/io/disk/ide.h"
+#include "kernel/interrupt/intr.h"
 #include "kernel/io/io.h"
+#include "kernel/io/video/console.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/thread/thd.h"
 
 namespace io {
 
@@ -22,8 +28,387 @@ inline constexpr stl::uint16_t alt_status_offset {0x206};
 inline constexpr stl::uint16_t ctrl_offset {alt_status_offset};
 }  // namespace port
 
+//! Bus-master registers, which are relative to the bus-master base port of a channel.
+namespace bm {
+inline constexpr stl::uint16_t cmd_offset {0};
+inline constexpr stl::uint16_t status_offset {2};
+inline constexpr stl::uint16_t prd_tab_offset {4};
+
+//! The bit starting transfers in the command register.
+inline constexpr stl::size_t start_pos {0};
+//! The bit making the controller write to memory in the command register.
+inline constexpr stl::size_t read_pos {3};
+
+//! The error bit in the status register.
+inline constexpr stl::byte error_mask {1 << 1};
+//! The interrupt bit in the status register.
+inline constexpr stl::byte intr_mask {1 << 2};
+}  // namespace bm
+
+//! The priority of worker threads.
+inline constexpr stl::size_t worker_priority {31};
+
+//! Whether a position is before another one in the elevator order.
+bool IsBefore(const Disk* const disk, const stl::size_t lba, const Disk* const other_disk,
+              const stl::size_t other_lba) noexcept {
+    // Disks of a channel are in the same array, so their addresses are ordered.
+    return disk != other_disk ? disk < other_disk : lba < other_lba;
+}
+
+//! Get the reading or writing command of a disk.
+Disk::Cmd GetTransferCmd(const Disk& disk, const bool write, const bool dma) noexcept {
+    if (disk.IsLba48Enabled()) {
+        if (dma) {
+            return write ? Disk::Cmd::WriteDmaExt : Disk::Cmd::ReadDmaExt;
+        } else {
+            return write ? Disk::Cmd::WriteExt : Disk::Cmd::ReadExt;
+        }
+    } else {
+        if (dma) {
+            return write ? Disk::Cmd::WriteDma : Disk::Cmd::ReadDma;
+        } else {
+            return write ? Disk::Cmd::Write : Disk::Cmd::Read;
+        }
+    }
+}
+
 }  // namespace
 
+IdeChnl::Request& IdeChnl::Request::GetByTag(const TagList::Tag& tag) noexcept {
+    return tag.GetElem<Request>();
+}
+
+stl::size_t IdeChnl::Request::GetEndLba() const noexcept {
+    return lba + count;
+}
+
+void IdeChnl::Enqueue(Request& req) const noexcept {
+    // Find the first request after the new one.
+    const auto after {reqs_.Find(
+        [](const TagList::Tag& tag, void* const arg) noexcept {
+            const auto& new_req {*static_cast<const Request*>(arg)};
+            const auto& req {Request::GetByTag(tag)};
+            return IsBefore(new_req.disk, new_req.lba, req.disk, req.lba);
+        },
+        &req)};
+
+    if (after) {
+        TagList::InsertBefore(*after, req.tag);
+    } else {
+        reqs_.PushBack(req.tag);
+    }
+}
+
+//! A cursor over the buffers of a batch of requests.
+class IdeChnl::BatchCursor {
+public:
+    explicit BatchCursor(Request& batch) noexcept : req_ {&batch} {}
+
+    /**
+     * @brief Visit the buffers of a number of sectors and move the cursor past them.
+     *
+     * @param visitor A callable object taking a buffer and its number of sectors.
+     */
+    template <typename Visitor>
+    BatchCursor& Advance(stl::size_t count, Visitor visitor) noexcept {
+        while (count > 0) {
+            dbg::Assert(req_);
+            const auto curr_count {stl::min(count, req_->count - offset_)};
+            visitor(req_->buf + offset_ * Disk::sector_size, curr_count);
+            offset_ += curr_count;
+            count -= curr_count;
+            if (offset_ == req_->count) {
+                req_ = req_->merged;
+                offset_ = 0;
+            }
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Get the buffer of the current request.
+     *
+     * @param[out] count The number of sectors left in the current request.
+     */
+    stl::byte* Peek(stl::size_t& count) const noexcept {
+        dbg::Assert(req_);
+        count = req_->count - offset_;
+        return req_->buf + offset_ * Disk::sector_size;
+    }
+
+private:
+    Request* req_;
+
+    //! The number of sectors already visited in the current request.
+    stl::size_t offset_ {0};
+};
+
+/**
+ * @brief The physical region descriptor.
+ *
+ * @details
+ * It describes a physically contiguous memory region for bus-master transfers.
+ * A region cannot cross a 64 KB boundary.
+ */
+struct IdeChnl::PrdEntry {
+    //! The maximum number of entries in a table, which is one page large.
+    static constexpr stl::size_t max_count {mem::page_size / sizeof(stl::uint64_t)};
+
+    //! The bit marking the last entry of a table.
+    static constexpr stl::size_t end_pos {15};
+
+    stl::uint32_t phy_addr;
+
+    //! The number of bytes, where @p 0 means 64 KB.
+    stl::uint16_t size;
+
+    stl::uint16_t flags;
+};
+
+void IdeChnl::Transfer(Request& batch) const noexcept {
+    auto& disk {*batch.disk};
+    stl::size_t total_count {0};
+    for (auto req {&batch}; req; req = req->merged) {
+        total_count += req->count;
+    }
+
+    disk.Select();
+    BatchCursor cursor {batch};
+    stl::size_t done_count {0};
+    while (done_count < total_count) {
+        auto curr_count {stl::min(total_count - done_count, disk.GetMaxSectorCountPerAccess())};
+        const auto lba {batch.lba + done_count};
+        {
+            const intr::IntrGuard guard;
+            ++disk.stats_.cmd_count;
+        }
+
+        const auto succeeded {disk.IsDmaEnabled()
+                                  ? TransferDma(disk, batch.write, lba, curr_count, cursor)
+                                  : TransferPio(disk, batch.write, lba, curr_count, cursor)};
+        if (!succeeded) {
+            io::Console::Printf("Failed to {} the disk '{}', LBA {}.\n",
+                                batch.write ? "write data to" : "read", disk.GetName(), lba);
+            dbg::Assert(false);
+        }
+
+        done_count += curr_count;
+    }
+}
+
+bool IdeChnl::TransferPio(Disk& disk, const bool write, const stl::size_t lba,
+                          const stl::size_t count, BatchCursor& cursor) const noexcept {
+    disk.SetSectors(lba, count);
+    disk.SendCmd(GetTransferCmd(disk, write, false));
+    // The disk does not raise an interrupt before it accepts the first sector to write.
+    if (write && !disk.BusyWait()) {
+        return false;
+    }
+
+    // The disk raises an interrupt for each sector.
+    // When reading, it has prepared a sector. When writing, it has written a sector.
+    auto succeeded {true};
+    auto left_count {count};
+    cursor.Advance(count, [this, &disk, write, &succeeded, &left_count](
+                              stl::byte* buf, const stl::size_t count) noexcept {
+        constexpr auto word_count {Disk::sector_size / sizeof(stl::uint16_t)};
+        for (stl::size_t i {0}; i != count && succeeded; ++i, buf += Disk::sector_size) {
+            --left_count;
+            if (write) {
+                // The last word may raise the interrupt at once, so the wait is armed first.
+                NeedToWaitForIntr();
+                disk.WriteWords(buf, word_count);
+                // The disk is ready for the next sector, or has finished the command.
+                succeeded = disk.WaitForIntr(left_count != 0);
+            } else {
+                succeeded = disk.WaitForIntr(true);
+                if (succeeded) {
+                    // Start waiting before the sector is taken, since the next interrupt may follow at once.
+                    if (left_count != 0) {
+                        NeedToWaitForIntr();
+                    }
+
+                    disk.ReadWords(buf, word_count);
+                }
+            }
+        }
+    });
+
+    return succeeded;
+}
+
+bool IdeChnl::TransferDma(Disk& disk, const bool write, const stl::size_t lba,
+                          stl::size_t& count, BatchCursor& cursor) const noexcept {
+    static_assert(sizeof(PrdEntry) == sizeof(stl::uint64_t));
+    dbg::Assert(IsBusMasterEnabled());
+    // Describe the buffers page by page, since pages are not physically contiguous.
+    // A page never crosses a 64 KB boundary.
+    stl::size_t entry_count {0};
+    stl::size_t described_count {0};
+    while (described_count != count) {
+        stl::size_t buf_count {0};
+        const auto buf {reinterpret_cast<stl::uintptr_t>(cursor.Peek(buf_count))};
+        // Only whole sectors fitting in the rest of the table are described.
+        const auto fit_count {((PrdEntry::max_count - entry_count) * mem::page_size
+                               - buf % mem::page_size)
+                              / Disk::sector_size};
+        buf_count = stl::min(stl::min(buf_count, count - described_count), fit_count);
+        if (buf_count == 0) {
+            break;
+        }
+
+        const auto end {buf + buf_count * Disk::sector_size};
+        for (auto addr {buf}; addr < end;) {
+            const auto size {stl::min(end - addr, mem::page_size - addr % mem::page_size)};
+            dbg::Assert(entry_count < PrdEntry::max_count);
+            prd_tab_[entry_count++] = {mem::VrAddr {addr}.GetPhyAddr(),
+                                       static_cast<stl::uint16_t>(size), 0};
+            addr += size;
+        }
+
+        cursor.Advance(buf_count, [](stl::byte*, stl::size_t) noexcept {});
+        described_count += buf_count;
+    }
+
+    dbg::Assert(entry_count > 0 && described_count > 0);
+    count = described_count;
+    bit::SetBit(prd_tab_[entry_count - 1].flags, PrdEntry::end_pos);
+
+    const auto cmd_port {GetBusMasterCmdPort()};
+    const auto status_port {GetBusMasterStatusPort()};
+    WriteDoubleWordToPort(GetBusMasterPrdTabPort(), mem::VrAddr {prd_tab_}.GetPhyAddr());
+    // The direction bit is set when the controller writes to memory.
+    stl::byte cmd {0};
+    if (!write) {
+        bit::SetBit(cmd, bm::read_pos);
+    }
+
+    WriteByteToPort(cmd_port, cmd);
+    // Clear the error and interrupt bits by writing ones.
+    WriteByteToPort(status_port, bm::error_mask | bm::intr_mask);
+
+    disk.SetSectors(lba, count);
+    disk.SendCmd(GetTransferCmd(disk, write, true));
+    bit::SetBit(cmd, bm::start_pos);
+    WriteByteToPort(cmd_port, cmd);
+    // The CPU is free for other threads until the controller finishes the transfer and raises an interrupt.
+    const auto succeeded {disk.WaitForIntr(false)};
+
+    bit::ResetBit(cmd, bm::start_pos);
+    WriteByteToPort(cmd_port, cmd);
+    const auto status {ReadByteFromPort(status_port)};
+    WriteByteToPort(status_port, bm::error_mask | bm::intr_mask);
+    return succeeded && (status & bm::error_mask) == 0;
+}
+
+IdeChnl::Request* IdeChnl::PopBatch() const noexcept {
+    const intr::IntrGuard guard;
+    if (reqs_.IsEmpty()) {
+        return nullptr;
+    }
+
+    // Continue from the last served position, or jump back to the lowest position.
+    auto found {reqs_.Find(
+        [](const TagList::Tag& tag, void* const arg) noexcept {
+            const auto& chnl {*static_cast<const IdeChnl*>(arg)};
+            const auto& req {Request::GetByTag(tag)};
+            return !IsBefore(req.disk, req.lba, chnl.head_disk_, chnl.head_lba_);
+        },
+        const_cast<IdeChnl*>(this))};
+
+    auto& batch {found ? Request::GetByTag(*found) : Request::GetByTag(reqs_.Pop())};
+    if (found) {
+        found->Detach();
+    }
+
+    --batch.disk->stats_.queue_depth;
+    batch.merged = nullptr;
+    auto last {&batch};
+    auto total_count {batch.count};
+    // Merge requests following the batch until a command is full.
+    while (true) {
+        const auto next {reqs_.Find(
+            [](const TagList::Tag& tag, void* const arg) noexcept {
+                const auto& last {*static_cast<const Request*>(arg)};
+                const auto& req {Request::GetByTag(tag)};
+                return req.disk == last.disk && req.write == last.write
+                       && req.lba == last.GetEndLba();
+            },
+            last)};
+
+        if (!next) {
+            break;
+        }
+
+        auto& req {Request::GetByTag(*next)};
+        if (total_count + req.count > batch.disk->GetMaxSectorCountPerAccess()) {
+            break;
+        }
+
+        next->Detach();
+        --req.disk->stats_.queue_depth;
+        ++req.disk->stats_.merged_count;
+        req.merged = nullptr;
+        last->merged = &req;
+        last = &req;
+        total_count += req.count;
+    }
+
+    head_disk_ = last->disk;
+    head_lba_ = last->GetEndLba();
+    return &batch;
+}
+
+void IdeChnl::Submit(Request& req) const noexcept {
+    SubmitAsync(req);
+    Wait(req);
+}
+
+void IdeChnl::SubmitAsync(Request& req) const noexcept {
+    dbg::Assert(req.disk && req.buf && req.count > 0);
+    req.submit_tsc = ReadTsc();
+    const intr::IntrGuard guard;
+    Enqueue(req);
+    auto& stats {req.disk->stats_};
+    stats.max_queue_depth = stl::max(stats.max_queue_depth, ++stats.queue_depth);
+    worker_.WakeOne();
+}
+
+void IdeChnl::Wait(Request& req) const noexcept {
+    req.done.acquire();
+    req.disk->RecordRequest(req.lba, req.count, req.write, ReadTsc() - req.submit_tsc);
+}
+
+void IdeChnl::Serve(void* const chnl) noexcept {
+    dbg::Assert(chnl);
+    const auto& self {*static_cast<const IdeChnl*>(chnl)};
+    while (true) {
+        {
+            const intr::IntrGuard guard;
+            while (self.reqs_.IsEmpty()) {
+                self.worker_.Wait();
+            }
+        }
+
+        // Serve the queue until it is empty, including requests submitted meanwhile.
+        while (const auto batch {self.PopBatch()}) {
+            self.Transfer(*batch);
+            for (auto done {batch}; done;) {
+                // A completed request may be released by its submitter once it is woken up.
+                const auto next {done->merged};
+                done->done.release();
+                done = next;
+            }
+        }
+    }
+}
+
+IdeChnl& IdeChnl::StartWorker() noexcept {
+    tsk::KrnlThread::Create(GetName(), worker_priority, &Serve, this);
+    return *this;
+}
+
 IdeChnls& GetIdeChnls() noexcept {
     static IdeChnls chnls;
     return chnls;
@@ -97,12 +482,26 @@ IdeChnl& IdeChnl::SetType(const Type type) noexcept {
     return *this;
 }
 
-void IdeChnl::Block() const noexcept {
-    disk_done_.acquire();
+bool IdeChnl::WaitForIntr(stl::uint8_t& status, const stl::size_t milliseconds) const noexcept {
+    const intr::IntrGuard guard;
+    // If the interrupt has arrived before the wait starts, the flag is cleared and the status is saved.
+    while (waiting_intr_) {
+        if (!intr_waiter_.Wait(milliseconds)) {
+            // An interrupt arriving after the timeout is ignored.
+            waiting_intr_ = false;
+            return false;
+        }
+    }
+
+    status = intr_status_;
+    return true;
 }
 
-void IdeChnl::Unblock() const noexcept {
-    disk_done_.release();
+void IdeChnl::CompleteIntr(const stl::uint8_t status) const noexcept {
+    const intr::IntrGuard guard;
+    intr_status_ = status;
+    waiting_intr_ = false;
+    intr_waiter_.WakeOne();
 }
 
 stl::uint16_t IdeChnl::GetSectorCountPort() const noexcept {
@@ -173,14 +572,37 @@ const IdeChnl& IdeChnl::NeedToWaitForIntr(const bool wait) const noexcept {
     return *this;
 }
 
-stl::mutex& IdeChnl::GetLock() const noexcept {
-    return mtx_;
-}
-
 bool IdeChnl::IsWaitingForIntr() const noexcept {
     return waiting_intr_;
 }
 
+IdeChnl& IdeChnl::EnableBusMaster(const stl::uint16_t port) noexcept {
+    dbg::Assert(port != 0 && !IsBusMasterEnabled());
+    prd_tab_ = mem::AllocPages<PrdEntry>(mem::PoolType::Kernel);
+    mem::AssertAlloc(prd_tab_);
+    bm_port_ = port;
+    return *this;
+}
+
+bool IdeChnl::IsBusMasterEnabled() const noexcept {
+    return bm_port_ != 0;
+}
+
+stl::uint16_t IdeChnl::GetBusMasterCmdPort() const noexcept {
+    dbg::Assert(IsBusMasterEnabled());
+    return bm_port_ + bm::cmd_offset;
+}
+
+stl::uint16_t IdeChnl::GetBusMasterStatusPort() const noexcept {
+    dbg::Assert(IsBusMasterEnabled());
+    return bm_port_ + bm::status_offset;
+}
+
+stl::uint16_t IdeChnl::GetBusMasterPrdTabPort() const noexcept {
+    dbg::Assert(IsBusMasterEnabled());
+    return bm_port_ + bm::prd_tab_offset;
+}
+
 stl::uint16_t IdeChnl::GetBasePort() const noexcept {
     dbg::Assert(type_ != Type::Invalid);
     return base_port_;
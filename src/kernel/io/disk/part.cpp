@@ -1,14 +1,20 @@
 #include "kernel/interrupt/intr.h"
+#include "kernel/io/disk/cache.h"
 #include "kernel/io/disk/disk.h"
+#include "kernel/io/disk/file/dentry.h"
+#include "kernel/io/disk/file/dir_index.h"
 #include "kernel/io/disk/file/inode.h"
 #include "kernel/io/disk/file/super_block.h"
 #include "kernel/io/disk/ide.h"
 #include "kernel/io/video/print.h"
+#include "kernel/krnl.h"
 #include "kernel/memory/pool.h"
+#include "kernel/thread/thd.h"
 
 namespace io {
 
 static_assert(sizeof(fs::IdxNode) < Disk::sector_size);
+static_assert(Disk::sector_size % fs::IdxNode::aligned_size == 0);
 
 namespace {
 
@@ -21,27 +27,63 @@ inline constexpr stl::size_t bit_count_per_sector {Disk::sector_size * bit::byte
 //! The number of directory entries in a sector.
 inline constexpr stl::size_t dir_entry_count_per_sector {Disk::sector_size / sizeof(fs::DirEntry)};
 
-//! The number of sectors used by a single indirect block table.
+/**
+ * @brief The number of sectors used by a single indirect block table.
+ *
+ * @details
+ * A block table only uses the first sector of its block, whatever the block size is.
+ */
 inline constexpr stl::size_t indirect_tab_sector_count_per_inode {1};
 
 /**
- * @brief The number of sectors in an index node's indirect blocks.
+ * @brief The number of blocks in an index node's indirect blocks.
  *
  * @details
- * In our system, a block is a sector in an index node.
+ * In our system, a block is one or more sectors, as recorded in the super block.
  */
 inline constexpr stl::size_t indirect_sector_count_per_inode {
     indirect_tab_sector_count_per_inode * Disk::sector_size / sizeof(stl::size_t)};
 
 /**
- * @brief The number of sectors in an index node's blocks, including both direct and indirect blocks.
+ * @brief The number of blocks in an index node's direct and single indirect blocks.
  *
  * @details
- * In our system, a block is a sector in an index node.
+ * It is the maximum number of blocks of a directory, or of a file on legacy file systems.
  */
 inline constexpr stl::size_t sector_count_per_inode {fs::IdxNode::direct_block_count
                                                      + indirect_sector_count_per_inode};
 
+//! The number of blocks in an index node's double indirect blocks.
+inline constexpr stl::size_t double_indirect_sector_count_per_inode {
+    indirect_sector_count_per_inode * indirect_sector_count_per_inode};
+
+//! The number of blocks in an index node's all blocks, including double indirect blocks.
+inline constexpr stl::size_t max_sector_count_per_inode {sector_count_per_inode
+                                                         + double_indirect_sector_count_per_inode};
+
+//! Get the maximum number of blocks of a file.
+stl::size_t GetMaxBlockCountPerFile(const fs::SuperBlock& super_block) noexcept {
+    return super_block.HasDoubleIndirect() ? max_sector_count_per_inode : sector_count_per_inode;
+}
+
+/**
+ * @brief Get the index after the last block that shares an indirect block table with a block.
+ *
+ * @details
+ * Direct blocks are regarded as sharing a table.
+ */
+stl::size_t GetTabEnd(const stl::size_t sector_idx) noexcept {
+    if (sector_idx < fs::IdxNode::direct_block_count) {
+        return fs::IdxNode::direct_block_count;
+    } else if (sector_idx < sector_count_per_inode) {
+        return sector_count_per_inode;
+    } else {
+        const auto tab_idx {(sector_idx - sector_count_per_inode)
+                            / indirect_sector_count_per_inode};
+        return sector_count_per_inode + (tab_idx + 1) * indirect_sector_count_per_inode;
+    }
+}
+
 //! The position of an index node in a partition.
 struct IdxNodePos {
     IdxNodePos(const Disk::FilePart& part, const fs::IdxNode& inode) noexcept :
@@ -49,39 +91,134 @@ struct IdxNodePos {
 
     IdxNodePos(const Disk::FilePart& part, const stl::size_t idx) noexcept {
         dbg::Assert(idx < max_file_count_per_part);
-        const auto offset {idx * sizeof(fs::IdxNode)};
+        // Legacy file systems have smaller index nodes.
+        // Sector-aligned file systems pad index nodes, so they are never across two sectors.
+        const auto& super_block {part.GetSuperBlock()};
+        const auto slot_size {super_block.GetNodeSize()};
+        size = stl::min(slot_size, sizeof(fs::IdxNode));
+        const auto offset {idx * slot_size};
         offset_in_sector = offset % Disk::sector_size;
-        lba = part.GetSuperBlock().inodes_start_lba + offset / Disk::sector_size;
+        lba = super_block.inodes_start_lba + offset / Disk::sector_size;
         dbg::Assert(lba < part.GetStartLba() + part.GetSectorCount());
-        is_across_sectors = Disk::sector_size - offset_in_sector < sizeof(fs::IdxNode);
     }
 
-    //! Whether the index node is across two sectors.
-    bool is_across_sectors;
-
     //! The sector LBA.
     stl::size_t lba;
 
     //! The offset in the sector.
     stl::size_t offset_in_sector;
+
+    //! The size of the index node on the disk, excluding its padding.
+    stl::size_t size;
 };
 
-//! Load an index node's all block LBAs, including both direct and indirect blocks.
-stl::array<stl::size_t, sector_count_per_inode> LoadNodeLbas(const Disk& disk,
-                                                             const fs::IdxNode& inode) noexcept {
-    stl::array<stl::size_t, sector_count_per_inode> lbas;
+static_assert(fs::IdxNode::indirect_block_count == indirect_sector_count_per_inode);
+
+/**
+ * @brief Load an open index node's single indirect block table.
+ *
+ * @details
+ * The table is only read from the disk the first time. Later loads use the table cached on the index node.
+ *
+ * @return The LBAs in the table.
+ */
+const stl::size_t* LoadIndirectLbas(const Disk& disk, const fs::IdxNode& inode) noexcept {
+    if (const auto cached_lbas {inode.GetCachedIndirectLbas()}; cached_lbas) {
+        return cached_lbas;
+    }
 
+    const auto indirect_tab_lba {inode.GetIndirectTabLba()};
+    dbg::Assert(indirect_tab_lba != 0);
+    const auto lbas {mem::AllocateUninit<stl::size_t>(Disk::sector_size)};
+    mem::AssertAlloc(lbas);
+    GetBlockCache().Read(disk, indirect_tab_lba, lbas, indirect_tab_sector_count_per_inode);
+    inode.CacheIndirectLbas(lbas);
+    mem::Free(lbas);
+    return inode.GetCachedIndirectLbas();
+}
+
+//! Save the LBAs to an open index node's single indirect block table and keep its cache coherent.
+void SaveIndirectLbas(Disk& disk, const fs::IdxNode& inode,
+                      const stl::size_t* const lbas) noexcept {
+    dbg::Assert(lbas);
+    const auto indirect_tab_lba {inode.GetIndirectTabLba()};
+    dbg::Assert(indirect_tab_lba != 0);
+    GetBlockCache().Write(disk, indirect_tab_lba, lbas, indirect_tab_sector_count_per_inode);
+    inode.CacheIndirectLbas(lbas);
+}
+
+/**
+ * @brief Load an index node's block LBAs in the range <tt>[begin, end)</tt>.
+ *
+ * @param[out] lbas A buffer for <tt>end - begin</tt> block LBAs. Unallocated blocks are @p 0.
+ */
+void LoadNodeLbas(const Disk& disk, const fs::IdxNode& inode, stl::size_t* const lbas,
+                  const stl::size_t begin, const stl::size_t end) noexcept {
+    dbg::Assert(lbas && begin <= end && end <= max_sector_count_per_inode);
+    auto i {begin};
     // Load direct blocks.
-    for (stl::size_t i {0}; i != fs::IdxNode::direct_block_count; ++i) {
-        lbas[i] = inode.GetDirectLba(i);
+    for (; i < stl::min(end, fs::IdxNode::direct_block_count); ++i) {
+        lbas[i - begin] = inode.GetDirectLba(i);
     }
 
-    // Load indirect blocks.
-    if (const auto indirect_tab_lba {inode.GetIndirectTabLba()}; indirect_tab_lba != 0) {
-        disk.ReadSectors(indirect_tab_lba, lbas.data() + fs::IdxNode::direct_block_count,
-                         indirect_tab_sector_count_per_inode);
+    // Load single indirect blocks.
+    if (const auto single_end {stl::min(end, sector_count_per_inode)}; i < single_end) {
+        const auto count {single_end - i};
+        if (inode.GetIndirectTabLba() != 0) {
+            stl::memcpy(lbas + (i - begin),
+                        LoadIndirectLbas(disk, inode) + (i - fs::IdxNode::direct_block_count),
+                        count * sizeof(stl::size_t));
+        } else {
+            stl::memset(lbas + (i - begin), 0, count * sizeof(stl::size_t));
+        }
+
+        i = single_end;
+    }
+
+    if (i == end) {
+        return;
+    }
+
+    // Load double indirect blocks.
+    const auto double_indirect_tab_lba {inode.GetDoubleIndirectTabLba()};
+    if (double_indirect_tab_lba == 0) {
+        stl::memset(lbas + (i - begin), 0, (end - i) * sizeof(stl::size_t));
+        return;
+    }
+
+    const auto tabs {mem::AllocateUninit<stl::size_t>(2 * Disk::sector_size)};
+    mem::AssertAlloc(tabs);
+    const auto outer_tab {tabs};
+    const auto inner_tab {tabs + indirect_sector_count_per_inode};
+    GetBlockCache().Read(disk, double_indirect_tab_lba, outer_tab);
+    while (i < end) {
+        const auto offset {i - sector_count_per_inode};
+        const auto inner_idx {offset % indirect_sector_count_per_inode};
+        const auto count {stl::min(end - i, indirect_sector_count_per_inode - inner_idx)};
+        if (const auto inner_tab_lba {outer_tab[offset / indirect_sector_count_per_inode]};
+            inner_tab_lba != 0) {
+            GetBlockCache().Read(disk, inner_tab_lba, inner_tab);
+            stl::memcpy(lbas + (i - begin), inner_tab + inner_idx, count * sizeof(stl::size_t));
+        } else {
+            stl::memset(lbas + (i - begin), 0, count * sizeof(stl::size_t));
+        }
+
+        i += count;
     }
 
+    mem::Free(tabs);
+}
+
+/**
+ * @brief Load an index node's direct and single indirect block LBAs.
+ *
+ * @details
+ * Directories do not use double indirect blocks.
+ */
+stl::array<stl::size_t, sector_count_per_inode> LoadNodeLbas(const Disk& disk,
+                                                             const fs::IdxNode& inode) noexcept {
+    stl::array<stl::size_t, sector_count_per_inode> lbas;
+    LoadNodeLbas(disk, inode, lbas.data(), 0, lbas.size());
     return lbas;
 }
 
@@ -93,34 +230,54 @@ stl::array<stl::size_t, sector_count_per_inode> LoadNodeLbas(const Disk& disk,
  * We use a simple calculation, but it is inaccurate and causes some memory waste.
  *
  * @param free_sector_count The number of free sectors.
+ * @param block_sector_count The number of sectors in a block.
  * @param[out] block_bitmap_bit_len The number of bits in the block bitmap.
  * @return The number of sectors in the block bitmap.
  */
 stl::size_t CalcSectorCountForBlockBitmap(const stl::size_t free_sector_count,
+                                          const stl::size_t block_sector_count,
                                           stl::size_t& block_bitmap_bit_len) noexcept {
     // Calculate the number of sectors needed for free blocks in the block bitmap
     // Each free block needs a bit.
-    const auto block_bitmap_sector_count {RoundUpDivide(free_sector_count, bit_count_per_sector)};
+    const auto block_bitmap_sector_count {
+        RoundUpDivide(free_sector_count / block_sector_count, bit_count_per_sector)};
     // The remaining blocks can be used by users.
-    block_bitmap_bit_len = free_sector_count - block_bitmap_sector_count;
+    block_bitmap_bit_len = (free_sector_count - block_bitmap_sector_count) / block_sector_count;
     return RoundUpDivide(block_bitmap_bit_len, bit_count_per_sector);
 }
 
-//! Format a partition and create a file system in it.
-void FormatPart(Disk::Part& part) noexcept {
+/**
+ * @brief The block size of new file systems.
+ *
+ * @details
+ * It can be 512 bytes, 1, 2 or 4 KiB.
+ * Larger blocks make bitmaps and block tables cover more data and transfer files with fewer commands,
+ * but waste more space for small files and directories.
+ */
+inline constexpr stl::size_t default_block_size {Disk::sector_size};
+
+/**
+ * @brief Format a partition and create a file system in it.
+ *
+ * @param block_size The size of a block in bytes.
+ */
+void FormatPart(Disk::Part& part, const stl::size_t block_size = default_block_size) noexcept {
+    dbg::Assert(fs::SuperBlock::IsBlockSizeValid(block_size));
+    const auto block_sector_count {block_size / Disk::sector_size};
     // Calculate the numbers of sectors for the super block, index nodes and bitmaps.
     constexpr stl::size_t super_block_sector_count {
         RoundUpDivide<stl::size_t>(sizeof(fs::PaddedSuperBlock), Disk::sector_size)};
     dbg::Assert(max_file_count_per_part % bit_count_per_sector == 0);
     constexpr auto inode_bitmap_sector_count {max_file_count_per_part / bit_count_per_sector};
-    const auto inodes_sector_count {RoundUpDivide<stl::size_t>(
-        max_file_count_per_part * sizeof(fs::IdxNode), Disk::sector_size)};
+    // Index nodes are padded, so none of them is across two sectors.
+    constexpr auto inodes_sector_count {
+        max_file_count_per_part * fs::IdxNode::aligned_size / Disk::sector_size};
     const auto used_sector_count {boot_sector_count + super_block_sector_count
                                   + inode_bitmap_sector_count + inodes_sector_count};
     const auto free_sector_count {part.GetSectorCount() - used_sector_count};
     stl::size_t block_bitmap_bit_len {0};
     const auto block_bitmap_sector_count {
-        CalcSectorCountForBlockBitmap(free_sector_count, block_bitmap_bit_len)};
+        CalcSectorCountForBlockBitmap(free_sector_count, block_sector_count, block_bitmap_bit_len)};
 
     // Initialize the super block and write it to the partition.
     fs::PaddedSuperBlock super_block {};
@@ -142,6 +299,16 @@ void FormatPart(Disk::Part& part) noexcept {
 
     super_block.data_start_lba = super_block.inodes_start_lba + super_block.inodes_sector_count;
     super_block.root_inode_idx = fs::root_inode_idx;
+    super_block.version = fs::SuperBlock::curr_version;
+    super_block.block_sector_count = block_sector_count;
+
+    // The root directory occupies the first index node and the first block.
+    super_block.summary_sign = fs::SuperBlock::valid_summary_sign;
+    super_block.block_count = block_bitmap_bit_len;
+    super_block.free_block_count = block_bitmap_bit_len - 1;
+    super_block.free_inode_count = max_file_count_per_part - 1;
+    super_block.free_block_hint = 1;
+    super_block.free_inode_hint = 1;
 
     super_block.WriteTo(part, block_bitmap_bit_len);
 }
@@ -162,7 +329,7 @@ Disk::FilePart*& GetDefaultPartImpl() noexcept {
 stl::array<fs::DirEntry, dir_entry_count_per_sector> LoadDirEntries(
     const Disk& disk, const stl::size_t lba) noexcept {
     stl::array<fs::DirEntry, dir_entry_count_per_sector + 1> padded_entries;
-    disk.ReadSectors(lba, padded_entries.data());
+    GetBlockCache().Read(disk, lba, padded_entries.data());
     stl::array<fs::DirEntry, dir_entry_count_per_sector> entries;
     stl::memcpy(entries.data(), padded_entries.data(), entries.size() * sizeof(fs::DirEntry));
     return entries;
@@ -172,38 +339,304 @@ stl::array<fs::DirEntry, dir_entry_count_per_sector> LoadDirEntries(
 fs::DirEntry* LoadDirEntries(const Disk& disk, const stl::size_t lba, void* const buf,
                              const stl::size_t buf_size) noexcept {
     dbg::Assert(buf && buf_size >= Disk::sector_size);
-    disk.ReadSectors(lba, buf);
+    GetBlockCache().Read(disk, lba, buf);
     return static_cast<fs::DirEntry*>(buf);
 }
 
 /**
- * @brief Mount the default partition.
+ * @brief Build the hashed index of a directory's entries.
+ *
+ * @return The index, or @p nullptr if there is no free memory.
+ */
+fs::DirIndex* BuildDirIndex(const Disk& disk, const fs::IdxNode& inode,
+                            const stl::size_t block_sector_count) noexcept {
+    const auto index {fs::DirIndex::Create()};
+    if (!index) {
+        return nullptr;
+    }
+
+    for (const auto lba : LoadNodeLbas(disk, inode)) {
+        if (lba == 0) {
+            continue;
+        }
+
+        for (stl::size_t i {0}; i != block_sector_count; ++i) {
+            const auto entries {LoadDirEntries(disk, lba + i)};
+            for (stl::size_t j {0}; j != entries.size(); ++j) {
+                if (const auto& entry {entries[j]};
+                    entry.type != fs::FileType::Unknown
+                    && !index->Insert(entry.name.data(), {lba + i, j})) {
+                    fs::DirIndex::Destroy(index);
+                    return nullptr;
+                }
+            }
+        }
+    }
+
+    return index;
+}
+
+//! Add a directory entry to the directory's hashed index if the index has been built.
+void IndexDirEntry(const fs::IdxNode& inode, const fs::DirEntry& entry, const stl::size_t lba,
+                   const stl::size_t idx) noexcept {
+    if (const auto index {inode.GetDirIndex()};
+        index && !index->Insert(entry.name.data(), {lba, idx})) {
+        // An incomplete index would miss entries. It will be built again on the next search.
+        inode.DropDirIndex();
+    }
+}
+
+/**
+ * @brief Write entries to a new block of a directory.
+ *
+ * @details
+ * The rest of the block is zero-filled, since it may contain old data.
+ *
+ * @param lba The LBA of the block.
+ * @param block_sector_count The number of sectors in a block.
+ * @param entries Directory entries to be saved at the beginning of the block.
+ * @param count The number of entries.
+ */
+void WriteNewDirBlock(Disk& disk, const stl::size_t lba, const stl::size_t block_sector_count,
+                      const fs::DirEntry* const entries, const stl::size_t count) noexcept {
+    dbg::Assert(entries && count * sizeof(fs::DirEntry) <= Disk::sector_size);
+    const auto buf {mem::Allocate(block_sector_count * Disk::sector_size)};
+    mem::AssertAlloc(buf);
+    stl::memcpy(buf, entries, count * sizeof(fs::DirEntry));
+    GetBlockCache().Write(disk, lba, buf, block_sector_count);
+    mem::Free(buf);
+}
+
+/**
+ * @brief Format a partition if it does not have a file system.
+ *
+ * @details
+ * The super block is read by direct disk accesses, so it must be called before the block cache is used.
+ */
+void PrepareFileSys(Disk::FilePart& part) noexcept {
+    constexpr auto super_block_sector_count {
+        RoundUpDivide<stl::size_t>(sizeof(fs::PaddedSuperBlock), Disk::sector_size)};
+    const auto super_block {mem::Allocate<fs::SuperBlock>(sizeof(fs::PaddedSuperBlock))};
+    mem::AssertAlloc(super_block);
+    part.GetDisk().ReadSectors(part.GetStartLba() + fs::PaddedSuperBlock::start_lba, super_block,
+                               super_block_sector_count);
+    if (!super_block->IsSignValid()) {
+        // Create a file system in the partition.
+        FormatPart(part);
+        io::Printf("The file system on the partition '{}' has been formatted.\n", part.GetName());
+    } else {
+        io::Printf("The partition '{}' already has a file system.\n", part.GetName());
+    }
+
+    mem::Free(super_block);
+}
+
+/**
+ * @brief Find the default partition.
  *
  * @details
  * All file and directory operations use the default partition as the target.
+ * Only its disk is scanned, and other partitions are not touched.
  */
-void MountDefaultPart() noexcept {
+Disk::FilePart& FindDefaultPart() noexcept {
     constexpr stl::string_view default_part {"sdb1"};
-    GetDiskParts().Find(
-        [](const TagList::Tag& part_tag, void* const name) noexcept {
-            auto& part {Disk::FilePart::GetByTag(part_tag)};
-            if (part.GetName() == static_cast<const char*>(name)) {
-                GetDefaultPartImpl() = &part;
-                part.LoadSuperBlock();
-                io::Printf("The partition '{}' has been mounted.\n", part.GetName());
-                return true;
-            } else {
-                return false;
-            }
-        },
-        const_cast<char*>(default_part.data()));
-
-    if (!GetDefaultPartImpl()) {
+    const auto part {FindDiskPart(default_part)};
+    if (!part) {
         io::Printf("Failed to find the default mount partition '{}'.\n", default_part);
         dbg::Assert(false);
     }
+
+    return *part;
+}
+
+//! The priority of the metadata flusher thread.
+inline constexpr stl::size_t meta_flusher_priority {31};
+
+//! The interval between two write-backs of the metadata flusher thread.
+inline constexpr stl::size_t meta_flush_interval {SecondsToMilliseconds(1)};
+
+//! The metadata flusher thread that writes modified metadata of the default partition periodically.
+void WriteBackMeta(void*) noexcept {
+    while (true) {
+        tsk::Thread::GetCurrent().Sleep(meta_flush_interval);
+        GetDefaultPart().FlushMeta();
+    }
+}
+
+/**
+ * @brief Get the number of blocks that are contiguous on the disk from a block.
+ *
+ * @param lbas Block LBAs of a file.
+ * @param begin The index of the first block.
+ * @param end The index after the last block that can be included.
+ * @param block_sector_count The number of sectors in a block.
+ * @return The number of blocks, whose sectors are up to @p BlockCache::max_run_count.
+ */
+stl::size_t GetRunLen(const stl::size_t* const lbas, const stl::size_t begin, const stl::size_t end,
+                      const stl::size_t block_sector_count) noexcept {
+    dbg::Assert(lbas && begin < end);
+    const auto max_run_len {BlockCache::max_run_count / block_sector_count};
+    stl::size_t run_len {1};
+    while (begin + run_len < end && run_len < max_run_len
+           && lbas[begin + run_len] == lbas[begin] + run_len * block_sector_count) {
+        ++run_len;
+    }
+
+    return run_len;
 }
 
+//! The initial number of blocks to prefetch when a file is read sequentially.
+inline constexpr stl::size_t min_readahead_block_count {4};
+
+//! The maximum number of blocks to prefetch after a read.
+inline constexpr stl::size_t max_readahead_block_count {BlockCache::max_run_count};
+
+/**
+ * @brief Prefetch blocks after a read if the file is read sequentially.
+ *
+ * @details
+ * A read is sequential if it starts where the last read ended.
+ * The readahead window starts small and doubles on each sequential read.
+ * A random read resets the window.
+ *
+ * @param start_pos The access offset before the read.
+ * @param block_sector_count The number of sectors in a block.
+ * @param lbas A buffer for @p max_readahead_block_count block LBAs.
+ */
+void ReadAhead(const Disk& disk, const fs::File& file, const stl::size_t start_pos,
+               const stl::size_t block_sector_count, stl::size_t* const lbas) noexcept {
+    auto& readahead {file.readahead};
+    if (start_pos != readahead.pos) {
+        readahead = {};
+        readahead.pos = file.pos;
+        return;
+    }
+
+    readahead.pos = file.pos;
+    readahead.window = readahead.window == 0
+                           ? min_readahead_block_count
+                           : stl::min(readahead.window * 2, max_readahead_block_count);
+
+    // The block containing the current offset has been read.
+    const auto& inode {file.GetNode()};
+    const auto block_size {block_sector_count * Disk::sector_size};
+    const auto next_block_idx {RoundUpDivide(file.pos, block_size)};
+    const auto block_count {
+        stl::min(RoundUpDivide(inode.size, block_size), max_sector_count_per_inode)};
+    const auto begin {stl::max(next_block_idx, readahead.end_block)};
+    const auto end {stl::min(next_block_idx + readahead.window, block_count)};
+    if (begin >= end) {
+        return;
+    }
+
+    // Collect block LBAs of the window.
+    dbg::Assert(end - begin <= max_readahead_block_count);
+    LoadNodeLbas(disk, inode, lbas, begin, end);
+
+    // Prefetch each run of blocks that are contiguous on the disk with a single command.
+    const auto count {end - begin};
+    for (stl::size_t i {0}; i < count;) {
+        if (lbas[i] == 0) {
+            ++i;
+            continue;
+        }
+
+        const auto run_len {GetRunLen(lbas, i, count, block_sector_count)};
+        GetBlockCache().Prefetch(disk, lbas[i], run_len * block_sector_count);
+        i += run_len;
+    }
+
+    readahead.end_block = end;
+}
+
+//! A cursor copying data between sectors and buffers of a vectored file operation in order.
+class IoVecCursor {
+public:
+    IoVecCursor(const IoVec* const vecs, const stl::size_t count) noexcept :
+        vecs_ {vecs}, count_ {count} {
+        dbg::Assert(vecs_ || count_ == 0);
+    }
+
+    //! Copy data from buffers to a sector buffer.
+    IoVecCursor& Gather(stl::byte* const dest, const stl::size_t size) noexcept {
+        return Copy(dest, size, true);
+    }
+
+    //! Copy data from a sector buffer to buffers.
+    IoVecCursor& Scatter(const stl::byte* const src, const stl::size_t size) noexcept {
+        return Copy(const_cast<stl::byte*>(src), size, false);
+    }
+
+    /**
+     * @brief Whether disks can transfer data into the current buffer directly.
+     *
+     * @details
+     * The buffer must be in kernel memory, since requests are transferred by the worker thread of the channel.
+     * It must be aligned to a word for DMA transfers.
+     */
+    bool IsCurrDirect() const noexcept {
+        const auto addr {reinterpret_cast<stl::uintptr_t>(GetCurr())};
+        return addr >= krnl_base && addr % sizeof(stl::uint16_t) == 0;
+    }
+
+    //! Get the address of the next byte in the current buffer.
+    stl::byte* GetCurr() const noexcept {
+        dbg::Assert(idx_ < count_);
+        return static_cast<stl::byte*>(vecs_[idx_].base) + offset_;
+    }
+
+    //! Get the number of bytes left in the current buffer.
+    stl::size_t GetCurrSize() const noexcept {
+        dbg::Assert(idx_ < count_);
+        return vecs_[idx_].size - offset_;
+    }
+
+    //! Skip bytes in the current buffer, which have been transferred directly.
+    IoVecCursor& Skip(const stl::size_t size) noexcept {
+        dbg::Assert(size <= GetCurrSize());
+        offset_ += size;
+        if (offset_ == vecs_[idx_].size) {
+            ++idx_;
+            offset_ = 0;
+        }
+
+        return *this;
+    }
+
+private:
+    IoVecCursor& Copy(stl::byte* const sector, const stl::size_t size,
+                      const bool gather) noexcept {
+        stl::size_t copied {0};
+        while (copied < size) {
+            dbg::Assert(idx_ < count_);
+            const auto& vec {vecs_[idx_]};
+            const auto chunk_size {stl::min(size - copied, vec.size - offset_)};
+            const auto buf {static_cast<stl::byte*>(vec.base) + offset_};
+            if (gather) {
+                stl::memcpy(sector + copied, buf, chunk_size);
+            } else {
+                stl::memcpy(buf, sector + copied, chunk_size);
+            }
+
+            copied += chunk_size;
+            offset_ += chunk_size;
+            if (offset_ == vec.size) {
+                ++idx_;
+                offset_ = 0;
+            }
+        }
+
+        return *this;
+    }
+
+    const IoVec* vecs_;
+    stl::size_t count_;
+    //! The index of the current buffer.
+    stl::size_t idx_ {0};
+    //! The offset in the current buffer.
+    stl::size_t offset_ {0};
+};
+
 }  // namespace
 
 stl::string_view Disk::Part::GetName() const noexcept {
@@ -241,6 +674,11 @@ bool Disk::Part::IsValid() const noexcept {
     return disk_ != nullptr && sector_count_ > 0;
 }
 
+DiskStats Disk::Part::GetStats() const noexcept {
+    const intr::IntrGuard guard;
+    return stats_;
+}
+
 TagList::Tag& Disk::Part::GetTag() noexcept {
     return tag_;
 }
@@ -262,8 +700,8 @@ const Disk::FilePart& Disk::FilePart::LoadBlockBitmap() const noexcept {
     const auto byte_len {super_block.block_bitmap_sector_count * sector_size};
     const auto bits {mem::Allocate(byte_len)};
     mem::AssertAlloc(bits);
-    GetDisk().ReadSectors(super_block.block_bitmap_start_lba, bits,
-                          super_block.block_bitmap_sector_count);
+    GetBlockCache().Read(GetDisk(), super_block.block_bitmap_start_lba, bits,
+                         super_block.block_bitmap_sector_count);
     block_bitmap_.Init(bits, byte_len, false);
     return *this;
 }
@@ -273,8 +711,8 @@ const Disk::FilePart& Disk::FilePart::LoadNodeBitmap() const noexcept {
     const auto byte_len {super_block.inode_bitmap_sector_count * sector_size};
     const auto bits {mem::Allocate(byte_len)};
     mem::AssertAlloc(bits);
-    GetDisk().ReadSectors(super_block.inode_bitmap_start_lba, bits,
-                          super_block.inode_bitmap_sector_count);
+    GetBlockCache().Read(GetDisk(), super_block.inode_bitmap_start_lba, bits,
+                         super_block.inode_bitmap_sector_count);
     inode_bitmap_.Init(bits, byte_len, false);
     return *this;
 }
@@ -282,7 +720,7 @@ const Disk::FilePart& Disk::FilePart::LoadNodeBitmap() const noexcept {
 void Disk::FilePart::OpenRootDir() const noexcept {
     auto& dir {fs::GetRootDir()};
     const auto inode {dir.inode};
-    dir.pos = 0;
+    dir.cursor = {};
     dir.inode = &OpenNode(GetSuperBlock().root_inode_idx);
     // The previously opened root directory may belong to another partition.
     // So we open the new directory first, then close the old one.
@@ -328,6 +766,7 @@ bool Disk::FilePart::SearchPath(const Path& path, PathSearchRecord& record) cons
                     // Record the index node ID of the previous parent directory.
                     search->parent_inode_idx = search->record->parent->GetNodeIdx();
                     search->record->type = fs::FileType::Directory;
+                    search->record->inode_idx = search->entry.inode_idx;
                     // Close the previous parent directory and open the current directory as the new parent directory for the next search.
                     search->record->parent->Close();
                     search->record->parent = &search->part->OpenDir(search->record->inode_idx);
@@ -367,42 +806,62 @@ bool Disk::FilePart::SearchPath(const Path& path, PathSearchRecord& record) cons
     }
 }
 
-fs::DirEntry* Disk::FilePart::ReadDir(const fs::Directory& dir) const noexcept {
-    dbg::Assert(dir.IsOpen());
-    if (dir.pos >= dir.GetNode().size) {
-        // All entries have been read.
-        return nullptr;
-    }
+bool Disk::FilePart::ReadDir(const fs::Directory& dir, fs::DirEntry& entry) const noexcept {
+    return ReadDir(dir, dir.cursor, &entry, 1) == 1;
+}
 
+stl::size_t Disk::FilePart::ReadDir(const fs::Directory& dir, fs::Directory::Cursor& cursor,
+                                    fs::DirEntry* const entries,
+                                    const stl::size_t count) const noexcept {
+    dbg::Assert(dir.IsOpen());
+    dbg::Assert(entries || count == 0);
+    const stl::shared_lock guard {meta_lock_};
     const auto& disk {GetDisk()};
-    stl::size_t pos {0};
-    for (const auto lba : LoadNodeLbas(disk, dir.GetNode())) {
-        if (lba == 0) {
+    const auto block_sector_count {GetSuperBlock().GetBlockSectorCount()};
+    const auto entry_count_per_block {dir_entry_count_per_sector * block_sector_count};
+    const auto lbas {LoadNodeLbas(disk, dir.GetNode())};
+    stl::size_t read_count {0};
+    while (read_count != count && cursor.block_idx < lbas.size()) {
+        const auto lba {lbas[cursor.block_idx]};
+        if (lba == 0 || cursor.slot_idx >= entry_count_per_block) {
+            // Move to the next block.
+            ++cursor.block_idx;
+            cursor.slot_idx = 0;
             continue;
         }
 
-        for (const auto& entry : LoadDirEntries(disk, lba)) {
-            if (entry.type != fs::FileType::Unknown) {
-                if (pos < dir.pos) {
-                    // Keep moving until reaching the current access offset.
-                    pos += sizeof(fs::DirEntry);
-                } else {
-                    // Read the next entry and update the access offset.
-                    dbg::Assert(pos == dir.pos);
-                    dir.pos += sizeof(fs::DirEntry);
-                    return const_cast<fs::DirEntry*>(&entry);
-                }
+        // Only read the sector containing the cursor, and resume from the slot.
+        const auto sector_entries {
+            LoadDirEntries(disk, lba + cursor.slot_idx / dir_entry_count_per_sector)};
+        for (auto i {cursor.slot_idx % dir_entry_count_per_sector};
+             i != sector_entries.size() && read_count != count; ++i) {
+            ++cursor.slot_idx;
+            if (sector_entries[i].type != fs::FileType::Unknown) {
+                entries[read_count++] = sector_entries[i];
             }
         }
     }
 
-    return nullptr;
+    return read_count;
+}
+
+stl::size_t Disk::FilePart::ReadDir(const Path& path, fs::Directory::Cursor& cursor,
+                                    fs::DirEntry* const entries,
+                                    const stl::size_t count) const noexcept {
+    const auto dir {OpenDir(path)};
+    if (!dir) {
+        return 0;
+    }
+
+    const auto read_count {ReadDir(*dir, cursor, entries, count)};
+    dir->Close();
+    return read_count;
 }
 
 fs::Directory& Disk::FilePart::OpenDir(const stl::size_t inode_idx) const noexcept {
     const auto dir {mem::Allocate<fs::Directory>(sizeof(fs::Directory))};
     mem::AssertAlloc(dir);
-    dir->pos = 0;
+    dir->cursor = {};
     dir->inode = &OpenNode(inode_idx);
     return *dir;
 }
@@ -412,27 +871,74 @@ bool Disk::FilePart::SearchDirEntry(const fs::Directory& dir, const stl::string_
     dbg::Assert(dir.IsOpen());
     dbg::Assert(!name.empty() && name.size() <= Path::max_len);
 
+    // Look up the directory entry cache first.
+    auto& dentries {fs::GetDentryCache()};
+    if (dentries.Find(this, dir.GetNodeIdx(), name, found_entry)) {
+        return found_entry.type != fs::FileType::Unknown;
+    }
+
+    const auto found {SearchDirEntryOnDisk(dir, name, found_entry)};
+    dentries.Insert(this, dir.GetNodeIdx(), name, found ? &found_entry : nullptr);
+    return found;
+}
+
+bool Disk::FilePart::SearchDirEntryOnDisk(const fs::Directory& dir, const stl::string_view name,
+                                          fs::DirEntry& found_entry) const noexcept {
     const auto& disk {GetDisk()};
-    auto found {false};
-    for (const auto lba : LoadNodeLbas(disk, dir.GetNode())) {
+    const auto& inode {dir.GetNode()};
+    const auto block_sector_count {GetSuperBlock().GetBlockSectorCount()};
+    auto index {inode.GetDirIndex()};
+    if (!index) {
+        // Build the index on the first search.
+        const stl::lock_guard guard {dir_index_lock_};
+        index = inode.GetDirIndex();
+        if (!index) {
+            index = BuildDirIndex(disk, inode, block_sector_count);
+            inode.SetDirIndex(index);
+        }
+    }
+
+    if (index) {
+        // Only read sectors containing entries whose name hashes match.
+        struct Query {
+            const Disk* disk;
+            stl::string_view name;
+            fs::DirEntry* found;
+        } query {&disk, name, &found_entry};
+
+        return index->Find(
+            name,
+            [](const fs::DirIndex::Pos& pos, void* const arg) noexcept {
+                const auto& query {*static_cast<const Query*>(arg)};
+                const auto entries {LoadDirEntries(*query.disk, pos.lba)};
+                const auto& entry {entries[pos.idx]};
+                if (entry.HasName(query.name)) {
+                    *query.found = entry;
+                    return true;
+                } else {
+                    return false;
+                }
+            },
+            &query);
+    }
+
+    // Scan the whole directory if there is no free memory for the index.
+    for (const auto lba : LoadNodeLbas(disk, inode)) {
         if (lba == 0) {
             continue;
         }
 
-        for (const auto& entry : LoadDirEntries(disk, lba)) {
-            if (entry.name.data() == name) {
-                found_entry = entry;
-                found = true;
-                break;
+        for (stl::size_t i {0}; i != block_sector_count; ++i) {
+            for (const auto& entry : LoadDirEntries(disk, lba + i)) {
+                if (entry.HasName(name)) {
+                    found_entry = entry;
+                    return true;
+                }
             }
         }
-
-        if (found) {
-            break;
-        }
     }
 
-    return found;
+    return false;
 }
 
 Disk::FilePart& Disk::FilePart::LoadSuperBlock() noexcept {
@@ -441,7 +947,8 @@ Disk::FilePart& Disk::FilePart::LoadSuperBlock() noexcept {
         RoundUpDivide<stl::size_t>(sizeof(fs::PaddedSuperBlock), sector_size)};
     const auto buf {mem::Allocate(sector_count * sector_size)};
     mem::AssertAlloc(buf);
-    GetDisk().ReadSectors(start_lba_ + fs::PaddedSuperBlock::start_lba, buf, sector_count);
+    GetBlockCache().Read(GetDisk(), start_lba_ + fs::PaddedSuperBlock::start_lba, buf,
+                         sector_count);
     super_block_ = mem::Allocate<fs::SuperBlock>(sizeof(fs::SuperBlock));
     mem::AssertAlloc(super_block_);
     stl::memcpy(super_block_, buf, sizeof(fs::SuperBlock));
@@ -449,9 +956,59 @@ Disk::FilePart& Disk::FilePart::LoadSuperBlock() noexcept {
 
     LoadBlockBitmap();
     LoadNodeBitmap();
+    if (super_block_->IsSummaryValid()) {
+        block_bitmap_.SetFreeHint(super_block_->free_block_hint);
+        inode_bitmap_.SetFreeHint(super_block_->free_inode_hint);
+    }
+
+    // The counts may have drifted if the bitmaps reached the disk without the super block.
+    // Bitmaps have just been loaded into memory, so counting their free bits is cheap.
+    RebuildSummary();
+
+    const auto bitmap_sector_count {super_block_->block_bitmap_sector_count
+                                    + super_block_->inode_bitmap_sector_count};
+    const auto dirty_byte_len {RoundUpDivide(bitmap_sector_count, bit::byte_len)};
+    const auto dirty_bits {mem::Allocate(dirty_byte_len)};
+    mem::AssertAlloc(dirty_bits);
+    dirty_bitmap_sectors_.Init(dirty_bits, dirty_byte_len);
+    return *this;
+}
+
+const Disk::FilePart& Disk::FilePart::RebuildSummary() const noexcept {
+    auto& super_block {*super_block_};
+    const auto data_end_lba {super_block.part_start_lba + super_block.part_sector_count};
+    dbg::Assert(data_end_lba >= super_block.data_start_lba);
+    const auto block_count {(data_end_lba - super_block.data_start_lba)
+                            / super_block.GetBlockSectorCount()};
+    // Extra bits at the end of the block bitmap are allocated, so they are not counted.
+    const auto free_block_count {block_bitmap_.GetFreeCount()};
+    const auto free_inode_count {inode_bitmap_.GetFreeCount()};
+    if (super_block.IsSummaryValid() && super_block.block_count == block_count
+        && super_block.free_block_count == free_block_count
+        && super_block.free_inode_count == free_inode_count) {
+        return *this;
+    }
+
+    super_block.block_count = block_count;
+    super_block.free_block_count = free_block_count;
+    super_block.free_inode_count = free_inode_count;
+    super_block.summary_sign = fs::SuperBlock::valid_summary_sign;
+    super_block_dirty_ = true;
     return *this;
 }
 
+FileSysStats Disk::FilePart::GetStats() const noexcept {
+    const stl::shared_lock guard {meta_lock_};
+    const auto& super_block {GetSuperBlock()};
+    FileSysStats stats;
+    stats.block_size = super_block.GetBlockSize();
+    stats.block_count = super_block.block_count;
+    stats.free_block_count = super_block.free_block_count;
+    stats.inode_count = super_block.part_inode_count;
+    stats.free_inode_count = super_block.free_inode_count;
+    return stats;
+}
+
 const fs::SuperBlock& Disk::FilePart::GetSuperBlock() const noexcept {
     dbg::Assert(super_block_);
     return *super_block_;
@@ -459,6 +1016,14 @@ const fs::SuperBlock& Disk::FilePart::GetSuperBlock() const noexcept {
 
 stl::size_t Disk::FilePart::AllocNode() const noexcept {
     if (const auto idx {inode_bitmap_.Alloc()}; idx != npos) {
+        if (super_block_->free_inode_count == 0) {
+            // The count has drifted from the bitmap.
+            RebuildSummary();
+        } else {
+            --super_block_->free_inode_count;
+            super_block_dirty_ = true;
+        }
+
         return idx;
     } else {
         io::PrintlnStr("The partition has no available index node.");
@@ -468,23 +1033,264 @@ stl::size_t Disk::FilePart::AllocNode() const noexcept {
 
 const Disk::FilePart& Disk::FilePart::FreeNode(const stl::size_t idx) const noexcept {
     inode_bitmap_.Free(idx);
+    if (super_block_->free_inode_count >= super_block_->part_inode_count) {
+        RebuildSummary();
+    } else {
+        ++super_block_->free_inode_count;
+        super_block_dirty_ = true;
+    }
+
     return *this;
 }
 
 const Disk::FilePart& Disk::FilePart::FreeBlock(const stl::size_t lba) const noexcept {
-    const auto start_lba {GetSuperBlock().data_start_lba};
-    dbg::Assert(lba >= start_lba);
-    block_bitmap_.Free(lba - start_lba);
+    const auto& super_block {GetSuperBlock()};
+    const auto start_lba {super_block.data_start_lba};
+    dbg::Assert(lba >= start_lba && (lba - start_lba) % super_block.GetBlockSectorCount() == 0);
+    block_bitmap_.Free((lba - start_lba) / super_block.GetBlockSectorCount());
+    // The data of a free block does not need to be written back.
+    GetBlockCache().Discard(GetDisk(), lba, super_block.GetBlockSectorCount());
+    if (super_block_->free_block_count >= super_block_->block_count) {
+        RebuildSummary();
+    } else {
+        ++super_block_->free_block_count;
+        super_block_dirty_ = true;
+    }
+
+    return *this;
+}
+
+stl::size_t Disk::FilePart::AllocBlock(const stl::size_t hint) const noexcept {
+    if (const auto lba {AllocBlocks(1, hint)}; lba != npos) {
+        return lba;
+    } else {
+        io::PrintlnStr("The partition has no available data block.");
+        return npos;
+    }
+}
+
+stl::size_t Disk::FilePart::AllocBlocks(const stl::size_t count,
+                                        const stl::size_t hint) const noexcept {
+    const auto& super_block {GetSuperBlock()};
+    const auto start_lba {super_block.data_start_lba};
+    const auto block_sector_count {super_block.GetBlockSectorCount()};
+    const auto hint_idx {hint != npos && hint >= start_lba
+                             ? (hint - start_lba) / block_sector_count
+                             : npos};
+    const auto idx {hint_idx != npos ? block_bitmap_.AllocNear(hint_idx, count)
+                                     : block_bitmap_.Alloc(count)};
+    if (idx == npos) {
+        return npos;
+    }
+
+    if (super_block_->free_block_count < count) {
+        // The count has drifted from the bitmap.
+        RebuildSummary();
+    } else {
+        super_block_->free_block_count -= count;
+        super_block_dirty_ = true;
+    }
+
+    return idx * block_sector_count + start_lba;
+}
+
+bool Disk::FilePart::PrepareNodeTab(fs::IdxNode& inode, const stl::size_t idx) noexcept {
+    dbg::Assert(idx < max_sector_count_per_inode);
+    if (idx < fs::IdxNode::direct_block_count) {
+        return true;
+    }
+
+    auto& disk {GetDisk()};
+    const auto empty_tab {mem::Allocate<stl::size_t>(Disk::sector_size)};
+    mem::AssertAlloc(empty_tab);
+    // Create an empty block table and return its LBA.
+    const auto create_tab {[this, &disk, empty_tab]() noexcept {
+        const auto lba {AllocBlock()};
+        if (lba != npos) {
+            SyncBlockBitmap(lba);
+            GetBlockCache().Write(disk, lba, empty_tab);
+        }
+
+        return lba;
+    }};
+
+    auto success {true};
+    if (idx < sector_count_per_inode) {
+        // Create the single indirect block table.
+        if (inode.GetIndirectTabLba() == 0) {
+            if (const auto lba {create_tab()}; lba != npos) {
+                inode.SetIndirectTabLba(lba);
+                inode.CacheIndirectLbas(empty_tab);
+            } else {
+                success = false;
+            }
+        }
+    } else {
+        // Create the double indirect block table.
+        if (inode.GetDoubleIndirectTabLba() == 0) {
+            if (const auto lba {create_tab()}; lba != npos) {
+                inode.SetDoubleIndirectTabLba(lba);
+            } else {
+                success = false;
+            }
+        }
+
+        // Create the second-level table containing the block.
+        if (success) {
+            const auto outer_tab {mem::AllocateUninit<stl::size_t>(Disk::sector_size)};
+            mem::AssertAlloc(outer_tab);
+            const auto outer_tab_lba {inode.GetDoubleIndirectTabLba()};
+            GetBlockCache().Read(disk, outer_tab_lba, outer_tab);
+            const auto tab_idx {(idx - sector_count_per_inode) / indirect_sector_count_per_inode};
+            if (outer_tab[tab_idx] == 0) {
+                if (const auto lba {create_tab()}; lba != npos) {
+                    outer_tab[tab_idx] = lba;
+                    GetBlockCache().Write(disk, outer_tab_lba, outer_tab);
+                } else {
+                    success = false;
+                }
+            }
+
+            mem::Free(outer_tab);
+        }
+    }
+
+    mem::Free(empty_tab);
+    return success;
+}
+
+Disk::FilePart& Disk::FilePart::SetNodeLbas(fs::IdxNode& inode, const stl::size_t begin,
+                                            const stl::size_t* const lbas,
+                                            const stl::size_t count) noexcept {
+    dbg::Assert(lbas && begin + count <= GetTabEnd(begin));
+    if (count == 0) {
+        return *this;
+    }
+
+    for (stl::size_t i {0}; i != count; ++i) {
+        dbg::Assert(lbas[i] != 0);
+        SyncBlockBitmap(lbas[i]);
+    }
+
+    if (begin < fs::IdxNode::direct_block_count) {
+        for (stl::size_t i {0}; i != count; ++i) {
+            dbg::Assert(inode.GetDirectLba(begin + i) == 0);
+            inode.SetDirectLba(begin + i, lbas[i]);
+        }
+
+        return *this;
+    }
+
+    auto& disk {GetDisk()};
+    const auto tab {mem::AllocateUninit<stl::size_t>(Disk::sector_size)};
+    mem::AssertAlloc(tab);
+    if (begin < sector_count_per_inode) {
+        // Save block LBAs to the single indirect block table.
+        stl::memcpy(tab, LoadIndirectLbas(disk, inode), Disk::sector_size);
+        stl::memcpy(tab + (begin - fs::IdxNode::direct_block_count), lbas,
+                    count * sizeof(stl::size_t));
+        SaveIndirectLbas(disk, inode, tab);
+    } else {
+        // Save block LBAs to a second-level table of the double indirect block table.
+        const auto offset {begin - sector_count_per_inode};
+        GetBlockCache().Read(disk, inode.GetDoubleIndirectTabLba(), tab);
+        const auto inner_tab_lba {tab[offset / indirect_sector_count_per_inode]};
+        dbg::Assert(inner_tab_lba != 0);
+        GetBlockCache().Read(disk, inner_tab_lba, tab);
+        stl::memcpy(tab + offset % indirect_sector_count_per_inode, lbas,
+                    count * sizeof(stl::size_t));
+        GetBlockCache().Write(disk, inner_tab_lba, tab);
+    }
+
+    mem::Free(tab);
     return *this;
 }
 
-stl::size_t Disk::FilePart::AllocBlock() const noexcept {
-    if (const auto lba {block_bitmap_.Alloc()}; lba != npos) {
-        return lba + GetSuperBlock().data_start_lba;
+bool Disk::FilePart::AllocNodeBlocks(fs::IdxNode& inode, const stl::size_t begin,
+                                     const stl::size_t end) noexcept {
+    dbg::Assert(begin <= end && end <= max_sector_count_per_inode);
+    auto& disk {GetDisk()};
+    const auto block_sector_count {GetSuperBlock().GetBlockSectorCount()};
+    // Block LBAs sharing a block table.
+    stl::array<stl::size_t, indirect_sector_count_per_inode> lbas;
+
+    // Blocks reserved before are kept.
+    auto first_new {begin};
+    while (first_new != end) {
+        const auto tab_end {stl::min(GetTabEnd(first_new), end)};
+        LoadNodeLbas(disk, inode, lbas.data(), first_new, tab_end);
+        const auto count {tab_end - first_new};
+        stl::size_t reserved_count {0};
+        while (reserved_count != count && lbas[reserved_count] != 0) {
+            ++reserved_count;
+        }
+
+        first_new += reserved_count;
+        if (reserved_count != count) {
+            break;
+        }
+    }
+
+    if (first_new == end) {
+        return true;
+    }
+
+    // New blocks are allocated after the previous block, so the file stays contiguous on the disk.
+    auto hint {npos};
+    if (first_new > 0) {
+        stl::size_t prev_lba {0};
+        LoadNodeLbas(disk, inode, &prev_lba, first_new - 1, first_new);
+        if (prev_lba != 0) {
+            hint = prev_lba + block_sector_count;
+        }
+    }
+
+    // Create block tables before allocating blocks, so tables do not break the run of blocks.
+    for (auto i {first_new}; i < end; i = GetTabEnd(i)) {
+        if (!PrepareNodeTab(inode, i)) {
+            MarkNodeDirty(inode);
+            return false;
+        }
+    }
+
+    if (const auto run_lba {AllocBlocks(end - first_new, hint)}; run_lba != npos) {
+        for (auto i {first_new}; i != end;) {
+            const auto tab_end {stl::min(GetTabEnd(i), end)};
+            for (auto j {i}; j != tab_end; ++j) {
+                lbas[j - i] = run_lba + (j - first_new) * block_sector_count;
+            }
+
+            SetNodeLbas(inode, i, lbas.data(), tab_end - i);
+            i = tab_end;
+        }
     } else {
-        io::PrintlnStr("The partition has no available data block.");
-        return npos;
+        // There is no free run long enough. Allocate blocks one by one.
+        for (auto i {first_new}; i != end;) {
+            const auto tab_end {stl::min(GetTabEnd(i), end)};
+            stl::size_t count {0};
+            while (i + count != tab_end) {
+                const auto lba {AllocBlock(hint)};
+                if (lba == npos) {
+                    break;
+                }
+
+                lbas[count++] = lba;
+                hint = lba + block_sector_count;
+            }
+
+            // Blocks allocated before a failure are kept as reserved blocks.
+            SetNodeLbas(inode, i, lbas.data(), count);
+            if (i + count != tab_end) {
+                MarkNodeDirty(inode);
+                return false;
+            }
+
+            i = tab_end;
+        }
     }
+
+    MarkNodeDirty(inode);
+    return true;
 }
 
 Disk::FilePart& Disk::FilePart::SyncNodeBitmap(const stl::size_t idx) noexcept {
@@ -492,17 +1298,40 @@ Disk::FilePart& Disk::FilePart::SyncNodeBitmap(const stl::size_t idx) noexcept {
 }
 
 Disk::FilePart& Disk::FilePart::SyncBlockBitmap(const stl::size_t lba) noexcept {
-    const auto start_lba {GetSuperBlock().data_start_lba};
+    const auto& super_block {GetSuperBlock()};
+    const auto start_lba {super_block.data_start_lba};
     dbg::Assert(lba >= start_lba);
-    return SyncBitmap(BitmapType::Block, lba - start_lba);
+    return SyncBitmap(BitmapType::Block, (lba - start_lba) / super_block.GetBlockSectorCount());
 }
 
 Disk::FilePart& Disk::FilePart::SyncBitmap(const BitmapType type,
                                            const stl::size_t bit_idx) noexcept {
-    const auto sector_offset {bit_idx / bit_count_per_sector};
-    const auto byte_offset {sector_offset * sector_size};
+    auto sector_idx {bit_idx / bit_count_per_sector};
+    switch (type) {
+        case BitmapType::Node: {
+            dbg::Assert(sector_idx < GetSuperBlock().inode_bitmap_sector_count);
+            sector_idx += GetSuperBlock().block_bitmap_sector_count;
+            break;
+        }
+        case BitmapType::Block: {
+            dbg::Assert(sector_idx < GetSuperBlock().block_bitmap_sector_count);
+            break;
+        }
+        default: {
+            dbg::Assert(false);
+            break;
+        }
+    }
+
+    dirty_bitmap_sectors_.ForceAlloc(sector_idx);
+    return *this;
+}
 
-    stl::size_t lba {sector_offset};
+Disk::FilePart& Disk::FilePart::WriteBitmapSector(const BitmapType type,
+                                                  const stl::size_t sector_idx) noexcept {
+    const auto byte_offset {sector_idx * sector_size};
+
+    stl::size_t lba {sector_idx};
     const void* bits {nullptr};
     switch (type) {
         case BitmapType::Node: {
@@ -521,50 +1350,53 @@ Disk::FilePart& Disk::FilePart::SyncBitmap(const BitmapType type,
         }
     }
 
-    GetDisk().WriteSectors(lba, bits);
+    GetBlockCache().Write(GetDisk(), lba, bits);
     return *this;
 }
 
 fs::IdxNode& Disk::FilePart::OpenNode(const stl::size_t idx) const noexcept {
     dbg::Assert(idx < max_file_count_per_part);
-    // Try to find the index node in the list of open nodes.
-    if (const auto found_tag {open_inodes_.Find(
-            [](const TagList::Tag& inode_tag, void* const idx) noexcept {
-                const auto& inode {fs::IdxNode::GetByTag(inode_tag)};
-                return inode.idx == reinterpret_cast<stl::size_t>(idx);
-            },
-            reinterpret_cast<void*>(idx))};
-        found_tag) {
-        // The index node is already open.
-        auto& found_inode {fs::IdxNode::GetByTag(*found_tag)};
-        found_inode.open_times += 1;
-        return found_inode;
-    } else {
-        // Allocate a new index node.
-        const auto new_inode {
-            mem::Allocate<fs::IdxNode>(mem::PoolType::Kernel, sizeof(fs::IdxNode))};
-        mem::AssertAlloc(new_inode);
-        new_inode->Init();
+    // Path lookups holding the shared metadata lock may open the same index node at the same time.
+    const stl::lock_guard guard {inode_lock_};
+    {
+        // Try to find the index node in the table of open nodes.
+        // Interrupts are disabled so that the node cannot be closed before its open times are increased.
+        const intr::IntrGuard intr_guard;
+        if (const auto found_tag {open_inodes_.Find(
+                idx,
+                [](const TagList::Tag& inode_tag, void* const idx) noexcept {
+                    const auto& inode {fs::IdxNode::GetByTag(inode_tag)};
+                    return inode.idx == reinterpret_cast<stl::size_t>(idx);
+                },
+                reinterpret_cast<void*>(idx))};
+            found_tag) {
+            // The index node is already open.
+            auto& found_inode {fs::IdxNode::GetByTag(*found_tag)};
+            found_inode.open_times += 1;
+            return found_inode;
+        }
+    }
 
-        // Read the index node data from the disk.
-        const IdxNodePos pos {*this, idx};
-        const auto sector_count {pos.is_across_sectors ? 2 : 1};
-        const auto buf {mem::Allocate<stl::byte>(sector_count * sector_size)};
-        mem::AssertAlloc(buf);
-        GetDisk().ReadSectors(pos.lba, buf, sector_count);
-        stl::memcpy(new_inode, buf + pos.offset_in_sector, sizeof(fs::IdxNode));
-        mem::Free(buf);
+    // Allocate a new index node.
+    const auto new_inode {fs::IdxNode::Create()};
+    mem::AssertAlloc(new_inode);
 
-        // Add the index node to the list of open nodes.
-        new_inode->open_times = 1;
-        open_inodes_.PushBack(new_inode->tag);
-        return *new_inode;
-    }
+    // Read the index node data from the cached sectors.
+    const IdxNodePos pos {*this, idx};
+    new_inode->SetDoubleIndirectTabLba(0);
+    GetBlockCache().ReadBytes(GetDisk(), pos.lba, pos.offset_in_sector, new_inode, pos.size);
+
+    // The dirty status in the padding may be left by an old image.
+    new_inode->dirty = false;
+    // Add the index node to the table of open nodes.
+    new_inode->open_times = 1;
+    open_inodes_.Insert(idx, new_inode->tag);
+    return *new_inode;
 }
 
 Disk::FilePart& Disk::FilePart::DeleteNode(const stl::size_t idx) noexcept {
     auto& inode {OpenNode(idx)};
-    // Free all direct and indirect blocks.
+    // Free all direct and single indirect blocks.
     for (const auto lba : LoadNodeLbas(GetDisk(), inode)) {
         if (lba != 0) {
             FreeBlock(lba);
@@ -578,37 +1410,89 @@ Disk::FilePart& Disk::FilePart::DeleteNode(const stl::size_t idx) noexcept {
         SyncBlockBitmap(indirect_tab_lba);
     }
 
+    // Double indirect blocks are freed later by the metadata flusher,
+    // since reading their second-level tables costs up to one disk read per table.
+    if (const auto outer_tab_lba {inode.GetDoubleIndirectTabLba()}; outer_tab_lba != 0) {
+        auto deferred {false};
+        {
+            const intr::IntrGuard guard;
+            if (!pending_double_indirect_tabs_.IsFull()) {
+                pending_double_indirect_tabs_.Push(outer_tab_lba);
+                deferred = true;
+            }
+        }
+
+        if (!deferred) {
+            FreeDoubleIndirectBlocks(outer_tab_lba);
+        }
+    }
+
+    // The index node must not be written back after it is freed.
+    DropNodeDirty(inode);
+
     // Free the index node.
+    // It is not zero-filled, since the bitmap decides whether it is used,
+    // and a new index node is initialized in memory before it is saved.
     FreeNode(idx);
     SyncNodeBitmap(idx);
 
-    constexpr auto io_buf_size {2 * sector_size};
-    if (const auto io_buf {mem::Allocate(io_buf_size)}; io_buf) {
-        ZeroFillNode(idx, io_buf, io_buf_size);
-        mem::Free(io_buf);
+    inode.Close();
+    return *this;
+}
+
+Disk::FilePart& Disk::FilePart::FreeDoubleIndirectBlocks(const stl::size_t outer_tab_lba) noexcept {
+    dbg::Assert(outer_tab_lba != 0);
+    const auto tabs {mem::AllocateUninit<stl::size_t>(2 * sector_size)};
+    mem::AssertAlloc(tabs);
+    const auto outer_tab {tabs};
+    const auto inner_tab {tabs + indirect_sector_count_per_inode};
+    GetBlockCache().Read(GetDisk(), outer_tab_lba, outer_tab);
+    for (stl::size_t i {0}; i != indirect_sector_count_per_inode; ++i) {
+        const auto inner_tab_lba {outer_tab[i]};
+        if (inner_tab_lba == 0) {
+            continue;
+        }
+
+        GetBlockCache().Read(GetDisk(), inner_tab_lba, inner_tab);
+        for (stl::size_t j {0}; j != indirect_sector_count_per_inode; ++j) {
+            if (const auto lba {inner_tab[j]}; lba != 0) {
+                FreeBlock(lba);
+                SyncBlockBitmap(lba);
+            }
+        }
+
+        FreeBlock(inner_tab_lba);
+        SyncBlockBitmap(inner_tab_lba);
     }
 
-    inode.Close();
+    FreeBlock(outer_tab_lba);
+    SyncBlockBitmap(outer_tab_lba);
+    mem::Free(tabs);
     return *this;
 }
 
-Disk::FilePart& Disk::FilePart::ZeroFillNode(const stl::size_t idx, void* const io_buf,
-                                             const stl::size_t io_buf_size) noexcept {
-    dbg::Assert(io_buf && io_buf_size >= 2 * sector_size);
-    dbg::Assert(idx < max_file_count_per_part);
-    auto& disk {GetDisk()};
-    const IdxNodePos pos {*this, idx};
-    const auto sector_count {pos.is_across_sectors ? 2 : 1};
-    disk.ReadSectors(pos.lba, io_buf, sector_count);
-    stl::memset(static_cast<stl::byte*>(io_buf) + pos.offset_in_sector, 0, sizeof(fs::IdxNode));
-    disk.WriteSectors(pos.lba, io_buf, sector_count);
+Disk::FilePart& Disk::FilePart::ReclaimBlocks() noexcept {
+    while (true) {
+        stl::size_t outer_tab_lba {0};
+        {
+            const intr::IntrGuard guard;
+            if (pending_double_indirect_tabs_.IsEmpty()) {
+                break;
+            }
+
+            outer_tab_lba = pending_double_indirect_tabs_.Pop();
+        }
+
+        FreeDoubleIndirectBlocks(outer_tab_lba);
+    }
+
     return *this;
 }
 
 FileDesc Disk::FilePart::OpenFile(const stl::size_t inode_idx,
                                   const bit::Flags<File::OpenMode> flags) const noexcept {
     auto& tab {fs::GetFileTab()};
-    const auto desc {tab.GetFreeDesc()};
+    const auto desc {tab.AllocDesc()};
     if (!desc.IsValid()) {
         return {};
     }
@@ -616,10 +1500,12 @@ FileDesc Disk::FilePart::OpenFile(const stl::size_t inode_idx,
     auto& inode {OpenNode(inode_idx)};
     if (flags.IsSet(File::OpenMode::WriteOnly) || flags.IsSet(File::OpenMode::ReadWrite)) {
         const intr::IntrGuard guard;
-        if (!inode.write_deny) {
+        // A file run by a program image cannot be rewritten, since its pages are loaded on demand.
+        if (!inode.write_deny && !inode.IsExecuting()) {
             inode.write_deny = true;
         } else {
             inode.Close();
+            tab.FreeDesc(desc);
             io::PrintlnStr("The file cannot be written now.");
             return {};
         }
@@ -629,19 +1515,60 @@ FileDesc Disk::FilePart::OpenFile(const stl::size_t inode_idx,
     tab[desc].Clear();
     tab[desc].inode = &inode;
     tab[desc].flags = flags;
-    return tsk::ProcFileDescTab::SyncGlobal(desc);
+    const auto local {tsk::ProcFileDescTab::SyncGlobal(desc)};
+    if (!local.IsValid()) {
+        tab.FreeDesc(desc);
+    }
+
+    return local;
 }
 
 stl::size_t Disk::FilePart::WriteFile(const FileDesc desc, const void* const data,
                                       const stl::size_t size) noexcept {
+    const stl::lock_guard guard {meta_lock_};
+    auto& tab {fs::GetFileTab()};
+    const auto idx {tsk::ProcFileDescTab::GetGlobal(desc)};
+    dbg::Assert(idx < tab.GetSize());
+    const IoVec vec {const_cast<void*>(data), size};
+    return WriteFile(tab[idx], &vec, 1);
+}
+
+bool Disk::FilePart::ReserveFile(const FileDesc desc, const stl::size_t size) noexcept {
+    const stl::lock_guard guard {meta_lock_};
+    auto& tab {fs::GetFileTab()};
+    const auto idx {tsk::ProcFileDescTab::GetGlobal(desc)};
+    dbg::Assert(idx < tab.GetSize());
+    auto& file {tab[idx]};
+    dbg::Assert(file.IsOpen());
+    const auto& super_block {GetSuperBlock()};
+    const auto block_size {super_block.GetBlockSize()};
+    if (size > GetMaxBlockCountPerFile(super_block) * block_size) {
+        io::PrintlnStr("Failed to reserve. The file exceeds the maximum size.");
+        return false;
+    }
+
+    auto& inode {file.GetNode()};
+    const auto curr_block_count {RoundUpDivide(inode.size, block_size)};
+    const auto new_block_count {RoundUpDivide(size, block_size)};
+    if (new_block_count <= curr_block_count) {
+        return true;
+    }
+
+    return AllocNodeBlocks(inode, curr_block_count, new_block_count);
+}
+
+stl::size_t Disk::FilePart::WriteFile(const FileDesc desc, const IoVec* const vecs,
+                                      const stl::size_t count) noexcept {
+    const stl::lock_guard guard {meta_lock_};
     auto& tab {fs::GetFileTab()};
     const auto idx {tsk::ProcFileDescTab::GetGlobal(desc)};
     dbg::Assert(idx < tab.GetSize());
-    return WriteFile(tab[idx], data, size);
+    return WriteFile(tab[idx], vecs, count);
 }
 
 stl::size_t Disk::FilePart::SeekFile(const FileDesc desc, const stl::int32_t offset,
                                      const File::SeekOrigin origin) const noexcept {
+    const stl::shared_lock guard {meta_lock_};
     auto& tab {fs::GetFileTab()};
     const auto idx {tsk::ProcFileDescTab::GetGlobal(desc)};
     dbg::Assert(idx < tab.GetSize());
@@ -650,10 +1577,75 @@ stl::size_t Disk::FilePart::SeekFile(const FileDesc desc, const stl::int32_t off
 
 stl::size_t Disk::FilePart::ReadFile(const FileDesc desc, void* const buf,
                                      const stl::size_t size) const noexcept {
+    const stl::shared_lock guard {meta_lock_};
+    auto& tab {fs::GetFileTab()};
+    const auto idx {tsk::ProcFileDescTab::GetGlobal(desc)};
+    dbg::Assert(idx < tab.GetSize());
+    const IoVec vec {buf, size};
+    return ReadFile(tab[idx], &vec, 1);
+}
+
+stl::size_t Disk::FilePart::ReadFile(const FileDesc desc, const IoVec* const vecs,
+                                     const stl::size_t count) const noexcept {
+    const stl::shared_lock guard {meta_lock_};
     auto& tab {fs::GetFileTab()};
     const auto idx {tsk::ProcFileDescTab::GetGlobal(desc)};
     dbg::Assert(idx < tab.GetSize());
-    return ReadFile(tab[idx], buf, size);
+    return ReadFile(tab[idx], vecs, count);
+}
+
+stl::size_t Disk::FilePart::ReadFileAt(const fs::File& file, const stl::size_t offset,
+                                       void* const buf, const stl::size_t size) const noexcept {
+    const stl::shared_lock guard {meta_lock_};
+    dbg::Assert(file.IsOpen() && !file.IsPipe());
+    if (offset >= file.GetNode().size) {
+        return 0;
+    }
+
+    file.pos = offset;
+    const IoVec vec {buf, size};
+    return ReadFile(file, &vec, 1);
+}
+
+stl::size_t Disk::FilePart::WriteFileAt(const fs::File& file, const stl::size_t offset,
+                                        const void* const data, const stl::size_t size) noexcept {
+    const stl::lock_guard guard {meta_lock_};
+    dbg::Assert(file.IsOpen() && !file.IsPipe());
+    const auto& inode {file.GetNode()};
+    if (offset >= inode.size) {
+        return 0;
+    }
+
+    const auto& super_block {GetSuperBlock()};
+    const auto block_sector_count {super_block.GetBlockSectorCount()};
+    const auto block_size {super_block.GetBlockSize()};
+    const auto io_buf {mem::AllocateUninit<stl::byte>(block_size)};
+    mem::AssertAlloc(io_buf);
+
+    // Blocks below the file size have been allocated, so they are overwritten one by one.
+    auto& disk {GetDisk()};
+    const auto total {stl::min(size, inode.size - offset)};
+    stl::size_t written {0};
+    while (written < total) {
+        const auto pos {offset + written};
+        const auto offset_in_block {pos % block_size};
+        const auto chunk_size {stl::min(total - written, block_size - offset_in_block)};
+        stl::size_t lba {0};
+        LoadNodeLbas(disk, inode, &lba, pos / block_size, pos / block_size + 1);
+        dbg::Assert(lba != 0);
+        if (chunk_size != block_size) {
+            // Keep the old data in the rest of a partial block.
+            GetBlockCache().Read(disk, lba, io_buf, block_sector_count);
+        }
+
+        stl::memcpy(io_buf + offset_in_block, static_cast<const stl::byte*>(data) + written,
+                    chunk_size);
+        GetBlockCache().Write(disk, lba, io_buf, block_sector_count);
+        written += chunk_size;
+    }
+
+    mem::Free(io_buf);
+    return written;
 }
 
 fs::Directory* Disk::FilePart::OpenDir(const Path& path) const noexcept {
@@ -662,6 +1654,7 @@ fs::Directory* Disk::FilePart::OpenDir(const Path& path) const noexcept {
         return &fs::GetRootDir();
     }
 
+    const stl::shared_lock guard {meta_lock_};
     PathSearchRecord search;
     const auto found {SearchPath(path, search)};
     dbg::Assert(search.parent);
@@ -705,6 +1698,7 @@ stl::size_t Disk::FilePart::SeekFile(fs::File& file, const stl::int32_t offset,
 
 bool Disk::FilePart::DeleteDir(fs::Directory& parent, const fs::Directory& child) noexcept {
     dbg::Assert(parent.IsOpen() && child.IsOpen());
+    const stl::lock_guard guard {meta_lock_};
     constexpr auto io_buf_size {2 * sector_size};
     const auto io_buf {mem::Allocate(io_buf_size)};
     mem::AssertAlloc(io_buf);
@@ -718,88 +1712,82 @@ bool Disk::FilePart::DeleteDir(fs::Directory& parent, const fs::Directory& child
     return success;
 }
 
-stl::size_t Disk::FilePart::ReadFile(const fs::File& file, void* const buf,
-                                     stl::size_t size) const noexcept {
+stl::size_t Disk::FilePart::ReadFile(const fs::File& file, const IoVec* const vecs,
+                                     const stl::size_t count) const noexcept {
     dbg::Assert(file.IsOpen());
     const auto& inode {file.GetNode()};
     dbg::Assert(inode.size >= file.pos);
-    size = stl::min(size, inode.size - file.pos);
+    const auto size {stl::min(GetIoVecSize(vecs, count), inode.size - file.pos)};
     if (size == 0) {
         return 0;
     }
 
-    const auto lbas {mem::Allocate<stl::size_t>(sector_count_per_inode * sizeof(stl::size_t))};
+    // LBAs of a run and of the readahead window are loaded before they are used.
+    static_assert(max_readahead_block_count <= BlockCache::max_run_count);
+    const auto lbas {
+        mem::AllocateUninit<stl::size_t>(BlockCache::max_run_count * sizeof(stl::size_t))};
     mem::AssertAlloc(lbas);
 
-    constexpr auto io_buf_size {sector_size};
-    const auto io_buf {mem::Allocate<stl::byte>(io_buf_size)};
+    // Blocks contiguous on the disk are read together.
+    constexpr auto io_buf_size {BlockCache::max_run_count * sector_size};
+    const auto io_buf {mem::AllocateUninit<stl::byte>(io_buf_size)};
     mem::AssertAlloc(io_buf);
 
-    const auto start_sector_idx {file.pos / sector_size};
-    const auto end_sector_idx {(file.pos + size) / sector_size};
-    dbg::Assert(start_sector_idx <= end_sector_idx && end_sector_idx < sector_count_per_inode);
-
-    // Collect block LBAs from which the data should be read.
+    // Read data from blocks and update the access offset.
     const auto& disk {GetDisk()};
-    if (start_sector_idx == end_sector_idx) {
-        // The required data is located in one block.
-        if (end_sector_idx < fs::IdxNode::direct_block_count) {
-            // The required data is located in a direct block.
-            lbas[start_sector_idx] = inode.GetDirectLba(start_sector_idx);
-            dbg::Assert(lbas[start_sector_idx] != 0);
-        } else {
-            // The required data is located in an indirect block.
-            const auto indirect_tab_lba {inode.GetIndirectTabLba()};
-            dbg::Assert(indirect_tab_lba != 0);
-            disk.ReadSectors(indirect_tab_lba, lbas + fs::IdxNode::direct_block_count,
-                             indirect_tab_sector_count_per_inode);
-        }
-    } else {
-        // The required data is located in multiple blocks.
-        if (end_sector_idx < fs::IdxNode::direct_block_count) {
-            // The required data is located in direct blocks.
-            for (stl::size_t i {start_sector_idx}; i <= end_sector_idx; ++i) {
-                lbas[i] = inode.GetDirectLba(i);
-                dbg::Assert(lbas[i] != 0);
-            }
-        } else if (start_sector_idx < fs::IdxNode::direct_block_count
-                   && end_sector_idx >= fs::IdxNode::direct_block_count) {
-            // The required data is located in both direct and indirect blocks.
-            for (stl::size_t i {start_sector_idx}; i != fs::IdxNode::direct_block_count; ++i) {
-                lbas[i] = inode.GetDirectLba(i);
-                dbg::Assert(lbas[i] != 0);
+    const auto block_sector_count {GetSuperBlock().GetBlockSectorCount()};
+    const auto block_size {block_sector_count * sector_size};
+    const auto start_pos {file.pos};
+    IoVecCursor cursor {vecs, count};
+    stl::size_t read_size {0};
+    while (read_size < size) {
+        const auto block_idx {file.pos / block_size};
+        const auto offset_in_block {file.pos % block_size};
+        const auto last_block_idx {(file.pos + size - read_size - 1) / block_size};
+        // Read a run of contiguous blocks with a single command.
+        const auto window {stl::min(last_block_idx + 1 - block_idx,
+                                    BlockCache::max_run_count / block_sector_count)};
+        LoadNodeLbas(disk, inode, lbas, block_idx, block_idx + window);
+        dbg::Assert(lbas[0] != 0);
+        const auto run_len {GetRunLen(lbas, 0, window, block_sector_count)};
+        const auto chunk_size {
+            stl::min(size - read_size, run_len * block_size - offset_in_block)};
+
+        // Whole sectors are transferred straight into the caller's buffer when possible.
+        // Only partial head and tail sectors and buffers in user memory use the bounce buffer.
+        auto lba {lbas[0] + offset_in_block / sector_size};
+        auto offset_in_sector {offset_in_block % sector_size};
+        stl::size_t done_size {0};
+        while (done_size < chunk_size) {
+            const auto rest_size {chunk_size - done_size};
+            const auto direct_count {offset_in_sector == 0 && cursor.IsCurrDirect()
+                                         ? stl::min(cursor.GetCurrSize(), rest_size) / sector_size
+                                         : 0};
+            if (direct_count != 0) {
+                GetBlockCache().Read(disk, lba, cursor.GetCurr(), direct_count);
+                cursor.Skip(direct_count * sector_size);
+                done_size += direct_count * sector_size;
+                lba += direct_count;
+                continue;
             }
 
-            const auto indirect_tab_lba {inode.GetIndirectTabLba()};
-            dbg::Assert(indirect_tab_lba != 0);
-            disk.ReadSectors(indirect_tab_lba, lbas + fs::IdxNode::direct_block_count,
-                             indirect_tab_sector_count_per_inode);
-        } else {
-            // The required data is located in indirect blocks.
-            const auto indirect_tab_lba {inode.GetIndirectTabLba()};
-            dbg::Assert(indirect_tab_lba != 0);
-            disk.ReadSectors(indirect_tab_lba, lbas + fs::IdxNode::direct_block_count,
-                             indirect_tab_sector_count_per_inode);
+            // A buffer in user memory reads the rest of the run at once.
+            const auto bounce_count {cursor.IsCurrDirect()
+                                         ? 1
+                                         : RoundUpDivide(offset_in_sector + rest_size, sector_size)};
+            const auto copy_size {stl::min(rest_size, bounce_count * sector_size - offset_in_sector)};
+            GetBlockCache().Read(disk, lba, io_buf, bounce_count);
+            cursor.Scatter(io_buf + offset_in_sector, copy_size);
+            done_size += copy_size;
+            lba += (offset_in_sector + copy_size) / sector_size;
+            offset_in_sector = (offset_in_sector + copy_size) % sector_size;
         }
-    }
-
-    // Read data from sectors and update the access offset.
-    stl::size_t read_size {0};
-    while (read_size < size) {
-        stl::memset(io_buf, 0, io_buf_size);
-        const auto sector_idx {file.pos / sector_size};
-        const auto offset_in_sector {file.pos % sector_size};
-        const auto left_in_sector {sector_size - offset_in_sector};
-        const auto chunk_size {stl::min(size - read_size, left_in_sector)};
-
-        disk.ReadSectors(lbas[sector_idx], io_buf);
-        stl::memcpy(static_cast<stl::byte*>(buf) + read_size, io_buf + offset_in_sector,
-                    chunk_size);
 
         read_size += chunk_size;
         file.pos += chunk_size;
     }
 
+    ReadAhead(disk, file, start_pos, block_sector_count, lbas);
     mem::Free(io_buf);
     mem::Free(lbas);
     return read_size;
@@ -807,6 +1795,7 @@ stl::size_t Disk::FilePart::ReadFile(const fs::File& file, void* const buf,
 
 bool Disk::FilePart::CreateDir(const Path& path) noexcept {
     dbg::Assert(path.IsAbsolute());
+    const stl::lock_guard guard {meta_lock_};
     fs::IdxNode inode;
     fs::DirEntry entry;
 
@@ -849,7 +1838,7 @@ bool Disk::FilePart::CreateDir(const Path& path) noexcept {
     }
 
     // Update the index node of its parent directory.
-    SyncNode(search.parent->GetNode(), io_buf, io_buf_size);
+    MarkNodeDirty(search.parent->GetNode());
 
     // Create directory entries in the new directory.
     curr_dir_entry->SetName(Path::curr_dir_name);
@@ -860,7 +1849,8 @@ bool Disk::FilePart::CreateDir(const Path& path) noexcept {
     parent_dir_entry->inode_idx = search.parent->GetNodeIdx();
     parent_dir_entry->type = fs::FileType::Directory;
 
-    GetDisk().WriteSectors(sector_lba, io_buf, min_sector_count_for_entries);
+    WriteNewDirBlock(GetDisk(), sector_lba, GetSuperBlock().GetBlockSectorCount(), curr_dir_entry,
+                     fs::Directory::min_entry_count);
     SyncBlockBitmap(sector_lba);
 
     // Create an index node for the new directory.
@@ -869,7 +1859,7 @@ bool Disk::FilePart::CreateDir(const Path& path) noexcept {
     inode.size = fs::Directory::min_entry_count * sizeof(fs::DirEntry);
 
     // Save the index node of the new directory.
-    SyncNode(inode, io_buf, io_buf_size);
+    SyncNode(inode);
     SyncNodeBitmap(inode_idx);
 
     mem::Free(io_buf);
@@ -898,6 +1888,7 @@ bool Disk::FilePart::DeleteFile(const Path& path) noexcept {
         return false;
     }
 
+    const stl::lock_guard guard {meta_lock_};
     PathSearchRecord search;
     const auto found {SearchPath(path, search)};
     dbg::Assert(search.parent);
@@ -925,222 +1916,78 @@ bool Disk::FilePart::DeleteFile(const Path& path) noexcept {
     return true;
 }
 
-stl::size_t Disk::FilePart::WriteFile(fs::File& file, const void* const data,
-                                      const stl::size_t size) noexcept {
+stl::size_t Disk::FilePart::WriteFile(fs::File& file, const IoVec* const vecs,
+                                      const stl::size_t count) noexcept {
     dbg::Assert(file.IsOpen());
+    const auto size {GetIoVecSize(vecs, count)};
     auto& inode {file.GetNode()};
     const auto curr_size {inode.size};
-    if (curr_size + size > sector_count_per_inode * sector_size) {
+    const auto& super_block {GetSuperBlock()};
+    const auto block_sector_count {super_block.GetBlockSectorCount()};
+    const auto block_size {super_block.GetBlockSize()};
+    const auto max_block_count {GetMaxBlockCountPerFile(super_block)};
+    if (curr_size + size > max_block_count * block_size) {
         io::PrintlnStr("Failed to write. The file exceeds the maximum size.");
         return 0;
     }
 
-    const auto lbas {mem::Allocate<stl::size_t>(sector_count_per_inode * sizeof(stl::size_t))};
+    // LBAs of a run are loaded before they are written.
+    const auto lbas {
+        mem::AllocateUninit<stl::size_t>(BlockCache::max_run_count * sizeof(stl::size_t))};
     mem::AssertAlloc(lbas);
 
-    constexpr auto io_buf_size {2 * sector_size};
+    // Blocks contiguous on the disk are written together.
+    constexpr auto io_buf_size {BlockCache::max_run_count * sector_size};
+    static_assert(io_buf_size >= fs::SuperBlock::max_block_sector_count * sector_size);
     const auto io_buf {mem::Allocate<stl::byte>(io_buf_size)};
     mem::AssertAlloc(io_buf);
 
-    const auto curr_sector_count {RoundUpDivide(curr_size, sector_size)};
-    const auto new_sector_count {RoundUpDivide(curr_size + size, sector_size)};
-    dbg::Assert(curr_sector_count <= new_sector_count
-                && new_sector_count <= sector_count_per_inode);
+    const auto curr_block_count {RoundUpDivide(curr_size, block_size)};
+    const auto new_block_count {RoundUpDivide(curr_size + size, block_size)};
+    dbg::Assert(curr_block_count <= new_block_count && new_block_count <= max_block_count);
 
-    // Collect block LBAs to which the data should be written.
+    // Allocate blocks to which the data should be written.
     auto& disk {GetDisk()};
-    if (curr_sector_count == new_sector_count) {
-        // The new data can be saved in the current last sector.
-        if (new_sector_count <= fs::IdxNode::direct_block_count) {
-            // The last sector is a direct block.
-            const auto last_sector_idx {curr_size / sector_size};
-            lbas[last_sector_idx] = inode.GetDirectLba(last_sector_idx);
-            dbg::Assert(lbas[last_sector_idx] != 0);
-        } else {
-            // The last sector is an indirect block.
-            const auto indirect_tab_lba {inode.GetIndirectTabLba()};
-            dbg::Assert(indirect_tab_lba != 0);
-            disk.ReadSectors(indirect_tab_lba, lbas + fs::IdxNode::direct_block_count,
-                             indirect_tab_sector_count_per_inode);
-        }
-    } else {
-        if (new_sector_count <= fs::IdxNode::direct_block_count) {
-            // The new data will be saved in direct blocks.
-            if (curr_size % sector_size != 0) {
-                // The last sector is not full.
-                const auto last_sector_idx {curr_size / sector_size};
-                lbas[last_sector_idx] = inode.GetDirectLba(last_sector_idx);
-                dbg::Assert(lbas[last_sector_idx] != 0);
-            }
-
-            // Allocate new direct blocks for writting.
-            auto failed {false};
-            for (stl::size_t i {curr_sector_count}; i != new_sector_count; ++i) {
-                dbg::Assert(lbas[i] == 0);
-                if (const auto new_sector_lba {AllocBlock()}; new_sector_lba != npos) {
-                    dbg::Assert(inode.GetDirectLba(i) == 0);
-                    inode.SetDirectLba(i, new_sector_lba);
-                    dbg::Assert(lbas[i] == 0);
-                    lbas[i] = new_sector_lba;
-                    SyncBlockBitmap(new_sector_lba);
-                } else {
-                    failed = true;
-                    break;
-                }
-            }
-
-            if (failed) {
-                for (stl::size_t i {curr_sector_count}; i != new_sector_count; ++i) {
-                    if (const auto lba {inode.GetDirectLba(i)}; lba != 0) {
-                        inode.SetDirectLba(i, 0);
-                        FreeBlock(lba);
-                        SyncBlockBitmap(lba);
-                    } else {
-                        break;
-                    }
-                }
-
-                mem::Free(io_buf);
-                mem::Free(lbas);
-                return 0;
-            }
-
-        } else if (curr_sector_count <= fs::IdxNode::direct_block_count
-                   && new_sector_count > fs::IdxNode::direct_block_count) {
-            // The new data will be saved in both direct and indirect blocks.
-            if (curr_size % sector_size != 0) {
-                // The last sector is not full.
-                const auto last_sector_idx {curr_size / sector_size};
-                lbas[last_sector_idx] = inode.GetDirectLba(last_sector_idx);
-                dbg::Assert(lbas[last_sector_idx] != 0);
-            }
-
-            // Create a single indirect block table.
-            const auto indirect_tab_lba {AllocBlock()};
-            if (indirect_tab_lba == npos) {
-                return 0;
-            }
-
-            dbg::Assert(inode.GetIndirectTabLba() == 0);
-            inode.SetIndirectTabLba(indirect_tab_lba);
-
-            // Allocate new direct and indirect blocks for writting.
-            auto failed {false};
-            for (stl::size_t i {curr_sector_count}; i != new_sector_count; ++i) {
-                if (const auto new_sector_lba {AllocBlock()}; new_sector_lba != npos) {
-                    if (i < fs::IdxNode::direct_block_count) {
-                        dbg::Assert(inode.GetDirectLba(i) == 0);
-                        inode.SetDirectLba(i, new_sector_lba);
-                    }
-
-                    dbg::Assert(lbas[i] == 0);
-                    lbas[i] = new_sector_lba;
-                    SyncBlockBitmap(new_sector_lba);
-                } else {
-                    failed = true;
-                    break;
-                }
-            }
-
-            if (!failed) {
-                // Save indirect block LBAs to the single indirect block table.
-                disk.WriteSectors(indirect_tab_lba, lbas + fs::IdxNode::direct_block_count,
-                                  indirect_tab_sector_count_per_inode);
-
-            } else {
-                for (stl::size_t i {curr_sector_count}; i != new_sector_count; ++i) {
-                    if (lbas[i] != 0) {
-                        if (i < fs::IdxNode::direct_block_count) {
-                            dbg::Assert(inode.GetDirectLba(i) != 0);
-                            inode.SetDirectLba(i, 0);
-                        }
-
-                        FreeBlock(lbas[i]);
-                        SyncBlockBitmap(lbas[i]);
-                    } else {
-                        break;
-                    }
-                }
-
-                dbg::Assert(inode.GetIndirectTabLba() != 0);
-                inode.SetIndirectTabLba(0);
-                FreeBlock(indirect_tab_lba);
-                SyncBlockBitmap(indirect_tab_lba);
-
-                mem::Free(io_buf);
-                mem::Free(lbas);
-                return 0;
-            }
-
-        } else {
-            // The new data will be saved in indirect blocks.
-            const auto indirect_tab_lba {inode.GetIndirectTabLba()};
-            dbg::Assert(indirect_tab_lba != 0);
-            disk.ReadSectors(indirect_tab_lba, lbas + fs::IdxNode::direct_block_count,
-                             indirect_tab_sector_count_per_inode);
-
-            // Allocate new indirect blocks for writting.
-            auto failed {false};
-            for (stl::size_t i {curr_sector_count}; i != new_sector_count; ++i) {
-                if (const auto new_sector_lba {AllocBlock()}; new_sector_lba != npos) {
-                    dbg::Assert(lbas[i] == 0);
-                    lbas[i] = new_sector_lba;
-                    SyncBlockBitmap(new_sector_lba);
-                } else {
-                    failed = true;
-                    break;
-                }
-            }
-
-            if (!failed) {
-                // Save indirect block LBAs to the single indirect block table.
-                disk.WriteSectors(indirect_tab_lba, lbas + fs::IdxNode::direct_block_count,
-                                  indirect_tab_sector_count_per_inode);
-
-            } else {
-                for (stl::size_t i {curr_sector_count}; i != new_sector_count; ++i) {
-                    if (lbas[i] != 0) {
-                        FreeBlock(lbas[i]);
-                        SyncBlockBitmap(lbas[i]);
-                    } else {
-                        break;
-                    }
-                }
-
-                mem::Free(io_buf);
-                mem::Free(lbas);
-                return 0;
-            }
-        }
+    if (!AllocNodeBlocks(inode, curr_block_count, new_block_count)) {
+        mem::Free(io_buf);
+        mem::Free(lbas);
+        return 0;
     }
 
-    // Write data to sectors and update the access offset.
+    // Write data to blocks and update the access offset.
+    IoVecCursor cursor {vecs, count};
     file.pos = curr_size - 1;
     auto is_first_write {true};
     stl::size_t written_size {0};
     while (written_size < size) {
-        stl::memset(io_buf, 0, io_buf_size);
-        const auto sector_idx {inode.size / sector_size};
-        const auto offset_in_sector {inode.size % sector_size};
-        const auto left_in_sector {sector_size - offset_in_sector};
-        const auto chunk_size {stl::min(size - written_size, left_in_sector)};
+        const auto block_idx {inode.size / block_size};
+        const auto offset_in_block {inode.size % block_size};
+        const auto last_block_idx {(inode.size + size - written_size - 1) / block_size};
+        // Write a run of contiguous blocks with a single command.
+        const auto window {stl::min(last_block_idx + 1 - block_idx,
+                                    BlockCache::max_run_count / block_sector_count)};
+        LoadNodeLbas(disk, inode, lbas, block_idx, block_idx + window);
+        dbg::Assert(lbas[0] != 0);
+        const auto run_len {GetRunLen(lbas, 0, window, block_sector_count)};
+        const auto chunk_size {
+            stl::min(size - written_size, run_len * block_size - offset_in_block)};
+        stl::memset(io_buf, 0, run_len * block_size);
         if (is_first_write) {
-            // When new data is written to a sector for the first time, there usually exist old data in the target sector.
+            // When new data is written to a block for the first time, there usually exist old data in the target block.
             // We need to read them first, then save the new data to the free area,
-            // and finally write the new data to the disk together with the old data in the sector.
-            disk.ReadSectors(lbas[sector_idx], io_buf);
+            // and finally write the new data to the disk together with the old data in the block.
+            GetBlockCache().Read(disk, lbas[0], io_buf, block_sector_count);
             is_first_write = false;
         }
 
-        stl::memcpy(io_buf + offset_in_sector, static_cast<const stl::byte*>(data) + written_size,
-                    chunk_size);
-        disk.WriteSectors(lbas[sector_idx], io_buf);
+        cursor.Gather(io_buf + offset_in_block, chunk_size);
+        GetBlockCache().Write(disk, lbas[0], io_buf, run_len * block_sector_count);
         written_size += chunk_size;
         file.pos += chunk_size;
         inode.size += chunk_size;
     }
 
-    SyncNode(inode, io_buf, io_buf_size);
+    MarkNodeDirty(inode);
     mem::Free(io_buf);
     mem::Free(lbas);
     return written_size;
@@ -1154,6 +2001,8 @@ FileDesc Disk::FilePart::OpenFile(const Path& path,
         return {};
     }
 
+    // Opening a file allocates a global file descriptor and may create the file.
+    const stl::lock_guard guard {meta_lock_};
     PathSearchRecord search;
     const auto found {SearchPath(path, search)};
     dbg::Assert(search.parent);
@@ -1193,10 +2042,10 @@ FileDesc Disk::FilePart::CreateFile(fs::Directory& dir, const stl::string_view n
     const auto io_buf {mem::Allocate(io_buf_size)};
     mem::AssertAlloc(io_buf);
 
-    const auto inode {mem::Allocate<fs::IdxNode>(sizeof(fs::IdxNode))};
+    const auto inode {fs::IdxNode::Create()};
     mem::AssertAlloc(inode);
     const auto inode_idx {AllocNode()};
-    const auto desc {tab.GetFreeDesc()};
+    const auto desc {tab.AllocDesc()};
     if (inode_idx == npos || !desc.IsValid()) {
         goto rollback;
     }
@@ -1219,28 +2068,35 @@ FileDesc Disk::FilePart::CreateFile(fs::Directory& dir, const stl::string_view n
     }
 
     // Update the index node of its parent directory.
-    SyncNode(dir.GetNode(), io_buf, io_buf_size);
+    MarkNodeDirty(dir.GetNode());
+
+    // Add the index node to the table of open nodes.
+    inode->open_times = 1;
+    open_inodes_.Insert(inode_idx, inode->tag);
 
     // Save the index node of the new file.
-    SyncNode(*inode, io_buf, io_buf_size);
+    MarkNodeDirty(*inode);
     SyncNodeBitmap(inode_idx);
 
-    // Add the index node to the list of open nodes.
-    inode->open_times = 1;
-    open_inodes_.PushBack(inode->tag);
-
     mem::Free(io_buf);
-    return tsk::ProcFileDescTab::SyncGlobal(desc);
+    if (const auto local {tsk::ProcFileDescTab::SyncGlobal(desc)}; local.IsValid()) {
+        return local;
+    } else {
+        tab.FreeDesc(desc);
+        return {};
+    }
 
 rollback:
     mem::Free(io_buf);
 
-    if (!inode) {
-        mem::Free(inode);
+    if (inode) {
+        fs::IdxNode::Destroy(inode);
     }
 
     if (desc.IsValid()) {
+        // The index node has been destroyed, so the file is cleared before the descriptor is released.
         tab[desc].Clear();
+        tab.FreeDesc(desc);
     }
 
     if (inode_idx != npos) {
@@ -1258,35 +2114,45 @@ bool Disk::FilePart::DeleteDirEntry(fs::Directory& dir, const stl::size_t inode_
     dbg::Assert(inode.size >= fs::Directory::min_entry_count * sizeof(fs::DirEntry)
                 && inode.size % sizeof(fs::DirEntry) == 0);
     auto& disk {GetDisk()};
+    const auto block_sector_count {GetSuperBlock().GetBlockSectorCount()};
     auto lbas {LoadNodeLbas(disk, inode)};
     for (stl::size_t i {0}; i != lbas.size(); ++i) {
         if (lbas[i] == 0) {
             continue;
         }
 
-        stl::memset(io_buf, 0, io_buf_size);
-        const auto entries {LoadDirEntries(disk, lbas[i], io_buf, io_buf_size)};
-
-        fs::DirEntry* found_entry {nullptr};
+        // The LBA of the sector containing the target entry.
+        auto found_lba {npos};
+        stl::size_t found_idx {0};
         stl::size_t entry_count {0};
-        // Try to find the target entry and count the number of entries in the parent directory.
-        for (stl::size_t j {0}; j != dir_entry_count_per_sector; ++j) {
-            if (auto& entry {entries[j]}; entry.type != fs::FileType::Unknown) {
-                ++entry_count;
-                if (entry.name.data() != Path::curr_dir_name
-                    && entry.name.data() != Path::parent_dir_name && entry.inode_idx == inode_idx) {
-                    dbg::Assert(!found_entry);
-                    found_entry = &entry;
+        // Try to find the target entry and count the number of entries in the block.
+        for (stl::size_t j {0}; j != block_sector_count; ++j) {
+            const auto entries {LoadDirEntries(disk, lbas[i] + j, io_buf, io_buf_size)};
+            for (stl::size_t k {0}; k != dir_entry_count_per_sector; ++k) {
+                if (const auto& entry {entries[k]}; entry.type != fs::FileType::Unknown) {
+                    ++entry_count;
+                    if (entry.inode_idx == inode_idx && !entry.HasName(Path::curr_dir_name)
+                        && !entry.HasName(Path::parent_dir_name)) {
+                        dbg::Assert(found_lba == npos);
+                        found_lba = lbas[i] + j;
+                        found_idx = k;
+                    }
                 }
             }
         }
 
         dbg::Assert(entry_count >= fs::Directory::min_entry_count);
-        if (found_entry) {
+        if (found_lba != npos) {
+            // The index node will be deleted and its ID may be reused.
+            fs::GetDentryCache().Erase(this, inode_idx);
             // The entry is found.
             if (entry_count == fs::Directory::min_entry_count + 1) {
                 // The entry is the last one in the parent directory.
                 // The block should be freed after deletion.
+                if (const auto index {inode.GetDirIndex()}; index) {
+                    index->Erase(lbas[i], lbas[i] + block_sector_count);
+                }
+
                 FreeBlock(lbas[i]);
                 SyncBlockBitmap(lbas[i]);
                 if (i < fs::IdxNode::direct_block_count) {
@@ -1303,26 +2169,31 @@ bool Disk::FilePart::DeleteDirEntry(fs::Directory& dir, const stl::size_t inode_
                     const auto indirect_tab_lba {inode.GetIndirectTabLba()};
                     if (indirect_block_count > 1) {
                         lbas[i] = 0;
-                        disk.WriteSectors(indirect_tab_lba,
-                                          lbas.data() + fs::IdxNode::direct_block_count,
-                                          indirect_tab_sector_count_per_inode);
+                        SaveIndirectLbas(disk, inode,
+                                         lbas.data() + fs::IdxNode::direct_block_count);
                     } else {
                         // The block is the last one in the index node of the parent directory.
                         // Free the single indirect block table.
                         FreeBlock(indirect_tab_lba);
                         SyncBlockBitmap(indirect_tab_lba);
                         inode.SetIndirectTabLba(0);
+                        inode.DropIndirectLbas();
                     }
                 }
             } else {
                 // Clear the entry.
-                stl::memset(found_entry, 0, sizeof(fs::DirEntry));
-                disk.WriteSectors(lbas[i], io_buf);
+                const auto entries {LoadDirEntries(disk, found_lba, io_buf, io_buf_size)};
+                if (const auto index {inode.GetDirIndex()}; index) {
+                    index->Erase(entries[found_idx].name.data(), {found_lba, found_idx});
+                }
+
+                stl::memset(&entries[found_idx], 0, sizeof(fs::DirEntry));
+                GetBlockCache().Write(disk, found_lba, io_buf);
             }
 
             // Update the index node of the parent directory.
             inode.size -= sizeof(fs::DirEntry);
-            SyncNode(inode, io_buf, io_buf_size);
+            MarkNodeDirty(inode);
             return true;
         }
     }
@@ -1337,7 +2208,11 @@ bool Disk::FilePart::SyncDirEntry(fs::Directory& dir, const fs::DirEntry& entry,
     auto& inode {dir.GetNode()};
     dbg::Assert(inode.size >= fs::Directory::min_entry_count * sizeof(fs::DirEntry)
                 && inode.size % sizeof(fs::DirEntry) == 0);
+    // Drop the negative entry of the name.
+    fs::GetDentryCache().Erase(this, dir.GetNodeIdx(), entry.name.data());
+
     auto& disk {GetDisk()};
+    const auto block_sector_count {GetSuperBlock().GetBlockSectorCount()};
     auto lbas {LoadNodeLbas(disk, inode)};
     for (stl::size_t i {0}; i != lbas.size(); ++i) {
         if (lbas[i] == 0) {
@@ -1368,26 +2243,28 @@ bool Disk::FilePart::SyncDirEntry(fs::Directory& dir, const fs::DirEntry& entry,
                 }
 
                 // Save the new indirect block LBA to the partition.
-                disk.WriteSectors(indirect_tab_lba, lbas.data() + fs::IdxNode::direct_block_count,
-                                  indirect_tab_sector_count_per_inode);
+                SaveIndirectLbas(disk, inode, lbas.data() + fs::IdxNode::direct_block_count);
             }
 
             // Save the new directory entry to the partition.
-            stl::memset(io_buf, 0, io_buf_size);
-            stl::memcpy(io_buf, &entry, sizeof(fs::DirEntry));
-            disk.WriteSectors(new_sector_lba, io_buf);
+            WriteNewDirBlock(disk, new_sector_lba, block_sector_count, &entry, 1);
+            IndexDirEntry(inode, entry, new_sector_lba, 0);
             inode.size += sizeof(fs::DirEntry);
             return true;
         } else {
             // Find an empty position in an existing block for the new directory entry.
-            const auto entries {LoadDirEntries(disk, lbas[i], io_buf, io_buf_size)};
-            for (stl::size_t j {0}; j != dir_entry_count_per_sector; ++j) {
-                if (entries[j].type == fs::FileType::Unknown) {
-                    // Save the new directory entry to the partition.
-                    stl::memcpy(&entries[j], &entry, sizeof(fs::DirEntry));
-                    disk.WriteSectors(lbas[i], io_buf);
-                    inode.size += sizeof(fs::DirEntry);
-                    return true;
+            for (stl::size_t j {0}; j != block_sector_count; ++j) {
+                const auto lba {lbas[i] + j};
+                const auto entries {LoadDirEntries(disk, lba, io_buf, io_buf_size)};
+                for (stl::size_t k {0}; k != dir_entry_count_per_sector; ++k) {
+                    if (entries[k].type == fs::FileType::Unknown) {
+                        // Save the new directory entry to the partition.
+                        stl::memcpy(&entries[k], &entry, sizeof(fs::DirEntry));
+                        GetBlockCache().Write(disk, lba, io_buf);
+                        IndexDirEntry(inode, entry, lba, k);
+                        inode.size += sizeof(fs::DirEntry);
+                        return true;
+                    }
                 }
             }
         }
@@ -1397,21 +2274,107 @@ bool Disk::FilePart::SyncDirEntry(fs::Directory& dir, const fs::DirEntry& entry,
     return false;
 }
 
-Disk::FilePart& Disk::FilePart::SyncNode(const fs::IdxNode& inode, void* const io_buf,
-                                         const stl::size_t io_buf_size) noexcept {
-    dbg::Assert(io_buf && io_buf_size >= 2 * sector_size);
+Disk::FilePart& Disk::FilePart::SyncNode(const fs::IdxNode& inode) noexcept {
     fs::IdxNode pure {};
     inode.CloneToPure(pure);
 
-    auto& disk {GetDisk()};
-    // Get the position of the index node.
+    // Overwrite the index node in the cached sectors where it is located.
+    // On sector-aligned file systems, it only touches one sector.
     const IdxNodePos pos {*this, inode.idx};
-    const auto sector_count {pos.is_across_sectors ? 2 : 1};
-    // Read one or two sectors where the index node is located.
-    disk.ReadSectors(pos.lba, io_buf, sector_count);
-    // Overwrite the index node to the disk.
-    stl::memcpy(static_cast<stl::byte*>(io_buf) + pos.offset_in_sector, &pure, sizeof(fs::IdxNode));
-    disk.WriteSectors(pos.lba, io_buf, sector_count);
+    GetBlockCache().WriteBytes(GetDisk(), pos.lba, pos.offset_in_sector, &pure, pos.size);
+    return *this;
+}
+
+Disk::FilePart& Disk::FilePart::MarkNodeDirty(fs::IdxNode& inode) noexcept {
+    dbg::Assert(inode.IsOpen());
+    const intr::IntrGuard guard;
+    if (!inode.dirty) {
+        inode.dirty = true;
+        inode.open_times += 1;
+    }
+
+    return *this;
+}
+
+Disk::FilePart& Disk::FilePart::DropNodeDirty(fs::IdxNode& inode) noexcept {
+    dbg::Assert(inode.IsOpen());
+    auto dirty {false};
+    {
+        const intr::IntrGuard guard;
+        dirty = inode.dirty;
+        inode.dirty = false;
+    }
+
+    if (dirty) {
+        // Release the reference held by the dirty status.
+        inode.Close();
+    }
+
+    return *this;
+}
+
+Disk::FilePart& Disk::FilePart::FlushMeta() noexcept {
+    const stl::lock_guard guard {meta_lock_};
+    // Free blocks of deleted files first, so their bitmap sectors are written below.
+    ReclaimBlocks();
+    const auto& super_block {GetSuperBlock()};
+    const auto block_bitmap_sector_count {super_block.block_bitmap_sector_count};
+    const auto bitmap_sector_count {block_bitmap_sector_count
+                                    + super_block.inode_bitmap_sector_count};
+    for (stl::size_t i {0}; i != bitmap_sector_count; ++i) {
+        if (dirty_bitmap_sectors_.IsAlloc(i)) {
+            if (i < block_bitmap_sector_count) {
+                WriteBitmapSector(BitmapType::Block, i);
+            } else {
+                WriteBitmapSector(BitmapType::Node, i - block_bitmap_sector_count);
+            }
+
+            dirty_bitmap_sectors_.Free(i);
+        }
+    }
+
+    if (super_block_dirty_) {
+        WriteSuperBlock();
+    }
+
+    while (true) {
+        fs::IdxNode* inode {nullptr};
+        {
+            const stl::lock_guard guard {inode_lock_};
+            if (const auto found_tag {open_inodes_.Find(
+                    [](const TagList::Tag& tag, void*) noexcept {
+                        return fs::IdxNode::GetByTag(tag).dirty;
+                    })};
+                found_tag) {
+                inode = &fs::IdxNode::GetByTag(*found_tag);
+            }
+        }
+
+        if (!inode) {
+            break;
+        }
+
+        // A dirty index node is still open since it holds a reference.
+        SyncNode(*inode);
+        DropNodeDirty(*inode);
+    }
+
+    return *this;
+}
+
+Disk::FilePart& Disk::FilePart::WriteSuperBlock() noexcept {
+    // Save the hints of bitmaps, so allocations after the next mount do not scan from the beginning.
+    super_block_->free_block_hint = block_bitmap_.GetFreeHint();
+    super_block_->free_inode_hint = inode_bitmap_.GetFreeHint();
+    GetBlockCache().WriteBytes(GetDisk(), start_lba_ + fs::PaddedSuperBlock::start_lba, 0,
+                               super_block_, sizeof(fs::SuperBlock));
+    super_block_dirty_ = false;
+    return *this;
+}
+
+Disk::FilePart& Disk::FilePart::Sync() noexcept {
+    FlushMeta();
+    GetBlockCache().Flush();
     return *this;
 }
 
@@ -1426,51 +2389,16 @@ void InitFileSys() noexcept {
     dbg::Assert(mem::IsMemInited());
     dbg::Assert(!GetDefaultPartImpl());
 
-    const auto super_block {mem::Allocate<fs::SuperBlock>(sizeof(fs::PaddedSuperBlock))};
-    mem::AssertAlloc(super_block);
-
-    stl::size_t inited_disk_count {0};
-    // Create a file system in each partition of all disks on IDE channels.
-    for (stl::size_t chnl_idx {0}; chnl_idx != GetIdeChnlCount(); ++chnl_idx) {
-        auto& chnl {GetIdeChnls()[chnl_idx]};
-        for (stl::size_t disk_idx {0};
-             disk_idx != IdeChnl::max_disk_count && inited_disk_count != GetDiskCount();
-             ++disk_idx, ++inited_disk_count) {
-            // Skip the boot disk.
-            if (disk_idx != boot_disk_idx) {
-                auto& disk {chnl.GetDisk(disk_idx)};
-                for (stl::size_t part_idx {0};
-                     part_idx != Disk::prim_part_count + Disk::max_logic_part_count; ++part_idx) {
-                    if (const auto part {
-                            part_idx < Disk::prim_part_count
-                                ? &disk.GetPrimaryPart(part_idx)
-                                : &disk.GetLogicPart(part_idx - Disk::prim_part_count)};
-                        part->IsValid()) {
-                        // Create a super block in the partition.
-                        stl::memset(super_block, 0, sizeof(fs::PaddedSuperBlock));
-                        disk.ReadSectors(part->GetStartLba() + fs::PaddedSuperBlock::start_lba,
-                                         super_block,
-                                         RoundUpDivide<stl::size_t>(sizeof(fs::PaddedSuperBlock),
-                                                                    Disk::sector_size));
-                        if (!super_block->IsSignValid()) {
-                            // Create a file system in the partition.
-                            FormatPart(*part);
-                            io::Printf("The file system on the partition '{}' has been "
-                                       "formatted.\n",
-                                       part->GetName());
-                        } else {
-                            io::Printf("The partition '{}' already has a file system.\n",
-                                       part->GetName());
-                        }
-                    }
-                }
-            }
-        }
-    }
-
+    auto& part {FindDefaultPart()};
+    // The partition is checked and formatted by direct disk accesses before the cache is used.
+    PrepareFileSys(part);
+    InitBlockCache();
     // Mount the default partition and open its root directory.
-    MountDefaultPart();
-    GetDefaultPart().OpenRootDir();
+    GetDefaultPartImpl() = &part;
+    part.LoadSuperBlock();
+    io::Printf("The partition '{}' has been mounted.\n", part.GetName());
+    part.OpenRootDir();
+    tsk::KrnlThread::Create("meta flusher", meta_flusher_priority, &WriteBackMeta);
 }
 
 namespace fs {
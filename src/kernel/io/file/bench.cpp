@@ -0,0 +1,354 @@
+#include "kernel/io/file/bench.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/disk/disk.h"
+#include "kernel/io/file/dir.h"
+#include "kernel/io/file/file.h"
+#include "kernel/io/timer.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/cstring.h"
+
+namespace io {
+
+namespace {
+
+//! The directory containing all benchmark files.
+constexpr stl::string_view bench_dir {"/bench"};
+
+//! The size of the file used by sequential and random workloads.
+constexpr stl::size_t seq_file_size {KB(256)};
+//! The size of each sequential read or write.
+constexpr stl::size_t seq_chunk_size {KB(4)};
+//! The number of random reads or writes.
+constexpr stl::size_t rand_op_count {256};
+//! The number of small files to create and delete.
+constexpr stl::size_t small_file_count {64};
+//! The size of each small file.
+constexpr stl::size_t small_file_size {128};
+//! The depth of the deep directory.
+constexpr stl::size_t deep_dir_depth {8};
+//! The number of times to open the file in the deep directory.
+constexpr stl::size_t deep_open_count {128};
+//! The number of times to list a directory.
+constexpr stl::size_t list_count {32};
+//! The number of entries read per directory read.
+constexpr stl::size_t list_batch_size {16};
+
+//! The flags to create a new file.
+constexpr auto create_flags {
+    bit::Flags<File::OpenMode> {File::OpenMode::CreateNew}.Set(File::OpenMode::ReadWrite)};
+
+/**
+ * @brief Divide a 64-bit integer by a 32-bit integer.
+ *
+ * @details
+ * The kernel is not linked with the compiler runtime, so 64-bit division is done bit by bit.
+ */
+stl::uint64_t Divide(const stl::uint64_t dividend, const stl::uint32_t divisor) noexcept {
+    dbg::Assert(divisor != 0);
+    stl::uint64_t quotient {0};
+    stl::uint64_t remainder {0};
+    for (auto i {static_cast<stl::int32_t>(sizeof(dividend) * bit::byte_len) - 1}; i >= 0; --i) {
+        remainder = (remainder << 1) | ((dividend >> i) & 1);
+        if (remainder >= divisor) {
+            remainder -= divisor;
+            quotient |= static_cast<stl::uint64_t>(1) << i;
+        }
+    }
+
+    return quotient;
+}
+
+//! Convert nanoseconds to microseconds, saturating at the maximum 32-bit value.
+stl::uint32_t ToMicroseconds(const stl::uint64_t ns) noexcept {
+    const auto us {Divide(ns, 1000)};
+    return bit::GetHighDword(us) == 0 ? bit::GetLowDword(us) : 0xFFFFFFFF;
+}
+
+//! The latencies of operations in a workload.
+class Samples {
+public:
+    //! The maximum number of saved latencies.
+    static constexpr stl::size_t max_count {256};
+
+    explicit Samples(const stl::string_view name) noexcept :
+        name_ {name}, latencies_ {mem::Allocate<stl::uint32_t>(max_count * sizeof(stl::uint32_t))} {
+        mem::AssertAlloc(latencies_);
+    }
+
+    Samples(const Samples&) = delete;
+
+    ~Samples() noexcept {
+        mem::Free(latencies_);
+    }
+
+    //! Start timing an operation.
+    Samples& Begin() noexcept {
+        begin_ = GetNanoseconds();
+        return *this;
+    }
+
+    //! Finish timing an operation.
+    Samples& End() noexcept {
+        const auto ns {GetNanoseconds() - begin_};
+        total_ns_ += ns;
+        if (count_ != max_count) {
+            latencies_[count_] = ToMicroseconds(ns);
+        }
+
+        ++count_;
+        return *this;
+    }
+
+    /**
+     * @brief Print the throughput and latency percentiles.
+     *
+     * @param bytes The number of transferred bytes, or zero to print operations per second.
+     */
+    void Report(const stl::size_t bytes = 0) noexcept {
+        const auto saved {stl::min(count_, max_count)};
+        if (saved == 0) {
+            Printf("{}: no operations.\n", name_);
+            return;
+        }
+
+        // The number of samples is small, so insertion sort is enough.
+        for (stl::size_t i {1}; i < saved; ++i) {
+            const auto latency {latencies_[i]};
+            auto j {i};
+            for (; j != 0 && latencies_[j - 1] > latency; --j) {
+                latencies_[j] = latencies_[j - 1];
+            }
+
+            latencies_[j] = latency;
+        }
+
+        const auto total_us {stl::max<stl::uint32_t>(ToMicroseconds(total_ns_), 1)};
+        Printf("{}: {} ops", name_, count_);
+        if (bytes != 0) {
+            Printf(", {} KiB/s",
+                   Divide(static_cast<stl::uint64_t>(bytes) * 1000000, total_us) / KB(1));
+        } else {
+            Printf(", {} ops/s", Divide(static_cast<stl::uint64_t>(count_) * 1000000, total_us));
+        }
+
+        Printf(", p50 {} us, p90 {} us, p99 {} us, max {} us.\n", GetPercentile(50),
+               GetPercentile(90), GetPercentile(99), latencies_[saved - 1]);
+    }
+
+private:
+    //! Get a percentile of sorted latencies.
+    stl::uint32_t GetPercentile(const stl::size_t percent) const noexcept {
+        const auto saved {stl::min(count_, max_count)};
+        return latencies_[stl::min(saved * percent / 100, saved - 1)];
+    }
+
+    stl::string_view name_;
+    stl::uint32_t* latencies_;
+    stl::size_t count_ {0};
+    stl::uint64_t total_ns_ {0};
+    stl::uint64_t begin_ {0};
+};
+
+//! The xorshift pseudo-random number generator.
+class Random {
+public:
+    constexpr explicit Random(const stl::uint32_t seed) noexcept : state_ {seed} {}
+
+    stl::uint32_t Next() noexcept {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+private:
+    stl::uint32_t state_;
+};
+
+//! Format a numbered name like @p "f07" into a buffer.
+stl::string_view FormatName(stl::array<char, Path::max_name_len + 1>& buf, const char prefix,
+                            const stl::size_t num) noexcept {
+    dbg::Assert(num < 100);
+    buf[0] = prefix;
+    buf[1] = static_cast<char>('0' + num / 10);
+    buf[2] = static_cast<char>('0' + num % 10);
+    buf[3] = '\0';
+    return buf.data();
+}
+
+//! Whether a directory contains an entry.
+bool Contain(const Path& dir, const stl::string_view name) noexcept {
+    const auto entries {mem::Allocate<fs::DirEntry>(list_batch_size * sizeof(fs::DirEntry))};
+    mem::AssertAlloc(entries);
+    fs::Directory::Cursor cursor {};
+    auto found {false};
+    while (!found) {
+        const auto count {Directory::ReadEntries(dir, cursor, entries, list_batch_size)};
+        if (count == 0) {
+            break;
+        }
+
+        for (stl::size_t i {0}; i != count && !found; ++i) {
+            found = entries[i].HasName(name);
+        }
+    }
+
+    mem::Free(entries);
+    return found;
+}
+
+//! Create a directory if it does not exist, so repeated runs do not print errors.
+bool CreateDir(const Path& parent, const stl::string_view name) noexcept {
+    return Contain(parent, name) || Directory::Create(parent.Join(name));
+}
+
+void BenchSequential(File& file, stl::byte* const buf) noexcept {
+    stl::memset(buf, 0x5A, seq_chunk_size);
+    Samples write {"Sequential write"};
+    for (stl::size_t i {0}; i != seq_file_size / seq_chunk_size; ++i) {
+        write.Begin();
+        file.Write(buf, seq_chunk_size);
+        write.End();
+    }
+
+    write.Report(seq_file_size);
+
+    Samples read {"Sequential read"};
+    file.Seek(0, File::SeekOrigin::Begin);
+    for (stl::size_t i {0}; i != seq_file_size / seq_chunk_size; ++i) {
+        read.Begin();
+        file.Read(buf, seq_chunk_size);
+        read.End();
+    }
+
+    read.Report(seq_file_size);
+}
+
+void BenchRandom(File& file, stl::byte* const buf) noexcept {
+    constexpr auto op_size {Disk::sector_size};
+    constexpr auto slot_count {seq_file_size / op_size};
+    Random random {0x12345678};
+    Samples write {"Random write"};
+    for (stl::size_t i {0}; i != rand_op_count; ++i) {
+        const auto offset {(random.Next() % slot_count) * op_size};
+        write.Begin();
+        file.Seek(static_cast<stl::int32_t>(offset), File::SeekOrigin::Begin);
+        file.Write(buf, op_size);
+        write.End();
+    }
+
+    write.Report(rand_op_count * op_size);
+
+    Samples read {"Random read"};
+    for (stl::size_t i {0}; i != rand_op_count; ++i) {
+        const auto offset {(random.Next() % slot_count) * op_size};
+        read.Begin();
+        file.Seek(static_cast<stl::int32_t>(offset), File::SeekOrigin::Begin);
+        file.Read(buf, op_size);
+        read.End();
+    }
+
+    read.Report(rand_op_count * op_size);
+}
+
+void BenchSmallFiles(const Path& dir, const stl::byte* const data) noexcept {
+    stl::array<char, Path::max_name_len + 1> name;
+    Samples create {"Small file create"};
+    for (stl::size_t i {0}; i != small_file_count; ++i) {
+        const auto path {dir.Join(FormatName(name, 'f', i))};
+        create.Begin();
+        File file {path, create_flags};
+        file.Write(data, small_file_size);
+        file.Close();
+        create.End();
+    }
+
+    create.Report();
+
+    Samples list {"Directory list"};
+    const auto entries {mem::Allocate<fs::DirEntry>(list_batch_size * sizeof(fs::DirEntry))};
+    mem::AssertAlloc(entries);
+    for (stl::size_t i {0}; i != list_count; ++i) {
+        fs::Directory::Cursor cursor {};
+        list.Begin();
+        while (Directory::ReadEntries(dir, cursor, entries, list_batch_size) != 0) {
+        }
+
+        list.End();
+    }
+
+    mem::Free(entries);
+    list.Report();
+
+    Samples del {"Small file delete"};
+    for (stl::size_t i {0}; i != small_file_count; ++i) {
+        const auto path {dir.Join(FormatName(name, 'f', i))};
+        del.Begin();
+        File::Delete(path);
+        del.End();
+    }
+
+    del.Report();
+}
+
+void BenchDeepLookup(const Path& dir) noexcept {
+    stl::array<char, Path::max_name_len + 1> name;
+    auto path {dir};
+    for (stl::size_t i {0}; i != deep_dir_depth; ++i) {
+        if (!CreateDir(path, FormatName(name, 'd', i))) {
+            return;
+        }
+
+        path.Join(name.data());
+    }
+
+    path.Join("file");
+    File {path, create_flags}.Close();
+    Samples lookup {"Deep path lookup"};
+    for (stl::size_t i {0}; i != deep_open_count; ++i) {
+        lookup.Begin();
+        File {path, File::OpenMode::ReadOnly}.Close();
+        lookup.End();
+    }
+
+    lookup.Report();
+    File::Delete(path);
+}
+
+}  // namespace
+
+void RunFileSysBench() noexcept {
+    const Path root {Path::root_dir_name};
+    if (!CreateDir(root, Path::GetFileName(bench_dir))) {
+        return;
+    }
+
+    const Path dir {bench_dir};
+    const auto stats {File::GetSysStats()};
+    Printf("File system benchmark: {}-byte blocks, {} of {} blocks free.\n", stats.block_size,
+           stats.free_block_count, stats.block_count);
+
+    const auto buf {mem::Allocate<stl::byte>(seq_chunk_size)};
+    mem::AssertAlloc(buf);
+    {
+        const auto path {dir.Join("seq")};
+        File file {path, create_flags};
+        if (file.IsOpen()) {
+            BenchSequential(file, buf);
+            BenchRandom(file, buf);
+            file.Close();
+            File::Delete(path);
+        }
+    }
+
+    if (CreateDir(dir, "small")) {
+        BenchSmallFiles(dir.Join("small"), buf);
+    }
+
+    BenchDeepLookup(dir);
+    mem::Free(buf);
+    File::Sync();
+}
+
+}  // namespace io
@@ -1,5 +1,9 @@
 #include "kernel/io/file/dir.h"
 #include "kernel/io/disk/disk.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/cstring.h"
 
 namespace io {
 
@@ -7,12 +11,51 @@ bool Directory::Create(const Path& path) noexcept {
     return GetDefaultPart().CreateDir(path);
 }
 
+stl::size_t Directory::ReadEntries(const Path& path, fs::Directory::Cursor& cursor,
+                                   fs::DirEntry* const entries, const stl::size_t count) noexcept {
+    return GetDefaultPart().ReadDir(path, cursor, entries, count);
+}
+
 namespace sc {
 
 bool Directory::Create(const char* const path) noexcept {
     return io::Directory::Create(path);
 }
 
+stl::size_t Directory::ReadEntries(const char* const path, fs::Directory::Cursor* const cursor,
+                                   fs::DirEntry* const entries, const stl::size_t count) noexcept {
+    if (!path || !cursor || !entries || count == 0) {
+        return 0;
+    }
+
+    const auto buf_count {stl::min(count, mem::page_size / sizeof(fs::DirEntry))};
+    const auto buf {mem::AllocateUninit<fs::DirEntry>(mem::PoolType::Kernel,
+                                                      buf_count * sizeof(fs::DirEntry))};
+    if (!buf) {
+        return 0;
+    }
+
+    // Entries are read into kernel memory and then copied to the user buffer,
+    // since a page fault on user memory must not happen while the file system is locked.
+    const Path krnl_path {path};
+    auto krnl_cursor {*cursor};
+    stl::size_t read_count {0};
+    while (read_count != count) {
+        const auto batch_count {stl::min(count - read_count, buf_count)};
+        const auto batch_read {
+            io::Directory::ReadEntries(krnl_path, krnl_cursor, buf, batch_count)};
+        stl::memcpy(entries + read_count, buf, batch_read * sizeof(fs::DirEntry));
+        read_count += batch_read;
+        if (batch_read != batch_count) {
+            break;
+        }
+    }
+
+    mem::Free(mem::PoolType::Kernel, buf);
+    *cursor = krnl_cursor;
+    return read_count;
+}
+
 }  // namespace sc
 
 }  // namespace io
\ No newline at end of file
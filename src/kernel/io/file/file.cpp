@@ -2,22 +2,225 @@
 #include "kernel/debug/assert.h"
 #include "kernel/io/disk/disk.h"
 #include "kernel/io/disk/file/file.h"
+#include "kernel/io/file/pipe.h"
+#include "kernel/io/video/print.h"
+#include "kernel/krnl.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/cstring.h"
 #include "kernel/thread/thd.h"
 
 namespace io {
 
+namespace {
+
+//! Get the file of a local descriptor in the global file table.
+fs::File& GetGlobalFile(const FileDesc desc) noexcept {
+    const auto global {tsk::ProcFileDescTab::GetGlobal(desc)};
+    auto& file_tab {fs::GetFileTab()};
+    dbg::Assert(global < file_tab.GetSize());
+    return file_tab[global];
+}
+
+//! Get the pipe of a local descriptor if it is an end of a pipe, otherwise @p nullptr.
+Pipe* GetPipe(const FileDesc desc, const bool write_end) noexcept {
+    const auto& file {GetGlobalFile(desc)};
+    if (!file.IsPipe()) {
+        return nullptr;
+    } else if (file.flags.IsSet(File::OpenMode::WriteOnly) != write_end) {
+        io::Printf("The descriptor {} is not the {} end of a pipe.\n", static_cast<stl::size_t>(desc),
+                   write_end ? "write" : "read");
+        return nullptr;
+    } else {
+        return &file.GetPipe();
+    }
+}
+
+//! Whether a buffer is in user memory, where an access may cause a page fault.
+bool IsUsrMem(const void* const buf) noexcept {
+    return reinterpret_cast<stl::uintptr_t>(buf) < krnl_base;
+}
+
+//! Whether a user buffer does not extend into kernel memory.
+bool IsValidUsrMem(const void* const buf, const stl::size_t size) noexcept {
+    return size <= krnl_base - reinterpret_cast<stl::uintptr_t>(buf);
+}
+
+//! Whether any buffer is in user memory.
+bool HasUsrMem(const IoVec* const vecs, const stl::size_t count) noexcept {
+    for (stl::size_t i {0}; i != count; ++i) {
+        if (IsUsrMem(vecs[i].base)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! Get the number of buffers before the first user buffer extending into kernel memory.
+stl::size_t GetValidIoVecCount(const IoVec* const vecs, const stl::size_t count) noexcept {
+    for (stl::size_t i {0}; i != count; ++i) {
+        if (IsUsrMem(vecs[i].base) && !IsValidUsrMem(vecs[i].base, vecs[i].size)) {
+            return i;
+        }
+    }
+
+    return count;
+}
+
+//! A cursor copying data between a kernel buffer and buffers of a vectored file operation in order.
+class IoVecCursor {
+public:
+    explicit IoVecCursor(const IoVec* const vecs) noexcept : vecs_ {vecs} {}
+
+    //! Copy data from buffers at the cursor to a kernel buffer and advance the cursor.
+    IoVecCursor& Gather(stl::byte* const buf, const stl::size_t size) noexcept {
+        return Copy(size, [buf](stl::byte* const vec_buf, const stl::size_t offset,
+                                const stl::size_t len) noexcept {
+            stl::memcpy(buf + offset, vec_buf, len);
+        });
+    }
+
+    //! Copy data from a kernel buffer to buffers at the cursor and advance the cursor.
+    IoVecCursor& Scatter(const stl::byte* const buf, const stl::size_t size) noexcept {
+        return Copy(size, [buf](stl::byte* const vec_buf, const stl::size_t offset,
+                                const stl::size_t len) noexcept {
+            stl::memcpy(vec_buf, buf + offset, len);
+        });
+    }
+
+private:
+    template <typename CopyFunc>
+    IoVecCursor& Copy(const stl::size_t size, const CopyFunc copy) noexcept {
+        for (stl::size_t copied {0}; copied != size;) {
+            const auto& vec {vecs_[vec_idx_]};
+            const auto len {stl::min(vec.size - vec_offset_, size - copied)};
+            copy(static_cast<stl::byte*>(vec.base) + vec_offset_, copied, len);
+            copied += len;
+            vec_offset_ += len;
+            if (vec_offset_ == vec.size) {
+                ++vec_idx_;
+                vec_offset_ = 0;
+            }
+        }
+
+        return *this;
+    }
+
+    const IoVec* vecs_;
+
+    //! The index of the current buffer.
+    stl::size_t vec_idx_ {0};
+
+    //! The offset in the current buffer.
+    stl::size_t vec_offset_ {0};
+};
+
+}  // namespace
+
+stl::size_t ReadDiskFile(const FileDesc desc, void* const buf, const stl::size_t size) noexcept {
+    const IoVec vec {buf, size};
+    return ReadDiskFile(desc, &vec, 1);
+}
+
+stl::size_t WriteDiskFile(const FileDesc desc, const void* const data,
+                          const stl::size_t size) noexcept {
+    const IoVec vec {const_cast<void*>(data), size};
+    return WriteDiskFile(desc, &vec, 1);
+}
+
+stl::size_t ReadDiskFile(const FileDesc desc, const IoVec* const vecs,
+                         const stl::size_t count) noexcept {
+    if (!HasUsrMem(vecs, count)) {
+        return GetDefaultPart().ReadFile(desc, vecs, count);
+    }
+
+    const auto size {GetIoVecSize(vecs, GetValidIoVecCount(vecs, count))};
+    if (size == 0) {
+        return 0;
+    }
+
+    const auto io_buf {mem::AllocateUninit<stl::byte>(mem::PoolType::Kernel,
+                                                   stl::min(size, usr_io_buf_size))};
+    if (!io_buf) {
+        return 0;
+    }
+
+    // Each chunk is read in a single locked pass,
+    // and the file system is unlocked before it is scattered to user memory.
+    IoVecCursor cursor {vecs};
+    stl::size_t read {0};
+    while (read != size) {
+        const IoVec krnl_vec {io_buf, stl::min(size - read, usr_io_buf_size)};
+        const auto chunk_read {GetDefaultPart().ReadFile(desc, &krnl_vec, 1)};
+        cursor.Scatter(io_buf, chunk_read);
+        read += chunk_read;
+        if (chunk_read != krnl_vec.size) {
+            break;
+        }
+    }
+
+    mem::Free(mem::PoolType::Kernel, io_buf);
+    return read;
+}
+
+stl::size_t WriteDiskFile(const FileDesc desc, const IoVec* const vecs,
+                          const stl::size_t count) noexcept {
+    if (!HasUsrMem(vecs, count)) {
+        return GetDefaultPart().WriteFile(desc, vecs, count);
+    }
+
+    const auto size {GetIoVecSize(vecs, GetValidIoVecCount(vecs, count))};
+    if (size == 0) {
+        return 0;
+    }
+
+    const auto io_buf {mem::AllocateUninit<stl::byte>(mem::PoolType::Kernel,
+                                                   stl::min(size, usr_io_buf_size))};
+    if (!io_buf) {
+        return 0;
+    }
+
+    // Consecutive buffers are gathered into each chunk before the file system is locked,
+    // and then the chunk is written in a single locked pass.
+    IoVecCursor cursor {vecs};
+    stl::size_t written {0};
+    while (written != size) {
+        const IoVec krnl_vec {io_buf, stl::min(size - written, usr_io_buf_size)};
+        cursor.Gather(io_buf, krnl_vec.size);
+        const auto chunk_written {GetDefaultPart().WriteFile(desc, &krnl_vec, 1)};
+        written += chunk_written;
+        if (chunk_written != krnl_vec.size) {
+            break;
+        }
+    }
+
+    mem::Free(mem::PoolType::Kernel, io_buf);
+    return written;
+}
+
 void FileDesc::Close() noexcept {
     if (IsValid() && desc_ >= std_stream_count) {
         // Get the global file descriptor from the process file table.
         const auto global {tsk::ProcFileDescTab::GetGlobal(desc_)};
         auto& file_tab {fs::GetFileTab()};
         dbg::Assert(global < file_tab.GetSize());
-        // Close the file in the global file table.
-        file_tab[global].Close();
+        // Close the file and release the descriptor in the global file table.
+        file_tab.FreeDesc(global);
         tsk::ProcFileDescTab::Reset(desc_);
     }
 }
 
+stl::size_t GetIoVecSize(const IoVec* const vecs, const stl::size_t count) noexcept {
+    dbg::Assert(vecs || count == 0);
+    stl::size_t size {0};
+    for (stl::size_t i {0}; i != count; ++i) {
+        size += vecs[i].size;
+    }
+
+    return size;
+}
+
 File::File(const Path& path, const bit::Flags<OpenMode> flags) noexcept :
     desc_ {Open(path, flags)} {}
 
@@ -44,19 +247,84 @@ bool File::IsOpen() const noexcept {
 
 stl::size_t File::Write(const void* const data, const stl::size_t size) noexcept {
     dbg::Assert(IsOpen());
-    return GetDefaultPart().WriteFile(desc_, data, size);
+    if (GetGlobalFile(desc_).IsPipe()) {
+        const auto pipe {GetPipe(desc_, true)};
+        return pipe ? pipe->Write(data, size) : 0;
+    }
+
+    return WriteDiskFile(desc_, data, size);
 }
 
 stl::size_t File::Read(void* const buf, const stl::size_t size) noexcept {
     dbg::Assert(IsOpen());
-    return GetDefaultPart().ReadFile(desc_, buf, size);
+    if (GetGlobalFile(desc_).IsPipe()) {
+        const auto pipe {GetPipe(desc_, false)};
+        return pipe ? pipe->Read(buf, size) : 0;
+    }
+
+    return ReadDiskFile(desc_, buf, size);
+}
+
+stl::size_t File::WriteV(const IoVec* const vecs, const stl::size_t count) noexcept {
+    dbg::Assert(IsOpen());
+    if (GetGlobalFile(desc_).IsPipe()) {
+        const auto pipe {GetPipe(desc_, true)};
+        stl::size_t written {0};
+        for (stl::size_t i {0}; pipe && i != count; ++i) {
+            const auto size {pipe->Write(vecs[i].base, vecs[i].size)};
+            written += size;
+            if (size != vecs[i].size) {
+                // All read ends have been closed.
+                break;
+            }
+        }
+
+        return written;
+    }
+
+    return WriteDiskFile(desc_, vecs, count);
+}
+
+stl::size_t File::ReadV(const IoVec* const vecs, const stl::size_t count) noexcept {
+    dbg::Assert(IsOpen());
+    if (GetGlobalFile(desc_).IsPipe()) {
+        const auto pipe {GetPipe(desc_, false)};
+        stl::size_t read {0};
+        for (stl::size_t i {0}; pipe && i != count; ++i) {
+            // Only wait for the first buffer, so a read returns when some data is available.
+            const auto size {pipe->Read(vecs[i].base, vecs[i].size, i == 0)};
+            read += size;
+            if (size != vecs[i].size) {
+                break;
+            }
+        }
+
+        return read;
+    }
+
+    return ReadDiskFile(desc_, vecs, count);
 }
 
 stl::size_t File::Seek(const stl::int32_t offset, const SeekOrigin origin) noexcept {
     dbg::Assert(IsOpen());
+    if (GetGlobalFile(desc_).IsPipe()) {
+        io::PrintlnStr("A pipe cannot be seeked.");
+        return 0;
+    }
+
     return GetDefaultPart().SeekFile(desc_, offset, origin);
 }
 
+bool File::Reserve(const stl::size_t size) noexcept {
+    dbg::Assert(IsOpen());
+    if (GetGlobalFile(desc_).IsPipe()) {
+        io::PrintlnStr("A pipe cannot reserve blocks.");
+        return false;
+    }
+
+    return GetDefaultPart().ReserveFile(desc_, size);
+}
+
 bool File::Delete(const Path& path) noexcept {
     return GetDefaultPart().DeleteFile(path);
 }
@@ -65,26 +333,74 @@ FileDesc File::Open(const Path& path, const bit::Flags<OpenMode> flags) noexcept
     return GetDefaultPart().OpenFile(path, flags);
 }
 
+void File::Sync() noexcept {
+    GetDefaultPart().Sync();
+}
+
+FileSysStats File::GetSysStats() noexcept {
+    return GetDefaultPart().GetStats();
+}
+
 namespace sc {
 
-stl::size_t File::Open(const OpenArgs& args) noexcept {
-    return io::File::Open(Path {args.path}, args.flags);
+stl::size_t File::Open(const char* const path, const stl::uint32_t flags) noexcept {
+    return io::File::Open(Path {path}, flags);
 }
 
 bool File::Delete(const char* const path) noexcept {
     return io::File::Delete(path);
 }
 
-stl::size_t File::Write(const WriteArgs& args) noexcept {
-    return io::File {args.desc}.Write(args.data, args.size);
+void File::Sync() noexcept {
+    io::File::Sync();
+}
+
+void File::GetSysStats(FileSysStats* const stats) noexcept {
+    if (stats) {
+        *stats = io::File::GetSysStats();
+    }
+}
+
+stl::size_t File::Write(const stl::size_t desc, const void* const data,
+                        const stl::size_t size) noexcept {
+    return io::File {desc}.Write(data, size);
+}
+
+stl::size_t File::Read(const stl::size_t desc, void* const buf, const stl::size_t size) noexcept {
+    return io::File {desc}.Read(buf, size);
+}
+
+stl::size_t File::WriteV(const stl::size_t desc, const IoVec* const vecs,
+                         const stl::size_t count) noexcept {
+    if (!vecs || count == 0 || count > max_io_vec_count) {
+        return 0;
+    }
+
+    // The array is in user memory, which must not be accessed while the file system is locked.
+    IoVec krnl_vecs[max_io_vec_count];
+    stl::memcpy(krnl_vecs, vecs, count * sizeof(IoVec));
+    return io::File {desc}.WriteV(krnl_vecs, count);
+}
+
+stl::size_t File::ReadV(const stl::size_t desc, const IoVec* const vecs,
+                        const stl::size_t count) noexcept {
+    if (!vecs || count == 0 || count > max_io_vec_count) {
+        return 0;
+    }
+
+    // The array is in user memory, which must not be accessed while the file system is locked.
+    IoVec krnl_vecs[max_io_vec_count];
+    stl::memcpy(krnl_vecs, vecs, count * sizeof(IoVec));
+    return io::File {desc}.ReadV(krnl_vecs, count);
 }
 
-stl::size_t File::Read(const ReadArgs& args) noexcept {
-    return io::File {args.desc}.Read(args.buf, args.size);
+stl::size_t File::Seek(const stl::size_t desc, const stl::int32_t offset,
+                       const io::File::SeekOrigin origin) noexcept {
+    return io::File {desc}.Seek(offset, origin);
 }
 
-stl::size_t File::Seek(const SeekArgs& args) noexcept {
-    return io::File {args.desc}.Seek(args.offset, args.origin);
+bool File::Reserve(const stl::size_t desc, const stl::size_t size) noexcept {
+    return io::File {desc}.Reserve(size);
 }
 
 void File::Close(const stl::size_t desc) noexcept {
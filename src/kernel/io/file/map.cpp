@@ -0,0 +1,232 @@
+#include "kernel/io/file/map.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/disk/disk.h"
+#include "kernel/io/disk/file/file.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/process/proc.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/mutex.h"
+
+namespace io {
+
+namespace {
+
+//! A range of a file mapped into a process.
+struct Mapping {
+    bool IsUsed() const noexcept {
+        return proc != nullptr;
+    }
+
+    bool Contain(const stl::uintptr_t vr_addr) const noexcept {
+        return vr_base <= vr_addr && vr_addr < vr_base + page_count * mem::page_size;
+    }
+
+    //! The process, or @p nullptr if the mapping is free.
+    const tsk::Process* proc;
+    stl::uintptr_t vr_base;
+    stl::size_t page_count;
+    //! The offset of the first page in the file.
+    stl::size_t offset;
+    //! The descriptor of the mapping in the global file table.
+    FileDesc global;
+    bool writable;
+};
+
+/**
+ * @brief A wrapper of a global variable representing file mappings.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+stl::array<Mapping, FileMap::max_count>& GetMappings() noexcept {
+    static stl::array<Mapping, FileMap::max_count> mappings {};
+    return mappings;
+}
+
+stl::mutex& GetMappingLock() noexcept {
+    static stl::mutex lock;
+    return lock;
+}
+
+//! Find the mapping of the current process containing a virtual address.
+Mapping* FindMapping(const stl::uintptr_t vr_addr) noexcept {
+    const auto proc {tsk::Process::GetCurrent()};
+    for (auto& mapping : GetMappings()) {
+        if (mapping.proc == proc && mapping.Contain(vr_addr)) {
+            return &mapping;
+        }
+    }
+
+    return nullptr;
+}
+
+//! Write dirty pages of a mapping back to the file.
+void SyncMapping(const Mapping& mapping) noexcept {
+    if (!mapping.writable) {
+        return;
+    }
+
+    const auto& file {fs::GetFileTab()[mapping.global]};
+    for (stl::size_t i {0}; i != mapping.page_count; ++i) {
+        const auto page_base {mapping.vr_base + i * mem::page_size};
+        mem::VrAddr page {page_base};
+        // Pages that have never been accessed are not mapped.
+        if (!page.IsMapped() || !page.GetPageTabEntry().IsDirty()) {
+            continue;
+        }
+
+        // Clear the dirty bit before writing, so a concurrent write marks the page again.
+        page.GetPageTabEntry().SetDirty(false);
+        page.FlushTlb();
+        GetDefaultPart().WriteFileAt(file, mapping.offset + i * mem::page_size,
+                                     reinterpret_cast<const void*>(page_base), mem::page_size);
+    }
+}
+
+}  // namespace
+
+void* FileMap::Map(const FileDesc desc, const stl::size_t offset, const stl::size_t size,
+                   const bool writable) noexcept {
+    const auto proc {tsk::Process::GetCurrent()};
+    if (!proc || size == 0 || offset % mem::page_size != 0) {
+        return nullptr;
+    }
+
+    const auto global {tsk::ProcFileDescTab::GetGlobal(desc)};
+    if (const auto& file {fs::GetFileTab()[global]}; !file.IsOpen() || file.IsPipe()) {
+        io::PrintlnStr("Only files on the disk can be mapped.");
+        return nullptr;
+    } else if (writable && !file.flags.IsSet(File::OpenMode::WriteOnly)
+               && !file.flags.IsSet(File::OpenMode::ReadWrite)) {
+        io::PrintlnStr("The file is not open for writing.");
+        return nullptr;
+    }
+
+    const stl::lock_guard guard {GetMappingLock()};
+    Mapping* mapping {nullptr};
+    for (auto& free : GetMappings()) {
+        if (!free.IsUsed()) {
+            mapping = &free;
+            break;
+        }
+    }
+
+    if (!mapping) {
+        io::PrintlnStr("The file mapping table is full.");
+        return nullptr;
+    }
+
+    // Reserve virtual pages. They are loaded by the page fault handler.
+    const auto vr_base {mem::MapMem(0, size)};
+    if (!vr_base) {
+        return nullptr;
+    }
+
+    // The mapping is read-only for the file table, so it does not deny other writers.
+    const auto dup {fs::GetFileTab().DupDesc(global)};
+    if (!dup.IsValid()) {
+        mem::UnmapMem(vr_base, size);
+        return nullptr;
+    }
+
+    mapping->vr_base = reinterpret_cast<stl::uintptr_t>(vr_base);
+    mapping->page_count = mem::CalcPageCount(size);
+    mapping->offset = offset;
+    mapping->global = dup;
+    mapping->writable = writable;
+    mapping->proc = proc;
+    return vr_base;
+}
+
+bool FileMap::Unmap(void* const vr_base) noexcept {
+    const stl::lock_guard guard {GetMappingLock()};
+    const auto base {reinterpret_cast<stl::uintptr_t>(vr_base)};
+    const auto mapping {FindMapping(base)};
+    if (!mapping || mapping->vr_base != base) {
+        return false;
+    }
+
+    SyncMapping(*mapping);
+    mem::UnmapMem(vr_base, mapping->page_count * mem::page_size);
+    fs::GetFileTab().FreeDesc(mapping->global);
+    mapping->proc = nullptr;
+    return true;
+}
+
+void FileMap::UnmapAll() noexcept {
+    const stl::lock_guard guard {GetMappingLock()};
+    const auto proc {tsk::Process::GetCurrent()};
+    dbg::Assert(proc);
+    for (auto& mapping : GetMappings()) {
+        if (mapping.proc == proc) {
+            SyncMapping(mapping);
+            mem::UnmapMem(reinterpret_cast<void*>(mapping.vr_base),
+                          mapping.page_count * mem::page_size);
+            fs::GetFileTab().FreeDesc(mapping.global);
+            mapping.proc = nullptr;
+        }
+    }
+}
+
+bool FileMap::Sync(void* const vr_base) noexcept {
+    const stl::lock_guard guard {GetMappingLock()};
+    const auto base {reinterpret_cast<stl::uintptr_t>(vr_base)};
+    const auto mapping {FindMapping(base)};
+    if (!mapping || mapping->vr_base != base) {
+        return false;
+    }
+
+    SyncMapping(*mapping);
+    return true;
+}
+
+bool FileMap::LoadPage(const stl::uintptr_t vr_addr) noexcept {
+    // Kernel threads have no mappings, and page faults may occur before threads are initialized.
+    if (!tsk::Thread::GetCurrent().GetProcess()) {
+        return false;
+    }
+
+    const stl::lock_guard guard {GetMappingLock()};
+    const auto mapping {FindMapping(vr_addr)};
+    if (!mapping) {
+        return false;
+    }
+
+    // Map a zeroed physical page, so bytes beyond the end of the file are zeros.
+    const auto page_base {mem::AlignToPageBase(vr_addr)};
+    if (!mem::MapPageOnDemand(page_base)) {
+        return false;
+    }
+
+    GetDefaultPart().ReadFileAt(fs::GetFileTab()[mapping->global],
+                                mapping->offset + (page_base - mapping->vr_base),
+                                reinterpret_cast<void*>(page_base), mem::page_size);
+
+    // Writing the file data has marked the page as dirty.
+    mem::VrAddr page {page_base};
+    page.GetPageTabEntry().SetDirty(false).SetWritable(mapping->writable);
+    page.FlushTlb();
+    return true;
+}
+
+namespace sc {
+
+void* FileMap::Map(const stl::size_t desc, const stl::size_t offset, const stl::size_t size,
+                   const bool writable) noexcept {
+    return io::FileMap::Map(desc, offset, size, writable);
+}
+
+bool FileMap::Unmap(void* const vr_base) noexcept {
+    return io::FileMap::Unmap(vr_base);
+}
+
+bool FileMap::Sync(void* const vr_base) noexcept {
+    return io::FileMap::Sync(vr_base);
+}
+
+}  // namespace sc
+
+}  // namespace io
@@ -0,0 +1,162 @@
+#include "kernel/io/file/pipe.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/disk/file/file.h"
+#include "kernel/memory/pool.h"
+#include "kernel/thread/thd.h"
+
+namespace io {
+
+bool Pipe::Create(FileDesc& read_end, FileDesc& write_end) noexcept {
+    // A pipe is shared by processes, so it must be in kernel memory.
+    const auto pipe {mem::Allocate<Pipe>(mem::PoolType::Kernel, sizeof(Pipe))};
+    if (!pipe) {
+        return false;
+    }
+
+    pipe->Init();
+    auto& tab {fs::GetFileTab()};
+    const auto read_global {tab.AllocDesc()};
+    const auto write_global {tab.AllocDesc()};
+    if (!read_global.IsValid() || !write_global.IsValid()) {
+        if (read_global.IsValid()) {
+            tab.FreeDesc(read_global);
+        }
+
+        if (write_global.IsValid()) {
+            tab.FreeDesc(write_global);
+        }
+
+        mem::Free(mem::PoolType::Kernel, pipe);
+        return false;
+    }
+
+    tab[read_global].Clear();
+    tab[read_global].pipe = pipe;
+    tab[read_global].flags = File::OpenMode::ReadOnly;
+    tab[write_global].Clear();
+    tab[write_global].pipe = pipe;
+    tab[write_global].flags = File::OpenMode::WriteOnly;
+
+    read_end = tsk::ProcFileDescTab::SyncGlobal(read_global);
+    write_end = tsk::ProcFileDescTab::SyncGlobal(write_global);
+    if (!read_end.IsValid() || !write_end.IsValid()) {
+        if (read_end.IsValid()) {
+            tsk::ProcFileDescTab::Reset(read_end);
+            read_end.Reset();
+        }
+
+        if (write_end.IsValid()) {
+            tsk::ProcFileDescTab::Reset(write_end);
+            write_end.Reset();
+        }
+
+        // Closing both ends frees the pipe.
+        tab.FreeDesc(read_global);
+        tab.FreeDesc(write_global);
+        return false;
+    }
+
+    return true;
+}
+
+Pipe& Pipe::Init() noexcept {
+    buf_.Init();
+    reader_count_ = 1;
+    writer_count_ = 1;
+    active_count_ = 0;
+    return *this;
+}
+
+stl::size_t Pipe::Write(const void* const data, const stl::size_t size) noexcept {
+    dbg::Assert(data || size == 0);
+    stl::size_t written {0};
+    bool unused {false};
+    {
+        const intr::IntrGuard guard;
+        ++active_count_;
+        written = buf_.PushN(static_cast<const stl::byte*>(data), size);
+        --active_count_;
+        unused = IsUnused();
+    }
+
+    if (unused) {
+        // Both ends were closed while the thread was waiting.
+        mem::Free(mem::PoolType::Kernel, this);
+    }
+
+    return written;
+}
+
+stl::size_t Pipe::Read(void* const buf, const stl::size_t size, const bool wait) noexcept {
+    dbg::Assert(buf || size == 0);
+    stl::size_t read {0};
+    bool unused {false};
+    {
+        const intr::IntrGuard guard;
+        ++active_count_;
+        read = buf_.PopSome(static_cast<stl::byte*>(buf), size, wait);
+        --active_count_;
+        unused = IsUnused();
+    }
+
+    if (unused) {
+        // Both ends were closed while the thread was waiting.
+        mem::Free(mem::PoolType::Kernel, this);
+    }
+
+    return read;
+}
+
+bool Pipe::IsUnused() const noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    return reader_count_ == 0 && writer_count_ == 0 && active_count_ == 0;
+}
+
+Pipe& Pipe::Open(const bool write_end) noexcept {
+    const intr::IntrGuard guard;
+    auto& count {write_end ? writer_count_ : reader_count_};
+    dbg::Assert(count > 0);
+    ++count;
+    return *this;
+}
+
+void Pipe::Close(const bool write_end) noexcept {
+    bool unused {false};
+    {
+        const intr::IntrGuard guard;
+        auto& count {write_end ? writer_count_ : reader_count_};
+        dbg::Assert(count > 0);
+        if (--count == 0) {
+            // Wake up threads waiting at the other end.
+            buf_.Close();
+        }
+
+        // Threads still reading or writing free the pipe when they return.
+        unused = IsUnused();
+    }
+
+    if (unused) {
+        mem::Free(mem::PoolType::Kernel, this);
+    }
+}
+
+namespace sc {
+
+bool Pipe::Create(stl::size_t* const descs) noexcept {
+    if (!descs) {
+        return false;
+    }
+
+    FileDesc read_end, write_end;
+    if (!io::Pipe::Create(read_end, write_end)) {
+        return false;
+    }
+
+    descs[0] = read_end;
+    descs[1] = write_end;
+    return true;
+}
+
+}  // namespace sc
+
+}  // namespace io
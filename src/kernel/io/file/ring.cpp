@@ -0,0 +1,265 @@
+#include "kernel/io/file/ring.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/disk/disk.h"
+#include "kernel/io/disk/file/file.h"
+#include "kernel/process/proc.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/mutex.h"
+#include "kernel/thread/sync.h"
+#include "kernel/util/metric.h"
+
+namespace io {
+
+namespace {
+
+//! The kernel state of a process's rings.
+struct Ring {
+    bool IsUsed() const noexcept {
+        return shared != nullptr;
+    }
+
+    /**
+     * @brief Get the number of submissions that have not been run.
+     *
+     * @details
+     * The head is written by the process, so a count larger than the ring is treated as no submission.
+     */
+    stl::size_t GetSubmitCount() const noexcept {
+        const auto count {__atomic_load_n(&shared->submit_head, __ATOMIC_ACQUIRE) - submit_tail};
+        return count <= IoRing::entry_count ? count : 0;
+    }
+
+    /**
+     * @brief Get the number of completions that have not been consumed by the process.
+     *
+     * @details
+     * The tail is written by the process, so a count larger than the ring is treated as a full ring.
+     */
+    stl::size_t GetCompleteCount() const noexcept {
+        const auto count {complete_head - __atomic_load_n(&shared->complete_tail, __ATOMIC_ACQUIRE)};
+        return count <= IoRing::entry_count ? count : IoRing::entry_count;
+    }
+
+    //! Whether the counters written by the process are consistent with those of the kernel.
+    bool IsValid() const noexcept {
+        return __atomic_load_n(&shared->submit_head, __ATOMIC_ACQUIRE) - submit_tail
+                   <= IoRing::entry_count
+               && complete_head - __atomic_load_n(&shared->complete_tail, __ATOMIC_ACQUIRE)
+                      <= IoRing::entry_count;
+    }
+
+    //! Whether the worker thread can run a submission.
+    bool IsRunnable() const noexcept {
+        return GetSubmitCount() > 0 && GetCompleteCount() < IoRing::entry_count;
+    }
+
+    //! The process owning the rings.
+    stl::size_t pid;
+    IoRing::Shared* shared;
+    /**
+     * @brief The tail of the submission ring and the head of the completion ring.
+     *
+     * @details
+     * They are only written by the kernel, and copied to the shared rings.
+     * The copies in user memory can be modified by the process, so they are never read back.
+     */
+    stl::size_t submit_tail;
+    stl::size_t complete_head;
+    //! The worker thread waiting for submissions.
+    sync::WaitQueue worker;
+    tsk::Thread* worker_thd;
+    //! Whether the process is exiting and the worker thread should stop.
+    bool stopping;
+    //! Threads waiting for completions.
+    sync::WaitQueue waiters;
+};
+
+/**
+ * @brief A wrapper of a global variable representing kernel states of rings.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+stl::array<Ring, IoRing::max_count>& GetRings() noexcept {
+    static stl::array<Ring, IoRing::max_count> rings {};
+    return rings;
+}
+
+stl::mutex& GetRingLock() noexcept {
+    static stl::mutex lock;
+    return lock;
+}
+
+Ring* FindRing(const stl::size_t pid) noexcept {
+    for (auto& ring : GetRings()) {
+        if (ring.IsUsed() && ring.pid == pid) {
+            return &ring;
+        }
+    }
+
+    return nullptr;
+}
+
+//! Run a file operation in the worker thread.
+stl::size_t Run(const IoRing::Submission& submit) noexcept {
+    // Pipes may block the worker thread forever, so only files on the disk are supported.
+    if (fs::GetFileTab()[tsk::ProcFileDescTab::GetGlobal(submit.desc)].IsPipe()) {
+        return npos;
+    }
+
+    switch (static_cast<IoRing::Op>(submit.op)) {
+        case IoRing::Op::Read: {
+            return ReadDiskFile(submit.desc, submit.buf, submit.size);
+        }
+        case IoRing::Op::Write: {
+            return WriteDiskFile(submit.desc, submit.buf, submit.size);
+        }
+        default: {
+            return npos;
+        }
+    }
+}
+
+/**
+ * @brief The worker thread of a process's rings.
+ *
+ * @details
+ * It runs submissions in order and posts a completion for each one.
+ * If the completion ring is full, it waits until the process consumes completions and enters the kernel again.
+ */
+void Work(void* const arg) noexcept {
+    dbg::Assert(arg);
+    auto& ring {*static_cast<Ring*>(arg)};
+    auto& shared {*ring.shared};
+    while (true) {
+        {
+            const intr::IntrGuard guard;
+            while (!ring.IsRunnable() && !ring.stopping) {
+                ring.worker.Wait();
+            }
+
+            // Remaining submissions are discarded when the process exits.
+            if (ring.stopping) {
+                return;
+            }
+        }
+
+        // Copy the submission since the process can modify the ring at any time.
+        const auto submit {shared.submits[ring.submit_tail % IoRing::entry_count]};
+        __atomic_store_n(&shared.submit_tail, ++ring.submit_tail, __ATOMIC_RELEASE);
+
+        const auto result {Run(submit)};
+        shared.completes[ring.complete_head % IoRing::entry_count] = {submit.user_data, result};
+        // Publish the completion after writing it.
+        __atomic_store_n(&shared.complete_head, ++ring.complete_head, __ATOMIC_RELEASE);
+
+        const intr::IntrGuard guard;
+        ring.waiters.WakeAll();
+    }
+}
+
+}  // namespace
+
+bool IoRing::Setup(Shared& shared) noexcept {
+    const auto proc {tsk::Process::GetCurrent()};
+    if (!proc) {
+        return false;
+    }
+
+    const stl::lock_guard guard {GetRingLock()};
+    if (FindRing(proc->GetPid())) {
+        return false;
+    }
+
+    for (auto& ring : GetRings()) {
+        if (!ring.IsUsed()) {
+            shared.submit_head = 0;
+            shared.submit_tail = 0;
+            shared.complete_head = 0;
+            shared.complete_tail = 0;
+            ring.pid = proc->GetPid();
+            ring.shared = &shared;
+            ring.submit_tail = 0;
+            ring.complete_head = 0;
+            ring.stopping = false;
+            // The worker thread is joined when the process exits.
+            ring.worker_thd =
+                &tsk::Thread::Create("io ring", tsk::Process::default_priority, &Work, &ring, proc);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+stl::size_t IoRing::Enter(const stl::size_t min_complete) noexcept {
+    Ring* ring {nullptr};
+    {
+        const stl::lock_guard guard {GetRingLock()};
+        ring = FindRing(tsk::Process::GetCurrPid());
+    }
+
+    if (!ring) {
+        return npos;
+    }
+
+    const intr::IntrGuard guard;
+    // The process has written counters beyond the ring.
+    if (!ring->IsValid()) {
+        return npos;
+    }
+
+    // Do not wait for more completions than queued operations.
+    const auto wait_count {
+        stl::min(min_complete, ring->GetCompleteCount() + ring->GetSubmitCount())};
+    ring->worker.WakeOne();
+    while (ring->GetCompleteCount() < wait_count) {
+        ring->waiters.Wait();
+    }
+
+    return ring->GetCompleteCount();
+}
+
+void IoRing::Release() noexcept {
+    Ring* ring {nullptr};
+    {
+        const stl::lock_guard guard {GetRingLock()};
+        ring = FindRing(tsk::Process::GetCurrPid());
+    }
+
+    if (!ring) {
+        return;
+    }
+
+    {
+        const intr::IntrGuard guard;
+        ring->stopping = true;
+        ring->worker.WakeOne();
+    }
+
+    // The worker thread may be running a submission, which accesses the process memory.
+    ring->worker_thd->Join();
+    const stl::lock_guard guard {GetRingLock()};
+    ring->shared = nullptr;
+}
+
+namespace sc {
+
+bool IoRing::Setup(void* const shared) noexcept {
+    if (!shared) {
+        return false;
+    }
+
+    return io::IoRing::Setup(*static_cast<io::IoRing::Shared*>(shared));
+}
+
+stl::size_t IoRing::Enter(const stl::size_t min_complete) noexcept {
+    return io::IoRing::Enter(min_complete);
+}
+
+}  // namespace sc
+
+}  // namespace io
@@ -21,6 +21,24 @@ SetCr3:
         ret
     %pop
 
+global      ReadTsc
+; Read the time-stamp counter into `EDX:EAX`.
+ReadTsc:
+    rdtsc
+    ret
+
+global      WriteMsr
+; Write a value to a model-specific register.
+; ```c++
+; void WriteMsr(std::uint32_t msr, std::uint64_t val) noexcept;
+; ```
+WriteMsr:
+    mov     ecx, [esp + B(4)]
+    mov     eax, [esp + B(8)]
+    mov     edx, [esp + B(12)]
+    wrmsr
+    ret
+
 global      GetEFlags
 ; Get the value of `EFLAGS`.
 GetEFlags:
@@ -75,6 +93,20 @@ WriteWordsToPort:
         ret
     %pop
 
+global      WriteDoubleWordToPort
+; Write a double word to a port.
+WriteDoubleWordToPort:
+    %push   write_double_word_to_port
+    %stacksize  flat
+    %arg    port:word, val:dword
+        enter   B(0), 0
+        mov     dx, [port]
+        mov     eax, [val]
+        out     dx, eax
+        leave
+        ret
+    %pop
+
 global      ReadByteFromPort
 ; Read a byte from a port.
 ReadByteFromPort:
@@ -88,6 +120,19 @@ ReadByteFromPort:
         ret
     %pop
 
+global      ReadDoubleWordFromPort
+; Read a double word from a port.
+ReadDoubleWordFromPort:
+    %push   read_double_word_from_port
+    %stacksize  flat
+    %arg    port:word
+        enter   B(0), 0
+        mov     dx, [port]
+        in      eax, dx
+        leave
+        ret
+    %pop
+
 global      ReadWordsFromPort
 ; Read a number of words from a port.
 ReadWordsFromPort:
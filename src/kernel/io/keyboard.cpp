@@ -1,7 +1,9 @@
 #include "kernel/io/keyboard.h"
 #include "kernel/debug/assert.h"
 #include "kernel/interrupt/intr.h"
+#include "kernel/interrupt/work.h"
 #include "kernel/io/io.h"
+#include "kernel/io/line_disc.h"
 #include "kernel/io/video/print.h"
 
 namespace io {
@@ -84,9 +86,9 @@ private:
 
 class KeyHandler {
 public:
-    KeyHandler(KeyboardBuffer& buf) noexcept : buf_ {buf} {}
+    KeyHandler(LineDiscipline& input) noexcept : input_ {input} {}
 
-    //! Process a scan code and push a character into the keyboard buffer.
+    //! Process a scan code and pass a character to the line discipline.
     void Enter(const stl::uint8_t scan_code) noexcept {
         if (scan_code == sc::ext_leader) {
             // Wait for the next byte if the scan code contains multiple bytes.
@@ -114,9 +116,8 @@ public:
             // Find the character according to the make code and shift status.
             const auto ch {
                 key_map[bit::GetLowByte(make_code)][static_cast<stl::size_t>(is_shift_enabled)]};
-            if (ch != '\0' && !buf_.IsFull()) {
-                // Push the character into the keyboard buffer.
-                buf_.Push(ch);
+            if (ch != '\0') {
+                input_.Receive(ch);
             }
         } else {
             io::PrintlnStr("The input key is unsupported.");
@@ -246,28 +247,30 @@ private:
     //! Whether the current scan code contains multiple bytes.
     bool is_ext_scan_code_ {false};
 
-    KeyboardBuffer& buf_;
+    LineDiscipline& input_;
 };
 
+//! Process a scan code in the worker thread.
+void ProcessScanCode(void* const arg) noexcept {
+    static KeyHandler handler {GetConsoleInput()};
+    handler.Enter(static_cast<stl::uint8_t>(reinterpret_cast<stl::uintptr_t>(arg)));
+}
+
 /**
  * @brief The keyboard interrupt handler.
  *
  * @details
- * It reads pressed keys and processes them.
+ * It reads a scan code and defers processing it to the worker thread.
+ * If the work queue is full, the key is dropped.
  */
 void KeyboardIntrHandler(stl::size_t) noexcept {
-    static KeyHandler handler {GetKeyboardBuffer()};
     const auto scan_code {io::ReadByteFromPort(port::data)};
-    handler.Enter(scan_code);
+    intr::ScheduleWork(&ProcessScanCode,
+                       reinterpret_cast<void*>(static_cast<stl::uintptr_t>(scan_code)));
 }
 
 }  // namespace
 
-KeyboardBuffer& GetKeyboardBuffer() noexcept {
-    static KeyboardBuffer buf;
-    return buf;
-}
-
 void InitKeyboard() noexcept {
     intr::GetIntrHandlerTab().Register(intr::Intr::Keyboard, &KeyboardIntrHandler);
     io::PrintStr("The keyboard has been initialized.\n");
@@ -0,0 +1,89 @@
+#include "kernel/io/line_disc.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/video/print.h"
+
+namespace io {
+
+LineDiscipline& GetConsoleInput() noexcept {
+    static LineDiscipline input;
+    return input;
+}
+
+void LineDiscipline::Receive(const char ch) noexcept {
+    if (!IsCanonical()) {
+        // A line edited before switching to the raw mode is delivered first.
+        CommitLine();
+        input_.TryPush(ch);
+    } else {
+        Edit(ch);
+    }
+}
+
+void LineDiscipline::Edit(const char ch) noexcept {
+    // Characters are echoed without locking the console, so the worker thread is never blocked.
+    switch (ch) {
+        case '\b': {
+            if (line_len_ != 0) {
+                --line_len_;
+                PrintChar(ch);
+            }
+
+            break;
+        }
+        case '\r':
+        case '\n': {
+            // The line feed always fits, since other characters leave space for it.
+            line_[line_len_++] = '\n';
+            PrintChar('\n');
+            CommitLine();
+            break;
+        }
+        default: {
+            if (line_len_ + 1 != line_.size()) {
+                line_[line_len_++] = ch;
+                PrintChar(ch);
+            }
+
+            break;
+        }
+    }
+}
+
+void LineDiscipline::CommitLine() noexcept {
+    // The line is pushed by one move of the head, so a reader never sees a part of it.
+    // It is dropped if the input ring does not have enough space.
+    input_.TryPushN(line_.data(), line_len_);
+    line_len_ = 0;
+}
+
+stl::size_t LineDiscipline::Read(char* const buf, const stl::size_t size) noexcept {
+    dbg::Assert(buf || size == 0);
+    if (size == 0) {
+        return 0;
+    }
+
+    const stl::lock_guard guard {read_mtx_};
+    buf[0] = input_.Pop();
+    if (!IsCanonical()) {
+        return 1 + input_.TryPopN(buf + 1, size - 1);
+    }
+
+    // Stop at the end of the line, or when an unfinished line from the raw mode runs out.
+    stl::size_t count {1};
+    while (buf[count - 1] != '\n' && count != size && input_.TryPop(buf[count])) {
+        ++count;
+    }
+
+    return count;
+}
+
+LineDiscipline& LineDiscipline::SetCanonical(const bool canonical) noexcept {
+    __atomic_store_n(&canonical_, canonical, __ATOMIC_RELAXED);
+    return *this;
+}
+
+bool LineDiscipline::IsCanonical() const noexcept {
+    return __atomic_load_n(&canonical_, __ATOMIC_RELAXED);
+}
+
+}  // namespace io
@@ -0,0 +1,136 @@
+#include "kernel/io/pci.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/io.h"
+#include "kernel/util/bit.h"
+
+namespace io {
+
+namespace {
+
+//! Configuration registers.
+namespace port {
+//! The address register.
+inline constexpr stl::uint16_t addr {0xCF8};
+//! The data register.
+inline constexpr stl::uint16_t data {0xCFC};
+}  // namespace port
+
+//! Offsets in the configuration space.
+namespace offset {
+inline constexpr stl::size_t id {0x00};
+inline constexpr stl::size_t cmd {0x04};
+inline constexpr stl::size_t class_code {0x08};
+inline constexpr stl::size_t header_type {0x0C};
+inline constexpr stl::size_t bar {0x10};
+}  // namespace offset
+
+//! The vendor ID returned by a nonexistent device.
+inline constexpr stl::uint16_t invalid_vendor_id {0xFFFF};
+
+}  // namespace
+
+PciDevice PciDevice::Find(const stl::uint8_t class_code, const stl::uint8_t subclass) noexcept {
+    for (stl::size_t bus {0}; bus != max_bus_count; ++bus) {
+        for (stl::size_t device {0}; device != max_device_count; ++device) {
+            for (stl::size_t func {0}; func != max_func_count; ++func) {
+                const PciDevice pci {bus, device, func};
+                if (pci.GetVendorId() == invalid_vendor_id) {
+                    if (func == 0) {
+                        break;
+                    } else {
+                        continue;
+                    }
+                }
+
+                if (pci.GetClassCode() == class_code && pci.GetSubclass() == subclass) {
+                    return pci;
+                }
+
+                // Other functions exist only in multi-function devices.
+                if (func == 0 && !pci.IsMultiFunc()) {
+                    break;
+                }
+            }
+        }
+    }
+
+    return {};
+}
+
+PciDevice::PciDevice(const stl::size_t bus, const stl::size_t device,
+                     const stl::size_t func) noexcept :
+    valid_ {true},
+    bus_ {static_cast<stl::uint8_t>(bus)},
+    device_ {static_cast<stl::uint8_t>(device)},
+    func_ {static_cast<stl::uint8_t>(func)} {
+    dbg::Assert(bus < max_bus_count && device < max_device_count && func < max_func_count);
+}
+
+bool PciDevice::IsValid() const noexcept {
+    return valid_;
+}
+
+stl::uint16_t PciDevice::GetVendorId() const noexcept {
+    return bit::GetLowWord(Read(offset::id));
+}
+
+stl::uint8_t PciDevice::GetClassCode() const noexcept {
+    return bit::GetHighByte(bit::GetHighWord(Read(offset::class_code)));
+}
+
+stl::uint8_t PciDevice::GetSubclass() const noexcept {
+    return bit::GetLowByte(bit::GetHighWord(Read(offset::class_code)));
+}
+
+stl::uint8_t PciDevice::GetProgIntf() const noexcept {
+    return bit::GetHighByte(bit::GetLowWord(Read(offset::class_code)));
+}
+
+bool PciDevice::IsMultiFunc() const noexcept {
+    constexpr stl::size_t multi_func_pos {7};
+    const auto header_type {bit::GetLowByte(bit::GetHighWord(Read(offset::header_type)))};
+    return bit::IsBitSet(header_type, multi_func_pos);
+}
+
+stl::uint32_t PciDevice::GetBar(const stl::size_t idx) const noexcept {
+    dbg::Assert(idx < bar_count);
+    return Read(offset::bar + idx * sizeof(stl::uint32_t));
+}
+
+const PciDevice& PciDevice::EnableBusMaster() const noexcept {
+    constexpr stl::size_t io_space_pos {0};
+    constexpr stl::size_t bus_master_pos {2};
+    // The high word is the status register, whose bits are cleared by writing ones.
+    stl::uint32_t cmd {bit::GetLowWord(Read(offset::cmd))};
+    bit::SetBit(cmd, io_space_pos);
+    bit::SetBit(cmd, bus_master_pos);
+    return Write(offset::cmd, cmd);
+}
+
+stl::uint32_t PciDevice::Read(const stl::size_t offset) const noexcept {
+    WriteDoubleWordToPort(port::addr, GetAddr(offset));
+    return ReadDoubleWordFromPort(port::data);
+}
+
+const PciDevice& PciDevice::Write(const stl::size_t offset,
+                                  const stl::uint32_t val) const noexcept {
+    WriteDoubleWordToPort(port::addr, GetAddr(offset));
+    WriteDoubleWordToPort(port::data, val);
+    return *this;
+}
+
+stl::uint32_t PciDevice::GetAddr(const stl::size_t offset) const noexcept {
+    dbg::Assert(valid_);
+    dbg::Assert(offset % sizeof(stl::uint32_t) == 0);
+    constexpr stl::size_t enable_pos {31};
+    constexpr stl::size_t bus_pos {16};
+    constexpr stl::size_t device_pos {11};
+    constexpr stl::size_t func_pos {8};
+    stl::uint32_t addr {(static_cast<stl::uint32_t>(bus_) << bus_pos)
+                        | (static_cast<stl::uint32_t>(device_) << device_pos)
+                        | (static_cast<stl::uint32_t>(func_) << func_pos) | offset};
+    bit::SetBit(addr, enable_pos);
+    return addr;
+}
+
+}  // namespace io
@@ -0,0 +1,264 @@
+#include "kernel/io/serial.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/io.h"
+#include "kernel/io/video/print.h"
+#include "kernel/util/bit.h"
+#include "kernel/util/format.h"
+
+namespace io {
+
+namespace {
+
+//! *NS16550A* registers, as offsets from the base port.
+namespace reg {
+//! The transmitter holding register and the receiver buffer register.
+inline constexpr stl::uint16_t data {0};
+//! The interrupt enable register.
+inline constexpr stl::uint16_t ier {1};
+//! The interrupt identification register when reading, and the FIFO control register when writing.
+inline constexpr stl::uint16_t iir {2};
+inline constexpr stl::uint16_t fcr {2};
+//! The line control register.
+inline constexpr stl::uint16_t lcr {3};
+//! The modem control register.
+inline constexpr stl::uint16_t mcr {4};
+//! The line status register.
+inline constexpr stl::uint16_t lsr {5};
+//! The modem status register.
+inline constexpr stl::uint16_t msr {6};
+//! The low byte of the divisor latch when @p DLAB is set.
+inline constexpr stl::uint16_t dll {0};
+//! The high byte of the divisor latch when @p DLAB is set.
+inline constexpr stl::uint16_t dlm {1};
+}  // namespace reg
+
+//! The frequency of the baud rate generator divided by @p 16.
+inline constexpr stl::size_t max_baud_rate {115200};
+
+//! Interrupt enable bits.
+namespace ier {
+inline constexpr stl::uint8_t tx_empty {1 << 1};
+}  // namespace ier
+
+//! Line control bits.
+namespace lcr {
+//! Eight data bits, no parity and one stop bit.
+inline constexpr stl::uint8_t data_8n1 {0b0000'0011};
+//! The divisor latch access bit.
+inline constexpr stl::uint8_t dlab {1 << 7};
+}  // namespace lcr
+
+//! FIFO control bits.
+namespace fcr {
+inline constexpr stl::uint8_t enabled {1 << 0};
+inline constexpr stl::uint8_t clear_rx {1 << 1};
+inline constexpr stl::uint8_t clear_tx {1 << 2};
+}  // namespace fcr
+
+//! Modem control bits.
+namespace mcr {
+inline constexpr stl::uint8_t dtr {1 << 0};
+inline constexpr stl::uint8_t rts {1 << 1};
+//! The output connecting the interrupt line of the port to the interrupt controller on PCs.
+inline constexpr stl::uint8_t out2 {1 << 3};
+inline constexpr stl::uint8_t loopback {1 << 4};
+}  // namespace mcr
+
+//! Line status bits.
+namespace lsr {
+inline constexpr stl::uint8_t data_ready {1 << 0};
+//! The transmitter holding register or the transmit FIFO is empty.
+inline constexpr stl::uint8_t tx_empty {1 << 5};
+}  // namespace lsr
+
+//! Interrupt identification values.
+namespace iir {
+//! The bit set when no interrupt is pending.
+inline constexpr stl::uint8_t none {1 << 0};
+//! The position and length of the interrupt identification.
+inline constexpr stl::size_t id_pos {1};
+inline constexpr stl::size_t id_len {3};
+//! The values of the interrupt identification.
+inline constexpr stl::uint8_t modem_status {0b000};
+inline constexpr stl::uint8_t tx_empty {0b001};
+//! Both bits are set if FIFOs are enabled on *NS16550A*.
+inline constexpr stl::uint8_t fifo_enabled {0b1100'0000};
+}  // namespace iir
+
+//! The size of the transmit FIFO of *NS16550A*. Older chips only have a holding register.
+inline constexpr stl::size_t fifo_size {16};
+
+//! A byte written and read back in the loopback mode to detect a port.
+inline constexpr stl::uint8_t loopback_test_byte {0xAE};
+
+/**
+ * @brief The interrupt handler of @p COM1.
+ *
+ * @details
+ * It refills the transmit FIFO. Received characters are not supported and discarded.
+ */
+void SerialIntrHandler(stl::size_t) noexcept {
+    auto& port {GetSerialPort()};
+    const auto base {SerialPort::com1_base};
+    while (true) {
+        const auto iir {ReadByteFromPort(base + reg::iir)};
+        if ((iir & iir::none) != 0) {
+            break;
+        }
+
+        switch (bit::GetBits(iir, iir::id_pos, iir::id_len)) {
+            case iir::tx_empty: {
+                port.OnTxEmpty();
+                break;
+            }
+            case iir::modem_status: {
+                ReadByteFromPort(base + reg::msr);
+                break;
+            }
+            default: {
+                // Reading the line status and received characters clears other interrupts.
+                while ((ReadByteFromPort(base + reg::lsr) & lsr::data_ready) != 0) {
+                    ReadByteFromPort(base + reg::data);
+                }
+
+                break;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+SerialPort& GetSerialPort() noexcept {
+    static SerialPort port {SerialPort::com1_base};
+    return port;
+}
+
+bool SerialPort::Init() noexcept {
+    static_assert(max_baud_rate % baud_rate == 0);
+    constexpr auto divisor {static_cast<stl::uint16_t>(max_baud_rate / baud_rate)};
+    WriteByteToPort(base_ + reg::ier, 0);
+    WriteByteToPort(base_ + reg::lcr, lcr::dlab);
+    WriteByteToPort(base_ + reg::dll, bit::GetLowByte(divisor));
+    WriteByteToPort(base_ + reg::dlm, bit::GetHighByte(divisor));
+    WriteByteToPort(base_ + reg::lcr, lcr::data_8n1);
+    WriteByteToPort(base_ + reg::fcr, fcr::enabled | fcr::clear_rx | fcr::clear_tx);
+
+    // A character sent in the loopback mode is received by the port itself.
+    WriteByteToPort(base_ + reg::mcr, mcr::loopback | mcr::dtr | mcr::rts);
+    WriteByteToPort(base_ + reg::data, loopback_test_byte);
+    if (ReadByteFromPort(base_ + reg::data) != loopback_test_byte) {
+        fifo_size_ = 0;
+        return false;
+    }
+
+    WriteByteToPort(base_ + reg::mcr, mcr::dtr | mcr::rts | mcr::out2);
+    fifo_size_ =
+        (ReadByteFromPort(base_ + reg::iir) & iir::fifo_enabled) == iir::fifo_enabled ? fifo_size
+                                                                                      : 1;
+    WriteByteToPort(base_ + reg::ier, ier::tx_empty);
+    return true;
+}
+
+bool SerialPort::IsPresent() const noexcept {
+    return fifo_size_ != 0;
+}
+
+void SerialPort::Push(const char ch) noexcept {
+    if (head_ - tail_ == tx_queue_size) {
+        ++dropped_count_;
+    } else {
+        tx_queue_[head_++ % tx_queue_size] = ch;
+    }
+}
+
+SerialPort& SerialPort::PutChar(const char ch) noexcept {
+    if (!IsPresent()) {
+        return *this;
+    }
+
+    if (ch == '\n') {
+        Push('\r');
+    }
+
+    Push(ch);
+    return *this;
+}
+
+SerialPort& SerialPort::PutStr(const stl::string_view str) noexcept {
+    for (const auto ch : str) {
+        PutChar(ch);
+    }
+
+    return *this;
+}
+
+SerialPort& SerialPort::PutHex(const stl::uint32_t num) noexcept {
+    char digits[sizeof(num) * 2 + 1];
+    return PutStr({digits, ConvertUIntToHexString(digits, num)});
+}
+
+void SerialPort::FillFifo() noexcept {
+    // The FIFO is empty, so it can hold a full batch without checking the line status.
+    for (stl::size_t i {0}; i != fifo_size_ && tail_ != head_; ++i) {
+        WriteByteToPort(base_ + reg::data, tx_queue_[tail_++ % tx_queue_size]);
+    }
+}
+
+SerialPort& SerialPort::Flush() noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    if (!IsPresent() || tx_busy_ || tail_ == head_) {
+        return *this;
+    }
+
+    // If the port is busy, the interrupt handler will continue when the FIFO becomes empty.
+    if ((ReadByteFromPort(base_ + reg::lsr) & lsr::tx_empty) != 0) {
+        FillFifo();
+        tx_busy_ = true;
+    }
+
+    return *this;
+}
+
+SerialPort& SerialPort::Drain() noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    if (!IsPresent()) {
+        return *this;
+    }
+
+    while (tail_ != head_) {
+        while ((ReadByteFromPort(base_ + reg::lsr) & lsr::tx_empty) == 0) {
+        }
+
+        FillFifo();
+        // The port still raises an interrupt when the last batch has been sent.
+        tx_busy_ = true;
+    }
+
+    return *this;
+}
+
+SerialPort& SerialPort::OnTxEmpty() noexcept {
+    tx_busy_ = tail_ != head_;
+    FillFifo();
+    return *this;
+}
+
+stl::size_t SerialPort::GetFreeCount() const noexcept {
+    return tx_queue_size - (head_ - tail_);
+}
+
+stl::size_t SerialPort::GetDroppedCount() const noexcept {
+    return dropped_count_;
+}
+
+void InitSerialPort() noexcept {
+    const intr::IntrGuard guard;
+    intr::GetIntrHandlerTab().Register(intr::Intr::Com1, &SerialIntrHandler);
+    if (GetSerialPort().Init()) {
+        io::PrintStr("The serial port has been initialized.\n");
+    }
+}
+
+}  // namespace io
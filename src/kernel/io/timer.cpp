@@ -1,8 +1,11 @@
 #include "kernel/io/timer.h"
 #include "kernel/debug/assert.h"
+#include "kernel/interrupt/apic.h"
 #include "kernel/interrupt/intr.h"
 #include "kernel/io/io.h"
+#include "kernel/io/timer_wheel.h"
 #include "kernel/io/video/print.h"
+#include "kernel/process/krnl_data.h"
 #include "kernel/thread/thd.h"
 #include "kernel/util/bit.h"
 
@@ -32,11 +35,88 @@ inline constexpr stl::uint16_t counter_1 {0x41};
 inline constexpr stl::uint16_t counter_2 {0x42};
 //! The mode and command register.
 static constexpr stl::uint16_t pit_ctrl {0x43};
+//! The control register for the gate of the counter @p 2 and the PC speaker.
+inline constexpr stl::uint16_t speaker_ctrl {0x61};
 }  // namespace port
 
+//! The input frequency of counters.
+constexpr stl::size_t input_freq {1193180};
+
 //! The number of ticks after system startup.
 stl::size_t ticks {0};
 
+//! The maximum value of a counter.
+constexpr stl::uint32_t max_counter_val {0xFFFF};
+
+//! The maximum initial count of the local APIC timer.
+constexpr stl::uint32_t max_apic_timer_count {0xFFFFFFFF};
+
+/**
+ * @brief Whether the local APIC timer generates clock interrupts instead of the counter @p 0.
+ *
+ * @details
+ * The local APIC timer is used when APICs have taken over interrupts.
+ */
+bool apic_timer {false};
+
+//! The counter value of a tick.
+stl::uint32_t tick_counter_val {0};
+
+//! The state of the tickless mode.
+struct Tickless {
+    //! Whether periodic clock interrupts have been stopped.
+    bool active;
+
+    //! The number of ticks until the one-shot clock interrupt.
+    stl::size_t ticks;
+
+    //! The counter value of the one-shot clock interrupt.
+    stl::uint32_t counter_val;
+};
+
+Tickless tickless {};
+
+//! The number of fraction bits in @p tsc_ns_mult.
+constexpr stl::size_t tsc_ns_shift {24};
+
+//! The number of nanoseconds per time-stamp counter cycle, as a fixed-point number.
+stl::uint32_t tsc_ns_mult {0};
+
+//! The time-stamp counter value when the timer is initialized.
+stl::uint64_t tsc_base {0};
+
+//! The frequency of the time-stamp counter.
+stl::uint64_t tsc_freq {0};
+
+/**
+ * @brief Divide a 64-bit integer by a 32-bit integer.
+ *
+ * @details
+ * The kernel is not linked with the compiler runtime library, which provides 64-bit division.
+ */
+stl::uint64_t Divide(const stl::uint64_t dividend, const stl::uint32_t divisor) noexcept {
+    dbg::Assert(divisor != 0);
+    stl::uint64_t quotient {0};
+    stl::uint64_t remainder {0};
+    for (auto i {static_cast<stl::int32_t>(sizeof(dividend) * bit::byte_len) - 1}; i >= 0; --i) {
+        remainder = (remainder << 1) | ((dividend >> i) & 1);
+        if (remainder >= divisor) {
+            remainder -= divisor;
+            quotient |= 1ULL << i;
+        }
+    }
+
+    return quotient;
+}
+
+//! Convert a number of time-stamp counter cycles to nanoseconds.
+stl::uint64_t ConvertTscToNanoseconds(const stl::uint64_t cycles) noexcept {
+    // Split cycles into two 32-bit parts, so the products do not overflow.
+    const auto high {static_cast<stl::uint64_t>(bit::GetHighDword(cycles)) * tsc_ns_mult};
+    const auto low {static_cast<stl::uint64_t>(bit::GetLowDword(cycles)) * tsc_ns_mult};
+    return (high << (sizeof(stl::uint32_t) * bit::byte_len - tsc_ns_shift)) + (low >> tsc_ns_shift);
+}
+
 enum class ReadWriteMode {
     LatchRead = 0,
     ReadWriteLowByte = 1,
@@ -108,33 +188,155 @@ private:
 
 //! Calculate the initial counter value by a timer interrupt frequency.
 constexpr stl::uint32_t CalcInitCounterVal(const stl::size_t freq_per_second) noexcept {
-    constexpr stl::size_t input_freq {1193180};
     return input_freq / freq_per_second;
 }
 
-void InitCounter(const stl::size_t freq_per_second) noexcept {
+void InitCounter(const CountMode mode, const stl::uint32_t val) noexcept {
+    dbg::Assert(0 < val && val <= max_counter_val);
     CtrlWord {}
         .SetSelectCounter(0)
-        .SetCountMode(CountMode::RateGenerator)
+        .SetCountMode(mode)
+        .SetReadWriteMode(ReadWriteMode::ReadWriteLowHighBytes)
+        .SetDigitalMode(DigitalMode::Binary)
+        .WriteToPort();
+
+    io::WriteByteToPort(port::counter_0, bit::GetLowByte(val));
+    io::WriteByteToPort(port::counter_0, bit::GetHighByte(val));
+}
+
+//! Latch and read the current value of the counter @p 0.
+stl::uint32_t ReadCounter() noexcept {
+    CtrlWord {}.SetSelectCounter(0).SetReadWriteMode(ReadWriteMode::LatchRead).WriteToPort();
+    const auto low {static_cast<stl::uint8_t>(io::ReadByteFromPort(port::counter_0))};
+    const auto high {static_cast<stl::uint8_t>(io::ReadByteFromPort(port::counter_0))};
+    return bit::CombineBytes(high, low);
+}
+
+//! Start periodic clock interrupts with a counter value per tick.
+void StartPeriodicCounter(const stl::uint32_t val) noexcept {
+    if (apic_timer) {
+        intr::apic::StartTimer(intr::apic::TimerMode::Periodic, val);
+    } else {
+        InitCounter(CountMode::RateGenerator, val);
+    }
+}
+
+//! Start a one-shot clock interrupt fired after a counter value.
+void StartOneShotCounter(const stl::uint32_t val) noexcept {
+    if (apic_timer) {
+        intr::apic::StartTimer(intr::apic::TimerMode::OneShot, val);
+    } else {
+        InitCounter(CountMode::IntrOnTerminalCount, val);
+    }
+}
+
+//! Read the remaining value of the clock interrupt counter.
+stl::uint32_t ReadCurrCounter() noexcept {
+    return apic_timer ? intr::apic::ReadTimer() : ReadCounter();
+}
+
+//! Get the maximum value of the clock interrupt counter.
+stl::uint32_t GetMaxCounterVal() noexcept {
+    return apic_timer ? max_apic_timer_count : max_counter_val;
+}
+
+/**
+ * @brief Calibrate the time-stamp counter against the counter @p 2.
+ *
+ * @details
+ * The counter @p 2 fires once after about 10 milliseconds,
+ * and its output can be polled without interrupts.
+ */
+void CalibrateTsc() noexcept {
+    constexpr stl::uint32_t counter_val {CalcInitCounterVal(100)};
+    constexpr stl::uint32_t calib_ns {static_cast<stl::uint32_t>(
+        static_cast<stl::uint64_t>(counter_val) * 1000'000'000 / input_freq)};
+    constexpr stl::uint8_t gate_2 {1 << 0};
+    constexpr stl::uint8_t speaker_data {1 << 1};
+    constexpr stl::uint8_t out_2 {1 << 5};
+
+    // Enable the gate of the counter 2 and disable the PC speaker.
+    const auto speaker_ctrl {static_cast<stl::uint8_t>(io::ReadByteFromPort(port::speaker_ctrl))};
+    io::WriteByteToPort(port::speaker_ctrl, (speaker_ctrl & ~speaker_data) | gate_2);
+
+    CtrlWord {}
+        .SetSelectCounter(2)
+        .SetCountMode(CountMode::IntrOnTerminalCount)
         .SetReadWriteMode(ReadWriteMode::ReadWriteLowHighBytes)
         .SetDigitalMode(DigitalMode::Binary)
         .WriteToPort();
+    io::WriteByteToPort(port::counter_2, bit::GetLowByte(counter_val));
+    io::WriteByteToPort(port::counter_2, bit::GetHighByte(counter_val));
+
+    // The output of the counter 2 goes high when the count reaches zero.
+    const auto begin {io::ReadTsc()};
+    while ((static_cast<stl::uint8_t>(io::ReadByteFromPort(port::speaker_ctrl)) & out_2) == 0) {
+    }
+
+    const auto cycles {static_cast<stl::uint32_t>(io::ReadTsc() - begin)};
+    io::WriteByteToPort(port::speaker_ctrl, speaker_ctrl);
+    dbg::Assert(cycles > 0);
+
+    tsc_ns_mult = static_cast<stl::uint32_t>(
+        Divide(static_cast<stl::uint64_t>(calib_ns) << tsc_ns_shift, cycles));
+    tsc_freq = Divide(static_cast<stl::uint64_t>(cycles) * 1000'000'000, calib_ns);
+    tsc_base = io::ReadTsc();
+
+    // Publish clock parameters so user programs can convert cycles to nanoseconds by themselves.
+    auto& data {tsk::GetKrnlData()};
+    data.tsc_base = tsc_base;
+    data.tsc_ns_mult = tsc_ns_mult;
+    data.tsc_ns_shift = tsc_ns_shift;
+}
 
-    const auto init_val {CalcInitCounterVal(freq_per_second)};
-    io::WriteByteToPort(port::counter_0, bit::GetLowByte(init_val));
-    io::WriteByteToPort(port::counter_0, bit::GetHighByte(init_val));
+/**
+ * @brief Calibrate the local APIC timer against the time-stamp counter.
+ *
+ * @return The count of the local APIC timer per tick.
+ */
+stl::uint32_t CalibrateApicTimer(const stl::size_t freq_per_second) noexcept {
+    const auto tick_cycles {Divide(tsc_freq, freq_per_second)};
+    intr::apic::StartTimer(intr::apic::TimerMode::OneShot, max_apic_timer_count);
+    const auto begin {io::ReadTsc()};
+    while (io::ReadTsc() - begin < tick_cycles) {
+    }
+
+    const auto count {max_apic_timer_count - intr::apic::ReadTimer()};
+    dbg::Assert(count > 0);
+    return count;
+}
+
+/**
+ * @brief Restart periodic clock interrupts.
+ *
+ * @param skipped_ticks The number of ticks skipped in the tickless mode.
+ */
+void RestartPeriodicTick(const stl::size_t skipped_ticks) noexcept {
+    dbg::Assert(tickless.active);
+    ticks += skipped_ticks;
+    tsk::GetKrnlData().ticks = ticks;
+    tickless.active = false;
+    StartPeriodicCounter(tick_counter_val);
 }
 
 /**
  * @brief The clock interrupt handler.
  *
  * @details
- * It increases ticks and schedules threads.
+ * It increases ticks, wakes up sleeping threads, expires kernel timers and schedules threads.
  */
 void ClockIntrHandler(stl::size_t) noexcept {
     auto& curr_thd {tsk::Thread::GetCurrent()};
     dbg::Assert(curr_thd.IsStackValid());
+    if (tickless.active) {
+        // The one-shot clock interrupt is fired. Other skipped ticks should be counted.
+        RestartPeriodicTick(tickless.ticks - 1);
+    }
+
     ++ticks;
+    tsk::GetKrnlData().ticks = ticks;
+    tsk::Thread::WakeSleepers(ticks);
+    RunKrnlTimers(ticks);
     if (!curr_thd.Tick()) {
         curr_thd.Schedule();
     }
@@ -150,12 +352,86 @@ void InitTimer(const stl::size_t freq_per_second) noexcept {
     dbg::Assert(!IsTimerInited());
     dbg::Assert(tsk::IsThreadInited());
     ticks = 0;
-    InitCounter(freq_per_second);
+    tsk::GetKrnlData().ticks = ticks;
+    CalibrateTsc();
+    apic_timer = intr::apic::IsApicEnabled();
+    tick_counter_val =
+        apic_timer ? CalibrateApicTimer(freq_per_second) : CalcInitCounterVal(freq_per_second);
     intr::GetIntrHandlerTab().Register(intr::Intr::Clock, &ClockIntrHandler);
+    StartPeriodicCounter(tick_counter_val);
     IsTimerInitedImpl() = true;
-    io::PrintStr("Intel 8253 Programmable Interval Timer has been initialized.\n");
+    if (apic_timer) {
+        io::PrintStr("The local APIC timer has been initialized.\n");
+    } else {
+        io::PrintStr("Intel 8253 Programmable Interval Timer has been initialized.\n");
+    }
+}
+
+void StopTimerTick(stl::size_t idle_ticks) noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    if constexpr (!timer_tickless_idle) {
+        return;
+    }
+
+    if (!IsTimerInited() || tickless.active) {
+        return;
+    }
+
+    // The counter of Intel 8253 has only 16 bits, so the timer can only skip a few ticks at a time.
+    // The local APIC timer has 32 bits.
+    idle_ticks = stl::min<stl::size_t>(idle_ticks, GetMaxCounterVal() / tick_counter_val);
+    if (idle_ticks <= 1) {
+        return;
+    }
+
+    tickless.active = true;
+    tickless.ticks = idle_ticks;
+    tickless.counter_val = idle_ticks * tick_counter_val;
+    StartOneShotCounter(tickless.counter_val);
+}
+
+void ResumeTimerTick() noexcept {
+    const intr::IntrGuard guard;
+    if (!tickless.active) {
+        return;
+    }
+
+    // Another interrupt is fired before the one-shot clock interrupt.
+    // The counter of Intel 8253 wraps around after it reaches zero, but the local APIC timer stays at zero.
+    if (const auto remain {ReadCurrCounter()};
+        apic_timer ? remain != 0 : remain <= tickless.counter_val) {
+        // The remaining part of the current tick is discarded.
+        RestartPeriodicTick((tickless.counter_val - remain) / tick_counter_val);
+    } else {
+        // The one-shot clock interrupt is pending. Its handler will count the last tick.
+        RestartPeriodicTick(tickless.ticks - 1);
+    }
+}
+
+stl::uint64_t GetNanoseconds() noexcept {
+    dbg::Assert(IsTimerInited());
+    return ConvertTscToNanoseconds(io::ReadTsc() - tsc_base);
+}
+
+stl::uint64_t GetTscFreq() noexcept {
+    dbg::Assert(IsTimerInited());
+    return tsc_freq;
 }
 
+stl::uint64_t ConvertTscToMicroseconds(const stl::uint64_t cycles) noexcept {
+    dbg::Assert(IsTimerInited());
+    return Divide(ConvertTscToNanoseconds(cycles), 1000);
+}
+
+namespace sc {
+
+void Timer::GetNanoseconds(stl::uint64_t* const ns) noexcept {
+    dbg::Assert(ns);
+    *ns = io::GetNanoseconds();
+}
+
+}  // namespace sc
+
 bool IsTimerInited() noexcept {
     return IsTimerInitedImpl();
 }
@@ -0,0 +1,212 @@
+#include "kernel/io/timer_wheel.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/timer.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/array.h"
+#include "kernel/util/metric.h"
+
+namespace io {
+
+//! The levels of slots saving pending timers.
+class TimerWheel {
+public:
+    /**
+     * @brief Put a pending timer into a slot.
+     *
+     * @details
+     * Interrupts must be disabled.
+     */
+    TimerWheel& Insert(KrnlTimer& timer) noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        // An expired timer is run at the current tick if it is being cascaded, or at the next one.
+        // A timer beyond the range is put into the last level and moved again when it is cascaded.
+        const auto delta {timer.expire_tick_ > ticks_
+                              ? stl::min(timer.expire_tick_ - ticks_, max_timer_wheel_ticks - 1)
+                              : 0};
+        stl::size_t level {0};
+        while ((delta >> (timer_wheel_slot_bit_count * (level + 1))) != 0) {
+            ++level;
+        }
+
+        slots_[level][GetSlotIdx(ticks_ + delta, level)].PushBack(timer.tag_);
+        ++count_;
+        return *this;
+    }
+
+    //! Remove a pending timer from its slot.
+    TimerWheel& Remove(KrnlTimer& timer) noexcept {
+        dbg::Assert(!intr::IsIntrEnabled() && count_ > 0);
+        timer.tag_.Detach();
+        --count_;
+        return *this;
+    }
+
+    stl::size_t GetTicks() const noexcept {
+        return ticks_;
+    }
+
+    //! Advance the wheel tick by tick until a tick.
+    TimerWheel& Run(const stl::size_t ticks) noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        while (ticks_ != ticks) {
+            ++ticks_;
+            if (count_ == 0) {
+                // Nothing can expire, so skipped ticks are not processed one by one.
+                ticks_ = ticks;
+                break;
+            }
+
+            // Cascade higher levels when the lower one wraps around.
+            for (stl::size_t level {1}; level != timer_wheel_level_count; ++level) {
+                if (GetSlotIdx(ticks_, level - 1) != 0) {
+                    break;
+                }
+
+                Cascade(slots_[level][GetSlotIdx(ticks_, level)]);
+            }
+
+            Expire(slots_[0][GetSlotIdx(ticks_, 0)]);
+        }
+
+        return *this;
+    }
+
+    stl::size_t GetNextTick() const noexcept {
+        dbg::Assert(!intr::IsIntrEnabled());
+        if (count_ == 0) {
+            return npos;
+        }
+
+        for (stl::size_t i {1}; i <= timer_wheel_slot_count; ++i) {
+            if (GetSlotIdx(ticks_ + i, 0) == 0) {
+                // Timers in higher levels may be cascaded at this tick.
+                return ticks_ + i;
+            } else if (!slots_[0][GetSlotIdx(ticks_ + i, 0)].IsEmpty()) {
+                return ticks_ + i;
+            }
+        }
+
+        return npos;
+    }
+
+private:
+    static stl::size_t GetSlotIdx(const stl::size_t tick, const stl::size_t level) noexcept {
+        return (tick >> (timer_wheel_slot_bit_count * level)) & (timer_wheel_slot_count - 1);
+    }
+
+    //! Move timers in a slot to lower levels.
+    TimerWheel& Cascade(TagList& slot) noexcept {
+        while (!slot.IsEmpty()) {
+            auto& timer {slot.Pop().GetElem<KrnlTimer>()};
+            --count_;
+            Insert(timer);
+        }
+
+        return *this;
+    }
+
+    //! Pass callbacks of timers in a slot to the work queue.
+    TimerWheel& Expire(TagList& slot) noexcept {
+        TagList retried;
+        while (!slot.IsEmpty()) {
+            auto& timer {slot.Pop().GetElem<KrnlTimer>()};
+            --count_;
+            if (!intr::ScheduleWork(timer.callback_, timer.arg_)) {
+                // The work queue is full. The timer is retried at the next tick.
+                retried.PushBack(timer.tag_);
+            } else if (timer.period_ != 0) {
+                timer.expire_tick_ = ticks_ + timer.period_;
+                Insert(timer);
+            } else {
+                timer.pending_ = false;
+            }
+        }
+
+        while (!retried.IsEmpty()) {
+            auto& timer {retried.Pop().GetElem<KrnlTimer>()};
+            timer.expire_tick_ = ticks_ + 1;
+            Insert(timer);
+        }
+
+        return *this;
+    }
+
+    stl::array<stl::array<TagList, timer_wheel_slot_count>, timer_wheel_level_count> slots_;
+
+    //! The last processed tick.
+    stl::size_t ticks_ {0};
+
+    //! The number of timers in slots.
+    stl::size_t count_ {0};
+};
+
+namespace {
+
+static_assert(timer_wheel_slot_bit_count * timer_wheel_level_count < sizeof(stl::size_t) * 8);
+
+/**
+ * @brief A wrapper of a global variable saving pending kernel timers.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+TimerWheel& GetTimerWheel() noexcept {
+    static TimerWheel wheel;
+    return wheel;
+}
+
+}  // namespace
+
+KrnlTimer& KrnlTimer::Init(const Callback callback, void* const arg) noexcept {
+    dbg::Assert(callback);
+    const intr::IntrGuard guard;
+    dbg::Assert(!pending_);
+    callback_ = callback;
+    arg_ = arg;
+    return *this;
+}
+
+KrnlTimer& KrnlTimer::Start(const stl::size_t ticks, const stl::size_t period) noexcept {
+    dbg::Assert(callback_);
+    auto& wheel {GetTimerWheel()};
+    const intr::IntrGuard guard;
+    if (pending_) {
+        wheel.Remove(*this);
+    }
+
+    // Ticks skipped in the tickless mode may not have been processed yet.
+    expire_tick_ = stl::max(GetTicks(), wheel.GetTicks()) + stl::max<stl::size_t>(ticks, 1);
+    period_ = period;
+    pending_ = true;
+    wheel.Insert(*this);
+    return *this;
+}
+
+bool KrnlTimer::Stop() noexcept {
+    const intr::IntrGuard guard;
+    if (!pending_) {
+        return false;
+    }
+
+    GetTimerWheel().Remove(*this);
+    pending_ = false;
+    return true;
+}
+
+bool KrnlTimer::IsPending() const noexcept {
+    const intr::IntrGuard guard;
+    return pending_;
+}
+
+void RunKrnlTimers(const stl::size_t ticks) noexcept {
+    GetTimerWheel().Run(ticks);
+}
+
+stl::size_t GetNextKrnlTimerTick() noexcept {
+    const intr::IntrGuard guard;
+    return GetTimerWheel().GetNextTick();
+}
+
+}  // namespace io
@@ -1,18 +1,20 @@
 #include "kernel/io/video/console.h"
-#include "kernel/io/keyboard.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/line_disc.h"
 
 namespace io {
 
 stl::mutex& Console::GetMutex() noexcept {
-    static stl::mutex mtx;
+    static stl::mutex mtx {"io::Console"};
     return mtx;
 }
 
-void Console::Read(char* const buf, const stl::size_t count) noexcept {
-    auto& keyboard {GetKeyboardBuffer()};
-    for (stl::size_t i {0}; i != count; ++i) {
-        buf[i] = keyboard.Pop();
-    }
+stl::size_t Console::Read(char* const buf, const stl::size_t size) noexcept {
+    return GetConsoleInput().Read(buf, size);
+}
+
+void Console::SetCanonical(const bool canonical) noexcept {
+    GetConsoleInput().SetCanonical(canonical);
 }
 
 void Console::PrintlnStr(const stl::string_view str) noexcept {
@@ -60,4 +62,11 @@ void Console::PrintHex(const stl::int32_t num) noexcept {
     io::PrintHex(num);
 }
 
+void Console::Write(const char* const buf, const stl::size_t size) noexcept {
+    dbg::Assert(buf || size == 0);
+    const stl::lock_guard guard {GetMutex()};
+    // The buffer is flushed to VGA memory once.
+    io::PrintStr({buf, size});
+}
+
 }  // namespace io
\ No newline at end of file
@@ -1,17 +1,79 @@
 #include "kernel/io/video/print.h"
 #include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/serial.h"
+#include "kernel/io/video/screen.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/util/bit.h"
 
 namespace io {
 
+namespace {
+
+/**
+ * @brief Printed text is put into the text screen and mirrored to the serial port.
+ *
+ * @details
+ * Interrupts should be disabled when using it.
+ */
+class Output {
+public:
+    Output& PutChar(const char ch) noexcept {
+        screen_.PutChar(ch);
+        serial_.PutChar(ch);
+        return *this;
+    }
+
+    Output& PutStr(const stl::string_view str) noexcept {
+        screen_.PutStr(str);
+        serial_.PutStr(str);
+        return *this;
+    }
+
+    Output& PutHex(const stl::uint32_t num) noexcept {
+        screen_.PutHex(num);
+        serial_.PutHex(num);
+        return *this;
+    }
+
+    Output& Flush() noexcept {
+        screen_.Flush();
+        serial_.Flush();
+        return *this;
+    }
+
+private:
+    TextScreen& screen_ {GetTextScreen()};
+    SerialPort& serial_ {GetSerialPort()};
+};
+
+}  // namespace
+
+void PrintChar(const char ch) noexcept {
+    const intr::IntrGuard guard;
+    Output {}.PutChar(ch).Flush();
+}
+
+void PrintStr(const char* const str) noexcept {
+    dbg::Assert(str);
+    const intr::IntrGuard guard;
+    Output {}.PutStr(str).Flush();
+}
+
+void PrintHex(const stl::uint32_t num) noexcept {
+    const intr::IntrGuard guard;
+    Output {}.PutHex(num).Flush();
+}
+
 void PrintlnStr(const stl::string_view str) noexcept {
-    PrintStr(str);
-    PrintChar('\n');
+    const intr::IntrGuard guard;
+    Output {}.PutStr(str).PutChar('\n').Flush();
 }
 
 void PrintStr(const stl::string_view str) noexcept {
-    if (!str.empty()) {
-        PrintStr(str.data());
-    }
+    const intr::IntrGuard guard;
+    Output {}.PutStr(str).Flush();
 }
 
 void PrintlnHex(const stl::int32_t num) noexcept {
@@ -24,7 +86,8 @@ void PrintHex(const stl::int32_t num) noexcept {
         PrintHex(static_cast<stl::uint32_t>(num));
     } else {
         PrintChar('-');
-        PrintHex(static_cast<stl::uint32_t>(-num));
+        // The magnitude of the minimum integer cannot be represented as a signed integer.
+        PrintHex(static_cast<stl::uint32_t>(0) - static_cast<stl::uint32_t>(num));
     }
 }
 
@@ -40,29 +103,72 @@ void PrintlnHex(const stl::uint32_t num) noexcept {
 
 namespace _printf_impl {
 
-void Print(const stl::uint32_t num) noexcept {
-    PrintHex(num);
+Buffer::~Buffer() noexcept {
+    Print();
 }
 
-void Print(const stl::int32_t num) noexcept {
-    PrintHex(num);
+void Buffer::Print() noexcept {
+    if (len_ != 0) {
+        PrintStr(stl::string_view {buf_, len_});
+        len_ = 0;
+    }
 }
 
-void Print(const char ch) noexcept {
-    PrintChar(ch);
+Buffer& Buffer::Append(const stl::uint32_t num) noexcept {
+    // The converter writes a null character after digits.
+    char digits[max_num_len];
+    return Append(stl::string_view {digits, ConvertUIntToHexString(digits, num)});
 }
 
-void Print(const stl::string_view str) noexcept {
-    PrintStr(str);
+Buffer& Buffer::Append(const stl::int32_t num) noexcept {
+    // A negative integer is printed with a sign, as by @p PrintHex.
+    char digits[max_num_len];
+    return Append(stl::string_view {digits, ConvertIntToString(digits, num, 16)});
 }
 
-void Print(const char* const str) noexcept {
-    dbg::Assert(str);
-    PrintStr(str);
+Buffer& Buffer::Append(const stl::uint64_t num) noexcept {
+    const auto high {bit::GetHighDword(num)};
+    const auto low {bit::GetLowDword(num)};
+    if (high == 0) {
+        return Append(low);
+    }
+
+    Append(high);
+    // The low double word must keep its leading zeros.
+    char digits[max_num_len];
+    return Append(
+        stl::string_view {digits, ConvertUIntToHexString(digits, low, sizeof(low) * 2)});
 }
 
-void Printf(const stl::string_view format) noexcept {
-    PrintStr(format);
+Buffer& Buffer::Append(const char ch) noexcept {
+    if (len_ == size) {
+        Print();
+    }
+
+    buf_[len_++] = ch;
+    return *this;
+}
+
+Buffer& Buffer::Append(const stl::string_view str) noexcept {
+    for (stl::size_t i {0}; i != str.size();) {
+        // Copy as many characters as the buffer can hold, and print the buffer when it is full.
+        const auto len {stl::min(str.size() - i, size - len_)};
+        if (len == 0) {
+            Print();
+            continue;
+        }
+
+        stl::memcpy(buf_ + len_, str.data() + i, len);
+        len_ += len;
+        i += len;
+    }
+
+    return *this;
+}
+
+Buffer& Buffer::Append(const char* const str) noexcept {
+    dbg::Assert(str);
+    return Append(stl::string_view {str});
 }
 
 }  // namespace _printf_impl
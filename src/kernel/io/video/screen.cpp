@@ -0,0 +1,166 @@
+#include "kernel/io/video/screen.h"
+#include "kernel/krnl.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/util/format.h"
+
+namespace io {
+
+namespace {
+
+//! The physical address of VGA text memory.
+inline constexpr stl::uintptr_t vga_text_mem_addr {0xB8000};
+
+//! The size of VGA text memory.
+inline constexpr stl::size_t vga_text_mem_size {0x8000};
+
+//! The number of rows in VGA text memory.
+inline constexpr stl::size_t vga_row_count {vga_text_mem_size / sizeof(stl::uint16_t)
+                                            / TextScreen::width};
+
+static_assert(vga_row_count >= TextScreen::height);
+
+/**
+ * @brief Get VGA text memory.
+ *
+ * @details
+ * The first megabyte of physical memory is mapped to the beginning of kernel space.
+ */
+stl::uint16_t* GetVgaTextMem() noexcept {
+    return reinterpret_cast<stl::uint16_t*>(krnl_base + vga_text_mem_addr);
+}
+
+}  // namespace
+
+TextScreen& GetTextScreen() noexcept {
+    static TextScreen screen;
+    return screen;
+}
+
+TextScreen::TextScreen() noexcept : cursor_ {GetCursorPos()} {
+    const auto vga {GetVgaTextMem()};
+    for (stl::size_t row {0}; row != height; ++row) {
+        stl::memcpy(lines_[row].data(), vga + row * width, sizeof(Line));
+    }
+
+    if (cursor_ >= width * height) {
+        cursor_ = 0;
+    }
+}
+
+TextScreen::Line& TextScreen::GetLine(const stl::size_t row) noexcept {
+    return lines_[(top_ + row) % height];
+}
+
+void TextScreen::MarkDirty(const stl::size_t row) noexcept {
+    dirty_rows_ |= static_cast<stl::uint32_t>(1) << row;
+}
+
+void TextScreen::ScrollUp() noexcept {
+    // The old top line becomes the new bottom line.
+    auto& bottom {lines_[top_]};
+    top_ = (top_ + 1) % height;
+    for (auto& cell : bottom) {
+        cell = (blank_attr << bit::byte_len) | ' ';
+    }
+
+    constexpr auto all_rows {
+        static_cast<stl::uint32_t>((static_cast<stl::uint64_t>(1) << height) - 1)};
+    if (vga_top_ + height != vga_row_count) {
+        // Move the display window down. Other rows are already in VGA memory.
+        ++vga_top_;
+        dirty_rows_ = (dirty_rows_ >> 1) | (static_cast<stl::uint32_t>(1) << (height - 1));
+    } else {
+        // The window wraps to the beginning, so every row should be copied.
+        vga_top_ = 0;
+        dirty_rows_ = all_rows;
+    }
+
+    window_moved_ = true;
+}
+
+TextScreen& TextScreen::PutChar(const char ch) noexcept {
+    const auto set_cell {[this](const stl::size_t pos, const char ch) noexcept {
+        auto& cell {GetLine(pos / width)[pos % width]};
+        // Keep the attribute of the cell.
+        cell = (cell & 0xFF00) | static_cast<stl::uint8_t>(ch);
+        MarkDirty(pos / width);
+    }};
+
+    switch (ch) {
+        case '\t': {
+            for (stl::size_t i {0}; i != tab_width; ++i) {
+                PutChar(' ');
+            }
+
+            return *this;
+        }
+        case '\b': {
+            // Delete the last character.
+            if (cursor_ != 0) {
+                set_cell(--cursor_, ' ');
+            }
+
+            break;
+        }
+        case '\r':
+        case '\n': {
+            // Move to the beginning of the next line.
+            cursor_ = (cursor_ / width + 1) * width;
+            break;
+        }
+        default: {
+            set_cell(cursor_++, ch);
+            break;
+        }
+    }
+
+    if (cursor_ == width * height) {
+        ScrollUp();
+        cursor_ -= width;
+    }
+
+    cursor_moved_ = true;
+    return *this;
+}
+
+TextScreen& TextScreen::PutStr(const stl::string_view str) noexcept {
+    for (const auto ch : str) {
+        PutChar(ch);
+    }
+
+    return *this;
+}
+
+TextScreen& TextScreen::PutHex(const stl::uint32_t num) noexcept {
+    char digits[sizeof(num) * 2 + 1];
+    return PutStr({digits, ConvertUIntToHexString(digits, num)});
+}
+
+TextScreen& TextScreen::Flush() noexcept {
+    const auto vga {GetVgaTextMem()};
+    for (stl::size_t row {0}; dirty_rows_ != 0; ++row) {
+        if (dirty_rows_ & (static_cast<stl::uint32_t>(1) << row)) {
+            stl::memcpy(vga + (vga_top_ + row) * width, GetLine(row).data(), sizeof(Line));
+            dirty_rows_ &= ~(static_cast<stl::uint32_t>(1) << row);
+        }
+    }
+
+    if (window_moved_) {
+        SetDisplayStart(static_cast<stl::uint16_t>(vga_top_ * width));
+        window_moved_ = false;
+    }
+
+    // The hardware cursor position is an offset in VGA memory instead of the window.
+    if (cursor_moved_) {
+        SetCursorPos(static_cast<stl::uint16_t>(vga_top_ * width + cursor_));
+        cursor_moved_ = false;
+    }
+
+    return *this;
+}
+
+bool TextScreen::IsDirty() const noexcept {
+    return dirty_rows_ != 0 || cursor_moved_ || window_moved_;
+}
+
+}  // namespace io
@@ -1,22 +1,57 @@
 #include "kernel/krnl.h"
+#include "kernel/cpu/fpu.h"
+#include "kernel/cpu/mp.h"
+#include "kernel/debug/log.h"
+#include "kernel/debug/timeline.h"
 #include "kernel/interrupt/intr.h"
+#include "kernel/interrupt/work.h"
 #include "kernel/io/disk/disk.h"
 #include "kernel/io/keyboard.h"
+#include "kernel/io/serial.h"
 #include "kernel/io/timer.h"
 #include "kernel/memory/pool.h"
+#include "kernel/process/krnl_data.h"
 #include "kernel/process/tss.h"
 #include "kernel/syscall/call.h"
 #include "kernel/thread/thd.h"
 
 void InitKernel() noexcept {
+    dbg::InitBootTimeline();
     intr::InitIntr();
+    dbg::MarkBootStage("Interrupts");
     sc::InitSysCall();
+    dbg::MarkBootStage("System calls");
     mem::InitMem();
+    dbg::MarkBootStage("Memory");
+    tsk::InitKrnlData();
+    dbg::MarkBootStage("Kernel data page");
+    cpu::InitMultiProcessor();
+    dbg::MarkBootStage("Multi-processor");
+    intr::SwitchToApic();
+    dbg::MarkBootStage("APIC");
     tsk::InitThread();
+    dbg::MarkBootStage("Threads");
+    cpu::InitFpu();
+    dbg::MarkBootStage("FPU");
+    intr::InitWorkQueue();
+    dbg::MarkBootStage("Work queue");
+    dbg::InitLog();
+    dbg::MarkBootStage("Log");
     io::InitTimer(io::timer_freq_per_second);
+    dbg::MarkBootStage("Timer");
     tsk::InitTaskStateSeg();
+    dbg::MarkBootStage("Task state segment");
+    sc::InitFastSysCall();
+    dbg::MarkBootStage("Fast system calls");
     io::InitKeyboard();
+    dbg::MarkBootStage("Keyboard");
+    io::InitSerialPort();
+    dbg::MarkBootStage("Serial port");
     intr::EnableIntr();
+    dbg::MarkBootStage("Interrupts enabled");
     io::InitDisk();
+    dbg::MarkBootStage("Disks");
     io::InitFileSys();
+    dbg::MarkBootStage("File system");
+    dbg::LogBootTimeline();
 }
\ No newline at end of file
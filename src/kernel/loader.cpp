@@ -0,0 +1,6 @@
+#include "kernel/loader.h"
+
+const LoaderData& GetLoaderData() noexcept {
+    const volatile stl::uintptr_t addr {loader_krnl_data_base};
+    return *reinterpret_cast<const LoaderData*>(addr);
+}
@@ -1,8 +1,23 @@
+#include "kernel/debug/bench.h"
+#include "kernel/io/file/bench.h"
+#include "kernel/io/video/print.h"
 #include "kernel/stl/cstdlib.h"
 #include "kernel/thread/thd.h"
 
 int main() {
     InitKernel();
+    if constexpr (io::fs_bench_enabled) {
+        io::RunFileSysBench();
+    }
+
+    if constexpr (dbg::krnl_bench_enabled) {
+        dbg::RunBenchmarks();
+    }
+
+    if constexpr (io::fs_bench_enabled || dbg::krnl_bench_enabled) {
+        // `tools/bench.sh` stops the virtual machine when it reads this line from the serial port.
+        io::PrintlnStr("Benchmarks have finished.");
+    }
 
     while (true) {
         tsk::Thread::GetCurrent().Yield();
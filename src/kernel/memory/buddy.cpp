@@ -0,0 +1,188 @@
+#include "kernel/memory/buddy.h"
+#include "kernel/debug/assert.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/util/metric.h"
+
+namespace mem {
+
+stl::size_t BuddyAllocator::CalcBlockCount(const stl::size_t page_count,
+                                           const stl::size_t order) noexcept {
+    return page_count >> order;
+}
+
+stl::size_t BuddyAllocator::CalcOrder(const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    stl::size_t order {0};
+    while ((static_cast<stl::size_t>(1) << order) < count) {
+        ++order;
+    }
+
+    return order;
+}
+
+stl::size_t BuddyAllocator::CalcBitmapByteLen(const stl::size_t page_count) noexcept {
+    stl::size_t byte_len {0};
+    for (stl::size_t order {0}; order != order_count; ++order) {
+        byte_len += RoundUpDivide(CalcBlockCount(page_count, order), bit::byte_len);
+    }
+
+    return byte_len;
+}
+
+BuddyAllocator& BuddyAllocator::Init(void* const bits, const stl::size_t page_count) noexcept {
+    dbg::Assert(bits && page_count > 0);
+    page_count_ = page_count;
+    split_count_ = 0;
+    merge_count_ = 0;
+    used_order_count_ = 0;
+
+    // Mark all blocks as unavailable. Then free all pages to build free blocks.
+    auto byte_addr {static_cast<stl::byte*>(bits)};
+    for (stl::size_t order {0}; order != order_count; ++order) {
+        free_counts_[order] = 0;
+        const auto byte_len {RoundUpDivide(CalcBlockCount(page_count, order), bit::byte_len)};
+        if (byte_len > 0) {
+            stl::memset(byte_addr, 0xFF, byte_len);
+            free_blocks_[order].Init(byte_addr, byte_len, false);
+            byte_addr += byte_len;
+            ++used_order_count_;
+        }
+    }
+
+    return Free(0, page_count);
+}
+
+stl::size_t BuddyAllocator::Alloc(const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    const auto order {CalcOrder(count)};
+    if (order >= used_order_count_) {
+        return npos;
+    }
+
+    // Find the smallest order with a free block.
+    auto curr_order {order};
+    while (curr_order != used_order_count_ && free_counts_[curr_order] == 0) {
+        ++curr_order;
+    }
+
+    if (curr_order == used_order_count_) {
+        return npos;
+    }
+
+    auto idx {free_blocks_[curr_order].Alloc()};
+    dbg::Assert(idx != npos);
+    --free_counts_[curr_order];
+
+    // Split the block until it reaches the required order.
+    // The first half is used and the second half is freed.
+    while (curr_order != order) {
+        --curr_order;
+        idx *= 2;
+        free_blocks_[curr_order].Free(idx + 1);
+        ++free_counts_[curr_order];
+        ++split_count_;
+    }
+
+    const auto begin {idx << order};
+    // Free excess pages if the number of pages is not a power of two.
+    if (const auto excess {(static_cast<stl::size_t>(1) << order) - count}; excess > 0) {
+        Free(begin + count, excess);
+    }
+
+    return begin;
+}
+
+BuddyAllocator& BuddyAllocator::Free(stl::size_t begin, stl::size_t count) noexcept {
+    dbg::Assert(count > 0 && begin + count <= page_count_);
+    // Split pages into the largest aligned blocks.
+    while (count > 0) {
+        stl::size_t order {used_order_count_ - 1};
+        while (begin % (static_cast<stl::size_t>(1) << order) != 0
+               || (static_cast<stl::size_t>(1) << order) > count) {
+            --order;
+        }
+
+        FreeBlock(begin >> order, order);
+        begin += static_cast<stl::size_t>(1) << order;
+        count -= static_cast<stl::size_t>(1) << order;
+    }
+
+    return *this;
+}
+
+BuddyAllocator& BuddyAllocator::Reserve(stl::size_t begin, const stl::size_t count) noexcept {
+    dbg::Assert(count > 0 && begin + count <= page_count_);
+    for (const auto end {begin + count}; begin != end; ++begin) {
+        // Find the free block containing the page.
+        stl::size_t order {0};
+        while (order != used_order_count_
+               && ((begin >> order) >= CalcBlockCount(page_count_, order)
+                   || free_blocks_[order].IsAlloc(begin >> order))) {
+            ++order;
+        }
+
+        dbg::Assert(order != used_order_count_, "The page has been allocated.");
+        free_blocks_[order].ForceAlloc(begin >> order);
+        --free_counts_[order];
+        // Split the block until it only contains the page.
+        // The halves not containing the page are freed.
+        while (order != 0) {
+            --order;
+            free_blocks_[order].Free((begin >> order) ^ 1);
+            ++free_counts_[order];
+            ++split_count_;
+        }
+    }
+
+    return *this;
+}
+
+BuddyAllocator& BuddyAllocator::FreeBlock(stl::size_t idx, stl::size_t order) noexcept {
+    dbg::Assert(order < used_order_count_);
+    dbg::Assert(free_blocks_[order].IsAlloc(idx), "The block has been freed.");
+    // Merge the block with its buddy if the buddy is also free.
+    while (order + 1 != used_order_count_) {
+        const auto buddy {idx ^ 1};
+        auto& blocks {free_blocks_[order]};
+        if (buddy >= blocks.GetCapacity() || blocks.IsAlloc(buddy)) {
+            break;
+        }
+
+        blocks.ForceAlloc(buddy);
+        --free_counts_[order];
+        idx /= 2;
+        ++order;
+        ++merge_count_;
+    }
+
+    free_blocks_[order].Free(idx);
+    ++free_counts_[order];
+    return *this;
+}
+
+stl::size_t BuddyAllocator::GetPageCount() const noexcept {
+    return page_count_;
+}
+
+bool BuddyAllocator::IsFree(const stl::size_t idx) const noexcept {
+    dbg::Assert(idx < page_count_);
+    for (stl::size_t order {0}; order != used_order_count_; ++order) {
+        if (const auto block_idx {idx >> order};
+            block_idx < CalcBlockCount(page_count_, order)
+            && !free_blocks_[order].IsAlloc(block_idx)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+stl::size_t BuddyAllocator::GetSplitCount() const noexcept {
+    return split_count_;
+}
+
+stl::size_t BuddyAllocator::GetMergeCount() const noexcept {
+    return merge_count_;
+}
+
+}  // namespace mem
@@ -0,0 +1,40 @@
+#include "kernel/memory/magazine.h"
+#include "kernel/debug/assert.h"
+
+namespace mem {
+
+MemBlockMagazine& MemBlockMagazine::Push(void* const block) noexcept {
+    dbg::Assert(block);
+    dbg::Assert(!IsFull());
+    blocks_[count_++] = block;
+    return *this;
+}
+
+void* MemBlockMagazine::Pop() noexcept {
+    dbg::Assert(!IsEmpty());
+    return blocks_[--count_];
+}
+
+MemBlockMagazine& MemBlockMagazine::Clear() noexcept {
+    count_ = 0;
+    return *this;
+}
+
+const MemBlockMagazine& MemBlockMagazines::operator[](const stl::size_t idx) const noexcept {
+    dbg::Assert(idx < count);
+    return mags_[idx];
+}
+
+MemBlockMagazine& MemBlockMagazines::operator[](const stl::size_t idx) noexcept {
+    return const_cast<MemBlockMagazine&>(const_cast<const MemBlockMagazines&>(*this)[idx]);
+}
+
+MemBlockMagazines& MemBlockMagazines::Clear() noexcept {
+    for (auto& mag : mags_) {
+        mag.Clear();
+    }
+
+    return *this;
+}
+
+}  // namespace mem
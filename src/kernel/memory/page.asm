@@ -1,5 +1,8 @@
 %include "kernel/util/metric.inc"
 
+; The `PGE` bit of `CR4`, which enables global pages.
+cr4_pge         equ     0x80
+
 [bits 32]
 section     .text
 global      DisableTlbEntry
@@ -16,4 +19,22 @@ DisableTlbEntry:
         invlpg  [eax]
         leave
         ret
-    %pop
\ No newline at end of file
+    %pop
+
+global      FlushTlb
+; Invalidate all Translation Lookaside Buffer (TLB) entries except global pages by reloading `CR3`.
+FlushTlb:
+    mov     eax, cr3
+    mov     cr3, eax
+    ret
+
+global      FlushGlobalTlb
+; Invalidate all Translation Lookaside Buffer (TLB) entries, including global pages.
+; Toggling the `PGE` bit of `CR4` flushes global pages as well.
+FlushGlobalTlb:
+    mov     eax, cr4
+    mov     ecx, eax
+    and     ecx, ~cr4_pge
+    mov     cr4, ecx
+    mov     cr4, eax
+    ret
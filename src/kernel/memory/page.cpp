@@ -2,37 +2,139 @@
 #include "kernel/debug/assert.h"
 #include "kernel/memory/pool.h"
 #include "kernel/stl/cstring.h"
+#include "kernel/stl/utility.h"
 
 namespace mem {
 
 namespace {
 
+/**
+ * @brief The maximum number of pages whose TLB entries are invalidated one by one when a range is unmapped.
+ *
+ * @details
+ * For larger ranges, the whole TLB is flushed instead.
+ */
+inline constexpr stl::size_t max_tlb_entry_invalidation_count {32};
+
 extern "C" {
 //! Invalidate a Translation Lookaside Buffer (TLB) entry.
 void DisableTlbEntry(stl::uintptr_t vr_addr) noexcept;
+
+//! Invalidate all Translation Lookaside Buffer (TLB) entries except global pages.
+void FlushTlb() noexcept;
+
+//! Invalidate all Translation Lookaside Buffer (TLB) entries, including global pages.
+void FlushGlobalTlb() noexcept;
+}
+
+//! Get the page table containing a virtual address, or @p nullptr if it does not exist.
+PageEntry* GetPageTab(const VrAddr vr_addr) noexcept {
+    dbg::Assert(!vr_addr.IsInLargePage(), "The virtual address is in a 4 MB page.");
+    return vr_addr.GetPageDirEntry().IsPresent()
+               ? &VrAddr {vr_addr.GetPageDirEntryIdx(), 0, 0}.GetPageTabEntry()
+               : nullptr;
+}
+
+//! Get the page table containing a virtual address, and create it if it does not exist.
+PageEntry* LoadPageTab(const VrAddr vr_addr) noexcept {
+    if (const auto page_tab {GetPageTab(vr_addr)}; page_tab) {
+        return page_tab;
+    }
+
+    // Allocate a new page for the page table.
+    const auto page_tab_phy_base {GetPhyMemPagePool(PoolType::Kernel).AllocPages()};
+    AssertAlloc(page_tab_phy_base);
+    // Make the page directory entry point to the new page table.
+    vr_addr.GetPageDirEntry()
+        .SetAddress(page_tab_phy_base)
+        .SetSupervisor(false)
+        .SetWritable()
+        .SetPresent();
+    // Clear the new page table.
+    const auto page_tab {&VrAddr {vr_addr.GetPageDirEntryIdx(), 0, 0}.GetPageTabEntry()};
+    stl::memset(page_tab, 0, page_size);
+    return page_tab;
+}
+
+//! Fill a page table entry. Kernel pages are mapped as global pages.
+void SetPageTabEntry(PageEntry& entry, const VrAddr vr_addr, const stl::uintptr_t phy_addr) noexcept {
+    dbg::Assert(!entry.IsPresent());
+    entry.SetAddress(phy_addr)
+        .SetSupervisor(false)
+        .SetWritable()
+        .SetGlobal(vr_addr >= krnl_base)
+        .SetPresent();
 }
 
 }  // namespace
 
-const VrAddr& VrAddr::MapToPhyAddr(const stl::uintptr_t phy_addr) const noexcept {
-    auto& page_dir_entry {GetPageDirEntry()};
-    auto& page_tab_entry {GetPageTabEntry()};
-    if (!page_dir_entry.IsPresent()) {
-        // Allocate a new page for the page table.
-        const auto page_tab_phy_base {GetPhyMemPagePool(PoolType::Kernel).AllocPages()};
-        AssertAlloc(page_tab_phy_base);
-        // Make the page directory entry point to the new page table.
-        page_dir_entry.SetAddress(page_tab_phy_base)
-            .SetSupervisor(false)
-            .SetWritable()
-            .SetPresent();
-        // Clear the new page table.
-        const auto page_tab_base {VrAddr {&page_tab_entry}.GetPageAddr()};
-        stl::memset(reinterpret_cast<void*>(page_tab_base), 0, page_size);
+stl::size_t MapRange(const stl::uintptr_t vr_base, const stl::size_t count,
+                     const PhyPageSource src, void* const arg) noexcept {
+    dbg::Assert(vr_base % page_size == 0 && src);
+    PageEntry* page_tab {nullptr};
+    for (stl::size_t i {0}; i != count; ++i) {
+        const VrAddr vr_addr {vr_base + i * page_size};
+        // Page tables are only looked up once for each 4 MB span.
+        if (!page_tab || vr_addr.GetPageTabEntryIdx() == 0) {
+            page_tab = LoadPageTab(vr_addr);
+        }
+
+        const auto phy_addr {src(arg)};
+        if (!phy_addr) {
+            return i;
+        }
+
+        SetPageTabEntry(page_tab[vr_addr.GetPageTabEntryIdx()], vr_addr, phy_addr);
+    }
+
+    return count;
+}
+
+void UnmapRange(const stl::uintptr_t vr_base, const stl::size_t count, const PhyPageSink sink,
+                void* const arg) noexcept {
+    dbg::Assert(vr_base % page_size == 0);
+    const auto flush_all {count > max_tlb_entry_invalidation_count};
+    stl::size_t i {0};
+    while (i < count) {
+        const VrAddr vr_addr {vr_base + i * page_size};
+        const auto page_tab {GetPageTab(vr_addr)};
+        // Unmap pages until the end of the range or the page table.
+        const auto end {
+            stl::min(count, i + page_dir_count - vr_addr.GetPageTabEntryIdx())};
+        if (!page_tab) {
+            // No page in this 4 MB span has been mapped.
+            i = end;
+            continue;
+        }
+
+        for (; i != end; ++i) {
+            const VrAddr page {vr_base + i * page_size};
+            auto& entry {page_tab[page.GetPageTabEntryIdx()]};
+            if (!entry.IsPresent()) {
+                // A reserved page is not mapped until it is accessed.
+                continue;
+            }
+
+            if (sink) {
+                sink(entry.GetAddress(), arg);
+            }
+
+            entry.SetPresent(false);
+            if (!flush_all) {
+                DisableTlbEntry(page);
+            }
+        }
+    }
+
+    if (flush_all) {
+        // Kernel pages are global and not flushed by reloading `CR3`.
+        vr_base >= krnl_base ? FlushGlobalTlb() : FlushTlb();
     }
+}
 
-    dbg::Assert(!page_tab_entry.IsPresent());
-    page_tab_entry.SetAddress(phy_addr).SetSupervisor(false).SetWritable().SetPresent();
+const VrAddr& VrAddr::MapToPhyAddr(const stl::uintptr_t phy_addr) const noexcept {
+    const auto page_tab {LoadPageTab(*this)};
+    SetPageTabEntry(page_tab[GetPageTabEntryIdx()], *this, phy_addr);
     return *this;
 }
 
@@ -45,6 +147,7 @@ VrAddr& VrAddr::Unmap() noexcept {
 }
 
 const VrAddr& VrAddr::Unmap() const noexcept {
+    dbg::Assert(!IsInLargePage(), "The virtual address is in a 4 MB page.");
     if (GetPageDirEntry().IsPresent()) {
         GetPageTabEntry().SetPresent(false);
         DisableTlbEntry(addr_);
@@ -53,7 +156,20 @@ const VrAddr& VrAddr::Unmap() const noexcept {
     return *this;
 }
 
+VrAddr& VrAddr::FlushTlb() noexcept {
+    return const_cast<VrAddr&>(const_cast<const VrAddr&>(*this).FlushTlb());
+}
+
+const VrAddr& VrAddr::FlushTlb() const noexcept {
+    DisableTlbEntry(addr_);
+    return *this;
+}
+
 stl::uintptr_t VrAddr::GetPhyAddr() const noexcept {
+    if (IsInLargePage()) {
+        return GetPageDirEntry().GetAddress() + addr_ % large_page_size;
+    }
+
     return GetPageTabEntry().GetAddress() + GetOffset();
 }
 
@@ -1,25 +1,90 @@
 #include "kernel/memory/pool.h"
 #include "kernel/debug/assert.h"
-#include "kernel/descriptor/desc.h"
-#include "kernel/descriptor/gdt/idx.h"
+#include "kernel/debug/trace.h"
+#include "kernel/io/file/map.h"
+#include "kernel/io/io.h"
 #include "kernel/io/video/print.h"
 #include "kernel/krnl.h"
+#include "kernel/loader.h"
 #include "kernel/memory/page.h"
+#include "kernel/memory/shrink.h"
+#include "kernel/memory/slab.h"
 #include "kernel/process/proc.h"
+#include "kernel/stl/algorithm.h"
 #include "kernel/stl/utility.h"
 #include "kernel/thread/thd.h"
 #include "kernel/util/bit.h"
+#include "kernel/util/metric.h"
 
 namespace mem {
 
 namespace {
 
-//! The base address of bitmap memory.
-inline constexpr stl::uintptr_t bitmap_base {krnl_base + 0x0009A000};
-
 //! The base address of kernel heap memory.
 inline constexpr stl::uintptr_t krnl_heap_base {krnl_base + 0x00100000};
 
+//! The end address of kernel heap memory, where page tables are mapped by the last page directory entry.
+inline constexpr stl::uintptr_t krnl_heap_end {krnl_base + krnl_page_dir_count * large_page_size};
+
+//! The number of bits to shift a physical address to get its page index.
+inline constexpr stl::size_t page_shift {12};
+
+static_assert(static_cast<stl::size_t>(1) << page_shift == page_size);
+
+//! A region of continuous usable physical pages.
+struct MemRegion {
+    stl::size_t GetEnd() const noexcept {
+        return begin + count;
+    }
+
+    //! The index of the first page.
+    stl::size_t begin;
+    stl::size_t count;
+};
+
+using MemRegions = stl::array<MemRegion, max_mem_map_count>;
+
+//! The backend of physical memory page pools.
+inline constexpr auto phy_mem_pool_backend {PhyMemPagePool::Backend::Bitmap};
+
+//! Block sizes of memory block descriptors.
+inline constexpr stl::size_t block_sizes[] {16,  24,  32,  40,  48,  56,  64,  80,
+                                            96,  112, 128, 160, 192, 224, 256, 320,
+                                            384, 448, 512, 640, 768, 896, 1024};
+
+static_assert(sizeof(block_sizes) / sizeof(stl::size_t) == MemBlockDescTab::count);
+static_assert(block_sizes[0] == MemBlockDescTab::min_block_size);
+static_assert(block_sizes[MemBlockDescTab::count - 1] == MemBlockDescTab::max_block_size);
+
+//! The number of entries in the descriptor lookup table.
+inline constexpr stl::size_t desc_idx_count {
+    MemBlockDescTab::max_block_size / MemBlockDescTab::block_size_step + 1};
+
+/**
+ * @brief Create a table mapping a size to the index of the smallest suitable descriptor.
+ *
+ * @details
+ * The entry @p i is for sizes in @p ((i-1)*block_size_step, i*block_size_step].
+ */
+constexpr stl::array<stl::uint8_t, desc_idx_count> CreateDescIdxTab() noexcept {
+    stl::array<stl::uint8_t, desc_idx_count> idxs {};
+    stl::size_t desc_idx {0};
+    for (stl::size_t i {0}; i != idxs.size(); ++i) {
+        while (block_sizes[desc_idx] < i * MemBlockDescTab::block_size_step) {
+            ++desc_idx;
+        }
+
+        idxs[i] = static_cast<stl::uint8_t>(desc_idx);
+    }
+
+    return idxs;
+}
+
+//! The index of the smallest suitable descriptor for each size step.
+inline constexpr auto desc_idxs {CreateDescIdxTab()};
+
+static_assert(block_sizes[desc_idxs[520 / MemBlockDescTab::block_size_step]] == 640);
+
 class MemArena;
 
 /**
@@ -159,50 +224,88 @@ bool IsKrnlMem(const void* const vr_addr) noexcept {
 void FreePages(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool, void* const vr_base,
                const stl::size_t count = 1) noexcept {
     dbg::Assert(vr_base && count > 0);
-    // Virtual addresses are continous.
-    for (stl::size_t i {0}; i != count; ++i) {
-        const VrAddr vr_addr {reinterpret_cast<stl::uintptr_t>(vr_base) + i * page_size};
-        // Get the mapped physical address.
-        const auto phy_addr {vr_addr.GetPhyAddr()};
-        dbg::Assert(phy_addr % page_size == 0);
-        // Free the mapped physical page.
-        mem_pool.FreePages(phy_addr);
-        // Clear the page table entry.
-        vr_addr.Unmap();
-    }
+    // Clear page table entries and free mapped physical pages.
+    // A reserved page is not mapped until it is accessed, so it is skipped.
+    UnmapRange(
+        reinterpret_cast<stl::uintptr_t>(vr_base), count,
+        [](const stl::uintptr_t phy_addr, void* const mem_pool) noexcept {
+            dbg::Assert(phy_addr % page_size == 0);
+            static_cast<PhyMemPagePool*>(mem_pool)->FreePages(phy_addr);
+        },
+        &mem_pool);
 
     // Free continous virtual addresses.
     addr_pool.FreePages(reinterpret_cast<stl::uintptr_t>(vr_base), count);
 }
 
-void* AllocPages(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool,
-                 const stl::size_t count = 1) noexcept {
-    // Allocate continous virtual addresses.
-    const auto vr_base {addr_pool.AllocPages(count)};
-    if (!vr_base) {
-        return nullptr;
+/**
+ * @brief Map allocated virtual pages to physical pages.
+ *
+ * @details
+ * If physical pages are insufficient, both physical pages and virtual addresses are freed.
+ *
+ * @param zeroed Whether to zero pages. Zeroed pages are taken from the zeroed page cache first.
+ * @return Whether the pages have been mapped.
+ */
+bool MapPages(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool, const stl::uintptr_t vr_base,
+              const stl::size_t count, const bool zeroed) noexcept {
+    constexpr auto alloc_phy_page {[](void* const mem_pool) noexcept {
+        return static_cast<PhyMemPagePool*>(mem_pool)->AllocPages();
+    }};
+
+    // Zeroed pages are also used when the pool has no other free pages.
+    constexpr auto alloc_any_phy_page {[](void* const mem_pool) noexcept {
+        auto& pool {*static_cast<PhyMemPagePool*>(mem_pool)};
+        if (pool.GetFreeCount() > 0) {
+            return pool.AllocPages();
+        } else {
+            auto& zeroed_pages {pool.GetZeroedPages()};
+            return zeroed_pages.IsEmpty() ? 0 : zeroed_pages.Pop();
+        }
+    }};
+
+    constexpr auto pop_zeroed_page {[](void* const zeroed_pages) noexcept {
+        return static_cast<ZeroedPageCache*>(zeroed_pages)->Pop();
+    }};
+
+    // Map new pages first, then pages from the zeroed page cache.
+    // So only the leading new pages need to be zeroed.
+    auto& zeroed_pages {mem_pool.GetZeroedPages()};
+    const auto pre_zeroed_count {zeroed ? stl::min(zeroed_pages.GetCount(), count) : 0};
+    const auto new_count {count - pre_zeroed_count};
+    auto mapped_count {MapRange(vr_base, new_count, zeroed ? +alloc_phy_page : +alloc_any_phy_page,
+                                &mem_pool)};
+    if (mapped_count == new_count) {
+        if (zeroed) {
+            stl::memset(reinterpret_cast<void*>(vr_base), 0, new_count * page_size);
+        }
+
+        mapped_count += MapRange(vr_base + new_count * page_size, pre_zeroed_count,
+                                 pop_zeroed_page, &zeroed_pages);
     }
 
-    for (stl::size_t i {0}; i != count; ++i) {
-        // Allocate a physical page.
-        if (const auto phy_page {mem_pool.AllocPages()}; phy_page) {
-            // Map the virtual address to the physical page.
-            const auto vr_addr {vr_base + i * page_size};
-            VrAddr {vr_addr}.MapToPhyAddr(phy_page);
-        } else {
-            // Failed to allocate.
-            if (i > 0) {
-                // Free allocated physical pages and virtual addresses.
-                FreePages(mem_pool, addr_pool, reinterpret_cast<void*>(vr_base), i);
-                const auto unmap_vr_base {vr_base + i * page_size};
-                addr_pool.FreePages(unmap_vr_base, count - i);
-            }
+    if (mapped_count != count) {
+        // Failed to allocate. Free allocated physical pages and virtual addresses.
+        FreePages(mem_pool, addr_pool, reinterpret_cast<void*>(vr_base), count);
+        return false;
+    }
 
-            return nullptr;
-        }
+    return true;
+}
+
+/**
+ * @brief Allocate virtual pages and map them to physical pages.
+ *
+ * @param zeroed Whether to zero pages. Zeroed pages are taken from the zeroed page cache first.
+ */
+void* AllocPages(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool, const stl::size_t count = 1,
+                 const bool zeroed = true) noexcept {
+    // Allocate continous virtual addresses.
+    const auto vr_base {addr_pool.AllocPages(count)};
+    if (!vr_base || !MapPages(mem_pool, addr_pool, vr_base, count, zeroed)) {
+        return nullptr;
     }
 
-    stl::memset(reinterpret_cast<void*>(vr_base), 0, page_size * count);
     return reinterpret_cast<void*>(vr_base);
 }
 
@@ -218,178 +321,1031 @@ void* AllocPageAtAddr(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool,
     }
 }
 
+/**
+ * @brief Reserve a number of continous virtual addresses.
+ *
+ * @details
+ * Physical pages will be mapped by @p MapPageOnDemand.
+ */
+void* ReservePages(VrAddrPool& addr_pool, const stl::size_t count = 1) noexcept {
+    return reinterpret_cast<void*>(addr_pool.AllocPages(count));
+}
+
 //! Get the pool type according to the current thread privilege.
 PoolType GetDefaultPoolType() noexcept {
     return tsk::Thread::GetCurrent().IsKrnlThread() ? PoolType::Kernel : PoolType::User;
 }
 
 /**
- * @brief A wrapper of a global @p bool variable representing whether memory management has been initialized.
+ * @brief A wrapper of a global variable saving memory block magazines of threads.
  *
  * @details
  * Global variables cannot be initialized properly.
  * We use @p static variables in methods instead since they can be initialized by methods.
  */
-bool& IsMemInitedImpl() noexcept {
-    static bool inited {false};
-    return inited;
+SlabCache<MemBlockMagazines>& GetMagazineCache() noexcept {
+    static SlabCache<MemBlockMagazines> cache {"magazine"};
+    return cache;
 }
 
-}  // namespace
+/**
+ * @brief Get the magazine of the current thread for a block descriptor.
+ *
+ * @details
+ * A thread only caches blocks from its default memory pool.
+ * For other pools, foreign descriptors, or before threads have been initialized, it returns @p nullptr.
+ * Magazines are allocated on first use. If they cannot be allocated, it also returns @p nullptr.
+ */
+MemBlockMagazine* GetCurrMagazine(const PoolType type, const MemBlockDesc& desc) noexcept {
+    if (!tsk::IsThreadInited() || type != GetDefaultPoolType()) {
+        return nullptr;
+    }
 
-PoolType GetSrcMemPool(const stl::uintptr_t phy_addr) noexcept {
-    return IsKrnlMem(phy_addr) ? PoolType::Kernel : PoolType::User;
-}
+    const auto& descs {GetMemBlockDescTab(type)};
+    if (&desc < descs.begin() || descs.end() <= &desc) {
+        return nullptr;
+    }
 
-PoolType GetSrcMemPool(const void* const vr_addr) noexcept {
-    return GetSrcMemPool(VrAddr {vr_addr}.GetPhyAddr());
-}
+    auto& thd {tsk::Thread::GetCurrent()};
+    auto mags {thd.GetMemBlockMagazines()};
+    if (!mags) {
+        // The slab cache only allocates pages, so it does not use magazines itself.
+        if (mags = GetMagazineCache().Allocate(); !mags) {
+            return nullptr;
+        }
 
-const MemBlockDesc& MemBlockDescTab::operator[](const stl::size_t idx) const noexcept {
-    dbg::Assert(idx < count);
-    return descs_[idx];
-}
+        thd.SetMemBlockMagazines(&mags->Clear());
+    }
 
-MemBlockDesc* MemBlockDescTab::GetMinDesc(const stl::size_t size) noexcept {
-    return const_cast<MemBlockDesc*>(const_cast<const MemBlockDescTab&>(*this).GetMinDesc(size));
+    const auto idx {static_cast<stl::size_t>(&desc - descs.begin())};
+    return &(*mags)[idx];
 }
 
-const MemBlockDesc* MemBlockDescTab::GetMinDesc(const stl::size_t size) const noexcept {
-    for (const auto& desc : descs_) {
-        if (size <= desc.GetBlockSize()) {
-            return &desc;
+/**
+ * @brief Remove a block from the free block list of a descriptor.
+ *
+ * @details
+ * If the free block list is empty, a new arena is allocated and all its blocks are added to the list.
+ * The memory pool must be locked.
+ */
+MemBlock& AllocBlock(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool, MemBlockDesc& desc) noexcept {
+    const auto new_arena {desc.GetFreeBlockList().IsEmpty()};
+    if (new_arena) {
+        // Allocate a new arena if the free block list of the descriptor is empty.
+        // Blocks are zeroed when they are allocated, so the arena does not need to be zeroed.
+        const auto arena {static_cast<MemArena*>(AllocPages(mem_pool, addr_pool, 1, false))};
+        AssertAlloc(arena);
+        desc.OnArenaAlloc();
+        arena->desc = &desc;
+        // The arena is not a large arena and the count refers to the number of blocks.
+        arena->large = false;
+        arena->count = desc.GetBlockCountPerArena();
+
+        // Add all blocks to the free block list.
+        const intr::IntrGuard intr_guard;
+        for (stl::size_t i {0}; i != arena->count; ++i) {
+            auto& block {arena->GetBlock(i)};
+            dbg::AssertSlow([&] { return !desc.GetFreeBlockList().Find(block.GetTag()); });
+            desc.GetFreeBlockList().PushBack(block.GetTag());
         }
     }
 
-    return nullptr;
-}
+    dbg::Assert(!desc.GetFreeBlockList().IsEmpty());
+    auto& block {MemBlock::GetByTag(desc.GetFreeBlockList().Pop())};
+    auto& arena {block.GetArena()};
+    dbg::Assert(arena.count > 0);
+    if (arena.count-- == desc.GetBlockCountPerArena() && !new_arena) {
+        // A retained empty arena is reused.
+        desc.OnArenaReuse();
+    }
 
-MemBlockDesc& MemBlockDescTab::operator[](const stl::size_t idx) noexcept {
-    return const_cast<MemBlockDesc&>(const_cast<const MemBlockDescTab&>(*this)[idx]);
+    return block;
 }
 
-PhyMemPagePool& GetPhyMemPagePool(const PoolType type) noexcept {
-    return type == PoolType::Kernel ? GetKrnlPhyMemPagePool() : GetUsrPhyMemPagePool();
-}
+/**
+ * @brief Remove all blocks of an empty arena from the free block list and free the arena.
+ *
+ * @details
+ * The memory pool must be locked.
+ */
+void FreeEmptyArena(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool, MemArena& arena) noexcept {
+    const auto desc {arena.desc};
+    dbg::Assert(!arena.large && desc && arena.count == desc->GetBlockCountPerArena());
+    for (stl::size_t i {0}; i != arena.count; ++i) {
+        auto& block {arena.GetBlock(i)};
+        dbg::AssertSlow([&] { return desc->GetFreeBlockList().Find(block.GetTag()); });
+        block.GetTag().Detach();
+    }
 
-VrAddrPool& GetVrAddrPool(const PoolType type) noexcept {
-    return type == PoolType::Kernel ? GetKrnlVrAddrPool() : GetUsrVrAddrPool();
+    FreePages(mem_pool, addr_pool, &arena);
 }
 
-stl::size_t GetTotalMemSize() noexcept {
-    constexpr stl::uintptr_t loader_base {0x900};
-    constexpr stl::uintptr_t size_addr {loader_base + gdt::count * sizeof(desc::SegDesc)};
-    const auto size {*reinterpret_cast<const stl::size_t*>(size_addr)};
-    dbg::Assert(size > 0);
-    return size;
-}
+/**
+ * @brief Add a block to the free block list of its descriptor.
+ *
+ * @details
+ * If all blocks in the arena are free and the descriptor has retained enough empty arenas,
+ * they are removed from the free block list and the arena is freed.
+ * Otherwise, the empty arena is retained for following allocations.
+ * The memory pool must be locked.
+ */
+void FreeBlock(PhyMemPagePool& mem_pool, VrAddrPool& addr_pool, MemBlock& block) noexcept {
+    auto& arena {block.GetArena()};
+    dbg::Assert(!arena.large);
+    // Get the block descriptor.
+    const auto desc {arena.desc};
+    dbg::Assert(desc);
+    // Add the block to the free block list of the descriptor.
+    desc->GetFreeBlockList().PushBack(block.GetTag());
+
+    // All blocks in the arena are free.
+    if (++arena.count == desc->GetBlockCountPerArena()) {
+        // Retain the empty arena to avoid allocating a new page in following allocations.
+        if (desc->GetEmptyArenaCount() < desc->GetMaxEmptyArenaCount()) {
+            desc->OnArenaRetain();
+            return;
+        }
 
-bool IsMemInited() noexcept {
-    return IsMemInitedImpl();
+        desc->OnArenaFree();
+        FreeEmptyArena(mem_pool, addr_pool, arena);
+    }
 }
 
-void InitMem() noexcept {
-    dbg::Assert(!IsMemInited());
-    const auto total_mem_size {GetTotalMemSize()};
-    dbg::Assert(total_mem_size > 0);
+/**
+ * @brief Free retained empty arenas of a memory pool until enough pages are released.
+ *
+ * @details
+ * It is a shrinker for memory reclaim. User arenas belong to the current process.
+ *
+ * @return The number of released pages.
+ */
+stl::size_t ReleaseEmptyArenas(const PoolType type, const stl::size_t page_count,
+                               void*) noexcept {
+    if (type == PoolType::User && !tsk::Thread::GetCurrent().GetProcess()) {
+        return 0;
+    }
 
-    const auto page_dir_size {page_size};
-    const auto krnl_page_tab_size {page_size * krnl_page_dir_count};
-    const auto used_mem_size {page_dir_size + krnl_page_tab_size + krnl_size};
-    const auto free_mem_size {total_mem_size - used_mem_size};
+    auto& mem_pool {GetPhyMemPagePool(type)};
+    auto& addr_pool {GetVrAddrPool(type)};
+    auto& descs {GetMemBlockDescTab(type)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    stl::size_t released {0};
+    for (auto& desc : descs) {
+        while (released != page_count && desc.GetEmptyArenaCount() != 0) {
+            // Find a free block in an empty arena.
+            const auto tag {desc.GetFreeBlockList().Find(
+                [](const TagList::Tag& tag, void* const arg) noexcept {
+                    return MemBlock::GetByTag(tag).GetArena().count
+                           == static_cast<const MemBlockDesc*>(arg)->GetBlockCountPerArena();
+                },
+                &desc)};
+            dbg::Assert(tag);
+            desc.OnArenaRelease();
+            FreeEmptyArena(mem_pool, addr_pool, MemBlock::GetByTag(*tag).GetArena());
+            ++released;
+        }
+    }
 
-    const auto free_page_count {free_mem_size / page_size};
-    // The kernel uses half of memory and users use the other half.
-    const auto krnl_free_page_count {free_page_count / 2};
-    const auto usr_free_page_count {free_page_count - krnl_free_page_count};
+    return released;
+}
 
-    const auto krnl_mem_size {krnl_free_page_count * page_size};
-    const auto krnl_mem_base {used_mem_size};
-    const auto usr_mem_base {krnl_mem_base + krnl_mem_size};
+/**
+ * @brief A wrapper of a global variable representing the kernel buffer for copying copy-on-write pages.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+void*& GetPageCopyBuf() noexcept {
+    static void* buf {nullptr};
+    return buf;
+}
 
-    const auto krnl_bitmap_len {krnl_free_page_count / bit::byte_len};
-    const auto usr_bitmap_len {usr_free_page_count / bit::byte_len};
+/**
+ * @brief A wrapper of a global variable representing the kernel virtual page for zeroing physical pages.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+void*& GetPageZeroWindow() noexcept {
+    static void* window {nullptr};
+    return window;
+}
 
-    const auto krnl_bitmap_base {bitmap_base};
-    const auto usr_bitmap_base {krnl_bitmap_base + krnl_bitmap_len};
+/**
+ * @brief Allocate virtual memory in bytes.
+ *
+ * @param zeroed Whether to zero the memory.
+ */
+void* AllocateImpl(const PoolType type, const stl::size_t size, const bool zeroed) noexcept {
+    dbg::Assert(size > 0);
+    MemBlockDesc* desc {nullptr};
+    MemBlockMagazine* mag {nullptr};
+    if (size <= MemBlockDescTab::max_block_size) {
+        // Get the suitable block descriptor.
+        desc = GetMemBlockDescTab(type).GetMinDesc(size);
+        dbg::Assert(desc);
+        // Try to take a block from the magazine of the current thread without locking.
+        if (mag = GetCurrMagazine(type, *desc); mag) {
+            const intr::IntrGuard intr_guard;
+            if (!mag->IsEmpty()) {
+                const auto block {mag->Pop()};
+                desc->OnBlockAlloc();
+                if (zeroed) {
+                    stl::memset(block, 0, desc->GetBlockSize());
+                }
+
+                return block;
+            }
+        }
+    }
 
-    auto& krnl_mem_pool {GetKrnlPhyMemPagePool()};
-    krnl_mem_pool.Init(krnl_mem_base, {reinterpret_cast<void*>(krnl_bitmap_base), krnl_bitmap_len});
+    // A block may need a new arena. User pages of large allocations are only reserved.
+    if (desc) {
+        ReclaimMem(type, 1);
+    } else if (type == PoolType::Kernel) {
+        ReclaimMem(type, CalcPageCount(size + sizeof(MemArena)));
+    }
 
-    auto& usr_mem_pool {GetUsrPhyMemPagePool()};
-    usr_mem_pool.Init(usr_mem_base, {reinterpret_cast<void*>(usr_bitmap_base), usr_bitmap_len});
+    auto& mem_pool {GetPhyMemPagePool(type)};
+    const stl::lock_guard lck_guard {mem_pool.GetLock()};
+    if ((mem_pool.GetFreeCount() + mem_pool.GetZeroedPages().GetCount()) * page_size < size) {
+        return nullptr;
+    }
 
-    auto& krnl_addr_pool {GetKrnlVrAddrPool()};
-    krnl_addr_pool.Init(krnl_heap_base, {reinterpret_cast<void*>(usr_bitmap_base + usr_bitmap_len),
-                                         krnl_bitmap_len});
+    auto& addr_pool {GetVrAddrPool(type)};
+    if (!desc) {
+        // Directly allocate a number of pages if the required size is larger than the maximum block size.
+        // User pages are only reserved. They will be mapped to zeroed physical pages on first access.
+        const auto page_count {CalcPageCount(size + sizeof(MemArena))};
+        const auto arena {static_cast<MemArena*>(
+            type == PoolType::User ? ReservePages(addr_pool, page_count)
+                                   : AllocPages(mem_pool, addr_pool, page_count, zeroed))};
+        AssertAlloc(arena);
+        arena->desc = nullptr;
+        // The arena is a large arena and the count refers to the number of pages instead of blocks.
+        arena->large = true;
+        arena->count = page_count;
+        return reinterpret_cast<stl::byte*>(arena) + sizeof(MemArena);
+    } else {
+        auto& block {AllocBlock(mem_pool, addr_pool, *desc)};
+        {
+            const intr::IntrGuard intr_guard;
+            desc->OnBlockAlloc();
+        }
 
-    IsMemInitedImpl() = true;
-    io::PrintlnStr("Memory pools have been initialized.");
-    io::Printf("\tThe memory size is 0x{}.\n", total_mem_size);
-    io::Printf("\tThe kernel physical memory addresses start from 0x{}.\n", krnl_mem_base);
-    io::Printf("\tThe user physical memory addresses start from 0x{}.\n", usr_mem_base);
-}
+        if (mag) {
+            // Refill the magazine with a batch of blocks, which avoids locking in following allocations.
+            const intr::IntrGuard intr_guard;
+            for (stl::size_t i {0};
+                 i != MemBlockMagazine::batch_size && !mag->IsFull()
+                 && !desc->GetFreeBlockList().IsEmpty();
+                 ++i) {
+                mag->Push(&AllocBlock(mem_pool, addr_pool, *desc));
+            }
+        }
 
-stl::uintptr_t VrAddrPool::AllocPages(const stl::size_t count) noexcept {
-    dbg::Assert(count > 0);
-    if (const auto bit_begin {bitmap_.Alloc(count)}; bit_begin != npos) {
-        dbg::Assert(free_count_ >= count);
-        free_count_ -= count;
-        return start_vr_addr_ + bit_begin * page_size;
-    } else {
-        return 0;
+        if (zeroed) {
+            stl::memset(&block, 0, desc->GetBlockSize());
+        }
+
+        return &block;
     }
 }
 
-stl::uintptr_t VrAddrPool::AllocPageAtAddr(const stl::uintptr_t vr_addr) noexcept {
-    const auto align_vr_addr {AlignToPageBase(vr_addr)};
-    const auto bit_idx {(align_vr_addr - start_vr_addr_) / page_size};
-    bitmap_.ForceAlloc(bit_idx, 1);
-    dbg::Assert(free_count_ >= 1);
-    free_count_ -= 1;
-    return align_vr_addr;
-}
+/**
+ * @brief Grow a large arena in place by allocating the following virtual pages.
+ *
+ * @details
+ * New kernel pages are mapped and zeroed. New user pages are only reserved.
+ *
+ * @param page_count The new number of pages.
+ * @return Whether the arena has grown.
+ */
+bool GrowLargeArena(const PoolType type, MemArena& arena, const stl::size_t page_count) noexcept {
+    dbg::Assert(arena.large && page_count > arena.count);
+    if (type == PoolType::Kernel) {
+        ReclaimMem(type, page_count - arena.count);
+    }
 
-stl::size_t VrAddrPool::GetFreeCount() const noexcept {
-    return free_count_;
-}
+    auto& mem_pool {GetPhyMemPagePool(type)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    auto& addr_pool {GetVrAddrPool(type)};
+    const auto tail {reinterpret_cast<stl::uintptr_t>(&arena) + arena.count * page_size};
+    const auto tail_count {page_count - arena.count};
+    if (!addr_pool.AllocPagesAtAddr(tail, tail_count)) {
+        return false;
+    }
 
-stl::uintptr_t VrAddrPool::GetStartAddr() const noexcept {
-    return start_vr_addr_;
-}
+    if (type == PoolType::Kernel && !MapPages(mem_pool, addr_pool, tail, tail_count, true)) {
+        return false;
+    }
 
-VrAddrPool::VrAddrPool(const stl::uintptr_t start_vr_addr, Bitmap bitmap) noexcept {
-    Init(start_vr_addr, stl::move(bitmap));
+    arena.count = page_count;
+    return true;
 }
 
-VrAddrPool& VrAddrPool::Init(const stl::uintptr_t start_vr_addr, Bitmap bitmap) noexcept {
-    start_vr_addr_ = start_vr_addr;
-    bitmap_ = stl::move(bitmap);
-    free_count_ = bitmap_.GetCapacity();
-    return *this;
-}
+/**
+ * @brief Zero a free physical page and save it in the zeroed page cache of a memory pool.
+ *
+ * @return Whether a page has been zeroed.
+ */
+bool FillZeroedPage(const PoolType type) noexcept {
+    auto& mem_pool {GetPhyMemPagePool(type)};
+    // Do not block the idle thread.
+    if (!mem_pool.GetLock().try_lock()) {
+        return false;
+    }
 
-VrAddrPool& VrAddrPool::FreePages(const stl::uintptr_t vr_base, const stl::size_t count) noexcept {
-    dbg::Assert(count > 0);
-    dbg::Assert(vr_base >= start_vr_addr_ && vr_base % page_size == 0);
-    const auto bit_idx {(vr_base - start_vr_addr_) / page_size};
-    bitmap_.Free(bit_idx, count);
-    free_count_ += count;
-    return *this;
-}
+    const auto phy_page {!mem_pool.GetZeroedPages().IsFull() ? mem_pool.AllocPages() : 0};
+    mem_pool.GetLock().unlock();
+    if (!phy_page) {
+        return false;
+    }
 
-const Bitmap& VrAddrPool::GetBitmap() const noexcept {
-    return bitmap_;
-}
+    // Temporarily map the zeroing window to the physical page.
+    const auto window {GetPageZeroWindow()};
+    dbg::Assert(window);
+    VrAddr vr_addr {window};
+    auto& page_tab_entry {vr_addr.GetPageTabEntry()};
+    const auto window_phy_page {page_tab_entry.GetAddress()};
+    page_tab_entry.SetAddress(phy_page);
+    vr_addr.FlushTlb();
+    stl::memset(window, 0, page_size);
+    page_tab_entry.SetAddress(window_phy_page);
+    vr_addr.FlushTlb();
 
-stl::uintptr_t PhyMemPagePool::AllocPages(const stl::size_t count) noexcept {
-    dbg::Assert(count > 0);
-    if (const auto bit_begin {bitmap_.Alloc(count)}; bit_begin != npos) {
-        dbg::Assert(free_count_ >= count);
-        free_count_ -= count;
-        return start_phy_addr_ + bit_begin * page_size;
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    if (mem_pool.GetZeroedPages().IsFull()) {
+        mem_pool.FreePages(phy_page);
+        return false;
     } else {
-        return 0;
+        mem_pool.GetZeroedPages().Push(phy_page);
+        return true;
+    }
+}
+
+/**
+ * @brief The page fault handler.
+ *
+ * @details
+ * It loads pages of memory-mapped files and executable images, maps reserved pages and makes copy-on-write pages writable.
+ * Other page faults are passed to the default interrupt handler.
+ */
+void PageFaultHandler(const stl::size_t intr_num) noexcept {
+    if (const auto vr_addr {io::GetCr2()};
+        !io::FileMap::LoadPage(vr_addr) && !tsk::Image::LoadPage(vr_addr)
+        && !MapPageOnDemand(vr_addr) && !CopyPageOnWrite(vr_addr)) {
+        intr::DefaultIntrHandler(intr_num);
+    }
+}
+
+/**
+ * @brief A wrapper of a global @p bool variable representing whether memory management has been initialized.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+bool& IsMemInitedImpl() noexcept {
+    static bool inited {false};
+    return inited;
+}
+
+/**
+ * @brief Add a region of pages to sorted regions and merge it with overlapped or adjacent ones.
+ *
+ * @details
+ * If regions are full, a region that cannot be merged is dropped.
+ *
+ * @param regions Sorted regions.
+ * @param count The number of regions.
+ * @param begin The index of the first page.
+ * @param end The index after the last page.
+ */
+void AddMemRegion(MemRegions& regions, stl::size_t& count, stl::size_t begin,
+                  stl::size_t end) noexcept {
+    dbg::Assert(begin < end);
+    // Find the first region that does not end before the new one.
+    stl::size_t first {0};
+    while (first != count && regions[first].GetEnd() < begin) {
+        ++first;
+    }
+
+    // Find regions that can be merged.
+    auto last {first};
+    while (last != count && regions[last].begin <= end) {
+        begin = stl::min(begin, regions[last].begin);
+        end = stl::max(end, regions[last].GetEnd());
+        ++last;
+    }
+
+    if (first == last) {
+        if (count == regions.size()) {
+            return;
+        }
+
+        for (auto i {count}; i != first; --i) {
+            regions[i] = regions[i - 1];
+        }
+
+        ++count;
+    } else {
+        // Merged regions are replaced by the first one.
+        const auto removed {last - first - 1};
+        for (auto i {last}; i != count; ++i) {
+            regions[i - removed] = regions[i];
+        }
+
+        count -= removed;
+    }
+
+    regions[first] = {begin, end - begin};
+}
+
+/**
+ * @brief Get sorted usable memory regions from the memory map saved by the loader.
+ *
+ * @details
+ * Memory above 4 GB is ignored since it cannot be accessed without physical address extension.
+ * If BIOS does not report a memory map, memory below the total memory size is a region.
+ *
+ * @param[out] regions Usable regions.
+ * @param min_page The index of the first page that can be used.
+ * @return The number of regions.
+ */
+stl::size_t GetUsableMemRegions(MemRegions& regions, const stl::size_t min_page) noexcept {
+    constexpr stl::uint64_t max_phy_addr {static_cast<stl::uint64_t>(1) << 32};
+    const auto& loader_data {GetLoaderData()};
+    dbg::Assert(loader_data.mem_map_count <= loader_data.mem_map.size());
+    stl::size_t count {0};
+    if (loader_data.mem_map_count == 0) {
+        if (const auto end {GetTotalMemSize() / page_size}; min_page < end) {
+            AddMemRegion(regions, count, min_page, end);
+        }
+
+        return count;
+    }
+
+    for (stl::size_t i {0}; i != loader_data.mem_map_count; ++i) {
+        const auto& desc {loader_data.mem_map[i]};
+        const auto base {desc.GetBase()};
+        if (!desc.IsUsable() || base >= max_phy_addr) {
+            continue;
+        }
+
+        // Pages partially in the range cannot be used.
+        const auto end {stl::min(base + desc.GetLen(), max_phy_addr)};
+        const auto begin_page {
+            stl::max(static_cast<stl::size_t>((base + page_size - 1) >> page_shift), min_page)};
+        if (const auto end_page {static_cast<stl::size_t>(end >> page_shift)};
+            begin_page < end_page) {
+            AddMemRegion(regions, count, begin_page, end_page);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Reserve pages of a pool that are not in usable regions.
+ *
+ * @param regions Sorted usable regions.
+ * @param count The number of regions.
+ */
+void ReserveMemHoles(PhyMemPagePool& mem_pool, const MemRegions& regions,
+                     const stl::size_t count) noexcept {
+    const auto begin {mem_pool.GetStartAddr() >> page_shift};
+    const auto end {begin + mem_pool.GetPageCount()};
+    auto hole_begin {begin};
+    for (stl::size_t i {0}; i != count && hole_begin < end; ++i) {
+        if (const auto hole_end {stl::min(regions[i].begin, end)}; hole_begin < hole_end) {
+            mem_pool.ReservePages(hole_begin * page_size, hole_end - hole_begin);
+        }
+
+        hole_begin = stl::max(hole_begin, regions[i].GetEnd());
+    }
+
+    if (hole_begin < end) {
+        mem_pool.ReservePages(hole_begin * page_size, end - hole_begin);
+    }
+}
+
+}  // namespace
+
+PoolType GetSrcMemPool(const stl::uintptr_t phy_addr) noexcept {
+    return IsKrnlMem(phy_addr) ? PoolType::Kernel : PoolType::User;
+}
+
+PoolType GetSrcMemPool(const void* const vr_addr) noexcept {
+    return GetSrcMemPool(VrAddr {vr_addr}.GetPhyAddr());
+}
+
+const MemBlockDesc& MemBlockDescTab::operator[](const stl::size_t idx) const noexcept {
+    dbg::Assert(idx < count);
+    return descs_[idx];
+}
+
+MemBlockDesc* MemBlockDescTab::GetMinDesc(const stl::size_t size) noexcept {
+    return const_cast<MemBlockDesc*>(const_cast<const MemBlockDescTab&>(*this).GetMinDesc(size));
+}
+
+const MemBlockDesc* MemBlockDescTab::GetMinDesc(const stl::size_t size) const noexcept {
+    if (size > max_block_size) {
+        return nullptr;
+    }
+
+    const auto step {(size + block_size_step - 1) / block_size_step};
+    return &descs_[desc_idxs[step]];
+}
+
+stl::size_t MemBlockDescTab::GetBlockSize(const stl::size_t idx) noexcept {
+    dbg::Assert(idx < count);
+    return block_sizes[idx];
+}
+
+MemBlockDesc& MemBlockDescTab::operator[](const stl::size_t idx) noexcept {
+    return const_cast<MemBlockDesc&>(const_cast<const MemBlockDescTab&>(*this)[idx]);
+}
+
+PhyMemPagePool& GetPhyMemPagePool(const PoolType type) noexcept {
+    return type == PoolType::Kernel ? GetKrnlPhyMemPagePool() : GetUsrPhyMemPagePool();
+}
+
+VrAddrPool& GetVrAddrPool(const PoolType type) noexcept {
+    return type == PoolType::Kernel ? GetKrnlVrAddrPool() : GetUsrVrAddrPool();
+}
+
+stl::size_t GetTotalMemSize() noexcept {
+    const stl::size_t size {GetLoaderData().total_mem_size};
+    dbg::Assert(size > 0);
+    return size;
+}
+
+bool IsMemInited() noexcept {
+    return IsMemInitedImpl();
+}
+
+void InitMem() noexcept {
+    dbg::Assert(!IsMemInited());
+    const auto total_mem_size {GetTotalMemSize()};
+    dbg::Assert(total_mem_size > 0);
+
+    const auto page_dir_size {page_size};
+    const auto krnl_page_tab_size {page_size * krnl_page_dir_count};
+    const auto used_mem_size {page_dir_size + krnl_page_tab_size + krnl_size};
+
+    MemRegions regions;
+    const auto region_count {GetUsableMemRegions(regions, used_mem_size / page_size)};
+    dbg::Assert(region_count > 0, "No usable memory is found.");
+    stl::size_t free_page_count {0};
+    for (stl::size_t i {0}; i != region_count; ++i) {
+        free_page_count += regions[i].count;
+    }
+
+    // The kernel uses half of usable memory and users use the other half.
+    // Kernel pages are also limited to half of the kernel heap,
+    // so pool metadata and mappings without physical pages have virtual addresses.
+    const auto krnl_heap_page_count {(krnl_heap_end - krnl_heap_base) / page_size};
+    const auto krnl_free_page_count {stl::min(free_page_count / 2, krnl_heap_page_count / 2)};
+
+    // Each pool spans from its first usable page to its last one, including holes between regions.
+    // The lengths are multiples of the bitmap byte length.
+    const auto first_page {regions[0].begin};
+    const auto last_page {regions[region_count - 1].GetEnd()};
+    auto krnl_end_page {first_page};
+    for (stl::size_t i {0}, left {krnl_free_page_count}; left > 0; ++i) {
+        const auto count {stl::min(left, regions[i].count)};
+        krnl_end_page = regions[i].begin + count;
+        left -= count;
+    }
+
+    const auto krnl_page_count {BackwardAlign(krnl_end_page - first_page, bit::byte_len)};
+    const auto usr_page_count {
+        BackwardAlign(last_page - first_page - krnl_page_count, bit::byte_len)};
+    dbg::Assert(krnl_page_count > 0 && usr_page_count > 0, "The memory is too small.");
+    const auto krnl_mem_base {first_page * page_size};
+    const auto usr_mem_base {krnl_mem_base + krnl_page_count * page_size};
+
+    // The length of the kernel virtual address bitmap.
+    const auto krnl_bitmap_len {krnl_page_count / bit::byte_len};
+    // The lengths of the physical memory page bitmaps.
+    const auto krnl_phy_bitmap_len {phy_mem_pool_backend == PhyMemPagePool::Backend::Buddy
+                                        ? BuddyAllocator::CalcBitmapByteLen(krnl_page_count)
+                                        : krnl_bitmap_len};
+    const auto usr_phy_bitmap_len {phy_mem_pool_backend == PhyMemPagePool::Backend::Buddy
+                                       ? BuddyAllocator::CalcBitmapByteLen(usr_page_count)
+                                       : usr_page_count / bit::byte_len};
+
+    // Bitmaps are saved in the first kernel pages, which are mapped at the beginning of the kernel heap.
+    const auto meta_page_count {
+        CalcPageCount(krnl_phy_bitmap_len + usr_phy_bitmap_len + krnl_bitmap_len)};
+    dbg::Assert(meta_page_count <= regions[0].count && meta_page_count < krnl_page_count,
+                "The first usable memory region is too small.");
+    auto meta_phy_addr {krnl_mem_base};
+    const auto mapped_count {MapRange(
+        krnl_heap_base, meta_page_count,
+        [](void* const arg) noexcept {
+            auto& phy_addr {*static_cast<stl::uintptr_t*>(arg)};
+            const auto page {phy_addr};
+            phy_addr += page_size;
+            return page;
+        },
+        &meta_phy_addr)};
+    dbg::Assert(mapped_count == meta_page_count);
+
+    const auto krnl_bitmap_base {krnl_heap_base};
+    const auto usr_bitmap_base {krnl_bitmap_base + krnl_phy_bitmap_len};
+
+    auto& krnl_mem_pool {GetKrnlPhyMemPagePool()};
+    auto& usr_mem_pool {GetUsrPhyMemPagePool()};
+    if constexpr (phy_mem_pool_backend == PhyMemPagePool::Backend::Buddy) {
+        krnl_mem_pool.Init(krnl_mem_base, reinterpret_cast<void*>(krnl_bitmap_base),
+                           krnl_page_count);
+        usr_mem_pool.Init(usr_mem_base, reinterpret_cast<void*>(usr_bitmap_base), usr_page_count);
+    } else {
+        krnl_mem_pool.Init(krnl_mem_base,
+                           {reinterpret_cast<void*>(krnl_bitmap_base), krnl_phy_bitmap_len});
+        usr_mem_pool.Init(usr_mem_base,
+                          {reinterpret_cast<void*>(usr_bitmap_base), usr_phy_bitmap_len});
+    }
+
+    krnl_mem_pool.GetLock().set_name("mem::PhyMemPagePool (kernel)");
+    usr_mem_pool.GetLock().set_name("mem::PhyMemPagePool (user)");
+    krnl_mem_pool.ReservePages(krnl_mem_base, meta_page_count);
+    ReserveMemHoles(krnl_mem_pool, regions, region_count);
+    ReserveMemHoles(usr_mem_pool, regions, region_count);
+
+    auto& krnl_addr_pool {GetKrnlVrAddrPool()};
+    krnl_addr_pool.Init(krnl_heap_base + meta_page_count * page_size,
+                        {reinterpret_cast<void*>(usr_bitmap_base + usr_phy_bitmap_len),
+                         krnl_bitmap_len});
+
+    // User pages can be shared by processes after forking.
+    const auto ref_counts {AllocPages(PoolType::Kernel, CalcPageCount(usr_page_count))};
+    AssertAlloc(ref_counts);
+    usr_mem_pool.InitRefCounts(ref_counts);
+
+    GetPageCopyBuf() = AllocPages(PoolType::Kernel);
+    AssertAlloc(GetPageCopyBuf());
+    GetPageZeroWindow() = AllocPages(PoolType::Kernel);
+    AssertAlloc(GetPageZeroWindow());
+    intr::GetIntrHandlerTab().Register(intr::Intr::PageFault, &PageFaultHandler);
+    RegisterShrinker(&ReleaseEmptyArenas);
+
+    IsMemInitedImpl() = true;
+    io::PrintlnStr("Memory pools have been initialized.");
+    io::Printf("\tThe memory size is 0x{}.\n", total_mem_size);
+    io::Printf("\tThe usable memory size is 0x{} in 0x{} regions.\n", free_page_count * page_size,
+               region_count);
+    io::Printf("\tThe kernel physical memory addresses start from 0x{}.\n", krnl_mem_base);
+    io::Printf("\tThe user physical memory addresses start from 0x{}.\n", usr_mem_base);
+}
+
+struct VrAddrPool::Range {
+    stl::size_t GetEnd() const noexcept {
+        return begin + count;
+    }
+
+    //! The index of the first page.
+    stl::size_t begin;
+    stl::size_t count;
+    Range* next;
+};
+
+SlabCacheBase& VrAddrPool::GetRangeCache() noexcept {
+    static SlabCache<Range> cache {"vr_addr_range"};
+    return cache;
+}
+
+stl::uintptr_t VrAddrPool::AllocPages(const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    if (free_count_ < count) {
+        return 0;
+    }
+
+    stl::size_t page_begin {npos};
+    if (backend_ == Backend::Bitmap) {
+        page_begin = bitmap_.Alloc(count);
+    } else {
+        // Find the first gap that is large enough.
+        stl::size_t gap_begin {0};
+        for (auto range {ranges_}; range; range = range->next) {
+            if (range->begin - gap_begin >= count) {
+                break;
+            }
+
+            gap_begin = range->GetEnd();
+        }
+
+        if (page_count_ - gap_begin >= count) {
+            page_begin = gap_begin;
+            AllocRange(page_begin, count);
+        }
+    }
+
+    if (page_begin != npos) {
+        dbg::Assert(free_count_ >= count);
+        free_count_ -= count;
+        return start_vr_addr_ + page_begin * page_size;
+    } else {
+        return 0;
+    }
+}
+
+stl::uintptr_t VrAddrPool::AllocPageAtAddr(const stl::uintptr_t vr_addr) noexcept {
+    const auto align_vr_addr {AlignToPageBase(vr_addr)};
+    const auto page_idx {(align_vr_addr - start_vr_addr_) / page_size};
+    if (backend_ == Backend::Bitmap) {
+        bitmap_.ForceAlloc(page_idx, 1);
+    } else {
+        dbg::Assert(page_idx < page_count_);
+        dbg::Assert(!IsAlloc(align_vr_addr), "The page has been allocated.");
+        AllocRange(page_idx, 1);
+    }
+
+    dbg::Assert(free_count_ >= 1);
+    free_count_ -= 1;
+    return align_vr_addr;
+}
+
+stl::uintptr_t VrAddrPool::AllocPagesAtAddr(const stl::uintptr_t vr_base,
+                                            const stl::size_t count) noexcept {
+    dbg::Assert(count > 0 && vr_base % page_size == 0);
+    if (vr_base < start_vr_addr_) {
+        return 0;
+    }
+
+    const auto page_begin {(vr_base - start_vr_addr_) / page_size};
+    if (!IsFree(page_begin, count)) {
+        return 0;
+    }
+
+    if (backend_ == Backend::Bitmap) {
+        bitmap_.ForceAlloc(page_begin, count);
+    } else {
+        AllocRange(page_begin, count);
+    }
+
+    dbg::Assert(free_count_ >= count);
+    free_count_ -= count;
+    return vr_base;
+}
+
+bool VrAddrPool::IsFree(const stl::size_t page_begin, const stl::size_t count) const noexcept {
+    const auto page_end {page_begin + count};
+    if (backend_ == Backend::Bitmap) {
+        if (page_end > bitmap_.GetCapacity()) {
+            return false;
+        }
+
+        for (auto i {page_begin}; i != page_end; ++i) {
+            if (bitmap_.IsAlloc(i)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    if (page_end > page_count_) {
+        return false;
+    }
+
+    for (auto range {ranges_}; range && range->begin < page_end; range = range->next) {
+        if (page_begin < range->GetEnd()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool VrAddrPool::IsAlloc(const stl::uintptr_t vr_addr) const noexcept {
+    if (vr_addr < start_vr_addr_) {
+        return false;
+    }
+
+    const auto page_idx {(vr_addr - start_vr_addr_) / page_size};
+    if (backend_ == Backend::Bitmap) {
+        return page_idx < bitmap_.GetCapacity() && bitmap_.IsAlloc(page_idx);
+    }
+
+    for (auto range {ranges_}; range && range->begin <= page_idx; range = range->next) {
+        if (page_idx < range->GetEnd()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+stl::size_t VrAddrPool::GetFreeCount() const noexcept {
+    return free_count_;
+}
+
+stl::uintptr_t VrAddrPool::GetStartAddr() const noexcept {
+    return start_vr_addr_;
+}
+
+VrAddrPool::Backend VrAddrPool::GetBackend() const noexcept {
+    return backend_;
+}
+
+VrAddrPool::VrAddrPool(const stl::uintptr_t start_vr_addr, Bitmap bitmap) noexcept {
+    Init(start_vr_addr, stl::move(bitmap));
+}
+
+VrAddrPool& VrAddrPool::Init(const stl::uintptr_t start_vr_addr, Bitmap bitmap) noexcept {
+    ClearRanges();
+    start_vr_addr_ = start_vr_addr;
+    backend_ = Backend::Bitmap;
+    bitmap_ = stl::move(bitmap);
+    free_count_ = bitmap_.GetCapacity();
+    return *this;
+}
+
+VrAddrPool& VrAddrPool::Init(const stl::uintptr_t start_vr_addr,
+                             const stl::size_t page_count) noexcept {
+    ClearRanges();
+    start_vr_addr_ = start_vr_addr;
+    backend_ = Backend::Range;
+    page_count_ = page_count;
+    free_count_ = page_count;
+    return *this;
+}
+
+VrAddrPool& VrAddrPool::Clear() noexcept {
+    if (backend_ == Backend::Bitmap) {
+        bitmap_.Clear();
+        free_count_ = bitmap_.GetCapacity();
+    } else {
+        ClearRanges();
+        free_count_ = page_count_;
+    }
+
+    return *this;
+}
+
+VrAddrPool& VrAddrPool::CopyFrom(const VrAddrPool& o) noexcept {
+    dbg::Assert(start_vr_addr_ == o.start_vr_addr_);
+    dbg::Assert(backend_ == o.backend_);
+    if (backend_ == Backend::Bitmap) {
+        bitmap_.CopyFrom(o.bitmap_);
+    } else {
+        dbg::Assert(page_count_ == o.page_count_);
+        ClearRanges();
+        auto next {&ranges_};
+        for (auto range {o.ranges_}; range; range = range->next) {
+            const auto copy {static_cast<Range*>(GetRangeCache().Allocate())};
+            AssertAlloc(copy);
+            *copy = {range->begin, range->count, nullptr};
+            *next = copy;
+            next = &copy->next;
+        }
+
+        range_count_ = o.range_count_;
+    }
+
+    free_count_ = o.free_count_;
+    return *this;
+}
+
+VrAddrPool& VrAddrPool::FreePages(const stl::uintptr_t vr_base, const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    dbg::Assert(vr_base >= start_vr_addr_ && vr_base % page_size == 0);
+    const auto page_idx {(vr_base - start_vr_addr_) / page_size};
+    if (backend_ == Backend::Bitmap) {
+        bitmap_.Free(page_idx, count);
+    } else {
+        FreeRange(page_idx, count);
+    }
+
+    free_count_ += count;
+    return *this;
+}
+
+VrAddrPool& VrAddrPool::AllocRange(const stl::size_t page_begin, const stl::size_t count) noexcept {
+    dbg::Assert(count > 0 && page_begin + count <= page_count_);
+    // Find the last range before the new one.
+    Range* prev {nullptr};
+    for (auto range {ranges_}; range && range->begin < page_begin; range = range->next) {
+        prev = range;
+    }
+
+    const auto next {prev ? prev->next : ranges_};
+    dbg::Assert(!prev || prev->GetEnd() <= page_begin);
+    dbg::Assert(!next || page_begin + count <= next->begin);
+
+    if (prev && prev->GetEnd() == page_begin) {
+        // Extend the previous range and merge it with the next range if they become adjacent.
+        prev->count += count;
+        if (next && prev->GetEnd() == next->begin) {
+            prev->count += next->count;
+            prev->next = next->next;
+            GetRangeCache().Free(next);
+            --range_count_;
+        }
+    } else if (next && page_begin + count == next->begin) {
+        next->begin = page_begin;
+        next->count += count;
+    } else {
+        const auto range {static_cast<Range*>(GetRangeCache().Allocate())};
+        AssertAlloc(range);
+        *range = {page_begin, count, next};
+        if (prev) {
+            prev->next = range;
+        } else {
+            ranges_ = range;
+        }
+
+        ++range_count_;
+    }
+
+    return *this;
+}
+
+VrAddrPool& VrAddrPool::FreeRange(const stl::size_t page_begin, const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    const auto page_end {page_begin + count};
+    Range* prev {nullptr};
+    auto range {ranges_};
+    while (range && range->GetEnd() < page_end) {
+        prev = range;
+        range = range->next;
+    }
+
+    dbg::Assert(range && range->begin <= page_begin && page_end <= range->GetEnd(),
+                "The pages have not been allocated.");
+
+    if (range->begin == page_begin && range->GetEnd() == page_end) {
+        // Remove the whole range.
+        if (prev) {
+            prev->next = range->next;
+        } else {
+            ranges_ = range->next;
+        }
+
+        GetRangeCache().Free(range);
+        --range_count_;
+    } else if (range->begin == page_begin) {
+        range->begin = page_end;
+        range->count -= count;
+    } else if (range->GetEnd() == page_end) {
+        range->count -= count;
+    } else {
+        // Split the range into two.
+        const auto tail {static_cast<Range*>(GetRangeCache().Allocate())};
+        AssertAlloc(tail);
+        *tail = {page_end, range->GetEnd() - page_end, range->next};
+        range->count = page_begin - range->begin;
+        range->next = tail;
+        ++range_count_;
+    }
+
+    return *this;
+}
+
+VrAddrPool& VrAddrPool::ClearRanges() noexcept {
+    while (ranges_) {
+        const auto next {ranges_->next};
+        GetRangeCache().Free(ranges_);
+        ranges_ = next;
+    }
+
+    range_count_ = 0;
+    return *this;
+}
+
+const Bitmap& VrAddrPool::GetBitmap() const noexcept {
+    dbg::Assert(backend_ == Backend::Bitmap);
+    return bitmap_;
+}
+
+stl::size_t VrAddrPool::GetRangeCount() const noexcept {
+    dbg::Assert(backend_ == Backend::Range);
+    return range_count_;
+}
+
+stl::uintptr_t PhyMemPagePool::AllocPages(const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    const auto page_begin {backend_ == Backend::Buddy ? buddy_.Alloc(count) : bitmap_.Alloc(count)};
+    if (page_begin != npos) {
+        dbg::Assert(free_count_ >= count);
+        free_count_ -= count;
+        ++stats_.alloc_count;
+        if (ref_counts_) {
+            for (stl::size_t i {0}; i != count; ++i) {
+                dbg::Assert(ref_counts_[page_begin + i] == 0);
+                ref_counts_[page_begin + i] = 1;
+            }
+        }
+
+        return start_phy_addr_ + page_begin * page_size;
+    } else {
+        ++stats_.fail_count;
+        return 0;
     }
 }
 
@@ -397,28 +1353,166 @@ stl::size_t PhyMemPagePool::GetFreeCount() const noexcept {
     return free_count_;
 }
 
+stl::size_t PhyMemPagePool::GetPageCount() const noexcept {
+    return backend_ == Backend::Buddy ? buddy_.GetPageCount() : bitmap_.GetCapacity();
+}
+
+bool PhyMemPagePool::IsFree(const stl::size_t page_idx) const noexcept {
+    return backend_ == Backend::Buddy ? buddy_.IsFree(page_idx) : !bitmap_.IsAlloc(page_idx);
+}
+
 stl::uintptr_t PhyMemPagePool::GetStartAddr() const noexcept {
     return start_phy_addr_;
 }
 
-PhyMemPagePool& PhyMemPagePool::FreePages(const stl::uintptr_t phy_base,
-                                          const stl::size_t count) noexcept {
-    dbg::Assert(count > 0);
-    dbg::Assert(phy_base >= start_phy_addr_ && phy_base % page_size == 0);
-    const auto bit_idx {(phy_base - start_phy_addr_) / page_size};
-    bitmap_.Free(bit_idx, count);
-    free_count_ += count;
+PhyMemPagePool& PhyMemPagePool::FreePages(const stl::uintptr_t phy_base,
+                                          const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    dbg::Assert(phy_base >= start_phy_addr_ && phy_base % page_size == 0);
+    const auto page_idx {(phy_base - start_phy_addr_) / page_size};
+    if (ref_counts_) {
+        // Only free pages without other references.
+        for (auto i {page_idx}; i != page_idx + count; ++i) {
+            dbg::Assert(ref_counts_[i] > 0, "The page has been freed.");
+            if (--ref_counts_[i] == 0) {
+                FreePagesImpl(i, 1);
+            }
+        }
+    } else {
+        FreePagesImpl(page_idx, count);
+    }
+
+    ++stats_.free_count;
+    return *this;
+}
+
+PhyMemPagePool& PhyMemPagePool::ReservePages(const stl::uintptr_t phy_base,
+                                             const stl::size_t count) noexcept {
+    dbg::Assert(count > 0);
+    dbg::Assert(phy_base >= start_phy_addr_ && phy_base % page_size == 0);
+    const auto page_idx {(phy_base - start_phy_addr_) / page_size};
+    dbg::Assert(page_idx + count <= GetPageCount());
+    for (auto i {page_idx}; i != page_idx + count; ++i) {
+        dbg::Assert(IsFree(i), "The page has been allocated.");
+    }
+
+    if (backend_ == Backend::Buddy) {
+        buddy_.Reserve(page_idx, count);
+    } else {
+        bitmap_.ForceAlloc(page_idx, count);
+    }
+
+    free_count_ -= count;
+    return *this;
+}
+
+PhyMemPagePool& PhyMemPagePool::FreePagesImpl(const stl::size_t page_idx,
+                                              const stl::size_t count) noexcept {
+    if (backend_ == Backend::Buddy) {
+        buddy_.Free(page_idx, count);
+    } else {
+        bitmap_.Free(page_idx, count);
+    }
+
+    free_count_ += count;
+    return *this;
+}
+
+PhyMemPagePool& PhyMemPagePool::InitRefCounts(void* const counts) noexcept {
+    dbg::Assert(counts);
+    ref_counts_ = static_cast<stl::uint8_t*>(counts);
+    return *this;
+}
+
+PhyMemPagePool& PhyMemPagePool::SharePage(const stl::uintptr_t phy_addr) noexcept {
+    dbg::Assert(ref_counts_);
+    dbg::Assert(phy_addr >= start_phy_addr_);
+    auto& ref_count {ref_counts_[(phy_addr - start_phy_addr_) / page_size]};
+    dbg::Assert(0 < ref_count && ref_count < 0xFF);
+    ++ref_count;
     return *this;
 }
 
+stl::size_t PhyMemPagePool::GetRefCount(const stl::uintptr_t phy_addr) const noexcept {
+    dbg::Assert(ref_counts_);
+    dbg::Assert(phy_addr >= start_phy_addr_);
+    return ref_counts_[(phy_addr - start_phy_addr_) / page_size];
+}
+
 PhyMemPagePool& PhyMemPagePool::Init(const stl::uintptr_t start_phy_addr, Bitmap bitmap) noexcept {
     start_phy_addr_ = start_phy_addr;
+    backend_ = Backend::Bitmap;
+    stats_ = {};
+    ref_counts_ = nullptr;
+    zeroed_pages_.Clear();
     bitmap_ = stl::move(bitmap);
     bitmap_.Clear();
     free_count_ = bitmap_.GetCapacity();
     return *this;
 }
 
+PhyMemPagePool& PhyMemPagePool::Init(const stl::uintptr_t start_phy_addr, void* const bits,
+                                     const stl::size_t page_count) noexcept {
+    start_phy_addr_ = start_phy_addr;
+    backend_ = Backend::Buddy;
+    stats_ = {};
+    ref_counts_ = nullptr;
+    zeroed_pages_.Clear();
+    buddy_.Init(bits, page_count);
+    free_count_ = page_count;
+    return *this;
+}
+
+PhyMemPagePool::Backend PhyMemPagePool::GetBackend() const noexcept {
+    return backend_;
+}
+
+const PhyMemPagePool::Stats& PhyMemPagePool::GetStats() const noexcept {
+    return stats_;
+}
+
+const BuddyAllocator& PhyMemPagePool::GetBuddy() const noexcept {
+    dbg::Assert(backend_ == Backend::Buddy);
+    return buddy_;
+}
+
+const ZeroedPageCache& PhyMemPagePool::GetZeroedPages() const noexcept {
+    return zeroed_pages_;
+}
+
+ZeroedPageCache& PhyMemPagePool::GetZeroedPages() noexcept {
+    return const_cast<ZeroedPageCache&>(const_cast<const PhyMemPagePool&>(*this).GetZeroedPages());
+}
+
+bool ZeroedPageCache::IsEmpty() const noexcept {
+    return count_ == 0;
+}
+
+bool ZeroedPageCache::IsFull() const noexcept {
+    return count_ == capacity;
+}
+
+stl::size_t ZeroedPageCache::GetCount() const noexcept {
+    return count_;
+}
+
+ZeroedPageCache& ZeroedPageCache::Push(const stl::uintptr_t phy_addr) noexcept {
+    dbg::Assert(!IsFull());
+    dbg::Assert(phy_addr % page_size == 0);
+    pages_[count_++] = phy_addr;
+    return *this;
+}
+
+stl::uintptr_t ZeroedPageCache::Pop() noexcept {
+    dbg::Assert(!IsEmpty());
+    return pages_[--count_];
+}
+
+ZeroedPageCache& ZeroedPageCache::Clear() noexcept {
+    count_ = 0;
+    return *this;
+}
+
 PhyMemPagePool::PhyMemPagePool(const stl::uintptr_t start_phy_addr, Bitmap bitmap) noexcept {
     Init(start_phy_addr, stl::move(bitmap));
 }
@@ -436,9 +1530,69 @@ MemBlockDesc& MemBlockDesc::Init(const stl::size_t block_size) noexcept {
     block_size_ = block_size;
     block_count_per_arena_ = (page_size - sizeof(MemArena)) / block_size;
     free_blocks_.Init();
+    empty_arena_count_ = 0;
+    max_empty_arena_count_ = default_max_empty_arena_count;
+    stats_ = {};
+    return *this;
+}
+
+stl::size_t MemBlockDesc::GetEmptyArenaCount() const noexcept {
+    return empty_arena_count_;
+}
+
+stl::size_t MemBlockDesc::GetMaxEmptyArenaCount() const noexcept {
+    return max_empty_arena_count_;
+}
+
+MemBlockDesc& MemBlockDesc::SetMaxEmptyArenaCount(const stl::size_t count) noexcept {
+    max_empty_arena_count_ = count;
+    return *this;
+}
+
+MemBlockDesc& MemBlockDesc::OnArenaAlloc() noexcept {
+    ++stats_.arena_alloc_count;
+    return *this;
+}
+
+MemBlockDesc& MemBlockDesc::OnArenaFree() noexcept {
+    ++stats_.arena_free_count;
     return *this;
 }
 
+MemBlockDesc& MemBlockDesc::OnArenaRetain() noexcept {
+    ++empty_arena_count_;
+    ++stats_.arena_retain_count;
+    return *this;
+}
+
+MemBlockDesc& MemBlockDesc::OnArenaRelease() noexcept {
+    dbg::Assert(empty_arena_count_ > 0);
+    --empty_arena_count_;
+    ++stats_.arena_free_count;
+    return *this;
+}
+
+MemBlockDesc& MemBlockDesc::OnArenaReuse() noexcept {
+    dbg::Assert(empty_arena_count_ > 0);
+    --empty_arena_count_;
+    ++stats_.arena_reuse_count;
+    return *this;
+}
+
+MemBlockDesc& MemBlockDesc::OnBlockAlloc() noexcept {
+    ++stats_.block_alloc_count;
+    return *this;
+}
+
+MemBlockDesc& MemBlockDesc::OnBlockFree() noexcept {
+    ++stats_.block_free_count;
+    return *this;
+}
+
+const MemBlockDesc::Stats& MemBlockDesc::GetStats() const noexcept {
+    return stats_;
+}
+
 stl::size_t MemBlockDesc::GetBlockSize() const noexcept {
     return block_size_;
 }
@@ -460,24 +1614,57 @@ MemBlockDescTab::MemBlockDescTab() noexcept {
 }
 
 MemBlockDescTab& MemBlockDescTab::Init() noexcept {
-    stl::size_t block_size {min_block_size};
-    for (auto& desc : descs_) {
-        desc.Init(block_size);
-        block_size *= 2;
+    for (stl::size_t i {0}; i != descs_.size(); ++i) {
+        descs_[i].Init(GetBlockSize(i));
     }
 
-    dbg::Assert(block_size / 2 == max_block_size);
     return *this;
 }
 
 void* AllocPages(const PoolType type, const stl::size_t count) noexcept {
     dbg::Assert(count > 0);
+    ReclaimMem(type, count);
     auto& addr_pool {GetVrAddrPool(type)};
     auto& mem_pool {GetPhyMemPagePool(type)};
     const stl::lock_guard guard {mem_pool.GetLock()};
     return AllocPages(mem_pool, addr_pool, count);
 }
 
+void* AllocAlignedPages(const PoolType type, const stl::size_t count) noexcept {
+    dbg::Assert(count > 0 && (count & (count - 1)) == 0);
+    if (count == 1) {
+        return AllocPages(type);
+    }
+
+    ReclaimMem(type, count);
+    auto& addr_pool {GetVrAddrPool(type)};
+    auto& mem_pool {GetPhyMemPagePool(type)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    // Allocate more virtual addresses than needed, so they must contain an aligned range.
+    const auto extra_count {count - 1};
+    const auto vr_base {addr_pool.AllocPages(count + extra_count)};
+    if (!vr_base) {
+        return nullptr;
+    }
+
+    // Free unused virtual addresses before and after the aligned range.
+    const auto align_vr_base {ForwardAlign(vr_base, count * page_size)};
+    const auto head_count {(align_vr_base - vr_base) / page_size};
+    if (head_count > 0) {
+        addr_pool.FreePages(vr_base, head_count);
+    }
+
+    if (const auto tail_count {extra_count - head_count}; tail_count > 0) {
+        addr_pool.FreePages(align_vr_base + count * page_size, tail_count);
+    }
+
+    if (!MapPages(mem_pool, addr_pool, align_vr_base, count, true)) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<void*>(align_vr_base);
+}
+
 void FreePages(void* const vr_base, const stl::size_t count) noexcept {
     dbg::Assert(vr_base && count > 0);
     const auto type {GetSrcMemPool(vr_base)};
@@ -488,6 +1675,7 @@ void FreePages(void* const vr_base, const stl::size_t count) noexcept {
 }
 
 void* AllocPageAtAddr(const PoolType type, const stl::uintptr_t vr_addr) noexcept {
+    ReclaimMem(type, 1);
     auto& mem_pool {GetPhyMemPagePool(type)};
     const stl::lock_guard guard {mem_pool.GetLock()};
     return AllocPageAtAddr(mem_pool, GetVrAddrPool(type), vr_addr);
@@ -495,44 +1683,70 @@ void* AllocPageAtAddr(const PoolType type, const stl::uintptr_t vr_addr) noexcep
 
 void* AllocPageAtAddr(const PoolType type, VrAddrPool& addr_pool,
                       const stl::uintptr_t vr_addr) noexcept {
+    ReclaimMem(type, 1);
     auto& mem_pool {GetPhyMemPagePool(type)};
     const stl::lock_guard guard {mem_pool.GetLock()};
     return AllocPageAtAddr(mem_pool, addr_pool, vr_addr);
 }
 
+void* ReservePages(const PoolType type, const stl::size_t count) noexcept {
+    dbg::Assert(type == PoolType::User && count > 0);
+    const stl::lock_guard guard {GetPhyMemPagePool(type).GetLock()};
+    return ReservePages(GetVrAddrPool(type), count);
+}
+
+void* ReservePageAtAddr(const PoolType type, const stl::uintptr_t vr_addr) noexcept {
+    dbg::Assert(type == PoolType::User);
+    dbg::Assert(!VrAddr {AlignToPageBase(vr_addr)}.IsMapped());
+    const stl::lock_guard guard {GetPhyMemPagePool(type).GetLock()};
+    return reinterpret_cast<void*>(GetVrAddrPool(type).AllocPageAtAddr(vr_addr));
+}
+
 void Free(const PoolType type, void* const vr_base) noexcept {
     if (!vr_base) {
         return;
     }
 
+    const auto block {static_cast<MemBlock*>(vr_base)};
+    auto& arena {block->GetArena()};
+    if (!arena.large) {
+        {
+            const intr::IntrGuard intr_guard;
+            arena.desc->OnBlockFree();
+        }
+
+        // Try to cache the block in the magazine of the current thread without locking.
+        if (const auto mag {GetCurrMagazine(type, *arena.desc)}; mag) {
+            {
+                const intr::IntrGuard intr_guard;
+                if (!mag->IsFull()) {
+                    mag->Push(block);
+                    return;
+                }
+            }
+
+            // Drain a batch of blocks back to the free block list if the magazine is full.
+            auto& mem_pool {GetPhyMemPagePool(type)};
+            const stl::lock_guard guard {mem_pool.GetLock()};
+            auto& addr_pool {GetVrAddrPool(type)};
+            const intr::IntrGuard intr_guard;
+            for (stl::size_t i {0}; i != MemBlockMagazine::batch_size && !mag->IsEmpty(); ++i) {
+                FreeBlock(mem_pool, addr_pool, *static_cast<MemBlock*>(mag->Pop()));
+            }
+
+            mag->Push(block);
+            return;
+        }
+    }
+
     auto& mem_pool {GetPhyMemPagePool(type)};
     const stl::lock_guard guard {mem_pool.GetLock()};
-    const auto block {reinterpret_cast<MemBlock*>(vr_base)};
-
-    // Get the arena at the begging of the memory page.
-    if (auto& arena {block->GetArena()}; arena.large) {
+    if (arena.large) {
         // Directly free pages if the arena is a large arena.
         dbg::Assert(!arena.desc);
         FreePages(mem_pool, GetVrAddrPool(type), &arena, arena.count);
     } else {
-        // Get the block descriptor.
-        const auto desc {arena.desc};
-        dbg::Assert(desc);
-        // Add the block to the free block list of the descriptor.
-        desc->GetFreeBlockList().PushBack(block->GetTag());
-
-        // All blocks in the arena are free.
-        if (++arena.count == desc->GetBlockCountPerArena()) {
-            // Remove all blocks from the free block list.
-            for (stl::size_t i {0}; i != arena.count; ++i) {
-                auto& block {arena.GetBlock(i)};
-                dbg::Assert(desc->GetFreeBlockList().Find(block.GetTag()));
-                block.GetTag().Detach();
-            }
-
-            // Free the arena.
-            FreePages(mem_pool, GetVrAddrPool(type), &arena);
-        }
+        FreeBlock(mem_pool, GetVrAddrPool(type), *block);
     }
 }
 
@@ -540,64 +1754,280 @@ void Free(void* const vr_base) noexcept {
     Free(GetDefaultPoolType(), vr_base);
 }
 
-void* Allocate(const PoolType type, const stl::size_t size) noexcept {
-    dbg::Assert(size > 0);
-    auto& mem_pool {GetPhyMemPagePool(type)};
-    const stl::lock_guard lck_guard {mem_pool.GetLock()};
-    if (mem_pool.GetFreeCount() * page_size < size) {
-        return nullptr;
+void DrainMemBlockMagazines() noexcept {
+    if (!tsk::IsThreadInited()) {
+        return;
     }
 
+    // A thread only caches blocks from its default memory pool.
+    const auto type {GetDefaultPoolType()};
+    auto& mem_pool {GetPhyMemPagePool(type)};
     auto& addr_pool {GetVrAddrPool(type)};
-    if (size > MemBlockDescTab::max_block_size) {
-        // Directly allocate a number of pages if the required size is larger than the maximum block size.
-        const auto page_count {CalcPageCount(size + sizeof(MemArena))};
-        const auto arena {static_cast<MemArena*>(AllocPages(mem_pool, addr_pool, page_count))};
-        AssertAlloc(arena);
-        arena->desc = nullptr;
-        // The arena is a large arena and the count refers to the number of pages instead of blocks.
-        arena->large = true;
-        arena->count = page_count;
-        return reinterpret_cast<stl::byte*>(arena) + sizeof(MemArena);
+    const auto mags {tsk::Thread::GetCurrent().GetMemBlockMagazines()};
+    if (!mags) {
+        return;
+    }
+
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    const intr::IntrGuard intr_guard;
+    for (stl::size_t i {0}; i != MemBlockMagazines::count; ++i) {
+        while (!(*mags)[i].IsEmpty()) {
+            FreeBlock(mem_pool, addr_pool, *static_cast<MemBlock*>((*mags)[i].Pop()));
+        }
+    }
+}
+
+void ReleaseMemBlockMagazines() noexcept {
+    DrainMemBlockMagazines();
+    auto& thd {tsk::Thread::GetCurrent()};
+    if (const auto mags {thd.GetMemBlockMagazines()}; mags) {
+        thd.SetMemBlockMagazines(nullptr);
+        GetMagazineCache().Free(mags);
+    }
+}
+
+void* Reallocate(const PoolType type, void* const vr_base, const stl::size_t size) noexcept {
+    if (!vr_base) {
+        return Allocate(type, size);
+    }
+
+    dbg::Assert(size > 0);
+    auto& arena {static_cast<MemBlock*>(vr_base)->GetArena()};
+    stl::size_t old_size {0};
+    if (!arena.large) {
+        old_size = arena.desc->GetBlockSize();
+        if (size <= old_size) {
+            return vr_base;
+        }
     } else {
-        auto& descs {GetMemBlockDescTab(type)};
-        // Get the suitable block descriptor.
-        const auto desc {descs.GetMinDesc(size)};
-        dbg::Assert(desc);
+        old_size = arena.count * page_size - sizeof(MemArena);
+        if (size <= old_size
+            || GrowLargeArena(type, arena, CalcPageCount(size + sizeof(MemArena)))) {
+            return vr_base;
+        }
+    }
 
-        if (desc->GetFreeBlockList().IsEmpty()) {
-            // Allocate a new arena if the free block list of the descriptor is empty.
-            const auto arena {static_cast<MemArena*>(AllocPages(mem_pool, addr_pool))};
-            AssertAlloc(arena);
-            arena->desc = desc;
-            // The arena is not a large arena and the count refers to the number of blocks.
-            arena->large = false;
-            arena->count = desc->GetBlockCountPerArena();
+    // Move the memory to a new allocation.
+    const auto new_base {static_cast<stl::byte*>(AllocateUninit(type, size))};
+    if (!new_base) {
+        return nullptr;
+    }
 
-            // Add all blocks to the free block list.
-            const intr::IntrGuard intr_guard;
-            for (stl::size_t i {0}; i != arena->count; ++i) {
-                auto& block {arena->GetBlock(i)};
-                dbg::Assert(!desc->GetFreeBlockList().Find(block.GetTag()));
-                desc->GetFreeBlockList().PushBack(block.GetTag());
-            }
+    stl::memcpy(new_base, vr_base, old_size);
+    stl::memset(new_base + old_size, 0, size - old_size);
+    Free(type, vr_base);
+    return new_base;
+}
+
+void* Reallocate(void* const vr_base, const stl::size_t size) noexcept {
+    return Reallocate(GetDefaultPoolType(), vr_base, size);
+}
+
+void* MapMem(const stl::uintptr_t vr_addr, const stl::size_t size,
+             const bit::Flags<MapFlag> flags) noexcept {
+    if (size == 0 || vr_addr % page_size != 0 || !tsk::Thread::GetCurrent().GetProcess()) {
+        return nullptr;
+    }
+
+    const auto count {CalcPageCount(size)};
+    auto& mem_pool {GetPhyMemPagePool(PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    auto& addr_pool {GetVrAddrPool(PoolType::User)};
+    stl::uintptr_t vr_base {0};
+    if (vr_addr) {
+        vr_base = addr_pool.AllocPagesAtAddr(vr_addr, count);
+    }
+
+    if (!vr_base && !flags.IsSet(MapFlag::Fixed)) {
+        vr_base = addr_pool.AllocPages(count);
+    }
+
+    if (!vr_base) {
+        return nullptr;
+    }
+
+    if (flags.IsSet(MapFlag::Populate) && !MapPages(mem_pool, addr_pool, vr_base, count, true)) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<void*>(vr_base);
+}
+
+bool UnmapMem(void* const vr_base, const stl::size_t size) noexcept {
+    const auto base {reinterpret_cast<stl::uintptr_t>(vr_base)};
+    if (!base || size == 0 || base % page_size != 0 || !tsk::Thread::GetCurrent().GetProcess()) {
+        return false;
+    }
+
+    const auto count {CalcPageCount(size)};
+    auto& mem_pool {GetPhyMemPagePool(PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    auto& addr_pool {GetVrAddrPool(PoolType::User)};
+    for (stl::size_t i {0}; i != count; ++i) {
+        if (!addr_pool.IsAlloc(base + i * page_size)) {
+            return false;
         }
+    }
 
-        dbg::Assert(!desc->GetFreeBlockList().IsEmpty());
-        // Remove a block from the free block list and return its address.
-        auto& block {MemBlock::GetByTag(desc->GetFreeBlockList().Pop())};
-        stl::memset(&block, 0, desc->GetBlockSize());
-        auto& arena {block.GetArena()};
-        dbg::Assert(arena.count > 0);
-        --arena.count;
-        return &block;
+    FreePages(mem_pool, addr_pool, vr_base, count);
+    return true;
+}
+
+void FreeUsrMem() noexcept {
+    const auto proc {tsk::Process::GetCurrent()};
+    dbg::Assert(proc);
+    auto& usr_mem_pool {GetPhyMemPagePool(PoolType::User)};
+    auto& krnl_mem_pool {GetPhyMemPagePool(PoolType::Kernel)};
+    {
+        const stl::lock_guard guard {usr_mem_pool.GetLock()};
+        const auto page_dir {reinterpret_cast<PageEntry*>(page_dir_base)};
+        for (stl::size_t i {0}; i != krnl_page_dir_start; ++i) {
+            if (!page_dir[i].IsPresent()) {
+                continue;
+            }
+
+            // Reserved pages are not mapped and have no physical pages.
+            const auto page_tab {&VrAddr {i, 0, 0}.GetPageTabEntry()};
+            for (stl::size_t j {0}; j != page_dir_count; ++j) {
+                if (page_tab[j].IsPresent()) {
+                    usr_mem_pool.FreePages(page_tab[j].GetAddress());
+                }
+            }
+
+            // Page tables are allocated from the kernel memory pool.
+            const auto page_tab_phy_base {page_dir[i].GetAddress()};
+            page_dir[i] = {};
+            const stl::lock_guard krnl_guard {krnl_mem_pool.GetLock()};
+            krnl_mem_pool.FreePages(page_tab_phy_base);
+        }
     }
+
+    proc->GetVrAddrPool().Clear();
+}
+
+void* Allocate(const PoolType type, const stl::size_t size) noexcept {
+    const auto addr {AllocateImpl(type, size, true)};
+    dbg::Trace<dbg::TraceEvent::MemAlloc>(size, reinterpret_cast<stl::uint32_t>(addr));
+    return addr;
 }
 
 void* Allocate(const stl::size_t size) noexcept {
     return Allocate(GetDefaultPoolType(), size);
 }
 
+void* AllocateUninit(const PoolType type, const stl::size_t size) noexcept {
+    const auto addr {AllocateImpl(type, size, false)};
+    dbg::Trace<dbg::TraceEvent::MemAlloc>(size, reinterpret_cast<stl::uint32_t>(addr));
+    return addr;
+}
+
+void* AllocateUninit(const stl::size_t size) noexcept {
+    return AllocateUninit(GetDefaultPoolType(), size);
+}
+
+void* AllocateZeroed(const PoolType type, const stl::size_t size) noexcept {
+    return Allocate(type, size);
+}
+
+void* AllocateZeroed(const stl::size_t size) noexcept {
+    return Allocate(size);
+}
+
+void FillZeroedPages() noexcept {
+    if (!IsMemInited()) {
+        return;
+    }
+
+    while (FillZeroedPage(PoolType::Kernel)) {
+    }
+
+    while (FillZeroedPage(PoolType::User)) {
+    }
+}
+
+bool MapPageOnDemand(const stl::uintptr_t vr_addr) noexcept {
+    const auto proc {tsk::Thread::GetCurrent().GetProcess()};
+    if (!proc) {
+        return false;
+    }
+
+    const VrAddr page {AlignToPageBase(vr_addr)};
+    if (page.IsMapped() || !proc->GetVrAddrPool().IsAlloc(page)) {
+        return false;
+    }
+
+    ReclaimMem(PoolType::User, 1);
+    auto& mem_pool {GetPhyMemPagePool(PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    auto& zeroed_pages {mem_pool.GetZeroedPages()};
+    if (!zeroed_pages.IsEmpty()) {
+        page.MapToPhyAddr(zeroed_pages.Pop());
+        return true;
+    }
+
+    const auto phy_addr {mem_pool.AllocPages()};
+    if (!phy_addr) {
+        return false;
+    }
+
+    page.MapToPhyAddr(phy_addr);
+    stl::memset(reinterpret_cast<void*>(static_cast<stl::uintptr_t>(page)), 0, page_size);
+    return true;
+}
+
+bool CopyPageOnWrite(const stl::uintptr_t vr_addr) noexcept {
+    const VrAddr page {AlignToPageBase(vr_addr)};
+    if (!page.IsMapped()) {
+        return false;
+    }
+
+    auto& entry {page.GetPageTabEntry()};
+    if (entry.IsWritable() || !entry.IsCopyOnWrite()) {
+        return false;
+    }
+
+    ReclaimMem(PoolType::User, 1);
+    auto& mem_pool {GetPhyMemPagePool(PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    const auto phy_addr {entry.GetAddress()};
+    if (mem_pool.GetRefCount(phy_addr) > 1) {
+        // The page is still shared by other processes. Copy it to a new physical page.
+        const auto new_phy_addr {mem_pool.AllocPages()};
+        if (!new_phy_addr) {
+            return false;
+        }
+
+        const auto buf {GetPageCopyBuf()};
+        dbg::Assert(buf);
+        stl::memcpy(buf, reinterpret_cast<const void*>(static_cast<stl::uintptr_t>(page)),
+                    page_size);
+        // Drop the reference to the shared page.
+        mem_pool.FreePages(phy_addr);
+        entry.SetAddress(new_phy_addr);
+        entry.SetCopyOnWrite(false).SetWritable();
+        page.FlushTlb();
+        stl::memcpy(reinterpret_cast<void*>(static_cast<stl::uintptr_t>(page)), buf, page_size);
+    } else {
+        // The page is only owned by the current process.
+        entry.SetCopyOnWrite(false).SetWritable();
+        page.FlushTlb();
+    }
+
+    return true;
+}
+
+bool PrepareUsrPageForWrite(const stl::uintptr_t vr_addr) noexcept {
+    dbg::Assert(vr_addr < krnl_base);
+    // Load the page as the page fault handler does for its first access.
+    if (!VrAddr {vr_addr}.IsMapped() && !io::FileMap::LoadPage(vr_addr)
+        && !tsk::Image::LoadPage(vr_addr) && !MapPageOnDemand(vr_addr)) {
+        return false;
+    }
+
+    const VrAddr page {AlignToPageBase(vr_addr)};
+    return page.GetPageTabEntry().IsWritable() || CopyPageOnWrite(vr_addr);
+}
+
 void AssertAlloc(const void* const addr) noexcept {
     dbg::Assert(addr, "Failed to allocate memory.");
 }
@@ -606,4 +2036,109 @@ void AssertAlloc(const stl::uintptr_t addr) noexcept {
     AssertAlloc(reinterpret_cast<const void*>(addr));
 }
 
+MemStats GetMemStats(const PoolType type) noexcept {
+    MemStats stats {};
+    {
+        const auto& mem_pool {GetPhyMemPagePool(type)};
+        const stl::lock_guard guard {mem_pool.GetLock()};
+        const auto& pool_stats {mem_pool.GetStats()};
+        stats.page_count = mem_pool.GetPageCount();
+        stats.free_page_count = mem_pool.GetFreeCount();
+        stats.zeroed_page_count = mem_pool.GetZeroedPages().GetCount();
+        stats.alloc_count = pool_stats.alloc_count;
+        stats.fail_count = pool_stats.fail_count;
+        stats.free_count = pool_stats.free_count;
+
+        // Build the free-run histogram.
+        const auto add_free_run {[&stats](const stl::size_t len) noexcept {
+            if (len > 0) {
+                stats.largest_free_run = stl::max(stats.largest_free_run, len);
+                const auto bucket {stl::min(bit::GetHighestSetBit(len),
+                                            MemStats::free_run_bucket_count - 1)};
+                ++stats.free_runs[bucket];
+            }
+        }};
+
+        stl::size_t free_run {0};
+        for (stl::size_t i {0}; i != stats.page_count; ++i) {
+            if (mem_pool.IsFree(i)) {
+                ++free_run;
+            } else {
+                add_free_run(free_run);
+                free_run = 0;
+            }
+        }
+
+        add_free_run(free_run);
+    }
+
+    // User block descriptors belong to the current process.
+    if (type == PoolType::Kernel || tsk::Thread::GetCurrent().GetProcess()) {
+        const auto& descs {GetMemBlockDescTab(type)};
+        const intr::IntrGuard guard;
+        for (stl::size_t i {0}; i != descs.size(); ++i) {
+            const auto& desc {descs[i]};
+            const auto& desc_stats {desc.GetStats()};
+            stats.blocks[i] = {
+                .block_size = desc.GetBlockSize(),
+                .alloc_count = desc_stats.block_alloc_count,
+                .free_count = desc_stats.block_free_count,
+                .live_arena_count = desc_stats.arena_alloc_count - desc_stats.arena_free_count,
+                .free_block_count = desc.GetFreeBlockList().GetSize(),
+            };
+        }
+    }
+
+    return stats;
+}
+
+void DumpMemStats() noexcept {
+    const PoolType types[] {PoolType::Kernel, PoolType::User};
+    for (const auto type : types) {
+        const auto stats {GetMemStats(type)};
+        io::Printf("{} memory pool:\n", type == PoolType::Kernel ? "Kernel" : "User");
+        io::Printf("\tPages: 0x{} free of 0x{}, 0x{} zeroed.\n", stats.free_page_count,
+                   stats.page_count, stats.zeroed_page_count);
+        io::Printf("\tPage allocations: 0x{}, failures: 0x{}, releases: 0x{}.\n",
+                   stats.alloc_count, stats.fail_count, stats.free_count);
+        const auto reclaim_stats {GetReclaimStats(type)};
+        io::Printf("\tReclaims: 0x{}, released pages: 0x{}.\n", reclaim_stats.reclaim_count,
+                   reclaim_stats.released_page_count);
+        io::Printf("\tThe largest free run: 0x{} pages.\n", stats.largest_free_run);
+        for (stl::size_t i {0}; i != stats.free_runs.size(); ++i) {
+            if (stats.free_runs[i] > 0) {
+                io::Printf("\tFree runs of 0x{}+ pages: 0x{}.\n",
+                           static_cast<stl::size_t>(1) << i, stats.free_runs[i]);
+            }
+        }
+
+        for (const auto& block : stats.blocks) {
+            if (block.block_size > 0) {
+                io::Printf(
+                    "\tBlocks of 0x{} bytes: 0x{} allocations, 0x{} releases, 0x{} arenas, 0x{} free.\n",
+                    block.block_size, block.alloc_count, block.free_count,
+                    block.live_arena_count, block.free_block_count);
+            }
+        }
+    }
+}
+
+namespace sc {
+
+void Memory::GetStats(const PoolType type, MemStats* const stats) noexcept {
+    dbg::Assert(stats);
+    *stats = GetMemStats(type);
+}
+
+void* Memory::Map(const stl::uintptr_t addr, const stl::size_t size,
+                  const stl::uint32_t flags) noexcept {
+    return MapMem(addr, size, flags);
+}
+
+bool Memory::Unmap(void* const addr, const stl::size_t size) noexcept {
+    return UnmapMem(addr, size);
+}
+
+}  // namespace sc
+
 }  // namespace mem
\ No newline at end of file
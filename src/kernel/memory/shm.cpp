@@ -0,0 +1,190 @@
+#include "kernel/memory/shm.h"
+#include "kernel/debug/assert.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/array.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/stl/mutex.h"
+
+namespace mem {
+
+namespace {
+
+//! A named shared memory region.
+struct Region {
+    bool IsUsed() const noexcept {
+        return pages != nullptr;
+    }
+
+    stl::array<char, SharedMem::max_name_len + 1> name;
+    stl::size_t page_count;
+    //! Physical addresses of pages.
+    stl::uintptr_t* pages;
+};
+
+/**
+ * @brief A wrapper of a global variable representing shared memory regions.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+stl::array<Region, SharedMem::max_count>& GetRegions() noexcept {
+    static stl::array<Region, SharedMem::max_count> regions {};
+    return regions;
+}
+
+stl::mutex& GetRegionLock() noexcept {
+    static stl::mutex lock;
+    return lock;
+}
+
+Region* FindRegion(const stl::string_view name) noexcept {
+    for (auto& region : GetRegions()) {
+        if (region.IsUsed() && stl::string_view {region.name.data()} == name) {
+            return &region;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Mark mapped pages as shared pages.
+ *
+ * @details
+ * The user memory pool must be locked.
+ */
+void MarkShared(const stl::uintptr_t vr_base, const stl::size_t count) noexcept {
+    for (stl::size_t i {0}; i != count; ++i) {
+        VrAddr {vr_base + i * page_size}.GetPageTabEntry().SetShared();
+    }
+}
+
+//! Create a region of zeroed pages and map it into the current process.
+void* CreateRegion(Region& region, const stl::string_view name, const stl::size_t size) noexcept {
+    const auto count {CalcPageCount(size)};
+    const auto pages {Allocate<stl::uintptr_t>(PoolType::Kernel, count * sizeof(stl::uintptr_t))};
+    if (!pages) {
+        return nullptr;
+    }
+
+    const auto vr_base {MapMem(0, size, MapFlag::Populate)};
+    if (!vr_base) {
+        Free(PoolType::Kernel, pages);
+        return nullptr;
+    }
+
+    {
+        auto& mem_pool {GetPhyMemPagePool(PoolType::User)};
+        const stl::lock_guard guard {mem_pool.GetLock()};
+        const auto base {reinterpret_cast<stl::uintptr_t>(vr_base)};
+        for (stl::size_t i {0}; i != count; ++i) {
+            pages[i] = VrAddr {base + i * page_size}.GetPhyAddr();
+            // The region holds its own reference to each page.
+            mem_pool.SharePage(pages[i]);
+        }
+
+        MarkShared(base, count);
+    }
+
+    stl::memcpy(region.name.data(), name.data(), name.size());
+    region.name[name.size()] = '\0';
+    region.page_count = count;
+    region.pages = pages;
+    return vr_base;
+}
+
+//! Map an existing region into the current process.
+void* MapRegion(const Region& region, const stl::size_t size) noexcept {
+    const auto count {CalcPageCount(size)};
+    if (count > region.page_count) {
+        return nullptr;
+    }
+
+    // Reserve virtual addresses, then map them to the region's pages.
+    const auto vr_base {MapMem(0, size)};
+    if (!vr_base) {
+        return nullptr;
+    }
+
+    struct Source {
+        PhyMemPagePool& mem_pool;
+        const stl::uintptr_t* pages;
+    };
+
+    auto& mem_pool {GetPhyMemPagePool(PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    Source src {mem_pool, region.pages};
+    const auto base {reinterpret_cast<stl::uintptr_t>(vr_base)};
+    MapRange(
+        base, count,
+        [](void* const arg) noexcept {
+            auto& src {*static_cast<Source*>(arg)};
+            const auto phy_addr {*src.pages++};
+            src.mem_pool.SharePage(phy_addr);
+            return phy_addr;
+        },
+        &src);
+    MarkShared(base, count);
+    return vr_base;
+}
+
+}  // namespace
+
+void* SharedMem::Map(const stl::string_view name, const stl::size_t size) noexcept {
+    if (name.empty() || name.size() > max_name_len || size == 0) {
+        return nullptr;
+    }
+
+    const stl::lock_guard guard {GetRegionLock()};
+    if (const auto region {FindRegion(name)}; region) {
+        return MapRegion(*region, size);
+    }
+
+    for (auto& region : GetRegions()) {
+        if (!region.IsUsed()) {
+            return CreateRegion(region, name, size);
+        }
+    }
+
+    return nullptr;
+}
+
+bool SharedMem::Delete(const stl::string_view name) noexcept {
+    const stl::lock_guard guard {GetRegionLock()};
+    const auto region {FindRegion(name)};
+    if (!region) {
+        return false;
+    }
+
+    {
+        // Drop the region's references. A page is freed if no process maps it.
+        auto& mem_pool {GetPhyMemPagePool(PoolType::User)};
+        const stl::lock_guard pool_guard {mem_pool.GetLock()};
+        for (stl::size_t i {0}; i != region->page_count; ++i) {
+            mem_pool.FreePages(region->pages[i]);
+        }
+    }
+
+    Free(PoolType::Kernel, region->pages);
+    region->pages = nullptr;
+    region->page_count = 0;
+    return true;
+}
+
+namespace sc {
+
+void* SharedMem::Map(const char* const name, const stl::size_t size) noexcept {
+    dbg::Assert(name);
+    return mem::SharedMem::Map(name, size);
+}
+
+bool SharedMem::Delete(const char* const name) noexcept {
+    dbg::Assert(name);
+    return mem::SharedMem::Delete(name);
+}
+
+}  // namespace sc
+
+}  // namespace mem
@@ -0,0 +1,98 @@
+#include "kernel/memory/shrink.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/stl/array.h"
+#include "kernel/thread/thd.h"
+
+namespace mem {
+
+namespace {
+
+struct ShrinkerEntry {
+    Shrinker shrink;
+    void* arg;
+};
+
+//! Registered shrinkers and reclaim statistics.
+struct ShrinkerTab {
+    stl::array<ShrinkerEntry, max_shrinker_count> shrinkers;
+    stl::size_t count;
+    //! Statistics indexed by @p PoolType.
+    stl::array<ReclaimStats, 2> stats;
+};
+
+/**
+ * @brief A wrapper of a global variable saving registered shrinkers.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+ShrinkerTab& GetShrinkerTab() noexcept {
+    static ShrinkerTab tab {};
+    return tab;
+}
+
+//! Get the number of pages that can be allocated from a memory pool without locking it.
+stl::size_t GetAvailPageCount(const PoolType type) noexcept {
+    const auto& mem_pool {GetPhyMemPagePool(type)};
+    return mem_pool.GetFreeCount() + mem_pool.GetZeroedPages().GetCount();
+}
+
+}  // namespace
+
+bool RegisterShrinker(const Shrinker shrink, void* const arg) noexcept {
+    dbg::Assert(shrink);
+    auto& tab {GetShrinkerTab()};
+    const intr::IntrGuard guard;
+    if (tab.count == tab.shrinkers.size()) {
+        return false;
+    }
+
+    tab.shrinkers[tab.count++] = {shrink, arg};
+    return true;
+}
+
+stl::size_t ReclaimMem(const PoolType type, const stl::size_t page_count) noexcept {
+    const auto target {page_count + reclaim_watermark_page_count};
+    // The counts are read without locking the pool. A stale value only reclaims too early or too late.
+    if (GetAvailPageCount(type) >= target) {
+        return 0;
+    }
+
+    // Shrinkers lock their caches, which may be held by the current thread.
+    if (!tsk::IsThreadInited() || tsk::Thread::GetCurrent().GetHeldMutexCount() != 0) {
+        return 0;
+    }
+
+    auto& tab {GetShrinkerTab()};
+    stl::size_t count {0};
+    {
+        const intr::IntrGuard guard;
+        count = tab.count;
+    }
+
+    stl::size_t released {0};
+    for (stl::size_t i {0}; i != count; ++i) {
+        const auto avail {GetAvailPageCount(type)};
+        if (avail >= target) {
+            break;
+        }
+
+        const auto& shrinker {tab.shrinkers[i]};
+        released += shrinker.shrink(type, target - avail, shrinker.arg);
+    }
+
+    const intr::IntrGuard guard;
+    auto& stats {tab.stats[static_cast<stl::size_t>(type)]};
+    ++stats.reclaim_count;
+    stats.released_page_count += released;
+    return released;
+}
+
+ReclaimStats GetReclaimStats(const PoolType type) noexcept {
+    const intr::IntrGuard guard;
+    return GetShrinkerTab().stats[static_cast<stl::size_t>(type)];
+}
+
+}  // namespace mem
@@ -0,0 +1,280 @@
+#include "kernel/memory/slab.h"
+#include "kernel/debug/assert.h"
+#include "kernel/memory/shrink.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/util/metric.h"
+
+namespace mem {
+
+struct SlabCacheBase::Slab {
+    static Slab& GetByTag(const TagList::Tag& tag) noexcept {
+        return tag.GetElem<Slab>();
+    }
+
+    //! Get the slab containing an object.
+    static Slab& GetByObj(const void* const obj) noexcept {
+        return *reinterpret_cast<Slab*>(AlignToPageBase(reinterpret_cast<stl::uintptr_t>(obj)));
+    }
+
+    //! Get the index list, where each element is the index of the next free object.
+    stl::uint16_t* GetFreeIdxs() noexcept {
+        return reinterpret_cast<stl::uint16_t*>(this + 1);
+    }
+
+    TagList::Tag tag;
+    SlabCacheBase* cache;
+    //! The number of free objects.
+    stl::size_t free_count;
+    //! The index of the first free object.
+    stl::size_t first_free;
+};
+
+SlabCacheBase::SlabCacheBase(const stl::string_view name, const stl::size_t obj_size,
+                             const stl::size_t obj_align, const PoolType type,
+                             const Ctor ctor) noexcept :
+    name_ {name}, obj_size_ {ForwardAlign(obj_size, obj_align)}, type_ {type}, ctor_ {ctor} {
+    dbg::Assert(0 < obj_size_ && obj_size_ <= page_size);
+    if (sizeof(Slab) + sizeof(stl::uint16_t) + obj_size_ > page_size) {
+        // An object is too large to share a page with a slab header.
+        obj_count_per_slab_ = 1;
+        obj_offset_ = 0;
+    } else {
+        auto count {(page_size - sizeof(Slab)) / (obj_size_ + sizeof(stl::uint16_t))};
+        const auto calc_offset {[obj_align](const stl::size_t count) noexcept {
+            return ForwardAlign(sizeof(Slab) + count * sizeof(stl::uint16_t), obj_align);
+        }};
+
+        while (calc_offset(count) + count * obj_size_ > page_size) {
+            --count;
+        }
+
+        dbg::Assert(count > 0);
+        obj_count_per_slab_ = count;
+        obj_offset_ = calc_offset(count);
+    }
+
+    RegisterShrinker(
+        [](const PoolType type, const stl::size_t page_count, void* const cache) noexcept {
+            auto& slab_cache {*static_cast<SlabCacheBase*>(cache)};
+            return type == slab_cache.type_ ? slab_cache.Shrink(page_count) : 0;
+        },
+        this);
+}
+
+bool SlabCacheBase::IsPageObj() const noexcept {
+    return obj_offset_ == 0;
+}
+
+void* SlabCacheBase::Allocate() noexcept {
+    const stl::lock_guard guard {mtx_};
+    if (IsPageObj()) {
+        return AllocatePage();
+    }
+
+    if (partial_slabs_.IsEmpty()) {
+        if (const auto slab {CreateSlab()}; slab) {
+            partial_slabs_.PushBack(slab->tag);
+        } else {
+            return nullptr;
+        }
+    }
+
+    auto& slab {Slab::GetByTag(partial_slabs_.Pop())};
+    dbg::Assert(slab.cache == this && slab.free_count > 0);
+    if (slab.free_count == obj_count_per_slab_) {
+        // An empty slab is being used.
+        dbg::Assert(empty_slab_count_ > 0);
+        --empty_slab_count_;
+    }
+
+    const auto idx {slab.first_free};
+    dbg::Assert(idx < obj_count_per_slab_);
+    slab.first_free = slab.GetFreeIdxs()[idx];
+    if (--slab.free_count > 0) {
+        partial_slabs_.PushFront(slab.tag);
+    }
+
+    --stats_.free_count;
+    ++stats_.used_count;
+    ++stats_.alloc_count;
+    return reinterpret_cast<stl::byte*>(&slab) + obj_offset_ + idx * obj_size_;
+}
+
+SlabCacheBase& SlabCacheBase::Free(void* const obj) noexcept {
+    dbg::Assert(obj);
+    const stl::lock_guard guard {mtx_};
+    if (IsPageObj()) {
+        return FreePage(obj);
+    }
+
+    auto& slab {Slab::GetByObj(obj)};
+    dbg::Assert(slab.cache == this, "The object does not belong to the slab cache.");
+    const auto offset {static_cast<stl::size_t>(static_cast<stl::byte*>(obj)
+                                                - reinterpret_cast<stl::byte*>(&slab))
+                       - obj_offset_};
+    dbg::Assert(offset % obj_size_ == 0);
+    const auto idx {offset / obj_size_};
+    dbg::Assert(idx < obj_count_per_slab_);
+
+    slab.GetFreeIdxs()[idx] = static_cast<stl::uint16_t>(slab.first_free);
+    slab.first_free = idx;
+    if (slab.free_count++ == 0) {
+        // A full slab has a free object again.
+        partial_slabs_.PushFront(slab.tag);
+    }
+
+    ++stats_.free_count;
+    --stats_.used_count;
+    ++stats_.release_count;
+
+    if (slab.free_count == obj_count_per_slab_) {
+        if (empty_slab_count_ < max_empty_slab_count) {
+            // Retain the empty slab to avoid creating a new slab in following allocations.
+            ++empty_slab_count_;
+        } else {
+            slab.tag.Detach();
+            stats_.free_count -= obj_count_per_slab_;
+            --stats_.slab_count;
+            FreePages(&slab);
+        }
+    }
+
+    return *this;
+}
+
+stl::size_t SlabCacheBase::Reserve(const stl::size_t count) noexcept {
+    const stl::lock_guard guard {mtx_};
+    if (IsPageObj()) {
+        while (free_page_count_ < stl::min(count, max_free_page_count)) {
+            const auto page {AllocPages(type_)};
+            if (!page) {
+                break;
+            }
+
+            if (ctor_) {
+                ctor_(page);
+            }
+
+            free_pages_[free_page_count_++] = page;
+            ++stats_.free_count;
+            ++stats_.slab_count;
+        }
+    } else {
+        while (stats_.free_count < count) {
+            if (const auto slab {CreateSlab()}; slab) {
+                partial_slabs_.PushBack(slab->tag);
+            } else {
+                break;
+            }
+        }
+    }
+
+    return stats_.free_count;
+}
+
+SlabCacheBase::Slab* SlabCacheBase::CreateSlab() noexcept {
+    const auto slab {AllocPages<Slab>(type_)};
+    if (!slab) {
+        return nullptr;
+    }
+
+    slab->tag = {};
+    slab->cache = this;
+    slab->free_count = obj_count_per_slab_;
+    slab->first_free = 0;
+    for (stl::size_t i {0}; i != obj_count_per_slab_; ++i) {
+        slab->GetFreeIdxs()[i] = static_cast<stl::uint16_t>(i + 1);
+        if (ctor_) {
+            ctor_(reinterpret_cast<stl::byte*>(slab) + obj_offset_ + i * obj_size_);
+        }
+    }
+
+    ++empty_slab_count_;
+    ++stats_.slab_count;
+    stats_.free_count += obj_count_per_slab_;
+    return slab;
+}
+
+stl::size_t SlabCacheBase::Shrink(const stl::size_t page_count) noexcept {
+    const stl::lock_guard guard {mtx_};
+    stl::size_t released {0};
+    while (released != page_count && free_page_count_ > 0) {
+        FreePages(free_pages_[--free_page_count_]);
+        --stats_.free_count;
+        --stats_.slab_count;
+        ++released;
+    }
+
+    while (released != page_count && empty_slab_count_ > 0) {
+        const auto tag {partial_slabs_.Find(
+            [](const TagList::Tag& tag, void* const cache) noexcept {
+                return Slab::GetByTag(tag).free_count
+                       == static_cast<const SlabCacheBase*>(cache)->obj_count_per_slab_;
+            },
+            this)};
+        dbg::Assert(tag);
+        tag->Detach();
+        --empty_slab_count_;
+        stats_.free_count -= obj_count_per_slab_;
+        --stats_.slab_count;
+        FreePages(&Slab::GetByTag(*tag));
+        ++released;
+    }
+
+    return released;
+}
+
+void* SlabCacheBase::AllocatePage() noexcept {
+    void* page {nullptr};
+    if (free_page_count_ > 0) {
+        page = free_pages_[--free_page_count_];
+        --stats_.free_count;
+    } else if (page = AllocPages(type_); page) {
+        if (ctor_) {
+            ctor_(page);
+        }
+
+        ++stats_.slab_count;
+    } else {
+        return nullptr;
+    }
+
+    ++stats_.used_count;
+    ++stats_.alloc_count;
+    return page;
+}
+
+SlabCacheBase& SlabCacheBase::FreePage(void* const page) noexcept {
+    dbg::Assert(AlignToPageBase(reinterpret_cast<stl::uintptr_t>(page))
+                == reinterpret_cast<stl::uintptr_t>(page));
+    if (free_page_count_ < max_free_page_count) {
+        // Keep the page for reuse.
+        free_pages_[free_page_count_++] = page;
+        ++stats_.free_count;
+    } else {
+        FreePages(page);
+        --stats_.slab_count;
+    }
+
+    --stats_.used_count;
+    ++stats_.release_count;
+    return *this;
+}
+
+stl::string_view SlabCacheBase::GetName() const noexcept {
+    return name_;
+}
+
+stl::size_t SlabCacheBase::GetObjSize() const noexcept {
+    return obj_size_;
+}
+
+stl::size_t SlabCacheBase::GetObjCountPerSlab() const noexcept {
+    return obj_count_per_slab_;
+}
+
+const SlabCacheBase::Stats& SlabCacheBase::GetStats() const noexcept {
+    return stats_;
+}
+
+}  // namespace mem
@@ -0,0 +1,354 @@
+#include "kernel/process/image.h"
+#include "kernel/debug/assert.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/disk/disk.h"
+#include "kernel/io/disk/file/file.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/process/elf.h"
+#include "kernel/process/proc.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/stl/mutex.h"
+
+namespace tsk {
+
+namespace {
+
+//! A physical page of a read-only segment shared by processes running the same executable.
+struct CachedPage {
+    bool IsUsed() const noexcept {
+        return phy_addr != 0;
+    }
+
+    //! The index node of the executable file.
+    stl::size_t inode_idx;
+    //! The file offset of the page.
+    stl::size_t offset;
+    //! The number of bytes read from the file. The rest are zeros.
+    stl::size_t size;
+    //! The physical address, or @p 0 if the entry is free.
+    stl::uintptr_t phy_addr;
+};
+
+/**
+ * @brief A wrapper of a global variable representing cached pages of read-only segments.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ *
+ * Each cached page holds a reference to its physical page, so it stays alive after processes unmap it.
+ */
+stl::array<CachedPage, Image::max_cached_page_count>& GetCachedPages() noexcept {
+    static stl::array<CachedPage, Image::max_cached_page_count> pages {};
+    return pages;
+}
+
+stl::mutex& GetPageCacheLock() noexcept {
+    static stl::mutex lock;
+    return lock;
+}
+
+//! Whether the headers describe a 32-bit @em x86 executable file.
+bool IsValidHeader(const elf::FileHeader& header) noexcept {
+    stl::uint32_t magic {0};
+    stl::memcpy(&magic, header.e_ident.data(), sizeof(magic));
+    return magic == elf::magic && header.e_ident[elf::ei_class] == elf::elf_class_32
+           && header.e_ident[elf::ei_data] == elf::elf_data_2lsb && header.e_type == elf::et_exec
+           && header.e_machine == elf::em_386 && header.e_phentsize == sizeof(elf::ProgHeader);
+}
+
+/**
+ * @brief Map a cached page into the current address space.
+ *
+ * @return Whether the page has been cached.
+ */
+bool MapCachedPage(const stl::size_t inode_idx, const stl::size_t offset, const stl::size_t size,
+                   mem::VrAddr page) noexcept {
+    for (const auto& cached : GetCachedPages()) {
+        if (cached.IsUsed() && cached.inode_idx == inode_idx && cached.offset == offset
+            && cached.size == size) {
+            auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::User)};
+            const stl::lock_guard guard {mem_pool.GetLock()};
+            mem_pool.SharePage(cached.phy_addr);
+            page.MapToPhyAddr(cached.phy_addr);
+            page.GetPageTabEntry().SetWritable(false);
+            page.FlushTlb();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Cache a loaded page.
+ *
+ * @details
+ * If the cache is full, a page no longer mapped by any process is replaced.
+ * Otherwise, the page is not cached and stays private.
+ */
+void CachePage(const stl::size_t inode_idx, const stl::size_t offset, const stl::size_t size,
+               const stl::uintptr_t phy_addr) noexcept {
+    auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    CachedPage* free {nullptr};
+    for (auto& cached : GetCachedPages()) {
+        if (!cached.IsUsed()) {
+            free = &cached;
+            break;
+        } else if (!free && mem_pool.GetRefCount(cached.phy_addr) == 1) {
+            free = &cached;
+        }
+    }
+
+    if (!free) {
+        return;
+    }
+
+    if (free->IsUsed()) {
+        mem_pool.FreePages(free->phy_addr);
+    }
+
+    mem_pool.SharePage(phy_addr);
+    *free = {inode_idx, offset, size, phy_addr};
+}
+
+}  // namespace
+
+bool Image::Segment::Contain(const stl::uintptr_t vr_addr) const noexcept {
+    return vr_base <= vr_addr && vr_addr < vr_base + page_count * mem::page_size;
+}
+
+bool Image::LoadPage(const stl::uintptr_t vr_addr) noexcept {
+    // Kernel threads have no images, and page faults may occur before threads are initialized.
+    const auto proc {Thread::GetCurrent().GetProcess()};
+    if (!proc) {
+        return false;
+    }
+
+    const auto& image {proc->GetImage()};
+    const auto seg {image.FindSeg(vr_addr)};
+    return seg && image.LoadPage(*seg, mem::AlignToPageBase(vr_addr));
+}
+
+bool Image::LoadPage(const Segment& seg, const stl::uintptr_t page_base) const noexcept {
+    const auto page_offset {page_base - seg.vr_base};
+    const auto size {page_offset < seg.file_size
+                         ? stl::min(seg.file_size - page_offset, mem::page_size)
+                         : 0};
+    if (size == 0 && seg.writable) {
+        // The page only contains zero-initialized data, which is mapped as a reserved page.
+        return false;
+    }
+
+    const auto& file {io::fs::GetFileTab()[global_]};
+    const auto offset {seg.offset + page_offset};
+    mem::VrAddr page {page_base};
+    const stl::lock_guard guard {GetPageCacheLock()};
+    // The page may have been loaded by another thread, or the fault is caused by writing to it.
+    if (page.IsMapped()) {
+        return false;
+    }
+
+    const auto shared {!seg.writable && size != 0};
+    if (shared && MapCachedPage(file.GetNodeIdx(), offset, size, page)) {
+        return true;
+    }
+
+    // Map a zeroed physical page, so bytes beyond the file data are zeros.
+    if (!mem::MapPageOnDemand(page_base)) {
+        return false;
+    }
+
+    // The faulting thread cannot be holding the partition lock,
+    // since file system calls only access user memory outside it.
+    if (size != 0) {
+        io::GetDefaultPart().ReadFileAt(file, offset, reinterpret_cast<void*>(page_base), size);
+    }
+
+    page.GetPageTabEntry().SetWritable(seg.writable);
+    page.FlushTlb();
+    if (shared) {
+        CachePage(file.GetNodeIdx(), offset, size, page.GetPageTabEntry().GetAddress());
+    }
+
+    return true;
+}
+
+bool Image::Open(const io::Path& path, const stl::uintptr_t vr_begin,
+                 const stl::uintptr_t vr_end) noexcept {
+    dbg::Assert(!IsOpen());
+    const auto local {io::File::Open(path, io::File::OpenMode::ReadOnly)};
+    if (!local.IsValid()) {
+        return false;
+    }
+
+    // The local descriptor is closed when the function returns.
+    const io::File file {local};
+    auto& file_tab {io::fs::GetFileTab()};
+    const auto global {ProcFileDescTab::GetGlobal(local)};
+    const auto& global_file {file_tab[global]};
+    if (global_file.IsPipe()) {
+        return false;
+    }
+
+    auto& part {io::GetDefaultPart()};
+    elf::FileHeader header;
+    if (part.ReadFileAt(global_file, 0, &header, sizeof(header)) != sizeof(header)
+        || !IsValidHeader(header)) {
+        io::Printf("The file '{}' is not an executable file.\n", path.GetPath());
+        return false;
+    }
+
+    seg_count_ = 0;
+    for (stl::size_t i {0}; i != header.e_phnum; ++i) {
+        elf::ProgHeader prog;
+        if (part.ReadFileAt(global_file, header.e_phoff + i * sizeof(prog), &prog, sizeof(prog))
+            != sizeof(prog)) {
+            return false;
+        } else if (prog.p_type != elf::pt_load || prog.p_memsz == 0) {
+            continue;
+        }
+
+        // The file offset and the virtual address must be at the same offset in a page,
+        // so the segment can be loaded page by page.
+        const auto page_offset {prog.p_vaddr % mem::page_size};
+        if (seg_count_ == max_seg_count || prog.p_offset % mem::page_size != page_offset
+            || prog.p_filesz > prog.p_memsz || prog.p_vaddr < vr_begin
+            || prog.p_memsz > vr_end - prog.p_vaddr) {
+            io::Printf("The file '{}' has an unsupported segment.\n", path.GetPath());
+            return false;
+        }
+
+        auto& seg {segs_[seg_count_]};
+        seg.vr_base = prog.p_vaddr - page_offset;
+        seg.page_count = mem::CalcPageCount(page_offset + prog.p_memsz);
+        seg.offset = prog.p_offset - page_offset;
+        seg.file_size = page_offset + prog.p_filesz;
+        seg.writable = (prog.p_flags & elf::pf_w) != 0;
+        // Segments cannot share pages, since each page has one owner.
+        for (stl::size_t j {0}; j != seg_count_; ++j) {
+            if (seg.vr_base < segs_[j].vr_base + segs_[j].page_count * mem::page_size
+                && segs_[j].vr_base < seg.vr_base + seg.page_count * mem::page_size) {
+                io::Printf("The file '{}' has overlapped segments.\n", path.GetPath());
+                return false;
+            }
+        }
+
+        ++seg_count_;
+    }
+
+    if (seg_count_ == 0 || !FindSeg(header.e_entry)) {
+        io::Printf("The file '{}' has no code entry.\n", path.GetPath());
+        return false;
+    }
+
+    {
+        // Pages are loaded on demand, so the file cannot be written while the image runs it.
+        const intr::IntrGuard guard;
+        if (!global_file.GetNode().DenyWriteForExec()) {
+            io::Printf("The file '{}' is being written.\n", path.GetPath());
+            return false;
+        }
+    }
+
+    // The image keeps the file open after the local descriptor is closed.
+    global_ = file_tab.DupDesc(global);
+    if (!global_.IsValid()) {
+        const intr::IntrGuard guard;
+        global_file.GetNode().AllowWriteForExec();
+        return false;
+    }
+
+    entry_ = header.e_entry;
+    return true;
+}
+
+Image& Image::Close() noexcept {
+    if (!IsOpen()) {
+        return *this;
+    }
+
+    auto& file_tab {io::fs::GetFileTab()};
+    {
+        const auto& inode {file_tab[global_].GetNode()};
+        const stl::lock_guard cache_guard {GetPageCacheLock()};
+        bool last {false};
+        {
+            const intr::IntrGuard guard;
+            last = inode.AllowWriteForExec();
+        }
+
+        // Free cached pages of the file that are no longer mapped by any process.
+        // After the last image is closed, the file may be rewritten,
+        // so all its cached pages are dropped and pages still mapped by processes become private.
+        auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::User)};
+        const stl::lock_guard mem_guard {mem_pool.GetLock()};
+        for (auto& cached : GetCachedPages()) {
+            if (cached.IsUsed() && cached.inode_idx == inode.idx
+                && (last || mem_pool.GetRefCount(cached.phy_addr) == 1)) {
+                mem_pool.FreePages(cached.phy_addr);
+                cached = {};
+            }
+        }
+    }
+
+    file_tab.FreeDesc(global_);
+    global_.Reset();
+    seg_count_ = 0;
+    entry_ = 0;
+    return *this;
+}
+
+bool Image::Map() const noexcept {
+    for (stl::size_t i {0}; i != seg_count_; ++i) {
+        const auto& seg {segs_[i]};
+        if (!mem::MapMem(seg.vr_base, seg.page_count * mem::page_size, mem::MapFlag::Fixed)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Image& Image::Fork() noexcept {
+    if (IsOpen()) {
+        auto& file_tab {io::fs::GetFileTab()};
+        global_ = file_tab.DupDesc(global_);
+        if (global_.IsValid()) {
+            // The parent image has denied writes to the file.
+            const intr::IntrGuard guard;
+            const auto denied {file_tab[global_].GetNode().DenyWriteForExec()};
+            dbg::Assert(denied);
+        } else {
+            // Pages that have not been loaded cannot be accessed by the child process.
+            io::PrintlnStr("The global file table is full.");
+            seg_count_ = 0;
+        }
+    }
+
+    return *this;
+}
+
+bool Image::IsOpen() const noexcept {
+    return global_.IsValid();
+}
+
+stl::uintptr_t Image::GetEntry() const noexcept {
+    return entry_;
+}
+
+const Image::Segment* Image::FindSeg(const stl::uintptr_t vr_addr) const noexcept {
+    for (stl::size_t i {0}; i != seg_count_; ++i) {
+        if (segs_[i].Contain(vr_addr)) {
+            return &segs_[i];
+        }
+    }
+
+    return nullptr;
+}
+
+}  // namespace tsk
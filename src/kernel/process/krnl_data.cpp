@@ -0,0 +1,76 @@
+#include "kernel/process/krnl_data.h"
+#include "kernel/debug/assert.h"
+#include "kernel/io/video/print.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/stl/mutex.h"
+
+namespace tsk {
+
+namespace {
+
+/**
+ * @brief A wrapper of a global variable representing the kernel-space alias of the kernel data page.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+KrnlData*& GetKrnlDataImpl() noexcept {
+    static KrnlData* data {nullptr};
+    return data;
+}
+
+//! Get the physical address of the kernel data page.
+stl::uintptr_t GetKrnlDataPhyAddr() noexcept {
+    return mem::VrAddr {&GetKrnlData()}.GetPhyAddr();
+}
+
+}  // namespace
+
+KrnlData& GetKrnlData() noexcept {
+    dbg::Assert(GetKrnlDataImpl(), "The kernel data page has not been initialized.");
+    return *GetKrnlDataImpl();
+}
+
+void MapKrnlData() noexcept {
+    const auto phy_addr {GetKrnlDataPhyAddr()};
+    auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    dbg::Assert(!mem::VrAddr {usr_krnl_data_base}.IsMapped());
+    mem::VrAddr {mem::GetVrAddrPool(mem::PoolType::User).AllocPageAtAddr(usr_krnl_data_base)}
+        .MapToPhyAddr(phy_addr)
+        .GetPageTabEntry()
+        .SetWritable(false);
+    // Each mapping holds a reference, so forking and freeing the page work as for other user pages.
+    mem_pool.SharePage(phy_addr);
+}
+
+void InitKrnlData() noexcept {
+    dbg::Assert(!GetKrnlDataImpl());
+    // The physical page comes from the user pool, since processes share it like a forked page.
+    stl::uintptr_t phy_addr {0};
+    {
+        auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::User)};
+        const stl::lock_guard guard {mem_pool.GetLock()};
+        phy_addr = mem_pool.AllocPages();
+    }
+
+    mem::AssertAlloc(phy_addr);
+    stl::uintptr_t vr_addr {0};
+    {
+        auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::Kernel)};
+        const stl::lock_guard guard {mem_pool.GetLock()};
+        vr_addr = mem::GetVrAddrPool(mem::PoolType::Kernel).AllocPages();
+    }
+
+    mem::AssertAlloc(vr_addr);
+    mem::VrAddr {vr_addr}.MapToPhyAddr(phy_addr);
+    const auto data {reinterpret_cast<KrnlData*>(vr_addr)};
+    stl::memset(data, 0, mem::page_size);
+    GetKrnlDataImpl() = data;
+    io::PrintlnStr("The kernel data page has been initialized.");
+}
+
+}  // namespace tsk
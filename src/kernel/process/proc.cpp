@@ -1,36 +1,111 @@
 #include "kernel/process/proc.h"
 #include "kernel/debug/assert.h"
+#include "kernel/debug/timeline.h"
 #include "kernel/interrupt/intr.h"
+#include "kernel/interrupt/work.h"
+#include "kernel/io/disk/file/file.h"
+#include "kernel/io/file/map.h"
+#include "kernel/io/file/ring.h"
 #include "kernel/io/io.h"
+#include "kernel/io/timer_wheel.h"
 #include "kernel/krnl.h"
 #include "kernel/memory/page.h"
+#include "kernel/memory/shrink.h"
+#include "kernel/memory/slab.h"
+#include "kernel/process/krnl_data.h"
+#include "kernel/stl/mutex.h"
+#include "kernel/util/bit.h"
 
 namespace tsk {
 
 namespace {
 inline constexpr stl::uintptr_t usr_stack_base {krnl_base - mem::page_size};
 
+/**
+ * @brief The maximum number of pages in a user stack.
+ *
+ * @details
+ * Only the top page is allocated when a process starts.
+ * The others are reserved and mapped on first access.
+ */
+inline constexpr stl::size_t usr_stack_page_count {256};
+
+/**
+ * @brief The base address of the user heap state page.
+ *
+ * @details
+ * User library code and data are in the kernel image, which is shared by all processes.
+ * So the user-space heap allocator saves its state in this page, which is private to each process.
+ * It must be the same as @p heap_state_base in @p src/user/memory/heap.cpp.
+ */
+inline constexpr stl::uintptr_t usr_heap_state_base {0x40000000};
+
+//! The backend of user virtual address pools.
+inline constexpr auto usr_vr_addr_pool_backend {mem::VrAddrPool::Backend::Range};
+
+//! The number of process control blocks, thread blocks and page directory tables kept ready.
+inline constexpr stl::size_t reserved_proc_count {8};
+
+//! The number of cached page directory tables below which the caches are refilled.
+inline constexpr stl::size_t proc_refill_watermark {reserved_proc_count / 2};
+
 extern "C" {
 //! Jump to the exit of interrupt routines.
 [[noreturn]] void JmpToIntrExit(const void* intr_stack) noexcept;
 }
 
+//! The size of the virtual address range of a user stack.
+inline constexpr stl::size_t usr_stack_size {usr_stack_page_count * mem::page_size};
+
+static_assert(Process::max_thd_count <= sizeof(stl::uint32_t) * bit::byte_len);
+
+//! Get the virtual base address of a user stack.
+stl::uintptr_t GetUsrStackBase(const stl::size_t idx) noexcept {
+    return usr_stack_base - idx * usr_stack_size - (usr_stack_page_count - 1) * mem::page_size;
+}
+
+//! Get the index of the user stack containing an address in its top page.
+stl::size_t GetUsrStackIdx(const stl::uintptr_t vr_addr) noexcept {
+    return (usr_stack_base - mem::AlignToPageBase(vr_addr)) / usr_stack_size;
+}
+
 /**
- * @brief Create and start a user process with a code entry.
+ * @brief Allocate a user stack in the current process.
  *
  * @details
- * User processes are created in kernel mode as threads.
- * To make them enter user mode, we can only use a interrupt return,
+ * Stacks are placed downwards from @p usr_stack_base, one for each thread.
+ * Only the top page is allocated. The others are reserved so the stack can grow on demand.
+ *
+ * @param idx The index of the stack.
+ * @return The stack top.
+ */
+stl::uintptr_t AllocUsrStack(const stl::size_t idx) noexcept {
+    dbg::Assert(idx < Process::max_thd_count);
+    const auto top_page {usr_stack_base - idx * usr_stack_size};
+    mem::AssertAlloc(mem::AllocPageAtAddr(mem::PoolType::User, top_page));
+    for (stl::size_t i {1}; i != usr_stack_page_count; ++i) {
+        mem::ReservePageAtAddr(mem::PoolType::User, top_page - i * mem::page_size);
+    }
+
+    return top_page + mem::page_size;
+}
+
+/**
+ * @brief Enter user mode.
+ *
+ * @details
+ * To make a thread enter user mode, we can only use a interrupt return,
  * which is the only way to lower the privilege.
- * 1. Create a thread with the callback @p StartProcess.
- * 2. In @p StartProcess:
- *     1. Prepare an interrupt stack with user selectors,
- *        and set the return address to the code entry.
- *     2. Jump to the interrupt exit.
+ * 1. Prepare an interrupt stack with user selectors,
+ *    and set the return address to the code entry.
+ * 2. Jump to the interrupt exit.
  * 3. Registers are restored according to the interrupt stack.
- * 4. The process runs from the code entry.
+ * 4. The thread runs from the code entry.
+ *
+ * @param code The code entry.
+ * @param stack The user stack pointer.
  */
-[[noreturn]] void StartProcess(void* const code) noexcept {
+[[noreturn]] void EnterUsrMode(const void* const code, const stl::uintptr_t stack) noexcept {
     dbg::Assert(code);
     intr::IntrStack intr_stack {};
     // User processes should use user selectors.
@@ -41,31 +116,698 @@ extern "C" {
     intr_stack.old_cs = sel::usr_code;
     intr_stack.old_ss = sel::usr_data;
     // The return address is set to the code entry.
-    // When the process returns from the interrupt, it will run this code.
+    // When the thread returns from the interrupt, it will run this code.
     intr_stack.old_eip = reinterpret_cast<stl::uintptr_t>(code);
-    const auto stack {mem::AllocPageAtAddr(mem::PoolType::User, usr_stack_base)};
-    mem::AssertAlloc(stack);
-    intr_stack.old_esp = reinterpret_cast<stl::uintptr_t>(stack) + mem::page_size;
+    intr_stack.old_esp = stack;
     JmpToIntrExit(&intr_stack);
 }
 
+/**
+ * @brief Allocate the first user stack and private pages in the current process, then enter user mode.
+ *
+ * @param code The code entry.
+ */
+[[noreturn]] void StartMainThread(const void* const code) noexcept {
+    const auto stack {AllocUsrStack(0)};
+    // The heap state page is zeroed on first access.
+    mem::ReservePageAtAddr(mem::PoolType::User, usr_heap_state_base);
+    MapKrnlData();
+    dbg::MarkFirstUsrProc();
+    EnterUsrMode(code, stack);
+}
+
+/**
+ * @brief Start a user process with a code entry.
+ *
+ * @details
+ * User processes are created in kernel mode as threads.
+ */
+[[noreturn]] void StartProcess(void* const code) noexcept {
+    StartMainThread(code);
+}
+
+/**
+ * @brief Start the image of the current process loaded from an executable file.
+ *
+ * @details
+ * Segments are reserved in the current address space and loaded on first access.
+ */
+[[noreturn]] void StartImage(void* = nullptr) noexcept {
+    const auto& image {Process::GetCurrent()->GetImage()};
+    // Segments are in range and do not overlap, so they can always be reserved in an empty pool.
+    const auto mapped {image.Map()};
+    dbg::Assert(mapped, "Failed to reserve segments of an image.");
+    StartMainThread(reinterpret_cast<const void*>(image.GetEntry()));
+}
+
+/**
+ * @brief A wrapper of a global variable saving all processes that have not been freed.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+TagList& GetProcList() noexcept {
+    static TagList procs;
+    return procs;
+}
+
+/**
+ * @brief A wrapper of a global variable saving exited orphan processes waiting to be freed.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+TagList& GetOrphanList() noexcept {
+    static TagList orphans;
+    return orphans;
+}
+
+/**
+ * @brief A wrapper of a global variable retrying to free orphan processes when the work queue is full.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+io::KrnlTimer& GetOrphanTimer() noexcept {
+    static io::KrnlTimer timer;
+    return timer;
+}
+
+/**
+ * @brief A wrapper of a global variable saving threads waiting for child processes to exit.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+sync::WaitQueue& GetExitQueue() noexcept {
+    static sync::WaitQueue waiters;
+    return waiters;
+}
+
+/**
+ * @brief A wrapper of a global variable saving process control blocks.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+mem::SlabCache<Process, mem::page_size>& GetProcCache() noexcept {
+    static mem::SlabCache<Process, mem::page_size> cache {"process"};
+    return cache;
+}
+
+//! Allocate a page directory table and copy kernel page directory entries to it.
+mem::PageEntry* CreatePageDir() noexcept {
+    const auto page_dir {mem::AllocPages<mem::PageEntry>(mem::PoolType::Kernel)};
+    if (!page_dir) {
+        return nullptr;
+    }
+
+    // All processes copy the same kernel page directory entries to share kernel memory.
+    stl::memcpy(
+        page_dir + mem::krnl_page_dir_start,
+        reinterpret_cast<const mem::PageEntry*>(mem::page_dir_base) + mem::krnl_page_dir_start,
+        mem::krnl_page_dir_count * sizeof(mem::PageEntry));
+
+    // Make the last page directory entry refer to the page directory table itself.
+    const auto phy_addr {mem::VrAddr {page_dir}.GetPhyAddr()};
+    page_dir[mem::page_dir_self_ref] = {phy_addr, true, false};
+    return page_dir;
+}
+
+/**
+ * @brief The cache of page directory tables ready for new processes.
+ *
+ * @details
+ * Kernel page directory entries never change after booting,
+ * and user entries are cleared when a process releases its memory.
+ * So a freed table can be reused without copying kernel entries again.
+ */
+class PageDirCache {
+public:
+    PageDirCache() noexcept {
+        mem::RegisterShrinker(&Shrink, this);
+    }
+
+    //! Get a cached table, or create one if the cache is empty.
+    mem::PageEntry* Allocate() noexcept {
+        {
+            const intr::IntrGuard guard;
+            if (count_ > 0) {
+                return page_dirs_[--count_];
+            }
+        }
+
+        return CreatePageDir();
+    }
+
+    //! Cache a table whose user entries have been cleared, or free it if the cache is full.
+    PageDirCache& Free(mem::PageEntry* const page_dir) noexcept {
+        dbg::AssertSlow([page_dir]() noexcept {
+            for (stl::size_t i {0}; i != mem::krnl_page_dir_start; ++i) {
+                if (page_dir[i].IsPresent()) {
+                    return false;
+                }
+            }
+
+            return true;
+        });
+
+        {
+            const intr::IntrGuard guard;
+            if (count_ < page_dirs_.size()) {
+                page_dirs_[count_++] = page_dir;
+                return *this;
+            }
+        }
+
+        mem::FreePages(page_dir);
+        return *this;
+    }
+
+    stl::size_t GetCount() const noexcept {
+        const intr::IntrGuard guard;
+        return count_;
+    }
+
+    /**
+     * @brief Refill process caches in the background if there are too few cached tables.
+     *
+     * @details
+     * Only one work item is scheduled at a time.
+     */
+    PageDirCache& ScheduleRefill() noexcept {
+        const intr::IntrGuard guard;
+        if (!refilling_ && count_ < proc_refill_watermark) {
+            refilling_ = intr::ScheduleWork(&Refill, this);
+        }
+
+        return *this;
+    }
+
+private:
+    //! Reserve process control blocks and thread blocks, and create tables until the cache is full.
+    static void Refill(void* const arg) noexcept {
+        auto& cache {*static_cast<PageDirCache*>(arg)};
+        GetProcCache().Reserve(reserved_proc_count);
+        ReserveThreadBlocks(reserved_proc_count);
+        // Allocations may shrink the cache under memory pressure, so attempts are limited.
+        for (stl::size_t i {0}; i != cache.page_dirs_.size(); ++i) {
+            if (cache.GetCount() == cache.page_dirs_.size()) {
+                break;
+            }
+
+            if (const auto page_dir {CreatePageDir()}; page_dir) {
+                cache.Free(page_dir);
+            } else {
+                break;
+            }
+        }
+
+        const intr::IntrGuard guard;
+        cache.refilling_ = false;
+    }
+
+    //! Free cached tables under memory pressure.
+    static stl::size_t Shrink(const mem::PoolType type, const stl::size_t page_count,
+                              void* const arg) noexcept {
+        if (type != mem::PoolType::Kernel) {
+            return 0;
+        }
+
+        auto& cache {*static_cast<PageDirCache*>(arg)};
+        stl::size_t released {0};
+        while (released != page_count) {
+            mem::PageEntry* page_dir {nullptr};
+            {
+                const intr::IntrGuard guard;
+                if (cache.count_ == 0) {
+                    break;
+                }
+
+                page_dir = cache.page_dirs_[--cache.count_];
+            }
+
+            mem::FreePages(page_dir);
+            ++released;
+        }
+
+        return released;
+    }
+
+    stl::array<mem::PageEntry*, reserved_proc_count> page_dirs_;
+    stl::size_t count_ {0};
+    //! Whether a refill work item has been scheduled.
+    bool refilling_ {false};
+};
+
+/**
+ * @brief A wrapper of a global variable saving cached page directory tables.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+PageDirCache& GetPageDirCache() noexcept {
+    static PageDirCache cache;
+    return cache;
+}
+
+/**
+ * @brief Allocate a process control block.
+ *
+ * @details
+ * Blocks are reused from the slab cache, so they are zeroed as newly allocated pages.
+ */
+Process* AllocProc() noexcept {
+    const auto proc {GetProcCache().Allocate()};
+    mem::AssertAlloc(proc);
+    stl::memset(proc, 0, sizeof(Process));
+    return proc;
+}
+
 }  // namespace
 
 Process& Process::Create(const stl::string_view name, void* const code) noexcept {
-    const auto proc {mem::AllocPages<Process>(mem::PoolType::Kernel)};
-    mem::AssertAlloc(proc);
-    return proc->Init(name, code);
+    return AllocProc()->Init(name, code);
 }
 
 Process& Process::Init(const stl::string_view name, void* const code) noexcept {
     dbg::Assert(code);
+    Init(npos);
+    // The main thread is freed when it exits, since no one joins it.
+    main_thd_ = &CreateThread(name, default_priority, &StartProcess, code).Detach();
+    return *this;
+}
+
+Process& Process::Init(const stl::size_t parent_pid) noexcept {
     InitVrAddrPool();
     InitPageDir();
     InitMemBlockDescTab();
     file_descs_.Init();
+    image_ = {};
     pid_ = CreateNewPid();
-    parent_pid_ = npos;
-    main_thd_ = &CreateThread(name, default_priority, &StartProcess, code);
+    parent_pid_ = parent_pid;
+    main_thd_ = nullptr;
+    // The main thread uses the first user stack.
+    usr_stacks_ = 1;
+    usr_thd_count_ = 1;
+    live_thd_count_ = 0;
+    exit_waiters_.Init();
+    exit_status_ = 0;
+    exited_ = false;
+    waited_ = false;
+    {
+        const intr::IntrGuard guard;
+        GetProcList().PushBack(tag_);
+    }
+
+    return *this;
+}
+
+stl::size_t Process::Spawn(const char* const path, const stl::size_t* const descs,
+                           const stl::size_t desc_count) noexcept {
+    const auto proc {GetCurrent()};
+    dbg::Assert(proc);
+    if (!path || (!descs && desc_count != 0)
+        || desc_count > max_open_file_count - io::std_stream_count) {
+        return npos;
+    }
+
+    // The array is in user memory and may be changed by other threads, so it is only read once.
+    // Its copy is too large for the kernel stack when many descriptors are inherited.
+    io::FileDesc* globals {nullptr};
+    if (desc_count != 0) {
+        globals = mem::AllocateUninit<io::FileDesc>(mem::PoolType::Kernel,
+                                                    desc_count * sizeof(io::FileDesc));
+        if (!globals) {
+            return npos;
+        }
+    }
+
+    stl::size_t pid {npos};
+    stl::size_t forked_count {0};
+    auto& file_tab {io::fs::GetFileTab()};
+    const io::Path exe_path {path};
+    Image image;
+    for (stl::size_t i {0}; i != desc_count; ++i) {
+        const auto local {descs[i]};
+        if (!proc->file_descs_.IsOpen(local)) {
+            goto cleanup;
+        }
+
+        globals[i] = proc->file_descs_.GetGlobal(local);
+    }
+
+    if (!image.Open(exe_path, image_base, usr_heap_state_base)) {
+        goto cleanup;
+    }
+
+    // Inherited descriptors are forked before the child is created, so a failure is easy to undo.
+    // Skipping a descriptor instead would renumber the following ones in the child process.
+    for (; forked_count != desc_count; ++forked_count) {
+        const auto forked {file_tab.ForkDesc(globals[forked_count])};
+        if (!forked.IsValid()) {
+            goto cleanup;
+        }
+
+        globals[forked_count] = forked;
+    }
+
+    pid = SpawnChild(proc->pid_, exe_path, image, globals, desc_count);
+    if (pid != npos) {
+        // The child owns the image and the forked descriptors now.
+        forked_count = 0;
+        image = {};
+    }
+
+cleanup:
+    for (stl::size_t i {0}; i != forked_count; ++i) {
+        file_tab.FreeDesc(globals[i]);
+    }
+
+    image.Close();
+    if (globals) {
+        mem::Free(mem::PoolType::Kernel, globals);
+    }
+
+    return pid;
+}
+
+stl::size_t Process::SpawnChild(const stl::size_t parent_pid, const io::Path& path,
+                                const Image& image, const io::FileDesc* const globals,
+                                const stl::size_t desc_count) noexcept {
+    dbg::Assert(globals || desc_count == 0);
+    const auto child {AllocProc()};
+    child->Init(parent_pid);
+    // Inherited descriptors are numbered in order after standard streams in the child process.
+    for (stl::size_t i {0}; i != desc_count; ++i) {
+        if (!child->file_descs_.SyncGlobal(globals[i]).IsValid()) {
+            // The descriptors are still owned by the caller, so only the local ones are reset.
+            for (stl::size_t j {0}; j != i; ++j) {
+                child->file_descs_.Reset(io::std_stream_count + j);
+            }
+
+            child->file_descs_.CloseAll();
+            {
+                const intr::IntrGuard guard;
+                child->tag_.Detach();
+                child->exited_ = true;
+            }
+
+            child->Free();
+            return npos;
+        }
+    }
+
+    child->image_ = image;
+    child->main_thd_ =
+        &child->CreateThread(path.GetFileName(), default_priority, &StartImage).Detach();
+    return child->pid_;
+}
+
+void Process::ExitCurrThread() noexcept {
+    const auto proc {GetCurrent()};
+    dbg::Assert(proc);
+    bool last {false};
+    {
+        const intr::IntrGuard guard;
+        dbg::Assert(proc->usr_thd_count_ > 0);
+        last = --proc->usr_thd_count_ == 0;
+    }
+
+    auto& thd {Thread::GetCurrent()};
+    if (last) {
+        proc->Release();
+    } else {
+        // The stack can be reused by a new thread.
+        proc->FreeUsrStack(thd.usr_stack_idx_);
+    }
+
+    thd.Exit();
+}
+
+void Process::ExitCurrent(const stl::int32_t status) noexcept {
+    const auto proc {GetCurrent()};
+    dbg::Assert(proc);
+    {
+        const intr::IntrGuard guard;
+        proc->exit_status_ = status;
+    }
+
+    ExitCurrThread();
+}
+
+bool Process::Wait(const stl::size_t pid, stl::int32_t* const status) noexcept {
+    const auto proc {GetCurrent()};
+    dbg::Assert(proc);
+    Process* child {nullptr};
+    {
+        const intr::IntrGuard guard;
+        child = FindChild(proc->pid_, pid);
+        if (!child || child->waited_) {
+            return false;
+        }
+
+        child->waited_ = true;
+        while (!child->exited_) {
+            GetExitQueue().Wait();
+        }
+
+        child->tag_.Detach();
+    }
+
+    if (status) {
+        *status = child->exit_status_;
+    }
+
+    child->Free();
+    return true;
+}
+
+bool Process::ExecCurrent(const char* const path) noexcept {
+    const auto proc {GetCurrent()};
+    dbg::Assert(proc);
+    if (!path) {
+        return false;
+    }
+
+    {
+        // Other threads would lose their code and stacks.
+        const intr::IntrGuard guard;
+        if (proc->usr_thd_count_ != 1) {
+            io::PrintlnStr("A process with multiple threads cannot run another image.");
+            return false;
+        }
+    }
+
+    // The path is in user memory, so the file is opened before the memory is released.
+    Image image;
+    if (!image.Open(io::Path {path}, image_base, usr_heap_state_base)) {
+        return false;
+    }
+
+    proc->ReleaseMem();
+    // Heap arenas have been freed with user memory.
+    proc->InitMemBlockDescTab();
+    // The current thread becomes the main thread with the first user stack.
+    proc->usr_stacks_ = 1;
+    Thread::GetCurrent().usr_stack_idx_ = 0;
+    proc->image_ = image;
+    StartImage();
+}
+
+Process* Process::FindChild(const stl::size_t parent_pid, const stl::size_t pid) noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    struct Finder {
+        stl::size_t parent_pid;
+        stl::size_t pid;
+    };
+
+    Finder finder {parent_pid, pid};
+    const auto tag {GetProcList().Find(
+        [](const TagList::Tag& tag, void* const arg) noexcept {
+            const auto& finder {*static_cast<const Finder*>(arg)};
+            const auto& proc {tag.GetElem<Process>()};
+            return proc.parent_pid_ == finder.parent_pid
+                   && (finder.pid == npos || proc.pid_ == finder.pid);
+        },
+        &finder)};
+    return tag ? &tag->GetElem<Process>() : nullptr;
+}
+
+Process& Process::OnThreadCreated() noexcept {
+    const intr::IntrGuard guard;
+    dbg::Assert(!exited_);
+    ++live_thd_count_;
+    return *this;
+}
+
+Process& Process::OnThreadExited() noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    dbg::Assert(live_thd_count_ > 0);
+    if (--live_thd_count_ != 0) {
+        // The last user thread may be waiting for other threads to exit.
+        exit_waiters_.WakeAll();
+        return *this;
+    }
+
+    exited_ = true;
+    if (parent_pid_ != npos) {
+        // The parent process frees the process when it waits.
+        GetExitQueue().WakeAll();
+    } else {
+        // The page directory table is still loaded until the last thread is switched out.
+        tag_.Detach();
+        GetOrphanList().PushBack(tag_);
+        if (!intr::ScheduleWork(&FreeOrphans)) {
+            // The work queue is shared with interrupt handlers and may be full.
+            // A kernel timer retries at every tick until the queue has space.
+            if (auto& timer {GetOrphanTimer()}; !timer.IsPending()) {
+                timer.Init(&FreeOrphans).Start(0);
+            }
+        }
+    }
+
+    return *this;
+}
+
+Process& Process::ReleaseMem() noexcept {
+    dbg::Assert(GetCurrent() == this);
+    // The worker thread of I/O rings accesses process memory.
+    io::IoRing::Release();
+    {
+        // Other threads may have started exiting but still be running.
+        const intr::IntrGuard guard;
+        while (live_thd_count_ != 1) {
+            exit_waiters_.Wait();
+        }
+    }
+
+    io::FileMap::UnmapAll();
+    // Cached blocks are in user memory, so they must be drained before the memory is freed.
+    mem::DrainMemBlockMagazines();
+    mem::FreeUsrMem();
+    // Reloading the page directory table flushes all user TLB entries at once.
+    Thread::GetCurrent().LoadPageDir();
+    // Cached pages of the image can only be freed after they are unmapped.
+    image_.Close();
+    return *this;
+}
+
+Process& Process::Release() noexcept {
+    ReleaseMem();
+    file_descs_.CloseAll();
+    return ReleaseChildren();
+}
+
+Process& Process::ReleaseChildren() noexcept {
+    while (true) {
+        Process* child {nullptr};
+        {
+            const intr::IntrGuard guard;
+            child = FindChild(pid_);
+            if (!child) {
+                break;
+            }
+
+            child->parent_pid_ = npos;
+            if (!child->exited_) {
+                // The child frees itself when it exits.
+                continue;
+            }
+
+            child->tag_.Detach();
+        }
+
+        child->Free();
+    }
+
+    return *this;
+}
+
+void Process::Free() noexcept {
+    dbg::Assert(exited_);
+    if (vr_addrs_.GetBackend() == mem::VrAddrPool::Backend::Bitmap) {
+        const auto& bitmap {vr_addrs_.GetBitmap()};
+        mem::FreePages(const_cast<void*>(bitmap.GetBits()),
+                       mem::CalcPageCount(bitmap.GetByteLen()));
+    }
+
+    GetPageDirCache().Free(page_dir_);
+    GetProcCache().Free(this);
+}
+
+void Process::FreeOrphans(void*) noexcept {
+    auto& orphans {GetOrphanList()};
+    while (true) {
+        Process* proc {nullptr};
+        {
+            const intr::IntrGuard guard;
+            if (orphans.IsEmpty()) {
+                return;
+            }
+
+            proc = &orphans.Pop().GetElem<Process>();
+        }
+
+        proc->Free();
+    }
+}
+
+bool Process::StartThread(void* const code, void* const arg) noexcept {
+    // The user stack is allocated in the current address space.
+    dbg::Assert(GetCurrent() == this);
+    if (!code) {
+        return false;
+    }
+
+    stl::size_t stack_idx {0};
+    {
+        const intr::IntrGuard guard;
+        while (stack_idx != max_thd_count && bit::IsBitSet(usr_stacks_, stack_idx)) {
+            ++stack_idx;
+        }
+
+        if (stack_idx == max_thd_count) {
+            return false;
+        }
+
+        bit::SetBit(usr_stacks_, stack_idx);
+    }
+
+    // Build a frame as if the code entry was called with the argument.
+    // The code entry is saved above the frame for `StartUsrThread`.
+    const auto frame {reinterpret_cast<stl::uintptr_t*>(AllocUsrStack(stack_idx)) - 3};
+    frame[0] = 0;
+    frame[1] = reinterpret_cast<stl::uintptr_t>(arg);
+    frame[2] = reinterpret_cast<stl::uintptr_t>(code);
+    {
+        const intr::IntrGuard guard;
+        ++usr_thd_count_;
+    }
+
+    CreateThread(Thread::GetCurrent().GetName(), default_priority, &StartUsrThread, frame).Detach();
+    return true;
+}
+
+void Process::StartUsrThread(void* const stack) noexcept {
+    const auto frame {static_cast<const stl::uintptr_t*>(stack)};
+    // The frame address is kept by the kernel, so the index cannot be changed by user code.
+    Thread::GetCurrent().usr_stack_idx_ = GetUsrStackIdx(reinterpret_cast<stl::uintptr_t>(stack));
+    EnterUsrMode(reinterpret_cast<const void*>(frame[2]), reinterpret_cast<stl::uintptr_t>(stack));
+}
+
+Process& Process::FreeUsrStack(const stl::size_t idx) noexcept {
+    dbg::Assert(GetCurrent() == this && idx < max_thd_count);
+    const auto unmapped {mem::UnmapMem(reinterpret_cast<void*>(GetUsrStackBase(idx)), usr_stack_size)};
+    dbg::Assert(unmapped, "Failed to free a user stack.");
+    const intr::IntrGuard guard;
+    bit::ResetBit(usr_stacks_, idx);
     return *this;
 }
 
@@ -91,11 +833,16 @@ Thread& Process::CreateThread(const stl::string_view name, const stl::size_t pri
 
 Process& Process::InitVrAddrPool() noexcept {
     // This virtual address pool only allocates user-space addresses.
-    const auto byte_len {(krnl_base - image_base) / mem::page_size / bit::byte_len};
-    const auto page_count {mem::CalcPageCount(byte_len)};
-    const auto bits {mem::AllocPages(mem::PoolType::Kernel, page_count)};
-    mem::AssertAlloc(bits);
-    vr_addrs_.Init(image_base, {bits, byte_len});
+    const auto vr_page_count {(krnl_base - image_base) / mem::page_size};
+    if constexpr (usr_vr_addr_pool_backend == mem::VrAddrPool::Backend::Range) {
+        vr_addrs_.Init(image_base, vr_page_count);
+    } else {
+        const auto byte_len {vr_page_count / bit::byte_len};
+        const auto bits {mem::AllocPages(mem::PoolType::Kernel, mem::CalcPageCount(byte_len))};
+        mem::AssertAlloc(bits);
+        vr_addrs_.Init(image_base, {bits, byte_len});
+    }
+
     return *this;
 }
 
@@ -105,27 +852,19 @@ Process& Process::InitMemBlockDescTab() noexcept {
 }
 
 Process& Process::InitPageDir() noexcept {
-    page_dir_ = mem::AllocPages<mem::PageEntry>(mem::PoolType::Kernel);
+    auto& cache {GetPageDirCache()};
+    page_dir_ = cache.Allocate();
     mem::AssertAlloc(page_dir_);
-
-    // All processes copy the same kernel page directory entries to share kernel memory.
-    stl::memcpy(
-        page_dir_ + mem::krnl_page_dir_start,
-        reinterpret_cast<const mem::PageEntry*>(mem::page_dir_base) + mem::krnl_page_dir_start,
-        mem::krnl_page_dir_count * sizeof(mem::PageEntry));
-
-    // Make the last page directory entry refer to the page directory table itself.
-    const auto phy_addr {mem::VrAddr {page_dir_}.GetPhyAddr()};
-    page_dir_[mem::page_dir_self_ref] = {phy_addr, true, false};
+    cache.ScheduleRefill();
     return *this;
 }
 
-FileDescTab<max_open_file_count>& Process::GetFileDescTab() noexcept {
-    return const_cast<FileDescTab<max_open_file_count>&>(
+FileDescTab& Process::GetFileDescTab() noexcept {
+    return const_cast<FileDescTab&>(
         const_cast<const Process&>(*this).GetFileDescTab());
 }
 
-const FileDescTab<max_open_file_count>& Process::GetFileDescTab() const noexcept {
+const FileDescTab& Process::GetFileDescTab() const noexcept {
     return file_descs_;
 }
 
@@ -142,6 +881,10 @@ mem::VrAddrPool& Process::GetVrAddrPool() noexcept {
     return const_cast<mem::VrAddrPool&>(const_cast<const Process&>(*this).GetVrAddrPool());
 }
 
+const Image& Process::GetImage() const noexcept {
+    return image_;
+}
+
 const mem::PageEntry* Process::GetPageDir() const noexcept {
     return page_dir_;
 }
@@ -175,8 +918,7 @@ stl::size_t Process::CreateNewPid() noexcept {
 }
 
 const Process& Process::CopyFileDescTabTo(Process& child) const noexcept {
-    child.file_descs_ = file_descs_;
-    child.file_descs_.Fork();
+    child.file_descs_.CopyFrom(file_descs_).Fork();
     return *this;
 }
 
@@ -187,24 +929,53 @@ Process& Process::CopyFileDescTabTo(Process& child) noexcept {
 const Process& Process::CopyMemTo(Process& child, void* const buf,
                                   const stl::size_t buf_size) const noexcept {
     dbg::Assert(buf && buf_size >= mem::page_size);
-    dbg::Assert(main_thd_ && child.main_thd_);
+    dbg::Assert(child.main_thd_);
     dbg::Assert(child.main_thd_->proc_ == &child);
-    for (stl::size_t i {0}; i != vr_addrs_.GetBitmap().GetCapacity(); ++i) {
-        // If a virtual memory page is allocated, copy it to the child process.
-        if (vr_addrs_.GetBitmap().IsAlloc(i)) {
-            // Copy data from the current process to a kernel buffer.
-            const auto addr {vr_addrs_.GetStartAddr() + i * mem::page_size};
-            stl::memcpy(buf, reinterpret_cast<const void*>(addr), mem::page_size);
+    child.vr_addrs_.CopyFrom(vr_addrs_);
+
+    auto& mem_pool {mem::GetPhyMemPagePool(mem::PoolType::User)};
+    const stl::lock_guard guard {mem_pool.GetLock()};
+    const auto page_dir {reinterpret_cast<mem::PageEntry*>(mem::page_dir_base)};
+    for (auto i {mem::VrAddr {image_base}.GetPageDirEntryIdx()}; i != mem::krnl_page_dir_start;
+         ++i) {
+        if (!page_dir[i].IsPresent()) {
+            continue;
+        }
 
-            // Load the page directory table of the child process to access its virtual memory.
-            child.main_thd_->LoadPageDir();
-            // Allocate a memory page at the same virtual address in the child process.
-            mem::AllocPageAtAddr(mem::PoolType::User, child.vr_addrs_, addr);
+        // Mark all writable pages as copy-on-write pages, which are shared by both processes.
+        // Pages of shared memory regions stay writable.
+        const auto page_tab {
+            reinterpret_cast<mem::PageEntry*>(static_cast<stl::uintptr_t>(mem::VrAddr {
+                mem::page_dir_self_ref, i, 0}))};
+        for (stl::size_t j {0}; j != mem::page_dir_count; ++j) {
+            if (auto& entry {page_tab[j]}; entry.IsPresent()) {
+                if (entry.IsWritable() && !entry.IsShared()) {
+                    entry.SetWritable(false).SetCopyOnWrite();
+                }
+
+                mem_pool.SharePage(entry.GetAddress());
+            }
+        }
+
+        // Copy the page table to a kernel buffer.
+        stl::memcpy(buf, page_tab, mem::page_size);
 
-            // Copy data from the kernel buffer to the child process.
-            stl::memcpy(reinterpret_cast<void*>(addr), buf, mem::page_size);
-            main_thd_->LoadPageDir();
+        // Allocate a page table for the child process.
+        stl::uintptr_t page_tab_phy_base {0};
+        {
+            auto& krnl_mem_pool {mem::GetPhyMemPagePool(mem::PoolType::Kernel)};
+            const stl::lock_guard krnl_guard {krnl_mem_pool.GetLock()};
+            page_tab_phy_base = krnl_mem_pool.AllocPages();
         }
+
+        mem::AssertAlloc(page_tab_phy_base);
+        child.page_dir_[i] = {page_tab_phy_base, true, false};
+
+        // Load the page directory table of the child process to access its page table.
+        child.main_thd_->LoadPageDir();
+        stl::memcpy(page_tab, buf, mem::page_size);
+        // Reloading the page directory table also flushes TLB entries of pages that have become read-only.
+        Thread::GetCurrent().LoadPageDir();
     }
 
     return *this;
@@ -216,17 +987,19 @@ Process& Process::CopyMemTo(Process& child, void* const buf, const stl::size_t b
 
 stl::size_t Process::Fork() const noexcept {
     dbg::Assert(!intr::IsIntrEnabled());
-    const auto child {mem::AllocPages<Process>(mem::PoolType::Kernel)};
-    mem::AssertAlloc(child);
-    child->pid_ = CreateNewPid();
+    const auto child {AllocProc()};
     // The parent of the child process is the current process.
-    child->parent_pid_ = pid_;
-    child->InitMemBlockDescTab();
-    child->InitVrAddrPool();
-    child->InitPageDir();
-    child->main_thd_ = &main_thd_->Fork();
+    child->Init(pid_);
+    // Only the calling thread is copied, which becomes the main thread of the child process.
+    // The child process keeps the user stacks of other threads, which are not reused.
+    child->usr_stacks_ = usr_stacks_;
+    child->live_thd_count_ = 1;
+    child->main_thd_ = &Thread::GetCurrent().Fork();
     child->main_thd_->proc_ = child;
+    child->main_thd_->Detach();
     CopyFileDescTabTo(*child);
+    child->image_ = image_;
+    child->image_.Fork();
     const auto buf {mem::AllocPages(mem::PoolType::Kernel)};
     CopyMemTo(*child, buf, mem::page_size);
     mem::FreePages(buf);
@@ -24,7 +24,11 @@ TaskStateSeg& GetTaskStateSeg() noexcept {
 }
 
 TaskStateSeg& TaskStateSeg::Update(const Thread& thd) noexcept {
-    esp0 = thd.GetKrnlStackBottom();
+    // The kernel stack is unchanged if a user thread is switched back to itself after the idle thread or kernel threads.
+    if (const auto stack {thd.GetKrnlStackBottom()}; esp0 != stack) {
+        esp0 = stack;
+    }
+
     return *this;
 }
 
@@ -0,0 +1,79 @@
+%include "kernel/util/metric.inc"
+
+[bits 32]
+section     .text
+
+global      CopyDoubleWords
+; Copy a number of double words by `rep movsd`.
+; ```c++
+; void CopyDoubleWords(void* dest, const void* src, std::size_t count) noexcept;
+; ```
+CopyDoubleWords:
+    %push   copy_double_words
+    %stacksize  flat
+    %arg    dest:dword, src:dword, count:dword
+        enter   B(0), 0
+        push    esi
+        push    edi
+        cld
+        mov     edi, [dest]
+        mov     esi, [src]
+        mov     ecx, [count]
+        rep     movsd
+        pop     edi
+        pop     esi
+        leave
+        ret
+    %pop
+
+global      SetDoubleWords
+; Fill a number of double words with a value by `rep stosd`.
+; ```c++
+; void SetDoubleWords(void* dest, std::uint32_t val, std::size_t count) noexcept;
+; ```
+SetDoubleWords:
+    %push   set_double_words
+    %stacksize  flat
+    %arg    dest:dword, val:dword, count:dword
+        enter   B(0), 0
+        push    edi
+        cld
+        mov     edi, [dest]
+        mov     eax, [val]
+        mov     ecx, [count]
+        rep     stosd
+        pop     edi
+        leave
+        ret
+    %pop
+
+global      CompareDoubleWords
+; Compare a number of double words by `repe cmpsd`.
+; ```c++
+; std::size_t CompareDoubleWords(const void* lhs, const void* rhs, std::size_t count) noexcept;
+; ```
+; It returns the index of the first different double word, or `count` if they are all equal.
+CompareDoubleWords:
+    %push   compare_double_words
+    %stacksize  flat
+    %arg    lhs:dword, rhs:dword, count:dword
+        enter   B(0), 0
+        push    esi
+        push    edi
+        cld
+        mov     esi, [lhs]
+        mov     edi, [rhs]
+        mov     ecx, [count]
+        mov     eax, ecx
+        jecxz   .end
+        repe    cmpsd
+        je      .end
+        ; `ECX` has been decreased for the different double word.
+        sub     eax, ecx
+        dec     eax
+.end:
+        pop     edi
+        pop     esi
+        leave
+        ret
+    %pop
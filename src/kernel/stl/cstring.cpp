@@ -3,6 +3,40 @@
 
 namespace stl {
 
+namespace {
+
+extern "C" {
+
+//! Copy a number of double words by @p rep @p movsd.
+void CopyDoubleWords(void* dest, const void* src, size_t count) noexcept;
+
+//! Fill a number of double words with a value by @p rep @p stosd.
+void SetDoubleWords(void* dest, uint32_t val, size_t count) noexcept;
+
+/**
+ * @brief Compare a number of double words by @p repe @p cmpsd.
+ *
+ * @return The index of the first different double word, or @p count if they are all equal.
+ */
+size_t CompareDoubleWords(const void* lhs, const void* rhs, size_t count) noexcept;
+}
+
+/**
+ * @brief The minimum size of memory operated by double words.
+ *
+ * @details
+ * Starting a string instruction costs more than a short byte loop.
+ */
+constexpr size_t min_dword_op_size {16};
+
+//! Get the number of bytes before the next double-word boundary.
+size_t GetUnalignedSize(const void* const addr) noexcept {
+    const auto offset {reinterpret_cast<uintptr_t>(addr) % sizeof(uint32_t)};
+    return offset == 0 ? 0 : sizeof(uint32_t) - offset;
+}
+
+}  // namespace
+
 char* strcpy(char* dest, const char* src) noexcept {
     dbg::Assert(dest && src);
     const auto begin {dest};
@@ -38,25 +72,64 @@ int strcmp(const char* lhs, const char* rhs) noexcept {
 
 void memset(void* const addr, const byte val, const size_t size) noexcept {
     dbg::Assert(addr);
-    for (size_t i {0}; i != size; ++i) {
-        *(static_cast<byte*>(addr) + i) = val;
+    auto dest {static_cast<byte*>(addr)};
+    auto remain {size};
+    if (remain >= min_dword_op_size) {
+        const auto head {GetUnalignedSize(dest)};
+        for (size_t i {0}; i != head; ++i) {
+            *dest++ = val;
+        }
+
+        remain -= head;
+        // Repeat the byte in a double word.
+        SetDoubleWords(dest, val * static_cast<uint32_t>(0x01010101), remain / sizeof(uint32_t));
+        dest += remain / sizeof(uint32_t) * sizeof(uint32_t);
+        remain %= sizeof(uint32_t);
+    }
+
+    for (size_t i {0}; i != remain; ++i) {
+        dest[i] = val;
     }
 }
 
 void memcpy(void* const dest, const void* const src, const size_t size) noexcept {
     dbg::Assert(dest && src);
-    for (size_t i {0}; i != size; ++i) {
-        *(static_cast<byte*>(dest) + i) = *(static_cast<const byte*>(src) + i);
+    auto to {static_cast<byte*>(dest)};
+    auto from {static_cast<const byte*>(src)};
+    auto remain {size};
+    if (remain >= min_dword_op_size) {
+        // Align the destination, since unaligned stores are slower than unaligned loads.
+        const auto head {GetUnalignedSize(to)};
+        for (size_t i {0}; i != head; ++i) {
+            *to++ = *from++;
+        }
+
+        remain -= head;
+        CopyDoubleWords(to, from, remain / sizeof(uint32_t));
+        to += remain / sizeof(uint32_t) * sizeof(uint32_t);
+        from += remain / sizeof(uint32_t) * sizeof(uint32_t);
+        remain %= sizeof(uint32_t);
+    }
+
+    for (size_t i {0}; i != remain; ++i) {
+        to[i] = from[i];
     }
 }
 
 int memcmp(const void* const lhs, const void* const rhs, const size_t size) noexcept {
     dbg::Assert(lhs && rhs);
-    for (size_t i {0}; i != size; ++i) {
-        const auto v1 {*(static_cast<const byte*>(lhs) + i)};
-        const auto v2 {*(static_cast<const byte*>(rhs) + i)};
-        if (v1 != v2) {
-            return v1 > v2 ? 1 : -1;
+    const auto v1 {static_cast<const byte*>(lhs)};
+    const auto v2 {static_cast<const byte*>(rhs)};
+    size_t begin {0};
+    if (size >= min_dword_op_size) {
+        // Skip equal double words. The first different one is compared by bytes,
+        // since the order of bytes in a double word is reversed.
+        begin = CompareDoubleWords(lhs, rhs, size / sizeof(uint32_t)) * sizeof(uint32_t);
+    }
+
+    for (auto i {begin}; i != size; ++i) {
+        if (v1[i] != v2[i]) {
+            return v1[i] > v2[i] ? 1 : -1;
         }
     }
 
@@ -2,12 +2,34 @@
 
 namespace stl {
 
+mutex::mutex(const char* const name) noexcept : mtx_ {name} {}
+
+void mutex::set_name(const char* const name) noexcept {
+    mtx_.SetName(name);
+}
+
 void mutex::lock() noexcept {
     mtx_.Lock();
 }
 
+bool mutex::try_lock() noexcept {
+    return mtx_.TryLock();
+}
+
 void mutex::unlock() noexcept {
     mtx_.Unlock();
 }
 
+void spin_lock::lock() noexcept {
+    lck_.Lock();
+}
+
+bool spin_lock::try_lock() noexcept {
+    return lck_.TryLock();
+}
+
+void spin_lock::unlock() noexcept {
+    lck_.Unlock();
+}
+
 }  // namespace stl
\ No newline at end of file
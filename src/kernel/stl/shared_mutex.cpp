@@ -0,0 +1,29 @@
+#include "kernel/stl/shared_mutex.h"
+
+namespace stl {
+
+void shared_mutex::lock() noexcept {
+    lck_.Lock();
+}
+
+bool shared_mutex::try_lock() noexcept {
+    return lck_.TryLock();
+}
+
+void shared_mutex::unlock() noexcept {
+    lck_.Unlock();
+}
+
+void shared_mutex::lock_shared() noexcept {
+    lck_.LockShared();
+}
+
+bool shared_mutex::try_lock_shared() noexcept {
+    return lck_.TryLockShared();
+}
+
+void shared_mutex::unlock_shared() noexcept {
+    lck_.UnlockShared();
+}
+
+}  // namespace stl
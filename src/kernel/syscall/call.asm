@@ -3,22 +3,60 @@
 ; The interrupt number of system calls.
 sys_call_intr_num       equ     0x30
 
+section     .data
+global      sys_enter_enabled
+; Whether the kernel has enabled `sysenter`, set by `sc::InitFastSysCall` in `src/kernel/syscall/call.cpp`.
+sys_enter_enabled:
+    dd      0
+
 [bits 32]
 section     .text
-global      SysCall
+global      RawSysCall
 ; The system call.
-; It accepts an index and an optional user-defined argument,
-; then calls the indexed method with the argument in the system call interrupt.
+; It accepts an index and up to five user-defined arguments,
+; then calls the indexed method with the arguments in the system call interrupt.
 ; Developers should register kernel APIs as system calls first before calling them in user mode.
-SysCall:
-    %push   sys_call
+;
+; The index is passed in `EAX` and arguments are passed in `EBX`, `ECX`, `EDX`, `ESI` and `EDI`,
+; so the kernel does not need to read them from user memory.
+;
+; If the kernel has enabled `sysenter`, it is used instead of the interrupt `sys_call_intr_num`.
+RawSysCall:
+    %push   raw_sys_call
     %stacksize  flat
-    %arg    func:dword, arg:dword
+    %arg    func:dword, arg1:dword, arg2:dword, arg3:dword, arg4:dword, arg5:dword
         enter   B(0), 0
-        mov     ecx, [func]
-        mov     eax, [arg]
+        ; `EBX`, `ESI` and `EDI` are callee-saved registers.
+        push    ebx
+        push    esi
+        push    edi
+        mov     eax, [func]
+        mov     ebx, [arg1]
+        mov     ecx, [arg2]
+        mov     edx, [arg3]
+        mov     esi, [arg4]
+        mov     edi, [arg5]
+        cmp     dword [sys_enter_enabled], 0
+        jne     .fast
         ; Jump to the method `SysCallEntry` in `src/kernel/interrupt/intr.asm`.
         int     sys_call_intr_num
+    .exit:
+        pop     edi
+        pop     esi
+        pop     ebx
         leave
         ret
-    %pop
\ No newline at end of file
+    .fast:
+        ; `sysexit` returns to `sys_enter_return` with the user stack saved in `EBP`,
+        ; since `ECX` and `EDX` are used to pass arguments.
+        push    ebp
+        mov     ebp, esp
+        ; Jump to the method `SysEnterEntry` in `src/kernel/interrupt/intr.asm`.
+        sysenter
+    %pop
+
+global      sys_enter_return
+; The return address of fast system calls.
+sys_enter_return:
+    pop     ebp
+    jmp     RawSysCall.exit
@@ -1,14 +1,92 @@
 #include "kernel/syscall/call.h"
 #include "kernel/debug/assert.h"
+#include "kernel/debug/prof.h"
+#include "kernel/debug/trace.h"
+#include "kernel/descriptor/gdt/tab.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/io/disk/disk.h"
+#include "kernel/io/io.h"
 #include "kernel/io/file/dir.h"
 #include "kernel/io/file/file.h"
+#include "kernel/io/file/map.h"
+#include "kernel/io/file/pipe.h"
+#include "kernel/io/file/ring.h"
+#include "kernel/io/timer.h"
 #include "kernel/io/video/console.h"
 #include "kernel/io/video/print.h"
 #include "kernel/memory/pool.h"
+#include "kernel/memory/shm.h"
 #include "kernel/process/proc.h"
+#include "kernel/process/tss.h"
+#include "kernel/selector/sel.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/array.h"
+#include "kernel/thread/futex.h"
+#include "kernel/thread/sync.h"
+#include "kernel/util/bit.h"
 
 namespace sc {
 
+namespace {
+
+//! The @p SEP bit of the feature flags in @p EDX returned by @p cpuid, indicating @p sysenter and @p sysexit.
+inline constexpr stl::uint32_t cpu_feature_sep {1 << 11};
+
+//! Model-specific registers for @p sysenter.
+enum class SysEnterMsr {
+    //! The kernel code selector. The kernel stack and user selectors are adjacent to it.
+    Cs = 0x174,
+    //! The kernel stack pointer.
+    Esp = 0x175,
+    //! The kernel entry point.
+    Eip = 0x176
+};
+
+extern "C" {
+//! Get the feature flags in @p EDX returned by @p cpuid with `EAX = 1`.
+stl::uint32_t GetCpuFeatures() noexcept;
+
+//! The entry point of fast system calls in @p src/kernel/interrupt/intr.asm.
+void SysEnterEntry() noexcept;
+
+//! Whether @p RawSysCall in @p src/kernel/syscall/call.asm uses @p sysenter.
+extern stl::uint32_t sys_enter_enabled;
+
+//! Whether @p SysCallEntry and @p SysEnterEntry in @p src/kernel/interrupt/intr.asm record statistics.
+extern stl::uint32_t sys_call_stats_enabled;
+}
+
+stl::uint32_t sys_call_stats_enabled {0};
+
+/**
+ * @brief A wrapper of a global variable representing statistics of system calls.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+stl::array<SysCallStats, count>& GetStatsTab() noexcept {
+    static stl::array<SysCallStats, count> stats {};
+    return stats;
+}
+
+//! Get the bucket of a latency in log2 histograms.
+stl::size_t GetLatencyBucket(const stl::uint64_t cycles) noexcept {
+    if (bit::GetHighDword(cycles) != 0) {
+        return SysCallStats::latency_bucket_count - 1;
+    } else if (const auto low {bit::GetLowDword(cycles)}; low != 0) {
+        return stl::min(bit::GetHighestSetBit(low), SysCallStats::latency_bucket_count - 1);
+    } else {
+        return 0;
+    }
+}
+
+void WriteMsr(const SysEnterMsr msr, const stl::uint64_t val) noexcept {
+    io::WriteMsr(static_cast<stl::uint32_t>(msr), val);
+}
+
+}  // namespace
+
 /**
  * @brief System call handlers.
  *
@@ -16,7 +94,8 @@ namespace sc {
  * When a user application needs to call a kernel method, @p mem::Allocate, for example:
  * 1. They can only call its user version @p usr::mem::Allocate, which is a wrapper for a system call.
  * 2. @p usr::mem::Allocate calls the method @p usr::sc::SysCall with the type @p usr::sc::SysCallType::MemAlloc.
- * 3. @p usr::sc::SysCall generates a @p sys_call_intr_num interrupt in @p src/kernel/syscall/call.asm.
+ * 3. @p usr::sc::SysCall passes arguments to @p usr::sc::RawSysCall in registers,
+ *    which generates a @p sys_call_intr_num interrupt or uses @p sysenter in @p src/kernel/syscall/call.asm.
  * 4. The CPU jumps to the interrupt entry point @p SysCallEntry in @p src/kernel/interrupt/intr.asm.
  * 5. @p SysCallEntry calls the corresponding kernel method @p sys_call_handlers[usr::sc::SysCallType::MemAlloc], which is @p mem::Allocate.
  */
@@ -24,6 +103,36 @@ extern "C" stl::uintptr_t sys_call_handlers[];
 
 stl::uintptr_t sys_call_handlers[count] {};
 
+/**
+ * @brief Call a system call handler, record its statistics and trace events.
+ *
+ * @details
+ * It is called by @p SysCallEntry and @p SysEnterEntry instead of the handler when statistics or tracepoints are enabled.
+ * The index of the system call is the last parameter, so the first five have the same layout as handler arguments.
+ */
+extern "C" stl::int32_t DispatchSysCallWithStats(
+    const stl::uintptr_t arg1, const stl::uintptr_t arg2, const stl::uintptr_t arg3,
+    const stl::uintptr_t arg4, const stl::uintptr_t arg5, const stl::size_t func) noexcept {
+    dbg::Assert(func < count);
+    const auto handler {reinterpret_cast<Handler>(sys_call_handlers[func])};
+    dbg::Trace<dbg::TraceEvent::SysCallEnter>(func, arg1);
+    const auto begin {io::ReadTsc()};
+    const auto ret {handler(arg1, arg2, arg3, arg4, arg5)};
+    const auto cycles {io::ReadTsc() - begin};
+    dbg::Trace<dbg::TraceEvent::SysCallExit>(func, ret);
+    if (!IsSysCallStatsEnabled()) {
+        return ret;
+    }
+
+    // The handler may have enabled interrupts or switched threads.
+    const intr::IntrGuard guard;
+    auto& stats {GetStatsTab()[func]};
+    ++stats.call_count;
+    stats.total_cycles += cycles;
+    ++stats.latencies[GetLatencyBucket(cycles)];
+    return ret;
+}
+
 SysCallHandlerTab<count>& GetSysCallHandlerTab() noexcept {
     static SysCallHandlerTab<count> handlers {sys_call_handlers};
     return handlers;
@@ -36,25 +145,166 @@ void InitSysCall() noexcept {
         .Register(SysCallType::PrintHex,
                   static_cast<void (*)(stl::uint32_t)>(&io::Console::PrintHex))
         .Register(SysCallType::PrintStr, static_cast<void (*)(const char*)>(&io::Console::PrintStr))
+        .Register(SysCallType::WriteConsole,
+                  static_cast<void (*)(const char*, stl::size_t)>(&io::Console::Write))
+        .Register(SysCallType::ReadConsole,
+                  static_cast<stl::size_t (*)(char*, stl::size_t)>(&io::Console::Read))
+        .Register(SysCallType::SetConsoleMode,
+                  static_cast<void (*)(bool)>(&io::Console::SetCanonical))
         .Register(SysCallType::MemAlloc, static_cast<void* (*)(stl::size_t)>(&mem::Allocate))
         .Register(SysCallType::Fork, static_cast<stl::size_t (*)()>(&tsk::Process::ForkCurrent))
         .Register(SysCallType::MemFree, static_cast<void (*)(void*)>(&mem::Free))
+        .Register(SysCallType::MemStats,
+                  static_cast<void (*)(mem::PoolType, mem::MemStats*)>(&mem::sc::Memory::GetStats))
+        .Register(SysCallType::MapMem,
+                  static_cast<void* (*)(stl::uintptr_t, stl::size_t, stl::uint32_t)>(
+                      &mem::sc::Memory::Map))
+        .Register(SysCallType::UnmapMem,
+                  static_cast<bool (*)(void*, stl::size_t)>(&mem::sc::Memory::Unmap))
+        .Register(SysCallType::MapSharedMem,
+                  static_cast<void* (*)(const char*, stl::size_t)>(&mem::sc::SharedMem::Map))
+        .Register(SysCallType::DeleteSharedMem,
+                  static_cast<bool (*)(const char*)>(&mem::sc::SharedMem::Delete))
+        .Register(SysCallType::GetTime,
+                  static_cast<void (*)(stl::uint64_t*)>(&io::sc::Timer::GetNanoseconds))
+        .Register(SysCallType::ThreadStats,
+                  static_cast<bool (*)(stl::size_t, tsk::ThreadStats*)>(&tsk::sc::Thread::GetStats))
+        .Register(SysCallType::CreateThread,
+                  static_cast<bool (*)(void*, void*)>(&tsk::sc::Thread::Create))
+        .Register(SysCallType::ExitThread, static_cast<void (*)()>(&tsk::sc::Thread::Exit))
+        .Register(SysCallType::SetThreadPriority,
+                  static_cast<bool (*)(stl::size_t)>(&tsk::sc::Thread::SetPriority))
+        .Register(SysCallType::SetThreadTimeSlice,
+                  static_cast<bool (*)(stl::size_t)>(&tsk::sc::Thread::SetTimeSlice))
+        .Register(SysCallType::SetThreadAffinity,
+                  static_cast<bool (*)(stl::uint32_t)>(&tsk::sc::Thread::SetAffinity))
+        .Register(SysCallType::ExitProcess,
+                  static_cast<void (*)(stl::int32_t)>(&tsk::Process::ExitCurrent))
+        .Register(SysCallType::WaitProcess,
+                  static_cast<bool (*)(stl::size_t, stl::int32_t*)>(&tsk::Process::Wait))
+        .Register(SysCallType::Exec,
+                  static_cast<bool (*)(const char*)>(&tsk::Process::ExecCurrent))
+        .Register(SysCallType::Spawn,
+                  static_cast<stl::size_t (*)(const char*, const stl::size_t*, stl::size_t)>(
+                      &tsk::Process::Spawn))
         .Register(SysCallType::OpenFile,
-                  static_cast<stl::size_t (*)(const io::sc::File::OpenArgs&)>(&io::sc::File::Open))
+                  static_cast<stl::size_t (*)(const char*, stl::uint32_t)>(&io::sc::File::Open))
         .Register(SysCallType::ReadFile,
-                  static_cast<stl::size_t (*)(const io::sc::File::ReadArgs&)>(&io::sc::File::Read))
+                  static_cast<stl::size_t (*)(stl::size_t, void*, stl::size_t)>(&io::sc::File::Read))
         .Register(SysCallType::SeekFile,
-                  static_cast<stl::size_t (*)(const io::sc::File::SeekArgs&)>(&io::sc::File::Seek))
-        .Register(
-            SysCallType::WriteFile,
-            static_cast<stl::size_t (*)(const io::sc::File::WriteArgs&)>(&io::sc::File::Write))
+                  static_cast<stl::size_t (*)(stl::size_t, stl::int32_t, io::File::SeekOrigin)>(
+                      &io::sc::File::Seek))
+        .Register(SysCallType::WriteFile,
+                  static_cast<stl::size_t (*)(stl::size_t, const void*, stl::size_t)>(
+                      &io::sc::File::Write))
+        .Register(SysCallType::WriteFileV,
+                  static_cast<stl::size_t (*)(stl::size_t, const io::IoVec*, stl::size_t)>(
+                      &io::sc::File::WriteV))
+        .Register(SysCallType::ReadFileV,
+                  static_cast<stl::size_t (*)(stl::size_t, const io::IoVec*, stl::size_t)>(
+                      &io::sc::File::ReadV))
+        .Register(SysCallType::SysCallStats,
+                  static_cast<bool (*)(SysCallType, SysCallStats*)>(&GetSysCallStats))
+        .Register(SysCallType::ResetSysCallStats,
+                  static_cast<void (*)(bool)>(&ResetSysCallStats))
+        .Register(SysCallType::IntrStats,
+                  static_cast<bool (*)(stl::size_t, intr::IntrStats*)>(&intr::GetIntrStats))
+        .Register(SysCallType::ResetIntrStats, static_cast<void (*)(bool)>(&intr::ResetIntrStats))
+        .Register(SysCallType::ResetProfiler, static_cast<void (*)(bool)>(&dbg::ResetProfiler))
+        .Register(SysCallType::DumpProfile, static_cast<void (*)()>(&dbg::DumpProfile))
+        .Register(SysCallType::ResetLockStats, static_cast<void (*)(bool)>(&sync::ResetLockStats))
+        .Register(SysCallType::DumpLockStats, static_cast<void (*)()>(&sync::DumpLockStats))
+        .Register(SysCallType::ResetTrace, static_cast<bool (*)(bool)>(&dbg::ResetTrace))
+        .Register(SysCallType::DumpTrace, static_cast<void (*)()>(&dbg::DumpTrace))
+        .Register(SysCallType::FutexWait,
+                  static_cast<bool (*)(stl::uint32_t*, stl::uint32_t, stl::size_t)>(
+                      &sync::sc::Futex::Wait))
+        .Register(SysCallType::FutexWake,
+                  static_cast<stl::size_t (*)(stl::uint32_t*, stl::size_t)>(&sync::sc::Futex::Wake))
         .Register(SysCallType::CloseFile, static_cast<void (*)(stl::size_t)>(&io::sc::File::Close))
         .Register(SysCallType::DeleteFile,
                   static_cast<bool (*)(const char*)>(&io::sc::File::Delete))
+        .Register(SysCallType::SyncFiles, static_cast<void (*)()>(&io::sc::File::Sync))
+        .Register(SysCallType::FileSysStats,
+                  static_cast<void (*)(io::FileSysStats*)>(&io::sc::File::GetSysStats))
+        .Register(SysCallType::DiskStats,
+                  static_cast<bool (*)(const char*, io::DiskStats*)>(&io::sc::Disk::GetStats))
+        .Register(SysCallType::ReserveFile,
+                  static_cast<bool (*)(stl::size_t, stl::size_t)>(&io::sc::File::Reserve))
+        .Register(SysCallType::CreatePipe,
+                  static_cast<bool (*)(stl::size_t*)>(&io::sc::Pipe::Create))
+        .Register(SysCallType::MapFile,
+                  static_cast<void* (*)(stl::size_t, stl::size_t, stl::size_t, bool)>(
+                      &io::sc::FileMap::Map))
+        .Register(SysCallType::UnmapFile,
+                  static_cast<bool (*)(void*)>(&io::sc::FileMap::Unmap))
+        .Register(SysCallType::SyncFileMap,
+                  static_cast<bool (*)(void*)>(&io::sc::FileMap::Sync))
         .Register(SysCallType::CreateDir,
-                  static_cast<bool (*)(const char*)>(&io::sc::Directory::Create));
+                  static_cast<bool (*)(const char*)>(&io::sc::Directory::Create))
+        .Register(SysCallType::ReadDirEntries,
+                  static_cast<stl::size_t (*)(const char*, io::fs::Directory::Cursor*,
+                                              io::fs::DirEntry*, stl::size_t)>(
+                      &io::sc::Directory::ReadEntries))
+        .Register(SysCallType::SetupIoRing,
+                  static_cast<bool (*)(void*)>(&io::sc::IoRing::Setup))
+        .Register(SysCallType::EnterIoRing,
+                  static_cast<stl::size_t (*)(stl::size_t)>(&io::sc::IoRing::Enter));
 
     io::PrintlnStr("System calls have been initialized.");
 }
 
-}  // namespace sc
\ No newline at end of file
+void InitFastSysCall() noexcept {
+    dbg::Assert(!IsFastSysCallEnabled());
+    if ((GetCpuFeatures() & cpu_feature_sep) == 0) {
+        io::PrintlnStr("Fast system calls are not supported.");
+        return;
+    }
+
+    // Copy kernel and user descriptors to adjacent entries.
+    auto gdt {gdt::GetGlobalDescTab()};
+    dbg::Assert(!gdt[gdt::idx::usr_code].IsInvalid() && !gdt[gdt::idx::usr_data].IsInvalid());
+    gdt[gdt::idx::sysenter_krnl_code] = gdt[gdt::idx::krnl_code];
+    gdt[gdt::idx::sysenter_krnl_stack] = gdt[gdt::idx::krnl_data];
+    gdt[gdt::idx::sysenter_usr_code] = gdt[gdt::idx::usr_code];
+    gdt[gdt::idx::sysenter_usr_stack] = gdt[gdt::idx::usr_data];
+
+    WriteMsr(SysEnterMsr::Cs, static_cast<stl::uint16_t>(sel::sysenter_krnl_code));
+    // The entry point loads the kernel stack of the current thread from `esp0`,
+    // so the register does not need to be updated when switching threads.
+    WriteMsr(SysEnterMsr::Esp, reinterpret_cast<stl::uintptr_t>(&tsk::GetTaskStateSeg().esp0));
+    WriteMsr(SysEnterMsr::Eip, reinterpret_cast<stl::uintptr_t>(&SysEnterEntry));
+    __atomic_store_n(&sys_enter_enabled, true, __ATOMIC_RELEASE);
+    io::PrintlnStr("Fast system calls have been initialized.");
+}
+
+bool IsFastSysCallEnabled() noexcept {
+    return __atomic_load_n(&sys_enter_enabled, __ATOMIC_ACQUIRE);
+}
+
+void ResetSysCallStats(const bool enabled) noexcept {
+    const intr::IntrGuard guard;
+    for (auto& stats : GetStatsTab()) {
+        stats = {};
+    }
+
+    __atomic_store_n(&sys_call_stats_enabled, enabled, __ATOMIC_RELEASE);
+}
+
+bool IsSysCallStatsEnabled() noexcept {
+    return __atomic_load_n(&sys_call_stats_enabled, __ATOMIC_ACQUIRE);
+}
+
+bool GetSysCallStats(const SysCallType func, SysCallStats* const stats) noexcept {
+    dbg::Assert(stats);
+    const auto idx {static_cast<stl::size_t>(func)};
+    if (idx >= count) {
+        return false;
+    }
+
+    const intr::IntrGuard guard;
+    *stats = GetStatsTab()[idx];
+    return true;
+}
+
+}  // namespace sc
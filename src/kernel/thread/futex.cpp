@@ -0,0 +1,136 @@
+#include "kernel/thread/futex.h"
+#include "kernel/interrupt/intr.h"
+#include "kernel/krnl.h"
+#include "kernel/memory/page.h"
+#include "kernel/memory/pool.h"
+#include "kernel/stl/array.h"
+#include "kernel/thread/sync.h"
+#include "kernel/util/tag_list.h"
+
+namespace sync {
+
+namespace {
+
+/**
+ * @brief A thread waiting for a futex word.
+ *
+ * @details
+ * It is saved in the waiting thread's kernel stack until the thread is woken up or its timeout expires.
+ */
+struct FutexWaiter {
+    //! The tag in a bucket, which must be the first member.
+    TagList::Tag tag;
+    //! The physical address of the futex word.
+    stl::uintptr_t key;
+    //! Whether the waiter is still in its bucket.
+    bool queued;
+    //! The queue containing only the waiting thread.
+    WaitQueue thd;
+};
+
+/**
+ * @brief A wrapper of a global variable saving futex waiters.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+stl::array<TagList, futex_bucket_count>& GetFutexBuckets() noexcept {
+    static stl::array<TagList, futex_bucket_count> buckets;
+    return buckets;
+}
+
+//! Get the bucket of a physical address by mixing the offset in the page and the page frame.
+TagList& GetFutexBucket(const stl::uintptr_t key) noexcept {
+    return GetFutexBuckets()[((key >> 2) ^ (key >> 12)) % futex_bucket_count];
+}
+
+//! Whether an address can be used as a futex word.
+bool IsValidFutex(const stl::uint32_t* const addr) noexcept {
+    const auto vr_addr {reinterpret_cast<stl::uintptr_t>(addr)};
+    return addr && vr_addr % sizeof(stl::uint32_t) == 0
+           && vr_addr <= krnl_base - sizeof(stl::uint32_t);
+}
+
+}  // namespace
+
+namespace sc {
+
+bool Futex::Wait(stl::uint32_t* const addr, const stl::uint32_t expected,
+                 const stl::size_t milliseconds) noexcept {
+    if (!IsValidFutex(addr)) {
+        return false;
+    }
+
+    // Make the page present and writable with interrupts enabled, since it may be loaded from disks.
+    // A page shared by copy-on-write would change its physical address on a later write.
+    if (!mem::PrepareUsrPageForWrite(reinterpret_cast<stl::uintptr_t>(addr))) {
+        return false;
+    }
+
+    const intr::IntrGuard guard;
+    const mem::VrAddr vr_addr {addr};
+    // Another thread of the process may have changed the page before interrupts are disabled.
+    if (!vr_addr.IsMapped() || !vr_addr.GetPageTabEntry().IsWritable()
+        || __atomic_load_n(addr, __ATOMIC_ACQUIRE) != expected) {
+        return false;
+    }
+
+    FutexWaiter waiter {};
+    waiter.key = vr_addr.GetPhyAddr();
+    waiter.queued = true;
+    GetFutexBucket(waiter.key).PushBack(waiter.tag);
+    if (milliseconds == futex_wait_forever) {
+        waiter.thd.Wait();
+        return true;
+    } else if (waiter.thd.Wait(milliseconds)) {
+        return true;
+    } else {
+        // The timeout expires. The waiter may have been removed by a wake-up that came too late.
+        if (waiter.queued) {
+            waiter.tag.Detach();
+        }
+
+        return false;
+    }
+}
+
+stl::size_t Futex::Wake(stl::uint32_t* const addr, const stl::size_t count) noexcept {
+    if (!IsValidFutex(addr)) {
+        return 0;
+    }
+
+    const intr::IntrGuard guard;
+    const mem::VrAddr vr_addr {addr};
+    if (!vr_addr.IsMapped()) {
+        return 0;
+    }
+
+    auto key {vr_addr.GetPhyAddr()};
+    const auto& bucket {GetFutexBucket(key)};
+    stl::size_t woken {0};
+    while (woken != count) {
+        const auto tag {bucket.Find(
+            [](const TagList::Tag& tag, void* const arg) noexcept {
+                return tag.GetElem<FutexWaiter>().key == *static_cast<const stl::uintptr_t*>(arg);
+            },
+            &key)};
+        if (!tag) {
+            break;
+        }
+
+        auto& waiter {tag->GetElem<FutexWaiter>()};
+        waiter.tag.Detach();
+        waiter.queued = false;
+        // The waiter's thread has been woken up by its timeout if its queue is empty.
+        if (waiter.thd.WakeOne()) {
+            ++woken;
+        }
+    }
+
+    return woken;
+}
+
+}  // namespace sc
+
+}  // namespace sync
@@ -1,29 +1,347 @@
 #include "kernel/thread/sync.h"
+#include "kernel/io/io.h"
+#include "kernel/io/video/print.h"
+#include "kernel/stl/algorithm.h"
+#include "kernel/stl/array.h"
 
 namespace sync {
 
+namespace {
+
+//! Hint the CPU that the thread is spinning, which reduces power and memory-order penalties.
+void Pause() noexcept {
+    __builtin_ia32_pause();
+}
+
+//! Statistics of named mutexes.
+struct LockStatsTab {
+    stl::array<LockStats, max_lock_stats_count> stats;
+    stl::size_t count;
+    //! Whether statistics are being recorded.
+    bool enabled;
+};
+
+/**
+ * @brief A wrapper of a global variable saving statistics of named mutexes.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+LockStatsTab& GetLockStatsTab() noexcept {
+    static LockStatsTab tab {};
+    return tab;
+}
+
+//! Whether a mutex should be printed before another one, ordered by contention.
+bool IsMoreContended(const LockStats& lhs, const LockStats& rhs) noexcept {
+    return lhs.contended_count != rhs.contended_count
+               ? lhs.contended_count > rhs.contended_count
+               : lhs.total_wait_cycles > rhs.total_wait_cycles;
+}
+
+}  // namespace
+
+void ResetLockStats(const bool enabled) noexcept {
+    const intr::IntrGuard guard;
+    auto& tab {GetLockStatsTab()};
+    for (stl::size_t i {0}; i != tab.count; ++i) {
+        tab.stats[i] = {tab.stats[i].name};
+    }
+
+    __atomic_store_n(&tab.enabled, enabled, __ATOMIC_RELEASE);
+}
+
+bool IsLockStatsEnabled() noexcept {
+    return __atomic_load_n(&GetLockStatsTab().enabled, __ATOMIC_ACQUIRE);
+}
+
+void DumpLockStats() noexcept {
+    // Mutexes are ordered by indices, so the table is not copied.
+    stl::array<stl::size_t, max_lock_stats_count> order;
+    stl::size_t count {0};
+    {
+        const intr::IntrGuard guard;
+        const auto& tab {GetLockStatsTab()};
+        count = tab.count;
+        for (stl::size_t i {0}; i != count; ++i) {
+            auto j {i};
+            for (; j != 0 && IsMoreContended(tab.stats[i], tab.stats[order[j - 1]]); --j) {
+                order[j] = order[j - 1];
+            }
+
+            order[j] = i;
+        }
+    }
+
+    io::Printf("Named mutexes: 0x{} in total.\n", count);
+    for (stl::size_t i {0}; i != stl::min(count, max_lock_stats_dump_count); ++i) {
+        LockStats stats;
+        {
+            const intr::IntrGuard guard;
+            stats = GetLockStatsTab().stats[order[i]];
+        }
+
+        io::Printf("{}:\n", stats.name);
+        io::Printf("\tAcquisitions: 0x{}, contended: 0x{}.\n", stats.acquire_count,
+                   stats.contended_count);
+        io::Printf("\tWait cycles: 0x{} in total, 0x{} at most.\n", stats.total_wait_cycles,
+                   stats.max_wait_cycles);
+        io::Printf("\tHold cycles: 0x{} at most.\n", stats.max_hold_cycles);
+    }
+}
+
+WaitQueue& WaitQueue::Init() noexcept {
+    waiters_.Init();
+    return *this;
+}
+
+void WaitQueue::Wait() noexcept {
+    const intr::IntrGuard guard;
+    auto& curr_thd {tsk::Thread::GetCurrent()};
+    dbg::AssertSlow([&] { return !waiters_.Find(curr_thd.GetTag()); });
+    waiters_.PushBack(curr_thd.GetTag());
+    curr_thd.Block(tsk::Thread::Status::Blocked);
+}
+
+bool WaitQueue::Wait(const stl::size_t milliseconds) noexcept {
+    const intr::IntrGuard guard;
+    auto& curr_thd {tsk::Thread::GetCurrent()};
+    dbg::AssertSlow([&] { return !waiters_.Find(curr_thd.GetTag()); });
+    waiters_.PushBack(curr_thd.GetTag());
+    // If the timeout expires, the thread will be removed from the queue by the clock interrupt handler.
+    return curr_thd.BlockFor(milliseconds, true);
+}
+
+bool WaitQueue::WakeOne() noexcept {
+    const intr::IntrGuard guard;
+    if (waiters_.IsEmpty()) {
+        return false;
+    }
+
+    tsk::Thread::Unblock(tsk::Thread::GetByTag(waiters_.Pop()));
+    return true;
+}
+
+stl::size_t WaitQueue::WakeAll() noexcept {
+    const intr::IntrGuard guard;
+    stl::size_t count {0};
+    while (!waiters_.IsEmpty()) {
+        tsk::Thread::Unblock(tsk::Thread::GetByTag(waiters_.Pop()));
+        ++count;
+    }
+
+    return count;
+}
+
+bool WaitQueue::IsEmpty() const noexcept {
+    const intr::IntrGuard guard;
+    return waiters_.IsEmpty();
+}
+
+void SpinLock::Lock() noexcept {
+    while (__atomic_exchange_n(&locked_, true, __ATOMIC_ACQUIRE)) {
+        // Wait until the lock seems free before trying to set it again.
+        while (__atomic_load_n(&locked_, __ATOMIC_RELAXED)) {
+            Pause();
+        }
+    }
+}
+
+bool SpinLock::TryLock() noexcept {
+    return !__atomic_load_n(&locked_, __ATOMIC_RELAXED)
+           && !__atomic_exchange_n(&locked_, true, __ATOMIC_ACQUIRE);
+}
+
+void SpinLock::Unlock() noexcept {
+    dbg::Assert(IsLocked());
+    __atomic_store_n(&locked_, false, __ATOMIC_RELEASE);
+}
+
+bool SpinLock::IsLocked() const noexcept {
+    return __atomic_load_n(&locked_, __ATOMIC_RELAXED);
+}
+
+Mutex::Mutex(const char* const name) noexcept {
+    SetName(name);
+}
+
+Mutex& Mutex::SetName(const char* const name) noexcept {
+    dbg::Assert(name);
+    const intr::IntrGuard guard;
+    if (stats_) {
+        stats_->name = name;
+        return *this;
+    }
+
+    auto& tab {GetLockStatsTab()};
+    if (tab.count != tab.stats.size()) {
+        stats_ = &tab.stats[tab.count++];
+        *stats_ = {name};
+    }
+
+    return *this;
+}
+
+LockStats* Mutex::GetStats() const noexcept {
+    return stats_ && IsLockStatsEnabled() ? stats_ : nullptr;
+}
+
+void Mutex::RecordLock(LockStats& stats, const bool contended,
+                       const stl::uint64_t wait_cycles) noexcept {
+    {
+        // Statistics are read and reset with interrupts disabled.
+        const intr::IntrGuard guard;
+        ++stats.acquire_count;
+        if (contended) {
+            ++stats.contended_count;
+            stats.total_wait_cycles += wait_cycles;
+            stats.max_wait_cycles = stl::max(stats.max_wait_cycles, wait_cycles);
+        }
+    }
+
+    locked_tsc_ = io::ReadTsc();
+}
+
+bool Mutex::TryAcquire(tsk::Thread& thd) noexcept {
+    tsk::Thread* expected {nullptr};
+    return __atomic_compare_exchange_n(&holder_, &expected, &thd, false, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_RELAXED);
+}
+
+void Mutex::Wait(tsk::Thread& thd) noexcept {
+    // On a single processor, disabling interrupts ensures that the mutex cannot be released
+    // between adding the thread to the wait queue and blocking it.
+    const intr::IntrGuard guard;
+    wait_lock_.Lock();
+    // The waiter count must be increased before checking the holder again.
+    // Otherwise the holder may release the mutex without waking up any thread.
+    __atomic_add_fetch(&waiter_count_, 1, __ATOMIC_SEQ_CST);
+    if (TryAcquire(thd)) {
+        __atomic_sub_fetch(&waiter_count_, 1, __ATOMIC_SEQ_CST);
+        wait_lock_.Unlock();
+        return;
+    }
+
+    dbg::AssertSlow([&] { return !waiters_.Find(thd.GetTag()); });
+    waiters_.PushBack(thd.GetTag());
+    wait_lock_.Unlock();
+    InheritPriority(thd);
+    thd.SetWaitingMutex(this);
+    thd.Block(tsk::Thread::Status::Blocked);
+    thd.SetWaitingMutex(nullptr);
+}
+
+void Mutex::InheritPriority(const tsk::Thread& waiter) const noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    const auto priority {waiter.GetPriority()};
+    const Mutex* mtx {this};
+    for (stl::size_t depth {0}; mtx && depth != max_inherit_depth; ++depth) {
+        const auto holder {__atomic_load_n(&mtx->holder_, __ATOMIC_RELAXED)};
+        if (!holder || holder->GetPriority() >= priority) {
+            break;
+        }
+
+        holder->InheritPriority(priority);
+        // If the holder is waiting for another mutex, its holder should be raised too.
+        mtx = holder->GetWaitingMutex();
+    }
+}
+
+void Mutex::Wake() noexcept {
+    const intr::IntrGuard guard;
+    wait_lock_.Lock();
+    if (!waiters_.IsEmpty()) {
+        __atomic_sub_fetch(&waiter_count_, 1, __ATOMIC_SEQ_CST);
+        tsk::Thread::Unblock(tsk::Thread::GetByTag(waiters_.Pop()));
+    }
+
+    wait_lock_.Unlock();
+}
+
 void Mutex::Lock() noexcept {
     auto& curr_thd {tsk::Thread::GetCurrent()};
-    // The mutex is held by another thread.
-    if (holder_ != &curr_thd) {
-        sema_.Decrease();
-        holder_ = &curr_thd;
-        dbg::Assert(repeat_times_ == 0);
-        repeat_times_ = 1;
-    } else {
+    if (__atomic_load_n(&holder_, __ATOMIC_RELAXED) == &curr_thd) {
+        // Repeatedly lock.
+        dbg::Assert(repeat_times_ > 0);
+        ++repeat_times_;
+        return;
+    }
+
+    const auto stats {GetStats()};
+    auto contended {false};
+    stl::uint64_t wait_begin {0};
+    stl::size_t spin_count {0};
+    while (!TryAcquire(curr_thd)) {
+        if (!contended) {
+            contended = true;
+            wait_begin = stats ? io::ReadTsc() : 0;
+        }
+
+        // The holder is running on another processor, so it may release the mutex soon.
+        // On a single processor, the holder cannot be running and the thread is blocked at once.
+        if (const auto holder {__atomic_load_n(&holder_, __ATOMIC_RELAXED)};
+            holder && holder->GetStatus() == tsk::Thread::Status::Running
+            && spin_count++ < max_spin_count) {
+            Pause();
+        } else {
+            // When the thread is woken up, it is possible that another thread may have grabbed the mutex faster than it.
+            // So we use a loop to try again.
+            Wait(curr_thd);
+        }
+    }
+
+    dbg::Assert(repeat_times_ == 0);
+    repeat_times_ = 1;
+    curr_thd.OnMutexLocked();
+    if (stats) {
+        RecordLock(*stats, contended, contended ? io::ReadTsc() - wait_begin : 0);
+    }
+}
+
+bool Mutex::TryLock() noexcept {
+    auto& curr_thd {tsk::Thread::GetCurrent()};
+    if (__atomic_load_n(&holder_, __ATOMIC_RELAXED) == &curr_thd) {
         // Repeatedly lock.
         dbg::Assert(repeat_times_ > 0);
         ++repeat_times_;
+        return true;
+    } else if (TryAcquire(curr_thd)) {
+        dbg::Assert(repeat_times_ == 0);
+        repeat_times_ = 1;
+        curr_thd.OnMutexLocked();
+        if (const auto stats {GetStats()}) {
+            RecordLock(*stats, false, 0);
+        }
+
+        return true;
+    } else {
+        return false;
     }
 }
 
 void Mutex::Unlock() noexcept {
-    dbg::Assert(holder_ == &tsk::Thread::GetCurrent());
+    auto& curr_thd {tsk::Thread::GetCurrent()};
+    dbg::Assert(__atomic_load_n(&holder_, __ATOMIC_RELAXED) == &curr_thd);
     if (repeat_times_ == 1) {
         repeat_times_ = 0;
-        // Reset the holder before unlocking the mutex.
-        holder_ = nullptr;
-        sema_.Increase();
+        // If recording was enabled after the mutex was acquired, the hold time is not measured.
+        if (locked_tsc_ != 0) {
+            if (const auto stats {GetStats()}) {
+                const auto hold_cycles {io::ReadTsc() - locked_tsc_};
+                const intr::IntrGuard guard;
+                stats->max_hold_cycles = stl::max(stats->max_hold_cycles, hold_cycles);
+            }
+
+            locked_tsc_ = 0;
+        }
+
+        __atomic_store_n(&holder_, nullptr, __ATOMIC_SEQ_CST);
+        curr_thd.OnMutexUnlocked();
+        // Only wake up a thread when there are waiters, so unlocking an uncontended mutex does not disable interrupts.
+        if (__atomic_load_n(&waiter_count_, __ATOMIC_SEQ_CST) > 0) {
+            Wake();
+        }
     } else {
         // Repeatedly unlock.
         dbg::Assert(repeat_times_ > 1);
@@ -31,4 +349,101 @@ void Mutex::Unlock() noexcept {
     }
 }
 
-}  // namespace sync
\ No newline at end of file
+bool RwLock::CanRead() const noexcept {
+    return !writer_ && waiting_writer_count_ == 0;
+}
+
+bool RwLock::CanWrite() const noexcept {
+    return !writer_ && reader_count_ == 0;
+}
+
+void RwLock::Lock() noexcept {
+    const intr::IntrGuard guard;
+    auto& curr_thd {tsk::Thread::GetCurrent()};
+    dbg::Assert(writer_ != &curr_thd);
+    while (!CanWrite()) {
+        ++waiting_writer_count_;
+        writers_.Wait();
+        --waiting_writer_count_;
+    }
+
+    writer_ = &curr_thd;
+}
+
+bool RwLock::TryLock() noexcept {
+    const intr::IntrGuard guard;
+    if (!CanWrite()) {
+        return false;
+    }
+
+    writer_ = &tsk::Thread::GetCurrent();
+    return true;
+}
+
+void RwLock::Unlock() noexcept {
+    const intr::IntrGuard guard;
+    dbg::Assert(writer_ == &tsk::Thread::GetCurrent());
+    writer_ = nullptr;
+    // Wake up the next writer first.
+    if (!writers_.WakeOne()) {
+        // Wake up all readers since they can hold the lock at the same time.
+        readers_.WakeAll();
+    }
+}
+
+void RwLock::LockShared() noexcept {
+    const intr::IntrGuard guard;
+    auto& curr_thd {tsk::Thread::GetCurrent()};
+    dbg::Assert(writer_ != &curr_thd);
+    while (!CanRead()) {
+        readers_.Wait();
+    }
+
+    ++reader_count_;
+}
+
+bool RwLock::TryLockShared() noexcept {
+    const intr::IntrGuard guard;
+    if (!CanRead()) {
+        return false;
+    }
+
+    ++reader_count_;
+    return true;
+}
+
+void RwLock::UnlockShared() noexcept {
+    const intr::IntrGuard guard;
+    dbg::Assert(reader_count_ > 0);
+    if (--reader_count_ == 0) {
+        // The last reader wakes up a waiting writer.
+        writers_.WakeOne();
+    }
+}
+
+void CondVar::Wait(Mutex& mtx) noexcept {
+    // Disabling interrupts ensures that a notification cannot be missed
+    // between releasing the mutex and adding the thread to the wait queue.
+    const intr::IntrGuard guard;
+    mtx.Unlock();
+    waiters_.Wait();
+    mtx.Lock();
+}
+
+bool CondVar::Wait(Mutex& mtx, const stl::size_t milliseconds) noexcept {
+    const intr::IntrGuard guard;
+    mtx.Unlock();
+    const auto notified {waiters_.Wait(milliseconds)};
+    mtx.Lock();
+    return notified;
+}
+
+void CondVar::NotifyOne() noexcept {
+    waiters_.WakeOne();
+}
+
+void CondVar::NotifyAll() noexcept {
+    waiters_.WakeAll();
+}
+
+}  // namespace sync
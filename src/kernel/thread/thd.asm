@@ -1,11 +1,4 @@
-%include "kernel/util/metric.inc"
-
-; This structure must be the same as the beginning of `tsk::Thread`.
-struc       Thread
-    .tags:          resq    2
-    .krnl_stack:    resd    1
-    ; ...
-endstruc
+%include "kernel/thread/thd.inc"
 
 [bits 32]
 section     .text
@@ -17,15 +10,15 @@ HaltCpu:
 
 global      GetCurrThread
 ; Get the current running thread.
-; The size of a thread block is one memory page.
-; The stack is located in the thread block. So the page address of `ESP` is the thread address.
+; The size of a thread block is `thd_block_size` and the block is aligned to its size.
+; The stack is located in the thread block. So `ESP` aligned to the block size is the thread address.
 ;
 ; Note that the compiler might allocate more memory for the control block in a thread, especially with debug options.
-; In that case, the size of a thread block is larger than one memory page,
+; In that case, the control block is larger than the thread block,
 ; and this method no longer works.
 GetCurrThread:
     mov     eax, esp
-    and     eax, 0xFFFFF000
+    and     eax, ~(thd_block_size - 1)
     ret
 
 global      SwitchThread
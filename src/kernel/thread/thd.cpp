@@ -1,21 +1,121 @@
 #include "kernel/thread/thd.h"
+#include "kernel/cpu/fpu.h"
+#include "kernel/debug/trace.h"
 #include "kernel/io/io.h"
 #include "kernel/io/timer.h"
+#include "kernel/io/timer_wheel.h"
 #include "kernel/memory/page.h"
 #include "kernel/memory/pool.h"
+#include "kernel/memory/slab.h"
+#include "kernel/process/krnl_data.h"
 #include "kernel/process/proc.h"
 #include "kernel/process/tss.h"
+#include "kernel/thread/sync.h"
+#include "kernel/util/bit.h"
 
 namespace tsk {
 
 namespace {
 
+/**
+ * @brief The multi-level run queue for ready threads.
+ *
+ * @details
+ * Each level has a first-in-first-out list and a bit in a bitmap indicating whether the list is not empty.
+ * The level @p 0 has the highest precedence, so the next thread can be found with a single bit scan.
+ */
+class RunQueue {
+public:
+    static constexpr stl::size_t level_count {sizeof(stl::uint32_t) * bit::byte_len};
+
+    RunQueue& PushBack(TagList::Tag& tag, const stl::size_t level) noexcept {
+        dbg::Assert(level < level_count);
+        levels_[level].PushBack(tag);
+        bit::SetBit(non_empty_levels_, level);
+        return *this;
+    }
+
+    RunQueue& PushFront(TagList::Tag& tag, const stl::size_t level) noexcept {
+        dbg::Assert(level < level_count);
+        levels_[level].PushFront(tag);
+        bit::SetBit(non_empty_levels_, level);
+        return *this;
+    }
+
+    //! Pop the first tag from the non-empty level with the highest precedence.
+    TagList::Tag& Pop() noexcept {
+        dbg::Assert(!IsEmpty());
+        return Pop(bit::GetLowestSetBit(non_empty_levels_));
+    }
+
+    TagList::Tag& Pop(const stl::size_t level) noexcept {
+        dbg::Assert(level < level_count && !levels_[level].IsEmpty());
+        auto& tag {levels_[level].Pop()};
+        if (levels_[level].IsEmpty()) {
+            bit::ResetBit(non_empty_levels_, level);
+        }
+
+        return tag;
+    }
+
+    //! Remove a tag from a level.
+    RunQueue& Remove(TagList::Tag& tag, const stl::size_t level) noexcept {
+        dbg::Assert(level < level_count);
+        dbg::AssertSlow([&] { return levels_[level].Find(tag); });
+        tag.Detach();
+        if (levels_[level].IsEmpty()) {
+            bit::ResetBit(non_empty_levels_, level);
+        }
+
+        return *this;
+    }
+
+    bool Find(const TagList::Tag& tag) const noexcept {
+        for (const auto& level : levels_) {
+            if (level.Find(tag)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool IsEmpty() const noexcept {
+        return non_empty_levels_ == 0;
+    }
+
+    //! Get the bitmap of non-empty levels.
+    stl::uint32_t GetNonEmptyLevels() const noexcept {
+        return non_empty_levels_;
+    }
+
+private:
+    stl::array<TagList, level_count> levels_;
+    stl::uint32_t non_empty_levels_ {0};
+};
+
+// The maximum priority has the level with the highest precedence.
+static_assert(Thread::max_priority == RunQueue::level_count - 1);
+
+//! The minimum size of the kernel stack in a thread block, below the control block.
+inline constexpr stl::size_t min_krnl_stack_size {mem::page_size * 7 / 8};
+
+// Large members such as memory block magazines must be allocated outside the thread block.
+static_assert(thd_block_size - sizeof(Thread) >= min_krnl_stack_size,
+              "The thread control block leaves too little kernel stack.");
+
 struct ThreadLists {
-    //! The list for ready threads.
-    TagList ready;
+    //! The run queue for ready threads.
+    RunQueue ready;
 
     //! The list for all threads.
     TagList all;
+
+    //! The list for sleeping threads, sorted by their wake-up ticks.
+    TagList sleeping;
+
+    //! The list for exited detached threads waiting to be freed.
+    TagList dead;
 };
 
 ThreadLists& GetThreadLists() noexcept {
@@ -38,6 +138,8 @@ void StartupCallback(const Thread::Callback callback, void* const arg) noexcept
     dbg::Assert(callback);
     intr::EnableIntr();
     callback(arg);
+    // The thread exits when its callback returns.
+    Thread::GetCurrent().Exit();
 }
 
 extern "C" {
@@ -54,12 +156,37 @@ void HaltCpu() noexcept;
 [[noreturn]] void intr_exit() noexcept;
 }
 
+//! Get the current time in nanoseconds for scheduler accounting, or zero before the timer is initialized.
+stl::uint64_t GetAcctTime() noexcept {
+    return io::IsTimerInited() ? io::GetNanoseconds() : 0;
+}
+
+/**
+ * @brief Stop periodic clock interrupts until a sleeping thread wakes up or a kernel timer expires.
+ *
+ * @details
+ * It only works when no other thread is ready to run.
+ */
+void StopIdleTick() noexcept {
+    const intr::IntrGuard guard;
+    if (io::IsTimerInited() && GetThreadLists().ready.IsEmpty()) {
+        const auto wake_tick {stl::min(Thread::GetNextWakeTick(), io::GetNextKrnlTimerTick())};
+        const auto curr_tick {io::GetTicks()};
+        io::StopTimerTick(wake_tick == npos ? npos
+                                            : (wake_tick > curr_tick ? wake_tick - curr_tick : 0));
+    }
+}
+
 //! A thread that runs when the system is idle.
 void Idle(void*) noexcept {
     while (true) {
+        // Zero free pages ahead of time, so allocations do not need to zero them.
+        mem::FillZeroedPages();
         Thread::GetCurrent().Block(Thread::Status::Blocked);
+        StopIdleTick();
         intr::EnableIntr();
         HaltCpu();
+        io::ResumeTimerTick();
     }
 }
 
@@ -94,6 +221,83 @@ void InitIdleThread() noexcept {
     thd = &KrnlThread::Create("idle", priority, &Idle);
 }
 
+/**
+ * @brief A wrapper of a global variable representing the slab cache of thread blocks.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ * It is used when a thread block occupies a whole page, so each object is a page.
+ */
+mem::SlabCache<Thread, mem::page_size>& GetThreadCache() noexcept {
+    static mem::SlabCache<Thread, mem::page_size> cache {"thread"};
+    return cache;
+}
+
+/**
+ * @brief Allocate a thread block.
+ *
+ * @details
+ * One-page blocks are allocated from the slab cache.
+ * Larger blocks are allocated from the kernel memory pool, since they must be aligned to their size.
+ */
+Thread* AllocThreadBlock() noexcept {
+    if constexpr (thd_block_page_count == 1) {
+        return GetThreadCache().Allocate();
+    } else {
+        return mem::AllocAlignedPages<Thread>(mem::PoolType::Kernel, thd_block_page_count);
+    }
+}
+
+void FreeThreadBlock(Thread* const thd) noexcept {
+    if constexpr (thd_block_page_count == 1) {
+        GetThreadCache().Free(thd);
+    } else {
+        mem::FreePages(thd, thd_block_page_count);
+    }
+}
+
+/**
+ * @brief A wrapper of a global variable representing the wait queue of the reaper thread.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+sync::WaitQueue& GetReaperQueue() noexcept {
+    static sync::WaitQueue waiters;
+    return waiters;
+}
+
+/**
+ * @brief A thread that frees exited detached threads.
+ *
+ * @details
+ * An exited thread cannot free its own thread block since it is still running on its kernel stack.
+ * Freed one-page thread blocks are kept by the slab cache for reuse, so creating short-lived threads does not always allocate pages.
+ */
+void Reap(void*) noexcept {
+    auto& dead {GetThreadLists().dead};
+    while (true) {
+        Thread* thd {nullptr};
+        {
+            const intr::IntrGuard guard;
+            while (dead.IsEmpty()) {
+                GetReaperQueue().Wait();
+            }
+
+            thd = &Thread::GetByTag(dead.Pop());
+        }
+
+        dbg::Assert(thd->GetStatus() == Thread::Status::Died);
+        FreeThreadBlock(thd);
+    }
+}
+
+void InitReaperThread() noexcept {
+    KrnlThread::Create("reaper", Process::default_priority, &Reap);
+}
+
 /**
  * @brief A wrapper of a global @p bool variable representing whether threads have been initialized.
  *
@@ -106,6 +310,20 @@ bool& IsThreadInitedImpl() noexcept {
     return inited;
 }
 
+/**
+ * @brief
+ * A wrapper of a global variable saving the physical address of the page directory table in @p CR3,
+ * or @p 0 if no table has been loaded by threads.
+ *
+ * @details
+ * Global variables cannot be initialized properly.
+ * We use @p static variables in methods instead since they can be initialized by methods.
+ */
+stl::uintptr_t& GetLoadedPageDir() noexcept {
+    static stl::uintptr_t phy_addr {0};
+    return phy_addr;
+}
+
 }  // namespace
 
 io::FileDesc ProcFileDescTab::SyncGlobal(const io::FileDesc global) noexcept {
@@ -120,11 +338,184 @@ void ProcFileDescTab::Reset(const io::FileDesc local) noexcept {
     Thread::GetFileDescTab().Reset(local);
 }
 
+FileDescTab& FileDescTab::Init() noexcept {
+    entries_ = nullptr;
+    size_ = init_entries_.size();
+    // The first three descriptors are standard I/O streams.
+    init_entries_[io::std_in].global = io::std_in;
+    init_entries_[io::std_out].global = io::std_out;
+    init_entries_[io::std_err].global = io::std_err;
+    // Push free entries in descending order, so lower descriptors are allocated first.
+    free_top_ = npos;
+    for (auto i {init_entries_.size()}; i != io::std_stream_count; --i) {
+        init_entries_[i - 1].global.Reset();
+        init_entries_[i - 1].next_free = free_top_;
+        free_top_ = i - 1;
+    }
+
+    return *this;
+}
+
+stl::size_t FileDescTab::GetSize() const noexcept {
+    return size_;
+}
+
+io::FileDesc FileDescTab::SyncGlobal(const io::FileDesc global) noexcept {
+    dbg::Assert(global.IsValid());
+    while (true) {
+        {
+            const intr::IntrGuard guard;
+            if (free_top_ != npos) {
+                const auto local {free_top_};
+                auto& entry {GetEntries()[local]};
+                free_top_ = entry.next_free;
+                entry.global = global;
+                return local;
+            }
+        }
+
+        if (!Grow()) {
+            io::PrintlnStr("The process file table is full.");
+            return {};
+        }
+    }
+}
+
+io::FileDesc FileDescTab::GetGlobal(const io::FileDesc local) const noexcept {
+    // Other threads of the process may grow the table and move entries.
+    const intr::IntrGuard guard;
+    dbg::Assert(io::std_stream_count <= local && local < size_);
+    const auto global {GetEntries()[local].global};
+    dbg::Assert(global.IsValid());
+    return global;
+}
+
+bool FileDescTab::IsOpen(const io::FileDesc local) const noexcept {
+    const intr::IntrGuard guard;
+    return io::std_stream_count <= local && local < size_ && GetEntries()[local].global.IsValid();
+}
+
+FileDescTab& FileDescTab::Reset(const io::FileDesc local) noexcept {
+    const intr::IntrGuard guard;
+    dbg::Assert(io::std_stream_count <= local && local < size_);
+    if (auto& entry {GetEntries()[local]}; entry.global.IsValid()) {
+        entry.global.Reset();
+        entry.next_free = free_top_;
+        free_top_ = local;
+    }
+
+    return *this;
+}
+
+FileDescTab& FileDescTab::CopyFrom(const FileDescTab& o) noexcept {
+    dbg::Assert(this != &o);
+    // Entries are in kernel memory, since the table is accessed in any address space.
+    const auto entries {o.entries_
+                            ? mem::Allocate<Entry>(mem::PoolType::Kernel, o.size_ * sizeof(Entry))
+                            : init_entries_.data()};
+    mem::AssertAlloc(entries);
+    const intr::IntrGuard guard;
+    for (stl::size_t i {0}; i != o.size_; ++i) {
+        entries[i] = o.GetEntries()[i];
+    }
+
+    entries_ = o.entries_ ? entries : nullptr;
+    size_ = o.size_;
+    free_top_ = o.free_top_;
+    return *this;
+}
+
+FileDescTab& FileDescTab::Fork() noexcept {
+    auto& file_tab {io::fs::GetFileTab()};
+    for (stl::size_t i {io::std_stream_count}; i != size_; ++i) {
+        // If a descriptor refers to an open file, increase its reference count.
+        if (auto& entry {GetEntries()[i]}; entry.global.IsValid()) {
+            if (const auto forked {file_tab.ForkDesc(entry.global)}; forked.IsValid()) {
+                entry.global = forked;
+            } else {
+                Reset(i);
+            }
+        }
+    }
+
+    return *this;
+}
+
+FileDescTab& FileDescTab::CloseAll() noexcept {
+    auto& file_tab {io::fs::GetFileTab()};
+    for (stl::size_t i {io::std_stream_count}; i != size_; ++i) {
+        if (const auto global {GetEntries()[i].global}; global.IsValid()) {
+            file_tab.FreeDesc(global);
+            Reset(i);
+        }
+    }
+
+    if (entries_) {
+        mem::Free(mem::PoolType::Kernel, entries_);
+    }
+
+    return Init();
+}
+
+bool FileDescTab::Grow() noexcept {
+    const auto old_size {size_};
+    if (old_size == max_open_file_count) {
+        return false;
+    }
+
+    // Memory allocation may sleep, so the new table is allocated with interrupts enabled.
+    const auto new_size {stl::min(old_size * 2, max_open_file_count)};
+    const auto new_entries {mem::Allocate<Entry>(mem::PoolType::Kernel, new_size * sizeof(Entry))};
+    if (!new_entries) {
+        return false;
+    }
+
+    Entry* old_entries {nullptr};
+    {
+        const intr::IntrGuard guard;
+        if (free_top_ != npos || size_ != old_size) {
+            // Another thread has released descriptors or grown the table.
+            old_entries = new_entries;
+        } else {
+            for (stl::size_t i {0}; i != size_; ++i) {
+                new_entries[i] = GetEntries()[i];
+            }
+
+            for (auto i {new_size}; i != size_; --i) {
+                new_entries[i - 1].global.Reset();
+                new_entries[i - 1].next_free = free_top_;
+                free_top_ = i - 1;
+            }
+
+            old_entries = entries_;
+            entries_ = new_entries;
+            size_ = new_size;
+        }
+    }
+
+    if (old_entries) {
+        mem::Free(mem::PoolType::Kernel, old_entries);
+    }
+
+    return true;
+}
+
+const FileDescTab::Entry* FileDescTab::GetEntries() const noexcept {
+    return entries_ ? entries_ : init_entries_.data();
+}
+
+FileDescTab::Entry* FileDescTab::GetEntries() noexcept {
+    return const_cast<Entry*>(const_cast<const FileDescTab&>(*this).GetEntries());
+}
+
 Thread& Thread::GetByTag(const TagList::Tag& tag, const TagType type) noexcept {
     switch (type) {
         case TagType::AllThreads: {
             return tag.GetElem<Thread, sizeof(TagList::Tag)>();
         }
+        case TagType::Sleeping: {
+            return tag.GetElem<Thread, 2 * sizeof(TagList::Tag)>();
+        }
         default: {
             return tag.GetElem<Thread>();
         }
@@ -137,7 +528,7 @@ bool Thread::IsKrnlThread() const noexcept {
 
 Thread& Thread::Fork() const noexcept {
     // Create a new thread and copy the current thread data to it.
-    const auto child {mem::AllocPages<Thread>(mem::PoolType::Kernel)};
+    const auto child {AllocThreadBlock()};
     mem::AssertAlloc(child);
     CopyTo(*child);
 
@@ -156,20 +547,36 @@ Thread& Thread::Fork() const noexcept {
     child->krnl_stack_ = static_cast<void*>(&switch_stack);
 
     dbg::Assert(child->status_ == Status::Died);
-    dbg::Assert(!GetThreadLists().all.Find(child->tags_.all_thds));
+    dbg::AssertSlow([&] { return !GetThreadLists().all.Find(child->tags_.all_thds); });
     GetThreadLists().all.PushBack(child->tags_.all_thds);
 
     child->status_ = Status::Ready;
-    dbg::Assert(!GetThreadLists().ready.Find(child->tags_.general));
-    GetThreadLists().ready.PushBack(child->tags_.general);
+    child->Enqueue();
     return *child;
 }
 
 void Thread::CopyTo(Thread& thd) const noexcept {
-    stl::memcpy(&thd, this, mem::page_size);
+    stl::memcpy(&thd, this, thd_block_size);
     thd.tags_ = {};
     thd.status_ = Status::Died;
     thd.elapsed_ticks_ = 0;
+    thd.level_ = thd.GetBaseLevel();
+    thd.sleeping_ = false;
+    thd.queued_ = false;
+    thd.detached_ = false;
+    thd.joiner_ = nullptr;
+    thd.acct_ = {};
+    thd.status_time_ = GetAcctTime();
+    thd.woken_ = false;
+    // Held mutexes belong to the current thread.
+    thd.inherited_priority_ = 0;
+    thd.held_mutex_count_ = 0;
+    thd.waiting_mtx_ = nullptr;
+    thd.intr_depth_ = 0;
+    thd.level_ = thd.GetBaseLevel();
+    cpu::CopyFpu(*this, thd);
+    // Cached blocks belong to the current thread.
+    thd.mem_blocks_ = nullptr;
     thd.krnl_stack_ = reinterpret_cast<void*>(thd.GetKrnlStackBottom() - sizeof(intr::IntrStack)
                                               - sizeof(StartupStack));
     thd.ResetTicks();
@@ -191,9 +598,23 @@ TagList::Tag& Thread::GetTag() noexcept {
     return const_cast<TagList::Tag&>(const_cast<const Thread&>(*this).GetTag());
 }
 
+const mem::MemBlockMagazines* Thread::GetMemBlockMagazines() const noexcept {
+    return mem_blocks_;
+}
+
+mem::MemBlockMagazines* Thread::GetMemBlockMagazines() noexcept {
+    return const_cast<mem::MemBlockMagazines*>(
+        const_cast<const Thread&>(*this).GetMemBlockMagazines());
+}
+
+Thread& Thread::SetMemBlockMagazines(mem::MemBlockMagazines* const mags) noexcept {
+    mem_blocks_ = mags;
+    return *this;
+}
+
 Thread& Thread::Create(const stl::string_view name, const stl::size_t priority,
                        const Callback callback, void* const arg, Process* const proc) noexcept {
-    const auto thd {mem::AllocPages<Thread>(mem::PoolType::Kernel)};
+    const auto thd {AllocThreadBlock()};
     mem::AssertAlloc(thd);
     return thd->Init(name, priority, proc).Start(callback, arg);
 }
@@ -206,16 +627,40 @@ Thread& Thread::Init(const stl::string_view name, const stl::size_t priority,
 
     stack_guard_ = stack_guard;
     priority_ = priority;
-    remain_ticks_ = priority;
+    time_slice_ = 0;
+    affinity_ = any_cpu;
+    inherited_priority_ = 0;
+    held_mutex_count_ = 0;
+    waiting_mtx_ = nullptr;
+    intr_depth_ = 0;
+    remain_ticks_ = GetTimeSlice();
     elapsed_ticks_ = 0;
+    level_ = GetBaseLevel();
+    sleeping_ = false;
+    queued_ = false;
+    detached_ = false;
+    joiner_ = nullptr;
+    acct_ = {};
+    status_time_ = GetAcctTime();
+    woken_ = false;
+    fpu_state_ = nullptr;
+    // The main thread of a process uses the first user stack.
+    usr_stack_idx_ = 0;
+    // The context switch in assembly finds the stack address at a fixed offset.
+    static_assert(__builtin_offsetof(Thread, krnl_stack_) == thd_krnl_stack_offset);
     krnl_stack_ = reinterpret_cast<void*>(GetKrnlStackBottom() - sizeof(intr::IntrStack)
                                           - sizeof(StartupStack));
     proc_ = proc;
+    if (proc_) {
+        proc_->OnThreadCreated();
+    }
+
+    mem_blocks_ = nullptr;
     // The main kernel thread is already running when the system starts.
     status_ = &KrnlThread::GetMain() == this ? Status::Running : Status::Died;
 
     // The thread has been created, but not ready to run (except the main kernel thread).
-    dbg::Assert(!GetThreadLists().all.Find(tags_.all_thds));
+    dbg::AssertSlow([&] { return !GetThreadLists().all.Find(tags_.all_thds); });
     GetThreadLists().all.PushBack(tags_.all_thds);
     return *this;
 }
@@ -227,11 +672,10 @@ Thread& Thread::Start(const Callback callback, void* const arg) noexcept {
     startup_stack.callback = callback;
     startup_stack.arg = arg;
     status_ = Status::Ready;
+    status_time_ = GetAcctTime();
 
     // The thread is ready to run. It can be scheduled now.
-    dbg::Assert(!GetThreadLists().ready.Find(tags_.general));
-    GetThreadLists().ready.PushBack(tags_.general);
-    return *this;
+    return Enqueue();
 }
 
 const intr::IntrStack& Thread::GetIntrStack() const noexcept {
@@ -260,12 +704,124 @@ Thread::StartupStack& Thread::GetStartupStack() noexcept {
     return const_cast<StartupStack&>(const_cast<const Thread&>(*this).GetStartupStack());
 }
 
+stl::string_view Thread::GetName() const noexcept {
+    return name_.data();
+}
+
 Thread::Status Thread::GetStatus() const noexcept {
     return status_;
 }
 
 stl::size_t Thread::GetPriority() const noexcept {
-    return priority_;
+    return stl::max(priority_, inherited_priority_);
+}
+
+Thread& Thread::InheritPriority(const stl::size_t priority) noexcept {
+    const intr::IntrGuard guard;
+    if (priority <= GetPriority()) {
+        return *this;
+    }
+
+    inherited_priority_ = priority;
+    if (const auto level {GetBaseLevel()}; level < level_) {
+        if (status_ == Status::Ready) {
+            // Move the thread to the new level in the run queue.
+            GetThreadLists().ready.Remove(tags_.general, level_);
+            level_ = level;
+            GetThreadLists().ready.PushFront(tags_.general, level_);
+        } else {
+            level_ = level;
+        }
+    }
+
+    return *this;
+}
+
+Thread& Thread::SetPriority(const stl::size_t priority) noexcept {
+    dbg::Assert(0 < priority && priority <= max_priority);
+    const intr::IntrGuard guard;
+    priority_ = priority;
+    if (const auto level {GetBaseLevel()}; status_ == Status::Ready && level != level_) {
+        // Move the thread to the new level in the run queue.
+        GetThreadLists().ready.Remove(tags_.general, level_);
+        level_ = level;
+        GetThreadLists().ready.PushBack(tags_.general, level_);
+    } else {
+        level_ = level;
+    }
+
+    return *this;
+}
+
+stl::size_t Thread::GetTimeSlice() const noexcept {
+    return time_slice_ != 0 ? time_slice_ : priority_;
+}
+
+Thread& Thread::SetTimeSlice(const stl::size_t ticks) noexcept {
+    dbg::Assert(ticks <= max_time_slice);
+    const intr::IntrGuard guard;
+    time_slice_ = ticks;
+    return *this;
+}
+
+stl::uint32_t Thread::GetAffinity() const noexcept {
+    return affinity_;
+}
+
+bool Thread::SetAffinity(const stl::uint32_t mask) noexcept {
+    // A thread that cannot run on any processor would never be scheduled.
+    if ((mask & cpu::GetOnlineCpuMask()) == 0) {
+        return false;
+    }
+
+    const intr::IntrGuard guard;
+    affinity_ = mask;
+    return true;
+}
+
+bool Thread::CanRunOn(const stl::size_t cpu_idx) const noexcept {
+    dbg::Assert(cpu_idx < cpu::max_cpu_count);
+    return (affinity_ & (static_cast<stl::uint32_t>(1) << cpu_idx)) != 0;
+}
+
+stl::size_t Thread::OnIntrEntered() noexcept {
+    return intr_depth_++;
+}
+
+Thread& Thread::OnIntrExited() noexcept {
+    dbg::Assert(intr_depth_ > 0);
+    --intr_depth_;
+    return *this;
+}
+
+Thread& Thread::OnMutexLocked() noexcept {
+    ++held_mutex_count_;
+    return *this;
+}
+
+Thread& Thread::OnMutexUnlocked() noexcept {
+    dbg::Assert(held_mutex_count_ > 0);
+    if (--held_mutex_count_ == 0 && inherited_priority_ != 0) {
+        // The thread no longer blocks other threads. It returns to its own priority.
+        const intr::IntrGuard guard;
+        inherited_priority_ = 0;
+        level_ = stl::max(level_, GetBaseLevel());
+    }
+
+    return *this;
+}
+
+stl::size_t Thread::GetHeldMutexCount() const noexcept {
+    return held_mutex_count_;
+}
+
+const sync::Mutex* Thread::GetWaitingMutex() const noexcept {
+    return waiting_mtx_;
+}
+
+Thread& Thread::SetWaitingMutex(const sync::Mutex* const mtx) noexcept {
+    waiting_mtx_ = mtx;
+    return *this;
 }
 
 Thread& Thread::SetStatus(const Status status) noexcept {
@@ -274,7 +830,7 @@ Thread& Thread::SetStatus(const Status status) noexcept {
 }
 
 stl::uintptr_t Thread::GetKrnlStackBottom() const noexcept {
-    return reinterpret_cast<stl::uintptr_t>(this) + mem::page_size;
+    return reinterpret_cast<stl::uintptr_t>(this) + thd_block_size;
 }
 
 Process* Thread::GetProcess() const noexcept {
@@ -293,7 +849,7 @@ bool Thread::Tick() noexcept {
     }
 }
 
-FileDescTab<max_open_file_count>& Thread::GetFileDescTab() noexcept {
+FileDescTab& Thread::GetFileDescTab() noexcept {
     auto& thd {GetCurrent()};
     if (thd.IsKrnlThread()) {
         return static_cast<KrnlThread&>(thd).GetFileDescTab();
@@ -308,10 +864,23 @@ void Thread::Unblock(Thread& thd) noexcept {
     dbg::Assert(thd.status_ == Status::Blocked || thd.status_ == Status::Hanging
                 || thd.status_ == Status::Waiting);
     const intr::IntrGuard guard;
-    dbg::Assert(!GetThreadLists().ready.Find(thd.GetTag()));
+    if (thd.sleeping_) {
+        // The thread is unblocked before its timeout.
+        thd.tags_.sleep.Detach();
+        thd.sleeping_ = false;
+    }
+
+    // The thread has been removed from its wait queue by the caller.
+    thd.queued_ = false;
+    const auto now {GetAcctTime()};
+    thd.acct_.blocked_time += now - thd.status_time_;
+    thd.status_time_ = now;
+    thd.woken_ = true;
     thd.status_ = Status::Ready;
-    // Put the thread at the beginning of the ready list so that it can be scheduled to run soon.
-    GetThreadLists().ready.PushFront(thd.GetTag());
+    // A thread blocked before its time slices run out is interactive or I/O-bound.
+    // Restore its base level and put it at the beginning of the level so that it can be scheduled to run soon.
+    thd.level_ = thd.GetBaseLevel();
+    thd.Enqueue(true);
 }
 
 void Thread::Block(const Status status) noexcept {
@@ -322,7 +891,11 @@ void Thread::Block(const Status status) noexcept {
     Schedule();
 }
 
-void Thread::Sleep(stl::size_t milliseconds) noexcept {
+void Thread::Sleep(const stl::size_t milliseconds) noexcept {
+    BlockFor(milliseconds, false);
+}
+
+bool Thread::BlockFor(stl::size_t milliseconds, const bool queued) noexcept {
     dbg::Assert(io::IsTimerInited());
     milliseconds = stl::max<stl::size_t>(1, milliseconds);
 
@@ -330,24 +903,147 @@ void Thread::Sleep(stl::size_t milliseconds) noexcept {
     constexpr auto milliseconds_per_intr {SecondsToMilliseconds(1) / io::timer_freq_per_second};
     const auto sleep_ticks {RoundUpDivide(milliseconds, milliseconds_per_intr)};
     dbg::Assert(sleep_ticks > 0);
-    const auto start_ticks {io::GetTicks()};
 
-    // Keep yielding if sleeping ticks are not enough.
-    while (io::GetTicks() - start_ticks < sleep_ticks) {
-        Yield();
+    const intr::IntrGuard guard;
+    wake_tick_ = io::GetTicks() + sleep_ticks;
+
+    // Insert the thread before the first thread waking up later,
+    // so threads with the same wake-up tick are woken in sleeping order.
+    auto& sleeping {GetThreadLists().sleeping};
+    dbg::Assert(!sleeping_);
+    dbg::AssertSlow([&] { return !sleeping.Find(tags_.sleep); });
+    const auto later {sleeping.Find(
+        [](const TagList::Tag& tag, void* const arg) noexcept {
+            return GetByTag(tag, TagType::Sleeping).wake_tick_
+                   > *static_cast<const stl::size_t*>(arg);
+        },
+        &wake_tick_)};
+    if (later) {
+        TagList::InsertBefore(*later, tags_.sleep);
+    } else {
+        sleeping.PushBack(tags_.sleep);
+    }
+
+    sleeping_ = true;
+    queued_ = queued;
+    timed_out_ = false;
+    Block(Status::Blocked);
+    dbg::Assert(!sleeping_ && !queued_);
+    return !timed_out_;
+}
+
+void Thread::WakeSleepers(const stl::size_t ticks) noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    auto& sleeping {GetThreadLists().sleeping};
+    bool woken {false};
+    while (!sleeping.IsEmpty()) {
+        auto& thd {GetByTag(sleeping.Pop(), TagType::Sleeping)};
+        if (thd.wake_tick_ > ticks) {
+            // The list is sorted, so the remaining threads are still sleeping.
+            sleeping.PushFront(thd.tags_.sleep);
+            break;
+        }
+
+        thd.sleeping_ = false;
+        thd.timed_out_ = true;
+        if (thd.queued_) {
+            // The timeout expires. Remove the thread from its wait queue.
+            thd.tags_.general.Detach();
+            thd.queued_ = false;
+        }
+
+        Unblock(thd);
+        woken = true;
+    }
+
+    // The idle thread should give up the CPU at once when any thread wakes up.
+    if (auto& curr {GetCurrent()}; woken && &curr == GetIdleThread()) {
+        curr.remain_ticks_ = 0;
+    }
+}
+
+stl::size_t Thread::GetNextWakeTick() noexcept {
+    const intr::IntrGuard guard;
+    auto& sleeping {GetThreadLists().sleeping};
+    if (sleeping.IsEmpty()) {
+        return npos;
+    }
+
+    // The first sleeping thread has the earliest wake-up tick.
+    auto& tag {sleeping.Pop()};
+    sleeping.PushFront(tag);
+    return GetByTag(tag, TagType::Sleeping).wake_tick_;
+}
+
+void Thread::Exit() noexcept {
+    dbg::Assert(this == &GetCurrent());
+    dbg::Assert(this != &KrnlThread::GetMain() && this != GetIdleThread());
+    cpu::ReleaseFpu(*this);
+    // Cached blocks would be leaked after the thread is freed.
+    // Nothing is allocated or freed after this, so the magazines are not allocated again.
+    mem::ReleaseMemBlockMagazines();
+
+    // Interrupts are not enabled again, since the thread will never run after being scheduled out.
+    // If it is detached, the reaper thread cannot free it until it is switched out.
+    intr::DisableIntr();
+    tags_.all_thds.Detach();
+    status_ = Status::Died;
+    if (proc_) {
+        proc_->OnThreadExited();
+    }
+
+    if (joiner_) {
+        Unblock(*joiner_);
+    } else if (detached_) {
+        GetThreadLists().dead.PushBack(tags_.general);
+        GetReaperQueue().WakeOne();
+    }
+
+    Schedule();
+    dbg::Assert(false, "An exited thread is scheduled again.");
+    while (true) {
     }
 }
 
+void Thread::Join() noexcept {
+    auto& curr_thd {GetCurrent()};
+    dbg::Assert(this != &curr_thd);
+    {
+        const intr::IntrGuard guard;
+        dbg::Assert(!detached_ && !joiner_);
+        joiner_ = &curr_thd;
+        if (status_ != Status::Died) {
+            curr_thd.Block(Status::Blocked);
+        }
+    }
+
+    // The thread has been switched out forever, so its thread block can be freed.
+    dbg::Assert(status_ == Status::Died);
+    FreeThreadBlock(this);
+}
+
+Thread& Thread::Detach() noexcept {
+    const intr::IntrGuard guard;
+    dbg::Assert(!detached_ && !joiner_);
+    detached_ = true;
+    if (status_ == Status::Died && !GetThreadLists().all.Find(tags_.all_thds)) {
+        // The thread has already exited.
+        GetThreadLists().dead.PushBack(tags_.general);
+        GetReaperQueue().WakeOne();
+    }
+
+    return *this;
+}
+
 void Thread::Yield() noexcept {
     const intr::IntrGuard guard;
-    dbg::Assert(!GetThreadLists().ready.Find(tags_.general));
     status_ = Status::Ready;
-    GetThreadLists().ready.PushBack(tags_.general);
+    Enqueue();
     Schedule();
 }
 
 Thread& Thread::ResetTicks() noexcept {
-    remain_ticks_ = priority_;
+    remain_ticks_ = GetTimeSlice();
     return *this;
 }
 
@@ -355,46 +1051,172 @@ bool Thread::IsStackValid() const noexcept {
     return stack_guard_ == stack_guard;
 }
 
+stl::size_t Thread::GetBaseLevel() const noexcept {
+    // Higher priorities have levels with higher precedence.
+    return RunQueue::level_count - 1 - stl::min(GetPriority(), RunQueue::level_count - 1);
+}
+
+Thread& Thread::Enqueue(const bool front) noexcept {
+    dbg::Assert(status_ == Status::Ready);
+    const intr::IntrGuard guard;
+    auto& ready {GetThreadLists().ready};
+    dbg::AssertSlow([&] { return !ready.Find(tags_.general); });
+    ready_tick_ = io::GetTicks();
+    if (front) {
+        ready.PushFront(tags_.general, level_);
+    } else {
+        ready.PushBack(tags_.general, level_);
+    }
+
+    return *this;
+}
+
+void Thread::AgeReadyThreads() noexcept {
+    dbg::Assert(!intr::IsIntrEnabled());
+    auto& ready {GetThreadLists().ready};
+    const auto ticks {io::GetTicks()};
+    // Each level is first-in-first-out, so only its first thread needs to be checked.
+    // The overhead depends on the number of levels instead of the number of threads.
+    for (auto levels {ready.GetNonEmptyLevels()}; levels != 0; levels &= levels - 1) {
+        if (const auto level {bit::GetLowestSetBit(levels)}; level != 0) {
+            auto& thd {GetByTag(ready.Pop(level))};
+            if (ticks - thd.ready_tick_ >= starvation_ticks) {
+                // The thread has waited too long. Move it to the highest level.
+                thd.level_ = 0;
+                thd.Enqueue();
+            } else {
+                ready.PushFront(thd.tags_.general, level);
+            }
+        }
+    }
+}
+
 void Thread::Schedule() noexcept {
     dbg::Assert(!intr::IsIntrEnabled());
+    const auto now {GetAcctTime()};
+    acct_.run_time += now - status_time_;
+    status_time_ = now;
     if (GetStatus() == Status::Running) {
-        dbg::Assert(!GetThreadLists().ready.Find(tags_.general));
+        ++acct_.involuntary_switch_count;
+        // Time slices run out. The thread is CPU-bound, so it is moved to a lower level.
+        level_ = stl::min(level_ + 1,
+                          stl::min(GetBaseLevel() + max_demotion_count, RunQueue::level_count - 1));
         ResetTicks();
         status_ = Status::Ready;
-        GetThreadLists().ready.PushBack(tags_.general);
+        Enqueue();
+    } else {
+        // The thread is blocked, yields or exits.
+        ++acct_.voluntary_switch_count;
+    }
+
+    AgeReadyThreads();
+
+    // Get a thread from the level with the highest precedence and switch to it.
+    // Threads that cannot run on the current processor are skipped and put back after selection.
+    auto& ready {GetThreadLists().ready};
+    const auto cpu_idx {cpu::GetCurrCpuIdx()};
+    TagList skipped;
+    Thread* selected {nullptr};
+    while (!selected) {
+        // If no thread is ready to run,
+        // the idle thread will be unblocked and added to the run queue.
+        if (ready.IsEmpty()) {
+            auto& idle_thd {GetIdleThread()};
+            dbg::Assert(idle_thd && idle_thd->CanRunOn(cpu_idx));
+            Thread::Unblock(*idle_thd);
+        }
+
+        dbg::Assert(!ready.IsEmpty());
+        if (auto& thd {GetByTag(ready.Pop())}; thd.CanRunOn(cpu_idx)) {
+            selected = &thd;
+        } else {
+            skipped.PushBack(thd.tags_.general);
+        }
     }
 
-    // If no thread is ready to run,
-    // the idle thread will be unblocked and added to the ready list.
-    if (GetThreadLists().ready.IsEmpty()) {
-        auto& idle_thd {GetIdleThread()};
-        dbg::Assert(idle_thd);
-        Thread::Unblock(*idle_thd);
+    while (!skipped.IsEmpty()) {
+        auto& thd {GetByTag(skipped.Pop())};
+        ready.PushBack(thd.tags_.general, thd.level_);
     }
 
-    // Get a thread from the ready list and switch to it.
-    dbg::Assert(!GetThreadLists().ready.IsEmpty());
-    auto& next {GetByTag(GetThreadLists().ready.Pop())};
+    auto& next {*selected};
+    // The idle thread may have been unblocked after `now`, so the time is read again.
+    const auto start {GetAcctTime()};
+    const auto ready_time {start - next.status_time_};
+    next.acct_.ready_time += ready_time;
+    if (next.woken_) {
+        next.acct_.max_wake_latency = stl::max(next.acct_.max_wake_latency, ready_time);
+        next.woken_ = false;
+    }
+
+    next.status_time_ = start;
     next.LoadKrnlEnv();
+    cpu::SwitchFpu(next);
     next.status_ = Status::Running;
+    dbg::Trace<dbg::TraceEvent::ThreadSwitch>(reinterpret_cast<stl::uint32_t>(this),
+                                              reinterpret_cast<stl::uint32_t>(&next));
     SwitchThread(*this, next);
 }
 
+ThreadStats Thread::GetStats() const noexcept {
+    const intr::IntrGuard guard;
+    ThreadStats stats {};
+    stl::strcpy_s(stats.name.data(), stats.name.max_size(), name_.data());
+    stats.status = static_cast<stl::size_t>(status_);
+    stats.priority = priority_;
+    stats.elapsed_ticks = elapsed_ticks_;
+    stats.run_time = acct_.run_time;
+    stats.ready_time = acct_.ready_time;
+    stats.blocked_time = acct_.blocked_time;
+    stats.max_wake_latency = acct_.max_wake_latency;
+    stats.voluntary_switch_count = acct_.voluntary_switch_count;
+    stats.involuntary_switch_count = acct_.involuntary_switch_count;
+    stats.time_slice = GetTimeSlice();
+    stats.affinity = affinity_;
+
+    // The running thread has not been accounted since it was scheduled.
+    if (status_ == Status::Running) {
+        stats.run_time += GetAcctTime() - status_time_;
+    }
+
+    return stats;
+}
+
+const cpu::FpuState* Thread::GetFpuState() const noexcept {
+    return fpu_state_;
+}
+
+cpu::FpuState* Thread::GetFpuState() noexcept {
+    return const_cast<cpu::FpuState*>(const_cast<const Thread&>(*this).GetFpuState());
+}
+
+Thread& Thread::SetFpuState(cpu::FpuState* const state) noexcept {
+    fpu_state_ = state;
+    return *this;
+}
+
 Thread& Thread::LoadPageDir() noexcept {
     return const_cast<Thread&>(const_cast<const Thread&>(*this).LoadPageDir());
 }
 
-const Thread& Thread::LoadPageDir() const noexcept {
+stl::uintptr_t Thread::GetPageDirPhyAddr() const noexcept {
     // `krnl_phy_addr` must be defined as a `static` variable to save the physical address of the kernel page directory table.
     // When `krnl_phy_addr` is evaluated for the first time, `CR3` is referring to the kernel page directory table.
     // So we can get its physical address by the virtual address `mem::page_dir_base`.
-    // If it is not `static`, it will be evaluated on each call of `LoadPageDir`.
+    // If it is not `static`, it will be evaluated on each call of `GetPageDirPhyAddr`.
     // After `CR3` refers to the page directory table of a user process,
     // `krnl_phy_addr` will be the physical address of that process-owned table, instead of the kernel page directory table.
     // In that case, we cannot make `CR3` refer to the kernel page directory table again.
     static const auto krnl_phy_addr {mem::VrAddr {mem::page_dir_base}.GetPhyAddr()};
     const auto proc {GetProcess()};
-    io::SetCr3(proc ? mem::VrAddr {proc->GetPageDir()}.GetPhyAddr() : krnl_phy_addr);
+    return proc ? mem::VrAddr {proc->GetPageDir()}.GetPhyAddr() : krnl_phy_addr;
+}
+
+const Thread& Thread::LoadPageDir() const noexcept {
+    // Writing `CR3` always flushes TLB entries, even if the table has been loaded.
+    auto& loaded {GetLoadedPageDir()};
+    loaded = GetPageDirPhyAddr();
+    io::SetCr3(loaded);
     return *this;
 }
 
@@ -403,7 +1225,13 @@ Thread& Thread::LoadKrnlEnv() noexcept {
 }
 
 const Thread& Thread::LoadKrnlEnv() const noexcept {
-    LoadPageDir();
+    // Kernel threads and threads of the same process share an address space.
+    // Switching between them keeps the loaded table and its TLB entries.
+    if (GetPageDirPhyAddr() != GetLoadedPageDir()) {
+        LoadPageDir();
+    }
+
+    GetKrnlData().pid = proc_ ? proc_->GetPid() : 0;
     if (!IsKrnlThread()) {
         // A user thread needs a task state segment to switch privileges.
         GetTaskStateSeg().Update(*this);
@@ -412,18 +1240,18 @@ const Thread& Thread::LoadKrnlEnv() const noexcept {
     return *this;
 }
 
-FileDescTab<max_open_file_count>& KrnlThread::GetFileDescTab() noexcept {
-    return const_cast<FileDescTab<max_open_file_count>&>(
+FileDescTab& KrnlThread::GetFileDescTab() noexcept {
+    return const_cast<FileDescTab&>(
         const_cast<const KrnlThread&>(*this).GetFileDescTab());
 }
 
-const FileDescTab<max_open_file_count>& KrnlThread::GetFileDescTab() const noexcept {
+const FileDescTab& KrnlThread::GetFileDescTab() const noexcept {
     return file_descs_;
 }
 
 KrnlThread& KrnlThread::Create(const stl::string_view name, const stl::size_t priority,
                                const Callback callback, void* const arg) noexcept {
-    const auto thd {mem::AllocPages<KrnlThread>(mem::PoolType::Kernel)};
+    const auto thd {static_cast<KrnlThread*>(AllocThreadBlock())};
     mem::AssertAlloc(thd);
     return static_cast<KrnlThread&>(thd->Init(name, priority).Start(callback, arg));
 }
@@ -451,12 +1279,104 @@ bool IsThreadInited() noexcept {
     return IsThreadInitedImpl();
 }
 
+void ReserveThreadBlocks(const stl::size_t count) noexcept {
+    if constexpr (thd_block_page_count == 1) {
+        GetThreadCache().Reserve(count);
+    }
+}
+
+void DumpThreadStats() noexcept {
+    static constexpr stl::string_view status_names[] {"Died",    "Ready",   "Running",
+                                               "Blocked", "Waiting", "Hanging"};
+    const intr::IntrGuard guard;
+    GetThreadLists().all.Find(
+        [](const TagList::Tag& tag, void*) noexcept {
+            const auto stats {Thread::GetByTag(tag, Thread::TagType::AllThreads).GetStats()};
+            io::Printf("Thread {} ({}), priority 0x{}, time slice 0x{}, affinity 0x{}:\n",
+                       stats.name.data(), status_names[stats.status], stats.priority,
+                       stats.time_slice, stats.affinity);
+            io::Printf("\tRun: 0x{} ns in 0x{} ticks.\n", stats.run_time, stats.elapsed_ticks);
+            io::Printf("\tReady: 0x{} ns, blocked: 0x{} ns, maximum wake-up latency: 0x{} ns.\n",
+                       stats.ready_time, stats.blocked_time, stats.max_wake_latency);
+            io::Printf("\tSwitches: 0x{} voluntary, 0x{} involuntary.\n",
+                       stats.voluntary_switch_count, stats.involuntary_switch_count);
+            return false;
+        });
+}
+
 void InitThread() noexcept {
     dbg::Assert(!IsThreadInited());
     dbg::Assert(mem::IsMemInited());
     KrnlThread::InitMain();
     InitIdleThread();
+    InitReaperThread();
     IsThreadInitedImpl() = true;
 }
 
-}  // namespace tsk
\ No newline at end of file
+namespace sc {
+
+bool Thread::GetStats(const stl::size_t idx, ThreadStats* const stats) noexcept {
+    dbg::Assert(stats);
+    struct Finder {
+        stl::size_t idx;
+        const tsk::Thread* thd;
+    };
+
+    const intr::IntrGuard guard;
+    Finder finder {idx, nullptr};
+    GetThreadLists().all.Find(
+        [](const TagList::Tag& tag, void* const arg) noexcept {
+            auto& finder {*static_cast<Finder*>(arg)};
+            if (finder.idx-- == 0) {
+                finder.thd = &tsk::Thread::GetByTag(tag, tsk::Thread::TagType::AllThreads);
+                return true;
+            } else {
+                return false;
+            }
+        },
+        &finder);
+
+    if (!finder.thd) {
+        return false;
+    }
+
+    *stats = finder.thd->GetStats();
+    return true;
+}
+
+bool Thread::Create(void* const code, void* const arg) noexcept {
+    const auto proc {Process::GetCurrent()};
+    dbg::Assert(proc);
+    return proc->StartThread(code, arg);
+}
+
+void Thread::Exit() noexcept {
+    dbg::Assert(!tsk::Thread::GetCurrent().IsKrnlThread());
+    Process::ExitCurrThread();
+}
+
+bool Thread::SetPriority(const stl::size_t priority) noexcept {
+    if (priority == 0 || priority > tsk::Thread::max_priority) {
+        return false;
+    }
+
+    tsk::Thread::GetCurrent().SetPriority(priority);
+    return true;
+}
+
+bool Thread::SetTimeSlice(const stl::size_t ticks) noexcept {
+    if (ticks > tsk::Thread::max_time_slice) {
+        return false;
+    }
+
+    tsk::Thread::GetCurrent().SetTimeSlice(ticks);
+    return true;
+}
+
+bool Thread::SetAffinity(const stl::uint32_t mask) noexcept {
+    return tsk::Thread::GetCurrent().SetAffinity(mask);
+}
+
+}  // namespace sc
+
+}  // namespace tsk
@@ -1,5 +1,6 @@
 #include "kernel/util/bitmap.h"
 #include "kernel/debug/assert.h"
+#include "kernel/stl/algorithm.h"
 #include "kernel/stl/cstring.h"
 #include "kernel/stl/utility.h"
 #include "kernel/util/bit.h"
@@ -9,6 +10,7 @@ Bitmap& Bitmap::Init(void* const bits, const stl::size_t byte_len, const bool cl
     dbg::Assert(bits && byte_len > 0);
     bits_ = static_cast<stl::uint8_t*>(bits);
     byte_len_ = byte_len;
+    free_hint_ = 0;
     if (clear) {
         Clear();
     }
@@ -16,16 +18,26 @@ Bitmap& Bitmap::Init(void* const bits, const stl::size_t byte_len, const bool cl
     return *this;
 }
 
+Bitmap& Bitmap::CopyFrom(const Bitmap& o) noexcept {
+    dbg::Assert(bits_ && o.bits_);
+    dbg::Assert(byte_len_ == o.byte_len_);
+    stl::memcpy(bits_, o.bits_, byte_len_);
+    free_hint_ = o.free_hint_;
+    return *this;
+}
+
 Bitmap::Bitmap(Bitmap&& o) noexcept {
     swap(o);
     o.bits_ = nullptr;
     o.byte_len_ = 0;
+    o.free_hint_ = 0;
 }
 
 Bitmap& Bitmap::operator=(Bitmap&& o) noexcept {
     swap(o);
     o.bits_ = nullptr;
     o.byte_len_ = 0;
+    o.free_hint_ = 0;
     return *this;
 }
 
@@ -33,10 +45,33 @@ const void* Bitmap::GetBits() const noexcept {
     return bits_;
 }
 
+stl::size_t Bitmap::GetFreeCount() const noexcept {
+    dbg::Assert(bits_);
+    stl::size_t count {0};
+    for (stl::size_t i {0}; i != RoundUpDivide(byte_len_, sizeof(stl::uint32_t)); ++i) {
+        // Clear the lowest free bit each time.
+        for (auto free {~LoadDword(i)}; free != 0; free &= free - 1) {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+stl::size_t Bitmap::GetFreeHint() const noexcept {
+    return free_hint_;
+}
+
+Bitmap& Bitmap::SetFreeHint(const stl::size_t hint) noexcept {
+    free_hint_ = stl::min(hint, GetCapacity());
+    return *this;
+}
+
 void Bitmap::swap(Bitmap& o) noexcept {
     using stl::swap;
     swap(bits_, o.bits_);
     swap(byte_len_, o.byte_len_);
+    swap(free_hint_, o.free_hint_);
 }
 
 stl::size_t Bitmap::GetCapacity() const noexcept {
@@ -94,11 +129,13 @@ Bitmap& Bitmap::SetBit(const stl::size_t idx, const bool val) noexcept {
 }
 
 Bitmap& Bitmap::Free(const stl::size_t begin, const stl::size_t count) noexcept {
+    free_hint_ = stl::min(free_hint_, begin);
     return Reset(begin, count);
 }
 
 Bitmap& Bitmap::Clear() noexcept {
     stl::memset(bits_, 0, byte_len_);
+    free_hint_ = 0;
     return *this;
 }
 
@@ -106,35 +143,105 @@ Bitmap& Bitmap::ForceAlloc(const stl::size_t begin, const stl::size_t count) noe
     return count > 0 ? Set(begin, count) : *this;
 }
 
-stl::size_t Bitmap::Alloc(const stl::size_t count) noexcept {
-    dbg::Assert(bits_ && count > 0);
-    stl::size_t byte_idx {0};
-    while (byte_idx != byte_len_ && bits_[byte_idx] == 0xFF) {
-        ++byte_idx;
+stl::uint32_t Bitmap::LoadDword(const stl::size_t dword_idx) const noexcept {
+    dbg::Assert(bits_);
+    const auto byte_idx {dword_idx * sizeof(stl::uint32_t)};
+    dbg::Assert(byte_idx < byte_len_);
+    if (byte_idx + sizeof(stl::uint32_t) <= byte_len_) {
+        return bit::CombineWords(bit::CombineBytes(bits_[byte_idx + 3], bits_[byte_idx + 2]),
+                                 bit::CombineBytes(bits_[byte_idx + 1], bits_[byte_idx]));
+    } else {
+        // The last double word is partial.
+        stl::uint32_t dword {0xFFFFFFFF};
+        for (auto i {byte_idx}; i != byte_len_; ++i) {
+            bit::SetByte(dword, bits_[i], (i - byte_idx) * bit::byte_len);
+        }
+
+        return dword;
+    }
+}
+
+stl::size_t Bitmap::FindFree(const stl::size_t begin, const stl::size_t end) const noexcept {
+    dbg::Assert(end <= GetCapacity());
+    auto idx {begin};
+    while (idx < end) {
+        const auto offset {idx % dword_bit_len};
+        // Mark bits before the beginning as allocated.
+        const auto dword {LoadDword(idx / dword_bit_len) | ((1u << offset) - 1)};
+        if (dword != 0xFFFFFFFF) {
+            const auto found {idx - offset + bit::GetLowestSetBit(~dword)};
+            return found < end ? found : npos;
+        }
+
+        idx += dword_bit_len - offset;
+    }
+
+    return npos;
+}
+
+stl::size_t Bitmap::FindAlloc(const stl::size_t begin, const stl::size_t end) const noexcept {
+    dbg::Assert(end <= GetCapacity());
+    auto idx {begin};
+    while (idx < end) {
+        const auto offset {idx % dword_bit_len};
+        // Mark bits before the beginning as free.
+        const auto dword {LoadDword(idx / dword_bit_len) & ~((1u << offset) - 1)};
+        if (dword != 0) {
+            const auto found {idx - offset + bit::GetLowestSetBit(dword)};
+            return found < end ? found : npos;
+        }
+
+        idx += dword_bit_len - offset;
     }
 
-    if (byte_idx == byte_len_) {
+    return npos;
+}
+
+stl::size_t Bitmap::Alloc(const stl::size_t count) noexcept {
+    dbg::Assert(bits_ && count > 0);
+    const auto capacity {GetCapacity()};
+    auto begin {FindFree(free_hint_, capacity)};
+    if (begin == npos) {
+        free_hint_ = capacity;
         return npos;
     }
 
-    stl::size_t bit_idx {0};
-    while (bit_idx != bit::byte_len && bit::IsBitSet(bits_[byte_idx], bit_idx)) {
-        ++bit_idx;
+    // All bits before the first free bit are allocated.
+    free_hint_ = begin;
+    return AllocInRange(begin, capacity, count);
+}
+
+stl::size_t Bitmap::AllocNear(const stl::size_t hint, const stl::size_t count) noexcept {
+    dbg::Assert(bits_ && count > 0);
+    if (const auto capacity {GetCapacity()}; hint < capacity) {
+        // Bits before the first possibly free bit are always allocated.
+        const auto begin {FindFree(stl::max(hint, free_hint_), capacity)};
+        if (const auto alloc {begin != npos ? AllocInRange(begin, capacity, count) : npos};
+            alloc != npos) {
+            return alloc;
+        }
     }
 
-    dbg::Assert(bit_idx < bit::byte_len);
-    bit_idx += byte_idx * bit::byte_len;
-    stl::size_t found_count {0};
-    for (auto i {bit_idx}; i != byte_len_ * bit::byte_len; ++i) {
-        if (!IsAlloc(i)) {
-            if (++found_count == count) {
-                const auto begin {i - count + 1};
-                Set(begin, count);
-                return begin;
+    return Alloc(count);
+}
+
+stl::size_t Bitmap::AllocInRange(stl::size_t begin, const stl::size_t end,
+                                 const stl::size_t count) noexcept {
+    dbg::Assert(end <= GetCapacity());
+    while (begin != npos && begin + count <= end) {
+        // Check whether the following bits are free.
+        const auto alloc {FindAlloc(begin, begin + count)};
+        if (alloc == npos) {
+            Set(begin, count);
+            if (begin == free_hint_) {
+                free_hint_ += count;
             }
-        } else {
-            found_count = 0;
+
+            return begin;
         }
+
+        // Skip the allocated bit and find the next free bit.
+        begin = FindFree(alloc + 1, end);
     }
 
     return npos;
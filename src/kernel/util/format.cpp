@@ -1,18 +1,96 @@
 #include "kernel/util/format.h"
+#include "kernel/stl/cstring.h"
+#include "kernel/util/bit.h"
 
-stl::size_t ConvertUIntToString(char* const buf, const stl::uint32_t num,
+namespace {
+
+//! Decimal strings of two digits from @p 00 to @p 99.
+constexpr char dec_digit_pairs[] {"00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899"};
+
+constexpr char hex_digits[] {"0123456789ABCDEF"};
+
+//! The maximum number of digits of a 32-bit unsigned integer, which is reached in binary.
+constexpr stl::size_t max_digit_count {sizeof(stl::uint32_t) * bit::byte_len};
+
+/**
+ * @brief Convert an unsigned integer to a decimal string.
+ *
+ * @details
+ * Two digits are converted in each step by looking up a table,
+ * which halves divisions. Divisions by a constant are compiled to multiplications.
+ */
+stl::size_t ConvertUIntToDecString(char* const buf, stl::uint32_t num) noexcept {
+    char digits[max_digit_count];
+    auto begin {max_digit_count};
+    while (num >= 100) {
+        const auto pair {(num % 100) * 2};
+        num /= 100;
+        digits[--begin] = dec_digit_pairs[pair + 1];
+        digits[--begin] = dec_digit_pairs[pair];
+    }
+
+    if (num >= 10) {
+        digits[--begin] = dec_digit_pairs[num * 2 + 1];
+        digits[--begin] = dec_digit_pairs[num * 2];
+    } else {
+        digits[--begin] = static_cast<char>('0' + num);
+    }
+
+    const auto len {max_digit_count - begin};
+    stl::memcpy(buf, digits + begin, len);
+    buf[len] = '\0';
+    return len;
+}
+
+}  // namespace
+
+stl::size_t ConvertUIntToHexString(char* const buf, stl::uint32_t num,
+                                   const stl::size_t min_len) noexcept {
+    dbg::Assert(buf);
+    constexpr stl::size_t digit_bit_len {4};
+    // The number of digits is known from the highest set bit, so digits are written from the end.
+    const auto digit_count {
+        num == 0 ? 1 : (bit::GetHighestSetBit(num) + digit_bit_len) / digit_bit_len};
+    const auto len {stl::max(digit_count, min_len)};
+    for (auto i {len}; i != 0; --i) {
+        buf[i - 1] = hex_digits[num & 0xF];
+        num >>= digit_bit_len;
+    }
+
+    buf[len] = '\0';
+    return len;
+}
+
+stl::size_t ConvertUIntToString(char* const buf, stl::uint32_t num,
                                 const stl::size_t base) noexcept {
     dbg::Assert(buf);
-    const auto digit {num % base};
-    const auto remain {num / base};
-    stl::size_t len {0};
-    if (remain > 0) {
-        len = ConvertUIntToString(buf, remain, base);
+    dbg::Assert(2 <= base && base <= sizeof(hex_digits) - 1);
+    if (base == 10) {
+        return ConvertUIntToDecString(buf, num);
+    } else if (base == 16) {
+        return ConvertUIntToHexString(buf, num);
     }
 
-    buf[len] = digit < 10 ? digit + '0' : digit - 10 + 'A';
-    buf[len + 1] = '\0';
-    return len + 1;
+    char digits[max_digit_count];
+    auto begin {max_digit_count};
+    do {
+        digits[--begin] = hex_digits[num % base];
+        num /= base;
+    } while (num > 0);
+
+    const auto len {max_digit_count - begin};
+    stl::memcpy(buf, digits + begin, len);
+    buf[len] = '\0';
+    return len;
 }
 
 stl::size_t ConvertIntToString(char* const buf, const stl::int32_t num,
@@ -20,7 +98,9 @@ stl::size_t ConvertIntToString(char* const buf, const stl::int32_t num,
     dbg::Assert(buf);
     if (num < 0) {
         buf[0] = '-';
-        return ConvertUIntToString(buf + 1, -num, base) + 1;
+        return ConvertUIntToString(
+                   buf + 1, static_cast<stl::uint32_t>(0) - static_cast<stl::uint32_t>(num), base)
+               + 1;
     } else {
         return ConvertUIntToString(buf, num, base);
     }
@@ -0,0 +1,289 @@
+#include "kernel/util/tag_tree.h"
+#include "kernel/debug/assert.h"
+
+TagTree& TagTree::Insert(Tag& tag, const Less less) noexcept {
+    dbg::Assert(less);
+    Tag* parent {nullptr};
+    auto link {&root_};
+    while (*link) {
+        parent = *link;
+        link = less(tag, *parent) ? &parent->left : &parent->right;
+    }
+
+    tag.parent = parent;
+    tag.left = nullptr;
+    tag.right = nullptr;
+    tag.red = true;
+    *link = &tag;
+    ++size_;
+    FixInsert(&tag);
+    return *this;
+}
+
+TagTree& TagTree::Erase(Tag& tag) noexcept {
+    dbg::Assert(size_ != 0);
+    // The tag replacing the removed position, which may be a null leaf, and its parent.
+    Tag* child {nullptr};
+    Tag* parent {nullptr};
+    bool removed_red {false};
+    if (!tag.left || !tag.right) {
+        child = tag.left ? tag.left : tag.right;
+        parent = tag.parent;
+        removed_red = tag.red;
+        Replace(tag, child);
+    } else {
+        // Move the successor, which has no left child, into the position of the tag.
+        auto succ {tag.right};
+        while (succ->left) {
+            succ = succ->left;
+        }
+
+        removed_red = succ->red;
+        child = succ->right;
+        if (succ->parent == &tag) {
+            parent = succ;
+        } else {
+            parent = succ->parent;
+            Replace(*succ, child);
+            succ->right = tag.right;
+            succ->right->parent = succ;
+        }
+
+        Replace(tag, succ);
+        succ->left = tag.left;
+        succ->left->parent = succ;
+        succ->red = tag.red;
+    }
+
+    --size_;
+    if (!removed_red) {
+        FixErase(child, parent);
+    }
+
+    tag.parent = nullptr;
+    tag.left = nullptr;
+    tag.right = nullptr;
+    return *this;
+}
+
+TagTree::Tag* TagTree::Find(const void* const key, const KeyCompare cmp) const noexcept {
+    dbg::Assert(cmp);
+    auto curr {root_};
+    while (curr) {
+        const auto res {cmp(*curr, key)};
+        if (res == 0) {
+            return curr;
+        }
+
+        curr = res < 0 ? curr->right : curr->left;
+    }
+
+    return nullptr;
+}
+
+TagTree::Tag* TagTree::LowerBound(const void* const key, const KeyCompare cmp) const noexcept {
+    dbg::Assert(cmp);
+    Tag* bound {nullptr};
+    auto curr {root_};
+    while (curr) {
+        if (cmp(*curr, key) < 0) {
+            curr = curr->right;
+        } else {
+            bound = curr;
+            curr = curr->left;
+        }
+    }
+
+    return bound;
+}
+
+TagTree::Tag* TagTree::GetFirst() const noexcept {
+    auto curr {root_};
+    while (curr && curr->left) {
+        curr = curr->left;
+    }
+
+    return curr;
+}
+
+TagTree::Tag* TagTree::GetNext(const Tag& tag) noexcept {
+    if (tag.right) {
+        auto curr {tag.right};
+        while (curr->left) {
+            curr = curr->left;
+        }
+
+        return curr;
+    }
+
+    // Go up until the tag is in a left subtree.
+    auto curr {&tag};
+    while (curr->parent && curr == curr->parent->right) {
+        curr = curr->parent;
+    }
+
+    return curr->parent;
+}
+
+stl::size_t TagTree::GetSize() const noexcept {
+    return size_;
+}
+
+bool TagTree::IsEmpty() const noexcept {
+    return size_ == 0;
+}
+
+void TagTree::Replace(const Tag& old_tag, Tag* const new_tag) noexcept {
+    const auto parent {old_tag.parent};
+    if (!parent) {
+        root_ = new_tag;
+    } else if (&old_tag == parent->left) {
+        parent->left = new_tag;
+    } else {
+        parent->right = new_tag;
+    }
+
+    if (new_tag) {
+        new_tag->parent = parent;
+    }
+}
+
+void TagTree::RotateLeft(Tag& tag) noexcept {
+    const auto right {tag.right};
+    dbg::Assert(right);
+    tag.right = right->left;
+    if (right->left) {
+        right->left->parent = &tag;
+    }
+
+    Replace(tag, right);
+    right->left = &tag;
+    tag.parent = right;
+}
+
+void TagTree::RotateRight(Tag& tag) noexcept {
+    const auto left {tag.left};
+    dbg::Assert(left);
+    tag.left = left->right;
+    if (left->right) {
+        left->right->parent = &tag;
+    }
+
+    Replace(tag, left);
+    left->right = &tag;
+    tag.parent = left;
+}
+
+void TagTree::FixInsert(Tag* tag) noexcept {
+    // A red parent is never the root, so the grandparent exists.
+    while (tag != root_ && tag->parent->red) {
+        auto parent {tag->parent};
+        const auto grand {parent->parent};
+        if (parent == grand->left) {
+            const auto uncle {grand->right};
+            if (uncle && uncle->red) {
+                parent->red = false;
+                uncle->red = false;
+                grand->red = true;
+                tag = grand;
+            } else {
+                if (tag == parent->right) {
+                    RotateLeft(*parent);
+                    tag = parent;
+                    parent = tag->parent;
+                }
+
+                parent->red = false;
+                grand->red = true;
+                RotateRight(*grand);
+            }
+        } else {
+            const auto uncle {grand->left};
+            if (uncle && uncle->red) {
+                parent->red = false;
+                uncle->red = false;
+                grand->red = true;
+                tag = grand;
+            } else {
+                if (tag == parent->left) {
+                    RotateRight(*parent);
+                    tag = parent;
+                    parent = tag->parent;
+                }
+
+                parent->red = false;
+                grand->red = true;
+                RotateLeft(*grand);
+            }
+        }
+    }
+
+    root_->red = false;
+}
+
+void TagTree::FixErase(Tag* tag, Tag* parent) noexcept {
+    // The tag carries an extra black. Its sibling always exists since the other side is deeper.
+    while (tag != root_ && (!tag || !tag->red)) {
+        if (tag == parent->left) {
+            auto sibling {parent->right};
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                RotateLeft(*parent);
+                sibling = parent->right;
+            }
+
+            if ((!sibling->left || !sibling->left->red)
+                && (!sibling->right || !sibling->right->red)) {
+                sibling->red = true;
+                tag = parent;
+                parent = tag->parent;
+            } else {
+                if (!sibling->right || !sibling->right->red) {
+                    sibling->left->red = false;
+                    sibling->red = true;
+                    RotateRight(*sibling);
+                    sibling = parent->right;
+                }
+
+                sibling->red = parent->red;
+                parent->red = false;
+                sibling->right->red = false;
+                RotateLeft(*parent);
+                tag = root_;
+            }
+        } else {
+            auto sibling {parent->left};
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                RotateRight(*parent);
+                sibling = parent->left;
+            }
+
+            if ((!sibling->left || !sibling->left->red)
+                && (!sibling->right || !sibling->right->red)) {
+                sibling->red = true;
+                tag = parent;
+                parent = tag->parent;
+            } else {
+                if (!sibling->left || !sibling->left->red) {
+                    sibling->right->red = false;
+                    sibling->red = true;
+                    RotateLeft(*sibling);
+                    sibling = parent->left;
+                }
+
+                sibling->red = parent->red;
+                parent->red = false;
+                sibling->left->red = false;
+                RotateRight(*parent);
+                tag = root_;
+            }
+        }
+    }
+
+    if (tag) {
+        tag->red = false;
+    }
+}
@@ -0,0 +1,14 @@
+#include "user/debug/prof.h"
+#include "user/syscall/call.h"
+
+namespace usr::dbg {
+
+void ResetProfiler(const bool enabled) noexcept {
+    sc::SysCall(sc::SysCallType::ResetProfiler, enabled);
+}
+
+void DumpProfile() noexcept {
+    sc::SysCall(sc::SysCallType::DumpProfile);
+}
+
+}  // namespace usr::dbg
@@ -0,0 +1,14 @@
+#include "user/debug/trace.h"
+#include "user/syscall/call.h"
+
+namespace usr::dbg {
+
+bool ResetTrace(const bool enabled) noexcept {
+    return sc::SysCall(sc::SysCallType::ResetTrace, enabled);
+}
+
+void DumpTrace() noexcept {
+    sc::SysCall(sc::SysCallType::DumpTrace);
+}
+
+}  // namespace usr::dbg
@@ -0,0 +1,14 @@
+#include "user/interrupt/intr.h"
+#include "user/syscall/call.h"
+
+namespace usr::intr {
+
+bool GetIntrStats(const stl::size_t intr_num, IntrStats& stats) noexcept {
+    return sc::SysCall(sc::SysCallType::IntrStats, intr_num, &stats);
+}
+
+void ResetIntrStats(const bool enabled) noexcept {
+    sc::SysCall(sc::SysCallType::ResetIntrStats, enabled);
+}
+
+}  // namespace usr::intr
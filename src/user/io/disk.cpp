@@ -0,0 +1,10 @@
+#include "user/io/disk.h"
+#include "user/syscall/call.h"
+
+namespace usr::io {
+
+bool GetDiskStats(const char* const name, DiskStats& stats) noexcept {
+    return sc::SysCall(sc::SysCallType::DiskStats, name, &stats);
+}
+
+}  // namespace usr::io
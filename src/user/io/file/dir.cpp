@@ -4,7 +4,12 @@
 namespace usr::io {
 
 bool Directory::Create(const char* const path) noexcept {
-    return sc::SysCall(sc::SysCallType::CreateDir, const_cast<char*>(path));
+    return sc::SysCall(sc::SysCallType::CreateDir, path);
+}
+
+stl::size_t Directory::ReadEntries(const char* const path, DirCursor& cursor,
+                                   DirEntry* const entries, const stl::size_t count) noexcept {
+    return sc::SysCall(sc::SysCallType::ReadDirEntries, path, &cursor, entries, count);
 }
 
 }
\ No newline at end of file
@@ -4,56 +4,51 @@
 namespace usr::io {
 
 stl::size_t File::Open(const char* const path, const stl::uint32_t flags) noexcept {
-    struct Args {
-        const char* path;
-        stl::uint32_t flags;
-    };
-
-    Args args {path, flags};
-    return sc::SysCall(sc::SysCallType::OpenFile, reinterpret_cast<void*>(&args));
+    return sc::SysCall(sc::SysCallType::OpenFile, path, flags);
 }
 
 void File::Close(const stl::size_t desc) noexcept {
-    sc::SysCall(sc::SysCallType::CloseFile, reinterpret_cast<void*>(desc));
+    sc::SysCall(sc::SysCallType::CloseFile, desc);
 }
 
 bool File::Delete(const char* const path) noexcept {
-    return sc::SysCall(sc::SysCallType::DeleteFile, const_cast<char*>(path));
+    return sc::SysCall(sc::SysCallType::DeleteFile, path);
+}
+
+void File::Sync() noexcept {
+    sc::SysCall(sc::SysCallType::SyncFiles);
+}
+
+void File::GetSysStats(FileSysStats& stats) noexcept {
+    sc::SysCall(sc::SysCallType::FileSysStats, &stats);
 }
 
 stl::size_t File::Write(const stl::size_t desc, const void* const data,
                         const stl::size_t size) noexcept {
-    struct Args {
-        stl::size_t desc;
-        const void* data;
-        stl::size_t size;
-    };
-
-    Args args {desc, data, size};
-    return sc::SysCall(sc::SysCallType::WriteFile, reinterpret_cast<void*>(&args));
+    return sc::SysCall(sc::SysCallType::WriteFile, desc, data, size);
 }
 
 stl::size_t File::Seek(const stl::size_t desc, const stl::int32_t offset,
                        const SeekOrigin origin) noexcept {
-    struct Args {
-        stl::size_t desc;
-        stl::int32_t offset;
-        SeekOrigin origin;
-    };
-
-    Args args {desc, offset, origin};
-    return sc::SysCall(sc::SysCallType::SeekFile, reinterpret_cast<void*>(&args));
+    return sc::SysCall(sc::SysCallType::SeekFile, desc, offset, origin);
 }
 
 stl::size_t File::Read(const stl::size_t desc, void* const buf, const stl::size_t size) noexcept {
-    struct Args {
-        stl::size_t desc;
-        void* buf;
-        stl::size_t size;
-    };
-
-    Args args {desc, buf, size};
-    return sc::SysCall(sc::SysCallType::ReadFile, reinterpret_cast<void*>(&args));
+    return sc::SysCall(sc::SysCallType::ReadFile, desc, buf, size);
+}
+
+bool File::Reserve(const stl::size_t desc, const stl::size_t size) noexcept {
+    return sc::SysCall(sc::SysCallType::ReserveFile, desc, size);
+}
+
+stl::size_t File::WriteV(const stl::size_t desc, const IoVec* const vecs,
+                         const stl::size_t count) noexcept {
+    return sc::SysCall(sc::SysCallType::WriteFileV, desc, vecs, count);
+}
+
+stl::size_t File::ReadV(const stl::size_t desc, const IoVec* const vecs,
+                        const stl::size_t count) noexcept {
+    return sc::SysCall(sc::SysCallType::ReadFileV, desc, vecs, count);
 }
 
 }  // namespace usr::io
\ No newline at end of file
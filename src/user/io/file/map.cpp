@@ -0,0 +1,20 @@
+#include "user/io/file/map.h"
+#include "user/syscall/call.h"
+
+namespace usr::io {
+
+void* FileMap::Map(const stl::size_t desc, const stl::size_t offset, const stl::size_t size,
+                   const bool writable) noexcept {
+    return reinterpret_cast<void*>(
+        sc::SysCall(sc::SysCallType::MapFile, desc, offset, size, writable));
+}
+
+bool FileMap::Unmap(void* const addr) noexcept {
+    return sc::SysCall(sc::SysCallType::UnmapFile, addr);
+}
+
+bool FileMap::Sync(void* const addr) noexcept {
+    return sc::SysCall(sc::SysCallType::SyncFileMap, addr);
+}
+
+}  // namespace usr::io
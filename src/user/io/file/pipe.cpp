@@ -0,0 +1,17 @@
+#include "user/io/file/pipe.h"
+#include "user/syscall/call.h"
+
+namespace usr::io {
+
+bool Pipe::Create(stl::size_t& read_end, stl::size_t& write_end) noexcept {
+    stl::size_t descs[2];
+    if (!sc::SysCall(sc::SysCallType::CreatePipe, descs)) {
+        return false;
+    }
+
+    read_end = descs[0];
+    write_end = descs[1];
+    return true;
+}
+
+}  // namespace usr::io
@@ -0,0 +1,52 @@
+#include "user/io/file/ring.h"
+#include "user/syscall/call.h"
+
+namespace usr::io {
+
+IoRing::IoRing(Shared& shared) noexcept : shared_ {shared} {}
+
+bool IoRing::Setup() noexcept {
+    return sc::SysCall(sc::SysCallType::SetupIoRing, &shared_);
+}
+
+bool IoRing::Queue(const Op op, const stl::size_t desc, void* const buf, const stl::size_t size,
+                   const stl::size_t user_data) noexcept {
+    const auto head {shared_.submit_head};
+    if (head - __atomic_load_n(&shared_.submit_tail, __ATOMIC_ACQUIRE) == entry_count) {
+        return false;
+    }
+
+    shared_.submits[head % entry_count] = {static_cast<stl::size_t>(op), desc, buf, size,
+                                           user_data};
+    // Publish the submission after writing it.
+    __atomic_store_n(&shared_.submit_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool IoRing::QueueRead(const stl::size_t desc, void* const buf, const stl::size_t size,
+                       const stl::size_t user_data) noexcept {
+    return Queue(Op::Read, desc, buf, size, user_data);
+}
+
+bool IoRing::QueueWrite(const stl::size_t desc, const void* const data, const stl::size_t size,
+                        const stl::size_t user_data) noexcept {
+    return Queue(Op::Write, desc, const_cast<void*>(data), size, user_data);
+}
+
+stl::size_t IoRing::Submit(const stl::size_t min_complete) noexcept {
+    return sc::SysCall(sc::SysCallType::EnterIoRing, min_complete);
+}
+
+bool IoRing::Pop(Completion& completion) noexcept {
+    const auto tail {shared_.complete_tail};
+    if (tail == __atomic_load_n(&shared_.complete_head, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    completion = shared_.completes[tail % entry_count];
+    // Release the slot after reading it.
+    __atomic_store_n(&shared_.complete_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+}  // namespace usr::io
@@ -0,0 +1,22 @@
+#include "user/io/timer.h"
+#include "user/process/krnl_data.h"
+
+namespace usr::io {
+
+stl::uint64_t GetNanoseconds() noexcept {
+    // Convert cycles to nanoseconds with clock parameters in the kernel data page,
+    // which is the same as the kernel's `io::GetNanoseconds`, without a system call.
+    const auto& data {tsk::GetKrnlData()};
+    const auto cycles {__builtin_ia32_rdtsc() - data.tsc_base};
+    const auto high {static_cast<stl::uint64_t>(static_cast<stl::uint32_t>(cycles >> 32))
+                     * data.tsc_ns_mult};
+    const auto low {static_cast<stl::uint64_t>(static_cast<stl::uint32_t>(cycles))
+                    * data.tsc_ns_mult};
+    return (high << (32 - data.tsc_ns_shift)) + (low >> data.tsc_ns_shift);
+}
+
+stl::size_t GetTicks() noexcept {
+    return tsk::ReadKrnlData(&tsk::KrnlData::ticks);
+}
+
+}  // namespace usr::io
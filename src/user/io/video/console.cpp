@@ -24,15 +24,15 @@ void Console::PrintlnHex(const stl::int32_t num) noexcept {
 }
 
 void Console::PrintChar(const char ch) noexcept {
-    sc::SysCall(sc::SysCallType::PrintChar, reinterpret_cast<void*>(ch));
+    sc::SysCall(sc::SysCallType::PrintChar, ch);
 }
 
 void Console::PrintStr(const char* const str) noexcept {
-    sc::SysCall(sc::SysCallType::PrintStr, const_cast<char*>(str));
+    sc::SysCall(sc::SysCallType::PrintStr, str);
 }
 
 void Console::PrintHex(const stl::uint32_t num) noexcept {
-    sc::SysCall(sc::SysCallType::PrintHex, reinterpret_cast<void*>(num));
+    sc::SysCall(sc::SysCallType::PrintHex, num);
 }
 
 void Console::PrintHex(const stl::int32_t num) noexcept {
@@ -44,4 +44,77 @@ void Console::PrintHex(const stl::int32_t num) noexcept {
     }
 }
 
+void Console::Write(const char* const buf, const stl::size_t size) noexcept {
+    sc::SysCall(sc::SysCallType::WriteConsole, buf, size);
+}
+
+stl::size_t Console::Read(char* const buf, const stl::size_t size) noexcept {
+    return sc::SysCall(sc::SysCallType::ReadConsole, buf, size);
+}
+
+void Console::SetCanonical(const bool canonical) noexcept {
+    sc::SysCall(sc::SysCallType::SetConsoleMode, canonical);
+}
+
+ConsoleStream::~ConsoleStream() noexcept {
+    Flush();
+}
+
+ConsoleStream& ConsoleStream::Print(const char ch) noexcept {
+    buf_[size_++] = ch;
+    // The stream is line-buffered.
+    if (ch == '\n' || size_ == buf_size) {
+        Flush();
+    }
+
+    return *this;
+}
+
+ConsoleStream& ConsoleStream::Print(const char* const str) noexcept {
+    for (auto curr {str}; *curr != '\0'; ++curr) {
+        Print(*curr);
+    }
+
+    return *this;
+}
+
+ConsoleStream& ConsoleStream::Print(const stl::uint32_t num) noexcept {
+    constexpr stl::size_t max_digit_count {10};
+    char digits[max_digit_count];
+    stl::size_t count {0};
+    auto remain {num};
+    do {
+        digits[count++] = static_cast<char>('0' + remain % 10);
+        remain /= 10;
+    } while (remain > 0);
+
+    while (count > 0) {
+        Print(digits[--count]);
+    }
+
+    return *this;
+}
+
+ConsoleStream& ConsoleStream::Print(const stl::int32_t num) noexcept {
+    if (num >= 0) {
+        return Print(static_cast<stl::uint32_t>(num));
+    } else {
+        Print('-');
+        return Print(static_cast<stl::uint32_t>(0) - static_cast<stl::uint32_t>(num));
+    }
+}
+
+ConsoleStream& ConsoleStream::Printf(const char* const format) noexcept {
+    return Print(format);
+}
+
+ConsoleStream& ConsoleStream::Flush() noexcept {
+    if (size_ > 0) {
+        Console::Write(buf_, size_);
+        size_ = 0;
+    }
+
+    return *this;
+}
+
 }  // namespace usr::io
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "user/memory/pool.h"
+
+namespace usr::mem {
+
+namespace {
+
+inline constexpr stl::size_t page_size {0x1000};
+
+/**
+ * @brief The base address of the heap state.
+ *
+ * @details
+ * User library code and data are in the kernel image, which is shared by all processes.
+ * So the heap state cannot be saved in global variables.
+ * The kernel reserves a page at this address for each process, which is zeroed on first access.
+ * It must be the same as @p usr_heap_state_base in @p src/kernel/process/proc.cpp.
+ */
+inline constexpr stl::uintptr_t heap_state_base {0x40000000};
+
+//! The size of memory requested from the kernel when free blocks run out.
+inline constexpr stl::size_t chunk_size {page_size * 16};
+
+inline constexpr stl::size_t min_block_size {16};
+inline constexpr stl::size_t max_block_size {1024};
+
+//! The number of size classes, from @p min_block_size to @p max_block_size in powers of two.
+inline constexpr stl::size_t class_count {7};
+
+/**
+ * @brief The header at the beginning of an arena.
+ *
+ * @details
+ * An arena is a page divided into blocks of the same size,
+ * or a number of pages for a single allocation larger than @p max_block_size.
+ */
+struct Arena {
+    //! The number of pages for a large arena, otherwise @p 0.
+    stl::size_t page_count;
+    //! The index of the size class for a small arena.
+    stl::size_t class_idx;
+};
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct HeapState {
+    //! Free blocks of each size class.
+    FreeBlock* free_blocks[class_count];
+    //! The next unused page in the current chunk.
+    stl::uintptr_t chunk_next;
+    //! The end of the current chunk.
+    stl::uintptr_t chunk_end;
+    //! Whether a thread of the process is using the heap.
+    bool locked;
+};
+
+static_assert(sizeof(HeapState) <= page_size);
+
+HeapState& GetHeapState() noexcept {
+    return *reinterpret_cast<HeapState*>(heap_state_base);
+}
+
+/**
+ * @brief The guard locking the heap state for threads of a process.
+ *
+ * @details
+ * It spins until the lock is free. A preempted holder runs again after other threads use up their time slices.
+ */
+class HeapGuard {
+public:
+    explicit HeapGuard(HeapState& heap) noexcept : heap_ {heap} {
+        while (__atomic_exchange_n(&heap_.locked, true, __ATOMIC_ACQUIRE)) {
+            while (__atomic_load_n(&heap_.locked, __ATOMIC_RELAXED)) {
+                __builtin_ia32_pause();
+            }
+        }
+    }
+
+    HeapGuard(const HeapGuard&) = delete;
+
+    ~HeapGuard() noexcept {
+        __atomic_store_n(&heap_.locked, false, __ATOMIC_RELEASE);
+    }
+
+private:
+    HeapState& heap_;
+};
+
+constexpr stl::size_t GetBlockSize(const stl::size_t class_idx) noexcept {
+    return min_block_size << class_idx;
+}
+
+//! Get the smallest size class that satisfies the required size.
+constexpr stl::size_t GetClassIdx(const stl::size_t size) noexcept {
+    stl::size_t idx {0};
+    while (GetBlockSize(idx) < size) {
+        ++idx;
+    }
+
+    return idx;
+}
+
+static_assert(GetBlockSize(class_count - 1) == max_block_size);
+
+Arena& GetArena(const void* const block) noexcept {
+    return *reinterpret_cast<Arena*>(reinterpret_cast<stl::uintptr_t>(block) & ~(page_size - 1));
+}
+
+void Zero(void* const base, const stl::size_t size) noexcept {
+    const auto bytes {static_cast<stl::byte*>(base)};
+    for (stl::size_t i {0}; i != size; ++i) {
+        bytes[i] = 0;
+    }
+}
+
+//! Take an unused page from the current chunk, or request a new chunk from the kernel.
+void* AllocArenaPage(HeapState& heap) noexcept {
+    if (heap.chunk_next == heap.chunk_end) {
+        // Chunk pages are reserved and mapped by the kernel on first access.
+        const auto chunk {MapMem(nullptr, chunk_size)};
+        if (!chunk) {
+            return nullptr;
+        }
+
+        heap.chunk_next = reinterpret_cast<stl::uintptr_t>(chunk);
+        heap.chunk_end = heap.chunk_next + chunk_size;
+    }
+
+    const auto page {reinterpret_cast<void*>(heap.chunk_next)};
+    heap.chunk_next += page_size;
+    return page;
+}
+
+//! Divide a new arena into blocks and add them to the free block list of a size class.
+bool RefillFreeBlocks(HeapState& heap, const stl::size_t class_idx) noexcept {
+    const auto arena {static_cast<Arena*>(AllocArenaPage(heap))};
+    if (!arena) {
+        return false;
+    }
+
+    arena->page_count = 0;
+    arena->class_idx = class_idx;
+    const auto block_size {GetBlockSize(class_idx)};
+    const auto block_count {(page_size - sizeof(Arena)) / block_size};
+    const auto blocks {reinterpret_cast<stl::byte*>(arena) + sizeof(Arena)};
+    for (stl::size_t i {0}; i != block_count; ++i) {
+        const auto block {reinterpret_cast<FreeBlock*>(blocks + i * block_size)};
+        block->next = heap.free_blocks[class_idx];
+        heap.free_blocks[class_idx] = block;
+    }
+
+    return true;
+}
+
+}  // namespace
+
+void* Allocate(const stl::size_t size) noexcept {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    if (size > max_block_size) {
+        // Directly map pages for a large allocation. They are zeroed by the kernel.
+        const auto page_count {(size + sizeof(Arena) + page_size - 1) / page_size};
+        const auto arena {static_cast<Arena*>(MapMem(nullptr, page_count * page_size))};
+        if (!arena) {
+            return nullptr;
+        }
+
+        arena->page_count = page_count;
+        return reinterpret_cast<stl::byte*>(arena) + sizeof(Arena);
+    }
+
+    auto& heap {GetHeapState()};
+    const HeapGuard guard {heap};
+    const auto class_idx {GetClassIdx(size)};
+    if (!heap.free_blocks[class_idx] && !RefillFreeBlocks(heap, class_idx)) {
+        return nullptr;
+    }
+
+    const auto block {heap.free_blocks[class_idx]};
+    heap.free_blocks[class_idx] = block->next;
+    Zero(block, GetBlockSize(class_idx));
+    return block;
+}
+
+void Free(void* const base) noexcept {
+    if (!base) {
+        return;
+    }
+
+    auto& arena {GetArena(base)};
+    if (arena.page_count > 0) {
+        UnmapMem(&arena, arena.page_count * page_size);
+    } else {
+        auto& heap {GetHeapState()};
+        const HeapGuard guard {heap};
+        const auto block {static_cast<FreeBlock*>(base)};
+        block->next = heap.free_blocks[arena.class_idx];
+        heap.free_blocks[arena.class_idx] = block;
+    }
+}
+
+}  // namespace usr::mem
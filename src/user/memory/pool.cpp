@@ -3,13 +3,24 @@
 
 namespace usr::mem {
 
-void* Allocate(const stl::size_t size) noexcept {
-    return reinterpret_cast<void*>(
-        SysCall(sc::SysCallType::MemAlloc, reinterpret_cast<void*>(size)));
+void GetStats(const PoolType type, MemStats& stats) noexcept {
+    SysCall(sc::SysCallType::MemStats, type, &stats);
 }
 
-void Free(void* const base) noexcept {
-    SysCall(sc::SysCallType::MemFree, base);
+void* MapMem(void* const addr, const stl::size_t size, const stl::uint32_t flags) noexcept {
+    return reinterpret_cast<void*>(SysCall(sc::SysCallType::MapMem, addr, size, flags));
+}
+
+bool UnmapMem(void* const addr, const stl::size_t size) noexcept {
+    return SysCall(sc::SysCallType::UnmapMem, addr, size);
+}
+
+void* MapSharedMem(const char* const name, const stl::size_t size) noexcept {
+    return reinterpret_cast<void*>(SysCall(sc::SysCallType::MapSharedMem, name, size));
+}
+
+bool DeleteSharedMem(const char* const name) noexcept {
+    return SysCall(sc::SysCallType::DeleteSharedMem, name);
 }
 
 }  // namespace usr::mem
\ No newline at end of file
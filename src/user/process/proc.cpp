@@ -1,13 +1,98 @@
 #include "user/process/proc.h"
+#include "user/memory/pool.h"
+#include "user/process/krnl_data.h"
 #include "user/syscall/call.h"
 
 namespace usr::tsk {
+
+namespace {
+
+//! The startup data of a thread, allocated from the heap.
+struct Startup {
+    Thread::Callback callback;
+    void* arg;
+};
+
+/**
+ * @brief The code entry of threads created by @p Thread::Create.
+ *
+ * @details
+ * The kernel calls it with the startup data on a new stack, where the return address is invalid.
+ * So it exits the thread by a system call instead of returning.
+ */
+[[noreturn]] void StartThread(Startup* const startup) noexcept {
+    const auto [callback, arg] {*startup};
+    mem::Free(startup);
+    callback(arg);
+    Thread::Exit();
+}
+
+}  // namespace
+
+bool Thread::Create(const Callback callback, void* const arg) noexcept {
+    const auto startup {static_cast<Startup*>(mem::Allocate(sizeof(Startup)))};
+    if (!startup) {
+        return false;
+    }
+
+    startup->callback = callback;
+    startup->arg = arg;
+    if (!SysCall(sc::SysCallType::CreateThread, reinterpret_cast<void*>(&StartThread), startup)) {
+        mem::Free(startup);
+        return false;
+    }
+
+    return true;
+}
+
+void Thread::Exit() noexcept {
+    SysCall(sc::SysCallType::ExitThread);
+    while (true) {
+    }
+}
+
+bool Thread::SetPriority(const stl::size_t priority) noexcept {
+    return SysCall(sc::SysCallType::SetThreadPriority, priority);
+}
+
+bool Thread::SetTimeSlice(const stl::size_t ticks) noexcept {
+    return SysCall(sc::SysCallType::SetThreadTimeSlice, ticks);
+}
+
+bool Thread::SetAffinity(const stl::uint32_t mask) noexcept {
+    return SysCall(sc::SysCallType::SetThreadAffinity, mask);
+}
+
 stl::size_t Process::GetCurrPid() noexcept {
-    return SysCall(sc::SysCallType::GetCurrPid);
+    // The kernel updates the process ID in the kernel data page when switching threads.
+    return ReadKrnlData(&KrnlData::pid);
 }
 
 stl::size_t Process::Fork() noexcept {
     return SysCall(sc::SysCallType::Fork);
 }
 
+void Process::Exit(const stl::int32_t status) noexcept {
+    SysCall(sc::SysCallType::ExitProcess, status);
+    while (true) {
+    }
+}
+
+bool Process::Wait(const stl::size_t pid, stl::int32_t& status) noexcept {
+    return SysCall(sc::SysCallType::WaitProcess, pid, &status);
+}
+
+bool Process::Exec(const char* const path) noexcept {
+    return SysCall(sc::SysCallType::Exec, path);
+}
+
+stl::size_t Process::Spawn(const char* const path, const stl::size_t* const descs,
+                           const stl::size_t desc_count) noexcept {
+    return SysCall(sc::SysCallType::Spawn, path, descs, desc_count);
+}
+
+bool GetThreadStats(const stl::size_t idx, ThreadStats& stats) noexcept {
+    return SysCall(sc::SysCallType::ThreadStats, idx, &stats);
+}
+
 }  // namespace usr::tsk
\ No newline at end of file
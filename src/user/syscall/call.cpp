@@ -0,0 +1,13 @@
+#include "user/syscall/call.h"
+
+namespace usr::sc {
+
+bool GetSysCallStats(const SysCallType func, SysCallStats& stats) noexcept {
+    return SysCall(SysCallType::SysCallStats, func, &stats);
+}
+
+void ResetSysCallStats(const bool enabled) noexcept {
+    SysCall(SysCallType::ResetSysCallStats, enabled);
+}
+
+}  // namespace usr::sc
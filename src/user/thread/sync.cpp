@@ -0,0 +1,85 @@
+#include "user/thread/sync.h"
+#include "user/syscall/call.h"
+
+namespace usr::sync {
+
+bool FutexWait(stl::uint32_t& addr, const stl::uint32_t expected,
+               const stl::size_t milliseconds) noexcept {
+    return sc::SysCall(sc::SysCallType::FutexWait, &addr, expected, milliseconds);
+}
+
+stl::size_t FutexWake(stl::uint32_t& addr, const stl::size_t count) noexcept {
+    return sc::SysCall(sc::SysCallType::FutexWake, &addr, count);
+}
+
+void Mutex::Lock() noexcept {
+    auto state {static_cast<stl::uint32_t>(Unlocked)};
+    if (__atomic_compare_exchange_n(&state_, &state, Locked, false, __ATOMIC_ACQUIRE,
+                                    __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    LockContended();
+}
+
+bool Mutex::TryLock() noexcept {
+    auto state {static_cast<stl::uint32_t>(Unlocked)};
+    return __atomic_compare_exchange_n(&state_, &state, Locked, false, __ATOMIC_ACQUIRE,
+                                       __ATOMIC_RELAXED);
+}
+
+void Mutex::LockContended() noexcept {
+    // Marking the mutex as contended makes the owner wake up a thread when unlocking it.
+    while (__atomic_exchange_n(&state_, Contended, __ATOMIC_ACQUIRE) != Unlocked) {
+        FutexWait(state_, Contended);
+    }
+}
+
+void Mutex::Unlock() noexcept {
+    if (__atomic_exchange_n(&state_, Unlocked, __ATOMIC_RELEASE) == Contended) {
+        FutexWake(state_, 1);
+    }
+}
+
+void CondVar::Wait(Mutex& mtx) noexcept {
+    Wait(mtx, futex_wait_forever);
+}
+
+bool CondVar::Wait(Mutex& mtx, const stl::size_t milliseconds) noexcept {
+    // The waiter is counted before reading the sequence number,
+    // so a notification either sees the waiter or changes the number before it is read.
+    __atomic_add_fetch(&waiter_count_, 1, __ATOMIC_SEQ_CST);
+    const auto seq {__atomic_load_n(&seq_, __ATOMIC_SEQ_CST)};
+    mtx.Unlock();
+    // The word has been changed if a notification comes before waiting.
+    const auto notified {FutexWait(seq_, seq, milliseconds)
+                         || __atomic_load_n(&seq_, __ATOMIC_RELAXED) != seq};
+    __atomic_sub_fetch(&waiter_count_, 1, __ATOMIC_RELAXED);
+    // Other threads may be waiting for the mutex.
+    mtx.LockContended();
+    return notified;
+}
+
+void CondVar::NotifyOne() noexcept {
+    __atomic_add_fetch(&seq_, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&waiter_count_, __ATOMIC_SEQ_CST) != 0) {
+        FutexWake(seq_, 1);
+    }
+}
+
+void CondVar::NotifyAll() noexcept {
+    __atomic_add_fetch(&seq_, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&waiter_count_, __ATOMIC_SEQ_CST) != 0) {
+        FutexWake(seq_, static_cast<stl::size_t>(-1));
+    }
+}
+
+void ResetLockStats(const bool enabled) noexcept {
+    sc::SysCall(sc::SysCallType::ResetLockStats, enabled);
+}
+
+void DumpLockStats() noexcept {
+    sc::SysCall(sc::SysCallType::DumpLockStats);
+}
+
+}  // namespace usr::sync
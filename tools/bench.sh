@@ -0,0 +1,149 @@
+#!/bin/sh
+# Run kernel benchmarks headless under QEMU and compare results with a baseline.
+#
+# Usage: bench.sh <build-dir> <baseline> <threshold> <timeout>
+#
+# - <build-dir> contains a benchmark-enabled `kernel.img`, which is written by `make bench`.
+# - <baseline> is a result file. If it does not exist, the current results are saved as the baseline.
+# - <threshold> is the allowed regression in percent.
+# - <timeout> is the maximum number of seconds to wait for benchmarks.
+#
+# Results are saved in `<build-dir>/bench.tsv` with tab-separated columns:
+# the suite (`krnl` or `fs`), the benchmark name, the metric and its decimal value.
+
+set -eu
+
+BUILD_DIR=$1
+BASELINE=$2
+THRESHOLD=$3
+TIMEOUT=$4
+
+QEMU=${QEMU:-qemu-system-i386}
+SYS_DISK=$BUILD_DIR/kernel.img
+FILE_DISK=$BUILD_DIR/hd80m.img
+SERIAL_LOG=$BUILD_DIR/serial.log
+RESULTS=$BUILD_DIR/bench.tsv
+
+# The line printed by the kernel after all benchmarks.
+DONE_LINE='Benchmarks have finished.'
+
+# Create a fresh file disk with the same partitions as `docs/Getting Started/Development Environment.md`.
+# The file system benchmark runs on the first partition `sdb1`, which is formatted by the kernel.
+rm -f "$FILE_DISK"
+dd if=/dev/zero of="$FILE_DISK" bs=512 count=163296 2> /dev/null
+sfdisk -q "$FILE_DISK" << EOF
+label: dos
+start=2048, size=16128, type=83
+start=18432, size=144864, type=5
+start=20480, size=9072, type=66
+start=32768, size=12600, type=66
+EOF
+
+# Boot the system without a display. Printed text is mirrored to the serial port.
+rm -f "$SERIAL_LOG"
+"$QEMU" -m 32 -display none -no-reboot -monitor none \
+    -serial "file:$SERIAL_LOG" \
+    -drive "file=$SYS_DISK,format=raw,if=ide,index=0,media=disk" \
+    -drive "file=$FILE_DISK,format=raw,if=ide,index=1,media=disk" &
+QEMU_PID=$!
+trap 'kill $QEMU_PID 2> /dev/null || true' EXIT
+
+elapsed=0
+until grep -q "$DONE_LINE" "$SERIAL_LOG" 2> /dev/null; do
+    if [ "$elapsed" -ge "$TIMEOUT" ]; then
+        echo "Benchmarks did not finish in $TIMEOUT seconds. See $SERIAL_LOG." >&2
+        exit 1
+    fi
+
+    if ! kill -0 $QEMU_PID 2> /dev/null; then
+        echo "QEMU exited before benchmarks finished. See $SERIAL_LOG." >&2
+        exit 1
+    fi
+
+    sleep 1
+    elapsed=$((elapsed + 1))
+done
+
+kill $QEMU_PID 2> /dev/null || true
+
+# Convert benchmark lines to results. The kernel prints integers in hexadecimal without `0x`.
+# - Microbenchmarks: `<name>: min <n>, median <n>, p99 <n> cycles.`
+# - File system benchmarks: `<name>: <n> ops, <n> KiB/s, p50 <n> us, p90 <n> us, p99 <n> us, max <n> us.`
+tr -d '\r' < "$SERIAL_LOG" | awk '
+function hex(str,    val, i) {
+    val = 0
+    for (i = 1; i <= length(str); ++i) {
+        val = val * 16 + index("0123456789abcdef", tolower(substr(str, i, 1))) - 1
+    }
+
+    return val
+}
+
+function emit(suite, name, metric, val) {
+    printf "%s\t%s\t%s\t%d\n", suite, name, metric, hex(val)
+}
+
+/: min [0-9a-fA-F]+, median [0-9a-fA-F]+, p99 [0-9a-fA-F]+ cycles\.$/ {
+    name = substr($0, 1, index($0, ": min ") - 1)
+    split(substr($0, length(name) + 3), fields, /[ ,.]+/)
+    emit("krnl", name, "min", fields[2])
+    emit("krnl", name, "median", fields[4])
+    emit("krnl", name, "p99", fields[6])
+}
+
+/: [0-9a-fA-F]+ ops, [0-9a-fA-F]+ (KiB|ops)\/s, p50 [0-9a-fA-F]+ us, .* max [0-9a-fA-F]+ us\.$/ {
+    name = substr($0, 1, index($0, ": ") - 1)
+    split(substr($0, length(name) + 3), fields, /[ ,.]+/)
+    emit("fs", name, fields[4], fields[3])
+    emit("fs", name, "p50", fields[6])
+    emit("fs", name, "p90", fields[9])
+    emit("fs", name, "p99", fields[12])
+    emit("fs", name, "max", fields[15])
+}
+' > "$RESULTS"
+
+if [ ! -s "$RESULTS" ]; then
+    echo "No benchmark results are found. See $SERIAL_LOG." >&2
+    exit 1
+fi
+
+echo "Results are saved in $RESULTS."
+if [ ! -f "$BASELINE" ]; then
+    cp "$RESULTS" "$BASELINE"
+    echo "No baseline is found. The results are saved as the baseline $BASELINE."
+    exit 0
+fi
+
+# Compare stable metrics with the baseline.
+# Tail latencies and maximums vary with interrupts, so they are printed but not checked.
+awk -F '\t' -v threshold="$THRESHOLD" '
+NR == FNR {
+    baseline[$1 FS $2 FS $3] = $4
+    next
+}
+
+{
+    key = $1 FS $2 FS $3
+    if (!(key in baseline) || baseline[key] == 0) {
+        printf "%-40s %-8s %12s %12d\n", $2, $3, "-", $4
+        next
+    }
+
+    change = ($4 - baseline[key]) * 100 / baseline[key]
+    higher_better = $3 == "KiB/s" || $3 == "ops/s"
+    checked = higher_better || $3 == "min" || $3 == "median" || $3 == "p50"
+    regressed = checked && (higher_better ? -change : change) > threshold
+    printf "%-40s %-8s %12d %12d %+7.1f%%%s\n", $2, $3, baseline[key], $4, change,
+           regressed ? " REGRESSION" : ""
+    if (regressed) {
+        ++regression_count
+    }
+}
+
+END {
+    if (regression_count > 0) {
+        printf "%d metrics regressed by more than %d%%.\n", regression_count, threshold
+        exit 1
+    }
+}
+' "$BASELINE" "$RESULTS"
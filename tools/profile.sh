@@ -0,0 +1,120 @@
+#!/bin/sh
+# Convert a trace of an instrumented kernel to per-function cycle counts.
+#
+# Usage: profile.sh <kernel> <serial-log>
+#
+# - <kernel> is the unstripped `kernel.bin` built with `KRNL_INSTRUMENT=1`, used to symbolize functions.
+# - <serial-log> contains the output of `usr::dbg::DumpTrace`.
+#
+# Results are printed with tab-separated columns sorted by exclusive cycles:
+# the function, the number of calls, inclusive cycles and exclusive cycles.
+# Cycles while a thread is switched out are not counted.
+# Calls that started before the oldest record or did not return are ignored.
+
+set -eu
+
+KERNEL=$1
+SERIAL_LOG=$2
+
+printf 'function\tcalls\tinclusive\texclusive\n'
+{
+    nm -C --defined-only "$KERNEL"
+    echo 'symbols-end'
+    tr -d '\r' < "$SERIAL_LOG"
+} | awk '
+function hex(str,    val, i) {
+    val = 0
+    for (i = 1; i <= length(str); ++i) {
+        val = val * 16 + index("0123456789abcdef", tolower(substr(str, i, 1))) - 1
+    }
+
+    return val
+}
+
+function name(addr) {
+    return (addr in syms) ? syms[addr] : "0x" addr
+}
+
+# Symbols from `nm`: `<address> <type> <name>`.
+!symbols_done {
+    if ($0 == "symbols-end") {
+        symbols_done = 1
+    } else if ($2 ~ /^[tTwW]$/) {
+        syms[tolower($1)] = substr($0, length($1) + length($2) + 3)
+    }
+
+    next
+}
+
+# The header of a trace dump. Records of an earlier dump are discarded.
+$1 == "trace" && NF == 4 {
+    in_trace = 1
+    delete depth
+    delete switched_out
+    delete paused
+    delete active
+    next
+}
+
+!in_trace || NF != 5 {
+    next
+}
+
+{
+    tsc = hex($1)
+    thd = tolower($3)
+}
+
+$2 == "switch" {
+    switched_out[tolower($4)] = tsc
+    next_thd = tolower($5)
+    if (next_thd in switched_out) {
+        paused[next_thd] += tsc - switched_out[next_thd]
+    }
+
+    next
+}
+
+$2 == "func_enter" {
+    fn = tolower($4)
+    d = ++depth[thd]
+    funcs[thd, d] = fn
+    starts[thd, d] = tsc - paused[thd]
+    children[thd, d] = 0
+    ++active[thd, fn]
+    next
+}
+
+$2 == "func_exit" {
+    fn = tolower($4)
+    # Frames of functions that did not return, such as those switching stacks, are dropped.
+    for (d = depth[thd]; d > 0 && funcs[thd, d] != fn; --d) {
+    }
+
+    if (d == 0) {
+        next
+    }
+
+    for (; depth[thd] > d; --depth[thd]) {
+        --active[thd, funcs[thd, depth[thd]]]
+    }
+
+    incl = tsc - paused[thd] - starts[thd, d]
+    ++calls[fn]
+    excl[fn] += incl - children[thd, d]
+    # Recursive calls are only counted once in inclusive cycles.
+    if (--active[thd, fn] == 0) {
+        inclusive[fn] += incl
+    }
+
+    if (--depth[thd] > 0) {
+        children[thd, depth[thd]] += incl
+    }
+}
+
+END {
+    for (fn in calls) {
+        printf "%s\t%d\t%d\t%d\n", name(fn), calls[fn], inclusive[fn], excl[fn]
+    }
+}
+' | sort -t "$(printf '\t')" -k 4 -n -r